@@ -58,6 +58,12 @@ __RCSID("$NetBSD: utils.c,v 1.44 2015/03/03 00:20:38 enami Exp $");
 
 #define	MMAP_MAX_SIZE	(8 * 1048576)
 #define	MMAP_MAX_WRITE	(64 * 1024)
+/*
+ * Size of the read/write copy buffer.  Large files (disk and VM images)
+ * are copied through this buffer, so make it big enough to amortize the
+ * per-call overhead over a megabyte at a time.
+ */
+#define	COPY_BUF_SIZE	(16 * MAXBSIZE)
 
 int
 set_utimes(const char *file, struct stat *fs)
@@ -93,7 +99,7 @@ progress(const struct finfo *fi, size_t written)
 int
 copy_file(FTSENT *entp, int dne)
 {
-	static char buf[MAXBSIZE];
+	static char buf[COPY_BUF_SIZE];
 	struct stat to_stat, *fs;
 	int ch, checkch, from_fd, rcount, rval, to_fd, tolnk, wcount;
 	char *p;
@@ -241,14 +247,41 @@ copy_file(FTSENT *entp, int dne)
 		}
 
 		if (use_read) {
-			while ((rcount = read(from_fd, buf, MAXBSIZE)) > 0) {
-				wcount = write(to_fd, buf, (size_t)rcount);
-				if (rcount != wcount || wcount == -1) {
-					warn("%s", to.p_path);
-					rval = 1;
-					break;
+			bool last_hole = false;
+
+			while ((rcount = read(from_fd, buf, COPY_BUF_SIZE)) > 0) {
+				int i;
+
+				/*
+				 * Seek over buffers that contain only zero
+				 * bytes instead of writing them out; on file
+				 * systems that support holes this produces a
+				 * sparse copy.  The output file was truncated
+				 * on open, so the skipped range is guaranteed
+				 * to read back as zeros.
+				 */
+				for (i = 0; i < rcount; i++)
+					if (buf[i] != '\0')
+						break;
+				if (i == rcount) {
+					if (lseek(to_fd, (off_t)rcount,
+					    SEEK_CUR) == -1) {
+						warn("%s", to.p_path);
+						rval = 1;
+						break;
+					}
+					last_hole = true;
+				} else {
+					wcount = write(to_fd, buf,
+					    (size_t)rcount);
+					if (rcount != wcount || wcount == -1) {
+						warn("%s", to.p_path);
+						rval = 1;
+						break;
+					}
+					last_hole = false;
 				}
-				ptotal += wcount;
+				ptotal += rcount;
 				if (pinfo)
 					progress(&fi, ptotal);
 			}
@@ -256,6 +289,16 @@ copy_file(FTSENT *entp, int dne)
 				warn("%s", entp->fts_path);
 				rval = 1;
 			}
+			/*
+			 * The seek alone does not extend the file; if the
+			 * copy ended in a hole, set the final size
+			 * explicitly.
+			 */
+			if (rval == 0 && last_hole &&
+			    ftruncate(to_fd, (off_t)ptotal) == -1) {
+				warn("%s", to.p_path);
+				rval = 1;
+			}
 		}
 	}
 
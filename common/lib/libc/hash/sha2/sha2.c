@@ -269,6 +269,305 @@ __weak_alias(SHA512_Transform,_SHA512_Transform)
 #endif
 #endif
 
+#if defined(__i386__) && !defined(_KERNEL) && !defined(_STANDALONE)
+
+/*
+ * SHA-NI accelerated SHA-256 block transform, selected at run time on x86
+ * processors that support the SHA instruction set extension.  The rounds and
+ * the message schedule are computed by the sha256rnds2, sha256msg1 and
+ * sha256msg2 instructions, following Intel's published one-block flow.  The
+ * SHA instructions are emitted as .byte sequences because the assembler
+ * predates them; each sequence carries the intended mnemonic as a comment.
+ *
+ * Register use: xmm0 holds the current round constants plus message words
+ * (fixed operand of sha256rnds2), xmm1/xmm2 hold the working variables in
+ * the ABEF/CDGH form that the instructions expect, xmm3-xmm6 hold the
+ * rolling message schedule, and xmm7 is scratch.
+ */
+static int sha256_use_shani = -1;	/* -1 = not yet determined */
+
+/*
+ * Return whether the processor supports the SHA extension, as well as the
+ * SSSE3 and SSE4.1 instructions used by the transform below.
+ */
+static int
+sha256_have_shani(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+
+	/*
+	 * The EBX register juggling keeps this code safe for use in
+	 * position-independent code, where EBX is reserved.
+	 */
+	__asm__ volatile (
+	    "xchgl %%ebx, %1\n\t"
+	    "cpuid\n\t"
+	    "xchgl %%ebx, %1"
+	    : "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx)
+	    : "0" (0));
+
+	if (eax < 7)
+		return 0;
+
+	__asm__ volatile (
+	    "xchgl %%ebx, %1\n\t"
+	    "cpuid\n\t"
+	    "xchgl %%ebx, %1"
+	    : "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx)
+	    : "0" (1));
+
+	if (!(ecx & (1 << 9)) || !(ecx & (1 << 19)))	/* SSSE3, SSE4.1 */
+		return 0;
+
+	__asm__ volatile (
+	    "xchgl %%ebx, %1\n\t"
+	    "cpuid\n\t"
+	    "xchgl %%ebx, %1"
+	    : "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx)
+	    : "0" (7), "2" (0));
+
+	return !!(ebx & (1 << 29));	/* CPUID feature flag for SHA */
+}
+
+static void
+sha256_transform_shani(SHA256_CTX *context, const uint32_t *data)
+{
+	/* Byte shuffle mask that converts big-endian message words. */
+	static const uint32_t flip[4] __aligned(16) = {
+		0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f
+	};
+	uint32_t save[8];
+
+	__asm__ volatile (
+	    "movdqu (%0), %%xmm1\n\t"
+	    "movdqu 16(%0), %%xmm2\n\t"
+	    "pshufd $0xb1, %%xmm1, %%xmm7\n\t"
+	    "pshufd $0x1b, %%xmm2, %%xmm2\n\t"
+	    "movdqa %%xmm7, %%xmm1\n\t"
+	    "palignr $8, %%xmm2, %%xmm1\n\t"
+	    "pblendw $0xf0, %%xmm7, %%xmm2\n\t"
+	    "movdqu %%xmm1, (%4)\n\t"
+	    "movdqu %%xmm2, 16(%4)\n\t"
+	    "\n"
+	    "/* rounds 0-3 */\n\t"
+	    "movdqu 0(%1), %%xmm0\n\t"
+	    "pshufb (%3), %%xmm0\n\t"
+	    "movdqa %%xmm0, %%xmm3\n\t"
+	    "movdqu 0(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    "\n"
+	    "/* rounds 4-7 */\n\t"
+	    "movdqu 16(%1), %%xmm0\n\t"
+	    "pshufb (%3), %%xmm0\n\t"
+	    "movdqa %%xmm0, %%xmm4\n\t"
+	    "movdqu 16(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xdc	/* sha256msg1 %%xmm4, %%xmm3 */\n\t"
+	    "\n"
+	    "/* rounds 8-11 */\n\t"
+	    "movdqu 32(%1), %%xmm0\n\t"
+	    "pshufb (%3), %%xmm0\n\t"
+	    "movdqa %%xmm0, %%xmm5\n\t"
+	    "movdqu 32(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xe5	/* sha256msg1 %%xmm5, %%xmm4 */\n\t"
+	    "\n"
+	    "/* rounds 12-15 */\n\t"
+	    "movdqu 48(%1), %%xmm0\n\t"
+	    "pshufb (%3), %%xmm0\n\t"
+	    "movdqa %%xmm0, %%xmm6\n\t"
+	    "movdqu 48(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm6, %%xmm7\n\t"
+	    "palignr $4, %%xmm5, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm3\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xde	/* sha256msg2 %%xmm6, %%xmm3 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xee	/* sha256msg1 %%xmm6, %%xmm5 */\n\t"
+	    "\n"
+	    "/* rounds 16-19 */\n\t"
+	    "movdqa %%xmm3, %%xmm0\n\t"
+	    "movdqu 64(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm3, %%xmm7\n\t"
+	    "palignr $4, %%xmm6, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm4\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xe3	/* sha256msg2 %%xmm3, %%xmm4 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xf3	/* sha256msg1 %%xmm3, %%xmm6 */\n\t"
+	    "\n"
+	    "/* rounds 20-23 */\n\t"
+	    "movdqa %%xmm4, %%xmm0\n\t"
+	    "movdqu 80(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm4, %%xmm7\n\t"
+	    "palignr $4, %%xmm3, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm5\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xec	/* sha256msg2 %%xmm4, %%xmm5 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xdc	/* sha256msg1 %%xmm4, %%xmm3 */\n\t"
+	    "\n"
+	    "/* rounds 24-27 */\n\t"
+	    "movdqa %%xmm5, %%xmm0\n\t"
+	    "movdqu 96(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm5, %%xmm7\n\t"
+	    "palignr $4, %%xmm4, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm6\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xf5	/* sha256msg2 %%xmm5, %%xmm6 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xe5	/* sha256msg1 %%xmm5, %%xmm4 */\n\t"
+	    "\n"
+	    "/* rounds 28-31 */\n\t"
+	    "movdqa %%xmm6, %%xmm0\n\t"
+	    "movdqu 112(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm6, %%xmm7\n\t"
+	    "palignr $4, %%xmm5, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm3\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xde	/* sha256msg2 %%xmm6, %%xmm3 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xee	/* sha256msg1 %%xmm6, %%xmm5 */\n\t"
+	    "\n"
+	    "/* rounds 32-35 */\n\t"
+	    "movdqa %%xmm3, %%xmm0\n\t"
+	    "movdqu 128(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm3, %%xmm7\n\t"
+	    "palignr $4, %%xmm6, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm4\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xe3	/* sha256msg2 %%xmm3, %%xmm4 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xf3	/* sha256msg1 %%xmm3, %%xmm6 */\n\t"
+	    "\n"
+	    "/* rounds 36-39 */\n\t"
+	    "movdqa %%xmm4, %%xmm0\n\t"
+	    "movdqu 144(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm4, %%xmm7\n\t"
+	    "palignr $4, %%xmm3, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm5\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xec	/* sha256msg2 %%xmm4, %%xmm5 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xdc	/* sha256msg1 %%xmm4, %%xmm3 */\n\t"
+	    "\n"
+	    "/* rounds 40-43 */\n\t"
+	    "movdqa %%xmm5, %%xmm0\n\t"
+	    "movdqu 160(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm5, %%xmm7\n\t"
+	    "palignr $4, %%xmm4, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm6\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xf5	/* sha256msg2 %%xmm5, %%xmm6 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xe5	/* sha256msg1 %%xmm5, %%xmm4 */\n\t"
+	    "\n"
+	    "/* rounds 44-47 */\n\t"
+	    "movdqa %%xmm6, %%xmm0\n\t"
+	    "movdqu 176(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm6, %%xmm7\n\t"
+	    "palignr $4, %%xmm5, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm3\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xde	/* sha256msg2 %%xmm6, %%xmm3 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xee	/* sha256msg1 %%xmm6, %%xmm5 */\n\t"
+	    "\n"
+	    "/* rounds 48-51 */\n\t"
+	    "movdqa %%xmm3, %%xmm0\n\t"
+	    "movdqu 192(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm3, %%xmm7\n\t"
+	    "palignr $4, %%xmm6, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm4\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xe3	/* sha256msg2 %%xmm3, %%xmm4 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    ".byte 0x0f, 0x38, 0xcc, 0xf3	/* sha256msg1 %%xmm3, %%xmm6 */\n\t"
+	    "\n"
+	    "/* rounds 52-55 */\n\t"
+	    "movdqa %%xmm4, %%xmm0\n\t"
+	    "movdqu 208(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm4, %%xmm7\n\t"
+	    "palignr $4, %%xmm3, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm5\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xec	/* sha256msg2 %%xmm4, %%xmm5 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    "\n"
+	    "/* rounds 56-59 */\n\t"
+	    "movdqa %%xmm5, %%xmm0\n\t"
+	    "movdqu 224(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "movdqa %%xmm5, %%xmm7\n\t"
+	    "palignr $4, %%xmm4, %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm6\n\t"
+	    ".byte 0x0f, 0x38, 0xcd, 0xf5	/* sha256msg2 %%xmm5, %%xmm6 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    "\n"
+	    "/* rounds 60-63 */\n\t"
+	    "movdqa %%xmm6, %%xmm0\n\t"
+	    "movdqu 240(%2), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xd1	/* sha256rnds2 %%xmm1, %%xmm2 */\n\t"
+	    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+	    ".byte 0x0f, 0x38, 0xcb, 0xca	/* sha256rnds2 %%xmm2, %%xmm1 */\n\t"
+	    "\n"
+	    "movdqu (%4), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm1\n\t"
+	    "movdqu 16(%4), %%xmm7\n\t"
+	    "paddd %%xmm7, %%xmm2\n\t"
+	    "pshufd $0x1b, %%xmm1, %%xmm7\n\t"
+	    "pshufd $0xb1, %%xmm2, %%xmm2\n\t"
+	    "movdqa %%xmm7, %%xmm1\n\t"
+	    "pblendw $0xf0, %%xmm2, %%xmm1\n\t"
+	    "palignr $8, %%xmm7, %%xmm2\n\t"
+	    "movdqu %%xmm1, (%0)\n\t"
+	    "movdqu %%xmm2, 16(%0)\n\t"
+	    :
+	    : "r" (context->state), "r" (data), "r" (K256), "r" (flip),
+	      "r" (save)
+	    : "memory", "cc");
+
+	/* Clean up */
+	memset(save, 0, sizeof(save));
+}
+
+#endif /* __i386__ && !_KERNEL && !_STANDALONE */
+
+
 /*** SHA-256: *********************************************************/
 int
 SHA256_Init(SHA256_CTX *context)
@@ -315,6 +614,15 @@ SHA256_Transform(SHA256_CTX *context, const uint32_t *data)
 	uint32_t	T1, *W256;
 	int		j;
 
+#if defined(__i386__) && !defined(_KERNEL) && !defined(_STANDALONE)
+	if (sha256_use_shani < 0)
+		sha256_use_shani = sha256_have_shani();
+	if (sha256_use_shani) {
+		sha256_transform_shani(context, data);
+		return;
+	}
+#endif
+
 	W256 = (uint32_t *)context->buffer;
 
 	/* Initialize registers with the prev. intermediate value */
@@ -375,6 +683,15 @@ SHA256_Transform(SHA256_CTX *context, const uint32_t *data)
 	uint32_t	T1, T2, *W256;
 	int		j;
 
+#if defined(__i386__) && !defined(_KERNEL) && !defined(_STANDALONE)
+	if (sha256_use_shani < 0)
+		sha256_use_shani = sha256_have_shani();
+	if (sha256_use_shani) {
+		sha256_transform_shani(context, data);
+		return;
+	}
+#endif
+
 	W256 = (uint32_t *)(void *)context->buffer;
 
 	/* Initialize registers with the prev. intermediate value */
@@ -48,19 +48,55 @@ __RCSID("$NetBSD: memchr.c,v 1.3 2008/01/08 21:57:06 martin Exp $");
 #include <lib/libkern/libkern.h>
 #endif
 
+/*
+ * sizeof(word) MUST BE A POWER OF TWO
+ * SO THAT wmask BELOW IS ALL ONES
+ */
+typedef	unsigned long word;	/* "word" used for optimal scan speed */
+
+#define	wsize	sizeof(word)
+#define	wmask	(wsize - 1)
+
+/*
+ * Repeating the target byte in every byte of a word and XORing turns
+ * the search into zero-byte detection: (w - wones) & ~w & whighs is
+ * non-zero exactly when w contains a zero byte.  Borrows can smear the
+ * per-byte indication, so the word loop only narrows the search and the
+ * byte loop below pinpoints the match.
+ */
+#define	wones	((word)-1 / 0xff)
+#define	whighs	(wones * 0x80)
+
 void *
 memchr(const void *s, int c, size_t n)
 {
+	const unsigned char *p = s;
+	const word *w;
+	word wcmp;
+	const unsigned char cmp = c;
+
 	_DIAGASSERT(s != NULL);
 
-	if (n != 0) {
-		const unsigned char *p = s;
-		const unsigned char cmp = c;
+	/* Scan bytes until the pointer is word aligned. */
+	while (n != 0 && ((unsigned long)p & wmask) != 0) {
+		if (*p == cmp)
+			return __UNCONST(p);
+		++p;
+		--n;
+	}
 
-		do {
-			if (*p++ == cmp)
-				return __UNCONST(p - 1);
-		} while (--n != 0);
+	/* Scan a word at a time for a word containing the byte. */
+	if (n >= wsize) {
+		wcmp = wones * cmp;
+		for (w = (const word *)p;
+		    n >= wsize && !(((*w ^ wcmp) - wones) & ~(*w ^ wcmp) & whighs);
+		    ++w)
+			n -= wsize;
+		p = (const unsigned char *)w;
 	}
+
+	for (; n != 0; ++p, --n)
+		if (*p == cmp)
+			return __UNCONST(p);
 	return NULL;
 }
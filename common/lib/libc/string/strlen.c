@@ -45,14 +45,42 @@ __RCSID("$NetBSD: strlen.c,v 1.2 2007/06/04 18:19:27 christos Exp $");
 #include <lib/libkern/libkern.h>
 #endif
 
+/*
+ * sizeof(word) MUST BE A POWER OF TWO
+ * SO THAT wmask BELOW IS ALL ONES
+ */
+typedef	unsigned long word;	/* "word" used for optimal scan speed */
+
+#define	wsize	sizeof(word)
+#define	wmask	(wsize - 1)
+
+/*
+ * wones has every byte set to 0x01, whighs every byte set to 0x80.
+ * (w - wones) & ~w & whighs is non-zero if and only if the word w
+ * contains a zero byte, although borrow propagation means it does not
+ * reliably say in which byte; the trailing byte loop determines that.
+ */
+#define	wones	((word)-1 / 0xff)
+#define	whighs	(wones * 0x80)
+
 size_t
 strlen(const char *str)
 {
 	const char *s;
+	const word *w;
 
 	_DIAGASSERT(str != NULL);
 
-	for (s = str; *s; ++s)
+	/*
+	 * Scan bytes until the pointer is word aligned, then scan a
+	 * word at a time for a word containing a zero byte.
+	 */
+	for (s = str; ((unsigned long)s & wmask) != 0; ++s)
+		if (!*s)
+			return(s - str);
+	for (w = (const word *)s; !((*w - wones) & ~*w & whighs); ++w)
+		continue;
+	for (s = (const char *)w; *s; ++s)
 		continue;
 	return(s - str);
 }
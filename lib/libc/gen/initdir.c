@@ -52,6 +52,15 @@ __RCSID("$NetBSD: initdir.c,v 1.3 2012/03/13 21:13:36 christos Exp $");
 
 #define	MAXITERATIONS	100
 
+/*
+ * Size of the readdir buffer, in page/DIRBLKSIZ increments.  Every
+ * getdents() call is a round trip to the file server, so reading the
+ * directory in large chunks directly cuts the number of calls needed to
+ * scan a big directory.  16 pages matches the 64 KB staging buffer the
+ * file servers use for getdents.
+ */
+#define	READDIR_NCHUNKS	16
+
 int
 _initdir(DIR *dirp, int fd, const char *name)
 {
@@ -242,7 +251,7 @@ retry:
 		dirp->dd_len = (int)len;
 		dirp->dd_size = ddptr - dirp->dd_buf;
 	} else {
-		dirp->dd_len = incr;
+		dirp->dd_len = READDIR_NCHUNKS * incr;
 		dirp->dd_buf = malloc((size_t)dirp->dd_len);
 		if (dirp->dd_buf == NULL)
 			return errno;
@@ -98,7 +98,12 @@
 /* LINTLIBRARY */
 
 #if defined(__NetBSD__) || defined(__minix)
-#  define xutrace(a, b)		utrace("malloc", (a), (b))
+#  ifdef __minix
+     /* MINIX has no utrace(2); compile the tracing hook out. */
+#    define xutrace(a, b)	((void)(a), (void)(b))
+#  else
+#    define xutrace(a, b)	utrace("malloc", (a), (b))
+#  endif
 #  define __DECONST(x, y)	((x)__UNCONST(y))
 #  define NO_TLS
 #else
@@ -148,7 +153,9 @@ __RCSID("$NetBSD: jemalloc.c,v 1.38 2015/07/26 17:21:55 martin Exp $");
 
 #include <errno.h>
 #include <limits.h>
+#ifndef __minix
 #include <pthread.h>
+#endif
 #include <sched.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -159,7 +166,7 @@ __RCSID("$NetBSD: jemalloc.c,v 1.38 2015/07/26 17:21:55 martin Exp $");
 #include <strings.h>
 #include <unistd.h>
 
-#ifdef __NetBSD__
+#if defined(__NetBSD__) || defined(__minix)
 #  include <reentrant.h>
 #  include "extern.h"
 
@@ -387,6 +394,16 @@ static bool malloc_initialized = false;
 /* Used to avoid initialization races. */
 static malloc_mutex_t init_lock = {_SPINLOCK_INITIALIZER};
 #else
+#ifdef __minix
+/*
+ * MINIX builds libc without _REENTRANT: the mutex operations from
+ * <reentrant.h> expand to no-ops, but the mutex type itself is not
+ * provided.  libmthread schedules its threads cooperatively, so they
+ * cannot preempt one another inside the allocator and a placeholder
+ * type is sufficient.
+ */
+typedef int mutex_t;
+#endif
 #define	malloc_mutex_t	mutex_t
 
 /* Set to true once the allocator has been initialized. */
@@ -941,7 +958,7 @@ static bool	malloc_init_hard(void);
  * Begin mutex.
  */
 
-#ifdef __NetBSD__
+#if defined(__NetBSD__) || defined(__minix)
 #define	malloc_mutex_init(m)	mutex_init(m, NULL)
 #define	malloc_mutex_lock(m)	mutex_lock(m)
 #define	malloc_mutex_unlock(m)	mutex_unlock(m)
@@ -1318,6 +1335,34 @@ pages_map_align(void *addr, size_t size, int align)
 	    MAP_PRIVATE | MAP_ANON | MAP_ALIGNED(align), -1, 0);
 	assert(ret != NULL);
 
+#ifdef __minix
+	if (ret != MAP_FAILED && addr == NULL && align != 0 &&
+	    ((uintptr_t)ret & (((uintptr_t)1 << align) - 1)) != 0) {
+		uintptr_t aret, mask;
+		size_t asize;
+
+		/*
+		 * The VM server does not implement virtual MAP_ALIGNED
+		 * alignment, so realign by hand: over-allocate by the
+		 * alignment and unmap the misaligned head and tail.
+		 */
+		mask = ((uintptr_t)1 << align) - 1;
+		pages_unmap(ret, size);
+		asize = size + mask;
+		ret = mmap(NULL, asize, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANON, -1, 0);
+		if (ret != MAP_FAILED) {
+			aret = ((uintptr_t)ret + mask) & ~mask;
+			if (aret != (uintptr_t)ret)
+				pages_unmap(ret, aret - (uintptr_t)ret);
+			if (aret + size != (uintptr_t)ret + asize)
+				pages_unmap((void *)(aret + size),
+				    (uintptr_t)ret + asize - (aret + size));
+			ret = (void *)aret;
+		}
+	}
+#endif /* __minix */
+
 	if (ret == MAP_FAILED)
 		ret = NULL;
 	else if (addr != NULL && ret != addr) {
@@ -1544,7 +1589,9 @@ chunk_dealloc(void *chunk, size_t size)
 			size_t offset;
 
 			malloc_mutex_unlock(&brk_mtx);
+#if !defined(__minix)
 			madvise(chunk, size, MADV_FREE);
+#endif /* !defined(__minix) */
 
 			/*
 			 * Iteratively create records of each chunk-sized
@@ -2076,8 +2123,10 @@ arena_run_dalloc(arena_t *arena, arena_run_t *run, size_t size)
 	 * Tell the kernel that we don't need the data in this run, but only if
 	 * requested via runtime configuration.
 	 */
+#if !defined(__minix)
 	if (opt_hint)
 		madvise(run, size, MADV_FREE);
+#endif /* !defined(__minix) */
 
 	/* Try to coalesce with neighboring runs. */
 	if (run_ind > arena_chunk_header_npages &&
@@ -3952,7 +4001,7 @@ free(void *ptr)
 /*
  * Begin non-standard functions.
  */
-#ifndef __NetBSD__
+#if !defined(__NetBSD__) && !defined(__minix)
 size_t
 malloc_usable_size(const void *ptr)
 {
@@ -501,6 +501,106 @@ do_get_bar(message *mp)
 	}
 }
 
+static void
+do_get_cfg(message *mp)
+{
+/* Copy out a snapshot of the first 'count' 32-bit registers of the
+ * device's configuration space, so that a driver can fetch them in one
+ * round trip instead of one call per register.
+ */
+	int i, r, devind, count;
+	cp_grant_id_t gid;
+	u32_t buf[256/4];
+
+	devind= mp->m1_i1;
+	count= mp->m1_i2;
+	gid= mp->m1_i3;
+
+	if (count <= 0 || count > (int)(sizeof(buf)/sizeof(buf[0])))
+	{
+		reply(mp, EINVAL);
+		return;
+	}
+
+	r= OK;
+	for (i= 0; i < count; i++)
+	{
+		r= _pci_attr_r32(devind, i*4, &buf[i]);
+		if (r != OK)
+		{
+			printf(
+		"pci:do_get_cfg: pci_attr_r32(%d, %d, ...) failed: %d\n",
+				devind, i*4, r);
+			break;
+		}
+	}
+
+	if (r == OK)
+	{
+		r= sys_safecopyto(mp->m_source, gid, 0,
+			(vir_bytes)buf, count * sizeof(buf[0]));
+	}
+
+	mp->m_type= r;
+	r= ipc_send(mp->m_source, mp);
+	if (r != 0)
+	{
+		printf("do_get_cfg: unable to send to %d: %d\n",
+			mp->m_source, r);
+	}
+}
+
+static void
+do_get_devs(message *mp)
+{
+/* Copy out the full list of devices visible to the caller in a single
+ * call, so that a (restarting) driver does not need one round trip per
+ * device to re-enumerate a bus the server has already walked.
+ */
+	int r, n, count;
+	cp_grant_id_t gid;
+	struct rs_pci *aclp;
+	struct pci_dev_info buf[NR_PCIDEV];
+
+	count= mp->m1_i1;
+	gid= mp->m1_i2;
+
+	if (count <= 0)
+	{
+		reply(mp, EINVAL);
+		return;
+	}
+	if (count > NR_PCIDEV)
+		count= NR_PCIDEV;
+
+	aclp= find_acl(mp->m_source);
+
+	if (!aclp && debug)
+		printf("PCI: do_get_devs: no acl for caller %d\n",
+			mp->m_source);
+
+	n= _pci_get_devs(aclp, buf, count);
+
+	if (n > 0)
+	{
+		r= sys_safecopyto(mp->m_source, gid, 0,
+			(vir_bytes)buf, n * sizeof(buf[0]));
+		if (r != OK)
+		{
+			reply(mp, r);
+			return;
+		}
+	}
+
+	mp->m_type= n;
+	r= ipc_send(mp->m_source, mp);
+	if (r != 0)
+	{
+		printf("do_get_devs: unable to send to %d: %d\n",
+			mp->m_source, r);
+	}
+}
+
 static void
 do_rescan_bus(message *mp)
 {
@@ -689,6 +789,8 @@ pci_other(message *m, int ipc_status)
 	case BUSC_PCI_SET_ACL: do_set_acl(m); break;
 	case BUSC_PCI_DEL_ACL: do_del_acl(m); break;
 	case BUSC_PCI_GET_BAR: do_get_bar(m); break;
+	case BUSC_PCI_GET_CFG: do_get_cfg(m); break;
+	case BUSC_PCI_GET_DEVS: do_get_devs(m); break;
 	default:
 		printf("PCI: unhandled message from %d, type %d\n",
 			m->m_source, m->m_type);
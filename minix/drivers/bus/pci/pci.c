@@ -2251,6 +2251,30 @@ _pci_next_dev(struct rs_pci *aclp, int *devindp, u16_t *vidp, u16_t *didp)
 	return 1;
 }
 
+/*===========================================================================*
+ *				_pci_get_devs				     *
+ *===========================================================================*/
+int
+_pci_get_devs(struct rs_pci *aclp, struct pci_dev_info *buf, int max)
+{
+/* Fill 'buf' with all devices visible to the caller, in devind order,
+ * and return the number of entries.
+ */
+	int devind, n;
+
+	n= 0;
+	for (devind= 0; devind < nr_pcidev && n < max; devind++)
+	{
+		if (!visible(aclp, devind))
+			continue;
+		buf[n].pdi_devind= devind;
+		buf[n].pdi_vid= pcidev[devind].pd_vid;
+		buf[n].pdi_did= pcidev[devind].pd_did;
+		n++;
+	}
+	return n;
+}
+
 /*===========================================================================*
  *				_pci_grant_access			     *
  *===========================================================================*/
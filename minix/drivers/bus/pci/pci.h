@@ -47,6 +47,7 @@ int _pci_first_dev(struct rs_pci *aclp, int *devindp, u16_t *vidp,
 	u16_t *didp);
 int _pci_next_dev(struct rs_pci *aclp, int *devindp, u16_t *vidp, u16_t
 	*didp);
+int _pci_get_devs(struct rs_pci *aclp, struct pci_dev_info *buf, int max);
 int _pci_find_dev(u8_t bus, u8_t dev, u8_t func, int *devindp);
 
 void _pci_rescan_bus(u8_t busnr);
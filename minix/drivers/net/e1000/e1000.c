@@ -15,11 +15,13 @@ static int e1000_init(unsigned int instance, netdriver_addr_t *addr,
 static void e1000_stop(void);
 static void e1000_set_mode(unsigned int, const netdriver_addr_t *,
 	unsigned int);
+static void e1000_set_caps(uint32_t caps);
 static void e1000_set_hwaddr(const netdriver_addr_t *);
 static int e1000_send(struct netdriver_data *data, size_t size);
 static ssize_t e1000_recv(struct netdriver_data *data, size_t max);
 static unsigned int e1000_get_link(uint32_t *);
 static void e1000_intr(unsigned int mask);
+static void e1000_poll(unsigned int budget);
 static void e1000_tick(void);
 static int e1000_probe(e1000_t *e, int skip);
 static void e1000_init_hw(e1000_t *e, netdriver_addr_t *addr);
@@ -35,16 +37,21 @@ static int eeprom_ich_cycle(e1000_t *e, u32_t timeout);
 static int e1000_instance;
 static e1000_t e1000_state;
 
+/* Enabled checksum offload capabilities (NDEV_CAP_CS_). */
+static uint32_t e1000_caps;
+
 static const struct netdriver e1000_table = {
 	.ndr_name	= "em",
 	.ndr_init	= e1000_init,
 	.ndr_stop	= e1000_stop,
 	.ndr_set_mode	= e1000_set_mode,
+	.ndr_set_caps	= e1000_set_caps,
 	.ndr_set_hwaddr	= e1000_set_hwaddr,
 	.ndr_recv	= e1000_recv,
 	.ndr_send	= e1000_send,
 	.ndr_get_link	= e1000_get_link,
 	.ndr_intr	= e1000_intr,
+	.ndr_poll	= e1000_poll,
 	.ndr_tick	= e1000_tick
 };
 
@@ -91,7 +98,13 @@ e1000_init(unsigned int instance, netdriver_addr_t * addr, uint32_t * caps,
 	/* Initialize the hardware, and return its ethernet address. */
 	e1000_init_hw(e, addr);
 
-	*caps = NDEV_CAP_MCAST | NDEV_CAP_BCAST | NDEV_CAP_HWADDR;
+	/* The hardware verifies IPv4, TCP, and UDP checksums on receipt.
+	 * Transmit-side checksum insertion would require per-packet header
+	 * parsing to fill the legacy descriptor's CSS/CSO fields, so we do
+	 * not offer it.
+	 */
+	*caps = NDEV_CAP_MCAST | NDEV_CAP_BCAST | NDEV_CAP_HWADDR |
+	    NDEV_CAP_CS_IP4_RX | NDEV_CAP_CS_UDP_RX | NDEV_CAP_CS_TCP_RX;
 	*ticks = sys_hz() / 10; /* update statistics 10x/sec */
 	return OK;
 }
@@ -288,13 +301,29 @@ e1000_init_addr(e1000_t * e, netdriver_addr_t * addr)
 static void
 e1000_init_buf(e1000_t * e)
 {
+	static char rxkey[] = E1000_ENVVAR "#_RXDESC";
+	static char txkey[] = E1000_ENVVAR "#_TXDESC";
 	phys_bytes rx_desc_p, rx_buff_p;
 	phys_bytes tx_desc_p, tx_buff_p;
+	long v;
 	int i;
 
-	/* Number of descriptors. */
-	e->rx_desc_count = E1000_RXDESC_NR;
-	e->tx_desc_count = E1000_TXDESC_NR;
+	/*
+	 * Number of descriptors.  The defaults may be overridden from the
+	 * environment, typically to give the card more slack at sustained
+	 * high packet rates.  The hardware requires that each ring be a
+	 * multiple of eight descriptors, so round down odd values.
+	 */
+	rxkey[sizeof(E1000_ENVVAR)-1] = '0' + e1000_instance;
+	txkey[sizeof(E1000_ENVVAR)-1] = '0' + e1000_instance;
+
+	v = E1000_RXDESC_NR;
+	(void)env_parse(rxkey, "d", 0, &v, E1000_NDESC_MIN, E1000_NDESC_MAX);
+	e->rx_desc_count = (int)v & ~7;
+
+	v = E1000_TXDESC_NR;
+	(void)env_parse(txkey, "d", 0, &v, E1000_NDESC_MIN, E1000_NDESC_MAX);
+	e->tx_desc_count = (int)v & ~7;
 
 	/* Allocate receive descriptors. */
 	if ((e->rx_desc = alloc_contig(sizeof(e1000_rx_desc_t) *
@@ -304,16 +333,19 @@ e1000_init_buf(e1000_t * e)
 	memset(e->rx_desc, 0, sizeof(e1000_rx_desc_t) * e->rx_desc_count);
 
 	/* Allocate receive buffers. */
-	e->rx_buffer_size = E1000_RXDESC_NR * E1000_IOBUF_SIZE;
+	e->rx_buffer_size = e->rx_desc_count * E1000_IOBUF_SIZE;
 
 	if ((e->rx_buffer = alloc_contig(e->rx_buffer_size, AC_ALIGN4K,
 	    &rx_buff_p)) == NULL)
 		panic("failed to allocate RX buffers");
 
 	/* Set up receive descriptors. */
-	for (i = 0; i < E1000_RXDESC_NR; i++)
+	for (i = 0; i < e->rx_desc_count; i++)
 		e->rx_desc[i].buffer = rx_buff_p + i * E1000_IOBUF_SIZE;
 
+	/* Outside polling mode, allow processing a full ring per attempt. */
+	e->rx_budget = e->rx_desc_count;
+
 	/* Allocate transmit descriptors. */
 	if ((e->tx_desc = alloc_contig(sizeof(e1000_tx_desc_t) *
 	    e->tx_desc_count, AC_ALIGN4K, &tx_desc_p)) == NULL)
@@ -322,26 +354,45 @@ e1000_init_buf(e1000_t * e)
 	memset(e->tx_desc, 0, sizeof(e1000_tx_desc_t) * e->tx_desc_count);
 
 	/* Allocate transmit buffers. */
-	e->tx_buffer_size = E1000_TXDESC_NR * E1000_IOBUF_SIZE;
+	e->tx_buffer_size = e->tx_desc_count * E1000_IOBUF_SIZE;
 
 	if ((e->tx_buffer = alloc_contig(e->tx_buffer_size, AC_ALIGN4K,
 	    &tx_buff_p)) == NULL)
 		panic("failed to allocate TX buffers");
 
 	/* Set up transmit descriptors. */
-	for (i = 0; i < E1000_TXDESC_NR; i++)
+	for (i = 0; i < e->tx_desc_count; i++)
 		e->tx_desc[i].buffer = tx_buff_p + i * E1000_IOBUF_SIZE;
 
+	/*
+	 * Initialize the software view of the rings.  The ring registers are
+	 * read back only on restarts; in steady-state operation, the head
+	 * positions are inferred from descriptor status write-backs and the
+	 * tail positions are tracked right here, saving MMIO register reads
+	 * in the packet send and receive paths.
+	 */
+	e->rx_tail = e->rx_desc_count - 1;
+	e->rx_pending = 0;
+	e->tx_head = 0;
+	e->tx_tail = 0;
+	e->tx_pending = 0;
+
 	/* Set up the receive ring registers. */
 	e1000_reg_write(e, E1000_REG_RDBAL, rx_desc_p);
 	e1000_reg_write(e, E1000_REG_RDBAH, 0);
 	e1000_reg_write(e, E1000_REG_RDLEN,
 	    e->rx_desc_count * sizeof(e1000_rx_desc_t));
 	e1000_reg_write(e, E1000_REG_RDH, 0);
-	e1000_reg_write(e, E1000_REG_RDT, e->rx_desc_count - 1);
+	e1000_reg_write(e, E1000_REG_RDT, e->rx_tail);
 	e1000_reg_unset(e, E1000_REG_RCTL, E1000_REG_RCTL_BSIZE);
 	e1000_reg_set(e, E1000_REG_RCTL, E1000_REG_RCTL_EN);
 
+	/* Have the hardware verify received checksums.  The results are only
+	 * acted upon when the corresponding capabilities are enabled.
+	 */
+	e1000_reg_set(e, E1000_REG_RXCSUM,
+	    E1000_REG_RXCSUM_IPOFL | E1000_REG_RXCSUM_TUOFL);
+
 	/* Set up the transmit ring registers. */
 	e1000_reg_write(e, E1000_REG_TDBAL, tx_desc_p);
 	e1000_reg_write(e, E1000_REG_TDBAH, 0);
@@ -437,6 +488,16 @@ e1000_set_mode(unsigned int mode, const netdriver_addr_t * mcast_list __unused,
 	e1000_reg_write(e, E1000_REG_RCTL, rctl);
 }
 
+/*
+ * Set the enabled checksum offload capabilities.
+ */
+static void
+e1000_set_caps(uint32_t caps)
+{
+
+	e1000_caps = caps;
+}
+
 /*
  * Set hardware address.
  */
@@ -462,7 +523,7 @@ e1000_send(struct netdriver_data * data, size_t size)
 {
 	e1000_t *e;
 	e1000_tx_desc_t *desc;
-	unsigned int head, tail, next;
+	unsigned int next;
 	char *ptr;
 
 	e = &e1000_state;
@@ -473,19 +534,36 @@ e1000_send(struct netdriver_data * data, size_t size)
 	/*
 	 * The queue tail must not advance to the point that it is equal to the
 	 * queue head, since this condition indicates that the queue is empty.
+	 * Rather than read back the head register for every packet, reclaim
+	 * transmitted descriptors lazily: since we set the Report Status bit
+	 * in every command field, the card writes back a Descriptor Done bit
+	 * once it is finished with a descriptor.
 	 */
-	head = e1000_reg_read(e, E1000_REG_TDH);
-	tail = e1000_reg_read(e, E1000_REG_TDT);
-	next = (tail + 1) % e->tx_desc_count;
+	next = (e->tx_tail + 1) % e->tx_desc_count;
+
+	while (next == e->tx_head &&
+	    (e->tx_desc[e->tx_head].status & E1000_TX_STATUS_DONE))
+		e->tx_head = (e->tx_head + 1) % e->tx_desc_count;
+
+	if (next == e->tx_head) {
+		/*
+		 * The ring is full.  Make sure the card has seen all
+		 * previously enqueued packets, so that a transmit-done
+		 * interrupt will eventually resume this request.
+		 */
+		if (e->tx_pending > 0) {
+			e1000_reg_write(e, E1000_REG_TDT, e->tx_tail);
+			e->tx_pending = 0;
+		}
 
-	if (next == head)
 		return SUSPEND;
+	}
 
 	/* The descriptor to use is the one pointed to by the current tail. */
-	desc = &e->tx_desc[tail];
+	desc = &e->tx_desc[e->tx_tail];
 
 	/* Copy the packet from the caller. */
-	ptr = e->tx_buffer + tail * E1000_IOBUF_SIZE;
+	ptr = e->tx_buffer + e->tx_tail * E1000_IOBUF_SIZE;
 
 	netdriver_copyin(data, 0, ptr, size);
 
@@ -494,12 +572,41 @@ e1000_send(struct netdriver_data * data, size_t size)
 	desc->length = size;
 	desc->command = E1000_TX_CMD_EOP | E1000_TX_CMD_FCS | E1000_TX_CMD_RS;
 
-	/* Increment tail.  Start transmission. */
-	e1000_reg_write(e, E1000_REG_TDT, next);
+	/* Increment tail. */
+	e->tx_tail = next;
+	e->tx_pending++;
+
+	/*
+	 * Start transmission, but ring the doorbell only for the last packet
+	 * of a burst: the tail register write is an expensive MMIO access,
+	 * and the card picks up all descriptors up to the tail in one go.
+	 */
+	if (!netdriver_send_pending()) {
+		e1000_reg_write(e, E1000_REG_TDT, e->tx_tail);
+		e->tx_pending = 0;
+	}
 
 	return OK;
 }
 
+/*
+ * Return reclaimed receive descriptors to the card by advancing the receive
+ * tail register.  Each tail register update is an expensive MMIO access, so
+ * the receive path batches reclaimed descriptors and rings the doorbell only
+ * once it has caught up with the card, covering a whole burst of received
+ * packets with a single write.
+ */
+static void
+e1000_rx_doorbell(e1000_t * e)
+{
+
+	if (e->rx_pending > 0) {
+		e1000_reg_write(e, E1000_REG_RDT, e->rx_tail);
+
+		e->rx_pending = 0;
+	}
+}
+
 /*
  * Try to receive a packet.
  */
@@ -508,40 +615,77 @@ e1000_recv(struct netdriver_data * data, size_t max)
 {
 	e1000_t *e;
 	e1000_rx_desc_t *desc;
-	unsigned int head, tail, cur;
+	unsigned int cur;
+	uint8_t errors;
 	char *ptr;
 	size_t size;
 
 	e = &e1000_state;
 
-	/* If the queue head and tail are equal, the queue is empty. */
-	head = e1000_reg_read(e, E1000_REG_RDH);
-	tail = e1000_reg_read(e, E1000_REG_RDT);
+	for (;;) {
+		/* Do not process more descriptors than the current budget
+		 * allows, so that a flood of (possibly bad) packets cannot
+		 * monopolize the driver.
+		 */
+		if (e->rx_budget == 0) {
+			e1000_rx_doorbell(e);
 
-	E1000_DEBUG(4, ("%s: head=%u, tail=%u\n",
-	    netdriver_name(), head, tail));
+			return SUSPEND;
+		}
+		e->rx_budget--;
 
-	if (head == tail)
-		return SUSPEND;
+		/*
+		 * Has a packet been received?  The card sets the Descriptor
+		 * Done bit once it has written back a descriptor, and we
+		 * clear the bit again upon reclaiming the descriptor, so
+		 * there is no need to read back the head register here.
+		 */
+		cur = (e->rx_tail + 1) % e->rx_desc_count;
+		desc = &e->rx_desc[cur];
 
-	/* Has a packet been received? */
-	cur = (tail + 1) % e->rx_desc_count;
-	desc = &e->rx_desc[cur];
+		if (!(desc->status & E1000_RX_STATUS_DONE)) {
+			e1000_rx_doorbell(e);
 
-	if (!(desc->status & E1000_RX_STATUS_DONE))
-		return SUSPEND;
+			return SUSPEND;
+		}
 
-	/*
-	 * HACK: we expect all packets to fit in a single receive buffer.
-	 * Eventually, some sort of support to deal with packets spanning
-	 * multiple receive descriptors should be added.  For now, we panic,
-	 * so that we can continue after the restart; this is already an
-	 * improvement over freezing (the old behavior of this driver).
-	 */
-	size = desc->length;
+		/*
+		 * HACK: we expect all packets to fit in a single receive
+		 * buffer.  Eventually, some sort of support to deal with
+		 * packets spanning multiple receive descriptors should be
+		 * added.  For now, we panic, so that we can continue after
+		 * the restart; this is already an improvement over freezing
+		 * (the old behavior of this driver).
+		 */
+		size = desc->length;
 
-	if (!(desc->status & E1000_RX_STATUS_EOP))
-		panic("received packet too large");
+		if (!(desc->status & E1000_RX_STATUS_EOP))
+			panic("received packet too large");
+
+		/*
+		 * With receive checksum offload enabled, lwip no longer
+		 * verifies checksums in software, so any packet that the
+		 * hardware flags as bad must be dropped right here.  The
+		 * hardware reports one result for TCP and UDP combined.
+		 */
+		errors = (desc->status & E1000_RX_STATUS_IXSM) ? 0 :
+		    desc->errors;
+
+		if (((e1000_caps & NDEV_CAP_CS_IP4_RX) &&
+		    (errors & E1000_RX_ERROR_IPE)) ||
+		    ((e1000_caps & (NDEV_CAP_CS_UDP_RX |
+		    NDEV_CAP_CS_TCP_RX)) &&
+		    (errors & E1000_RX_ERROR_TCPE))) {
+			netdriver_stat_ierror(1);
+
+			desc->status = 0;
+			e->rx_tail = cur;
+			e->rx_pending++;
+			continue;
+		}
+
+		break;
+	}
 
 	/* Copy the packet to the caller. */
 	ptr = e->rx_buffer + cur * E1000_IOBUF_SIZE;
@@ -554,8 +698,9 @@ e1000_recv(struct netdriver_data * data, size_t max)
 	/* Reset the descriptor. */
 	desc->status = 0;
 
-	/* Increment tail. */
-	e1000_reg_write(e, E1000_REG_RDT, cur);
+	/* Increment tail.  The doorbell is rung once we have caught up. */
+	e->rx_tail = cur;
+	e->rx_pending++;
 
 	/* Return the size of the received packet. */
 	return size;
@@ -609,21 +754,78 @@ e1000_intr(unsigned int __unused mask)
 
 	e = &e1000_state;
 
-	/* Reenable interrupts. */
+	/* Read, and thereby clear, the Interrupt Cause Read register. */
+	cause = e1000_reg_read(e, E1000_REG_ICR);
+
+	if (cause & E1000_REG_ICR_LSC)
+		netdriver_link();
+
+	/*
+	 * For packet work, switch to polling mode rather than reenabling the
+	 * interrupt line right away: the poll function is called from the
+	 * driver message loop until it has drained the rings, and only then
+	 * reenables the interrupt line.  This bounds the interrupt rate to
+	 * roughly one interrupt per packet burst rather than one per packet.
+	 */
+	if (cause & (E1000_REG_ICR_RXO | E1000_REG_ICR_RXT |
+	    E1000_REG_ICR_TXQE | E1000_REG_ICR_TXDW)) {
+		netdriver_poll_start();
+
+		return;
+	}
+
+	/* Nothing else to do; reenable interrupts. */
 	if (sys_irqenable(&e->irq_hook) != OK)
 		panic("failed to re-enable IRQ");
+}
 
-	/* Read the Interrupt Cause Read register. */
-	if ((cause = e1000_reg_read(e, E1000_REG_ICR)) != 0) {
-		if (cause & E1000_REG_ICR_LSC)
-			netdriver_link();
+/*
+ * Make a polling pass: with our interrupt line still masked, process up to
+ * 'budget' received packets, and reap transmitted packets.  Once the receive
+ * ring has been drained, leave polling mode and reenable the interrupt line.
+ * Any interrupt causes that have latched in the meantime will reassert the
+ * line immediately after.
+ */
+static void
+e1000_poll(unsigned int budget)
+{
+	e1000_t *e;
+	unsigned int cur;
 
-		if (cause & (E1000_REG_ICR_RXO | E1000_REG_ICR_RXT))
-			netdriver_recv();
+	e = &e1000_state;
 
-		if (cause & (E1000_REG_ICR_TXQE | E1000_REG_ICR_TXDW))
-			netdriver_send();
-	}
+	/* Reap transmitted packets, resuming suspended send requests. */
+	netdriver_send();
+
+	/* Hand up to 'budget' received packets to the TCP/IP stack. */
+	e->rx_budget = budget;
+
+	netdriver_recv();
+
+	/*
+	 * Return any reclaimed receive descriptors to the card, also if the
+	 * receive pass above stopped because it ran out of receive requests
+	 * rather than packets or budget.
+	 */
+	e1000_rx_doorbell(e);
+
+	/*
+	 * If more received packets are waiting, stay in polling mode.  We get
+	 * another pass either right away (with a larger budget) or, if we ran
+	 * out of receive requests, once the TCP/IP stack sends us new ones.
+	 */
+	cur = (e->rx_tail + 1) % e->rx_desc_count;
+
+	if (e->rx_desc[cur].status & E1000_RX_STATUS_DONE)
+		return;
+
+	/* All caught up; return to interrupt-driven operation. */
+	e->rx_budget = e->rx_desc_count;
+
+	netdriver_poll_stop();
+
+	if (sys_irqenable(&e->irq_hook) != OK)
+		panic("failed to re-enable IRQ");
 }
 
 /*
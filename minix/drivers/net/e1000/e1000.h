@@ -25,12 +25,18 @@
  * @{
  */
 
-/** Number of receive descriptors per card. */
+/** Default number of receive descriptors per card. */
 #define E1000_RXDESC_NR 256
 
-/** Number of transmit descriptors per card. */
+/** Default number of transmit descriptors per card. */
 #define E1000_TXDESC_NR 256
 
+/** Minimum number of descriptors per ring. */
+#define E1000_NDESC_MIN 64
+
+/** Maximum number of descriptors per ring. */
+#define E1000_NDESC_MAX 4096
+
 /** Size of each I/O buffer per descriptor. */
 #define E1000_IOBUF_SIZE 2048
 
@@ -126,11 +132,19 @@ typedef struct e1000
     int rx_desc_count;		  /**< Number of Receive Descriptors. */
     char *rx_buffer;		  /**< Receive buffer returned by malloc(). */
     int rx_buffer_size;		  /**< Size of the receive buffer. */
+    unsigned int rx_budget;	  /**< Receive descriptor processing budget. */
+    unsigned int rx_tail;	  /**< Last receive descriptor reclaimed. */
+    unsigned int rx_pending;	  /**< Reclaimed descriptors not yet given
+				       back to the card through RDT. */
 
     e1000_tx_desc_t *tx_desc;	  /**< Transmit Descriptor table. */
     int tx_desc_count;		  /**< Number of Transmit Descriptors. */
     char *tx_buffer;		  /**< Transmit buffer returned by malloc(). */
     int tx_buffer_size;		  /**< Size of the transmit buffer. */
+    unsigned int tx_head;	  /**< Software copy of the transmit head. */
+    unsigned int tx_tail;	  /**< Software copy of the transmit tail. */
+    unsigned int tx_pending;	  /**< Descriptors queued but not yet made
+				       visible to the card through TDT. */
 } e1000_t;
 
 #endif /* __E1000_H */
@@ -120,8 +120,11 @@ union ich8_hws_flash_regacc
  */
 
 /** Passed In-exact Filter. */
-#define E1000_RX_STATUS_PIF	(1 << 7) 
- 
+#define E1000_RX_STATUS_PIF	(1 << 7)
+
+/** Ignore Checksum Indication. */
+#define E1000_RX_STATUS_IXSM	(1 << 2)
+
 /** End of Packet. */
 #define E1000_RX_STATUS_EOP	(1 << 1)
 
@@ -140,6 +143,12 @@ union ich8_hws_flash_regacc
 /** RX Data Error. */
 #define E1000_RX_ERROR_RXE	(1 << 7)
 
+/** IPv4 Checksum Error. */
+#define E1000_RX_ERROR_IPE	(1 << 6)
+
+/** TCP/UDP Checksum Error. */
+#define E1000_RX_ERROR_TCPE	(1 << 5)
+
 /** Carrier Extension Error. */
 #define E1000_RX_ERROR_CXE	(1 << 4)
 
@@ -167,6 +176,18 @@ union ich8_hws_flash_regacc
 /** Report Status. */
 #define E1000_TX_CMD_RS		(1 << 3)
 
+/**
+ * @}
+ */
+
+/**
+ * @name Transmit Status Field Bits.
+ * @{
+ */
+
+/** Descriptor Done. */
+#define E1000_TX_STATUS_DONE	(1 << 0)
+
 /**
  * @}
  */
@@ -104,6 +104,9 @@
 /** Total Packets Transmitted. */
 #define E1000_REG_TPT		0x040D4
 
+/** Receive Checksum Control. */
+#define E1000_REG_RXCSUM	0x05000
+
 /** Receive Address Low. */
 #define E1000_REG_RAL		0x05400
 
@@ -262,6 +265,21 @@
 /** Receive Buffer Size. */
 #define E1000_REG_RCTL_BSIZE	((1 << 16) | (1 << 17))
 
+/**
+ * @}
+ */
+
+/**
+ * @name Receive Checksum Control Register Bits.
+ * @{
+ */
+
+/** IPv4 Checksum Offload Enable. */
+#define E1000_REG_RXCSUM_IPOFL	(1 << 8)
+
+/** TCP/UDP Checksum Offload Enable. */
+#define E1000_REG_RXCSUM_TUOFL	(1 << 9)
+
 /**
  * @}
  */
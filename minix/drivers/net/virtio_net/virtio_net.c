@@ -217,6 +217,7 @@ virtio_net_refill_rx_queue(void)
 {
 	struct vumap_phys phys[2];
 	struct packet *p;
+	int added = 0;
 
 	while ((in_rx < BUF_PACKETS / 2) && !STAILQ_EMPTY(&free_list)) {
 		/* peek */
@@ -236,10 +237,15 @@ virtio_net_refill_rx_queue(void)
 		phys[0].vp_addr |= 1;
 		phys[1].vp_addr |= 1;
 
-		virtio_to_queue(net_dev, RX_Q, phys, 2, p);
+		/* Add to the queue, but notify the host only once below */
+		virtio_to_queue_defer(net_dev, RX_Q, phys, 2, p);
+		added++;
 		in_rx++;
 	}
 
+	if (added > 0)
+		virtio_queue_kick(net_dev, RX_Q);
+
 	if (in_rx == 0 && STAILQ_EMPTY(&free_list))
 		dput(("warning: rx queue underflow!"));
 }
@@ -246,6 +246,7 @@ static int ahci_ioctl(devminor_t minor, unsigned long request,
 	endpoint_t endpt, cp_grant_id_t grant, endpoint_t user_endpt);
 static void ahci_intr(unsigned int mask);
 static int ahci_device(devminor_t minor, device_id_t *id);
+static int ahci_discard(devminor_t minor, u64_t position, size_t size);
 static struct port_state *ahci_get_port(devminor_t minor);
 
 /* AHCI driver table. */
@@ -258,7 +259,8 @@ static struct blockdriver ahci_dtab = {
 	.bdr_part	= ahci_part,
 	.bdr_intr	= ahci_intr,
 	.bdr_alarm	= ahci_alarm,
-	.bdr_device	= ahci_device
+	.bdr_device	= ahci_device,
+	.bdr_discard	= ahci_discard
 };
 
 /*===========================================================================*
@@ -597,6 +599,12 @@ static int ata_id_check(struct port_state *ps, u16_t *buf)
 		(ATA_ID_ENA2_VALID | ATA_ID_ENA2_FUA))
 		ps->flags |= FLAG_HAS_FUA;
 
+	/* Check whether the device supports the DATA SET MANAGEMENT command
+	 * with the TRIM bit set, for discard requests.
+	 */
+	if (buf[ATA_ID_DSM] & ATA_ID_DSM_TRIM)
+		ps->flags |= FLAG_HAS_TRIM;
+
 	return TRUE;
 }
 
@@ -650,6 +658,65 @@ static int ata_transfer(struct port_state *ps, int cmd, u64_t start_lba,
 	return port_exec(ps, cmd, ahci_transfer_timeout);
 }
 
+/*===========================================================================*
+ *				ata_trim				     *
+ *===========================================================================*/
+static int ata_trim(struct port_state *ps, u64_t start_lba, u64_t count)
+{
+	/* Tell an ATA device that the given range of sectors no longer
+	 * contains data that must be preserved, using the DATA SET MANAGEMENT
+	 * command with the TRIM bit set. The temporary buffer is used to
+	 * construct 512-byte blocks of LBA range entries, each entry covering
+	 * at most ATA_DSM_RANGE_SECTORS sectors. Each block is sent as a
+	 * separate command, since one block covers well over a terabyte.
+	 */
+	cmd_fis_t fis;
+	prd_t prd;
+	u64_t *entry;
+	unsigned int i, chunk;
+	int r;
+
+	assert(ps->flags & FLAG_HAS_TRIM);
+
+	while (count > 0) {
+		/* Fill one block of range entries. */
+		entry = (u64_t *) ps->tmp_base;
+
+		for (i = 0; i < ATA_DSM_NR_RANGES && count > 0; i++) {
+			chunk = MIN(count, ATA_DSM_RANGE_SECTORS);
+
+			*entry++ = ((u64_t) chunk << 48) | start_lba;
+
+			start_lba += chunk;
+			count -= chunk;
+		}
+
+		/* Zero out the rest of the block; zeroed entries are to be
+		 * ignored by the device.
+		 */
+		memset(entry, 0, (ATA_DSM_NR_RANGES - i) * sizeof(*entry));
+
+		/* Set up a command. */
+		memset(&fis, 0, sizeof(fis));
+		fis.cf_cmd = ATA_CMD_DATA_SET_MANAGEMENT;
+		fis.cf_feat = ATA_DSM_TRIM;
+		fis.cf_dev = ATA_DEV_LBA;
+		fis.cf_sec = 1;		/* one block of range entries */
+
+		prd.vp_addr = ps->tmp_phys;
+		prd.vp_size = ATA_SECTOR_SIZE;
+
+		/* Start the command, and wait for it to complete or fail. */
+		port_set_cmd(ps, 0, &fis, NULL /*packet*/, &prd, 1,
+			TRUE /*write*/);
+
+		if ((r = port_exec(ps, 0, ahci_transfer_timeout)) != OK)
+			return r;
+	}
+
+	return OK;
+}
+
 /*===========================================================================*
  *				gen_identify				     *
  *===========================================================================*/
@@ -2681,6 +2748,47 @@ static int ahci_ioctl(devminor_t minor, unsigned long request,
 	return ENOTTY;
 }
 
+/*===========================================================================*
+ *				ahci_discard				     *
+ *===========================================================================*/
+static int ahci_discard(devminor_t minor, u64_t position, size_t size)
+{
+	/* Discard a range of data on the selected device.
+	 */
+	struct port_state *ps;
+	struct device *dv;
+	u64_t start_lba, end_lba;
+
+	ps = ahci_get_port(minor);
+	dv = ahci_part(minor);
+
+	if (ps->state != STATE_GOOD_DEV || (ps->flags & FLAG_BARRIER))
+		return EIO;
+
+	/* Only ATA devices with TRIM support can discard data. */
+	if ((ps->flags & FLAG_ATAPI) || !(ps->flags & FLAG_HAS_TRIM))
+		return ENOTSUP;
+
+	/* Bound the byte range to the partition. */
+	if (position >= dv->dv_size)
+		return OK;
+
+	if (size > dv->dv_size - position)
+		size = dv->dv_size - position;
+
+	/* Reduce the range to whole sectors. Discarding is advisory, so
+	 * telling the device about less than requested is always safe.
+	 */
+	start_lba = (dv->dv_base + position + ps->sector_size - 1) /
+		ps->sector_size;
+	end_lba = (dv->dv_base + position + size) / ps->sector_size;
+
+	if (start_lba >= end_lba)
+		return OK;
+
+	return ata_trim(ps, start_lba, end_lba - start_lba);
+}
+
 /*===========================================================================*
  *				ahci_device				     *
  *===========================================================================*/
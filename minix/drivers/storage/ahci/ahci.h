@@ -30,6 +30,7 @@
 #define ATA_H2D_FLAGS			1	/* C and PM Port */
 #define 	ATA_H2D_FLAGS_C		0x80	/* update command register */
 #define ATA_H2D_CMD			2	/* Command */
+#define 	ATA_CMD_DATA_SET_MANAGEMENT	0x06	/* DATA SET MANAGEMENT */
 #define 	ATA_CMD_READ_DMA_EXT	0x25	/* READ DMA EXT */
 #define 	ATA_CMD_WRITE_DMA_EXT	0x35	/* WRITE DMA EXT */
 #define 	ATA_CMD_READ_FPDMA_QUEUED	0x60	/* READ FPDMA QUEUED */
@@ -66,6 +67,11 @@
 #define ATA_SECTOR_SIZE		512		/* default sector size */
 #define ATA_MAX_SECTORS		0x10000		/* max sectors per transfer */
 
+/* DATA SET MANAGEMENT (TRIM) constants. */
+#define ATA_DSM_TRIM		0x01		/* TRIM bit in features field */
+#define ATA_DSM_NR_RANGES	64		/* LBA ranges per 512-b block */
+#define ATA_DSM_RANGE_SECTORS	0xFFFF		/* max sectors per LBA range */
+
 #define ATA_ID_SIZE	(256 * sizeof(u16_t))	/* IDENTIFY result size */
 
 #define ATA_ID_GCAP		0		/* General capabililties */
@@ -110,6 +116,8 @@
 #define ATA_ID_PLSS_LLS		0x1000		/* Long logical sectors */
 #define ATA_ID_LSS0		118		/* Logical sector size (LSW) */
 #define ATA_ID_LSS1		119		/* Logical sector size (MSW) */
+#define ATA_ID_DSM		169		/* DATA SET MANAGEMENT support */
+#define ATA_ID_DSM_TRIM		0x0001		/* TRIM supported */
 
 #define ATA_SF_EN_WCACHE	0x02		/* Enable write cache */
 #define ATA_SF_DI_WCACHE	0x82		/* Disable write cache */
@@ -297,6 +305,7 @@ enum {
 #define FLAG_HAS_FUA		0x00000400	/* is WRITE DMA FUA EX sup.? */
 #define FLAG_HAS_NCQ		0x00000800	/* is NCQ supported? */
 #define FLAG_NCQ_MODE		0x00001000	/* issuing NCQ commands? */
+#define FLAG_HAS_TRIM		0x00002000	/* is DSM TRIM supported? */
 
 /* Mapping between devices and ports. */
 #define NO_PORT		-1	/* this device maps to no port */
@@ -169,6 +169,9 @@ int main(int argc, char *argv[])
   env_setargs(argc, argv);
   sef_local_startup();
 
+  /* Spinning disks benefit from position-sorted request dispatch. */
+  blockdriver_set_scheduler(BLOCKDRIVER_SCHED_ELEVATOR);
+
   /* Call the generic receive loop. */
   blockdriver_task(&w_dtab);
 
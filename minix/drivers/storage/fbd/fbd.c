@@ -7,6 +7,7 @@
 #include <sys/ioc_fbd.h>
 #include <minix/ds.h>
 #include <minix/optset.h>
+#include <minix/minlib.h>
 #include <assert.h>
 
 #include "rule.h"
@@ -29,6 +30,9 @@ static char driver_label[32] = "";	/* driver DS label */
 static devminor_t driver_minor = -1;	/* driver's partition minor to use */
 static endpoint_t driver_endpt;		/* driver endpoint */
 
+static struct fbd_stats stats;		/* latency statistics */
+static u64_t stats_drv_tsc;		/* driver round trip of last transfer */
+
 /* Entry points to this driver. */
 static struct blockdriver fbd_dtab = {
 	.bdr_type	= BLOCKDRIVER_TYPE_OTHER,/* do not handle part. reqs */
@@ -198,6 +202,15 @@ static int fbd_ioctl(devminor_t UNUSED(minor), unsigned long request,
 	case FBDCDELRULE:
 	case FBDCGETRULE:
 		return rule_ctl(request, endpt, grant);
+
+	case FBDCGETSTATS:
+		return sys_safecopyto(endpt, grant, 0, (vir_bytes) &stats,
+			sizeof(stats));
+
+	case FBDCRESETSTATS:
+		memset(&stats, 0, sizeof(stats));
+
+		return OK;
 	}
 
 	assert(grant != GRANT_INVALID);
@@ -224,6 +237,30 @@ static int fbd_ioctl(devminor_t UNUSED(minor), unsigned long request,
 	return m.m_lblockdriver_lbdev_reply.status;
 }
 
+/*===========================================================================*
+ *				fbd_sendrec				     *
+ *===========================================================================*/
+static void fbd_sendrec(message *m_ptr)
+{
+	/* Forward a transfer request to the underlying driver, timing the
+	 * round trip for the latency statistics.
+	 */
+	u64_t before, after;
+	int r;
+
+	read_tsc_64(&before);
+
+	if ((r = ipc_sendrec(driver_endpt, m_ptr)) != OK)
+		panic("ipc_sendrec to driver failed (%d)\n", r);
+
+	read_tsc_64(&after);
+
+	stats_drv_tsc = after - before;
+
+	if (m_ptr->m_type != BDEV_REPLY)
+		panic("invalid reply from driver (%d)\n", m_ptr->m_type);
+}
+
 /*===========================================================================*
  *				fbd_transfer_direct			     *
  *===========================================================================*/
@@ -234,7 +271,7 @@ static ssize_t fbd_transfer_direct(int do_write, u64_t position,
 	iovec_s_t iovec[NR_IOREQS];
 	cp_grant_id_t grant;
 	message m;
-	int i, r;
+	int i;
 
 	for (i = 0; i < count; i++) {
 		iovec[i].iov_size = iov[i].iov_size;
@@ -255,11 +292,7 @@ static ssize_t fbd_transfer_direct(int do_write, u64_t position,
 	m.m_lbdev_lblockdriver_msg.id = 0;
 	m.m_lbdev_lblockdriver_msg.pos = position;
 
-	if ((r = ipc_sendrec(driver_endpt, &m)) != OK)
-		panic("ipc_sendrec to driver failed (%d)\n", r);
-
-	if (m.m_type != BDEV_REPLY)
-		panic("invalid reply from driver (%d)\n", m.m_type);
+	fbd_sendrec(&m);
 
 	cpf_revoke(grant);
 
@@ -347,11 +380,7 @@ static ssize_t fbd_transfer_copy(int do_write, u64_t position,
 	m.m_lbdev_lblockdriver_msg.id = 0;
 	m.m_lbdev_lblockdriver_msg.pos = position;
 
-	if ((r = ipc_sendrec(driver_endpt, &m)) != OK)
-		panic("ipc_sendrec to driver failed (%d)\n", r);
-
-	if (m.m_type != BDEV_REPLY)
-		panic("invalid reply from driver (%d)\n", m.m_type);
+	fbd_sendrec(&m);
 
 	cpf_revoke(grant);
 
@@ -390,6 +419,52 @@ static ssize_t fbd_transfer_copy(int do_write, u64_t position,
 	return m.m_lblockdriver_lbdev_reply.status;
 }
 
+/*===========================================================================*
+ *				stats_record				     *
+ *===========================================================================*/
+static void stats_record(int do_write, size_t size, u64_t start_tsc)
+{
+	/* Account one completed transfer request in the latency statistics.
+	 * The driver round-trip time was measured around the forwarded
+	 * request by fbd_sendrec(); whatever remains of the total time was
+	 * spent in this driver, on copying, grants and injection hooks.
+	 */
+	struct fbd_opstats *op;
+	u64_t now, val;
+	u32_t total, drv;
+	int b;
+
+	read_tsc_64(&now);
+
+	total = tsc_64_to_micros(now - start_tsc);
+	drv = tsc_64_to_micros(stats_drv_tsc);
+	if (drv > total) drv = total;
+
+	stats.overhead += total - drv;
+
+	/* If no request went out to the underlying driver at all (a pre-hook
+	 * swallowed the request), there is no round trip to account.
+	 */
+	if (stats_drv_tsc == 0) return;
+
+	op = do_write ? &stats.write : &stats.read;
+
+	if (op->count == 0 || drv < op->lat_min) op->lat_min = drv;
+	if (drv > op->lat_max) op->lat_max = drv;
+	op->count++;
+	op->lat_sum += drv;
+
+	for (b = 0, val = drv; val >= 2 && b < FBD_LAT_BUCKETS - 1; b++)
+		val >>= 1;
+	op->lat_hist[b]++;
+
+	for (b = 0, val = size / 512; val >= 2 && b < FBD_SIZE_BUCKETS - 1;
+			b++)
+		val >>= 1;
+	op->size_count[b]++;
+	op->size_lat[b] += drv;
+}
+
 /*===========================================================================*
  *				fbd_transfer				     *
  *===========================================================================*/
@@ -401,6 +476,10 @@ static int fbd_transfer(devminor_t UNUSED(minor), int do_write, u64_t position,
 	size_t size, osize;
 	int i, hooks;
 	ssize_t r;
+	u64_t tsc;
+
+	read_tsc_64(&tsc);
+	stats_drv_tsc = 0;
 
 	/* Compute the total size of the request. */
 	for (size = i = 0; i < nr_req; i++)
@@ -434,6 +513,8 @@ static int fbd_transfer(devminor_t UNUSED(minor), int do_write, u64_t position,
 	if (hooks & POST_HOOK)
 		rule_post_hook(osize, &r);
 
+	stats_record(do_write, osize, tsc);
+
 #if DEBUG
 	printf("FBD: returning %d\n", r);
 #endif
@@ -13,6 +13,10 @@ static u64_t disk_size;
 
 static int problem_stats[BD_LAST] = { 0 };
 
+/* Read balancing. */
+static int read_turn = DRIVER_MAIN;
+static unsigned long read_stats[2] = { 0, 0 };
+
 /*===========================================================================*
  *				driver_open				     *
  *===========================================================================*/
@@ -203,6 +207,8 @@ void driver_shutdown(void)
 	printf("Filter: %u driver deaths, %u protocol errors, "
 		"%u data errors\n", problem_stats[BD_DEAD],
 		problem_stats[BD_PROTO], problem_stats[BD_DATA]);
+	printf("Filter: reads served: %lu by main disk, %lu by backup disk\n",
+		read_stats[DRIVER_MAIN], read_stats[DRIVER_BACKUP]);
 #endif
 
 	if(driver_close(DRIVER_MAIN) != OK)
@@ -751,24 +757,25 @@ static int do_sendrec_both(message *m1, message *m2)
 /*===========================================================================*
  *				do_sendrec_one				     *
  *===========================================================================*/
-static int do_sendrec_one(message *m1)
+static int do_sendrec_one(message *m1, int which)
 {
-	/* Only talk to the main driver. If something goes wrong, it will
+	/* Only talk to the given driver. If something goes wrong, it will
 	 * be fixed elsewhere.
 	 * This function will only return either OK or RET_REDO.
 	 */
 
-    	return flt_sendrec(m1, DRIVER_MAIN);
+    	return flt_sendrec(m1, which);
 }
 
 /*===========================================================================*
  *				paired_sendrec				     *
  *===========================================================================*/
-static int paired_sendrec(message *m1, message *m2, int both)
+static int paired_sendrec(message *m1, message *m2, int both, int which)
 {
 	/* Sendrec with the disk driver. If the disk driver is down, and was
 	 * restarted, redo the request, until the driver works fine, or can't
-	 * be restarted again.
+	 * be restarted again. If 'both' is not set, 'which' identifies the
+	 * single driver to talk to.
 	 */
 	int r;
 
@@ -781,7 +788,7 @@ static int paired_sendrec(message *m1, message *m2, int both)
 	if (both)
 		r = do_sendrec_both(m1, m2);
 	else
-		r = do_sendrec_one(m1);
+		r = do_sendrec_one(m1, which);
 
 #if DEBUG2
 	if (r != OK)
@@ -842,17 +849,21 @@ static int single_grant(endpoint_t endpt, vir_bytes buf, int access,
  *===========================================================================*/
 static int paired_grant(char *buf1, char *buf2, int request,
 	cp_grant_id_t *gids, iovec_s_t vectors[2][NR_IOREQS], size_t size,
-	int both)
+	int both, int which)
 {
-	/* Create memory grants, either to one or to both drivers.
+	/* Create memory grants, either to the given single driver or to both
+	 * drivers.
 	 */
 	int count, access;
 
 	count = 0;
 	access = (request == FLT_WRITE) ? CPF_READ : CPF_WRITE;
 
-	if(driver[DRIVER_MAIN].endpt > 0) {
-		count = single_grant(driver[DRIVER_MAIN].endpt,
+	if (both)
+		which = DRIVER_MAIN;
+
+	if(driver[which].endpt > 0) {
+		count = single_grant(driver[which].endpt,
 			(vir_bytes) buf1, access, &gids[0], vectors[0], size);
 	}
 
@@ -908,16 +919,55 @@ int read_write(u64_t pos, char *bufa, char *bufb, size_t *sizep, int request)
 	iovec_s_t vectors[2][NR_IOREQS];
 	message m1, m2;
 	cp_grant_id_t gids[2];
-	int r, both, count;
+	int r, both, split, which, count, count2;
+	size_t size1, size2;
 
 	gids[0] = gids[1] = GRANT_INVALID;
+	split = 0;
+	which = DRIVER_MAIN;
+	size1 = *sizep;
+	size2 = 0;
 
 	/* Send two requests only if mirroring is enabled and the given request
 	 * is either FLT_READ2 or FLT_WRITE.
 	 */
 	both = (USE_MIRROR && request != FLT_READ);
 
-	count = paired_grant(bufa, bufb, request, gids, vectors, *sizep, both);
+	/* Balance single reads across the mirror pair. Reads of at least
+	 * READ_SPLIT bytes are split in two halves, each served by one of the
+	 * disks in parallel; smaller reads are sent to the two disks in turn.
+	 * Reads are never split across the disk end, so that a truncated
+	 * reply to either half can be treated as a driver error below.
+	 * Checksumming reads are excluded from balancing, because checksum
+	 * failures are always attributed to the main disk.
+	 */
+	if (USE_MIRROR && !USE_CHECKSUM && request == FLT_READ &&
+			driver[DRIVER_BACKUP].endpt > 0) {
+		if (READ_SPLIT > 0 && *sizep >= (size_t) READ_SPLIT &&
+				*sizep >= 2 * SECTOR_SIZE &&
+				pos + *sizep <= disk_size) {
+			split = 1;
+			both = 1;
+			size1 = (*sizep / SECTOR_SIZE / 2) * SECTOR_SIZE;
+			size2 = *sizep - size1;
+		} else {
+			which = read_turn;
+			read_turn = (read_turn == DRIVER_MAIN) ?
+				DRIVER_BACKUP : DRIVER_MAIN;
+		}
+	}
+
+	if (split) {
+		count = single_grant(driver[DRIVER_MAIN].endpt,
+			(vir_bytes) bufa, CPF_WRITE, &gids[0], vectors[0],
+			size1);
+		count2 = single_grant(driver[DRIVER_BACKUP].endpt,
+			(vir_bytes) bufa + size1, CPF_WRITE, &gids[1],
+			vectors[1], size2);
+	} else {
+		count = count2 = paired_grant(bufa, bufb, request, gids,
+			vectors, size1, both, which);
+	}
 
 	memset(&m1, 0, sizeof(m1));
 	m1.m_type = (request == FLT_WRITE) ? BDEV_SCATTER : BDEV_GATHER;
@@ -928,10 +978,23 @@ int read_write(u64_t pos, char *bufa, char *bufb, size_t *sizep, int request)
 
 	m1.m_lbdev_lblockdriver_msg.grant = gids[0];
 	m2.m_lbdev_lblockdriver_msg.grant = gids[1];
+	m2.m_lbdev_lblockdriver_msg.count = count2;
+	if (split)
+		m2.m_lbdev_lblockdriver_msg.pos = pos + size1;
+
+	if (request != FLT_WRITE) {
+		read_stats[both ? DRIVER_MAIN : which]++;
+		if (both)
+			read_stats[DRIVER_BACKUP]++;
+	}
 
-	r = paired_sendrec(&m1, &m2, both);
+	r = paired_sendrec(&m1, &m2, both, which);
 
-	paired_revoke(gids, vectors, count, both);
+	if (split) {
+		single_revoke(gids[0], vectors[0], count);
+		single_revoke(gids[1], vectors[1], count2);
+	} else
+		paired_revoke(gids, vectors, count, both);
 
 	if(r != OK) {
 #if DEBUG
@@ -941,28 +1004,35 @@ int read_write(u64_t pos, char *bufa, char *bufb, size_t *sizep, int request)
 		return r;
 	}
 
+	/* The first reply came from the main disk, unless this was an
+	 * unsplit read served by the other disk.
+	 */
+	if (both)
+		which = DRIVER_MAIN;
+
 	if (m1.m_type != BDEV_REPLY ||
 		m1.m_lblockdriver_lbdev_reply.status < 0) {
-		printf("Filter: unexpected/invalid reply from main driver: "
-			"(%x, %d)\n", m1.m_type,
+		printf("Filter: unexpected/invalid reply from driver %d: "
+			"(%x, %d)\n", which, m1.m_type,
 			m1.m_lblockdriver_lbdev_reply.status);
 
-		return bad_driver(DRIVER_MAIN, BD_PROTO,
+		return bad_driver(which, BD_PROTO,
 			(m1.m_type == BDEV_REPLY) ?
 			m1.m_lblockdriver_lbdev_reply.status : EFAULT);
 	}
 
-	if (m1.m_lblockdriver_lbdev_reply.status != (ssize_t) *sizep) {
-		printf("Filter: truncated reply from main driver\n");
+	if (m1.m_lblockdriver_lbdev_reply.status != (ssize_t) size1) {
+		printf("Filter: truncated reply from driver %d\n", which);
 
 		/* If the driver returned a value *larger* than we requested,
 		 * OR if we did NOT exceed the disk size, then we should
-		 * report the driver for acting strangely!
+		 * report the driver for acting strangely! Note that for split
+		 * reads, the latter condition always holds.
 		 */
-		if (m1.m_lblockdriver_lbdev_reply.status > (ssize_t) *sizep ||
+		if (m1.m_lblockdriver_lbdev_reply.status > (ssize_t) size1 ||
 			(pos + (unsigned int)
 			    m1.m_lblockdriver_lbdev_reply.status < disk_size))
-			return bad_driver(DRIVER_MAIN, BD_PROTO, EFAULT);
+			return bad_driver(which, BD_PROTO, EFAULT);
 
 		/* Return the actual size. */
 		*sizep = m1.m_lblockdriver_lbdev_reply.status;
@@ -981,12 +1051,15 @@ int read_write(u64_t pos, char *bufa, char *bufb, size_t *sizep, int request)
 				m2.m_lblockdriver_lbdev_reply.status :
 				EFAULT);
 		}
-		if (m2.m_lblockdriver_lbdev_reply.status != (ssize_t) *sizep) {
+		if (m2.m_lblockdriver_lbdev_reply.status !=
+			(ssize_t) (split ? size2 : size1)) {
 			printf("Filter: truncated reply from backup driver\n");
 
 			/* As above */
-			if (m2.m_lblockdriver_lbdev_reply.status > (ssize_t) *sizep ||
-					(pos + (unsigned int)
+			if (m2.m_lblockdriver_lbdev_reply.status >
+				(ssize_t) (split ? size2 : size1) ||
+					((split ? pos + size1 : pos) +
+					 (unsigned int)
 					 m2.m_lblockdriver_lbdev_reply.status
 						< disk_size))
 				return bad_driver(DRIVER_BACKUP, BD_PROTO,
@@ -92,6 +92,7 @@ extern int NR_RETRIES;
 extern int NR_RESTARTS;
 extern int DRIVER_TIMEOUT;
 extern int CHUNK_SIZE;
+extern int READ_SPLIT;
 
 extern char MAIN_LABEL[LABEL_SIZE];
 extern char BACKUP_LABEL[LABEL_SIZE];
@@ -30,6 +30,10 @@ int DRIVER_TIMEOUT = 5;	/* timeout in seconds to declare a driver dead (T) */
 
 int CHUNK_SIZE = 0;	/* driver requests will be vectorized at this size */
 
+int READ_SPLIT = 128 * 1024;	/* mirrored reads of at least this many bytes
+				 * are split across the two disks (0 = never)
+				 */
+
 char MAIN_LABEL[LABEL_SIZE] = "";		/* main disk driver label */
 char BACKUP_LABEL[LABEL_SIZE] = "";		/* backup disk driver label */
 int MAIN_MINOR = -1;				/* main partition minor nr */
@@ -60,6 +64,7 @@ static struct optset optset_table[] = {
   { "timeout",	OPT_INT,	&DRIVER_TIMEOUT,	10		},
   { "T",	OPT_INT,	&DRIVER_TIMEOUT,	10		},
   { "chunk",	OPT_INT,	&CHUNK_SIZE,		10		},
+  { "split",	OPT_INT,	&READ_SPLIT,		10		},
   { NULL,	0,		NULL,			0		}
 };
 
@@ -7,3 +7,9 @@ extern unsigned char _binary_imgrd_mfs_start, _binary_imgrd_mfs_end;
 #define	imgrd	&_binary_imgrd_mfs_start
 #define	imgrd_size \
 	(((size_t) &_binary_imgrd_mfs_end - (size_t)&_binary_imgrd_mfs_start))
+
+/* lz.c */
+size_t lz_compress(const unsigned char *src, size_t slen, unsigned char *dst,
+	size_t dmax);
+ssize_t lz_decompress(const unsigned char *src, size_t slen,
+	unsigned char *dst, size_t dmax);
@@ -0,0 +1,197 @@
+/* Small LZ77 compressor and decompressor for the compressed RAM disk
+ * (/dev/zram). The format is byte oriented, in the style of LZ4, trading
+ * some compression ratio for speed and simplicity:
+ *
+ * The compressed stream is a series of sequences. Each sequence starts with
+ * a token byte: the high nibble is the number of literal bytes that follow,
+ * the low nibble is the match length minus LZ_MIN_MATCH. A nibble value of
+ * 15 means the length continues in subsequent bytes, each adding 0..255,
+ * where a byte less than 255 terminates the length. After the literals
+ * comes a two-byte little-endian match offset (1..65535), pointing back
+ * into the output produced so far, followed by any match length extension
+ * bytes. The last sequence of a stream consists of literals only: the
+ * stream simply ends after them, with no offset.
+ *
+ * The compressor uses a single-probe hash table over four-byte prefixes,
+ * and gives up as soon as the output would grow beyond the given limit, at
+ * which point the caller stores the data uncompressed instead.
+ */
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "local.h"
+
+#define LZ_MIN_MATCH	4		/* minimum (and implied) match length */
+#define LZ_MAX_OFFSET	65535		/* maximum match offset */
+#define LZ_HASH_LOG	12
+#define LZ_HASH_SIZE	(1 << LZ_HASH_LOG)
+
+static unsigned int
+lz_hash(const unsigned char *p)
+{
+	uint32_t v;
+
+	v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+	    ((uint32_t)p[3] << 24);
+
+	return (v * 2654435761U) >> (32 - LZ_HASH_LOG);
+}
+
+/*
+ * Append one sequence to the output. Return 1 on success, or 0 if the
+ * output limit would be exceeded. A match length of zero denotes the final,
+ * literals-only sequence.
+ */
+static int
+lz_emit(unsigned char *dst, size_t dmax, size_t *opp, const unsigned char *lit,
+	size_t litlen, size_t offset, size_t mlen)
+{
+	size_t op = *opp, rest;
+	unsigned char *tok;
+
+	if (op >= dmax) return 0;
+	tok = &dst[op++];
+	*tok = 0;
+
+	if (litlen >= 15) {
+		*tok |= 0xf0;
+		for (rest = litlen - 15; rest >= 255; rest -= 255) {
+			if (op >= dmax) return 0;
+			dst[op++] = 255;
+		}
+		if (op >= dmax) return 0;
+		dst[op++] = rest;
+	} else
+		*tok |= litlen << 4;
+
+	if (op + litlen > dmax) return 0;
+	memcpy(dst + op, lit, litlen);
+	op += litlen;
+
+	if (mlen > 0) {
+		if (op + 2 > dmax) return 0;
+		dst[op++] = offset & 0xff;
+		dst[op++] = (offset >> 8) & 0xff;
+
+		if (mlen - LZ_MIN_MATCH >= 15) {
+			*tok |= 0x0f;
+			for (rest = mlen - LZ_MIN_MATCH - 15; rest >= 255;
+			    rest -= 255) {
+				if (op >= dmax) return 0;
+				dst[op++] = 255;
+			}
+			if (op >= dmax) return 0;
+			dst[op++] = rest;
+		} else
+			*tok |= mlen - LZ_MIN_MATCH;
+	}
+
+	*opp = op;
+	return 1;
+}
+
+/*
+ * Compress 'slen' bytes into a buffer of 'dmax' bytes. Return the number of
+ * compressed bytes, or 0 if the data does not fit within 'dmax'.
+ */
+size_t
+lz_compress(const unsigned char *src, size_t slen, unsigned char *dst,
+	size_t dmax)
+{
+	static uint16_t htab[LZ_HASH_SIZE];	/* position + 1; 0 is empty */
+	size_t ip = 0, anchor = 0, op = 0;
+	size_t ref, offset, mlen;
+	unsigned int h;
+
+	memset(htab, 0, sizeof(htab));
+
+	while (slen >= LZ_MIN_MATCH && ip <= slen - LZ_MIN_MATCH) {
+		h = lz_hash(src + ip);
+		ref = htab[h];
+		htab[h] = (uint16_t)(ip + 1);
+
+		if (ref == 0 || memcmp(src + ref - 1, src + ip,
+		    LZ_MIN_MATCH) != 0 || ip - (ref - 1) > LZ_MAX_OFFSET) {
+			ip++;
+			continue;
+		}
+
+		ref--;
+		offset = ip - ref;
+
+		mlen = LZ_MIN_MATCH;
+		while (ip + mlen < slen && src[ref + mlen] == src[ip + mlen])
+			mlen++;
+
+		if (!lz_emit(dst, dmax, &op, src + anchor, ip - anchor,
+		    offset, mlen))
+			return 0;
+
+		ip += mlen;
+		anchor = ip;
+	}
+
+	/* The final sequence holds the remaining literals, and no match. */
+	if (!lz_emit(dst, dmax, &op, src + anchor, slen - anchor, 0, 0))
+		return 0;
+
+	return op;
+}
+
+/*
+ * Decompress 'slen' bytes into a buffer of 'dmax' bytes. Return the number
+ * of decompressed bytes, or -1 if the input is corrupt.
+ */
+ssize_t
+lz_decompress(const unsigned char *src, size_t slen, unsigned char *dst,
+	size_t dmax)
+{
+	size_t ip = 0, op = 0;
+	size_t lit, mlen, offset, i;
+	unsigned int tok, b;
+
+	while (ip < slen) {
+		tok = src[ip++];
+
+		lit = tok >> 4;
+		if (lit == 15) {
+			do {
+				if (ip >= slen) return -1;
+				b = src[ip++];
+				lit += b;
+			} while (b == 255);
+		}
+
+		if (ip + lit > slen || op + lit > dmax) return -1;
+		memcpy(dst + op, src + ip, lit);
+		ip += lit;
+		op += lit;
+
+		if (ip == slen) break;	/* final, literals-only sequence */
+
+		if (ip + 2 > slen) return -1;
+		offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op) return -1;
+
+		mlen = tok & 0x0f;
+		if (mlen == 15) {
+			do {
+				if (ip >= slen) return -1;
+				b = src[ip++];
+				mlen += b;
+			} while (b == 255);
+		}
+		mlen += LZ_MIN_MATCH;
+
+		if (op + mlen > dmax) return -1;
+
+		/* Byte-wise copy: the match may overlap the output. */
+		for (i = 0; i < mlen; i++, op++)
+			dst[op] = dst[op - offset];
+	}
+
+	return op;
+}
@@ -7,6 +7,7 @@
  *     /dev/boot	- boot device loaded from boot image 
  *     /dev/zero	- null byte stream generator
  *     /dev/imgrd	- boot image RAM disk
+ *     /dev/zram	- compressed RAM disk
  *
  *  Changes:
  *	Apr 29, 2005	added null byte generator  (Jorrit N. Herder)
@@ -38,7 +39,22 @@
 
 #define RAM_DEV_LAST (RAM_DEV_FIRST+RAMDISKS-1)
 
-#define NR_DEVS            (7+RAMDISKS)	/* number of minor devices */
+#define NR_DEVS            (8+RAMDISKS)	/* number of minor devices */
+
+/* # bytes of RAM disk memory given to the VM cache per call */
+#define PUBLISH_CHUNK (1024 * PAGE_SIZE)
+
+/* compressed RAM disk (/dev/zram) */
+struct zram_slot {
+  unsigned char *data;		/* compressed page; NULL for an all-zero page */
+  u16_t len;			/* compressed length; PAGE_SIZE means raw */
+};
+
+static struct zram_slot *zram_slots = NULL; /* one slot per PAGE_SIZE block */
+static size_t zram_pages = 0;		/* device size in pages */
+
+static unsigned char zram_page[PAGE_SIZE]; /* uncompressed staging buffer */
+static unsigned char zram_cbuf[PAGE_SIZE]; /* compression output buffer */
 
 static struct device m_geom[NR_DEVS];  /* base and size of each device */
 static vir_bytes m_vaddrs[NR_DEVS];
@@ -411,6 +427,138 @@ static struct device *m_block_part(devminor_t minor)
   return(&m_geom[minor]);
 }
 
+/*===========================================================================*
+ *				m_zram_fetch				     *
+ *===========================================================================*/
+static int m_zram_fetch(struct zram_slot *sp)
+{
+/* Expand the contents of a compressed RAM disk slot into zram_page. */
+
+  if (sp->data == NULL)
+	memset(zram_page, 0, PAGE_SIZE);
+  else if (sp->len == PAGE_SIZE)
+	memcpy(zram_page, sp->data, PAGE_SIZE);
+  else if (lz_decompress(sp->data, sp->len, zram_page, PAGE_SIZE) !=
+    PAGE_SIZE) {
+	printf("MEM: zram: corrupt compressed page\n");
+	return EIO;
+  }
+
+  return OK;
+}
+
+/*===========================================================================*
+ *				m_zram_store				     *
+ *===========================================================================*/
+static int m_zram_store(struct zram_slot *sp)
+{
+/* Compress the contents of zram_page into a compressed RAM disk slot,
+ * replacing whatever the slot held before.
+ */
+  unsigned char *data;
+  size_t clen, i;
+
+  /* All-zero pages, for example on a freshly created file system, take up
+   * no memory at all.
+   */
+  for (i = 0; i < PAGE_SIZE; i++)
+	if (zram_page[i] != 0)
+		break;
+  if (i == PAGE_SIZE) {
+	free(sp->data);
+	sp->data = NULL;
+	sp->len = 0;
+	return OK;
+  }
+
+  /* Pages that do not shrink are stored uncompressed. */
+  if ((clen = lz_compress(zram_page, PAGE_SIZE, zram_cbuf,
+    PAGE_SIZE - 1)) == 0)
+	clen = PAGE_SIZE;
+
+  if ((data = malloc(clen)) == NULL)
+	return ENOMEM;
+  memcpy(data, (clen == PAGE_SIZE) ? zram_page : zram_cbuf, clen);
+
+  free(sp->data);
+  sp->data = data;
+  sp->len = clen;
+
+  return OK;
+}
+
+/*===========================================================================*
+ *				m_zram_transfer				     *
+ *===========================================================================*/
+static ssize_t m_zram_transfer(int do_write, u64_t position, endpoint_t endpt,
+	iovec_t *iov, unsigned int nr_req)
+{
+/* Read or write the compressed RAM disk, one page at a time. Reads expand
+ * the page into a staging buffer and copy out the requested part. Writes
+ * that cover a whole page simply replace it; partial writes first expand
+ * the old page contents and overlay the new data, after which the page is
+ * compressed again.
+ */
+  struct zram_slot *sp;
+  u64_t dv_size;
+  size_t count, page_off, chunk;
+  vir_bytes vir_offset = 0;
+  cp_grant_id_t grant;
+  ssize_t total = 0;
+  int r;
+
+  if (zram_slots == NULL) {
+	printf("MEM: dev %d not initialized\n", ZRAM_DEV);
+	return EIO;
+  }
+
+  dv_size = m_geom[ZRAM_DEV].dv_size;
+
+  while (nr_req > 0) {
+	count = iov->iov_size;
+	grant = (cp_grant_id_t) iov->iov_addr;
+
+	if (position >= dv_size) return(total);	/* check for EOF */
+	if (position + count > dv_size) count = dv_size - position;
+
+	while (count > 0) {
+		sp = &zram_slots[(size_t) (position / PAGE_SIZE)];
+		page_off = (size_t) (position % PAGE_SIZE);
+		chunk = PAGE_SIZE - page_off;
+		if (chunk > count) chunk = count;
+
+		if (!do_write) {
+			if ((r = m_zram_fetch(sp)) != OK)
+				return r;
+			r = sys_safecopyto(endpt, grant, vir_offset,
+				(vir_bytes) &zram_page[page_off], chunk);
+			if (r != OK)
+				panic("I/O copy failed: %d", r);
+		} else {
+			/* Partial page update: read-modify-write. */
+			if (chunk < PAGE_SIZE && (r = m_zram_fetch(sp)) != OK)
+				return r;
+			r = sys_safecopyfrom(endpt, grant, vir_offset,
+				(vir_bytes) &zram_page[page_off], chunk);
+			if (r != OK)
+				panic("I/O copy failed: %d", r);
+			if ((r = m_zram_store(sp)) != OK)
+				return r;
+		}
+
+		position += chunk;
+		vir_offset += chunk;
+		total += chunk;
+		count -= chunk;
+		iov->iov_size -= chunk;
+	}
+
+	if (iov->iov_size == 0) { iov++; nr_req--; vir_offset = 0; }
+  }
+
+  return(total);
+}
+
 /*===========================================================================*
  *				m_block_transfer			     *
  *===========================================================================*/
@@ -442,6 +590,10 @@ static int m_block_transfer(
   if (ex64hi(position) != 0)
 	return OK;	/* Beyond EOF */
 
+  /* The compressed RAM disk is not a flat memory mapping. */
+  if (minor == ZRAM_DEV)
+	return m_zram_transfer(do_write, position, endpt, iov, nr_req);
+
   while (nr_req > 0) {
 
 	/* How much to transfer and where to / from. */
@@ -476,6 +628,45 @@ static int m_block_transfer(
   return(total);
 }
 
+/*===========================================================================*
+ *				m_ramdisk_publish			     *
+ *===========================================================================*/
+static void m_ramdisk_publish(devminor_t minor)
+{
+/* Publish the pages of a RAM disk into the VM cache, keyed by the block
+ * device they make up. File systems fill their buffer cache from the VM
+ * cache (see libminixfs), so once the pages are published, a file system
+ * mounted on the RAM disk maps the disk's own pages straight into its
+ * cache rather than copying them in through BDEV transfers. The driver
+ * keeps its own mapping of the pages, which also keeps them referenced so
+ * that VM will not evict them under memory pressure. All of this is a
+ * best-effort optimization: if publishing fails, the copying path in
+ * m_block_transfer still works as before.
+ */
+  u64_t size, offset;
+  size_t chunk;
+  u32_t flags;
+  dev_t dev;
+  int r;
+
+  dev = makedev(MEMORY_MAJOR, minor);
+  size = roundup(m_geom[minor].dv_size, PAGE_SIZE);
+
+  for (offset = 0; offset < size; offset += chunk) {
+	chunk = PUBLISH_CHUNK;
+	if (chunk > size - offset) chunk = size - offset;
+
+	flags = 0;
+	r = vm_set_cacheblock((void *) (m_vaddrs[minor] + offset), dev,
+		offset, VMC_NO_INODE, 0, &flags, chunk, 0);
+	if (r != OK) {
+		printf("MEM: failed to publish ramdisk %d pages (%d)\n",
+			minor, r);
+		return;
+	}
+  }
+}
+
 /*===========================================================================*
  *				m_block_open				     *
  *===========================================================================*/
@@ -533,7 +724,7 @@ static int m_block_ioctl(devminor_t minor, unsigned long request,
    */
   if ((dv = m_block_part(minor)) == NULL) return ENXIO;
   if((minor < RAM_DEV_FIRST || minor > RAM_DEV_LAST) &&
-  	minor != RAM_DEV_OLD && !is_imgrd) {
+  	minor != RAM_DEV_OLD && minor != ZRAM_DEV && !is_imgrd) {
 	printf("MEM: MIOCRAMSIZE: %d not a ramdisk\n", minor);
 	return EINVAL;
   }
@@ -545,6 +736,46 @@ static int m_block_ioctl(devminor_t minor, unsigned long request,
 	return s;
   if(is_imgrd)
   	ramdev_size = 0;
+
+  if(minor == ZRAM_DEV) {
+	/* (Re)size the compressed RAM disk. The slot array is allocated up
+	 * front; memory for the compressed pages themselves is allocated
+	 * only as data is written. Resizing frees any old contents.
+	 */
+	struct zram_slot *slots;
+	size_t pages, i;
+
+	ramdev_size = rounddown(ramdev_size, PAGE_SIZE);
+	pages = ramdev_size / PAGE_SIZE;
+
+	if(zram_slots && dv->dv_size == (u64_t) ramdev_size) {
+		return(OK);
+	}
+	/* openct is 1 for the ioctl(). */
+	if(openct[minor] != 1) {
+		printf("MEM: MIOCRAMSIZE: %d in use (count %d)\n",
+			minor, openct[minor]);
+		return(EBUSY);
+	}
+
+	slots = NULL;
+	if(pages > 0 && (slots = calloc(pages, sizeof(slots[0]))) == NULL) {
+		printf("MEM: failed to get memory for zram\n");
+		return(ENOMEM);
+	}
+
+	if(zram_slots) {
+		for(i = 0; i < zram_pages; i++)
+			free(zram_slots[i].data);
+		free(zram_slots);
+	}
+	zram_slots = slots;
+	zram_pages = pages;
+	dv->dv_size = ramdev_size;
+
+	return(OK);
+  }
+
   if(m_vaddrs[minor] && dv->dv_size == (u64_t) ramdev_size) {
 	return(OK);
   }
@@ -569,6 +800,10 @@ static int m_block_ioctl(devminor_t minor, unsigned long request,
 		size -= l;
 	}
 	size = rounddown(size, PAGE_SIZE);
+	/* Withdraw the old contents from the VM cache before the pages go
+	 * away; see m_ramdisk_publish().
+	 */
+	vm_clear_cache(makedev(MEMORY_MAJOR, minor));
 	r = munmap((void *) a, size);
 	if(r != OK) {
 		printf("memory: WARNING: munmap failed: %d\n", r);
@@ -595,5 +830,13 @@ static int m_block_ioctl(devminor_t minor, unsigned long request,
 
   dv->dv_size = ramdev_size;
 
+  /* Hand the new RAM disk's pages to the VM cache, so that file systems
+   * can map them into their own caches directly. The boot image RAM disk
+   * is not published: it lives in the driver's data segment, and the VM
+   * cache can only take whole, exclusively owned anonymous pages.
+   */
+  if (ramdev_size > 0)
+	m_ramdisk_publish(minor);
+
   return(OK);
 }
@@ -36,7 +36,7 @@ static struct mmc_host host;
 
 /* When passing data over a grant one needs to pass
  * a buffer to sys_safecopy copybuff is used for that*/
-#define COPYBUFF_SIZE 0x1000	/* 4k buff */
+#define COPYBUFF_SIZE 0x10000	/* 64k buff */
 static unsigned char copybuff[COPYBUFF_SIZE];
 
 static struct sd_slot *get_slot(devminor_t minor);
@@ -294,8 +294,10 @@ block_transfer(
 	vir_bytes io_size;	/* Size to read/write to/from the iov */
 	vir_bytes io_offset;	/* Size to read/write to/from the iov */
 	vir_bytes bytes_written;
+	vir_bytes done;		/* Bytes transferred for the current iov */
+	vir_bytes chunk;	/* Size of a single host transfer */
 
-	int r, blk_size, i;
+	int r, blk_size;
 
 	/* Get the current "device" geometry */
 	dev = block_part(minor);
@@ -383,15 +385,18 @@ block_transfer(
 		    "offset)=(%d,%d,%d,%d)\n",
 		    (do_write) ? "write" : "read", counter + 1, nr_req,
 		    ciov->iov_addr, ciov->iov_size, io_size, io_offset);
-		/* transfer max one block at the time */
-		for (i = 0; i < io_size / blk_size; i++) {
+		/* transfer in chunks of up to COPYBUFF_SIZE, so the host can
+		 * use multi-block commands */
+		io_size -= io_size % blk_size;	/* whole blocks only */
+		for (done = 0; done < io_size; done += chunk) {
+			chunk = io_size - done;
+			if (chunk > COPYBUFF_SIZE)
+				chunk = COPYBUFF_SIZE;
 			if (do_write) {
-				/* Read io_size bytes from i/o vector starting
-				 * at 0 and write it to out buffer at the
-				 * correct offset */
+				/* Read chunk bytes from the i/o vector at the
+				 * correct offset into our buffer at 0 */
 				r = copyfrom(endpt, ciov->iov_addr,
-				    i * blk_size, (vir_bytes) copybuff,
-				    blk_size);
+				    done, (vir_bytes) copybuff, chunk);
 				if (r != OK) {
 					log_warn(&log,
 					    "I/O write error: %s iov(base,size)=(%d,%d)"
@@ -401,21 +406,24 @@ block_transfer(
 					return EINVAL;
 				}
 
-				/* write a single block */
+				/* write the blocks in a single request */
 				slot->host->write(&slot->card,
 				    (dev->dv_base / blk_size) +
-				    (io_offset / blk_size) + i, 1, copybuff);
-				bytes_written += blk_size;
+				    (io_offset + done) / blk_size,
+				    chunk / blk_size, copybuff);
+				bytes_written += chunk;
 			} else {
-				/* read a single block info copybuff */
+				/* read the blocks into copybuff in a single
+				 * request */
 				slot->host->read(&slot->card,
 				    (dev->dv_base / blk_size) +
-				    (io_offset / blk_size) + i, 1, copybuff);
-				/* Read io_size bytes from our data at the
-				 * correct offset and write it to the output
-				 * buffer at 0 */
-				r = copyto(endpt, ciov->iov_addr, i * blk_size,
-				    (vir_bytes) copybuff, blk_size);
+				    (io_offset + done) / blk_size,
+				    chunk / blk_size, copybuff);
+				/* Read chunk bytes from our buffer at 0 and
+				 * write it to the output buffer at the
+				 * correct offset */
+				r = copyto(endpt, ciov->iov_addr, done,
+				    (vir_bytes) copybuff, chunk);
 				if (r != OK) {
 					log_warn(&log,
 					    "I/O read error: %s iov(base,size)=(%d,%d)"
@@ -424,7 +432,7 @@ block_transfer(
 					    ciov->iov_size, io_offset);
 					return EINVAL;
 				}
-				bytes_written += blk_size;
+				bytes_written += chunk;
 			}
 		}
 		ciov++;
@@ -67,7 +67,8 @@ struct mmc_command
 	uint32_t data_type;
 	uint32_t resp[4];
 	unsigned char *data;
-	uint32_t data_len;
+	uint32_t data_len;	/* length of a single block of data */
+	uint32_t blkcnt;	/* number of blocks of data_len bytes */
 };
 
 /* structure representing an SD card */
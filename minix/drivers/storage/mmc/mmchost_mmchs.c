@@ -323,7 +323,8 @@ intr_deassert(int mask)
 
 /* pointer to the data to transfer used in bwr and brr */
 unsigned char *io_data;
-int io_len;
+int io_len;			/* length of a single block of data */
+int io_blocks;			/* blocks left to transfer in bwr/brr */
 
 void
 handle_bwr()
@@ -351,8 +352,11 @@ handle_bwr()
 		mmc_write32(mmchs->regs->DATA, value);
 	}
 	intr_deassert(MMCHS_SD_IE_BWR_ENABLE);
-	/* expect buffer to be write enabled */
-	io_data = NULL;
+	/* multi block transfers raise bwr once for every block */
+	if (--io_blocks > 0)
+		io_data += io_len;
+	else
+		io_data = NULL;
 }
 
 void
@@ -378,7 +382,11 @@ handle_brr()
 	}
 	/* clear bbr interrupt */
 	intr_deassert(MMCHS_SD_IE_BRR_ENABLE_ENABLE);
-	io_data = NULL;
+	/* multi block transfers raise brr once for every block */
+	if (--io_blocks > 0)
+		io_data += io_len;
+	else
+		io_data = NULL;
 }
 
 static void
@@ -578,20 +586,29 @@ mmc_send_cmd(struct mmc_command *c)
 		return 1;
 	}
 
-	/* read single block */
+	/* read single or multiple blocks */
 	if (c->data_type == DATA_READ) {
 		cmd |= MMCHS_SD_CMD_DP_DATA;	/* Command with data transfer */
-		cmd |= MMCHS_SD_CMD_MSBS_SINGLE;	/* single block */
+		cmd |= (c->blkcnt > 1) ? MMCHS_SD_CMD_MSBS_MULTI :
+		    MMCHS_SD_CMD_MSBS_SINGLE;
 		cmd |= MMCHS_SD_CMD_DDIR_READ;	/* read data from card */
 	}
 
-	/* write single block */
+	/* write single or multiple blocks */
 	if (c->data_type == DATA_WRITE) {
 		cmd |= MMCHS_SD_CMD_DP_DATA;	/* Command with data transfer */
-		cmd |= MMCHS_SD_CMD_MSBS_SINGLE;	/* single block */
+		cmd |= (c->blkcnt > 1) ? MMCHS_SD_CMD_MSBS_MULTI :
+		    MMCHS_SD_CMD_MSBS_SINGLE;
 		cmd |= MMCHS_SD_CMD_DDIR_WRITE;	/* write to the card */
 	}
 
+	/* for multi block transfers, let the controller count the blocks and
+	 * send a stop transmission command (CMD12) by itself when done */
+	if ((cmd & MMCHS_SD_CMD_DP_DATA) && c->blkcnt > 1) {
+		cmd |= MMCHS_SD_CMD_BCE_EN;
+		cmd |= MMCHS_SD_CMD_ACEN_EN;
+	}
+
 	/* check we are in a sane state */
 	if ((mmc_read32(mmchs->regs->SD_STAT) & 0xffffu)) {
 		log_warn(&log, "%s, interrupt already raised stat  %08x\n",
@@ -613,9 +630,12 @@ mmc_send_cmd(struct mmc_command *c)
 		}
 		io_data = c->data;
 		io_len = c->data_len;
+		io_blocks = c->blkcnt;
 		assert(io_len <= 0xFFF);	/* only 12 bits */
+		assert(c->blkcnt >= 1);
+		assert(c->blkcnt <= 0xFFFF);	/* only 16 bits */
 		assert(io_data != NULL);
-		mmc_set32(mmchs->regs->BLK, MMCHS_SD_BLK_BLEN, io_len);
+		mmc_write32(mmchs->regs->BLK, (c->blkcnt << 16) | io_len);
 	}
 
 	ret = mmchs_send_cmd(cmd, arg);
@@ -885,6 +905,7 @@ card_scr(struct sd_card_regs *card)
 	command.args = 0xaaaaaaaa;
 	command.data = buffer;
 	command.data_len = 8;
+	command.blkcnt = 1;
 
 	if (mmc_send_app_cmd(card, &command)) {
 		return 1;
@@ -986,6 +1007,7 @@ mmc_switch(int function, int value, uint8_t * data)
 	command.data_type = DATA_READ;
 	command.data = data;
 	command.data_len = 64;
+	command.blkcnt = 1;
 	command.args = (1 << 31) | (0x00ffffff & ~(0xf << fshift));
 	command.args |= (value << fshift);
 	if (mmc_send_cmd(&command)) {
@@ -1039,6 +1061,7 @@ read_single_block(struct sd_card_regs *card,
 	command.data_type = DATA_READ;
 	command.data = buf;
 	command.data_len = 512;
+	command.blkcnt = 1;
 
 	if (mmc_send_cmd(&command)) {
 		log_warn(&log, "Error sending command\n");
@@ -1060,6 +1083,7 @@ write_single_block(struct sd_card_regs *card,
 	command.data_type = DATA_WRITE;
 	command.data = buf;
 	command.data_len = 512;
+	command.blkcnt = 1;
 
 	/* write single block */
 	if (mmc_send_cmd(&command)) {
@@ -1070,6 +1094,50 @@ write_single_block(struct sd_card_regs *card,
 	return 0;
 }
 
+int
+read_multiple_blocks(struct sd_card_regs *card,
+    uint32_t blknr, uint32_t count, unsigned char *buf)
+{
+	struct mmc_command command;
+
+	command.cmd = MMC_READ_BLOCK_MULTIPLE;
+	command.args = blknr;
+	command.resp_type = RESP_LEN_48;
+	command.data_type = DATA_READ;
+	command.data = buf;
+	command.data_len = 512;
+	command.blkcnt = count;
+
+	if (mmc_send_cmd(&command)) {
+		log_warn(&log, "Read multiple blocks command failed\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int
+write_multiple_blocks(struct sd_card_regs *card,
+    uint32_t blknr, uint32_t count, unsigned char *buf)
+{
+	struct mmc_command command;
+
+	command.cmd = MMC_WRITE_BLOCK_MULTIPLE;
+	command.args = blknr;
+	command.resp_type = RESP_LEN_48;
+	command.data_type = DATA_WRITE;
+	command.data = buf;
+	command.data_len = 512;
+	command.blkcnt = count;
+
+	if (mmc_send_cmd(&command)) {
+		log_warn(&log, "Write multiple blocks command failed\n");
+		return 1;
+	}
+
+	return 0;
+}
+
 int
 mmchs_host_init(struct mmc_host *host)
 {
@@ -1190,11 +1258,18 @@ static int
 mmchs_host_read(struct sd_card *card,
     uint32_t blknr, uint32_t count, unsigned char *buf)
 {
-	uint32_t i;
-	i = count;
-	for (i = 0; i < count; i++) {
-		read_single_block(&card->regs, blknr + i,
-		    buf + (i * card->blk_size));
+	uint32_t chunk;
+
+	while (count > 0) {
+		/* the block count field in BLK is only 16 bits wide */
+		chunk = (count > 0xFFFF) ? 0xFFFF : count;
+		if (chunk == 1)
+			read_single_block(&card->regs, blknr, buf);
+		else
+			read_multiple_blocks(&card->regs, blknr, chunk, buf);
+		blknr += chunk;
+		buf += chunk * card->blk_size;
+		count -= chunk;
 	}
 	return OK;
 }
@@ -1204,12 +1279,18 @@ static int
 mmchs_host_write(struct sd_card *card,
     uint32_t blknr, uint32_t count, unsigned char *buf)
 {
-	uint32_t i;
-
-	i = count;
-	for (i = 0; i < count; i++) {
-		write_single_block(&card->regs, blknr + i,
-		    buf + (i * card->blk_size));
+	uint32_t chunk;
+
+	while (count > 0) {
+		/* the block count field in BLK is only 16 bits wide */
+		chunk = (count > 0xFFFF) ? 0xFFFF : count;
+		if (chunk == 1)
+			write_single_block(&card->regs, blknr, buf);
+		else
+			write_multiple_blocks(&card->regs, blknr, chunk, buf);
+		blknr += chunk;
+		buf += chunk * card->blk_size;
+		count -= chunk;
 	}
 
 	return OK;
@@ -168,7 +168,7 @@ static struct omap_mmchs_registers regs_v0 = {
 #define MMCHS_SD_CMD_RSP_TYPE_48B_BUSY    (0x3 << 16) /* Response length 48 bits with busy after response */
 #define MMCHS_SD_CMD_MSBS                 (0x1 << 5)  /* Multi/Single block select */
 #define MMCHS_SD_CMD_MSBS_SINGLE          (0x0 << 5)  /* Single block mode */
-#define MMCHS_SD_CMD_MSBS_MULTI           (0x0 << 5)  /* Multi block mode */
+#define MMCHS_SD_CMD_MSBS_MULTI           (0x1 << 5)  /* Multi block mode */
 #define MMCHS_SD_CMD_DDIR                 (0x1 << 4)  /* Data transfer direction */
 #define MMCHS_SD_CMD_DDIR_READ            (0x1 << 4)  /* Data read (card to host) */
 #define MMCHS_SD_CMD_DDIR_WRITE           (0x0 << 4)  /* Data write (host to card)  */
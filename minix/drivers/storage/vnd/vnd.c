@@ -9,7 +9,14 @@
 #include <fcntl.h>
 #include <assert.h>
 
-#define VND_BUF_SIZE	65536
+/*
+ * Default size of the intermediate I/O transfer buffer.  Larger transfers are
+ * split up into chunks of this size, and each chunk requires a full round trip
+ * to VFS and the underlying file system, so a larger buffer means less
+ * per-request overhead.  The default may be overridden with the "bufsize"
+ * driver argument.
+ */
+#define VND_BUF_SIZE	262144
 
 static struct {
 	int fd;			/* file descriptor for the underlying file */
@@ -22,6 +29,7 @@ static struct {
 	struct device subpart[SUB_PER_DRIVE];	/* same for subpartitions */
 	struct part_geom geom;	/* geometry information */
 	char *buf;		/* intermediate I/O transfer buffer */
+	size_t buf_size;	/* size of the transfer buffer */
 } state;
 
 static unsigned int instance;
@@ -135,7 +143,7 @@ vnd_copy(iovec_s_t *iov, size_t iov_off, size_t bytes, endpoint_t endpt,
 	int count;
 	char *ptr;
 
-	assert(bytes > 0 && bytes <= VND_BUF_SIZE);
+	assert(bytes > 0 && bytes <= state.buf_size);
 
 	vvp = vvec;
 	count = 0;
@@ -186,7 +194,7 @@ vnd_advance(iovec_s_t *iov, size_t *iov_offp, size_t bytes)
 {
 	size_t iov_off;
 
-	assert(bytes > 0 && bytes <= VND_BUF_SIZE);
+	assert(bytes > 0 && bytes <= state.buf_size);
 
 	iov_off = *iov_offp;
 
@@ -250,7 +258,7 @@ vnd_transfer(devminor_t minor, int do_write, u64_t position,
 	iov_off = 0;
 
 	for (off = 0; off < bytes; off += chunk) {
-		chunk = MIN(bytes - off, VND_BUF_SIZE);
+		chunk = MIN(bytes - off, state.buf_size);
 
 		assert((unsigned int) (iov - (iovec_s_t *) iovt) < nr_req);
 
@@ -404,7 +412,7 @@ vnd_ioctl(devminor_t UNUSED(minor), unsigned long request, endpoint_t endpt,
 		 * of malloc to allow the memory to be actually freed later.
 		 */
 		if (r == OK) {
-			state.buf = mmap(NULL, VND_BUF_SIZE, PROT_READ |
+			state.buf = mmap(NULL, state.buf_size, PROT_READ |
 			    PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
 			if (state.buf == MAP_FAILED)
 				r = ENOMEM;
@@ -432,7 +440,7 @@ vnd_ioctl(devminor_t UNUSED(minor), unsigned long request, endpoint_t endpt,
 		}
 
 		if (r != OK) {
-			munmap(state.buf, VND_BUF_SIZE);
+			munmap(state.buf, state.buf_size);
 			close(state.fd);
 			state.fd = -1;
 		}
@@ -457,7 +465,7 @@ vnd_ioctl(devminor_t UNUSED(minor), unsigned long request, endpoint_t endpt,
 		 * allow reuse until the device has been closed by the other
 		 * users.
 		 */
-		munmap(state.buf, VND_BUF_SIZE);
+		munmap(state.buf, state.buf_size);
 		close(state.fd);
 		state.fd = -1;
 
@@ -545,6 +553,14 @@ vnd_init(int UNUSED(type), sef_init_info_t *UNUSED(info))
 	(void) env_parse("instance", "d", 0, &v, 0, 255);
 	instance = (unsigned int) v;
 
+	/*
+	 * The transfer buffer size determines how much backing-file I/O is
+	 * performed per VFS round trip, and may be tuned per instance.
+	 */
+	v = VND_BUF_SIZE;
+	(void) env_parse("bufsize", "d", 0, &v, SECTOR_SIZE, 4 * VND_BUF_SIZE);
+	state.buf_size = (size_t) v & ~(SECTOR_SIZE - 1);
+
 	state.openct = 0;
 	state.exiting = FALSE;
 	state.fd = -1;
@@ -682,11 +682,13 @@ static void pty_finish(pty_t *pp)
  *===========================================================================*/
 static int pty_slave_read(tty_t *tp, int try)
 {
-/* Offer bytes from the PTY writer for input on the TTY.  (Do it one byte at
- * a time, 99% of the writes will be for one byte, so no sense in being smart.)
+/* Offer bytes from the PTY writer for input on the TTY.  Characters are
+ * copied in and processed a chunk at a time, so that bulk input (pastes,
+ * multiplexers funneling whole screens) does not cost one kernel call per
+ * byte; interactive single-byte writes simply arrive as chunks of one.
  */
   pty_t *pp = tp->tty_priv;
-  char c;
+  char buf[TTY_IN_BYTES];
 
   if (pp->state & PTY_CLOSED) {
 	if (try) return 1;
@@ -706,25 +708,32 @@ static int pty_slave_read(tty_t *tp, int try)
   }
 
   while (pp->wrleft > 0) {
-  	int s;
+  	int s, count, ct;
 
-	/* Transfer one character to 'c'. */
+	/* Transfer a chunk of characters. */
+	count = (int) sizeof(buf);
+	if ((size_t) count > pp->wrleft) count = (int) pp->wrleft;
 	if ((s = sys_safecopyfrom(pp->wrcaller, pp->wrgrant, pp->wrcum,
-		(vir_bytes) &c, 1)) != OK) {
+		(vir_bytes) buf, count)) != OK) {
 		printf("pty: safecopy failed (error %d)\n", s);
 		break;
 	}
 
-	/* Input processing. */
-	if (in_process(tp, &c, 1) == 0) break;
+	/* Input processing.  Whatever is not accepted stays with the writer
+	 * and is copied in again once there is room.
+	 */
+	ct = in_process(tp, buf, count);
 
 	/* PTY writer bookkeeping. */
-	pp->wrcum++;
-	if (--pp->wrleft == 0) {
+	pp->wrcum += ct;
+	pp->wrleft -= ct;
+	if (pp->wrleft == 0) {
 		chardriver_reply_task(pp->wrcaller, pp->wrid, pp->wrcum);
 		pp->wrcum = 0;
 		pp->wrcaller = NONE;
 	}
+
+	if (ct < count) break;	/* input queue full */
   }
 
   return 0;
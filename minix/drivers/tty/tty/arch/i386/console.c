@@ -67,6 +67,13 @@ static int disabled_sm;	/* Scroll mode to be restored when re-enabling
 static char *console_memory = NULL;
 static char *font_memory = NULL;
 
+/* Shadow copy of the video memory.  All updates are made to the shadow first
+ * and then written out to video memory in wide, sequential stores, which the
+ * slow video bus combines far better than word-sized ones.  Having the shadow
+ * also means screen-to-screen copies never have to read video memory.
+ */
+static u16_t vid_shadow[EGA_SIZE / 2];
+
 /* Per console data. */
 typedef struct console {
   tty_t *c_tty;			/* associated TTY struct */
@@ -136,6 +143,7 @@ static int ga_program(struct sequence *seq);
 static int cons_ioctl(tty_t *tp, int);
 static void mem_vid_copy(vir_bytes src, int dst, int count);
 static void vid_vid_copy(int src, int dst, int count);
+static void vid_update(int index, int count);
 
 #if 0
 static void get_6845(int reg, unsigned *val);
@@ -168,7 +176,7 @@ int try;
   int count;
   int result = OK;
   register char *tbuf;
-  char buf[64];
+  static char buf[4096];	/* static, so as not to burden the stack */
   console_t *cons = tp->tty_priv;
 
   if (try) return 1;	/* we can always write to console */
@@ -179,7 +187,10 @@ int try;
   if ((count = tp->tty_outleft) == 0 || tp->tty_inhibited) return 0;
 
   /* Copy the user bytes to buf[] for decent addressing. Loop over the
-   * copies, since the user buffer may be much larger than buf[].
+   * copies, since the user buffer may be much larger than buf[].  The buffer
+   * is large enough that typical writes take a single kernel copy, after
+   * which the entire chunk--escape sequences and all--is processed in one
+   * pass below, with screen updates batched through the RAM queue.
    */
   do {
 	if (count > sizeof(buf)) count = sizeof(buf);
@@ -965,6 +976,12 @@ tty_t *tp;
 	if(console_memory == MAP_FAILED) 
   		panic("Console couldn't map video memory");
 
+	/* Seed the shadow copy with the current screen contents, so that
+	 * the boot messages survive.  This is the only time video memory
+	 * is ever read.
+	 */
+	memcpy(vid_shadow, console_memory, vid_size);
+
 	font_memory = vm_map_phys(SELF, (void *)GA_VIDEO_ADDRESS, GA_FONT_SIZE);
 
 	if(font_memory == MAP_FAILED) 
@@ -1190,13 +1207,14 @@ static void mem_vid_copy(vir_bytes src, int dst_index, int count)
 		int i, subcount = count;
 		u16_t *dst_mem;
 		LIMITINDEX(vid_mask, dst_index, vid_size, subcount);
-		dst_mem = (u16_t *) console_memory + dst_index;
+		dst_mem = vid_shadow + dst_index;
 		if(!src)
 			for(i = 0; i < subcount; i++)
 				*dst_mem++ = blank_color;
 		else
 			for(i = 0; i < subcount; i++)
 				*dst_mem++ = *src_mem++;
+		vid_update(dst_index, subcount);
 		count -= subcount;
 		dst_index += subcount;
 	}
@@ -1215,8 +1233,8 @@ static void vid_vid_copy(int src_index, int dst_index, int count)
 		u16_t *dst_mem, *src_mem;
 		LIMITINDEX(vid_mask, src_index, vid_size, subcount);
 		LIMITINDEX(vid_mask, dst_index, vid_size, subcount);
-		src_mem = (u16_t *) console_memory + src_index;
-		dst_mem = (u16_t *) console_memory + dst_index;
+		src_mem = vid_shadow + src_index;
+		dst_mem = vid_shadow + dst_index;
 		if(backwards) {
 			src_mem += subcount - 1;
 			dst_mem += subcount - 1;
@@ -1226,8 +1244,35 @@ static void vid_vid_copy(int src_index, int dst_index, int count)
 			for(i = 0; i < subcount; i++)
 				*dst_mem++ = *src_mem++;
 		}
+		vid_update(dst_index, subcount);
 		count -= subcount;
 		dst_index += subcount;
 		src_index += subcount;
 	}
 }
+
+/*===========================================================================*
+ *				vid_update				     *
+ *===========================================================================*/
+static void vid_update(int index, int count)
+{
+/* Write a range of words from the shadow buffer out to video memory.  This
+ * is the only routine that touches video memory, and it does so with 32-bit
+ * stores wherever alignment allows.
+ */
+	u16_t *src = vid_shadow + index;
+	u16_t *dst = (u16_t *) console_memory + index;
+
+	if((index & 1) && count > 0) {
+		*dst++ = *src++;
+		count--;
+	}
+	while(count >= 2) {
+		*(u32_t *) dst = *(u32_t *) src;
+		dst += 2;
+		src += 2;
+		count -= 2;
+	}
+	if(count > 0)
+		*dst = *src;
+}
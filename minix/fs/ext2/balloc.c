@@ -4,6 +4,7 @@
  *   discard_preallocated_blocks:	Discard preallocated blocks.
  *   alloc_block:	somebody wants to allocate a block; find one.
  *   free_block:	indicate that a block is available for new allocation.
+ *   discard_flush:	pass pending freed blocks to the driver as a discard.
  *
  * Created:
  *   June 2010 (Evgeniy Ivanov)
@@ -12,6 +13,7 @@
 #include "fs.h"
 #include <string.h>
 #include <stdlib.h>
+#include <minix/bdev.h>
 #include <minix/com.h>
 #include <minix/u64.h>
 #include "buf.h"
@@ -23,6 +25,42 @@
 static block_t alloc_block_bit(struct super_block *sp, block_t origin,
 	struct inode *rip);
 
+/* Freed blocks are batched into one contiguous extent and passed down to the
+ * device driver as a discard (TRIM) request, so that flash-based devices can
+ * reclaim the underlying storage.  Discarding is purely advisory: on the first
+ * driver error, typically ENOTSUP from a driver without discard support, we
+ * simply stop issuing requests.  The extent is capped so that its byte size
+ * always fits in a size_t.
+ */
+#define DISCARD_MAX_BLOCKS	0x10000	/* flush the extent beyond this size */
+
+static struct {
+  block_t block;		/* first block of the pending extent */
+  block_t count;		/* number of blocks in the pending extent */
+  int enabled;			/* cleared after a driver error */
+} discard = { NO_BLOCK, 0, TRUE };
+
+/*===========================================================================*
+ *                              discard_flush                                *
+ *===========================================================================*/
+void discard_flush(void)
+{
+/* Pass the pending extent of freed blocks, if any, to the device driver as a
+ * discard request.  Stop issuing discard requests after the first failure.
+ */
+  int r;
+
+  if (discard.enabled && discard.count > 0) {
+	r = bdev_discard(superblock->s_dev,
+		(u64_t) discard.block * superblock->s_block_size,
+		(size_t) discard.count * superblock->s_block_size);
+	if (r != OK)
+		discard.enabled = FALSE;
+  }
+  discard.block = NO_BLOCK;
+  discard.count = 0;
+}
+
 /*===========================================================================*
  *                      discard_preallocated_blocks                          *
  *===========================================================================*/
@@ -41,7 +79,7 @@ void discard_preallocated_blocks(struct inode *rip)
 
   if (rip) {
 	rip->i_prealloc_count = rip->i_prealloc_index = 0;
-	for (i = 0; i < EXT2_PREALLOC_BLOCKS; i++) {
+	for (i = 0; i < EXT2_MAX_PREALLOC_BLOCKS; i++) {
 		if (rip->i_prealloc_blocks[i] != NO_BLOCK) {
 			free_block(rip->i_sp, rip->i_prealloc_blocks[i]);
 			rip->i_prealloc_blocks[i] = NO_BLOCK;
@@ -55,7 +93,7 @@ void discard_preallocated_blocks(struct inode *rip)
   for(rip = &inode[0]; rip < &inode[NR_INODES]; rip++) {
 	rip->i_prealloc_count = rip->i_prealloc_index = 0;
 	rip->i_preallocation = 0; /* forbid preallocation */
-	for (i = 0; i < EXT2_PREALLOC_BLOCKS; i++) {
+	for (i = 0; i < EXT2_MAX_PREALLOC_BLOCKS; i++) {
 		if (rip->i_prealloc_blocks[i] != NO_BLOCK) {
 			free_block(rip->i_sp, rip->i_prealloc_blocks[i]);
 			rip->i_prealloc_blocks[i] = NO_BLOCK;
@@ -76,25 +114,42 @@ block_t alloc_block(struct inode *rip, block_t block)
  */
   block_t goal;
   block_t b;
+  u32_t free_count;
   struct super_block *sp = rip->i_sp;
 
   if (sp->s_rd_only)
 	panic("can't alloc block on read-only filesys.");
 
+  /* Blocks reserved for not-yet-flushed delayed allocations are off limits
+   * here: treating them as free would let immediate allocations drive the
+   * free count below the outstanding reservations, making delay_flush() run
+   * out of space for writes that already reported success.  The flush path
+   * itself releases each block's reservation before allocating it, and thus
+   * draws from the reserved space.
+   */
+  if (sp->s_free_blocks_count > delay_reserved_count())
+	free_count = sp->s_free_blocks_count - delay_reserved_count();
+  else
+	free_count = 0;
+
   /* Check for free blocks. First time discard preallocation,
    * next time return NO_BLOCK
    */
-  if (!opt.use_reserved_blocks &&
-      sp->s_free_blocks_count <= sp->s_r_blocks_count) {
+  if (!opt.use_reserved_blocks && free_count <= sp->s_r_blocks_count) {
 	discard_preallocated_blocks(NULL);
-  } else if (sp->s_free_blocks_count <= EXT2_PREALLOC_BLOCKS) {
+  } else if (free_count <= EXT2_MAX_PREALLOC_BLOCKS) {
 	discard_preallocated_blocks(NULL);
   }
 
-  if (!opt.use_reserved_blocks &&
-      sp->s_free_blocks_count <= sp->s_r_blocks_count) {
+  /* Discarding preallocated blocks may have increased the free count. */
+  if (sp->s_free_blocks_count > delay_reserved_count())
+	free_count = sp->s_free_blocks_count - delay_reserved_count();
+  else
+	free_count = 0;
+
+  if (!opt.use_reserved_blocks && free_count <= sp->s_r_blocks_count) {
 	return(NO_BLOCK);
-  } else if (sp->s_free_blocks_count == 0) {
+  } else if (free_count == 0) {
 	return(NO_BLOCK);
   }
 
@@ -108,7 +163,7 @@ block_t alloc_block(struct inode *rip, block_t block)
 			rip->i_prealloc_blocks[rip->i_prealloc_index] = NO_BLOCK;
 			rip->i_prealloc_count--;
 			rip->i_prealloc_index++;
-			if (rip->i_prealloc_index >= EXT2_PREALLOC_BLOCKS) {
+			if (rip->i_prealloc_index >= EXT2_MAX_PREALLOC_BLOCKS) {
 				rip->i_prealloc_index = 0;
 				ASSERT(rip->i_prealloc_count == 0);
 			}
@@ -157,6 +212,7 @@ struct inode *rip;		/* used for preallocation */
   bit_t	bit = -1;
   int group;
   char update_bsearch = FALSE;
+  unsigned int nbytes, nblocks;
   int i;
 
   if (goal >= sp->s_blocks_count ||
@@ -198,7 +254,7 @@ struct inode *rip;		/* used for preallocation */
 	bp = get_block(sp->s_dev, gd->block_bitmap, NORMAL);
 
 	if (rip->i_preallocation &&
-	    gd->free_blocks_count >= (EXT2_PREALLOC_BLOCKS * 4) ) {
+	    gd->free_blocks_count >= (EXT2_MAX_PREALLOC_BLOCKS * 4) ) {
 		/* Try to preallocate blocks */
 		if (rip->i_prealloc_count != 0) {
 			/* kind of glitch... */
@@ -207,33 +263,45 @@ struct inode *rip;		/* used for preallocation */
 				    blocks! It had to be done by another code.");
 		}
 		ASSERT(rip->i_prealloc_count == 0);
-		/* we preallocate bytes only */
-		ASSERT(EXT2_PREALLOC_BLOCKS == sizeof(char)*CHAR_BIT);
+		/* we preallocate whole bytes only */
+		ASSERT(!(EXT2_MAX_PREALLOC_BLOCKS % (sizeof(char)*CHAR_BIT)));
 
-		bit = setbyte(b_bitmap(bp), sp->s_blocks_per_group);
+		bit = setbytes(b_bitmap(bp), sp->s_blocks_per_group,
+			EXT2_MAX_PREALLOC_BLOCKS / CHAR_BIT, &nbytes);
 		if (bit != -1) {
+			nblocks = nbytes * CHAR_BIT;
 			block = bit + sp->s_first_data_block +
 					group * sp->s_blocks_per_group;
 			check_block_number(block, sp, gd);
 
-			/* We preallocate a byte starting from block.
-			 * First preallocated block will be returned as
+			/* We preallocate a run of free bytes starting from
+			 * block. First preallocated block will be returned as
 			 * normally allocated block.
 			 */
-			for (i = 1; i < EXT2_PREALLOC_BLOCKS; i++) {
+			for (i = 1; i < nblocks; i++) {
 				check_block_number(block + i, sp, gd);
 				rip->i_prealloc_blocks[i-1] = block + i;
 			}
 			rip->i_prealloc_index = 0;
-			rip->i_prealloc_count = EXT2_PREALLOC_BLOCKS - 1;
+			rip->i_prealloc_count = nblocks - 1;
 
 			lmfs_markdirty(bp);
 			put_block(bp);
 
-			gd->free_blocks_count -= EXT2_PREALLOC_BLOCKS;
-			sp->s_free_blocks_count -= EXT2_PREALLOC_BLOCKS;
-			lmfs_change_blockusage(EXT2_PREALLOC_BLOCKS);
+			gd->free_blocks_count -= nblocks;
+			sp->s_free_blocks_count -= nblocks;
+			lmfs_change_blockusage(nblocks);
 			group_descriptors_dirty = 1;
+
+			/* If the run overlaps the pending discard extent,
+			 * issue the discard now, so that it cannot reach the
+			 * device after the blocks' new contents.
+			 */
+			if (discard.count > 0 &&
+			    block < discard.block + discard.count &&
+			    block + nblocks > discard.block)
+				discard_flush();
+
 			return block;
 		}
 	}
@@ -265,6 +333,14 @@ struct inode *rip;		/* used for preallocation */
 		sp->s_bsearch = block;
 	}
 
+	/* If the block is part of the pending discard extent, issue the
+	 * discard now, so that it cannot reach the device after the block's
+	 * new contents.
+	 */
+	if (discard.count > 0 && block >= discard.block &&
+	    block < discard.block + discard.count)
+		discard_flush();
+
 	return block;
   }
 
@@ -336,6 +412,27 @@ void free_block(struct super_block *sp, bit_t bit_returned)
    * block will not be mapped in erroneously later on.
    */
   lmfs_free_block(sp->s_dev, (block_t)bit_returned);
+
+  /* Add the block to the pending discard extent, merging adjacent frees into
+   * one request.  Truncation frees blocks in descending order, so merge in
+   * both directions.  A free that is not adjacent to the extent flushes it.
+   */
+  if (discard.enabled) {
+	if (discard.count > 0 &&
+	    (block_t) bit_returned == discard.block + discard.count)
+		discard.count++;
+	else if (discard.count > 0 &&
+	    (block_t) bit_returned == discard.block - 1) {
+		discard.block = (block_t) bit_returned;
+		discard.count++;
+	} else {
+		discard_flush();
+		discard.block = (block_t) bit_returned;
+		discard.count = 1;
+	}
+	if (discard.count >= DISCARD_MAX_BLOCKS)
+		discard_flush();
+  }
 }
 
 
@@ -161,6 +161,22 @@
 #define EXT2_TOPDIR_FL                  0x00020000
 
 #define EXT2_PREALLOC_BLOCKS		8
-
+#define EXT2_MAX_PREALLOC_BLOCKS	32	/* upper bound on the per-inode
+						 * preallocation window; must be
+						 * a multiple of CHAR_BIT
+						 */
+
+/* Delayed allocation (see write.c).  New file data is held in the buffer
+ * cache under fake block numbers and only assigned device blocks when the
+ * delayed set is flushed, so that one sorted allocation pass replaces many
+ * interleaved per-write allocations.
+ */
+#define EXT2_MAX_DELAYED	16	/* max delayed blocks per inode */
+#define EXT2_MAX_DELAYED_TOTAL	128	/* max delayed blocks over all inodes */
+#define EXT2_DELAYED_BASE	((block_t) 0xF0000000)	/* first fake block # */
+#define EXT2_DELAYED_RESERVE	4	/* worst-case # blocks (data plus
+					 * indirect chain) reserved for each
+					 * delayed block
+					 */
 
 #endif /* EXT2_CONST_H */
@@ -166,12 +166,14 @@ struct inode *get_inode(
   rip->i_bsearch = NO_BLOCK;
   rip->i_last_pos_bl_alloc = 0;
   rip->i_last_dentry_size = 0;
+  rip->i_map_count = 0;	    /* no mapping extent cached yet */
   rip->i_mountpoint= FALSE;
 
   rip->i_preallocation = opt.use_prealloc;
   rip->i_prealloc_count = rip->i_prealloc_index = 0;
+  rip->i_delayed_count = 0;	/* no delayed-allocation blocks */
 
-  for (i = 0; i < EXT2_PREALLOC_BLOCKS; i++) {
+  for (i = 0; i < EXT2_MAX_PREALLOC_BLOCKS; i++) {
 	if (rip->i_prealloc_blocks[i] != NO_BLOCK) {
 		/* Actually this should never happen */
 		free_block(rip->i_sp, rip->i_prealloc_blocks[i]);
@@ -231,6 +233,14 @@ void put_inode(
 	panic("put_inode: i_count already below 1: %d", rip->i_count);
 
   if (--rip->i_count == 0) {    /* i_count == 0 means no one is using it now */
+	/* Assign device blocks to any delayed-allocation data, so that an
+	 * inode never leaves the active set while its size exceeds its
+	 * mapped blocks.  (If the inode is to be freed, truncate_inode()
+	 * would merely have discarded the delayed blocks anyway.)
+	 */
+	if (rip->i_delayed_count > 0 && rip->i_links_count != NO_LINK)
+		delay_flush(rip);
+
 	if (rip->i_links_count == NO_LINK) {
 		/* i_nlinks == NO_LINK means free the inode. */
 		/* return all the disk blocks */
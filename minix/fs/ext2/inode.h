@@ -85,12 +85,20 @@ EXTERN struct inode {
     off_t i_last_dpos;          /* where to start dentry search */
     int i_last_dentry_size;	/* size of last found dentry */
 
+    block_t i_map_fstart;       /* first file block of the cached mapping
+                                 * extent, maintained by read_map.
+				 */
+    block_t i_map_dstart;       /* device block that i_map_fstart maps to */
+    unsigned int i_map_count;   /* number of blocks in the cached extent,
+                                 * zero if nothing is cached.
+				 */
+
     char i_mountpoint;          /* true if mounted on */
 
     char i_seek;                /* set on LSEEK, cleared on READ/WRITE */
     char i_update;              /* the ATIME, CTIME, and MTIME bits are here */
 
-    block_t i_prealloc_blocks[EXT2_PREALLOC_BLOCKS];	/* preallocated blocks */
+    block_t i_prealloc_blocks[EXT2_MAX_PREALLOC_BLOCKS]; /* preallocated blocks */
     int i_prealloc_count;	/* number of preallocated blocks */
     int i_prealloc_index;	/* index into i_prealloc_blocks */
     int i_preallocation;	/* use preallocation for this inode, normally
@@ -98,6 +106,13 @@ EXTERN struct inode {
 				 * happens.
 				 */
 
+    off_t i_delayed_pos[EXT2_MAX_DELAYED];  /* block-aligned file positions of
+                                 * delayed-allocation blocks
+				 */
+    block_t i_delayed_fake[EXT2_MAX_DELAYED]; /* their fake block numbers */
+    struct buf *i_delayed_buf[EXT2_MAX_DELAYED]; /* their pinned cache bufs */
+    int i_delayed_count;	/* number of delayed-allocation blocks */
+
     LIST_ENTRY(inode) i_hash;     /* hash list */
     TAILQ_ENTRY(inode) i_unused;  /* free and unused list */
 
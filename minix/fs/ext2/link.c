@@ -458,8 +458,14 @@ int fs_trunc(ino_t ino_nr, off_t start, off_t end)
 
   if (end == 0)
 	  r = truncate_inode(rip, start);
-  else
+  else {
+	  /* Hole punching frees mapped blocks; delayed-allocation data in
+	   * the range would be missed, so assign device blocks first.
+	   */
+	  if (rip->i_delayed_count > 0)
+		  delay_flush(rip);
 	  r = freesp_inode(rip, start, end);
+  }
 
   return(r);
 }
@@ -485,6 +491,17 @@ off_t newsize;			/* inode must become this size */
 
   discard_preallocated_blocks(rip);
 
+  /* If the file is emptied, its delayed-allocation data can simply be
+   * dropped; otherwise the data must have device blocks assigned before the
+   * blocks beyond the new size are freed.
+   */
+  if (rip->i_delayed_count > 0) {
+	if (newsize == 0)
+		delay_discard(rip);
+	else
+		delay_flush(rip);
+  }
+
   file_type = rip->i_mode & I_TYPE;	/* check to see if file is special */
   if (file_type == I_CHAR_SPECIAL || file_type == I_BLOCK_SPECIAL)
 	return(EINVAL);
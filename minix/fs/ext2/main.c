@@ -74,7 +74,7 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
   opt.mfsalloc = FALSE;
   opt.use_reserved_blocks = FALSE;
   opt.block_with_super = 0;
-  opt.use_prealloc = FALSE;
+  opt.use_prealloc = TRUE;
 
   /* If we have been given an options string, parse options from there. */
   for (i = 1; i < env_argc - 1; i++)
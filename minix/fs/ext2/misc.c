@@ -22,12 +22,23 @@ void fs_sync(void)
   if (superblock->s_rd_only)
 	return; /* nothing to sync */
 
+  /* Assign device blocks to all delayed-allocation data first, since doing
+   * so dirties both data blocks and inodes.
+   */
+  for(rip = &inode[0]; rip < &inode[NR_INODES]; rip++)
+	if(rip->i_count > 0 && rip->i_delayed_count > 0) delay_flush(rip);
+
   /* Write all the dirty inodes to the disk. */
   for(rip = &inode[0]; rip < &inode[NR_INODES]; rip++)
 	if(rip->i_count > 0 && rip->i_dirt == IN_DIRTY) rw_inode(rip, WRITING);
 
   lmfs_flushall();
 
+  /* Pass any pending extent of freed blocks to the driver as a discard
+   * request, now that the bitmap updates covering it have been written.
+   */
+  discard_flush();
+
   if (superblock->s_dev != NO_DEV) {
 	superblock->s_wtime = clock_time(NULL);
 	write_super(superblock);
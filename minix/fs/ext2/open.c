@@ -283,3 +283,17 @@ void fs_seek(ino_t ino_nr)
   if ((rip = find_inode(fs_dev, ino_nr)) != NULL)
 	rip->i_seek = ISEEK;
 }
+
+
+/*===========================================================================*
+ *				fs_fadvise				     *
+ *===========================================================================*/
+int fs_fadvise(ino_t ino_nr, int advice)
+{
+  /* Pass the access pattern hint on to the buffer cache, which adjusts its
+   * read-ahead and eviction policies for the file accordingly.
+   */
+  lmfs_set_advice(fs_dev, ino_nr, advice);
+
+  return(OK);
+}
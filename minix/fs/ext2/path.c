@@ -14,6 +14,102 @@
 #include "super.h"
 
 
+/* Directory entry position cache.  For each known (directory, name) pair, the
+ * cache stores the byte position of the name's entry in that directory, so
+ * that a repeated lookup does not have to scan the directory blocks again.
+ * This matters in particular for large directories.  A cached position is
+ * always verified against the actual directory entry before it is used, so a
+ * stale cache entry merely results in falling back to the linear scan.  The
+ * cache is direct-mapped: entering a name simply evicts the previous occupant
+ * of its hash slot.  Names that do not fit in a slot are not cached at all.
+ */
+#define NR_DCACHE_SLOTS	512	/* number of cached entry positions */
+#define DCACHE_NAME_MAX	60	/* maximum cached name length, plus one */
+
+static struct dcache {
+  ino_t dc_dir;			/* directory inode number, 0 iff slot unused */
+  dev_t dc_dev;			/* device number of the directory */
+  off_t dc_pos;			/* byte position of the entry in the dir */
+  char dc_name[DCACHE_NAME_MAX];	/* entry name, null terminated */
+} dcache[NR_DCACHE_SLOTS];
+
+/*===========================================================================*
+ *				dcache_slot				     *
+ *===========================================================================*/
+static struct dcache *dcache_slot(struct inode *ldir_ptr, const char *string)
+{
+/* Return the cache slot that may hold the entry position for the given name
+ * in the given directory, or NULL if the name is too long to be cached.
+ */
+  unsigned int i, h;
+
+  h = (unsigned int) ldir_ptr->i_num ^ (unsigned int) ldir_ptr->i_dev;
+  for (i = 0; string[i] != '\0'; i++) {
+	if (i >= DCACHE_NAME_MAX - 1)
+		return(NULL);	/* name too long to be cached */
+	h = h * 31 + (unsigned char) string[i];
+  }
+
+  return(&dcache[h % NR_DCACHE_SLOTS]);
+}
+
+/*===========================================================================*
+ *				dcache_enter				     *
+ *===========================================================================*/
+static void dcache_enter(struct inode *ldir_ptr, const char *string, off_t pos)
+{
+/* Remember that the given name has its entry at the given byte position in
+ * the given directory, evicting the slot's previous occupant if any.
+ */
+  struct dcache *dcp;
+
+  if ((dcp = dcache_slot(ldir_ptr, string)) == NULL)
+	return;
+
+  dcp->dc_dir = ldir_ptr->i_num;
+  dcp->dc_dev = ldir_ptr->i_dev;
+  dcp->dc_pos = pos;
+  (void) strncpy(dcp->dc_name, string, sizeof(dcp->dc_name));
+}
+
+/*===========================================================================*
+ *				dcache_find				     *
+ *===========================================================================*/
+static off_t dcache_find(struct inode *ldir_ptr, const char *string)
+{
+/* Return the cached byte position of the given name's entry in the given
+ * directory, or -1 if no position is cached for it.
+ */
+  struct dcache *dcp;
+
+  if ((dcp = dcache_slot(ldir_ptr, string)) == NULL)
+	return(-1);
+
+  if (dcp->dc_dir != ldir_ptr->i_num || dcp->dc_dev != ldir_ptr->i_dev ||
+      strncmp(dcp->dc_name, string, sizeof(dcp->dc_name)) != 0)
+	return(-1);
+
+  return(dcp->dc_pos);
+}
+
+/*===========================================================================*
+ *				dcache_delete				     *
+ *===========================================================================*/
+static void dcache_delete(struct inode *ldir_ptr, const char *string)
+{
+/* The given name is being removed from the given directory; forget its cached
+ * entry position, if any.
+ */
+  struct dcache *dcp;
+
+  if ((dcp = dcache_slot(ldir_ptr, string)) == NULL)
+	return;
+
+  if (dcp->dc_dir == ldir_ptr->i_num && dcp->dc_dev == ldir_ptr->i_dev)
+	dcp->dc_dir = 0;	/* mark the slot as unused */
+}
+
+
 /*===========================================================================*
  *                             fs_lookup				     *
  *===========================================================================*/
@@ -109,7 +205,7 @@ int ftype;			 /* used when ENTER and INCOMPAT_FILETYPE */
   register struct ext2_disk_dir_desc  *prev_dp = NULL;
   register struct buf *bp = NULL;
   int i, r, e_hit, t, match;
-  off_t pos;
+  off_t pos, off;
   unsigned new_slots;
   int extended = 0;
   int required_space = 0;
@@ -128,6 +224,28 @@ int ftype;			 /* used when ENTER and INCOMPAT_FILETYPE */
   if ((string_len = strlen(string)) > EXT2_NAME_MAX)
 	return(ENAMETOOLONG);
 
+  /* For lookups, first try the entry position cached for this name, if any.
+   * The cached position must be verified against the actual entry, since it
+   * may have become stale.  If it has, fall through to the linear scan.
+   */
+  if (flag == LOOK_UP && (pos = dcache_find(ldir_ptr, string)) >= 0 &&
+      pos < ldir_ptr->i_size) {
+	if ((bp = get_block_map(ldir_ptr, (u64_t) pos)) != NULL) {
+		off = pos % ldir_ptr->i_sp->s_block_size;
+		dp = (struct ext2_disk_dir_desc *) (b_data(bp) + off);
+		if (off + MIN_DIR_ENTRY_SIZE + dp->d_name_len <=
+			ldir_ptr->i_sp->s_block_size &&
+		    dp->d_ino != NO_ENTRY &&
+		    ansi_strcmp(dp->d_name, string, dp->d_name_len) == 0) {
+			*numb = (ino_t) conv4(le_CPU, dp->d_ino);
+			put_block(bp);
+			return(OK);
+		}
+		put_block(bp);
+	}
+  }
+  pos = 0;	/* scan from the start of the directory */
+
   if (flag == ENTER) {
 	required_space = MIN_DIR_ENTRY_SIZE + string_len;
 	required_space += (required_space & 0x03) == 0 ? 0 :
@@ -211,9 +329,12 @@ int ftype;			 /* used when ENTER and INCOMPAT_FILETYPE */
 					prev_dp->d_rec_len = conv2(le_CPU,
 							temp);
 				}
+				dcache_delete(ldir_ptr, string);
 			} else {
 				/* 'flag' is LOOK_UP */
 				*numb = (ino_t) conv4(le_CPU, dp->d_ino);
+				dcache_enter(ldir_ptr, string, pos + (off_t)
+				    CUR_DISC_DIR_POS(dp, &b_data(bp)));
 			}
 			put_block(bp);
 			return(r);
@@ -299,6 +420,8 @@ int ftype;			 /* used when ENTER and INCOMPAT_FILETYPE */
 	else
 		dp->d_file_type = EXT2_FT_UNKNOWN;
   }
+  dcache_enter(ldir_ptr, string, pos + (off_t)
+	CUR_DISC_DIR_POS(dp, &b_data(bp)));
   lmfs_markdirty(bp);
   put_block(bp);
   ldir_ptr->i_update |= CTIME | MTIME;	/* mark mtime for update later */
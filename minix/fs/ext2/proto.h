@@ -14,6 +14,7 @@ struct super_block;
 /* balloc.c */
 void discard_preallocated_blocks(struct inode *rip);
 block_t alloc_block(struct inode *rip, block_t goal);
+void discard_flush(void);
 void free_block(struct super_block *sp, bit_t bit);
 
 /* ialloc.c */
@@ -58,6 +59,7 @@ int fs_mknod(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid,
 int fs_slink(ino_t dir_nr, char *name, uid_t uid, gid_t gid,
 	struct fsdriver_data *data, size_t bytes);
 void fs_seek(ino_t ino_nr);
+int fs_fadvise(ino_t ino_nr, int advice);
 
 /* path.c */
 int fs_lookup(ino_t dir_nr, char *name, struct fsdriver_node *node,
@@ -101,9 +103,15 @@ int ansi_strcmp(register const char* ansi_s, register const char *s2,
 	register size_t ansi_s_length);
 bit_t setbit(bitchunk_t *bitmap, bit_t max_bits, unsigned int word);
 bit_t setbyte(bitchunk_t *bitmap, bit_t max_bits);
+bit_t setbytes(bitchunk_t *bitmap, bit_t max_bits, unsigned int max_bytes,
+	unsigned int *nbytes);
 int unsetbit(bitchunk_t *bitmap, bit_t bit);
 
 /* write.c */
+struct buf *delay_get_block(struct inode *rip, off_t position);
+void delay_flush(struct inode *rip);
+void delay_discard(struct inode *rip);
+u32_t delay_reserved_count(void);
 struct buf *new_block(struct inode *rip, off_t position);
 void zero_block(struct buf *bp);
 int write_map(struct inode *, off_t, block_t, int);
@@ -137,16 +137,35 @@ int *completed;                 /* number of bytes copied */
 
   if (b == NO_BLOCK) {
 	if (call == FSC_READ) {
-		/* Reading from a nonexistent block.  Must read as all zeros.*/
-		r = fsdriver_zero(data, buf_off, chunk);
-		if(r != OK) {
-			printf("ext2fs: fsdriver_zero failed\n");
+		/* The position may hold delayed-allocation data, which lives
+		 * in the cache without a device block.
+		 */
+		if ((bp = delay_get_block(rip, (off_t) ex64lo(position)))
+		    == NULL) {
+			/* Reading from a nonexistent block.  Must read as
+			 * all zeros.
+			 */
+			r = fsdriver_zero(data, buf_off, chunk);
+			if(r != OK) {
+				printf("ext2fs: fsdriver_zero failed\n");
+			}
+			return r;
 		}
-		return r;
 	} else if (call == FSC_PEEK) {
-		/* Peeking a nonexistent block. Report to VM. */
-		lmfs_zero_block_ino(dev, ino, ino_off);
-		return OK;
+		/* Peeked blocks are identified to VM by device offset, which
+		 * delayed-allocation data does not have yet; if there is any,
+		 * allocate now and try the mapping again.
+		 */
+		if (rip->i_delayed_count > 0) {
+			delay_flush(rip);
+			b = read_map(rip, (off_t) ex64lo(position), 0);
+		}
+		if (b == NO_BLOCK) {
+			/* Peeking a nonexistent block. Report to VM. */
+			lmfs_zero_block_ino(dev, ino, ino_off);
+			return OK;
+		}
+		bp = rahead(rip, b, position, left);
 	} else {
                /* Writing to a nonexistent block.
                 * Create and enter in inode.
@@ -208,9 +227,9 @@ int opportunistic;
  */
 
   struct buf *bp;
-  int mindex;
-  block_t b;
-  unsigned long excess, block_pos;
+  int mindex, lo, hi;
+  block_t b, expected;
+  unsigned long excess, block_pos, ind_base;
   static char first_time = TRUE;
   static long addr_in_block;
   static long addr_in_block2;
@@ -232,9 +251,42 @@ int opportunistic;
 
   block_pos = position / rip->i_sp->s_block_size; /* relative blk # in file */
 
+  /* Check the cached mapping extent first.  The cache describes a run of
+   * contiguously mapped blocks as found during an earlier lookup, so that
+   * repeated mapping of nearby positions does not walk the indirection
+   * levels again.  It is invalidated whenever the mapping changes.
+   */
+  if (rip->i_map_count > 0 && block_pos >= rip->i_map_fstart &&
+      block_pos - rip->i_map_fstart < rip->i_map_count)
+	return(rip->i_map_dstart + (block_t) (block_pos - rip->i_map_fstart));
+
   /* Is 'position' to be found in the inode itself? */
-  if (block_pos < EXT2_NDIR_BLOCKS)
-	return(rip->i_block[block_pos]);
+  if (block_pos < EXT2_NDIR_BLOCKS) {
+	if ((b = rip->i_block[block_pos]) == NO_BLOCK)
+		return(NO_BLOCK);
+
+	/* Cache the extent of contiguously mapped direct blocks around this
+	 * position.  Entry j is part of the extent iff it maps to block
+	 * b + (j - block_pos), which also rules out any holes.
+	 */
+	lo = hi = (int) block_pos;
+	while (lo > 0) {
+		expected = b - (block_t) (block_pos - (lo - 1));
+		if (expected == NO_BLOCK ||
+		    rip->i_block[lo - 1] != expected)
+			break;
+		lo--;
+	}
+	while (hi < EXT2_NDIR_BLOCKS - 1 &&
+	    rip->i_block[hi + 1] == b + (block_t) (hi + 1 - block_pos))
+		hi++;
+
+	rip->i_map_fstart = (block_t) lo;
+	rip->i_map_dstart = b - (block_t) (block_pos - lo);
+	rip->i_map_count = hi - lo + 1;
+
+	return(b);
+  }
 
   /* It is not in the inode, so it must be single, double or triple indirect */
   if (block_pos < doub_ind_s) {
@@ -273,6 +325,31 @@ int opportunistic;
 	return NO_BLOCK;			/* peeking failed */
 
   b = rd_indir(bp, mindex);
+
+  if (b != NO_BLOCK) {
+	/* Cache the extent of contiguously mapped blocks around this entry
+	 * of the single indirect block, in the same way as for the direct
+	 * blocks above.  The entries in one indirect block cover adjacent
+	 * file positions by construction.
+	 */
+	ind_base = block_pos - mindex;	/* file block of entry 0 */
+
+	lo = hi = mindex;
+	while (lo > 0) {
+		expected = b - (block_t) (mindex - (lo - 1));
+		if (expected == NO_BLOCK || rd_indir(bp, lo - 1) != expected)
+			break;
+		lo--;
+	}
+	while (hi < addr_in_block - 1 &&
+	    rd_indir(bp, hi + 1) == b + (block_t) (hi + 1 - mindex))
+		hi++;
+
+	rip->i_map_fstart = (block_t) (ind_base + lo);
+	rip->i_map_dstart = b - (block_t) (mindex - lo);
+	rip->i_map_count = hi - lo + 1;
+  }
+
   put_block(bp);				/* release single ind block */
 
   return(b);
@@ -459,9 +536,12 @@ static unsigned int get_dtype(struct ext2_disk_dir_desc *dp)
 ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
 	off_t *posp)
 {
-#define GETDENTS_BUFSIZE (sizeof(struct dirent) + EXT2_NAME_MAX + 1)
-#define GETDENTS_ENTRIES	8
-  static char getdents_buf[GETDENTS_BUFSIZE * GETDENTS_ENTRIES];
+/* The staging buffer is flushed to the caller with one kernel copy each time
+ * it fills up; a size covering a large user buffer lets one getdents request
+ * complete with a single copy. See the corresponding comment in MFS.
+ */
+#define GETDENTS_BUFSIZE	(64 * 1024)
+  static char getdents_buf[GETDENTS_BUFSIZE];
   struct fsdriver_dentry fsdentry;
   struct inode *rip;
   int r, done;
@@ -23,6 +23,7 @@ struct fsdriver ext2_table = {
 	.fdr_getdents	= fs_getdents,
 	.fdr_trunc	= fs_trunc,
 	.fdr_seek	= fs_seek,
+	.fdr_fadvise	= fs_fadvise,
 	.fdr_create	= fs_create,
 	.fdr_mkdir	= fs_mkdir,
 	.fdr_mknod	= fs_mknod,
@@ -43,5 +44,6 @@ struct fsdriver ext2_table = {
 	.fdr_bread	= lmfs_bio,
 	.fdr_bwrite	= lmfs_bio,
 	.fdr_bpeek	= lmfs_bio,
-	.fdr_bflush	= lmfs_bflush
+	.fdr_bflush	= lmfs_bflush,
+	.fdr_other	= lmfs_other
 };
@@ -3,6 +3,7 @@
  */
 
 #include "fs.h"
+#include <string.h>
 #include "buf.h"
 #include "inode.h"
 #include "super.h"
@@ -179,6 +180,54 @@ bit_t setbyte(bitchunk_t *bitmap, bit_t max_bits)
 }
 
 
+/*===========================================================================*
+ *				setbytes   				     *
+ *===========================================================================*/
+bit_t setbytes(bitchunk_t *bitmap, bit_t max_bits, unsigned int max_bytes,
+	unsigned int *nbytes)
+{
+  /* Find a run of up to max_bytes consecutive free bytes in bitmap and set
+   * them. Return number of the starting bit and store the length of the run
+   * in nbytes, if failed return -1.
+   */
+  unsigned char *wptr, *wlim;
+  unsigned int count;
+  bit_t b = -1;
+
+  wptr = (unsigned char*) &bitmap[0];
+  wlim = &wptr[(max_bits >> 3)];
+
+  /* Iterate over the bytes in block. */
+  for ( ; wptr < wlim; wptr++) {
+	/* Is it a free byte? */
+	if (*wptr | 0)
+		continue;
+
+	/* Bit number from the start of the bit map. */
+	b = (wptr - (unsigned char*) &bitmap[0]) * CHAR_BIT;
+
+	/* Don't allocate bits beyond the end of the map. */
+	if (b + CHAR_BIT >= max_bits) {
+		b = -1;
+		continue;
+	}
+
+	/* Extend the run over subsequent free bytes. */
+	count = 1;
+	while (count < max_bytes && &wptr[count] < wlim &&
+	       wptr[count] == 0 &&
+	       b + (bit_t) (count + 1) * CHAR_BIT < max_bits)
+		count++;
+
+	/* Allocate the whole run. */
+	memset(wptr, ~0, count);
+	*nbytes = count;
+	break;
+  }
+  return b;
+}
+
+
 /*===========================================================================*
  *				unsetbit   				     *
  *===========================================================================*/
@@ -5,6 +5,9 @@
  *   write_map:    write a new block into an inode
  *   new_block:    acquire a new block
  *   zero_block:   overwrite a block with zeroes
+ *   delay_get_block: look up a delayed-allocation block for a file position
+ *   delay_flush:  assign device blocks to all delayed blocks of an inode
+ *   delay_discard: drop the delayed blocks of an inode without allocating
  *
  * Created (MFS based):
  *   February 2010 (Evgeniy Ivanov)
@@ -20,6 +23,9 @@
 
 static void wr_indir(struct buf *bp, int index, block_t block);
 static int empty_indir(struct buf *, struct super_block *);
+static struct buf *delay_new_block(struct inode *rip, off_t position);
+static int delay_ok(struct inode *rip);
+static void delay_dispose(struct inode *rip, int i);
 
 /*===========================================================================*
  *				write_map				     *
@@ -65,6 +71,9 @@ int op;				/* special actions */
 
   block_pos = position / rip->i_sp->s_block_size; /* relative blk # in file */
   rip->i_dirt = IN_DIRTY;		/* inode will be changed */
+  rip->i_map_count = 0;	    /* the mapping extent cached by read_map may
+			     * become stale, invalidate it
+			     */
 
   /* Is 'position' to be found in the inode itself? */
   if (block_pos < EXT2_NDIR_BLOCKS) {
@@ -299,6 +308,274 @@ struct super_block *sb;		/* superblock of device block resides on */
   return(1);
 }
 
+/* Delayed allocation.  When a write creates a new block in a regular file,
+ * the data is not assigned a device block right away.  Instead, the block is
+ * held in the buffer cache under a fake block number, pinned by an extra
+ * reference so that neither eviction nor a cache flush can touch it, and its
+ * file position is recorded in the inode.  Only when the delayed set is
+ * flushed--at fsync time, when the inode is released, or when the per-inode
+ * set is full--are device blocks allocated, in one pass sorted by file
+ * position.  Small appends to many files thus no longer interleave their
+ * allocations, and together with the block preallocation window each file
+ * gets contiguous extents sized by what had actually been written.  To keep
+ * writes from succeeding and then failing allocation later, every delayed
+ * block conservatively reserves worst-case space (data plus indirect chain)
+ * against the free block count; when the reservation cannot be made, the
+ * write falls back to immediate allocation.
+ */
+static block_t next_fake_block = EXT2_DELAYED_BASE;
+static u32_t delayed_reserved;	/* # free blocks claimed by delayed data */
+
+/*===========================================================================*
+ *				delay_get_block				     *
+ *===========================================================================*/
+struct buf *delay_get_block(rip, position)
+register struct inode *rip;	/* pointer to inode */
+off_t position;			/* file pointer */
+{
+/* If the block at the given file position has delayed-allocation data, return
+ * its (pinned) cache block with an extra reference, like new_block() would.
+ * Return NULL otherwise.
+ */
+  struct buf *bp;
+  off_t block_pos;
+  int i, r;
+
+  if (rip->i_delayed_count == 0)
+	return(NULL);
+
+  block_pos = rounddown(position, rip->i_sp->s_block_size);
+  for (i = 0; i < rip->i_delayed_count; i++)
+	if (rip->i_delayed_pos[i] == block_pos)
+		break;
+  if (i == rip->i_delayed_count)
+	return(NULL);
+
+  /* The block is pinned in the cache, so this is always a cache hit.  Do not
+   * pass the inode association: the fake block number must stay out of both
+   * the VM cache and the read-ahead engine.
+   */
+  r = lmfs_get_block(&bp, rip->i_dev, rip->i_delayed_fake[i], NORMAL);
+  if (r != OK)
+	panic("ext2: error getting delayed block (%llu,%u): %d", rip->i_dev,
+	    rip->i_delayed_fake[i], r);
+  assert(bp == rip->i_delayed_buf[i]);
+  return(bp);
+}
+
+/*===========================================================================*
+ *				delay_new_block				     *
+ *===========================================================================*/
+static struct buf *delay_new_block(rip, position)
+register struct inode *rip;	/* pointer to inode */
+off_t position;			/* file pointer */
+{
+/* Create a new delayed-allocation block for the given file position, and
+ * return it with an extra reference for the caller.
+ */
+  struct buf *bp;
+  int i, r;
+
+  if (rip->i_delayed_count == EXT2_MAX_DELAYED)
+	delay_flush(rip);
+
+  i = rip->i_delayed_count;
+  rip->i_delayed_pos[i] = rounddown(position, rip->i_sp->s_block_size);
+  rip->i_delayed_fake[i] = next_fake_block++;
+
+  r = lmfs_get_block(&bp, rip->i_dev, rip->i_delayed_fake[i], NO_READ);
+  if (r != OK)
+	panic("ext2: error getting delayed block (%llu,%u): %d", rip->i_dev,
+	    rip->i_delayed_fake[i], r);
+  zero_block(bp);	/* dirty, but pinned: never written to the fake # */
+
+  /* The reference just obtained pins the block in the cache on behalf of the
+   * inode; obtain a second one to hand to the caller.
+   */
+  rip->i_delayed_buf[i] = bp;
+  rip->i_delayed_count = i + 1;
+  delayed_reserved += EXT2_DELAYED_RESERVE;
+
+  if ((r = lmfs_get_block(&bp, rip->i_dev, rip->i_delayed_fake[i],
+      NORMAL)) != OK)
+	panic("ext2: error getting delayed block (%llu,%u): %d", rip->i_dev,
+	    rip->i_delayed_fake[i], r);
+  return(bp);
+}
+
+/*===========================================================================*
+ *				delay_ok				     *
+ *===========================================================================*/
+static int delay_ok(rip)
+register struct inode *rip;	/* pointer to inode */
+{
+/* May allocation of a new block for this inode be delayed? */
+  struct super_block *sp = rip->i_sp;
+
+  /* Only regular file data benefits; directory and symlink blocks are
+   * created through new_block() as well, but must exist on the device by the
+   * time their metadata does.
+   */
+  if ((rip->i_mode & I_TYPE) != I_REGULAR)
+	return(FALSE);
+
+  /* The fake block numbers must not collide with real ones. */
+  if (sp->s_blocks_count >= EXT2_DELAYED_BASE)
+	return(FALSE);
+
+  /* Pinned delayed blocks are exempt from cache eviction and flushing, so
+   * bound their total number across all inodes.
+   */
+  if (delayed_reserved >= EXT2_MAX_DELAYED_TOTAL * EXT2_DELAYED_RESERVE)
+	return(FALSE);
+
+  /* Reserve worst-case space now, so that the allocation at flush time
+   * cannot run into ENOSPC after the write already reported success.
+   */
+  if (sp->s_free_blocks_count <
+      delayed_reserved + EXT2_DELAYED_RESERVE + EXT2_PREALLOC_BLOCKS)
+	return(FALSE);
+
+  return(TRUE);
+}
+
+/*===========================================================================*
+ *				delay_dispose				     *
+ *===========================================================================*/
+static void delay_dispose(rip, i)
+register struct inode *rip;	/* pointer to inode */
+int i;				/* index of the delayed block to dispose */
+{
+/* Drop the pinning reference on a delayed block and purge the fake block
+ * number from the cache.  Fake block numbers are never reused, so a stale
+ * entry could only waste cache space.  The caller is responsible for
+ * releasing the block's space reservation through delay_unreserve().
+ */
+  lmfs_free_block(rip->i_dev, rip->i_delayed_fake[i]);
+  put_block(rip->i_delayed_buf[i]);
+}
+
+/*===========================================================================*
+ *				delay_unreserve				     *
+ *===========================================================================*/
+static void delay_unreserve(void)
+{
+/* Release the space reservation of one delayed block. */
+
+  assert(delayed_reserved >= EXT2_DELAYED_RESERVE);
+  delayed_reserved -= EXT2_DELAYED_RESERVE;
+}
+
+/*===========================================================================*
+ *				delay_reserved_count			     *
+ *===========================================================================*/
+u32_t delay_reserved_count(void)
+{
+/* Return the number of free blocks currently claimed by outstanding delayed
+ * allocation reservations.  Immediate allocations must stay out of this
+ * space; see alloc_block().
+ */
+  return(delayed_reserved);
+}
+
+/*===========================================================================*
+ *				delay_flush				     *
+ *===========================================================================*/
+void delay_flush(rip)
+register struct inode *rip;	/* pointer to inode */
+{
+/* Assign device blocks to all delayed-allocation blocks of the given inode.
+ * The blocks are allocated in file position order, each using the previously
+ * allocated block as its goal, so that the result is one contiguous extent
+ * whenever the bitmap allows it.
+ */
+  struct buf *bp;
+  block_t b, goal;
+  off_t pos;
+  int i, j, r;
+
+  /* Sort the delayed set by file position (insertion sort; the set is small
+   * and writes mostly enter it in order already).
+   */
+  for (i = 1; i < rip->i_delayed_count; i++) {
+	pos = rip->i_delayed_pos[i];
+	b = rip->i_delayed_fake[i];
+	bp = rip->i_delayed_buf[i];
+	for (j = i; j > 0 && rip->i_delayed_pos[j - 1] > pos; j--) {
+		rip->i_delayed_pos[j] = rip->i_delayed_pos[j - 1];
+		rip->i_delayed_fake[j] = rip->i_delayed_fake[j - 1];
+		rip->i_delayed_buf[j] = rip->i_delayed_buf[j - 1];
+	}
+	rip->i_delayed_pos[j] = pos;
+	rip->i_delayed_fake[j] = b;
+	rip->i_delayed_buf[j] = bp;
+  }
+
+  for (i = 0; i < rip->i_delayed_count; i++) {
+	pos = rip->i_delayed_pos[i];
+
+	/* Release this block's reservation up front: the allocations below
+	 * must be able to draw from the reserved space, rather than being
+	 * refused by alloc_block() on behalf of the reservation itself.
+	 */
+	delay_unreserve();
+
+	goal = (rip->i_bsearch != NO_BLOCK) ? rip->i_bsearch + 1 : NO_BLOCK;
+	if ((b = alloc_block(rip, goal)) == NO_BLOCK) {
+		/* Despite the reservation, allocation failed; the data is
+		 * lost.  This should not happen.
+		 */
+		printf("ext2: delayed allocation for inode %llu failed, "
+		    "data lost\n", (unsigned long long)rip->i_num);
+		delay_dispose(rip, i);
+		continue;
+	}
+	if ((r = write_map(rip, pos, b, 0)) != OK) {
+		printf("ext2: delayed write_map failed (%d), data lost\n", r);
+		free_block(rip->i_sp, b);
+		delay_dispose(rip, i);
+		continue;
+	}
+	rip->i_last_pos_bl_alloc = (pos != 0) ? pos : pos + 1;
+
+	/* Copy the data over to the real block, now under the inode
+	 * association that makes it visible to the VM cache.
+	 */
+	r = lmfs_get_block_ino(&bp, rip->i_dev, b, NO_READ, rip->i_num, pos);
+	if (r != OK)
+		panic("ext2: error getting block (%llu,%u): %d", rip->i_dev,
+		    b, r);
+	memcpy(b_data(bp), b_data(rip->i_delayed_buf[i]),
+	    rip->i_sp->s_block_size);
+	lmfs_markdirty(bp);
+	put_block(bp);
+
+	delay_dispose(rip, i);
+  }
+
+  rip->i_delayed_count = 0;
+}
+
+/*===========================================================================*
+ *				delay_discard				     *
+ *===========================================================================*/
+void delay_discard(rip)
+register struct inode *rip;	/* pointer to inode */
+{
+/* Drop all delayed-allocation blocks of the given inode without assigning
+ * device blocks, for when the data is about to be truncated away anyway.
+ */
+  int i;
+
+  /* lmfs_free_block() in delay_dispose() also marks the block clean. */
+  for (i = 0; i < rip->i_delayed_count; i++) {
+	delay_unreserve();
+	delay_dispose(rip, i);
+  }
+
+  rip->i_delayed_count = 0;
+}
+
 /*===========================================================================*
  *				new_block				     *
  *===========================================================================*/
@@ -313,10 +590,20 @@ off_t position;			/* file pointer */
 
   /* Is another block available? */
   if ( (b = read_map(rip, position, 0)) == NO_BLOCK) {
+	block_t goal = NO_BLOCK;
+
+	/* The position may already have delayed-allocation data, in which
+	 * case that block must be returned (and not zeroed!).  Otherwise,
+	 * delay the allocation if possible.
+	 */
+	if ((bp = delay_get_block(rip, position)) != NULL)
+		return(bp);
+	if (delay_ok(rip))
+		return delay_new_block(rip, position);
+
 	/* Check if this position follows last allocated
 	 * block.
 	 */
-	block_t goal = NO_BLOCK;
 	if (rip->i_last_pos_bl_alloc != 0) {
 		off_t position_diff = position - rip->i_last_pos_bl_alloc;
 		if (rip->i_bsearch == 0) {
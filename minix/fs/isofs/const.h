@@ -1,5 +1,8 @@
 
-#define GETDENTS_BUFSIZ         1024
+/* Getdents staging buffer; flushed to the caller with one kernel copy each
+ * time it fills up, so a large size lets big requests finish in one copy.
+ */
+#define GETDENTS_BUFSIZ         (64 * 1024)
 
 #define ISO9660_STANDARD_ID     "CD001" /* Standard code for ISO9660 FS */
 
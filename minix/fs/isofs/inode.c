@@ -129,7 +129,7 @@ int read_directory(struct inode *dir) {
 	num_entries = 0;
 
 	while ((status = read_inode(&entries[cur_entry], &dir->extent,
-	    &pos)) == OK) {
+	    &pos, dir->i_stat.st_ino)) == OK) {
 		/* Dump the entry if it's not to be exported to userland. */
 		if (entries[cur_entry].i_node->skip) {
 			free_inode_dir_entry(&entries[cur_entry]);
@@ -179,7 +179,7 @@ int read_directory(struct inode *dir) {
 	 */
 	while (cur_entry < num_entries) {
 		if (read_inode(&dir->dir_contents[cur_entry], &dir->extent,
-		    &saved_pos) != OK)
+		    &saved_pos, dir->i_stat.st_ino) != OK)
 			panic("unexpected EOF or error rereading directory");
 
 		if (dir->dir_contents[cur_entry].i_node->skip) {
@@ -214,7 +214,7 @@ int check_inodes(void) {
 }
 
 int read_inode(struct inode_dir_entry *dir_entry, struct dir_extent *extent,
-	size_t *offset)
+	size_t *offset, ino_t dir_ino)
 {
 	struct iso9660_dir_record *dir_rec;
 	struct buf *bp;
@@ -223,7 +223,7 @@ int read_inode(struct inode_dir_entry *dir_entry, struct dir_extent *extent,
 	int name_only = FALSE;
 
 	/* Find inode. */
-	bp = read_extent_block(extent, *offset);
+	bp = read_extent_block(extent, *offset, dir_ino);
 	if (bp == NULL) {
 		return EOF;
 	}
@@ -237,7 +237,7 @@ int read_inode(struct inode_dir_entry *dir_entry, struct dir_extent *extent,
 		    v_pri.logical_block_size_l;
 
 		lmfs_put_block(bp);
-		bp = read_extent_block(extent, *offset);
+		bp = read_extent_block(extent, *offset, dir_ino);
 		if (bp == NULL) {
 			return EOF;
 		}
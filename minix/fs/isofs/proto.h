@@ -19,7 +19,7 @@ void dup_inode(struct inode *i_node);
 int read_directory(struct inode *dir);
 
 int read_inode(struct inode_dir_entry *dir_entry, struct dir_extent *extent,
-    size_t *offset);
+    size_t *offset, ino_t dir_ino);
 
 struct inode* inode_cache_get(ino_t ino_nr);
 void inode_cache_add(ino_t ino_nr, struct inode *i_node);
@@ -65,7 +65,8 @@ int parse_susp_rock_ridge(struct rrii_dir_record *dir, char *buffer);
 /* utility.c */
 void free_inode_dir_entry(struct inode_dir_entry *e);
 void free_extent(struct dir_extent *extent);
-struct buf* read_extent_block(struct dir_extent *e, size_t block);
+struct buf* read_extent_block(struct dir_extent *e, size_t offset,
+    ino_t ino_nr);
 size_t get_extent_absolute_block_id(struct dir_extent *e, size_t block);
 
 time_t date7_to_time_t(const u8_t *date);
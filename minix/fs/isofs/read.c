@@ -37,7 +37,8 @@ ssize_t fs_read(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
 			chunk = bytes;
 
 		/* Read 'chunk' bytes. */
-		bp = read_extent_block(&i_node->extent, pos);
+		bp = read_extent_block(&i_node->extent, pos,
+		    i_node->i_stat.st_ino);
 		if (bp == NULL)
 			panic("bp not valid in rw_chunk; this can't happen");
 
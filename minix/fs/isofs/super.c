@@ -60,7 +60,8 @@ static int create_vol_pri_desc(struct iso9660_vol_pri_desc *vol_pri, char *buf)
 	if (root_record->data_length_l % vol_pri->logical_block_size_l)
 		extent.length++;
 
-	if (read_inode(&dir_entry, &extent, &dummy_offset) != OK) {
+	if (read_inode(&dir_entry, &extent, &dummy_offset,
+	    VMC_NO_INODE) != OK) {
 		return EINVAL;
 	}
 
@@ -39,7 +39,7 @@ void parse_susp_rock_ridge_plcl(struct rrii_dir_record *dir, u32_t block) {
 
 	memset(&dummy_dir_entry, 0, sizeof(struct inode_dir_entry));
 	/* XXX what if this fails? */
-	read_inode(&dummy_dir_entry, &extent, &dummy_offset);
+	read_inode(&dummy_dir_entry, &extent, &dummy_offset, VMC_NO_INODE);
 	free(dummy_dir_entry.r_name);
 	dir->reparented_inode = dummy_dir_entry.i_node;
 }
@@ -28,5 +28,6 @@ struct fsdriver isofs_table = {
 #if 0 /* FIXME: isofs uses subpage block sizes */
 	.fdr_bpeek	= lmfs_bio,
 #endif
-	.fdr_bflush	= lmfs_bflush
+	.fdr_bflush	= lmfs_bflush,
+	.fdr_other	= lmfs_other
 };
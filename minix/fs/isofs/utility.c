@@ -17,14 +17,26 @@ void free_inode_dir_entry(struct inode_dir_entry *e) {
 	e->r_name = NULL;
 }
 
-struct buf* read_extent_block(struct dir_extent *e, size_t block) {
-	size_t block_id = get_extent_absolute_block_id(e, block);
+struct buf* read_extent_block(struct dir_extent *e, size_t offset,
+	ino_t ino_nr) {
+	size_t block_id = get_extent_absolute_block_id(e, offset);
 	struct buf *bp;
+	int r;
 
 	if (block_id == 0 || block_id >= v_pri.volume_space_size_l)
 		return NULL;
 
-	if(lmfs_get_block(&bp, fs_dev, block_id, NORMAL) != OK)
+	/* Associate the block with the inode it belongs to, so that the
+	 * sequential read-ahead engine can track the access stream, and so
+	 * that the block can be cached by inode in the secondary VM cache.
+	 */
+	if (ino_nr != VMC_NO_INODE)
+		r = lmfs_get_block_ino(&bp, fs_dev, block_id, NORMAL, ino_nr,
+		    rounddown(offset, v_pri.logical_block_size_l));
+	else
+		r = lmfs_get_block(&bp, fs_dev, block_id, NORMAL);
+
+	if (r != OK)
 		return NULL;
 
 	return bp;
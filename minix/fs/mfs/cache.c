@@ -16,6 +16,43 @@
 #include "super.h"
 #include "inode.h"
 
+/* Freed blocks are batched into one contiguous extent and passed down to the
+ * device driver as a discard (TRIM) request, so that flash-based devices can
+ * reclaim the underlying storage.  Discarding is purely advisory: on the first
+ * driver error, typically ENOTSUP from a driver without discard support, we
+ * simply stop issuing requests.  The extent is capped so that its byte size
+ * always fits in a size_t.
+ */
+#define DISCARD_MAX_BLOCKS	0x10000	/* flush the extent beyond this size */
+
+static struct {
+  block_t block;		/* first block of the pending extent */
+  block_t count;		/* number of blocks in the pending extent */
+  int enabled;			/* cleared after a driver error */
+} discard = { NO_BLOCK, 0, TRUE };
+
+/*===========================================================================*
+ *				discard_flush				     *
+ *===========================================================================*/
+void discard_flush(void)
+{
+/* Pass the pending extent of freed blocks, if any, to the device driver as a
+ * discard request.  Stop issuing discard requests after the first failure.
+ */
+  struct super_block *sp;
+  int r;
+
+  if (discard.enabled && discard.count > 0) {
+	sp = &superblock;
+	r = bdev_discard(sp->s_dev, (u64_t) discard.block * sp->s_block_size,
+		(size_t) discard.count * sp->s_block_size);
+	if (r != OK)
+		discard.enabled = FALSE;
+  }
+  discard.block = NO_BLOCK;
+  discard.count = 0;
+}
+
 /*===========================================================================*
  *				get_block				     *
  *===========================================================================*/
@@ -76,7 +113,16 @@ zone_t alloc_zone(
   }
   print_oos_msg = 1;
   if (z == sp->s_firstdatazone) sp->s_zsearch = b;	/* for next time */
-  return( (zone_t) (sp->s_firstdatazone - 1) + (zone_t) b);
+  z = (zone_t) (sp->s_firstdatazone - 1) + (zone_t) b;
+
+  /* If the zone is part of the pending discard extent, issue the discard
+   * now, so that it cannot reach the device after the zone's new contents.
+   */
+  if (discard.count > 0 && (block_t) z >= discard.block &&
+	(block_t) z < discard.block + discard.count)
+	discard_flush();
+
+  return(z);
 }
 
 /*===========================================================================*
@@ -106,4 +152,23 @@ void free_zone(
    */
   assert(sp->s_log_zone_size == 0); /* otherwise we need a loop here.. */
   lmfs_free_block(dev, (block_t)numb);
+
+  /* Add the block to the pending discard extent, merging adjacent frees into
+   * one request.  Truncation frees zones in descending order, so merge in
+   * both directions.  A free that is not adjacent to the extent flushes it.
+   */
+  if (discard.enabled) {
+	if (discard.count > 0 && (block_t) numb == discard.block + discard.count)
+		discard.count++;
+	else if (discard.count > 0 && (block_t) numb == discard.block - 1) {
+		discard.block = (block_t) numb;
+		discard.count++;
+	} else {
+		discard_flush();
+		discard.block = (block_t) numb;
+		discard.count = 1;
+	}
+	if (discard.count >= DISCARD_MAX_BLOCKS)
+		discard_flush();
+  }
 }
@@ -5,15 +5,12 @@
 #define V2_NR_DZONES       7	/* # direct zone numbers in a V2 inode */
 #define V2_NR_TZONES      10	/* total # zone numbers in a V2 inode */
 
-#define NR_INODES        512	/* # slots in "in core" inode table,
+#define NR_INODES        512	/* default # slots in "in core" inode table,
 				 * should be more or less the same as
-				 * NR_VNODES in vfs
+				 * NR_VNODES in vfs; the actual number may be
+				 * set with the "inodes" environment setting
 				 */
 
-#define INODE_HASH_LOG2   7     /* 2 based logarithm of the inode hash size */
-#define INODE_HASH_SIZE   ((unsigned long)1<<INODE_HASH_LOG2)
-#define INODE_HASH_MASK   (((unsigned long)1<<INODE_HASH_LOG2)-1)
-
 /* Max. filename length */
 #define MFS_NAME_MAX	 MFS_DIRSIZ
 
@@ -17,6 +17,7 @@
  */
 
 #include "fs.h"
+#include <stdlib.h>
 #include "buf.h"
 #include "inode.h"
 #include "super.h"
@@ -71,20 +72,43 @@ void init_inode_cache()
 {
   struct inode *rip;
   struct inodelist *rlp;
+  unsigned long nr_hash_slots;
+  long slots;
 
   inode_cache_hit = 0;
   inode_cache_miss = 0;
 
+  /* The size of the inode table may be overridden from the environment. */
+  slots = NR_INODES;
+  env_parse("inodes", "d", 0, &slots, 1L, 1024L * 1024L);
+  nr_inodes = (unsigned int) slots;
+
+  inode = malloc(nr_inodes * sizeof(inode[0]));
+  if (inode == NULL)
+      panic("cannot allocate inode table of %u slots", nr_inodes);
+
+  /* Use the lowest power of two of at least the table size as the number of
+   * hash buckets, so that the chains stay short as the table grows.
+   */
+  for (nr_hash_slots = 1; nr_hash_slots < nr_inodes; nr_hash_slots <<= 1)
+      ;
+  inode_hash_mask = nr_hash_slots - 1;
+
+  hash_inodes = malloc(nr_hash_slots * sizeof(hash_inodes[0]));
+  if (hash_inodes == NULL)
+      panic("cannot allocate %lu inode hash buckets", nr_hash_slots);
+
   /* init free/unused list */
   TAILQ_INIT(&unused_inodes);
-  
+
   /* init hash lists */
-  for (rlp = &hash_inodes[0]; rlp < &hash_inodes[INODE_HASH_SIZE]; ++rlp) 
+  for (rlp = &hash_inodes[0]; rlp < &hash_inodes[nr_hash_slots]; ++rlp)
       LIST_INIT(rlp);
 
   /* add free inodes to unused/free list */
-  for (rip = &inode[0]; rip < &inode[NR_INODES]; ++rip) {
+  for (rip = &inode[0]; rip < &inode[nr_inodes]; ++rip) {
       rip->i_num = NO_ENTRY;
+      rip->i_count = 0;
       TAILQ_INSERT_HEAD(&unused_inodes, rip, i_unused);
   }
 }
@@ -93,9 +117,9 @@ void init_inode_cache()
 /*===========================================================================*
  *				addhash_inode   			     *
  *===========================================================================*/
-static void addhash_inode(struct inode *node) 
+static void addhash_inode(struct inode *node)
 {
-  int hashi = (int) (node->i_num & INODE_HASH_MASK);
+  int hashi = (int) (node->i_num & inode_hash_mask);
   
   /* insert into hash table */
   LIST_INSERT_HEAD(&hash_inodes[hashi], node, i_hash);
@@ -126,7 +150,7 @@ struct inode *get_inode(
   register struct inode *rip;
   int hashi;
 
-  hashi = (int) (numb & INODE_HASH_MASK);
+  hashi = (int) (numb & inode_hash_mask);
 
   /* Search inode in the hash table */
   LIST_FOREACH(rip, &hash_inodes[hashi], i_hash) {
@@ -187,7 +211,7 @@ struct inode *find_inode(
   struct inode *rip;
   int hashi;
 
-  hashi = (int) (numb & INODE_HASH_MASK);
+  hashi = (int) (numb & inode_hash_mask);
 
   /* Search inode in the hash table */
   LIST_FOREACH(rip, &hash_inodes[hashi], i_hash) {
@@ -46,14 +46,17 @@ EXTERN struct inode {
 
   LIST_ENTRY(inode) i_hash;     /* hash list */
   TAILQ_ENTRY(inode) i_unused;  /* free and unused list */
-  
-} inode[NR_INODES];
 
-/* list of unused/free inodes */ 
+} *inode;			/* inode table, allocated at startup */
+
+EXTERN unsigned int nr_inodes;	/* number of slots in the inode table */
+
+/* list of unused/free inodes */
 EXTERN TAILQ_HEAD(unused_inodes_t, inode)  unused_inodes;
 
-/* inode hashtable */
-EXTERN LIST_HEAD(inodelist, inode)         hash_inodes[INODE_HASH_SIZE];
+/* inode hashtable, allocated at startup along with the inode table */
+EXTERN LIST_HEAD(inodelist, inode)         *hash_inodes;
+EXTERN unsigned long inode_hash_mask;	/* # hash buckets minus one */
 
 EXTERN unsigned int inode_cache_hit;
 EXTERN unsigned int inode_cache_miss;
@@ -51,12 +51,10 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
 
   lmfs_may_use_vmcache(1);
 
-  /* Init inode table */
-  for (i = 0; i < NR_INODES; ++i) {
-	inode[i].i_count = 0;
+  for (i = 0; i < NR_INODES; ++i)
 	cch[i] = 0;
-  }
-	
+
+  /* Init inode table */
   init_inode_cache();
 
   lmfs_buf_pool(DEFAULT_NR_BUFS);
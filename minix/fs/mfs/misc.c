@@ -15,9 +15,14 @@ void fs_sync(void)
   struct inode *rip;
 
   /* Write all the dirty inodes to the disk. */
-  for(rip = &inode[0]; rip < &inode[NR_INODES]; rip++)
+  for(rip = &inode[0]; rip < &inode[nr_inodes]; rip++)
 	  if(rip->i_count > 0 && IN_ISDIRTY(rip)) rw_inode(rip, WRITING);
 
   /* Write all the dirty blocks to the disk. */
   lmfs_flushall();
+
+  /* Pass any pending extent of freed blocks to the driver as a discard
+   * request, now that the bitmap updates covering it have been written.
+   */
+  discard_flush();
 }
@@ -87,6 +87,9 @@ int fs_mount(dev_t dev, unsigned int flags, struct fsdriver_node *root_node,
 
   *res_flags = RES_NOFLAGS;
 
+  /* Publish this mount's performance statistics through the MIB service. */
+  stats_mib_register(fs_dev);
+
   /* Mark it dirty */
   if(!superblock.s_rd_only) {
 	  superblock.s_flags &= ~MFSFLAG_CLEAN;
@@ -142,7 +145,7 @@ void fs_unmount(void)
    * check only: VFS expects the unmount to succeed either way.
    */
   count = 0;
-  for (rip = &inode[0]; rip < &inode[NR_INODES]; rip++) 
+  for (rip = &inode[0]; rip < &inode[nr_inodes]; rip++)
 	  if (rip->i_count > 0 && rip->i_dev == fs_dev) count += rip->i_count;
   if (count != 1)
 	printf("MFS: file system has %d in-use inodes!\n", count);
@@ -167,6 +170,9 @@ void fs_unmount(void)
   /* Throw out blocks out of the VM cache, to prevent corruption later. */
   lmfs_invalidate(fs_dev);
 
+  /* Withdraw this mount's statistics subtree from the MIB service. */
+  stats_mib_deregister();
+
   /* Finish off the unmount. */
   superblock.s_dev = NO_DEV;
 }
@@ -10,6 +10,92 @@
 #include "super.h"
 
 
+/* Directory entry position cache.  For each known (directory, name) pair, the
+ * cache stores the byte position of the name's entry in that directory, so
+ * that a repeated lookup does not have to scan the directory blocks again.
+ * This matters in particular for large directories.  A cached position is
+ * always verified against the actual directory entry before it is used, so a
+ * stale cache entry merely results in falling back to the linear scan.  The
+ * cache is direct-mapped: entering a name simply evicts the previous occupant
+ * of its hash slot.
+ */
+#define NR_DCACHE_SLOTS	512	/* number of cached entry positions */
+
+static struct dcache {
+  ino_t dc_dir;			/* directory inode number, 0 iff slot unused */
+  dev_t dc_dev;			/* device number of the directory */
+  off_t dc_pos;			/* byte position of the entry in the dir */
+  char dc_name[MFS_NAME_MAX];	/* entry name, not necessarily terminated */
+} dcache[NR_DCACHE_SLOTS];
+
+/*===========================================================================*
+ *				dcache_slot				     *
+ *===========================================================================*/
+static struct dcache *dcache_slot(struct inode *ldir_ptr, const char *string)
+{
+/* Return the cache slot that may hold the entry position for the given name
+ * in the given directory.
+ */
+  unsigned int i, h;
+
+  h = (unsigned int) ldir_ptr->i_num ^ (unsigned int) ldir_ptr->i_dev;
+  for (i = 0; i < MFS_NAME_MAX && string[i] != '\0'; i++)
+	h = h * 31 + (unsigned char) string[i];
+
+  return(&dcache[h % NR_DCACHE_SLOTS]);
+}
+
+/*===========================================================================*
+ *				dcache_enter				     *
+ *===========================================================================*/
+static void dcache_enter(struct inode *ldir_ptr, const char *string, off_t pos)
+{
+/* Remember that the given name has its entry at the given byte position in
+ * the given directory, evicting the slot's previous occupant if any.
+ */
+  struct dcache *dcp;
+
+  dcp = dcache_slot(ldir_ptr, string);
+  dcp->dc_dir = ldir_ptr->i_num;
+  dcp->dc_dev = ldir_ptr->i_dev;
+  dcp->dc_pos = pos;
+  (void) strncpy(dcp->dc_name, string, sizeof(dcp->dc_name));
+}
+
+/*===========================================================================*
+ *				dcache_find				     *
+ *===========================================================================*/
+static off_t dcache_find(struct inode *ldir_ptr, const char *string)
+{
+/* Return the cached byte position of the given name's entry in the given
+ * directory, or -1 if no position is cached for it.
+ */
+  struct dcache *dcp;
+
+  dcp = dcache_slot(ldir_ptr, string);
+  if (dcp->dc_dir != ldir_ptr->i_num || dcp->dc_dev != ldir_ptr->i_dev ||
+      strncmp(dcp->dc_name, string, sizeof(dcp->dc_name)) != 0)
+	return(-1);
+
+  return(dcp->dc_pos);
+}
+
+/*===========================================================================*
+ *				dcache_delete				     *
+ *===========================================================================*/
+static void dcache_delete(struct inode *ldir_ptr, const char *string)
+{
+/* The given name is being removed from the given directory; forget its cached
+ * entry position, if any.
+ */
+  struct dcache *dcp;
+
+  dcp = dcache_slot(ldir_ptr, string);
+  if (dcp->dc_dir == ldir_ptr->i_num && dcp->dc_dev == ldir_ptr->i_dev)
+	dcp->dc_dir = 0;	/* mark the slot as unused */
+}
+
+
 /*===========================================================================*
  *                             fs_lookup				     *
  *===========================================================================*/
@@ -119,7 +205,29 @@ int flag;			 /* LOOK_UP, ENTER, DELETE or IS_EMPTY */
 
   if((flag == DELETE || flag == ENTER) && ldir_ptr->i_sp->s_rd_only)
 	return EROFS;
-  
+
+  /* For lookups, first try the entry position cached for this name, if any.
+   * The cached position must be verified against the actual entry, since it
+   * may have become stale.  If it has, fall through to the linear scan.
+   */
+  if (flag == LOOK_UP && (pos = dcache_find(ldir_ptr, string)) >= 0 &&
+      pos < ldir_ptr->i_size) {
+	if ((bp = get_block_map(ldir_ptr, (u64_t) pos)) != NULL) {
+		dp = &b_dir(bp)[((unsigned) pos %
+		    ldir_ptr->i_sp->s_block_size) / DIR_ENTRY_SIZE];
+		if (dp->mfs_d_ino != NO_ENTRY &&
+		    strncmp(dp->mfs_d_name, string,
+			sizeof(dp->mfs_d_name)) == 0) {
+			sp = ldir_ptr->i_sp;
+			*numb = (ino_t) conv4(sp->s_native,
+			    (int) dp->mfs_d_ino);
+			put_block(bp);
+			return(OK);
+		}
+		put_block(bp);
+	}
+  }
+
   /* Step through the directory one block at a time. */
   old_slots = (unsigned) (ldir_ptr->i_size/DIR_ENTRY_SIZE);
   new_slots = 0;
@@ -179,10 +287,13 @@ int flag;			 /* LOOK_UP, ENTER, DELETE or IS_EMPTY */
 				IN_MARKDIRTY(ldir_ptr);
 				if (pos < ldir_ptr->i_last_dpos)
 					ldir_ptr->i_last_dpos = pos;
+				dcache_delete(ldir_ptr, string);
 			} else {
 				sp = ldir_ptr->i_sp;	/* 'flag' is LOOK_UP */
 				*numb = (ino_t) conv4(sp->s_native,
 						      (int) dp->mfs_d_ino);
+				dcache_enter(ldir_ptr, string, (off_t)
+				    (new_slots - 1) * DIR_ENTRY_SIZE);
 			}
 			put_block(bp);
 			return(r);
@@ -225,10 +336,11 @@ int flag;			 /* LOOK_UP, ENTER, DELETE or IS_EMPTY */
   /* 'bp' now points to a directory block with space. 'dp' points to slot. */
   (void) memset(dp->mfs_d_name, 0, (size_t) MFS_NAME_MAX); /* clear entry */
   for (i = 0; i < MFS_NAME_MAX && string[i]; i++) dp->mfs_d_name[i] = string[i];
-  sp = ldir_ptr->i_sp; 
+  sp = ldir_ptr->i_sp;
   dp->mfs_d_ino = conv4(sp->s_native, (int) *numb);
   MARKDIRTY(bp);
   put_block(bp);
+  dcache_enter(ldir_ptr, string, (off_t) (new_slots - 1) * DIR_ENTRY_SIZE);
   ldir_ptr->i_update |= CTIME | MTIME;	/* mark mtime for update later */
   IN_MARKDIRTY(ldir_ptr);
   if (new_slots > old_slots) {
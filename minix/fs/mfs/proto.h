@@ -14,6 +14,7 @@ struct super_block;
 
 /* cache.c */
 zone_t alloc_zone(dev_t dev, zone_t z);
+void discard_flush(void);
 void free_zone(dev_t dev, zone_t numb);
 struct buf *get_block(dev_t dev, block_t block, int how);
 
@@ -55,6 +56,7 @@ int fs_mknod(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid,
 int fs_slink(ino_t dir_nr, char *name, uid_t uid, gid_t gid,
 	struct fsdriver_data *data, size_t bytes);
 void fs_seek(ino_t ino_nr);
+int fs_fadvise(ino_t ino_nr, int advice);
 
 /* path.c */
 int fs_lookup(ino_t dir_nr, char *name, struct fsdriver_node *node,
@@ -89,6 +91,8 @@ int write_super(struct super_block *sp);
 
 /* stats.c */
 bit_t count_free_bits(struct super_block *sp, int map);
+void stats_mib_register(dev_t dev);
+void stats_mib_deregister(void);
 
 /* time.c */
 int fs_utime(ino_t ino_t, struct timespec *atime, struct timespec *mtime);
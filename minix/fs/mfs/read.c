@@ -324,6 +324,115 @@ int index;			/* index into *bp */
   return(zone);
 }
 
+/*===========================================================================*
+ *				read_map_run				     *
+ *===========================================================================*/
+static unsigned int read_map_run(rip, position, max_blocks, first)
+register struct inode *rip;	/* ptr to inode to map from */
+off_t position;			/* position of the first block in the run */
+unsigned int max_blocks;	/* maximum number of blocks to map */
+block_t *first;			/* resulting first block of the run */
+{
+/* Starting at the given position within the file, determine the length (in
+ * blocks) of the run of contiguous device blocks that make up this part of
+ * the file, up to the given maximum.  The mapping is derived from the zone
+ * pointers in the inode and in indirect blocks, but only indirect blocks
+ * already in the cache are used: no I/O is performed here.  If an uncached
+ * indirect block cuts the run short and is itself contiguous with the run,
+ * it is included as the run's last block, so that it is read in along with
+ * the data and can be used the next time we get here.  Return the length of
+ * the run, storing its first block number in 'first'.  A return value of
+ * zero indicates a hole or an uncached indirect block at the position.
+ */
+  struct buf *bp;
+  zone_t z, expected;
+  int scale, boff, index;
+  unsigned int dzones, nr_indirects, zblocks, count;
+  unsigned long excess, zone, block_pos;
+
+  scale = rip->i_sp->s_log_zone_size;	/* for block-zone conversion */
+  block_pos = position/rip->i_sp->s_block_size;	/* relative blk # in file */
+  zone = block_pos >> scale;	/* position's zone */
+  boff = (int) (block_pos - (zone << scale) ); /* relative blk # within zone */
+  dzones = rip->i_ndzones;
+  nr_indirects = rip->i_nindirs;
+  zblocks = 1 << scale;		/* number of blocks per zone */
+
+  count = 0;
+  expected = NO_ZONE;
+
+  while (count < max_blocks) {
+	/* Find the zone pointer for file zone 'zone', using only indirect
+	 * blocks that are already in the cache.
+	 */
+	if (zone < dzones) {
+		z = rip->i_zone[(int) zone];
+	} else {
+		excess = zone - dzones;
+
+		if (excess < nr_indirects) {
+			/* The zone pointer is in the single indirect block. */
+			z = rip->i_zone[dzones];
+		} else {
+			/* The zone pointer must be located via the double
+			 * indirect block.
+			 */
+			if ((z = rip->i_zone[dzones+1]) == NO_ZONE) break;
+			excess -= nr_indirects;
+			index = (int) (excess/nr_indirects);
+			if ((unsigned int) index > rip->i_nindirs)
+				break;	/* can't go beyond double indirects */
+			bp = get_block(rip->i_dev, (block_t) (z << scale),
+				PEEK);
+			if (bp == NULL) {
+				/* The double indirect block is not cached.
+				 * Append it to the run if contiguous.
+				 */
+				if (expected == NO_ZONE || z == expected) {
+					if (count == 0)
+						*first = (block_t)(z << scale);
+					count++;
+				}
+				break;
+			}
+			z = rd_indir(bp, index);
+			put_block(bp);
+			excess = excess % nr_indirects;
+		}
+
+		if (z == NO_ZONE) break;
+		bp = get_block(rip->i_dev, (block_t) (z << scale), PEEK);
+		if (bp == NULL) {
+			/* The single indirect block is not cached.  Append it
+			 * to the run if contiguous.
+			 */
+			if (expected == NO_ZONE || z == expected) {
+				if (count == 0)
+					*first = (block_t) (z << scale);
+				count++;
+			}
+			break;
+		}
+		z = rd_indir(bp, (int) excess);
+		put_block(bp);
+	}
+
+	if (z == NO_ZONE) break;		/* hole in the file */
+	if (expected != NO_ZONE && z != expected)
+		break;				/* end of the contiguous run */
+
+	if (count == 0)
+		*first = (block_t) ((z << scale) + boff);
+	count += zblocks - boff;
+	boff = 0;
+	expected = z + 1;
+	zone++;
+  }
+
+  if (count > max_blocks) count = max_blocks;
+  return(count);
+}
+
 /*===========================================================================*
  *				rahead					     *
  *===========================================================================*/
@@ -342,10 +451,9 @@ unsigned bytes_ahead;		/* bytes beyond position for immediate use */
  */
 /* Minimum number of blocks to prefetch. */
 # define BLOCKS_MINIMUM		32
-  int r, scale, read_q_size;
-  unsigned int blocks_ahead, fragment, block_size;
-  block_t block, blocks_left;
-  off_t ind1_pos;
+  int r, read_q_size;
+  unsigned int i, run_len, blocks_ahead, fragment, block_size;
+  block_t block, run_block, blocks_left;
   dev_t dev;
   struct buf *bp;
   static block64_t read_q[LMFS_MAX_PREFETCH];
@@ -384,23 +492,14 @@ unsigned bytes_ahead;		/* bytes beyond position for immediate use */
    * read as much as you can.  With luck the caching on the drive allows
    * for a little time to start the next read.
    *
-   * The current solution below is a bit of a hack, it just reads blocks from
-   * the current file position hoping that more of the file can be found.  A
-   * better solution must look at the already available zone pointers and
-   * indirect blocks (but don't call read_map!).
+   * The blocks to read are determined by following runs of contiguous zones
+   * through the zone pointers in the inode and any cached indirect blocks,
+   * so that each run can be read from the driver in one request.
    */
 
   blocks_left = (block_t) (rip->i_size-ex64lo(position)+(block_size-1)) /
 								block_size;
 
-  /* Go for the first indirect block if we are in its neighborhood. */
-  scale = rip->i_sp->s_log_zone_size;
-  ind1_pos = (off_t) rip->i_ndzones * (block_size << scale);
-  if ((off_t) ex64lo(position) <= ind1_pos && rip->i_size > ind1_pos) {
-	blocks_ahead++;
-	blocks_left++;
-  }
-
   /* Read at least the minimum number of blocks, but not after a seek. */
   if (blocks_ahead < BLOCKS_MINIMUM && rip->i_seek == NO_SEEK)
 	blocks_ahead = BLOCKS_MINIMUM;
@@ -413,33 +512,41 @@ unsigned bytes_ahead;		/* bytes beyond position for immediate use */
 
   read_q_size = 0;
 
-  /* Acquire block buffers. */
-  for (;;) {
-  	block_t thisblock;
-	read_q[read_q_size++] = block;
-
-	if (--blocks_ahead == 0) break;
-
-	block++;
-	position_running += block_size;
-
-	thisblock = read_map(rip, (off_t) ex64lo(position_running), 1);
-	if (thisblock != NO_BLOCK) {
-		r = lmfs_get_block_ino(&bp, dev, thisblock, PEEK, rip->i_num,
-		    position_running);
-		block = thisblock;
-	} else
-		r = lmfs_get_block(&bp, dev, block, PEEK);
+  /* Collect the blocks to read ahead, following runs of contiguous zones as
+   * far as the zone pointers and cached indirect blocks allow.  Stop at a
+   * hole, or when a block is already in the cache: in the latter case, the
+   * rest of the range is likely to be in the cache as well.
+   */
+  while (blocks_ahead > 0) {
+	run_len = read_map_run(rip, (off_t) ex64lo(position_running),
+		blocks_ahead, &run_block);
+
+	if (run_len == 0) break;	/* hole or uncached indirect block */
+
+	for (i = 0; i < run_len; i++) {
+		if (read_q_size > 0) {
+			r = lmfs_get_block_ino(&bp, dev, run_block, PEEK,
+			    rip->i_num, position_running);
+			if (r == OK) {
+				/* Oops, block already in the cache, get out.*/
+				put_block(bp);
+				break;
+			}
+			if (r != ENOENT)
+				panic("MFS: error getting block (%llu,%u): %d",
+				    dev, run_block, r);
+		}
 
-	if (r == OK) {
-		/* Oops, block already in the cache, get out. */
-		put_block(bp);
-		break;
+		read_q[read_q_size++] = run_block++;
+		blocks_ahead--;
+		position_running += block_size;
 	}
-	if (r != ENOENT)
-		panic("MFS: error getting block (%llu,%u): %d", dev, block, r);
+
+	if (i < run_len) break;		/* found a cached block above */
   }
-  lmfs_prefetch(dev, read_q, read_q_size);
+
+  if (read_q_size > 0)
+	lmfs_prefetch(dev, read_q, read_q_size);
 
   r = lmfs_get_block_ino(&bp, dev, baseblock, NORMAL, rip->i_num, position);
   if (r != OK)
@@ -454,9 +561,14 @@ unsigned bytes_ahead;		/* bytes beyond position for immediate use */
 ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
 	off_t *posp)
 {
-#define GETDENTS_BUFSIZE	(sizeof(struct dirent) + MFS_NAME_MAX + 1)
-#define GETDENTS_ENTRIES	8
-  static char getdents_buf[GETDENTS_BUFSIZE * GETDENTS_ENTRIES];
+/* The staging buffer is flushed to the caller with one kernel copy each time
+ * it fills up, so its size determines how many kernel calls are needed to
+ * satisfy a large getdents request. Size it to cover a large user buffer in
+ * a single copy; enumerating a huge directory is then bounded by the number
+ * of getdents calls rather than by per-entry-batch copy overhead.
+ */
+#define GETDENTS_BUFSIZE	(64 * 1024)
+  static char getdents_buf[GETDENTS_BUFSIZE];
   struct fsdriver_dentry fsdentry;
   struct inode *rip, *entrip;
   int r, done;
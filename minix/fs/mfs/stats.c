@@ -1,8 +1,12 @@
 #include "fs.h"
 #include <string.h>
+#include <stdio.h>
 #include <minix/com.h>
 #include <assert.h>
 #include <minix/u64.h>
+#include <minix/rmib.h>
+#include <minix/sysctl.h>
+#include <minix/vfsif.h>
 #include "buf.h"
 #include "inode.h"
 #include "super.h"
@@ -87,3 +91,95 @@ int map;			/* IMAP (inode map) or ZMAP (zone map) */
   } while (--bcount > 0);
   return free_bits;
 }
+
+/* While mounted, each MFS instance publishes a minix.fs.<name> subtree with
+ * per-mount performance statistics, where <name> is derived from the device
+ * the instance serves.  The subtree contains the buffer cache counters kept
+ * by libminixfs and the per-request-type counters kept by libfsdriver.
+ */
+static char stats_mib_name[16];
+
+static struct rmib_node stats_mib_cache_table[] = {
+	RMIB_QUADPTR(RMIB_RO, &lmfs_stats.ls_hits, "hits",
+	    "Block lookups satisfied from the buffer cache"),
+	RMIB_QUADPTR(RMIB_RO, &lmfs_stats.ls_vmhits, "vmhits",
+	    "Block lookups satisfied from the VM secondary cache"),
+	RMIB_QUADPTR(RMIB_RO, &lmfs_stats.ls_misses, "misses",
+	    "Block lookups that required a device read"),
+	RMIB_QUADPTR(RMIB_RO, &lmfs_stats.ls_rablocks, "rablocks",
+	    "Blocks fetched by the read-ahead engine"),
+	RMIB_QUADPTR(RMIB_RO, &lmfs_stats.ls_raused, "raused",
+	    "Read-ahead blocks that were later actually looked up"),
+};
+
+/* These two tables are filled at registration time, from the request names
+ * that libfsdriver exports.  Entries for unimplemented requests stay zeroed
+ * and are skipped by the RMIB code.
+ */
+static struct rmib_node stats_mib_calls_table[NREQS];
+static struct rmib_node stats_mib_cycles_table[NREQS];
+
+static struct rmib_node stats_mib_table[] = {
+	RMIB_NODE(RMIB_RO, stats_mib_cache_table, "cache",
+	    "Buffer cache statistics"),
+	RMIB_NODE(RMIB_RO, stats_mib_calls_table, "calls",
+	    "Number of requests handled, per request type"),
+	RMIB_NODE(RMIB_RO, stats_mib_cycles_table, "cycles",
+	    "TSC cycles spent handling requests, per request type"),
+};
+
+static struct rmib_node stats_mib_node = RMIB_NODE(RMIB_RO, stats_mib_table,
+    stats_mib_name, "MFS per-mount statistics");
+
+/*===========================================================================*
+ *				stats_mib_register			     *
+ *===========================================================================*/
+void stats_mib_register(dev_t dev)
+{
+/* Publish the minix.fs.<name> subtree for the newly mounted device.  The
+ * device number doubles as the node identifier, which keeps the identifier
+ * unique among file server instances.
+ */
+  const int mib[] = { CTL_MINIX, MINIX_FS, (int)dev };
+  struct rmib_node *np;
+  unsigned int i;
+  int r;
+
+  for (i = 0; i < NREQS; i++) {
+	if (fsdriver_callnames[i] == NULL)
+		continue;
+
+	np = &stats_mib_calls_table[i];
+	np->rnode_flags = CTLTYPE_QUAD | CTLFLAG_PERMANENT | RMIB_RO;
+	np->rnode_size = sizeof(u_quad_t);
+	np->rnode_data = &fsdriver_stats[i].fst_calls;
+	np->rnode_name = fsdriver_callnames[i];
+	np->rnode_desc = "Number of requests handled";
+
+	np = &stats_mib_cycles_table[i];
+	np->rnode_flags = CTLTYPE_QUAD | CTLFLAG_PERMANENT | RMIB_RO;
+	np->rnode_size = sizeof(u_quad_t);
+	np->rnode_data = &fsdriver_stats[i].fst_cycles;
+	np->rnode_name = fsdriver_callnames[i];
+	np->rnode_desc = "TSC cycles spent handling requests";
+  }
+
+  snprintf(stats_mib_name, sizeof(stats_mib_name), "mfs_%llx",
+	(unsigned long long)dev);
+
+  /* Only local failures are reported; remote failures are silently ignored.
+   * Either way, the file system works fine without the subtree.
+   */
+  if ((r = rmib_register(mib, __arraycount(mib), &stats_mib_node)) != OK)
+	printf("MFS: unable to register remote MIB tree (%d)\n", r);
+}
+
+/*===========================================================================*
+ *				stats_mib_deregister			     *
+ *===========================================================================*/
+void stats_mib_deregister(void)
+{
+/* Withdraw the statistics subtree; the file system is being unmounted. */
+
+  (void)rmib_deregister(&stats_mib_node);
+}
@@ -11,6 +11,7 @@
  */
 
 #include "fs.h"
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <minix/com.h>
@@ -23,6 +24,101 @@
 #include "super.h"
 #include "const.h"
 
+/* In-memory summary of the bit maps.  For every bitmap block we keep the
+ * number of free bits it contains and the first word that may hold a free
+ * bit, maintained incrementally by alloc_bit() and free_bit().  This lets
+ * alloc_bit() skip blocks that are known to be full without fetching them,
+ * which matters on nearly-full file systems where most blocks are full.
+ * The summaries are built on first use and describe a single device.
+ */
+static struct bmap_summary {
+  bit_t bs_free;		/* # free bits in this bitmap block */
+  unsigned bs_word;		/* no free bits before this word */
+} *bsum[2];			/* indexed by IMAP or ZMAP */
+static dev_t bsum_dev = NO_DEV;	/* device the summaries describe */
+
+/*===========================================================================*
+ *				get_bmap_summary			     *
+ *===========================================================================*/
+static struct bmap_summary *get_bmap_summary(sp, map)
+struct super_block *sp;		/* the filesystem to summarize */
+int map;			/* IMAP (inode map) or ZMAP (zone map) */
+{
+/* Return the bitmap summary for the given map, building it first if it is
+ * not there yet (or describes another device).
+ */
+
+  block_t start_block;
+  bit_t map_bits;
+  short bit_blocks;
+  block_t block;
+  unsigned word;
+  struct buf *bp;
+  bitchunk_t k;
+  struct bmap_summary *bs;
+  bit_t b, i;
+
+  if (bsum_dev != sp->s_dev) {
+	/* Summaries, if any, are for another device; throw them away. */
+	for (i = 0; i < 2; i++) {
+		free(bsum[i]);
+		bsum[i] = NULL;
+	}
+	bsum_dev = sp->s_dev;
+  }
+
+  if (bsum[map] != NULL)
+	return(bsum[map]);
+
+  if (map == IMAP) {
+	start_block = START_BLOCK;
+	map_bits = (bit_t) (sp->s_ninodes + 1);
+	bit_blocks = sp->s_imap_blocks;
+  } else {
+	start_block = START_BLOCK + sp->s_imap_blocks;
+	map_bits = (bit_t) (sp->s_zones - (sp->s_firstdatazone - 1));
+	bit_blocks = sp->s_zmap_blocks;
+  }
+
+  bs = malloc(bit_blocks * sizeof(bs[0]));
+  if (bs == NULL)
+	panic("cannot allocate bitmap summary of %d blocks", bit_blocks);
+
+  /* Sweep the entire bit map once, counting the free bits in each block. */
+  for (block = 0; block < (block_t) bit_blocks; block++) {
+	bs[block].bs_free = 0;
+	bs[block].bs_word = FS_BITMAP_CHUNKS(sp->s_block_size);
+
+	bp = get_block(sp->s_dev, start_block + block, NORMAL);
+
+	for (word = 0; word < FS_BITMAP_CHUNKS(sp->s_block_size); word++) {
+		if (b_bitmap(bp)[word] == (bitchunk_t) ~0) continue;
+
+		k = (bitchunk_t) conv4(sp->s_native,
+			(int) b_bitmap(bp)[word]);
+
+		for (i = 0; i < FS_BITCHUNK_BITS; i++) {
+			b = ((bit_t) block *
+				FS_BITS_PER_BLOCK(sp->s_block_size))
+			    + word * FS_BITCHUNK_BITS + i;
+
+			/* Don't count bits beyond the end of the map. */
+			if (b >= map_bits) break;
+
+			if ((k & (1 << i)) == 0) {
+				if (bs[block].bs_free == 0)
+					bs[block].bs_word = word;
+				bs[block].bs_free++;
+			}
+		}
+	}
+	put_block(bp);
+  }
+
+  bsum[map] = bs;
+  return(bs);
+}
+
 /*===========================================================================*
  *				alloc_bit				     *
  *===========================================================================*/
@@ -37,14 +133,17 @@ bit_t origin;			/* number of bit to start searching at */
   block_t block;
   bit_t map_bits;		/* how many bits are there in the bit map? */
   short bit_blocks;		/* how many blocks are there in the bit map? */
-  unsigned word, bcount;
+  unsigned word, scan_start, bcount;
   struct buf *bp;
   bitchunk_t *wptr, *wlim, k;
+  struct bmap_summary *bs;
   bit_t i, b;
 
   if (sp->s_rd_only)
 	panic("can't allocate bit on read-only filesys");
 
+  bs = get_bmap_summary(sp, map);
+
   if (map == IMAP) {
 	start_block = START_BLOCK;
 	map_bits = (bit_t) (sp->s_ninodes + 1);
@@ -65,6 +164,17 @@ bit_t origin;			/* number of bit to start searching at */
   /* Iterate over all blocks plus one, because we start in the middle. */
   bcount = bit_blocks + 1;
   do {
+	/* Skip blocks that are known not to contain any free bits. */
+	if (bs[block].bs_free == 0) {
+		if (++block >= (unsigned int) bit_blocks) block = 0;
+		word = 0;
+		continue;
+	}
+
+	/* No free bits exist before the block's first-free hint. */
+	if (word < bs[block].bs_word) word = bs[block].bs_word;
+	scan_start = word;
+
 	bp = get_block(sp->s_dev, start_block + block, NORMAL);
 	wlim = &b_bitmap(bp)[FS_BITMAP_CHUNKS(sp->s_block_size)];
 
@@ -90,6 +200,13 @@ bit_t origin;			/* number of bit to start searching at */
 		k |= 1 << i;
 		*wptr = (bitchunk_t) conv4(sp->s_native, (int) k);
 		MARKDIRTY(bp);
+		bs[block].bs_free--;
+		/* If we scanned from the hint onwards, all words before this
+		 * one are now known to be full, so move the hint up.
+		 */
+		if (scan_start == bs[block].bs_word)
+			bs[block].bs_word =
+				(unsigned) (wptr - &b_bitmap(bp)[0]);
 		put_block(bp);
 		if(map == ZMAP) {
 			used_zones++;
@@ -149,6 +266,13 @@ bit_t bit_returned;		/* number of bit to insert into the map */
 
   put_block(bp);
 
+  /* Keep the bitmap summary, if present, in sync. */
+  if (sp->s_dev == bsum_dev && bsum[map] != NULL) {
+	bsum[map][block].bs_free++;
+	if (word < bsum[map][block].bs_word)
+		bsum[map][block].bs_word = word;
+  }
+
   if(map == ZMAP) {
 	used_zones--;
 	lmfs_change_blockusage(-1);
@@ -21,6 +21,7 @@ struct fsdriver mfs_table = {
 	.fdr_getdents	= fs_getdents,
 	.fdr_trunc	= fs_trunc,
 	.fdr_seek	= fs_seek,
+	.fdr_fadvise	= fs_fadvise,
 	.fdr_create	= fs_create,
 	.fdr_mkdir	= fs_mkdir,
 	.fdr_mknod	= fs_mknod,
@@ -41,5 +42,6 @@ struct fsdriver mfs_table = {
 	.fdr_bread	= lmfs_bio,
 	.fdr_bwrite	= lmfs_bio,
 	.fdr_bpeek	= lmfs_bio,
-	.fdr_bflush	= lmfs_bflush
+	.fdr_bflush	= lmfs_bflush,
+	.fdr_other	= lmfs_other
 };
@@ -35,4 +35,14 @@
 /* Size of the I/O buffer. */
 #define BUF_SIZE	4097			/* 4KB+1 (see buf.c) */
 
+/*
+ * Regeneration throttling intervals, in clock ticks.  The process list and
+ * the tree of PID directories are refreshed at most once per UPDATE_TTL
+ * ticks, and the generated contents of any particular file are kept for
+ * DATA_TTL ticks.  Larger values make hammering ProcFS cheaper, at the cost
+ * of a longer window in which stale information may be returned.
+ */
+#define UPDATE_TTL	1
+#define DATA_TTL	1
+
 #endif /* _PROCFS_CONST_H */
@@ -67,6 +67,9 @@ init_hook(void)
 
 		service_init();
 
+		/* Keep generated file contents for a short while. */
+		vtreefs_set_data_ttl(DATA_TTL);
+
 		first_time = FALSE;
 	}
 }
@@ -18,6 +18,7 @@ static void root_pci(void);
 static void root_dmap(void);
 static void root_ipcvecs(void);
 static void root_mounts(void);
+static void root_pstab(void);
 
 struct file root_files[] = {
 	{ "hz",		REG_ALL_MODE,	(data_t) root_hz	},
@@ -34,6 +35,7 @@ struct file root_files[] = {
 #endif
 	{ "ipcvecs",	REG_ALL_MODE,	(data_t) root_ipcvecs	},
 	{ "mounts",	REG_ALL_MODE,	(data_t) root_mounts	},
+	{ "pstab",	REG_ALL_MODE,	(data_t) root_pstab	},
 	{ NULL,		0,		NULL			}
 };
 
@@ -207,6 +209,76 @@ root_ipcvecs(void)
 	PRINT_ENTRYPOINT(do_kernel_call);
 }
 
+/*
+ * Print a one-line summary for every process in the system.  The first line
+ * contains just the PSINFO_VERSION number; each subsequent line contains the
+ * same fields as the per-PID psinfo files, prefixed with the process PID, so
+ * that the entire process table can be enumerated without opening one file
+ * per process.  Unlike psinfo, no memory usage is included: that information
+ * is owned by VM, and obtaining it would cost one extra call per process.
+ */
+static void
+root_pstab(void)
+{
+	/* The full table is too large to allocate on the stack. */
+	static struct minix_proc_data ptab[NR_TASKS + NR_PROCS];
+	struct minix_proc_data *mpd;
+	int slot, type, state;
+	char *p;
+
+	if (minix_getproctab(ptab, sizeof(ptab)) != 0)
+		return;
+
+	buf_printf("%d\n", PSINFO_VERSION);
+
+	for (slot = 0; slot < NR_TASKS + NR_PROCS; slot++) {
+		mpd = &ptab[slot];
+
+		if (slot >= NR_TASKS && mpd->mpd_endpoint == NONE)
+			continue;
+
+		/* Get the type of the process. */
+		if (slot < NR_TASKS)
+			type = TYPE_TASK;
+		else if (mpd->mpd_flags & MPDF_SYSTEM)
+			type = TYPE_SYSTEM;
+		else
+			type = TYPE_USER;
+
+		/* Get the (rudimentary) state of the process. */
+		if (mpd->mpd_flags & MPDF_ZOMBIE)
+			state = STATE_ZOMBIE;
+		else if (mpd->mpd_flags & MPDF_RUNNABLE)
+			state = STATE_RUN;
+		else if (mpd->mpd_flags & MPDF_STOPPED)
+			state = STATE_STOP;
+		else
+			state = STATE_SLEEP;
+
+		/* Spaces in the process name would mess up the format. */
+		if ((p = strchr(mpd->mpd_name, ' ')) != NULL)
+			*p = '\0';
+
+		buf_printf("%d %c %d %s %c %d %d %u %u "
+		    "%"PRIu64" %"PRIu64" %"PRIu64" %d %u\n",
+		    mpd->mpd_pid,			/* process PID */
+		    type,				/* process type */
+		    mpd->mpd_endpoint,			/* process endpoint */
+		    mpd->mpd_name,			/* process name */
+		    state,				/* process state letter */
+		    mpd->mpd_blocked_on,		/* endpt blocked on */
+		    mpd->mpd_priority,			/* process priority */
+		    mpd->mpd_user_time,			/* user time */
+		    mpd->mpd_sys_time,			/* system time */
+		    mpd->mpd_cycles,			/* execution cycles */
+		    mpd->mpd_kipc_cycles,		/* kernel IPC cycles */
+		    mpd->mpd_kcall_cycles,		/* kernel call cycles */
+		    mpd->mpd_nice,			/* nice value */
+		    mpd->mpd_uid			/* effective user ID */
+		);
+	}
+}
+
 /*
  * Print the list of mounted file systems.
  */
@@ -347,6 +347,32 @@ pid_link(struct inode * __unused node, char * ptr, int max)
 	return OK;
 }
 
+/*
+ * Refresh the process list and regenerate the set of PID directories in the
+ * root directory, at most once per UPDATE_TTL clock ticks.  If the process
+ * list is not refreshed, our view of the system has not changed either, and
+ * reconstructing the PID directories would add and delete the exact same
+ * entries.  The tree must always be updated all at once; if we update
+ * individual entries, we risk name collisions.
+ */
+static void
+update_tree(void)
+{
+	static clock_t last_update = 0;
+	clock_t now;
+
+	now = getticks();
+
+	if ((clock_t)(now - last_update) < UPDATE_TTL && last_update != 0)
+		return;
+
+	last_update = now;
+
+	update_list();
+
+	construct_pid_dirs();
+}
+
 /*
  * Path name resolution hook, for a specific parent and name pair.  If needed,
  * update our own view of the system first; after that, determine whether we
@@ -355,41 +381,27 @@ pid_link(struct inode * __unused node, char * ptr, int max)
 int
 lookup_hook(struct inode * parent, char * name, cbdata_t __unused cbdata)
 {
-	static clock_t last_update = 0;
-	clock_t now;
 
 	/*
 	 * Update lazily for lookups, as this gets too expensive otherwise.
 	 * Alternative: pull in only PM's table?
 	 */
-	now = getticks();
-
-	if (last_update != now) {
-		update_list();
-
-		last_update = now;
-	}
+	update_tree();
 
 	/*
-	 * If the parent is the root directory, we must now reconstruct all
-	 * entries, because some of them might have been garbage collected.
-	 * We must update the entire tree at once; if we update individual
-	 * entries, we risk name collisions.
-	 *
 	 * If the parent is a process directory, we may need to (re)construct
-	 * the entry being looked up.
+	 * the entry being looked up.  The set of PID directories in the root
+	 * directory has already been brought up to date above, as needed.
 	 */
-	if (parent == get_root_inode())
-		construct_pid_dirs();
-	else if (dir_is_pid(parent))
+	if (dir_is_pid(parent))
 		/*
 		 * We might now have deleted our current containing directory;
 		 * construct_pid_entries() will take care of this case.
 		 */
 		construct_pid_entries(parent, name);
-	else
+	else if (parent != get_root_inode())
 		/* TODO: skip updating the main tables in this case. */
-		service_lookup(parent, now);
+		service_lookup(parent, getticks());
 
 	return OK;
 }
@@ -404,9 +416,7 @@ getdents_hook(struct inode * node, cbdata_t __unused cbdata)
 {
 
 	if (node == get_root_inode()) {
-		update_list();
-
-		construct_pid_dirs();
+		update_tree();
 	} else if (dir_is_pid(node))
 		construct_pid_entries(node, NULL /*name*/);
 	else
@@ -0,0 +1,538 @@
+/* TMPFS - directory entries and path operations */
+
+#include "tmpfs.h"
+
+#define GETDENTS_BUF	1024	/* size of the temporary buffer for getdents */
+
+/*
+ * Find the directory entry with the given name in the given directory.
+ * Return the entry, or NULL if no entry with that name exists.
+ */
+struct dentry *
+find_dentry(struct inode * dir, const char * name)
+{
+	struct dentry *dep;
+
+	TAILQ_FOREACH(dep, &dir->i_children, d_next)
+		if (!strcmp(dep->d_name, name))
+			return dep;
+
+	return NULL;
+}
+
+/*
+ * Add an entry with the given name, pointing to the given inode, to a
+ * directory.  The caller must have verified that no entry with this name
+ * exists yet.  The entry accounts for one link to the inode.  Return OK or
+ * an error code.
+ */
+int
+add_dentry(struct inode * dir, const char * name, struct inode * rip)
+{
+	struct dentry *dep;
+
+	if ((dep = malloc(sizeof(*dep))) == NULL)
+		return ENOSPC;
+
+	if ((dep->d_name = strdup(name)) == NULL) {
+		free(dep);
+		return ENOSPC;
+	}
+
+	dep->d_ino = rip;
+	TAILQ_INSERT_TAIL(&dir->i_children, dep, d_next);
+
+	rip->i_nlink++;
+
+	dir->i_update |= MTIME | CTIME;
+
+	return OK;
+}
+
+/*
+ * Remove an entry from a directory, dropping the link it accounts for.  The
+ * caller is responsible for freeing the inode if it is no longer in use.
+ */
+void
+del_dentry(struct inode * dir, struct dentry * dep)
+{
+
+	TAILQ_REMOVE(&dir->i_children, dep, d_next);
+
+	assert(dep->d_ino->i_nlink > 0);
+	dep->d_ino->i_nlink--;
+	dep->d_ino->i_update |= CTIME;
+
+	dir->i_update |= MTIME | CTIME;
+
+	free(dep->d_name);
+	free(dep);
+}
+
+/*
+ * Resolve one path component in a directory, yielding a referenced node.
+ */
+int
+fs_lookup(ino_t dir_nr, char * name, struct fsdriver_node * node,
+	int * is_mountpt)
+{
+	struct inode *dir, *rip;
+	struct dentry *dep;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if (name[0] == '.' && name[1] == '\0')
+		rip = dir;
+	else if (name[0] == '.' && name[1] == '.' && name[2] == '\0') {
+		if (!S_ISDIR(dir->i_mode))
+			return ENOTDIR;
+		rip = dir->i_parent;
+		assert(rip != NULL);
+	} else {
+		if ((dep = find_dentry(dir, name)) == NULL)
+			return ENOENT;
+		rip = dep->d_ino;
+	}
+
+	ref_inode(rip);
+
+	node->fn_ino_nr = rip->i_num;
+	node->fn_mode = rip->i_mode;
+	node->fn_size = rip->i_size;
+	node->fn_uid = rip->i_uid;
+	node->fn_gid = rip->i_gid;
+	node->fn_dev = rip->i_rdev;
+
+	*is_mountpt = rip->i_mountpoint;
+
+	return OK;
+}
+
+/*
+ * Enumerate directory contents.
+ */
+ssize_t
+fs_getdents(ino_t ino_nr, struct fsdriver_data * data, size_t bytes,
+	off_t * posp)
+{
+	struct fsdriver_dentry fsdentry;
+	static char buf[GETDENTS_BUF];
+	struct inode *dir;
+	struct dentry *dep;
+	const char *name;
+	ino_t child_nr;
+	unsigned int type;
+	off_t pos;
+	ssize_t r;
+
+	if ((dir = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (!S_ISDIR(dir->i_mode))
+		return ENOTDIR;
+
+	fsdriver_dentry_init(&fsdentry, data, bytes, buf, sizeof(buf));
+
+	/*
+	 * The directory position is an index into the directory: zero and one
+	 * are the "." and ".." entries, and each subsequent position is the
+	 * corresponding entry in the children list.  Concurrent removal of
+	 * entries may cause entries to be skipped or repeated across calls;
+	 * this is a known limitation of the indexing approach.
+	 */
+	dep = TAILQ_FIRST(&dir->i_children);
+
+	for (pos = 2; pos < *posp && dep != NULL; pos++)
+		dep = TAILQ_NEXT(dep, d_next);
+
+	for (;;) {
+		pos = (*posp)++;
+
+		if (pos == 0 || pos == 1) {
+			name = (pos == 0) ? "." : "..";
+			child_nr = (pos == 0) ? dir->i_num :
+			    dir->i_parent->i_num;
+			type = DT_DIR;
+		} else {
+			if (dep == NULL)
+				break;	/* EOF */
+
+			name = dep->d_name;
+			child_nr = dep->d_ino->i_num;
+			type = IFTODT(dep->d_ino->i_mode);
+
+			dep = TAILQ_NEXT(dep, d_next);
+		}
+
+		if ((r = fsdriver_dentry_add(&fsdentry, child_nr, name,
+		    strlen(name), type)) < 0)
+			return r;
+		if (r == 0) {
+			(*posp)--;	/* not transferred after all */
+			break;		/* result buffer full */
+		}
+	}
+
+	dir->i_update |= ATIME;
+
+	return fsdriver_dentry_finish(&fsdentry);
+}
+
+/*
+ * Create a regular file, and return a referenced node for it.
+ */
+int
+fs_create(ino_t dir_nr, char * name, mode_t mode, uid_t uid, gid_t gid,
+	struct fsdriver_node * node)
+{
+	struct inode *dir, *rip;
+	int r;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if (find_dentry(dir, name) != NULL)
+		return EEXIST;
+
+	if ((rip = alloc_inode(mode, uid, gid)) == NULL)
+		return ENFILE;
+
+	if ((r = add_dentry(dir, name, rip)) != OK) {
+		free_inode(rip);
+		return r;
+	}
+
+	ref_inode(rip);
+
+	node->fn_ino_nr = rip->i_num;
+	node->fn_mode = rip->i_mode;
+	node->fn_size = rip->i_size;
+	node->fn_uid = rip->i_uid;
+	node->fn_gid = rip->i_gid;
+	node->fn_dev = NO_DEV;
+
+	return OK;
+}
+
+/*
+ * Create a directory.
+ */
+int
+fs_mkdir(ino_t dir_nr, char * name, mode_t mode, uid_t uid, gid_t gid)
+{
+	struct inode *dir, *rip;
+	int r;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if (find_dentry(dir, name) != NULL)
+		return EEXIST;
+
+	if ((rip = alloc_inode(mode, uid, gid)) == NULL)
+		return ENFILE;
+
+	if ((r = add_dentry(dir, name, rip)) != OK) {
+		free_inode(rip);
+		return r;
+	}
+
+	/* Account for the links through "." and "..". */
+	rip->i_nlink++;
+	rip->i_parent = dir;
+	dir->i_nlink++;
+
+	return OK;
+}
+
+/*
+ * Create a device or other special file.
+ */
+int
+fs_mknod(ino_t dir_nr, char * name, mode_t mode, uid_t uid, gid_t gid,
+	dev_t rdev)
+{
+	struct inode *dir, *rip;
+	int r;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if (find_dentry(dir, name) != NULL)
+		return EEXIST;
+
+	if ((rip = alloc_inode(mode, uid, gid)) == NULL)
+		return ENFILE;
+
+	if ((r = add_dentry(dir, name, rip)) != OK) {
+		free_inode(rip);
+		return r;
+	}
+
+	rip->i_rdev = rdev;
+
+	return OK;
+}
+
+/*
+ * Create a symbolic link.
+ */
+int
+fs_slink(ino_t dir_nr, char * name, uid_t uid, gid_t gid,
+	struct fsdriver_data * data, size_t bytes)
+{
+	struct inode *dir, *rip;
+	char *target;
+	int r;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if (bytes == 0 || bytes >= PATH_MAX)
+		return ENAMETOOLONG;
+
+	if (find_dentry(dir, name) != NULL)
+		return EEXIST;
+
+	if ((target = malloc(bytes + 1)) == NULL)
+		return ENOSPC;
+
+	if ((r = fsdriver_copyin(data, 0, target, bytes)) != OK) {
+		free(target);
+		return r;
+	}
+	target[bytes] = '\0';
+
+	if ((rip = alloc_inode(S_IFLNK | 0777, uid, gid)) == NULL) {
+		free(target);
+		return ENFILE;
+	}
+
+	if ((r = add_dentry(dir, name, rip)) != OK) {
+		free(target);
+		free_inode(rip);
+		return r;
+	}
+
+	rip->i_link = target;
+	rip->i_size = strlen(target);
+
+	return OK;
+}
+
+/*
+ * Retrieve symbolic link target.
+ */
+ssize_t
+fs_rdlink(ino_t ino_nr, struct fsdriver_data * data, size_t bytes)
+{
+	struct inode *rip;
+	int r;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (!S_ISLNK(rip->i_mode))
+		return EINVAL;
+
+	if (bytes > (size_t)rip->i_size)
+		bytes = (size_t)rip->i_size;
+
+	if ((r = fsdriver_copyout(data, 0, rip->i_link, bytes)) != OK)
+		return r;
+
+	return bytes;
+}
+
+/*
+ * Create a hard link to an existing inode.
+ */
+int
+fs_link(ino_t dir_nr, char * name, ino_t ino_nr)
+{
+	struct inode *dir, *rip;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	/* Directories may not be hard-linked. */
+	if (S_ISDIR(rip->i_mode))
+		return EPERM;
+
+	if (rip->i_nlink >= LINK_MAX)
+		return EMLINK;
+
+	if (find_dentry(dir, name) != NULL)
+		return EEXIST;
+
+	return add_dentry(dir, name, rip);
+}
+
+/*
+ * Unlink a file.
+ */
+int
+fs_unlink(ino_t dir_nr, char * name, int __unused call)
+{
+	struct inode *dir, *rip;
+	struct dentry *dep;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if ((dep = find_dentry(dir, name)) == NULL)
+		return ENOENT;
+
+	rip = dep->d_ino;
+
+	if (S_ISDIR(rip->i_mode))
+		return EPERM;
+
+	del_dentry(dir, dep);
+
+	/* If the file is still open, its data are freed at the last close. */
+	if (rip->i_nlink == 0 && rip->i_count == 0)
+		free_inode(rip);
+
+	return OK;
+}
+
+/*
+ * Remove an empty directory.
+ */
+int
+fs_rmdir(ino_t dir_nr, char * name, int __unused call)
+{
+	struct inode *dir, *rip;
+	struct dentry *dep;
+
+	if ((dir = find_inode(dir_nr)) == NULL)
+		return EINVAL;
+
+	if ((dep = find_dentry(dir, name)) == NULL)
+		return ENOENT;
+
+	rip = dep->d_ino;
+
+	if (!S_ISDIR(rip->i_mode))
+		return ENOTDIR;
+
+	if (!TAILQ_EMPTY(&rip->i_children))
+		return ENOTEMPTY;
+
+	if (rip->i_num == ROOT_INO_NR)
+		return EBUSY;
+
+	/* Undo the links through "." and the parent's entry. */
+	del_dentry(dir, dep);
+	assert(rip->i_nlink > 0);
+	rip->i_nlink--;
+	assert(dir->i_nlink > 0);
+	dir->i_nlink--;
+
+	if (rip->i_nlink == 0 && rip->i_count == 0)
+		free_inode(rip);
+
+	return OK;
+}
+
+/*
+ * Check whether the inode 'rip' is an ancestor of, or equal to, the directory
+ * 'dir'.  Used to refuse moving a directory into its own subtree.
+ */
+static int
+is_ancestor(struct inode * rip, struct inode * dir)
+{
+
+	for (;; dir = dir->i_parent) {
+		if (dir == rip)
+			return TRUE;
+		if (dir->i_num == ROOT_INO_NR)
+			return FALSE;
+	}
+}
+
+/*
+ * Rename a file or directory.
+ */
+int
+fs_rename(ino_t old_dir_nr, char * old_name, ino_t new_dir_nr,
+	char * new_name)
+{
+	struct inode *old_dir, *new_dir, *rip, *target;
+	struct dentry *dep, *new_dep;
+	char *newp;
+
+	if ((old_dir = find_inode(old_dir_nr)) == NULL)
+		return EINVAL;
+	if ((new_dir = find_inode(new_dir_nr)) == NULL)
+		return EINVAL;
+
+	if ((dep = find_dentry(old_dir, old_name)) == NULL)
+		return ENOENT;
+
+	rip = dep->d_ino;
+
+	/* A directory may not be moved into its own subtree. */
+	if (S_ISDIR(rip->i_mode) && is_ancestor(rip, new_dir))
+		return EINVAL;
+
+	if ((new_dep = find_dentry(new_dir, new_name)) != NULL) {
+		target = new_dep->d_ino;
+
+		/* Renaming a file or directory to itself is a no-op. */
+		if (target == rip)
+			return OK;
+
+		/* The target, if it exists, must be replaceable. */
+		if (S_ISDIR(target->i_mode)) {
+			if (!S_ISDIR(rip->i_mode))
+				return EISDIR;
+			if (!TAILQ_EMPTY(&target->i_children))
+				return ENOTEMPTY;
+			if (target->i_num == ROOT_INO_NR)
+				return EBUSY;
+
+			del_dentry(new_dir, new_dep);
+			assert(target->i_nlink > 0);
+			target->i_nlink--;
+			assert(new_dir->i_nlink > 0);
+			new_dir->i_nlink--;
+		} else {
+			if (S_ISDIR(rip->i_mode))
+				return ENOTDIR;
+
+			del_dentry(new_dir, new_dep);
+		}
+
+		if (target->i_nlink == 0 && target->i_count == 0)
+			free_inode(target);
+	}
+
+	/* Rename the entry, allocating the new name first so we can fail. */
+	if ((newp = strdup(new_name)) == NULL)
+		return ENOSPC;
+
+	TAILQ_REMOVE(&old_dir->i_children, dep, d_next);
+	free(dep->d_name);
+	dep->d_name = newp;
+	TAILQ_INSERT_TAIL(&new_dir->i_children, dep, d_next);
+
+	/* For directories moving between parents, update ".." accounting. */
+	if (S_ISDIR(rip->i_mode) && old_dir != new_dir) {
+		rip->i_parent = new_dir;
+		assert(old_dir->i_nlink > 0);
+		old_dir->i_nlink--;
+		new_dir->i_nlink++;
+	}
+
+	rip->i_update |= CTIME;
+	old_dir->i_update |= MTIME | CTIME;
+	new_dir->i_update |= MTIME | CTIME;
+
+	return OK;
+}
@@ -0,0 +1,549 @@
+/* TMPFS - inode management and file data */
+
+#include "tmpfs.h"
+
+static struct inode *inode;		/* inode table, allocated at startup */
+
+static LIST_HEAD(, inode) free_inodes;	/* list of free inodes */
+
+/*
+ * Initialize the inode table.  The table size is determined by the inode
+ * limit, which has been set by the time we get here.
+ */
+int
+init_inodes(void)
+{
+	struct inode *rip;
+	unsigned int i;
+
+	if ((inode = calloc(tmpfs_max_inodes, sizeof(inode[0]))) == NULL)
+		return ENOMEM;
+
+	LIST_INIT(&free_inodes);
+
+	/*
+	 * Walk backwards so that the lowest inode numbers end up being used
+	 * first.  The root directory thus gets inode number one.
+	 */
+	for (i = tmpfs_max_inodes; i > 0; i--) {
+		rip = &inode[i - 1];
+
+		/* Inode number 0 is reserved.  See also find_inode. */
+		rip->i_num = i;
+		rip->i_free = TRUE;
+
+		LIST_INSERT_HEAD(&free_inodes, rip, i_next);
+	}
+
+	return OK;
+}
+
+/*
+ * Find the inode with the corresponding inode number.  It must be in use.
+ */
+struct inode *
+find_inode(ino_t ino_nr)
+{
+	struct inode *rip;
+
+	/* Inode numbers are 1-based, because inode number 0 is reserved. */
+	if (ino_nr < 1 || ino_nr > tmpfs_max_inodes)
+		return NULL;
+
+	rip = &inode[ino_nr - 1];
+	assert(rip->i_num == ino_nr);
+
+	if (rip->i_free == TRUE)
+		return NULL;
+
+	return rip;
+}
+
+/*
+ * Allocate an inode, and initialize its fields for a new, empty file of the
+ * given type.  Return the inode on success, or NULL if the inode limit has
+ * been reached.  The caller is responsible for link and reference counting.
+ */
+struct inode *
+alloc_inode(mode_t mode, uid_t uid, gid_t gid)
+{
+	struct inode *rip;
+
+	if (LIST_EMPTY(&free_inodes))
+		return NULL;
+
+	rip = LIST_FIRST(&free_inodes);
+	LIST_REMOVE(rip, i_next);
+
+	assert(rip->i_free == TRUE);
+	rip->i_free = FALSE;	/* this is for sanity checks only */
+	tmpfs_used_inodes++;
+
+	rip->i_mode = mode;
+	rip->i_uid = uid;
+	rip->i_gid = gid;
+	rip->i_nlink = 0;
+	rip->i_size = 0;
+	rip->i_rdev = NO_DEV;
+	rip->i_update = ATIME | MTIME | CTIME;
+	rip->i_count = 0;
+	rip->i_mountpoint = FALSE;
+	rip->i_parent = NULL;
+	TAILQ_INIT(&rip->i_children);
+	rip->i_blocks = NULL;
+	rip->i_nblocks = 0;
+	rip->i_link = NULL;
+
+	return rip;
+}
+
+/*
+ * Increase the VFS reference count of an inode.
+ */
+void
+ref_inode(struct inode *rip)
+{
+
+	rip->i_count++;
+}
+
+/*
+ * Free all data blocks from the given block index up to, but not including,
+ * the current end of the block pointer array.
+ */
+static void
+free_blocks(struct inode *rip, size_t index)
+{
+	size_t i;
+
+	for (i = index; i < rip->i_nblocks; i++) {
+		if (rip->i_blocks[i] == NULL)
+			continue;
+
+		free(rip->i_blocks[i]);
+		rip->i_blocks[i] = NULL;
+
+		assert(tmpfs_used_bytes >= TMPFS_BLOCK_SIZE);
+		tmpfs_used_bytes -= TMPFS_BLOCK_SIZE;
+	}
+}
+
+/*
+ * Free an inode, releasing all memory associated with it.  The inode must no
+ * longer be linked or referenced.  This is the fast-unlink path: since all
+ * data live in memory, releasing a file of any size is a matter of freeing
+ * its blocks, with no device I/O involved at any point.
+ */
+void
+free_inode(struct inode *rip)
+{
+
+	assert(rip->i_free == FALSE);
+	assert(rip->i_nlink == 0);
+	assert(rip->i_count == 0);
+	assert(TAILQ_EMPTY(&rip->i_children));
+
+	free_blocks(rip, 0);
+	if (rip->i_blocks != NULL) {
+		free(rip->i_blocks);
+		rip->i_blocks = NULL;
+		rip->i_nblocks = 0;
+	}
+	if (rip->i_link != NULL) {
+		free(rip->i_link);
+		rip->i_link = NULL;
+	}
+
+	rip->i_free = TRUE;
+	assert(tmpfs_used_inodes > 0);
+	tmpfs_used_inodes--;
+
+	LIST_INSERT_HEAD(&free_inodes, rip, i_next);
+}
+
+/*
+ * Resolve any pending file time updates on the inode.
+ */
+void
+get_times(struct inode *rip)
+{
+	time_t now;
+
+	if (rip->i_update != 0) {
+		now = clock_time(NULL);
+
+		if (rip->i_update & ATIME) rip->i_atime = now;
+		if (rip->i_update & MTIME) rip->i_mtime = now;
+		if (rip->i_update & CTIME) rip->i_ctime = now;
+
+		rip->i_update = 0;
+	}
+}
+
+/*
+ * Drop references to a node.  If the node is no longer referenced and no
+ * longer linked from any directory, free it.
+ */
+int
+fs_putnode(ino_t ino_nr, unsigned int count)
+{
+	struct inode *rip;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (count > rip->i_count) {
+		printf("TMPFS: dropping too many references\n");
+		return EINVAL;
+	}
+
+	rip->i_count -= count;
+
+	if (rip->i_count == 0) {
+		rip->i_mountpoint = FALSE;
+
+		if (rip->i_nlink == 0)
+			free_inode(rip);
+	}
+
+	return OK;
+}
+
+/*
+ * Make sure that the block pointer array of the given inode covers at least
+ * the given number of blocks, and that all blocks up to that number are
+ * present.  New blocks are zeroed only if 'zero' is set; callers that are
+ * about to overwrite the entire block may skip that.  Return OK or an error.
+ */
+static int
+get_block(struct inode *rip, size_t index, int zero, char **blkp)
+{
+	char **blocks, *blk;
+	size_t nblocks;
+
+	if (index >= rip->i_nblocks) {
+		/* Grow the block pointer array by at least doubling it. */
+		nblocks = MAX(rip->i_nblocks * 2, 8);
+		while (nblocks <= index)
+			nblocks *= 2;
+
+		blocks = realloc(rip->i_blocks, nblocks * sizeof(blocks[0]));
+		if (blocks == NULL)
+			return ENOSPC;
+
+		memset(&blocks[rip->i_nblocks], 0,
+		    (nblocks - rip->i_nblocks) * sizeof(blocks[0]));
+
+		rip->i_blocks = blocks;
+		rip->i_nblocks = nblocks;
+	}
+
+	if ((blk = rip->i_blocks[index]) == NULL) {
+		/* Enforce the mount-time limit on the total data size. */
+		if (tmpfs_used_bytes + TMPFS_BLOCK_SIZE > tmpfs_max_bytes)
+			return ENOSPC;
+
+		if ((blk = malloc(TMPFS_BLOCK_SIZE)) == NULL)
+			return ENOSPC;
+
+		if (zero)
+			memset(blk, 0, TMPFS_BLOCK_SIZE);
+
+		rip->i_blocks[index] = blk;
+		tmpfs_used_bytes += TMPFS_BLOCK_SIZE;
+	}
+
+	*blkp = blk;
+	return OK;
+}
+
+/*
+ * Read from a file.
+ */
+ssize_t
+fs_read(ino_t ino_nr, struct fsdriver_data * data, size_t bytes, off_t pos,
+	int __unused call)
+{
+	struct inode *rip;
+	size_t off, chunk, done;
+	char *blk;
+	int r;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (S_ISDIR(rip->i_mode))
+		return EISDIR;
+
+	/* We cannot read beyond the end of the file. */
+	if (pos >= rip->i_size)
+		return 0;
+	if ((off_t)bytes > rip->i_size - pos)
+		bytes = (size_t)(rip->i_size - pos);
+
+	for (done = 0; done < bytes; done += chunk) {
+		off = (size_t)(pos % TMPFS_BLOCK_SIZE);
+		chunk = MIN(bytes - done, TMPFS_BLOCK_SIZE - off);
+
+		blk = NULL;
+		if ((size_t)(pos / TMPFS_BLOCK_SIZE) < rip->i_nblocks)
+			blk = rip->i_blocks[pos / TMPFS_BLOCK_SIZE];
+
+		/* A hole reads as zeroes. */
+		if (blk != NULL)
+			r = fsdriver_copyout(data, done, blk + off, chunk);
+		else
+			r = fsdriver_zero(data, done, chunk);
+		if (r != OK)
+			return r;
+
+		pos += chunk;
+	}
+
+	rip->i_update |= ATIME;
+
+	return done;
+}
+
+/*
+ * Write to a file.
+ */
+ssize_t
+fs_write(ino_t ino_nr, struct fsdriver_data * data, size_t bytes, off_t pos,
+	int __unused call)
+{
+	struct inode *rip;
+	size_t off, chunk, done;
+	char *blk;
+	int r, zero;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (S_ISDIR(rip->i_mode))
+		return EISDIR;
+
+	if (pos > INT64_MAX - (off_t)bytes)
+		return EFBIG;
+
+	r = OK;
+	for (done = 0; done < bytes; done += chunk) {
+		off = (size_t)(pos % TMPFS_BLOCK_SIZE);
+		chunk = MIN(bytes - done, TMPFS_BLOCK_SIZE - off);
+
+		/* Newly allocated blocks need zeroing only if partial. */
+		zero = (chunk < TMPFS_BLOCK_SIZE);
+
+		if ((r = get_block(rip, (size_t)(pos / TMPFS_BLOCK_SIZE),
+		    zero, &blk)) != OK)
+			break;
+
+		if ((r = fsdriver_copyin(data, done, blk + off, chunk)) != OK)
+			break;
+
+		pos += chunk;
+	}
+
+	/* If anything was written at all, the file size and times change. */
+	if (done > 0) {
+		if (pos > rip->i_size)
+			rip->i_size = pos;
+
+		rip->i_update |= MTIME | CTIME;
+	}
+
+	if (done == 0 && r != OK)
+		return r;
+	return done;
+}
+
+/*
+ * Zero a byte range in a file, for truncation purposes.  Blocks covered
+ * entirely by the range are freed; partially covered blocks are zeroed in
+ * place.  Holes are skipped.
+ */
+static void
+zero_range(struct inode *rip, off_t start, off_t end)
+{
+	size_t index, off, chunk;
+	char *blk;
+
+	while (start < end) {
+		index = (size_t)(start / TMPFS_BLOCK_SIZE);
+		off = (size_t)(start % TMPFS_BLOCK_SIZE);
+		chunk = TMPFS_BLOCK_SIZE - off;
+		if ((off_t)chunk > end - start)
+			chunk = (size_t)(end - start);
+
+		if (index >= rip->i_nblocks)
+			break;	/* anything beyond this is a hole already */
+
+		if ((blk = rip->i_blocks[index]) != NULL) {
+			if (chunk == TMPFS_BLOCK_SIZE) {
+				/* The whole block is zeroed; free it. */
+				free(blk);
+				rip->i_blocks[index] = NULL;
+
+				assert(tmpfs_used_bytes >= TMPFS_BLOCK_SIZE);
+				tmpfs_used_bytes -= TMPFS_BLOCK_SIZE;
+			} else
+				memset(blk + off, 0, chunk);
+		}
+
+		start += chunk;
+	}
+}
+
+/*
+ * Resize a file, or zero a part of it.  If 'end_pos' is zero, the file size
+ * is to be changed to 'start_pos'; otherwise, the byte range from 'start_pos'
+ * to 'end_pos' is to be zeroed.  We maintain the invariant that all bytes
+ * beyond the end of the file, in blocks that are allocated, are zero; that
+ * way, neither extending the file nor writing beyond its end can ever expose
+ * stale data.
+ */
+int
+fs_trunc(ino_t ino_nr, off_t start_pos, off_t end_pos)
+{
+	struct inode *rip;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (end_pos != 0) {
+		/* Zero a range within the file. */
+		zero_range(rip, start_pos, end_pos);
+	} else if (start_pos < rip->i_size) {
+		/* Shrink the file.  Free blocks beyond the new end. */
+		zero_range(rip, start_pos,
+		    (off_t)roundup(start_pos, TMPFS_BLOCK_SIZE));
+		free_blocks(rip, (size_t)howmany(start_pos,
+		    TMPFS_BLOCK_SIZE));
+
+		rip->i_size = start_pos;
+	} else {
+		/* Grow the file.  The new area is a hole; nothing to do. */
+		rip->i_size = start_pos;
+	}
+
+	rip->i_update |= MTIME | CTIME;
+
+	return OK;
+}
+
+/*
+ * Return node status.
+ */
+int
+fs_stat(ino_t ino_nr, struct stat * statbuf)
+{
+	struct inode *rip;
+	size_t i, blocks;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	get_times(rip);
+
+	/* Count the actually allocated blocks, skipping any holes. */
+	blocks = 0;
+	for (i = 0; i < rip->i_nblocks; i++)
+		if (rip->i_blocks[i] != NULL)
+			blocks++;
+
+	statbuf->st_mode = rip->i_mode;
+	statbuf->st_nlink = rip->i_nlink;
+	statbuf->st_uid = rip->i_uid;
+	statbuf->st_gid = rip->i_gid;
+	statbuf->st_rdev = rip->i_rdev;
+	statbuf->st_size = rip->i_size;
+	statbuf->st_atime = rip->i_atime;
+	statbuf->st_mtime = rip->i_mtime;
+	statbuf->st_ctime = rip->i_ctime;
+	statbuf->st_blksize = TMPFS_BLOCK_SIZE;
+	statbuf->st_blocks = blocks * (TMPFS_BLOCK_SIZE / S_BLKSIZE);
+
+	return OK;
+}
+
+/*
+ * Change file ownership.
+ */
+int
+fs_chown(ino_t ino_nr, uid_t uid, gid_t gid, mode_t * mode)
+{
+	struct inode *rip;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	rip->i_uid = uid;
+	rip->i_gid = gid;
+	rip->i_mode &= ~(S_ISUID | S_ISGID);
+	rip->i_update |= CTIME;
+
+	*mode = rip->i_mode;
+
+	return OK;
+}
+
+/*
+ * Change file permissions.
+ */
+int
+fs_chmod(ino_t ino_nr, mode_t * mode)
+{
+	struct inode *rip;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	rip->i_mode = (rip->i_mode & ~ALLPERMS) | (*mode & ALLPERMS);
+	rip->i_update |= CTIME;
+
+	*mode = rip->i_mode;
+
+	return OK;
+}
+
+/*
+ * Change file times.
+ */
+int
+fs_utime(ino_t ino_nr, struct timespec * atime, struct timespec * mtime)
+{
+	struct inode *rip;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	/* Resolve any pending updates first, then apply the new times. */
+	get_times(rip);
+
+	switch (atime->tv_nsec) {
+	case UTIME_NOW:
+		rip->i_update |= ATIME;
+		break;
+	case UTIME_OMIT:	/* do not touch */
+		break;
+	default:
+		/* TMPFS does not support subsecond resolution. */
+		rip->i_atime = atime->tv_sec;
+		break;
+	}
+
+	switch (mtime->tv_nsec) {
+	case UTIME_NOW:
+		rip->i_update |= MTIME;
+		break;
+	case UTIME_OMIT:	/* do not touch */
+		break;
+	default:
+		rip->i_mtime = mtime->tv_sec;
+		break;
+	}
+
+	rip->i_update |= CTIME;
+
+	return OK;
+}
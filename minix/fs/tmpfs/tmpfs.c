@@ -0,0 +1,238 @@
+/*
+ * TMPFS - a memory-backed file system server.
+ *
+ * All file system contents are stored in anonymous memory obtained from VM,
+ * and are lost when the file system is unmounted or the system shuts down.
+ * The intended use is for /tmp and other scratch space for short-lived files,
+ * which with this file system never involve a block device, a buffer cache,
+ * or any other part of the disk I/O path.
+ *
+ * The total amount of file data and the number of files are both limited, so
+ * that a runaway application cannot eat all system memory.  The limits can be
+ * set with the following service options ("-o option[,option]"):
+ *
+ *   size=N     maximum total file data size, in bytes (default 64 MB)
+ *   inodes=N   maximum number of files (default 1024)
+ *   mode=M     permissions of the root directory, in octal (default 1777)
+ */
+
+#include "tmpfs.h"
+
+size_t tmpfs_max_bytes;			/* data limit, in bytes */
+size_t tmpfs_used_bytes;		/* data blocks in use, in bytes */
+unsigned int tmpfs_max_inodes;		/* inode limit */
+unsigned int tmpfs_used_inodes;		/* inodes in use */
+
+static int opt_size = TMPFS_DEFAULT_SIZE;	/* "size" option value */
+static int opt_inodes = TMPFS_DEFAULT_INODES;	/* "inodes" option value */
+static int opt_mode = TMPFS_DEFAULT_MODE & ALLPERMS; /* "mode" option value */
+
+static struct optset optset_table[] = {
+	{ "size",	OPT_INT,	&opt_size,	10	},
+	{ "inodes",	OPT_INT,	&opt_inodes,	10	},
+	{ "mode",	OPT_INT,	&opt_mode,	8	},
+	{ NULL,		0,		NULL,		0	}
+};
+
+/*
+ * Mount the file system.  Create the root directory, and return its details.
+ */
+static int
+fs_mount(dev_t __unused dev, unsigned int flags,
+	struct fsdriver_node * root_node, unsigned int * res_flags)
+{
+	struct inode *rip;
+
+	/* This file system can not be used as a root file system. */
+	if (flags & REQ_ISROOT)
+		return EINVAL;
+
+	if ((rip = alloc_inode(S_IFDIR | (opt_mode & ALLPERMS), 0, 0)) == NULL)
+		return ENFILE;
+
+	assert(rip->i_num == ROOT_INO_NR);
+
+	/* The root directory is its own parent, and covers "." and "..". */
+	rip->i_nlink = 2;
+	rip->i_parent = rip;
+
+	/* VFS keeps a reference to the root node while we are mounted. */
+	ref_inode(rip);
+
+	root_node->fn_ino_nr = rip->i_num;
+	root_node->fn_mode = rip->i_mode;
+	root_node->fn_size = rip->i_size;
+	root_node->fn_uid = rip->i_uid;
+	root_node->fn_gid = rip->i_gid;
+	root_node->fn_dev = NO_DEV;
+
+	*res_flags = RES_64BIT;
+
+	return OK;
+}
+
+/*
+ * Unmount the file system.  All contents are lost.
+ */
+static void
+fs_unmount(void)
+{
+	struct inode *root;
+
+	if ((root = find_inode(ROOT_INO_NR)) == NULL)
+		return;
+
+	/*
+	 * VFS guarantees that no inodes other than the root are still in use
+	 * when it unmounts a file system.  All contents are simply discarded;
+	 * the memory is released back to VM once the service exits.
+	 */
+	if (root->i_count > 1)
+		printf("TMPFS: unmounting while busy!\n");
+
+	root->i_count = 0;
+}
+
+/*
+ * Mount a file system on top of an inode of this file system.
+ */
+static int
+fs_mountpt(ino_t ino_nr)
+{
+	struct inode *rip;
+
+	if ((rip = find_inode(ino_nr)) == NULL)
+		return EINVAL;
+
+	if (rip->i_mountpoint)
+		return EBUSY;
+
+	if (S_ISBLK(rip->i_mode) || S_ISCHR(rip->i_mode))
+		return ENOTDIR;
+
+	rip->i_mountpoint = TRUE;
+
+	return OK;
+}
+
+/*
+ * Return file system statistics.
+ */
+static int
+fs_statvfs(struct statvfs * buf)
+{
+
+	buf->f_flag = ST_NOTRUNC;
+	buf->f_bsize = TMPFS_BLOCK_SIZE;
+	buf->f_frsize = TMPFS_BLOCK_SIZE;
+	buf->f_iosize = TMPFS_BLOCK_SIZE;
+	buf->f_blocks = tmpfs_max_bytes / TMPFS_BLOCK_SIZE;
+	buf->f_bfree = (tmpfs_max_bytes - tmpfs_used_bytes) /
+	    TMPFS_BLOCK_SIZE;
+	buf->f_bavail = buf->f_bfree;
+	buf->f_files = tmpfs_max_inodes;
+	buf->f_ffree = tmpfs_max_inodes - tmpfs_used_inodes;
+	buf->f_favail = buf->f_ffree;
+	buf->f_namemax = NAME_MAX;
+
+	return OK;
+}
+
+/*
+ * Initialize the service.
+ */
+static int
+fs_init(int __unused type, sef_init_info_t * __unused info)
+{
+	int i, r;
+
+	/* If we have been given an options string, parse options from it. */
+	for (i = 1; i < env_argc - 1; i++)
+		if (!strcmp(env_argv[i], "-o"))
+			optset_parse(optset_table, env_argv[++i]);
+
+	if (opt_size <= 0 || opt_inodes <= 0) {
+		printf("TMPFS: invalid size or inode limit\n");
+		return EINVAL;
+	}
+
+	tmpfs_max_bytes = (size_t)opt_size;
+	tmpfs_max_inodes = (unsigned int)opt_inodes;
+	tmpfs_used_bytes = 0;
+	tmpfs_used_inodes = 0;
+
+	if ((r = init_inodes()) != OK)
+		return r;
+
+	return OK;
+}
+
+/*
+ * Process an incoming signal.
+ */
+static void
+fs_signal(int signo)
+{
+
+	/* Only check for termination signal, ignore anything else. */
+	if (signo != SIGTERM) return;
+
+	fsdriver_terminate();
+}
+
+/*
+ * Perform SEF initialization.
+ */
+static void
+fs_startup(void)
+{
+
+	sef_setcb_init_fresh(fs_init);
+	sef_setcb_signal_handler(fs_signal);
+	sef_startup();
+}
+
+/*
+ * Function call table for the fsdriver library.
+ */
+static struct fsdriver tmpfs_table = {
+	.fdr_mount	= fs_mount,
+	.fdr_unmount	= fs_unmount,
+	.fdr_lookup	= fs_lookup,
+	.fdr_putnode	= fs_putnode,
+	.fdr_read	= fs_read,
+	.fdr_write	= fs_write,
+	.fdr_getdents	= fs_getdents,
+	.fdr_trunc	= fs_trunc,
+	.fdr_create	= fs_create,
+	.fdr_mkdir	= fs_mkdir,
+	.fdr_mknod	= fs_mknod,
+	.fdr_link	= fs_link,
+	.fdr_unlink	= fs_unlink,
+	.fdr_rmdir	= fs_rmdir,
+	.fdr_rename	= fs_rename,
+	.fdr_slink	= fs_slink,
+	.fdr_rdlink	= fs_rdlink,
+	.fdr_stat	= fs_stat,
+	.fdr_chown	= fs_chown,
+	.fdr_chmod	= fs_chmod,
+	.fdr_utime	= fs_utime,
+	.fdr_mountpt	= fs_mountpt,
+	.fdr_statvfs	= fs_statvfs
+};
+
+/*
+ * The main routine of this service.
+ */
+int
+main(void)
+{
+
+	/* Local startup. */
+	fs_startup();
+
+	/* The fsdriver library does the actual work here. */
+	fsdriver_task(&tmpfs_table);
+
+	return EXIT_SUCCESS;
+}
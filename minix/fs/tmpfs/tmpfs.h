@@ -0,0 +1,118 @@
+#ifndef _TMPFS_TMPFS_H
+#define _TMPFS_TMPFS_H
+
+/* TMPFS - memory-backed file system server */
+
+#include <minix/drivers.h>
+#include <minix/fsdriver.h>
+#include <minix/vfsif.h>
+#include <minix/optset.h>
+#include <sys/queue.h>
+#include <sys/stat.h>
+#include <sys/dirent.h>
+#include <assert.h>
+
+/*
+ * All file data is kept in blocks of the following size, allocated on demand.
+ * Blocks that consist of zeroes only need not be allocated at all, so files
+ * may be sparse.  The block size is also the unit of the size accounting
+ * against the mount-time size limit.
+ */
+#define TMPFS_BLOCK_SIZE	4096
+
+/* Default limits.  Both can be changed with mount options (see tmpfs.c). */
+#define TMPFS_DEFAULT_SIZE	(64 * 1024 * 1024)	/* data limit (bytes) */
+#define TMPFS_DEFAULT_INODES	1024			/* inode limit */
+#define TMPFS_DEFAULT_MODE	(S_IFDIR | 0777 | S_ISVTX) /* root dir mode */
+
+#define ROOT_INO_NR		1	/* inode number of the root directory */
+
+/* The following bits can be combined in the inode's i_update field. */
+#define ATIME			0x1	/* update access time later */
+#define MTIME			0x2	/* update modification time later */
+#define CTIME			0x4	/* update change time later */
+
+struct inode;
+
+/* A directory entry, linking a name to an inode. */
+struct dentry {
+	TAILQ_ENTRY(dentry) d_next;	/* next entry in the directory */
+	struct inode *d_ino;		/* the inode the entry points to */
+	char *d_name;			/* allocated, null-terminated name */
+};
+
+struct inode {
+	ino_t i_num;			/* inode number */
+
+	mode_t i_mode;			/* file mode and permissions */
+	uid_t i_uid;			/* user ID of the file's owner */
+	gid_t i_gid;			/* group ID of the file's owner */
+	nlink_t i_nlink;		/* number of links to this inode */
+	off_t i_size;			/* current file size in bytes */
+	dev_t i_rdev;			/* device number for device nodes */
+	time_t i_atime;			/* file access time */
+	time_t i_mtime;			/* file modification time */
+	time_t i_ctime;			/* file change time */
+
+	unsigned int i_count;		/* number of references from VFS */
+	unsigned char i_update;		/* which file times to update? */
+	unsigned char i_mountpoint;	/* is the inode a mount point? */
+	unsigned char i_free;		/* sanity check: is the inode free? */
+
+	struct inode *i_parent;		/* parent directory, for directories */
+	TAILQ_HEAD(, dentry) i_children; /* directory entries */
+
+	char **i_blocks;		/* data block pointers; NULL = hole */
+	size_t i_nblocks;		/* size of the block pointer array */
+	char *i_link;			/* symbolic link target */
+
+	LIST_ENTRY(inode) i_next;	/* next element in free list */
+};
+
+/* tmpfs.c */
+extern size_t tmpfs_max_bytes;		/* data limit, in bytes */
+extern size_t tmpfs_used_bytes;		/* data blocks in use, in bytes */
+extern unsigned int tmpfs_max_inodes;	/* inode limit */
+extern unsigned int tmpfs_used_inodes;	/* inodes in use */
+
+/* inode.c */
+int init_inodes(void);
+struct inode *find_inode(ino_t ino_nr);
+struct inode *alloc_inode(mode_t mode, uid_t uid, gid_t gid);
+void ref_inode(struct inode *rip);
+void free_inode(struct inode *rip);
+void get_times(struct inode *rip);
+int fs_putnode(ino_t ino_nr, unsigned int count);
+ssize_t fs_read(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
+	off_t pos, int call);
+ssize_t fs_write(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
+	off_t pos, int call);
+int fs_trunc(ino_t ino_nr, off_t start_pos, off_t end_pos);
+int fs_stat(ino_t ino_nr, struct stat *statbuf);
+int fs_chown(ino_t ino_nr, uid_t uid, gid_t gid, mode_t *mode);
+int fs_chmod(ino_t ino_nr, mode_t *mode);
+int fs_utime(ino_t ino_nr, struct timespec *atime, struct timespec *mtime);
+
+/* dir.c */
+struct dentry *find_dentry(struct inode *dir, const char *name);
+int add_dentry(struct inode *dir, const char *name, struct inode *rip);
+void del_dentry(struct inode *dir, struct dentry *dep);
+int fs_lookup(ino_t dir_nr, char *name, struct fsdriver_node *node,
+	int *is_mountpt);
+ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
+	off_t *posp);
+int fs_create(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid,
+	struct fsdriver_node *node);
+int fs_mkdir(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid);
+int fs_mknod(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid,
+	dev_t rdev);
+int fs_slink(ino_t dir_nr, char *name, uid_t uid, gid_t gid,
+	struct fsdriver_data *data, size_t bytes);
+ssize_t fs_rdlink(ino_t ino_nr, struct fsdriver_data *data, size_t bytes);
+int fs_link(ino_t dir_nr, char *name, ino_t ino_nr);
+int fs_unlink(ino_t dir_nr, char *name, int call);
+int fs_rmdir(ino_t dir_nr, char *name, int call);
+int fs_rename(ino_t old_dir_nr, char *old_name, ino_t new_dir_nr,
+	char *new_name);
+
+#endif /* !_TMPFS_TMPFS_H */
@@ -49,6 +49,7 @@ static struct optset optset_table[] = {
 	{ "gid",    OPT_INT,    &params.p_gid,       10                      },
 	{ "fmask",  OPT_INT,    &params.p_file_mask, 8                       },
 	{ "dmask",  OPT_INT,    &params.p_dir_mask,  8                       },
+	{ "ttl",    OPT_INT,    &params.p_attr_ttl,  10                      },
 	{ NULL,     0,          NULL,                0                       }
 };
 
@@ -69,6 +70,7 @@ init(int UNUSED(type), sef_init_info_t *UNUSED(info))
 	params.p_file_mask = 0755;
 	params.p_dir_mask = 0755;
 	params.p_case_insens = FALSE;
+	params.p_attr_ttl = 1;
 
 	/* We must have been given an options string. Parse the options. */
 	for (i = 1; i < env_argc - 1; i++)
@@ -42,6 +42,19 @@ struct xfp_save {
 /* Size of xfp_save structure. */
 #define FPU_XFP_SIZE		512
 
+/* XSAVE state area: the FXSAVE-format legacy region above, followed by a
+ * 64-byte header. XSTATE_BV is the first 64-bit word of the header; the
+ * remainder of the header must be zero. Only the x87 and SSE components
+ * are used, so the area is not any larger than the legacy region plus the
+ * header.
+ */
+#define FPU_XSAVE_HDR_OFF	FPU_XFP_SIZE
+#define FPU_XSAVE_SIZE		(FPU_XFP_SIZE + 64)
+
+/* XSTATE_BV component bits. */
+#define XSTATE_BV_X87		0x1
+#define XSTATE_BV_SSE		0x2
+
 union fpu_state_u {
 	struct fpu_regs_s fpu_regs;
 	struct xfp_save xfp_regs;
@@ -86,6 +86,9 @@ i386/vm.h
 #define CPUID1_ECX_SSSE3	(1L << 9)
 #define CPUID1_ECX_SSE4_1	(1L << 19)
 #define CPUID1_ECX_SSE4_2	(1L << 20)
+#define CPUID1_ECX_XSAVE	(1L << 26)	/* XSAVE/XRSTOR/XSETBV/XGETBV */
+
+#define CPUID7_EBX_ERMS		(1L << 9)	/* Enhanced REP MOVSB/STOSB */
 
 #define CPUID_EF_EDX_SYSENTER	(1L << 11)	/* Intel SYSENTER */
 
@@ -45,6 +45,9 @@ typedef struct {
 	endpoint_t ReviveProcNr;                  /* the process to unblock */
 	cdev_id_t ReviveId;                       /* request ID */
 	cp_grant_id_t ReviveGrant;		  /* grant id associated with io */
+	size_t ReviveSize;                        /* total size of the request */
+	size_t ReviveLeft;                        /* bytes still to be moved */
+	size_t ReviveOffset;                      /* progress within the grant */
 	endpoint_t SourceProcNr;                  /* process to send notify to (FS) */
 	u32_t FragSize;                           /* dma fragment size */
 	char *DmaBuf;        /* the dma buffer; extra space for 
@@ -52,6 +55,8 @@ typedef struct {
 	phys_bytes DmaPhys;                       /* physical address of dma buffer */
 	char* DmaPtr;                             /* pointer to aligned dma buffer */
 	int OutOfData;                            /* all buffers empty? */
+	unsigned int Underruns;                   /* playback ran dry (periods) */
+	unsigned int Overruns;                    /* capture data dropped (periods) */
 	char *ExtraBuf;                           /* don't use extra buffer;just 
 											   declare a pointer to supress
 											   error messages */
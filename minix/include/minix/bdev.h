@@ -12,12 +12,17 @@ extern ssize_t bdev_read(dev_t dev, u64_t pos, char *buf, size_t count,
 	int flags);
 extern ssize_t bdev_write(dev_t dev, u64_t pos, char *buf, size_t count,
 	int flags);
+extern ssize_t bdev_read_grant(dev_t dev, u64_t pos, endpoint_t granter,
+	cp_grant_id_t grant, size_t count, int flags);
+extern ssize_t bdev_write_grant(dev_t dev, u64_t pos, endpoint_t granter,
+	cp_grant_id_t grant, size_t count, int flags);
 extern ssize_t bdev_gather(dev_t dev, u64_t pos, iovec_t *vec, int count,
 	int flags);
 extern ssize_t bdev_scatter(dev_t dev, u64_t pos, iovec_t *vec, int count,
 	int flags);
 extern int bdev_ioctl(dev_t dev, unsigned long request, void *buf,
 	endpoint_t user_endpt);
+extern int bdev_discard(dev_t dev, u64_t pos, size_t count);
 
 /* Asynchronous API. */
 typedef int bdev_id_t;
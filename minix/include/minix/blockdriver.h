@@ -28,8 +28,17 @@ struct blockdriver {
   void (*bdr_alarm)(clock_t stamp);
   void (*bdr_other)(message *m_ptr, int ipc_status);
   int (*bdr_device)(devminor_t minor, device_id_t *id);
+  int (*bdr_discard)(devminor_t minor, u64_t position, size_t size);
 };
 
+/* Request scheduling policies for the incoming-message queue of a device.
+ * FIFO (the default) dispatches requests in arrival order; ELEVATOR sorts
+ * queued transfer requests on their device position, with a bound on how long
+ * any one request may be passed over. The latter pays off for seeking media.
+ */
+#define BLOCKDRIVER_SCHED_FIFO		0
+#define BLOCKDRIVER_SCHED_ELEVATOR	1
+
 /* Functions defined by libblockdriver. These can be used for both
  * singlethreaded and multithreaded drivers.
  */
@@ -47,6 +56,7 @@ void blockdriver_process(struct blockdriver *dp, message *m_ptr, int
 void blockdriver_terminate(void);
 void blockdriver_task(struct blockdriver *bdp);
 int blockdriver_mq_queue(message *m_ptr, int status);
+void blockdriver_set_scheduler(int sched_policy);
 #endif /* !_BLOCKDRIVER_MT_API */
 
 /* Parameters for the disk drive. */
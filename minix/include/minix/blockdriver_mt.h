@@ -11,6 +11,7 @@ void blockdriver_mt_sleep(void);
 void blockdriver_mt_wakeup(thread_id_t id);
 void blockdriver_mt_terminate(void);
 void blockdriver_mt_set_workers(device_id_t id, unsigned int workers);
+void blockdriver_mt_set_scheduler(device_id_t id, int sched_policy);
 thread_id_t blockdriver_mt_get_tid(void);
 
 void blockdriver_mt_support_lu(void);
@@ -58,8 +58,9 @@
 #define PM_GETEPINFO		(PM_BASE + 45)
 #define PM_GETPROCNR		(PM_BASE + 46)
 #define PM_GETSYSINFO		(PM_BASE + 47)
+#define PM_VFORK		(PM_BASE + 48)
 
-#define NR_PM_CALLS		48	/* highest number from base plus one */
+#define NR_PM_CALLS		49	/* highest number from base plus one */
 
 /*===========================================================================*
  *				Calls to VFS				     *
@@ -133,7 +134,25 @@
 #define VFS_GETSOCKNAME		(VFS_BASE + 61)
 #define VFS_GETPEERNAME		(VFS_BASE + 62)
 #define VFS_SHUTDOWN		(VFS_BASE + 63)
+#define VFS_SENDFILE		(VFS_BASE + 64)
+#define VFS_SENDMMSG		(VFS_BASE + 65)
+#define VFS_RECVMMSG		(VFS_BASE + 66)
+#define VFS_OPENAT		(VFS_BASE + 67)
+#define VFS_MKDIRAT		(VFS_BASE + 68)
+#define VFS_MKNODAT		(VFS_BASE + 69)
+#define VFS_UNLINKAT		(VFS_BASE + 70)
+#define VFS_LINKAT		(VFS_BASE + 71)
+#define VFS_RENAMEAT		(VFS_BASE + 72)
+#define VFS_SYMLINKAT		(VFS_BASE + 73)
+#define VFS_READLINKAT		(VFS_BASE + 74)
+#define VFS_STATAT		(VFS_BASE + 75)
+#define VFS_ACCESSAT		(VFS_BASE + 76)
+#define VFS_CHMODAT		(VFS_BASE + 77)
+#define VFS_CHOWNAT		(VFS_BASE + 78)
+#define VFS_UTIMENSAT		(VFS_BASE + 79)
+#define VFS_ACCEPT4		(VFS_BASE + 80)
+#define VFS_FADVISE		(VFS_BASE + 81)
 
-#define NR_VFS_CALLS		64	/* highest number from base plus one */
+#define NR_VFS_CALLS		82	/* highest number from base plus one */
 
 #endif /* !_MINIX_CALLNR_H */
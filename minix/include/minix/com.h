@@ -154,6 +154,16 @@
 #define BUSC_PCI_GET_BAR	(BUSC_RQ_BASE + 19)	/* Get Base Address
 							 * Register properties
 							 */
+#define BUSC_PCI_GET_CFG	(BUSC_RQ_BASE + 20)	/* Read a snapshot of
+							 * the configuration
+							 * space of a device
+							 * (safecopy)
+							 */
+#define BUSC_PCI_GET_DEVS	(BUSC_RQ_BASE + 21)	/* Get a snapshot of
+							 * all devices visible
+							 * to the caller
+							 * (safecopy)
+							 */
 #define IOMMU_MAP		(BUSC_RQ_BASE + 32)	/* Ask IOMMU to map
 							 * a segment of memory
 							 */
@@ -306,6 +316,7 @@
 #  define IRQ_ENABLE        3	/* enable interrupts */
 #  define IRQ_DISABLE       4	/* disable interrupts */
 #  define IRQ_REENABLE  0x001	/* reenable IRQ line after interrupt */
+#  define IRQ_HIGHPRIO  0x002	/* dispatch before other hooks on the line */
 #  define IRQ_BYTE      0x100	/* byte values */      
 #  define IRQ_WORD      0x200	/* word values */
 #  define IRQ_LONG      0x400	/* long values */
@@ -337,6 +348,12 @@
 #   define GET_CPUINFO    23    /* get information about cpus */
 #   define GET_REGS	  24	/* get general process registers */
 #   define GET_CPUTICKS	  25	/* get per-state ticks for a cpu */
+#   define GET_IPCTRACE	  26	/* get the IPC trace ring for a cpu */
+#   define GET_IRQSTATS	  27	/* get per-IRQ dispatch statistics */
+#   define GET_LOCKSTATS  28	/* get kernel lock contention statistics */
+#   define GET_STALLPROF  29	/* get the watchdog stall samples for a cpu */
+#   define GET_BOOTEVENTS 30	/* get the boot-phase event table */
+#   define GET_SAFECOPYSTATS 31	/* get grant copy size-class statistics */
 
 /* Subfunctions for SYS_PRIVCTL */
 #define SYS_PRIV_ALLOW		1	/* Allow process to run */
@@ -407,12 +424,15 @@
 #define VMCTL_VMINHIBIT_CLEAR	31
 #define VMCTL_CLEARMAPCACHE	32
 #define VMCTL_BOOTINHIBIT_CLEAR	33
+#define VMCTL_PTCACHE_INVAL	34
 
 /* Codes and field names for SYS_DIAGCTL. */
 #define DIAGCTL_CODE_DIAG	1	/* Print diagnostics. */
 #define DIAGCTL_CODE_STACKTRACE	2	/* Print process stack. */
 #define DIAGCTL_CODE_REGISTER	3	/* Register for diagnostic signals */
 #define DIAGCTL_CODE_UNREGISTER	4	/* Unregister for diagnostic signals */
+#define DIAGCTL_CODE_IPCTRACE	5	/* Enable or disable IPC tracing */
+#define DIAGCTL_CODE_LOCKSTATS	6	/* Enable or disable lock statistics */
 #define DIAG_BUFSIZE	(80*25)
 
 /* Field names for SYS_VTIMER. */
@@ -615,6 +635,9 @@
 /* MIB sysctl request on a registered subtree. */
 #define COMMON_MIB_CALL		(COMMON_RQ_BASE+5)
 
+/* Common request to all processes: SEF service time statistics. */
+#define COMMON_REQ_SEF_STATS	(COMMON_RQ_BASE+6)
+
 /* Reply to process event message to PM. */
 #define PROC_EVENT_REPLY	(COMMON_RS_BASE+0)
 
@@ -697,11 +720,13 @@
 #	define VFS_VMCALL_ENDPOINT	m10_i4
 #	define VFS_VMCALL_OFFSET	m10_ull1
 #	define VFS_VMCALL_LENGTH	m10_l3
+#	define VFS_VMCALL_BUF		m10_l1
 
 /* Request codes to from VM to VFS */
 #define VMVFSREQ_FDLOOKUP		101
 #define VMVFSREQ_FDCLOSE		102
 #define VMVFSREQ_FDIO			103
+#define VMVFSREQ_FDWRITE		104
 
 /* Calls from VFS. */
 #define VM_VFS_REPLY		(VM_RQ_BASE+30)
@@ -765,8 +790,17 @@
 
 #define VM_RS_PREPARE		(VM_RQ_BASE+48)
 
+#define VM_SWAPON		(VM_RQ_BASE+49)
+
+#define VM_MADVISE		(VM_RQ_BASE+50)
+
+#define VM_MLOCK		(VM_RQ_BASE+51)
+#define VM_MUNLOCK		(VM_RQ_BASE+52)
+#define VM_MLOCKALL		(VM_RQ_BASE+53)
+#define VM_MUNLOCKALL		(VM_RQ_BASE+54)
+
 /* Total. */
-#define NR_VM_CALLS				49
+#define NR_VM_CALLS				55
 #define VM_CALL_MASK_SIZE			BITMAP_CHUNKS(NR_VM_CALLS)
 
 /* not handled as a normal VM call, thus at the end of the reserved rage */
@@ -777,6 +811,7 @@
 /* Basic vm calls allowed to every process. */
 #define VM_BASIC_CALLS \
     VM_BRK, VM_MMAP, VM_MUNMAP, VM_MAP_PHYS, VM_UNMAP_PHYS, VM_INFO, \
+    VM_MADVISE, VM_MLOCK, VM_MUNLOCK, VM_MLOCKALL, VM_MUNLOCKALL, \
     VM_GETRUSAGE /* VM_GETRUSAGE is to be removed from this list ASAP */
 
 /*===========================================================================*
@@ -795,6 +830,10 @@
 #define IPC_SEMCTL	(IPC_BASE+6)
 #define IPC_SEMOP	(IPC_BASE+7)
 
+/* Futex-style wait/wake on a shared memory word */
+#define IPC_FUTEX_WAIT	(IPC_BASE+8)
+#define IPC_FUTEX_WAKE	(IPC_BASE+9)
+
 /*===========================================================================*
  *                Messages for Scheduling				     *
  *===========================================================================*/
@@ -805,6 +844,8 @@
 #define SCHEDULING_STOP		(SCHEDULING_BASE+3)
 #define SCHEDULING_SET_NICE	(SCHEDULING_BASE+4)
 #define SCHEDULING_INHERIT	(SCHEDULING_BASE+5)
+#define SCHEDULING_SET_BUDGET	(SCHEDULING_BASE+6)
+#define SCHEDULING_SET_CPU	(SCHEDULING_BASE+7)
 
 /*===========================================================================*
  *              Messages for USB                                             *
@@ -891,6 +932,7 @@
 #define INPUT_SETLEDS		(INPUT_RQ_BASE + 1)	/* set keyboard LEDs */
 
 #define INPUT_EVENT		(INPUT_RS_BASE + 0)	/* send input event */
+#define INPUT_EVENTS		(INPUT_RS_BASE + 1)	/* send event batch */
 
 /*===========================================================================*
  *			Messages for PTYFS				     *
@@ -974,6 +1016,7 @@
 #define BDEV_GATHER	(BDEV_RQ_BASE + 4)	/* read into a vector */
 #define BDEV_SCATTER	(BDEV_RQ_BASE + 5)	/* write from a vector */
 #define BDEV_IOCTL	(BDEV_RQ_BASE + 6)	/* I/O control operation */
+#define BDEV_DISCARD	(BDEV_RQ_BASE + 7)	/* discard a range of data */
 
 /* Message types for block device responses. */
 #define BDEV_REPLY	(BDEV_RS_BASE + 0)	/* general reply code */
@@ -1144,6 +1187,15 @@
 #  define NDEV_LINK_UP		1	/* link is up */
 #  define NDEV_LINK_DOWN	2	/* link is down */
 
+/*===========================================================================*
+ *		Messages for the information server			     *
+ *===========================================================================*/
+
+/* Base type for information server requests. */
+#define IS_RQ_BASE		0x1B00
+
+#define IS_GETSYSINFO	(IS_RQ_BASE + 0)	/* get a raw table snapshot */
+
 /*===========================================================================*
  *		Internal codes used by several services			     *
  *===========================================================================*/
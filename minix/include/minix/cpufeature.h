@@ -27,6 +27,10 @@
 
 #define _CPUF_I386_PAE		18	/* Page Address Extension */
 
+#define _CPUF_I386_ERMS		19	/* Enhanced REP MOVSB/STOSB */
+
+#define _CPUF_I386_XSAVE	20	/* XSAVE/XRSTOR/XSETBV/XGETBV */
+
 int _cpufeature(int featureno);
 
 #endif
@@ -90,6 +90,7 @@
 #  define ZERO_DEV    		   5	/* minor device for /dev/zero */
 #  define IMGRD_DEV   		   6	/* minor device for /dev/imgrd */
 #  define RAM_DEV_FIRST		   7	/* first minor device for /dev/ram* */
+#  define ZRAM_DEV		  13	/* minor device for /dev/zram */
 
 /* Minor device numbers for the TTY driver. */
 #  define CONS_MINOR		   0	/* console device */
@@ -6,6 +6,7 @@
 #ifdef _MINIX_SYSTEM
 
 #include <sys/types.h>
+#include <minix/config.h>
 #include <minix/endpoint.h>
 
 /* Flags. */
@@ -28,6 +29,26 @@
 /* DS constants. */
 #define DS_MAX_KEYLEN 80        /* Max length of a key, including '\0'. */
 
+/* Label snapshot, shared between the DS server and libsys.  DS keeps a
+ * read-only mirror of all label entries in this layout, and hands out a
+ * memory grant for it on DS_SNAPSHOT, so that services can perform label
+ * lookups without a round trip to DS each time.  The sequence number is even
+ * whenever the table is consistent; DS increments it both before and after
+ * every change, so a reader must retry if it observes an odd value or a
+ * change while copying.  Unused slots have an empty key.
+ */
+#define DS_SNAP_NR		(2*NR_SYS_PROCS)  /* matches NR_DS_KEYS */
+
+struct ds_snap_entry {
+	char dse_key[DS_MAX_KEYLEN];	/* published label */
+	endpoint_t dse_endpt;		/* endpoint the label maps to */
+};
+
+struct ds_snap {
+	u32_t ds_seq;			/* sequence number, odd = updating */
+	struct ds_snap_entry ds_entry[DS_SNAP_NR];
+};
+
 /* DS events. */
 #define DS_DRIVER_UP		1
 
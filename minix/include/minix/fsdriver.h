@@ -69,6 +69,7 @@ struct fsdriver {
 	    size_t bytes, off_t *pos);
 	int (*fdr_trunc)(ino_t ino_nr, off_t start_pos, off_t end_pos);
 	void (*fdr_seek)(ino_t ino);
+	int (*fdr_fadvise)(ino_t ino_nr, int advice);
 	int (*fdr_create)(ino_t dir_nr, char *name, mode_t mode, uid_t uid,
 	    gid_t gid, struct fsdriver_node *node);
 	int (*fdr_mkdir)(ino_t dir_nr, char *name, mode_t mode, uid_t uid,
@@ -104,11 +105,23 @@ struct fsdriver {
 	void (*fdr_other)(const message *m_ptr, int ipc_status);
 };
 
+/* Per-request-type statistics, maintained by the library.  The arrays are
+ * indexed by request number minus FS_BASE; entries with a NULL name are
+ * requests that the library does not implement.
+ */
+struct fsdriver_stat {
+	u64_t fst_calls;	/* number of requests handled */
+	u64_t fst_cycles;	/* TSC cycles spent handling them */
+};
+extern struct fsdriver_stat fsdriver_stats[];
+extern const char *const fsdriver_callnames[];
+
 /* Functions defined by libfsdriver. */
 void fsdriver_process(const struct fsdriver * __restrict fdp,
 	const message * __restrict m_ptr, int ipc_status, int asyn_reply);
 void fsdriver_terminate(void);
 void fsdriver_task(struct fsdriver *fdp);
+void fsdriver_mt_task(struct fsdriver *fdp, unsigned int workers);
 
 int fsdriver_copyin(const struct fsdriver_data *data, size_t off, void *ptr,
 	size_t len);
@@ -0,0 +1,67 @@
+#ifndef _MINIX_FUTEX_H
+#define _MINIX_FUTEX_H
+
+/*
+ * Futex-style wait/wake calls on 32-bit words in System V shared memory
+ * segments.  The word is identified by the identifier of the segment it lives
+ * in and its byte offset into the segment, so that all processes sharing the
+ * segment refer to the word by the same name, no matter where each of them
+ * attached the segment.
+ *
+ * The expected usage pattern is that processes operate on the shared word
+ * with atomic instructions on their own mappings, and make these calls only
+ * when they find the word in a contended state: no system call at all is made
+ * for an uncontended lock or unlock.
+ *
+ * minix_futex_wait() blocks the caller until a wake call is made on the same
+ * word, but only if the word still contains the given value; if it does not,
+ * the call fails with EAGAIN, and the caller must reexamine the word.  The
+ * call may also be interrupted by a signal (EINTR) or by removal of the
+ * segment (EIDRM).  minix_futex_wake() wakes up at most 'max' processes
+ * blocked on the word, and returns the number of processes woken up.
+ */
+
+#include <sys/types.h>
+
+int minix_futex_wait(int id, size_t offset, unsigned int value);
+int minix_futex_wake(int id, size_t offset, unsigned int max);
+
+/*
+ * Robust mutexes on futex words.  A robust mutex is a futex word that obeys
+ * the following convention: the word is zero when the mutex is free, and
+ * contains the process ID of the owner while the mutex is held.  The
+ * MINIX_FUTEX_WAITERS bit is set by processes that are about to block on the
+ * word, telling the unlocking owner that a wake call is needed.  The
+ * MINIX_FUTEX_OWNERDEAD bit is set by the IPC server when it finds that the
+ * owner of the mutex has exited without unlocking it, in which case the next
+ * process to acquire the mutex is told, through an EOWNERDEAD error code,
+ * that the state protected by the mutex may be inconsistent.  That process
+ * owns the mutex, and after repairing the state, it must mark the mutex as
+ * consistent again before unlocking it; otherwise, every subsequent
+ * acquisition will keep reporting EOWNERDEAD.
+ *
+ * minix_robust_mutex_lock() blocks until the calling process owns the mutex,
+ * and returns 0, or EOWNERDEAD as described above, or another error code on
+ * failure.  The wait calls that the server uses to detect owner death rely on
+ * process IDs, so a mutex owner must not die and have its process ID reused
+ * while another process is already blocked on the mutex; in practice this
+ * would require a full wrap-around of the process ID space during the block.
+ *
+ * These calls do not protect against threads within one process contending
+ * for the same mutex: like the word itself, the ownership of a robust mutex
+ * is per process.  Use mthread mutexes for synchronization within a process.
+ */
+#define MINIX_FUTEX_WAITERS	0x80000000	/* blocked processes exist */
+#define MINIX_FUTEX_OWNERDEAD	0x40000000	/* the owner died; recover */
+#define MINIX_FUTEX_TID_MASK	0x3fffffff	/* owner process ID bits */
+
+int minix_futex_wait_robust(int id, size_t offset, unsigned int value,
+	pid_t owner);
+
+int minix_robust_mutex_lock(int id, size_t offset,
+	volatile unsigned int * mutex);
+int minix_robust_mutex_unlock(int id, size_t offset,
+	volatile unsigned int * mutex);
+int minix_robust_mutex_consistent(volatile unsigned int * mutex);
+
+#endif /* _MINIX_FUTEX_H */
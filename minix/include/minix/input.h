@@ -12,6 +12,13 @@
 /* Known-invalid input device ID. */
 #define INVALID_INPUT_ID	(-1)
 
+/*
+ * Maximum number of events in a single batched input event message.  This
+ * value must match the array sizes in mess_linputdriver_input_events
+ * (see <minix/ipc.h>).
+ */
+#define INPUT_EVENTS_MAX	4
+
 #endif /* _SYSTEM */
 
 /*
@@ -361,6 +361,16 @@ typedef struct {
 } mess_lblockdriver_lbdev_reply;
 _ASSERT_MSG_SIZE(mess_lblockdriver_lbdev_reply);
 
+typedef struct {
+	int		id;
+	vir_bytes	offset;
+	unsigned int	value;
+	unsigned int	max;
+	pid_t		owner;
+	uint8_t		padding[36];
+} mess_lc_ipc_futex;
+_ASSERT_MSG_SIZE(mess_lc_ipc_futex);
+
 typedef struct {
 	int		id;
 	int		num;
@@ -608,6 +618,21 @@ typedef struct {
 } mess_lc_svrctl;
 _ASSERT_MSG_SIZE(mess_lc_svrctl);
 
+typedef struct {
+	int dirfd;		/* lookup start directory, or AT_FDCWD */
+	vir_bytes name;
+	size_t len;
+	int flags;		/* AT_* flags and/or open flags */
+	mode_t mode;
+	vir_bytes buf;		/* stat buffer / readlink target buffer */
+	size_t bufsize;
+	uid_t owner;
+	gid_t group;
+
+	uint8_t padding[20];
+} mess_lc_vfs_at;
+_ASSERT_MSG_SIZE(mess_lc_vfs_at);
+
 typedef struct {
 	vir_bytes name;
 	size_t len;
@@ -637,6 +662,17 @@ typedef struct {
 } mess_lc_vfs_creat;
 _ASSERT_MSG_SIZE(mess_lc_vfs_creat);
 
+typedef struct {
+	off_t offset;
+	off_t len;
+
+	int fd;
+	int advice;
+
+	uint8_t padding[32];
+} mess_lc_vfs_fadvise;
+_ASSERT_MSG_SIZE(mess_lc_vfs_fadvise);
+
 typedef struct {
 	int fd;
 
@@ -715,6 +751,19 @@ typedef struct {
 } mess_lc_vfs_link;
 _ASSERT_MSG_SIZE(mess_lc_vfs_link);
 
+typedef struct {
+	int dirfd1;		/* lookup start dir for name1, or AT_FDCWD */
+	vir_bytes name1;
+	size_t len1;
+	int dirfd2;		/* lookup start dir for name2, or AT_FDCWD */
+	vir_bytes name2;
+	size_t len2;
+	int flags;		/* AT_* flags */
+
+	uint8_t padding[28];
+} mess_lc_vfs_linkat;
+_ASSERT_MSG_SIZE(mess_lc_vfs_linkat);
+
 typedef struct {
 	int fd;
 	int backlog;
@@ -744,6 +793,18 @@ typedef struct {
 } mess_lc_vfs_mknod;
 _ASSERT_MSG_SIZE(mess_lc_vfs_mknod);
 
+typedef struct {
+	dev_t device;
+
+	int dirfd;		/* lookup start directory, or AT_FDCWD */
+	vir_bytes name;
+	size_t len;
+	mode_t mode;
+
+	uint8_t padding[32];
+} mess_lc_vfs_mknodat;
+_ASSERT_MSG_SIZE(mess_lc_vfs_mknodat);
+
 typedef struct {
 	int flags;
 	size_t devlen;
@@ -813,6 +874,16 @@ typedef struct {
 } mess_lc_vfs_select;
 _ASSERT_MSG_SIZE(mess_lc_vfs_select);
 
+typedef struct {
+	int out_fd;
+	int in_fd;
+	off_t offset;
+	size_t len;
+
+	uint8_t padding[36];
+} mess_lc_vfs_sendfile;
+_ASSERT_MSG_SIZE(mess_lc_vfs_sendfile);
+
 typedef struct {
 	int fd;
 	vir_bytes buf;		/* void * */
@@ -837,8 +908,9 @@ typedef struct {
 	int fd;
 	vir_bytes addr;		/* struct sockaddr * */
 	unsigned int addr_len;	/* socklen_t */
+	int flags;		/* SOCK_* flags (accept4 only) */
 
-	uint8_t padding[44];
+	uint8_t padding[40];
 } mess_lc_vfs_sockaddr;
 _ASSERT_MSG_SIZE(mess_lc_vfs_sockaddr);
 
@@ -851,6 +923,16 @@ typedef struct {
 } mess_lc_vfs_socket;
 _ASSERT_MSG_SIZE(mess_lc_vfs_socket);
 
+typedef struct {
+	int fd;
+	vir_bytes mmsgbuf;	/* struct mmsghdr * */
+	unsigned int vlen;
+	int flags;
+
+	uint8_t padding[40];
+} mess_lc_vfs_sockmmsg;
+_ASSERT_MSG_SIZE(mess_lc_vfs_sockmmsg);
+
 typedef struct {
 	int fd;
 	vir_bytes msgbuf;	/* struct msghdr * */
@@ -940,6 +1022,29 @@ typedef struct {
 } mess_lc_vm_shm_unmap;
 _ASSERT_MSG_SIZE(mess_lc_vm_shm_unmap);
 
+typedef struct {
+	uint64_t	size;
+	int		fd;
+	uint8_t		padding[44];
+} mess_lc_vm_swapon;
+_ASSERT_MSG_SIZE(mess_lc_vm_swapon);
+
+typedef struct {
+	void		*addr;
+	size_t		len;
+	int		advice;
+	uint8_t		padding[44];
+} mess_lc_vm_madvise;
+_ASSERT_MSG_SIZE(mess_lc_vm_madvise);
+
+typedef struct {
+	void		*addr;
+	size_t		len;
+	int		flags;		/* MCL_* for mlockall() */
+	uint8_t		padding[44];
+} mess_lc_vm_mlock;
+_ASSERT_MSG_SIZE(mess_lc_vm_mlock);
+
 typedef struct {
 	int status;
 	uint32_t id;		/* should be cdev_id_t */
@@ -1000,6 +1105,19 @@ typedef struct {
 } mess_linputdriver_input_event;
 _ASSERT_MSG_SIZE(mess_linputdriver_input_event);
 
+typedef struct {
+	int id;
+	unsigned int count;
+	/* The array sizes must match INPUT_EVENTS_MAX (see <minix/input.h>) */
+	uint16_t page[4];
+	uint16_t code[4];
+	int32_t value[4];
+	uint16_t flags[4];
+
+	uint8_t padding[8];
+} mess_linputdriver_input_events;
+_ASSERT_MSG_SIZE(mess_linputdriver_input_events);
+
 typedef struct {
 	int32_t req_id;
 	int32_t sock_id;
@@ -1457,8 +1575,8 @@ typedef struct {
 	endpoint_t endpt;
 	int fd;
 	int what;
-
-	uint8_t padding[44];
+	unsigned int nfds;	/* batched transfer: FD count, or 0 if unused */
+	int fds[10];		/* batched transfer: the FDs (COPYFD_MAX) */
 } mess_lsys_vfs_copyfd;
 _ASSERT_MSG_SIZE(mess_lsys_vfs_copyfd);
 
@@ -1862,7 +1980,9 @@ typedef struct {
 	vir_bytes	buff_addr;
 	size_t		buff_len;
 	int		prepare_state;
-	uint8_t padding[20];
+	vir_bytes	hb_addr;	/* heartbeat counter (reply only) */
+	u64_t		sef_tsc;	/* sef_startup() entry (reply only) */
+	u64_t		init_tsc;	/* initialization done (reply only) */
 } mess_rs_init;
 _ASSERT_MSG_SIZE(mess_rs_init);
 
@@ -1918,7 +2038,8 @@ typedef struct {
 	endpoint_t endpt;	/* process number for inform */
 	int sig;		/* signal number to send */
 	void *sigctx;		/* pointer to signal context */
-	uint8_t padding[28];
+	int count;		/* number of signal contexts (SYS_SIGSEND) */
+	uint8_t padding[24];
 } mess_sigcalls;
 _ASSERT_MSG_SIZE(mess_sigcalls);
 
@@ -1973,6 +2094,15 @@ typedef struct {
 } mess_vfs_fs_create;
 _ASSERT_MSG_SIZE(mess_vfs_fs_create);
 
+typedef struct {
+	ino_t inode;
+
+	int advice;
+
+	uint8_t data[44];
+} mess_vfs_fs_fadvise;
+_ASSERT_MSG_SIZE(mess_vfs_fs_fadvise);
+
 typedef struct {
 	dev_t device;
 
@@ -2345,6 +2475,13 @@ typedef struct {
 } mess_vfs_lsys_gcov;
 _ASSERT_MSG_SIZE(mess_vfs_lsys_gcov);
 
+typedef struct {
+	int fds[10];		/* the resulting FDs (COPYFD_MAX) */
+
+	uint8_t padding[16];
+} mess_vfs_lsys_copyfds;
+_ASSERT_MSG_SIZE(mess_vfs_lsys_copyfds);
+
 typedef struct {
 	dev_t device;
 	ino_t inode;
@@ -2445,6 +2582,7 @@ typedef struct noxfer_message {
 		mess_krn_lsys_sys_vumap	m_krn_lsys_sys_vumap;
 		mess_lbdev_lblockdriver_msg m_lbdev_lblockdriver_msg;
 		mess_lblockdriver_lbdev_reply m_lblockdriver_lbdev_reply;
+		mess_lc_ipc_futex	m_lc_ipc_futex;
 		mess_lc_ipc_semctl	m_lc_ipc_semctl;
 		mess_lc_ipc_semget	m_lc_ipc_semget;
 		mess_lc_ipc_semop	m_lc_ipc_semop;
@@ -2473,9 +2611,11 @@ typedef struct noxfer_message {
 		mess_lc_pm_wait4	m_lc_pm_wait4;
 		mess_lc_readclock_rtcdev m_lc_readclock_rtcdev;
 		mess_lc_svrctl		m_lc_svrctl;
+		mess_lc_vfs_at		m_lc_vfs_at;
 		mess_lc_vfs_chown	m_lc_vfs_chown;
 		mess_lc_vfs_close	m_lc_vfs_close;
 		mess_lc_vfs_creat	m_lc_vfs_creat;
+		mess_lc_vfs_fadvise	m_lc_vfs_fadvise;
 		mess_lc_vfs_fchdir	m_lc_vfs_fchdir;
 		mess_lc_vfs_fchmod	m_lc_vfs_fchmod;
 		mess_lc_vfs_fcntl	m_lc_vfs_fcntl;
@@ -2485,19 +2625,23 @@ typedef struct noxfer_message {
 		mess_lc_vfs_getvfsstat	m_lc_vfs_getvfsstat;
 		mess_lc_vfs_ioctl	m_lc_vfs_ioctl;
 		mess_lc_vfs_link	m_lc_vfs_link;
+		mess_lc_vfs_linkat	m_lc_vfs_linkat;
 		mess_lc_vfs_listen	m_lc_vfs_listen;
 		mess_lc_vfs_lseek	m_lc_vfs_lseek;
 		mess_lc_vfs_mknod	m_lc_vfs_mknod;
+		mess_lc_vfs_mknodat	m_lc_vfs_mknodat;
 		mess_lc_vfs_mount	m_lc_vfs_mount;
 		mess_lc_vfs_path	m_lc_vfs_path;
 		mess_lc_vfs_pipe2	m_lc_vfs_pipe2;
 		mess_lc_vfs_readlink	m_lc_vfs_readlink;
 		mess_lc_vfs_readwrite	m_lc_vfs_readwrite;
 		mess_lc_vfs_select	m_lc_vfs_select;
+		mess_lc_vfs_sendfile	m_lc_vfs_sendfile;
 		mess_lc_vfs_sendrecv	m_lc_vfs_sendrecv;
 		mess_lc_vfs_shutdown	m_lc_vfs_shutdown;
 		mess_lc_vfs_sockaddr	m_lc_vfs_sockaddr;
 		mess_lc_vfs_socket	m_lc_vfs_socket;
+		mess_lc_vfs_sockmmsg	m_lc_vfs_sockmmsg;
 		mess_lc_vfs_sockmsg	m_lc_vfs_sockmsg;
 		mess_lc_vfs_sockopt	m_lc_vfs_sockopt;
 		mess_lc_vfs_stat	m_lc_vfs_stat;
@@ -2508,6 +2652,9 @@ typedef struct noxfer_message {
 		mess_lc_vm_brk		m_lc_vm_brk;
 		mess_lc_vm_getphys	m_lc_vm_getphys;
 		mess_lc_vm_shm_unmap	m_lc_vm_shm_unmap;
+		mess_lc_vm_swapon	m_lc_vm_swapon;
+		mess_lc_vm_madvise	m_lc_vm_madvise;
+		mess_lc_vm_mlock	m_lc_vm_mlock;
 		mess_lchardriver_vfs_reply m_lchardriver_vfs_reply;
 		mess_lchardriver_vfs_sel1 m_lchardriver_vfs_sel1;
 		mess_lchardriver_vfs_sel2 m_lchardriver_vfs_sel2;
@@ -2515,6 +2662,8 @@ typedef struct noxfer_message {
 		mess_li2cdriver_i2c_busc_i2c_exec m_li2cdriver_i2c_busc_i2c_exec;
 		mess_li2cdriver_i2c_busc_i2c_reserve m_li2cdriver_i2c_busc_i2c_reserve;
 		mess_linputdriver_input_event m_linputdriver_input_event;
+		mess_linputdriver_input_events
+		    m_linputdriver_input_events;
 		mess_lsockdriver_vfs_accept_reply
 		    m_lsockdriver_vfs_accept_reply;
 		mess_lsockdriver_vfs_recv_reply
@@ -2625,6 +2774,7 @@ typedef struct noxfer_message {
 		mess_vfs_fs_chmod	m_vfs_fs_chmod;
 		mess_vfs_fs_chown	m_vfs_fs_chown;
 		mess_vfs_fs_create	m_vfs_fs_create;
+		mess_vfs_fs_fadvise	m_vfs_fs_fadvise;
 		mess_vfs_fs_flush	m_vfs_fs_flush;
 		mess_vfs_fs_ftrunc	m_vfs_fs_ftrunc;
 		mess_vfs_fs_getdents	m_vfs_fs_getdents;
@@ -2660,6 +2810,7 @@ typedef struct noxfer_message {
 		mess_vfs_lsockdriver_sendrecv	m_vfs_lsockdriver_sendrecv;
 		mess_vfs_lsockdriver_simple	m_vfs_lsockdriver_simple;
 		mess_vfs_lsockdriver_socket	m_vfs_lsockdriver_socket;
+		mess_vfs_lsys_copyfds	m_vfs_lsys_copyfds;
 		mess_vfs_lsys_gcov	m_vfs_lsys_gcov;
 		mess_vfs_lsys_socketpath	m_vfs_lsys_socketpath;
 		mess_vfs_utimens	m_vfs_utimens;
@@ -20,6 +20,9 @@ struct buf {
   block64_t lmfs_blocknr;      /* block number of its (minor) device */
   char lmfs_count;             /* number of users of this buffer */
   char lmfs_needsetcache;      /* to be identified to VM */
+  char lmfs_refd;              /* referenced again since entering the LRU? */
+  char lmfs_prefetched;        /* loaded by read-ahead, not yet looked up? */
+  char lmfs_noreuse;           /* evict early: the file was declared NOREUSE */
   size_t lmfs_bytes;           /* size of this block (allocated and used) */
   u32_t lmfs_flags;            /* Flags shared between VM and FS */
 
@@ -30,6 +33,16 @@ struct buf {
   u64_t lmfs_inode_offset;
 };
 
+/* Buffer cache statistics, maintained by the library. */
+struct lmfs_stats {
+  u64_t ls_hits;               /* block lookups satisfied from the cache */
+  u64_t ls_vmhits;             /* block lookups satisfied from the VM cache */
+  u64_t ls_misses;             /* block lookups that required a device read */
+  u64_t ls_rablocks;           /* blocks fetched by the read-ahead engine */
+  u64_t ls_raused;             /* read-ahead blocks later actually looked up */
+};
+extern struct lmfs_stats lmfs_stats;
+
 void lmfs_markdirty(struct buf *bp);
 void lmfs_markclean(struct buf *bp);
 int lmfs_isclean(struct buf *bp);
@@ -40,11 +53,13 @@ void lmfs_may_use_vmcache(int);
 void lmfs_set_blocksize(size_t blocksize);
 void lmfs_buf_pool(int new_nr_bufs);
 int lmfs_get_block(struct buf **bpp, dev_t dev, block64_t block, int how);
+int lmfs_cache_contains(dev_t dev, block64_t block);
 int lmfs_get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 	ino_t ino, u64_t off);
 void lmfs_put_block(struct buf *bp);
 void lmfs_free_block(dev_t dev, block64_t block);
 void lmfs_zero_block_ino(dev_t dev, ino_t ino, u64_t off);
+void lmfs_set_advice(dev_t dev, ino_t ino, int advice);
 void lmfs_invalidate(dev_t device);
 void lmfs_prefetch(dev_t dev, const block64_t *blockset, unsigned int nblocks);
 void lmfs_setquiet(int q);
@@ -60,6 +75,7 @@ void lmfs_change_blockusage(int delta);
 void lmfs_driver(dev_t dev, char *label);
 ssize_t lmfs_bio(dev_t dev, struct fsdriver_data *data, size_t bytes,
 	off_t pos, int call);
+void lmfs_other(const message *m_ptr, int ipc_status);
 void lmfs_bflush(dev_t dev);
 
 #endif /* _MINIX_FSLIB_H */
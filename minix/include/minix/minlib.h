@@ -1,6 +1,7 @@
 #ifndef _MINLIB
 #define _MINLIB
 
+#include <sys/types.h>
 #include <sys/mount.h>
 
 /* Miscellaneous BSD. */
@@ -18,11 +19,16 @@ int get_mtab_entry(char dev[PATH_MAX], char mount_point[PATH_MAX],
 int servxcheck(unsigned long peer, const char *service,
 	void (*logf)(int pass, const char *name));
 const char *servxfile(const char *file);
+ssize_t sendfile(int out_fd, int in_fd, off_t offset, size_t count);
 
 /* read_tsc() and friends */
 void read_tsc(u32_t *hi, u32_t *lo);
 void read_tsc_64(u64_t *t);
 
+/* Per-CPU statistics, from the mapped-in kernel information page. */
+struct kcpustats;
+int minix_getcpustats(struct kcpustats *kcs, int nelem);
+
 /* return values for fsversion */
 #define FSVERSION_MFS1		0x00001
 #define FSVERSION_MFS2		0x00002
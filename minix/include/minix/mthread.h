@@ -35,6 +35,7 @@ struct __mthread_mutex {
 typedef struct __mthread_mutex *mthread_mutex_t;
 
 struct __mthread_cond {
+  mthread_queue_t mc_queue;	/* Queue of threads waiting on this condition */
   struct __mthread_mutex *mc_mutex;	/* Associate mutex with condition */
 #ifdef MTHREAD_STRICT
   struct __mthread_cond *mc_prev;
@@ -71,6 +72,17 @@ typedef struct {
 #define MTHREAD_STACK_MIN MINSIGSTKSZ
 #define MTHREAD_KEYS_MAX 128
 
+#define MTHREAD_PRIO_NORMAL 0
+#define MTHREAD_PRIO_HIGH 1
+
+struct mthread_schedstats {
+  unsigned long ms_switches;	/* number of context switches */
+  unsigned long ms_wakeups;	/* number of threads made runnable */
+  unsigned long ms_hiwakeups;	/* ..of which on the high-priority tier */
+  unsigned long ms_latency;	/* cumulative run-queue latency, in switches */
+  unsigned long ms_maxlatency;	/* worst-case run-queue latency, in switches */
+};
+
 __BEGIN_DECLS
 /* allocate.c */
 int mthread_create(mthread_thread_t *thread, mthread_attr_t *tattr, void
@@ -139,6 +151,8 @@ int mthread_rwlock_wrlock(mthread_rwlock_t *rwlock);
 int mthread_rwlock_unlock(mthread_rwlock_t *rwlock);
 
 /* schedule.c */
+void mthread_schedstats(struct mthread_schedstats *stats);
+int mthread_setprio(mthread_thread_t thread, int priority);
 int mthread_yield(void);
 void mthread_yield_all(void);
 __END_DECLS
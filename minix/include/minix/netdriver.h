@@ -35,6 +35,7 @@ struct netdriver {
 	int (* ndr_send)(struct netdriver_data * data, size_t size);
 	unsigned int (* ndr_get_link)(uint32_t * media);
 	void (* ndr_intr)(unsigned int mask);
+	void (* ndr_poll)(unsigned int budget);
 	void (* ndr_tick)(void);
 	void (* ndr_other)(const message * m_ptr, int ipc_status);
 };
@@ -51,8 +52,12 @@ const char *netdriver_name(void);
 
 void netdriver_recv(void);
 void netdriver_send(void);
+int netdriver_send_pending(void);
 void netdriver_link(void);
 
+void netdriver_poll_start(void);
+void netdriver_poll_stop(void);
+
 void netdriver_stat_oerror(uint32_t count);
 void netdriver_stat_coll(uint32_t count);
 void netdriver_stat_ierror(uint32_t count);
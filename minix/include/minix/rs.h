@@ -63,6 +63,25 @@ Interface to the reincarnation server
 #define RS_CPU_DEFAULT		-1 /* use the default cpu or do not change the current one */
 #define RS_CPU_BSP		-2 /* use the bootstrap cpu */
 
+/* Boot-time profiling records, exported by RS through the minix.rs.boot
+ * sysctl subtree.  All times are in microseconds, relative to the first
+ * kernel boot event.
+ */
+#define RS_BOOTPROF_NR_KERNEL	16	/* matches the kernel's event table */
+
+struct rs_bootprof_kev {		/* one kernel boot phase */
+	char ke_name[16];		/* phase name, empty if slot unused */
+	u32_t ke_micros;		/* time the phase was entered */
+};
+
+struct rs_bootprof_srv {		/* one system service */
+	char sv_label[RS_MAX_LABEL_LEN]; /* service label */
+	u32_t sv_start;		/* RS sent the initialization request */
+	u32_t sv_sef;		/* service entered sef_startup() */
+	u32_t sv_init;		/* service completed initialization */
+	u32_t sv_ready;		/* RS received the initialization reply */
+};
+
 /* Labels are copied over separately. */
 struct rss_label
 {
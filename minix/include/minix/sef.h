@@ -328,6 +328,42 @@ void sef_setcb_gcov(sef_cb_gcov_t cb);
 /* Fault injection tool support. */
 #define SEF_FI_ALLOW_EDFI               1
 
+/*===========================================================================*
+ *				  SEF Stats				     *
+ *===========================================================================*/
+/* What to intercept. */
+#define INTERCEPT_SEF_STATS_REQUESTS 1
+#define SEF_STATS_REQUEST_TYPE COMMON_REQ_SEF_STATS
+#define IS_SEF_STATS_REQUEST(mp, status) \
+    ((mp)->m_type == COMMON_REQ_SEF_STATS)
+
+/* Request actions, carried in the getsysinfo message layout. */
+#define SEF_STATS_ENABLE	1	/* reset and start collecting */
+#define SEF_STATS_DISABLE	2	/* stop collecting */
+#define SEF_STATS_RETRIEVE	3	/* copy out the collected table */
+
+/* Per-message-type service time statistics, kept by the SEF message loop
+ * while collection is enabled. The service time of a message is the time
+ * between SEF handing it to the server and the server coming back to
+ * receive, counted in time stamp counter cycles and binned by log2.
+ */
+#define SEF_STATS_SLOTS		64	/* distinct message types tracked */
+#define SEF_STATS_BUCKETS	32	/* log2 service time buckets */
+
+struct sef_stats_slot {
+    int ss_type;			/* message type, or 0 if slot free */
+    u32_t ss_count;			/* messages of this type handled */
+    u32_t ss_bucket[SEF_STATS_BUCKETS];	/* log2(cycles) histogram */
+};
+
+struct sef_stats {
+    u32_t st_total;			/* total messages handled */
+    u32_t st_untracked;			/* handled, but no free slot left */
+    struct sef_stats_slot st_slot[SEF_STATS_SLOTS];
+};
+
+int sef_stats_request(endpoint_t who, int action, struct sef_stats *where);
+
 /*===========================================================================*
  *                          SEF State Transfer                               *
  *===========================================================================*/
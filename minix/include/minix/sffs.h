@@ -59,6 +59,9 @@ struct sffs_params {
   unsigned int p_file_mask;	/* AND-mask to apply to file permissions */
   unsigned int p_dir_mask;	/* AND-mask to apply to directory perms */
   int p_case_insens;		/* case insensitivity flag */
+  unsigned int p_attr_ttl;	/* seconds before cached attributes expire
+				 * (0 = do not cache attributes at all)
+				 */
 };
 
 int sffs_init(char *name, const struct sffs_table *table,
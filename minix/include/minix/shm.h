@@ -0,0 +1,32 @@
+#ifndef _MINIX_SHM_H
+#define _MINIX_SHM_H
+
+/*
+ * Named shared memory objects, layered over System V shared memory.  The VM
+ * service does not support writable MAP_SHARED file mappings, since its
+ * file-mapped memory is copied on write and never written back, so the POSIX
+ * shm_open(3) interface cannot provide memory that is actually shared between
+ * processes.  System V shared memory segments, on the other hand, are mapped
+ * truly shared; these calls merely give them string names.
+ *
+ * minix_shm_open() returns the identifier of the System V shared memory
+ * segment associated with the given name, creating the segment first if
+ * O_CREAT is given; O_EXCL and the permissions in 'mode' are honored as in
+ * shmget(2).  The identifier can be passed to shmat(2) to map the segment,
+ * to shmctl(2), and to the futex calls (see <minix/futex.h>) to synchronize
+ * on words in the segment.  minix_shm_unlink() marks the named segment for
+ * removal, which takes effect once all processes have detached it.
+ *
+ * The name is folded into a System V IPC key using a published hash (32-bit
+ * FNV-1a, truncated to the positive key space), so all processes agree on the
+ * name-to-segment mapping without filesystem involvement.  Distinct names may
+ * in principle hash to the same key; applications that create many objects
+ * with O_CREAT but without O_EXCL should keep this in mind.
+ */
+
+#include <sys/types.h>
+
+int minix_shm_open(const char * name, int oflag, mode_t mode, size_t size);
+int minix_shm_unlink(const char * name);
+
+#endif /* _MINIX_SHM_H */
@@ -101,6 +101,8 @@ typedef sockid_t (* sockevent_socket_cb_t)(int domain, int type, int protocol,
 	const struct sockevent_ops ** ops);
 
 void sockevent_init(sockevent_socket_cb_t socket_cb);
+void sockevent_defer(void);
+void sockevent_flush(void);
 void sockevent_process(const message * m_ptr, int ipc_status);
 
 void sockevent_clone(struct sock * sock, struct sock * newsock,
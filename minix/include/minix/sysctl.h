@@ -29,6 +29,8 @@
 #define MINIX_MIB	1
 #define MINIX_PROC	2
 #define MINIX_LWIP	3
+#define MINIX_FS	4
+#define MINIX_RS	5
 
 /*
  * These identifiers, under MINIX_TEST, are used by test87 to test the MIB
@@ -57,6 +59,7 @@
 /* Identifiers for subnodes of MINIX_PROC. */
 #define PROC_LIST	1
 #define PROC_DATA	2
+#define PROC_TAB	3
 
 /* Structure used for PROC_LIST.  Not part of the ABI.  Used by ProcFS only. */
 struct minix_proc_list {
@@ -68,9 +71,15 @@ struct minix_proc_list {
 #define MPLF_IN_USE	0x01		/* process slot is in use */
 #define MPLF_ZOMBIE	0x02		/* process is a zombie */
 
-/* Structure used for PROC_DATA.  Not part of the ABI.  Used by ProcFS only. */
+/*
+ * Structure used for PROC_DATA and PROC_TAB.  Not part of the ABI.  Used by
+ * ProcFS only.  PROC_DATA returns one entry for a given PID; PROC_TAB returns
+ * an array of NR_TASKS + NR_PROCS entries, indexed by kernel slot, in which
+ * unused slots have mpd_endpoint set to NONE.
+ */
 struct minix_proc_data {
 	endpoint_t mpd_endpoint;	/* process endpoint */
+	pid_t mpd_pid;			/* process PID (<= 0 for tasks) */
 	uint32_t mpd_flags;		/* procses flags (MPDF_) */
 	endpoint_t mpd_blocked_on;	/* blocked on other process, or NONE */
 	uint32_t mpd_priority;		/* current process priority */
@@ -80,6 +89,7 @@ struct minix_proc_data {
 	uint64_t mpd_kipc_cycles;	/* cycles spent on kernel IPC */
 	uint64_t mpd_kcall_cycles;	/* cycles spent on kernel calls */
 	uint32_t mpd_nice;		/* nice value */
+	uid_t mpd_uid;			/* effective user ID */
 	char mpd_name[16];		/* short process name */
 };
 #define MPDF_SYSTEM	0x01		/* process is a system service */
@@ -94,4 +104,10 @@ struct minix_proc_data {
 int __sysctl(const int *, unsigned int, void *, size_t *, const void *,
 	size_t);
 
+/*
+ * Retrieve a snapshot of the entire process table with a single call.  The
+ * given buffer should be large enough for NR_TASKS + NR_PROCS entries.
+ */
+int minix_getproctab(struct minix_proc_data *, size_t);
+
 #endif /* !_MINIX_SYSCTL_H */
@@ -101,6 +101,24 @@ int free_contig(void *addr, size_t len);
 #define AC_ALIGN64K	0x04
 #define AC_LOWER1M	0x08
 
+/* Pool of fixed-size DMA buffers, carved out of one contiguous region that is
+ * reserved once at initialization time.  Buffer allocation and freeing are
+ * constant-time free list operations that involve no calls to VM.
+ */
+struct dma_pool {
+  void *dp_base;		/* base of the contiguous region */
+  phys_bytes dp_phys;		/* physical address of the region */
+  size_t dp_bufsize;		/* rounded-up size of each buffer */
+  unsigned int dp_count;	/* total number of buffers */
+  void *dp_free;		/* head of the free list */
+};
+
+int dma_pool_init(struct dma_pool *pool, size_t bufsize, unsigned int count,
+	int flags);
+void *dma_pool_alloc(struct dma_pool *pool, phys_bytes *phys);
+void dma_pool_free(struct dma_pool *pool, void *buf);
+void dma_pool_cleanup(struct dma_pool *pool);
+
 /* Clock functionality: get system times, (un)schedule an alarm call, or
  * retrieve/set a process-virtual timer.
  */
@@ -169,6 +187,10 @@ int sys_umap_remote(endpoint_t proc_ep, endpoint_t grantee, int seg,
 	sys_diagctl(DIAGCTL_CODE_REGISTER, NULL, 0)
 #define sys_diagctl_unregister() \
 	sys_diagctl(DIAGCTL_CODE_UNREGISTER, NULL, 0)
+#define sys_diagctl_ipctrace(enable) \
+	sys_diagctl(DIAGCTL_CODE_IPCTRACE, NULL, enable)
+#define sys_diagctl_lockstats(enable) \
+	sys_diagctl(DIAGCTL_CODE_LOCKSTATS, NULL, enable)
 int sys_diagctl(int ctl, char *arg1, int arg2);
 
 /* Shorthands for sys_getinfo() system call. */
@@ -190,6 +212,9 @@ int sys_diagctl(int ctl, char *arg1, int arg2);
 #define sys_getidletsc(dst)	sys_getinfo(GET_IDLETSC, dst, 0,0,0)
 #define sys_getregs(dst,nr)	sys_getinfo(GET_REGS, dst, 0,0, nr)
 #define sys_getcputicks(dst,nr)	sys_getinfo(GET_CPUTICKS, dst, 0,0, nr)
+#define sys_getipctrace(dst,nr)	sys_getinfo(GET_IPCTRACE, dst, 0,0, nr)
+#define sys_getlockstats(dst)	sys_getinfo(GET_LOCKSTATS, dst, 0,0,0)
+#define sys_getstallprof(dst,nr) sys_getinfo(GET_STALLPROF, dst, 0,0, nr)
 int sys_getinfo(int request, void *val_ptr, int val_len, void *val_ptr2,
 	int val_len2);
 int sys_whoami(endpoint_t *ep, char *name, int namelen, int
@@ -198,6 +223,7 @@ int sys_whoami(endpoint_t *ep, char *name, int namelen, int
 /* Signal control. */
 int sys_kill(endpoint_t proc_ep, int sig);
 int sys_sigsend(endpoint_t proc_ep, struct sigmsg *sig_ctxt);
+int sys_sigsendv(endpoint_t proc_ep, struct sigmsg *sig_ctxt, int count);
 int sys_sigreturn(endpoint_t proc_ep, struct sigmsg *sig_ctxt);
 int sys_getksig(endpoint_t *proc_ep, sigset_t *k_sig_map);
 int sys_endksig(endpoint_t proc_ep);
@@ -229,9 +255,16 @@ int sys_in(int port, u32_t *value, int type);
 int sys_padconf(u32_t padconf, u32_t mask, u32_t value);
 
 /* pci.c */
+struct pci_dev_info
+{
+	int pdi_devind;			/* device index at the PCI server */
+	u16_t pdi_vid;			/* vendor ID */
+	u16_t pdi_did;			/* device ID */
+};
 void pci_init(void);
 int pci_first_dev(int *devindp, u16_t *vidp, u16_t *didp);
 int pci_next_dev(int *devindp, u16_t *vidp, u16_t *didp);
+int pci_get_devs(struct pci_dev_info *buf, int max);
 int pci_find_dev(u8_t bus, u8_t dev, u8_t func, int *devindp);
 void pci_reserve(int devind);
 int pci_reserve_ok(int devind);
@@ -249,6 +282,7 @@ int pci_set_acl(struct rs_pci *rs_pci);
 int pci_del_acl(endpoint_t proc_ep);
 int pci_get_bar(int devind, int port, u32_t *base, u32_t *size, int
 	*ioflag);
+int pci_get_cfg(int devind, u32_t *buf, size_t count);
 
 /* Profiling. */
 int sys_sprof(int action, int size, int freq, int type, endpoint_t
@@ -278,11 +312,13 @@ int socketpath(endpoint_t endpt, const char *path, size_t size, int what,
 #define SPATH_CHECK	0	/* check user permissions on socket path */
 #define SPATH_CREATE	1	/* create socket file at given path */
 int copyfd(endpoint_t endpt, int fd, int what);
+int copyfds(endpoint_t endpt, int * fds, unsigned int nfds, int what);
 #define COPYFD_FROM	0	/* copy file descriptor from remote process */
 #define COPYFD_TO	1	/* copy file descriptor to remote process */
 #define COPYFD_CLOSE	2	/* close file descriptor in remote process */
 #define COPYFD_CLOEXEC	0x8000	/* with COPYFD_TO: set close-on-exec flag */
 #define COPYFD_FLAGS	0xF000	/* flags mask */
+#define COPYFD_MAX	10	/* max FDs per batched copyfds() call */
 int closenb(int fd);
 
 /*
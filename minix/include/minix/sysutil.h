@@ -55,6 +55,7 @@ void panic_hook(void);
 void __panic_hook(void);
 int getuptime(clock_t *ticks, clock_t *realtime, time_t *boottime);
 clock_t getticks(void);
+int endpt_proc_nr(endpoint_t endpt, int *proc_nr);
 int tickdelay(clock_t ticks);
 int tsc_calibrate(void);
 u32_t sys_hz(void);
@@ -87,6 +88,12 @@ uint32_t cpuavg_getccpu(void);
 
 #define asynsend(ep, msg) asynsend3(ep, msg, 0)
 int asynsend3(endpoint_t ep, message *msg, int flags);
+/* One (destination, message) pair of a vectored asynchronous send. */
+typedef struct {
+	endpoint_t dst;
+	message msg;
+} asynvec_t;
+int asynsendv(asynvec_t *vec, int count, int flags);
 int asyn_geterror(endpoint_t *dst, message *msg, int *err);
 int senda_reload(void);
 
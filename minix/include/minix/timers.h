@@ -28,10 +28,19 @@ typedef void (*tmr_func_t)(int arg);
  * The timers watchdog function and expiration time are automatically set
  * by the library function tmrs_settimer, but its argument is not.  In general,
  * the timer is in use when it has a callback function.
+ *
+ * Active timers are kept in an intrusive pairing heap, rooted at the queue
+ * head pointer that the owner of the queue maintains.  The head is always the
+ * next timer due, so its expiry time may be read directly.  The three pointer
+ * fields are owned by the timers library; a timer that is not on any queue
+ * has a NULL tmr_prev and is not the head, which is how the library tells the
+ * two cases apart.
  */
 typedef struct minix_timer
 {
-  struct minix_timer	*tmr_next;	/* next in a timer chain */
+  struct minix_timer	*tmr_next;	/* next sibling in the timer heap */
+  struct minix_timer	*tmr_prev;	/* parent or previous sibling */
+  struct minix_timer	*tmr_child;	/* first child in the timer heap */
   clock_t 		tmr_exp_time;	/* expiration time (absolute) */
   tmr_func_t		tmr_func;	/* function to call when expired */
   int			tmr_arg;	/* integer argument */
@@ -61,7 +70,8 @@ typedef struct minix_timer
  * not to reinitialize a timer that is in a list of timers, or the chain
  * will be broken.
  */
-#define tmr_inittimer(tp) (void)((tp)->tmr_func = NULL, (tp)->tmr_next = NULL)
+#define tmr_inittimer(tp) (void)((tp)->tmr_func = NULL, (tp)->tmr_next = NULL, \
+	(tp)->tmr_prev = NULL, (tp)->tmr_child = NULL)
 
 /* The following generic timer management functions are available. They
  * can be used to operate on the lists of timers. Adding a timer to a list
@@ -122,6 +132,7 @@ int tmrs_exptimers(minix_timer_t **tmrs, clock_t now, clock_t *new_head);
 
 void init_timer(minix_timer_t *tp);
 void set_timer(minix_timer_t *tp, clock_t ticks, tmr_func_t watchdog, int arg);
+void set_timer_slack(clock_t slack);
 void cancel_timer(minix_timer_t *tp);
 void expire_timers(clock_t now);
 
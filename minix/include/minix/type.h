@@ -117,6 +117,9 @@ struct kclockinfo {
 #error "unknown endianness"
 #endif
   uint32_t hz;			/* clock frequency in ticks per second */
+  uint32_t seq;			/* update sequence number; odd during a
+				 * multi-field time change
+				 */
 };
 
 struct machine {
@@ -199,6 +202,38 @@ struct arm_frclock {
 	u32_t tcrr;		/* tcrr address */
 };
 
+/* Per-CPU statistics maintained by the kernel and exported to userland
+ * through the mapped-in kernel information page.  The kcpustats pointer in
+ * the minix_kerninfo structure points to an array of these structures, one
+ * per configured CPU; the number of CPUs actually in use is given by the
+ * machine structure.  The counters are updated without locking, so readers
+ * may observe slightly stale or torn values: these are statistics only.
+ */
+struct kcpustats {
+	u64_t kcs_busy_cycles;	/* TSC cycles spent running processes */
+	u64_t kcs_idle_cycles;	/* TSC cycles spent idling */
+	u64_t kcs_ctxsw;	/* number of process dispatches */
+	u32_t kcs_rqlen;	/* current run queue length */
+	u32_t kcs_spare;	/* reserved for future use */
+};
+
+/* Endpoint table maintained by the kernel and exported read-only through the
+ * mapped-in kernel information page.  Entry (kei_nr_tasks + n) holds the
+ * endpoint of the process currently occupying kernel process slot n, or NONE
+ * if that slot is free.  This allows system services to translate and
+ * validate endpoints, including detection of stale endpoints from earlier
+ * slot generations, with two memory loads instead of a kernel call.  The
+ * entries are updated whenever a slot is allocated or freed, so a reader may
+ * race with such updates; as with any endpoint check, a positive result is
+ * only authoritative for as long as the named process cannot exit.
+ */
+#define KEI_MAX_TASKS	16	/* room for kernel task slots (>= NR_TASKS) */
+struct kendpointinfo {
+	int kei_nr_tasks;	/* number of kernel task slots in use */
+	int kei_nr_procs;	/* number of process slots in use */
+	endpoint_t kei_endpoint[KEI_MAX_TASKS + _NR_PROCS];
+};
+
 /* The userland ABI portion of general information exposed by the kernel.
  * This structure may only ever be extended with new fields!
  */
@@ -241,9 +276,16 @@ struct minix_kerninfo {
 	struct kuserinfo	*kuserinfo;		/* userland ABI */
 	struct arm_frclock	*arm_frclock;		/* NOT userland ABI */
 	volatile struct kclockinfo	*kclockinfo;	/* NOT userland ABI */
+	volatile struct kcpustats	*kcpustats;	/* NOT userland ABI */
+	volatile struct kendpointinfo	*kendpointinfo;	/* NOT userland ABI */
 };
 
 #define MINIX_KIF_IPCVECS	(1L << 0)	/* minix_ipcvecs is valid */
 #define MINIX_KIF_USERINFO	(1L << 1)	/* kuserinfo is valid */
+#define MINIX_KIF_CLOCKINFO	(1L << 2)	/* kclockinfo is valid and has
+						 * a sequence number
+						 */
+#define MINIX_KIF_CPUSTATS	(1L << 3)	/* kcpustats is valid */
+#define MINIX_KIF_ENDPTINFO	(1L << 4)	/* kendpointinfo is valid */
 
 #endif /* _TYPE_H */
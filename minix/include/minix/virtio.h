@@ -97,6 +97,19 @@ int virtio_host_supports(struct virtio_device *dev, int bit);
 int virtio_to_queue(struct virtio_device *dev, int qidx,
 			struct vumap_phys *bufs, size_t num, void *data);
 
+/*
+ * Like virtio_to_queue(), but never kick the queue. This allows a driver
+ * to add a batch of buffers to a queue and notify the host only once, by
+ * calling virtio_queue_kick() after the last buffer has been added.
+ */
+int virtio_to_queue_defer(struct virtio_device *dev, int qidx,
+			struct vumap_phys *bufs, size_t num, void *data);
+
+/* Kick the queue if needed, after one or more virtio_to_queue_defer()
+ * calls.
+ */
+void virtio_queue_kick(struct virtio_device *dev, int qidx);
+
 /*
  * If the host used a chain of descriptors, return 0, set data as was given to
  * virtio_to_queue(), and if len is not NULL, set it to the resulting length.
@@ -67,6 +67,8 @@ extern struct inode *get_next_inode(const struct inode *previous);
 extern void get_inode_stat(const struct inode *inode, struct inode_stat *stat);
 extern void set_inode_stat(struct inode *inode, struct inode_stat *stat);
 
+extern void vtreefs_set_data_ttl(clock_t ttl);
+
 extern void run_vtreefs(struct fs_hooks *hooks, unsigned int nr_inodes,
 	size_t inode_extra, struct inode_stat *stat, index_t nr_indexed_slots,
 	size_t buf_size);
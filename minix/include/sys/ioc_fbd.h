@@ -58,9 +58,37 @@ enum {
 	FBD_CORRUPT_RANDOM		/* ..new random data every time */
 };
 
+/* Latency statistics. The driver timestamps every transfer request when it
+ * comes in, around the request forwarded to the underlying driver, and when
+ * the reply goes out again, and aggregates the results below. The driver
+ * round-trip time covers everything below FBD: the underlying driver, its
+ * queue, and the device itself. Time spent in FBD itself (data copying,
+ * grant management, fault injection) is accounted separately as overhead.
+ */
+#define FBD_LAT_BUCKETS	 16	/* latency buckets; [2^i, 2^(i+1)) usec */
+#define FBD_SIZE_BUCKETS 10	/* size buckets; [2^i, 2^(i+1)) * 512 bytes */
+
+struct fbd_opstats {
+	u64_t count;		/* number of forwarded requests */
+	u64_t lat_sum;		/* summed driver round-trip time (usec) */
+	u32_t lat_min;		/* shortest driver round trip (usec) */
+	u32_t lat_max;		/* longest driver round trip (usec) */
+	u64_t lat_hist[FBD_LAT_BUCKETS];   /* round trips by latency */
+	u64_t size_count[FBD_SIZE_BUCKETS]; /* requests by original size */
+	u64_t size_lat[FBD_SIZE_BUCKETS];  /* summed round trips by size */
+};
+
+struct fbd_stats {
+	u64_t overhead;		/* time spent in FBD itself (usec) */
+	struct fbd_opstats read;	/* read request statistics */
+	struct fbd_opstats write;	/* write request statistics */
+};
+
 /* The I/O control requests. */
 #define FBDCADDRULE	_IOW('B', 1, struct fbd_rule)	/* add a rule */
 #define FBDCDELRULE	_IOW('B', 2, fbd_rulenum_t)	/* delete a rule */
 #define FBDCGETRULE	_IOWR('B', 3, struct fbd_rule)	/* retrieve a rule */
+#define FBDCGETSTATS	_IOR('B', 4, struct fbd_stats)	/* get statistics */
+#define FBDCRESETSTATS	_IO('B', 5)			/* reset statistics */
 
 #endif /* _S_I_FBD_H */
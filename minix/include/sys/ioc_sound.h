@@ -20,6 +20,8 @@
 #define DSPIOSAMPLESINBUF	_IOR('s', 31, unsigned int)
 #define DSPIOPAUSE		_IO ('s', 32)
 #define DSPIORESUME		_IO ('s', 33)
+#define DSPIOUNDERRUNS		_IOR('s', 34, unsigned int)
+#define DSPIOOVERRUNS		_IOR('s', 35, unsigned int)
 
 /* Soundcard mixer ioctls. */
 #define MIXIOGETVOLUME		_IOWR('s', 10, struct volume_level)
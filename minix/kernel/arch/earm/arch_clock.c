@@ -152,6 +152,11 @@ void context_stop(struct proc * p)
 
 	tsc_per_state[cpu][counter] += tsc_delta;
 
+	if (counter == CP_IDLE)
+		kcpustats[cpu].kcs_idle_cycles += tsc_delta;
+	else
+		kcpustats[cpu].kcs_busy_cycles += tsc_delta;
+
 	*__tsc_ctr_switch = tsc;
 }
 
@@ -179,6 +184,14 @@ void restart_local_timer(void)
 {
 }
 
+void idle_local_timer(clock_t UNUSED(ticks))
+{
+	/* The timer on this platform is free-running; we cannot stretch it
+	 * over multiple ticks while idle.
+	 */
+	restart_local_timer();
+}
+
 int register_local_timer_handler(const irq_handler_t handler)
 {
 	return bsp_register_timer_handler(handler);
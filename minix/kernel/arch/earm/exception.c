@@ -187,6 +187,8 @@ void exception_handler(int is_nested, reg_t *saved_lr, int vector)
 	 */
 	if (((void*)*saved_lr >= (void*)copy_msg_to_user &&
 			(void*)*saved_lr <= (void*)__copy_msg_to_user_end) ||
+			((void*)*saved_lr >= (void*)copy_msg_status_to_user &&
+			(void*)*saved_lr <= (void*)__copy_msg_status_to_user_end) ||
 			((void*)*saved_lr >= (void*)copy_msg_from_user &&
 			(void*)*saved_lr <= (void*)__copy_msg_from_user_end)) {
 		switch(vector) {
@@ -723,6 +723,8 @@ int arch_phys_map_reply(const int index, const vir_bytes addr)
 		ASSIGN(kuserinfo);
 		ASSIGN(arm_frclock);
 		ASSIGN(kclockinfo);
+		ASSIGN(kcpustats);
+		ASSIGN(kendpointinfo);
 
 		/* adjust the pointers of the functions and the struct
 		 * itself to the user-accessible mapping
@@ -732,6 +734,9 @@ int arch_phys_map_reply(const int index, const vir_bytes addr)
 		minix_kerninfo_user = (vir_bytes) FIXEDPTR(&minix_kerninfo);
 
 		minix_kerninfo.ki_flags |= MINIX_KIF_USERINFO;
+		minix_kerninfo.ki_flags |= MINIX_KIF_CLOCKINFO;
+		minix_kerninfo.ki_flags |= MINIX_KIF_CPUSTATS;
+		minix_kerninfo.ki_flags |= MINIX_KIF_ENDPTINFO;
 
 		return OK;
 	}
@@ -42,6 +42,15 @@ static unsigned tsc_per_ms[CONFIG_MAX_CPUS];
 static unsigned tsc_per_tick[CONFIG_MAX_CPUS];
 static uint64_t tsc_per_state[CONFIG_MAX_CPUS][CPUSTATES];
 
+/* Tickless idle state: nonzero while the local timer has been stretched over
+ * multiple ticks by idle_local_timer(), along with the TSC value at the start
+ * of the idle period, so that restart_local_timer() can credit the skipped
+ * ticks on wakeup. Only ever set on the boot processor; the application
+ * processors stop their timer entirely while idle.
+ */
+static int idle_stretch[CONFIG_MAX_CPUS];
+static u64_t idle_stretch_tsc[CONFIG_MAX_CPUS];
+
 /*===========================================================================*
  *				init_8235A_timer			     *
  *===========================================================================*/
@@ -169,11 +178,60 @@ void restart_local_timer(void)
 {
 #ifdef USE_APIC
 	if (lapic_addr) {
-		lapic_restart_timer();
+		const unsigned cpu = cpuid;
+
+		if (idle_stretch[cpu]) {
+			u64_t tsc;
+			clock_t ticks;
+
+			/* We are waking up from a stretched idle period. Find
+			 * out from the TSC how many whole ticks have passed,
+			 * and credit them to the system clock. If the one-shot
+			 * timer itself woke us up, its interrupt handler has
+			 * yet to run and will account for one more tick.
+			 */
+			idle_stretch[cpu] = 0;
+			read_tsc_64(&tsc);
+			ticks = (clock_t)((tsc - idle_stretch_tsc[cpu]) /
+			    tsc_per_tick[cpu]);
+			if (lapic_read(LAPIC_TIMER_CCR) == 0 && ticks > 0)
+				ticks--;
+			if (ticks > 0)
+				clock_add_idle_ticks(ticks);
+
+			/* Resume the regular per-tick one-shot timer. */
+			lapic_set_timer_one_shot(1000000 / system_hz);
+		} else
+			lapic_restart_timer();
 	}
 #endif
 }
 
+void idle_local_timer(clock_t ticks)
+{
+#ifdef USE_APIC
+	/* With the APIC timer in one-shot mode we can skip timerless ticks
+	 * entirely: program the timer for the full idle period, and have
+	 * restart_local_timer() credit the skipped ticks on wakeup. This
+	 * saves both power and, on consolidated virtual machine hosts, the
+	 * host CPU time spent delivering empty tick interrupts to idle
+	 * guests.
+	 */
+	if (lapic_addr && ticks > 1) {
+		const unsigned cpu = cpuid;
+
+		read_tsc_64(&idle_stretch_tsc[cpu]);
+		idle_stretch[cpu] = 1;
+		lapic_set_timer_one_shot((1000000 / system_hz) * ticks);
+		return;
+	}
+#endif
+	/* The PIC timer is periodic and cannot skip ticks; just make sure
+	 * that the timer is rearmed if it expired while in the kernel.
+	 */
+	restart_local_timer();
+}
+
 int register_local_timer_handler(const irq_handler_t handler)
 {
 #ifdef USE_APIC
@@ -245,7 +303,10 @@ void context_stop(struct proc * p)
 
 		bkl_ticks[cpu] = bkl_ticks[cpu] + tsc - bkl_tsc;
 		bkl_tries[cpu]++;
-		bkl_succ[cpu] += !(!(succ == 0));
+		/* the ticket lock is free iff the next free ticket (high
+		 * half) equals the now-serving number (low half)
+		 */
+		bkl_succ[cpu] += !(!((succ >> 16) == (succ & 0xffff)));
 
 		p->p_cycles = p->p_cycles + tsc - *__tsc_ctr_switch;
 
@@ -339,6 +400,11 @@ void context_stop(struct proc * p)
 
 	tsc_per_state[cpu][counter] += tsc_delta;
 
+	if (counter == CP_IDLE)
+		kcpustats[cpu].kcs_idle_cycles += tsc_delta;
+	else
+		kcpustats[cpu].kcs_busy_cycles += tsc_delta;
+
 	*__tsc_ctr_switch = tsc;
 
 #ifdef CONFIG_SMP
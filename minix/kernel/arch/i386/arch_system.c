@@ -28,6 +28,16 @@
 #endif
 
 static int osfxsr_feature; /* FXSAVE/FXRSTOR instructions support (SSEx) */
+static int osxsave_feature; /* XSAVE/XRSTOR instructions support */
+
+int cpu_has_erms; /* Enhanced REP MOVSB/STOSB support; used by klib.S */
+
+/* Minimum byte count for which phys_copy uses non-temporal stores, or zero
+ * if the processor does not support them (SSE2 movnti).  Copies this large
+ * do not fit in the cache anyway, so writing around it saves the working
+ * set of whatever else is running.
+ */
+unsigned phys_copy_nt_min;
 
 /* set MP and NE flags to handle FPU exceptions in native mode. */
 #define CR0_MP_NE	0x0022
@@ -35,6 +45,8 @@ static int osfxsr_feature; /* FXSAVE/FXRSTOR instructions support (SSEx) */
 #define CR4_OSFXSR	(1L<<9)
 /* set OSXMMEXCPT[bit 10] if we provide #XM handler. */
 #define CR4_OSXMMEXCPT	(1L<<10)
+/* set CR4.OSXSAVE[bit 18] if XSAVE is supported. */
+#define CR4_OSXSAVE	(1L<<18)
 
 void * k_stacks;
 
@@ -74,8 +86,21 @@ void fpu_init(void)
 
 			write_cr4(cr4);
 			osfxsr_feature = 1;
+
+			/* Save and restore FPU state with XSAVE/XRSTOR if
+			 * the CPU supports it; both skip components that
+			 * are in their initial state.
+			 */
+			if(_cpufeature(_CPUF_I386_XSAVE)) {
+				write_cr4(read_cr4() | CR4_OSXSAVE);
+				xsetbv0(XSTATE_BV_X87 | XSTATE_BV_SSE, 0);
+				osxsave_feature = 1;
+			} else {
+				osxsave_feature = 0;
+			}
 		} else {
 			osfxsr_feature = 0;
+			osxsave_feature = 0;
 		}
 	} else {
 		/* No FPU presents. */
@@ -99,7 +124,9 @@ void save_local_fpu(struct proc *pr, int retain)
 
 	assert(state);
 
-	if(osfxsr_feature) {
+	if(osxsave_feature) {
+		xsave(state);
+	} else if(osfxsr_feature) {
 		fxsave(state);
 	} else {
 		fnsave(state);
@@ -139,9 +166,10 @@ void save_fpu(struct proc *pr)
 }
 
 /* reserve a chunk of memory for fpu state; every one has to
- * be FPUALIGN-aligned.
+ * be FPUALIGN-aligned. The extra room beyond the legacy FXSAVE image
+ * holds the XSAVE header, used when the CPU supports XSAVE.
  */
-static char fpu_state[NR_PROCS][FPU_XFP_SIZE] __aligned(FPUALIGN);
+static char fpu_state[NR_PROCS][FPU_XSAVE_SIZE] __aligned(FPUALIGN);
 
 void arch_proc_reset(struct proc *pr)
 {
@@ -155,7 +183,7 @@ void arch_proc_reset(struct proc *pr)
 		/* verify alignment */
 		assert(!((vir_bytes)v % FPUALIGN));
 		/* initialize state */
-		memset(v, 0, FPU_XFP_SIZE);
+		memset(v, 0, FPU_XSAVE_SIZE);
 	}
 
 	/* Clear process state. */
@@ -197,7 +225,9 @@ int restore_fpu(struct proc *pr)
 		fninit();
 		pr->p_misc_flags |= MF_FPU_INITIALIZED;
 	} else {
-		if(osfxsr_feature) {
+		if(osxsave_feature) {
+			failed = xrstor(state);
+		} else if(osfxsr_feature) {
 			failed = fxrstor(state);
 		} else {
 			failed = frstor(state);
@@ -209,6 +239,54 @@ int restore_fpu(struct proc *pr)
 	return OK;
 }
 
+void fpu_state_copyin(struct proc *pr)
+{
+	/* The caller copied a bare FXSAVE image into the process' FPU state
+	 * area. If the state is managed with XSAVE, complete the save area:
+	 * mark the x87 and SSE components as present so that XRSTOR loads
+	 * them from the legacy region instead of reinitializing them. The
+	 * rest of the XSAVE header is never written to and remains zero.
+	 */
+	if(osxsave_feature) {
+		*(u64_t *) (pr->p_seg.fpu_state + FPU_XSAVE_HDR_OFF) =
+			XSTATE_BV_X87 | XSTATE_BV_SSE;
+	}
+}
+
+void fpu_state_copyout(struct proc *pr)
+{
+	struct xfp_save *xfp;
+	u64_t xstate_bv;
+
+	/* The caller is about to copy the legacy region of the process' FPU
+	 * state area to a signal or machine context. XSAVE skips components
+	 * that were in their initial state, which leaves stale values in the
+	 * legacy region; write out the initial values so that the copy is a
+	 * faithful FXSAVE image.
+	 */
+	if(!osxsave_feature)
+		return;
+
+	xstate_bv = *(u64_t *) (pr->p_seg.fpu_state + FPU_XSAVE_HDR_OFF);
+	xfp = (struct xfp_save *) pr->p_seg.fpu_state;
+
+	if(!(xstate_bv & XSTATE_BV_X87)) {
+		memset(xfp->fp_st_regs, 0, sizeof(xfp->fp_st_regs));
+		xfp->fp_control = 0x037f;
+		xfp->fp_status = 0;
+		xfp->fp_tag = 0;	/* abridged tag word: all empty */
+		xfp->fp_opcode = 0;
+		xfp->fp_eip = 0;
+		xfp->fp_cs = 0;
+		xfp->fp_dp = 0;
+		xfp->fp_ds = 0;
+	}
+	if(!(xstate_bv & XSTATE_BV_SSE)) {
+		memset(xfp->fp_xreg_word, 0, sizeof(xfp->fp_xreg_word));
+		xfp->fp_mxcsr = 0x1f80;
+	}
+}
+
 void cpu_identify(void)
 {
 	u32_t eax, ebx, ecx, edx;
@@ -241,6 +319,11 @@ void cpu_identify(void)
 	cpu_info[cpu].stepping = eax & 0xf;
 	cpu_info[cpu].flags[0] = ecx;
 	cpu_info[cpu].flags[1] = edx;
+
+	cpu_has_erms = _cpufeature(_CPUF_I386_ERMS);
+
+	if (_cpufeature(_CPUF_I386_SSE2))
+		phys_copy_nt_min = 512 * 1024;
 }
 
 void arch_init(void)
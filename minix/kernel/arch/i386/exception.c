@@ -205,6 +205,8 @@ void exception_handler(int is_nested, struct exception_frame * frame)
 	 */
 	if (((void*)frame->eip >= (void*)copy_msg_to_user &&
 			(void*)frame->eip <= (void*)__copy_msg_to_user_end) ||
+			((void*)frame->eip >= (void*)copy_msg_status_to_user &&
+			(void*)frame->eip <= (void*)__copy_msg_status_to_user_end) ||
 			((void*)frame->eip >= (void*)copy_msg_from_user &&
 			(void*)frame->eip <= (void*)__copy_msg_from_user_end)) {
 		switch(frame->vector) {
@@ -224,7 +226,9 @@ void exception_handler(int is_nested, struct exception_frame * frame)
 	if (((void*)frame->eip >= (void*)fxrstor &&
 			(void *)frame->eip <= (void*)__fxrstor_end) ||
 			((void*)frame->eip >= (void*)frstor &&
-			(void *)frame->eip <= (void*)__frstor_end)) {
+			(void *)frame->eip <= (void*)__frstor_end) ||
+			((void*)frame->eip >= (void*)xrstor &&
+			(void *)frame->eip <= (void*)__xrstor_end)) {
 		frame->eip = (reg_t) __frstor_failure;
 		return;
 	}
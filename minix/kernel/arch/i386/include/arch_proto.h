@@ -114,6 +114,10 @@ int __fxrstor_end(void *);
 int frstor(void *);
 int __frstor_end(void *);
 int __frstor_failure(void *);
+void xsave(void *);
+int xrstor(void *);
+int __xrstor_end(void *);
+void xsetbv0(u32_t lo, u32_t hi);
 unsigned short fnstsw(void);
 void fnstcw(unsigned short* cw);
 void x86_lgdt(void *);
@@ -253,6 +257,7 @@ void int_gate_idt(unsigned vec_nr, vir_bytes offset, unsigned dpl_type);
 
 void __copy_msg_from_user_end(void);
 void __copy_msg_to_user_end(void);
+void __copy_msg_status_to_user_end(void);
 void __user_copy_msg_pointer_failure(void);
 
 int platform_tbl_checksum_ok(void *ptr, unsigned int length);
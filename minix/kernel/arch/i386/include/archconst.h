@@ -135,8 +135,10 @@
 #define CPU_VENDOR_AMD		2
 #define CPU_VENDOR_UNKNOWN	0xff
 
-/* fpu context should be saved in 16-byte aligned memory */
-#define FPUALIGN		16
+/* fpu context should be saved in 64-byte aligned memory; FXSAVE requires
+ * 16-byte alignment, XSAVE requires 64-byte alignment
+ */
+#define FPUALIGN		64
 
 /* Poweroff 16-bit code address */
 #define BIOS_POWEROFF_ENTRY 0x1000
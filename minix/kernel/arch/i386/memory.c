@@ -883,6 +883,8 @@ int arch_phys_map_reply(const int index, const vir_bytes addr)
 		ASSIGN(kuserinfo);
 		ASSIGN(arm_frclock); /* eh, why not. */
 		ASSIGN(kclockinfo);
+		ASSIGN(kcpustats);
+		ASSIGN(kendpointinfo);
 
 		/* select the right set of IPC routines to map into processes */
 		if(minix_feature_flags & MKF_I386_INTEL_SYSENTER) {
@@ -923,6 +925,9 @@ int arch_phys_map_reply(const int index, const vir_bytes addr)
 		}
 
 		minix_kerninfo.ki_flags |= MINIX_KIF_USERINFO;
+		minix_kerninfo.ki_flags |= MINIX_KIF_CLOCKINFO;
+		minix_kerninfo.ki_flags |= MINIX_KIF_CPUSTATS;
+		minix_kerninfo.ki_flags |= MINIX_KIF_ENDPTINFO;
 
 		return OK;
 	}
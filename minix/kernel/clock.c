@@ -172,6 +172,63 @@ int timer_int_handler(void)
 	return(1);					/* reenable interrupts */
 }
 
+/*===========================================================================*
+ *				clock_idle_ticks			     *
+ *===========================================================================*/
+clock_t clock_idle_ticks(void)
+{
+/* Return the number of clock ticks that the boot processor may spend idling
+ * without processing timer interrupts. While the CPU is idle, ticks serve no
+ * purpose beyond expiring CLOCK timers and keeping time, so the idle code may
+ * program the local timer to skip ahead to the next timer deadline and have
+ * the skipped ticks credited in one go upon wakeup (clock_add_idle_ticks).
+ * A return value of 1 means that ticks must be processed one at a time.
+ */
+  clock_t ticks;
+
+#ifdef USE_WATCHDOG
+  /* The watchdog checks that ticks keep coming; do not starve it. */
+  if (watchdog_enabled)
+	return 1;
+#endif
+
+  /* Adjusting realtime requires processing every single tick. */
+  if (adjtime_delta != 0)
+	return 1;
+
+  if (clock_timers == NULL)
+	ticks = system_hz;
+  else if (tmr_has_expired(clock_timers, kclockinfo.uptime))
+	return 1;
+  else
+	ticks = tmr_exp_time(clock_timers) - kclockinfo.uptime;
+
+  /* Cap the idle period at one second. The cap bounds the amount of clock
+   * catch-up to perform on wakeup, and keeps the load average samples (see
+   * load_update) reasonably dense.
+   */
+  if (ticks > (clock_t) system_hz)
+	ticks = system_hz;
+
+  return(ticks);
+}
+
+/*===========================================================================*
+ *				clock_add_idle_ticks			     *
+ *===========================================================================*/
+void clock_add_idle_ticks(clock_t ticks)
+{
+/* Credit ticks that were skipped while the boot processor was idling with a
+ * stretched local timer. Any CLOCK timers that became due in the meantime are
+ * expired by the timer interrupt handler, which runs right after the wakeup
+ * path calls this function. Per-process time accounting needs no catch-up:
+ * only the idle process was running, and its time is kept in TSC cycles by
+ * context_stop().
+ */
+  kclockinfo.uptime += ticks;
+  kclockinfo.realtime += ticks;
+}
+
 /*===========================================================================*
  *				get_realtime				     *
  *===========================================================================*/
@@ -214,6 +271,27 @@ void set_boottime(time_t newboottime)
   kclockinfo.boottime = newboottime;
 }
 
+/*===========================================================================*
+ *				kclock_write_begin			     *
+ *===========================================================================*/
+void kclock_write_begin(void)
+{
+  /* Mark the start of a multi-field clock update, so that userland readers
+   * of the shared clock information page can detect and retry inconsistent
+   * reads. The sequence number is odd while an update is in progress.
+   */
+  kclockinfo.seq++;
+}
+
+/*===========================================================================*
+ *				kclock_write_end			     *
+ *===========================================================================*/
+void kclock_write_end(void)
+{
+  /* Mark the end of a multi-field clock update. */
+  kclockinfo.seq++;
+}
+
 /*===========================================================================*
  *				get_boottime				     *
  *===========================================================================*/
@@ -9,11 +9,18 @@ int app_cpu_init_timer(unsigned freq);
 
 int timer_int_handler(void);
 
+/* how many ticks may the boot processor skip while idle? */
+clock_t clock_idle_ticks(void);
+/* credit ticks skipped during a stretched idle period */
+void clock_add_idle_ticks(clock_t ticks);
+
 int init_local_timer(unsigned freq);
 /* stop the local timer ticking */
 void stop_local_timer(void);
 /* let the time tick again with the original settings after it was stopped */
 void restart_local_timer(void);
+/* rearm the timer upon entering idle, skipping timerless ticks if possible */
+void idle_local_timer(clock_t ticks);
 int register_local_timer_handler(irq_handler_t handler);
 
 u64_t ms_2_cpu_time(unsigned ms);
@@ -26,6 +26,8 @@ extern struct loadinfo loadinfo;	  /* status of load average */
 extern struct kuserinfo kuserinfo;	  /* kernel information for users */
 extern struct arm_frclock arm_frclock;	  /* ARM free-running timer info */
 extern struct kclockinfo kclockinfo;	  /* clock information */
+extern struct kcpustats kcpustats[];	  /* per-CPU statistics */
+extern struct kendpointinfo kendpointinfo; /* endpoint validation table */
 extern struct minix_kerninfo minix_kerninfo;
 
 EXTERN struct k_randomness krandom; 	/* gather kernel random information */
@@ -44,11 +46,22 @@ EXTERN char *ipc_call_names[IPCNO_HIGHEST+1]; /* human-readable call names */
 EXTERN struct proc *kbill_kcall; /* process that made kernel call */
 EXTERN struct proc *kbill_ipc; /* process that invoked ipc */
 
+/* IPC tracing. Each CPU logs message deliveries into its own ring. */
+EXTERN int ipc_trace_enabled;	/* set through DIAGCTL_CODE_IPCTRACE */
+
 /* Interrupt related variables. */
 EXTERN irq_hook_t irq_hooks[NR_IRQ_HOOKS];	/* hooks for general use */
 EXTERN int irq_actids[NR_IRQ_VECTORS];		/* IRQ ID bits active */
+EXTERN irq_stat_t irq_stats[NR_IRQ_VECTORS];	/* per-IRQ dispatch accounting */
 EXTERN int irq_use;				/* map of all in-use irq's */
 
+/* Boot-phase timestamps, logged from kmain() onwards. */
+EXTERN struct boot_event boot_events[NR_BOOT_EVENTS];
+EXTERN int boot_events_count;
+
+/* Grant copy statistics, maintained by do_safecopy. */
+EXTERN struct safecopy_stat safecopy_stats[NR_SAFECOPY_CLASSES];
+
 /* Miscellaneous. */
 EXTERN int verboseboot;			/* verbose boot, init'ed in cstart */
 
@@ -36,13 +36,10 @@ void put_irq_handler( irq_hook_t* hook, int irq,
   if( irq < 0 || irq >= NR_IRQ_VECTORS )
 	panic("invalid call to put_irq_handler: %d",  irq);
 
-  line = &irq_handlers[irq];
-
   bitmap = 0;
-  while ( *line != NULL ) {
+  for (line = &irq_handlers[irq]; *line != NULL; line = &(*line)->next) {
 	if(hook == *line) return; /* extra initialization */
 	bitmap |= (*line)->id;	/* mark ids in use */
-	line = &(*line)->next;
   }
 
   /* find the lowest id not in use */
@@ -51,8 +48,22 @@ void put_irq_handler( irq_hook_t* hook, int irq,
 
   if(id == 0)
   	panic("Too many handlers for irq: %d",  irq);
-  
-  hook->next = NULL;
+
+  /* Find the insertion point. Hooks with a high-priority policy go in
+   * front of ordinary hooks on a shared line, so that e.g. a network
+   * driver is serviced before a slower handler hooked to the same line.
+   * Registration order is kept within each class.
+   */
+  line = &irq_handlers[irq];
+  if (hook->policy & IRQ_HIGHPRIO) {
+	while (*line != NULL && ((*line)->policy & IRQ_HIGHPRIO))
+		line = &(*line)->next;
+  } else {
+	while (*line != NULL)
+		line = &(*line)->next;
+  }
+
+  hook->next = *line;
   hook->handler = handler;
   hook->irq = irq;
   hook->id = id;
@@ -116,6 +127,7 @@ void rm_irq_handler( const irq_hook_t* hook ) {
 void irq_handle(int irq)
 {
   irq_hook_t * hook;
+  u64_t tsc, tsc_end;
 
   /* here we need not to get this IRQ until all the handlers had a say */
   assert(irq >= 0 && irq < NR_IRQ_VECTORS);
@@ -135,6 +147,12 @@ void irq_handle(int irq)
       return;
   }
 
+  /* Account the interrupt and the time spent servicing it, so that IRQ
+   * load can be inspected through sys_getinfo(GET_IRQSTATS).
+   */
+  read_tsc_64(&tsc);
+  irq_stats[irq].count++;
+
   /* Call list of handlers for an IRQ. */
   while( hook != NULL ) {
     /* For each handler in the list, mark it active by setting its ID bit,
@@ -150,6 +168,9 @@ void irq_handle(int irq)
     hook = hook->next;
   }
 
+  read_tsc_64(&tsc_end);
+  irq_stats[irq].cycles += tsc_end - tsc;
+
   /* reenable the IRQ only if there is no active handler */
   if (irq_actids[irq] == 0)
 	  hw_intr_unmask(irq);
@@ -43,6 +43,11 @@ EXTERN int _ipcf_nr;
 struct ipc_filter_s {
   int type;
   int num_elements;
+  int num_sorted;	/* elements[0..num_sorted-1] all match on m_type and
+			 * are sorted by it, so evaluation can binary search
+			 * them; the remaining elements match on m_source
+			 * only and are scanned linearly
+			 */
   int flags;
   struct ipc_filter_s *next;
   ipc_filter_el_t elements[IPCF_MAX_ELEMENTS];
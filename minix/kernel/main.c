@@ -35,6 +35,22 @@ char *** _penviron;
 /* Prototype declarations for PRIVATE functions. */
 static void announce(void);
 
+/*===========================================================================*
+ *				boot_event				     *
+ *===========================================================================*/
+void boot_event(const char *name)
+{
+/* Log a named, timestamped boot-phase event.  The table is retrieved by user
+ * space through sys_getinfo(GET_BOOTEVENTS) to attribute boot time to phases.
+ */
+  struct boot_event *bev;
+
+  if (boot_events_count >= NR_BOOT_EVENTS) return;
+  bev = &boot_events[boot_events_count++];
+  strlcpy(bev->bev_name, name, sizeof(bev->bev_name));
+  read_tsc_64(&bev->bev_tsc);
+}
+
 void bsp_finish_booting(void)
 {
   int i;
@@ -104,6 +120,8 @@ void bsp_finish_booting(void)
   /* Kernel may no longer use bits of memory as VM will be running soon */
   kernel_may_alloc = 0;
 
+  boot_event("switch_to_user");
+
   switch_to_user();
   NOT_REACHABLE;
 }
@@ -138,6 +156,8 @@ void kmain(kinfo_t *local_cbi)
   /* We can talk now */
   DEBUGBASIC(("MINIX booting\n"));
 
+  boot_event("kmain");
+
   /* Kernel may use bits of main memory before VM is started */
   kernel_may_alloc = 1;
 
@@ -146,6 +166,8 @@ void kmain(kinfo_t *local_cbi)
 
   cstart();
 
+  boot_event("cstart");
+
   BKL_LOCK();
  
    DEBUGEXTRA(("main()\n"));
@@ -268,9 +290,12 @@ void kmain(kinfo_t *local_cbi)
 
 	rp->p_rts_flags |= RTS_PROC_STOP;
 	rp->p_rts_flags &= ~RTS_SLOT_FREE;
+	kendpt_publish(rp);
 	DEBUGEXTRA(("done\n"));
   }
 
+  boot_event("procinit");
+
   /* update boot procs info for VM */
   memcpy(kinfo.boot_procs, image, sizeof(kinfo.boot_procs));
 
@@ -295,6 +320,8 @@ void kmain(kinfo_t *local_cbi)
   system_init();
   DEBUGEXTRA(("done\n"));
 
+  boot_event("sysinit");
+
   /* The bootstrap phase is over, so we can add the physical
    * memory used for it to the free list.
    */
@@ -24,9 +24,25 @@
  *  *xpp = new_node;		// now replace the end (the NULL pointer) 
  *  new_node->next = NULL;	// and mark the new end of the list
  * 
- * For example, when adding a new node to the end of the list, one normally 
- * makes an exception for an empty list and looks up the end of the list for 
+ * For example, when adding a new node to the end of the list, one normally
+ * makes an exception for an empty list and looks up the end of the list for
  * nonempty lists. As shown above, this is not required with pointer pointers.
+ *
+ * A note on the message path, for anyone looking to shave it further: a
+ * message crosses memory exactly once in each direction.  On send it goes
+ * straight from the sender's user buffer into the receiver's p_delivermsg
+ * slot (copy_msg_from_user); the copy out to the receiver's user buffer
+ * (delivermsg) is deferred until the receiver returns to userspace.  Both
+ * copies are fully unrolled word moves in klib.S, and the trap itself
+ * already uses sysenter/syscall when the CPU has it (see the ipcvec
+ * selection in arch/i386/memory.c).  Carrying small payloads in registers
+ * instead has been considered and rejected: the pagefault recovery for
+ * delivery (vm_suspend/VMSTYPE_DELIVERMSG below) relies on the message
+ * sitting in p_delivermsg so delivery can be retried after VM resolves the
+ * fault, and the usermapped ipcvecs ABI would have to carry a per-call
+ * register layout that every binary agrees on.  The win left on the table
+ * is one 56-byte copy per direction; the machinery to skip it would cost
+ * more than it saves.
  */
 
 #include <stddef.h>
@@ -59,10 +75,40 @@ static int try_one(endpoint_t receive_e, struct proc *src_ptr,
 	struct proc *dst_ptr);
 static struct proc * pick_proc(void);
 static void enqueue_head(struct proc *rp);
+#ifdef CONFIG_SMP
+static struct proc * steal_proc(void);
+#endif
+static int ipc_direct_handoff(struct proc *caller_ptr, struct proc *dst_ptr);
 
 /* all idles share the same idle_priv structure */
 static struct priv idle_priv;
 
+/* The IPC trace rings, one per CPU. A delivery is always logged on the CPU
+ * that writes the receiver's p_delivermsg, so each ring has a single writer
+ * and no locking is needed.
+ */
+struct ipc_trace_ring ipc_trace_ring[CONFIG_MAX_CPUS];
+
+/*===========================================================================*
+ *				ipc_trace_record			     *
+ *===========================================================================*/
+static void ipc_trace_record(const struct proc *dst_ptr)
+{
+/* Log the message just placed in 'dst_ptr's delivery buffer into the current
+ * CPU's trace ring. Callers must check ipc_trace_enabled first to keep the
+ * disabled case free of overhead.
+ */
+  struct ipc_trace_ring *itr = &ipc_trace_ring[cpuid];
+  struct ipc_trace_entry *ite;
+
+  ite = &itr->itr_ent[itr->itr_head % IPC_TRACE_ENTRIES];
+  read_tsc_64(&ite->ite_tsc);
+  ite->ite_src = dst_ptr->p_delivermsg.m_source;
+  ite->ite_dst = dst_ptr->p_endpoint;
+  ite->ite_type = dst_ptr->p_delivermsg.m_type;
+  itr->itr_head++;
+}
+
 static void set_idle_name(char * name, int n)
 {
         int i, c;
@@ -126,6 +172,8 @@ void proc_init(void)
 	 * mappings for proc_addr() and proc_nr() macros. Do the same for the
 	 * table with privilege structures for the system processes. 
 	 */
+	kendpointinfo.kei_nr_tasks = NR_TASKS;
+	kendpointinfo.kei_nr_procs = NR_PROCS;
 	for (rp = BEG_PROC_ADDR, i = -NR_TASKS; rp < END_PROC_ADDR; ++rp, ++i) {
 		rp->p_rts_flags = RTS_SLOT_FREE;/* initialize free slot */
 		rp->p_magic = PMAGIC;
@@ -134,6 +182,7 @@ void proc_init(void)
 		rp->p_scheduler = NULL;		/* no user space scheduler */
 		rp->p_priority = 0;		/* no priority */
 		rp->p_quantum_size_ms = 0;	/* no quantum size */
+		kendpt_publish(rp);		/* free: publish NONE */
 
 		/* arch-specific initialization */
 		arch_proc_reset(rp);
@@ -198,10 +247,12 @@ static void idle(void)
 #endif
 	{
 		/*
-		 * If the timer has expired while in kernel we must
-		 * rearm it before we go to sleep
+		 * If the timer has expired while in kernel we must rearm it
+		 * before we go to sleep. Moreover, while we are idle, ticks
+		 * serve no purpose other than expiring CLOCK timers, so let
+		 * the timer skip ahead to the next timer deadline if it can.
 		 */
-		restart_local_timer();
+		idle_local_timer(clock_idle_ticks());
 	}
 
 	/* start accounting for the idle time */
@@ -336,12 +387,19 @@ not_runnable_pick_new:
 	 * process. If there is still nothing runnable we "schedule" IDLE again
 	 */
 	while (!(p = pick_proc())) {
+#ifdef CONFIG_SMP
+		/* Before going idle, try to steal work from another CPU. */
+		if ((p = steal_proc()) != NULL)
+			break;
+#endif
 		idle();
 	}
 
 	/* update the global variable */
 	get_cpulocal_var(proc_ptr) = p;
 
+	kcpustats[cpuid].kcs_ctxsw++;
+
 #ifdef CONFIG_SMP
 	if (p->p_misc_flags & MF_FLUSH_TLB && get_cpulocal_var(ptproc) == p)
 		tlb_must_refresh = 1;
@@ -865,7 +923,73 @@ void unset_notify_pending(struct proc * caller, int src_p)
 }
 
 /*===========================================================================*
- *				mini_send				     * 
+ *				ipc_direct_handoff			     *
+ *===========================================================================*/
+static int ipc_direct_handoff(struct proc *caller_ptr, struct proc *dst_ptr)
+{
+/* Fast path for the common synchronous round trip: the caller is in the
+ * receive phase of a SENDREC and the receiver, running on the same CPU, was
+ * already blocked in RECEIVE. Instead of appending the receiver to the tail
+ * of its run queue and paying for a full scheduling pass, unblock it onto
+ * the head of the queue so it runs the moment the caller blocks for the
+ * reply, similar to an L4-style direct switch. Returns nonzero iff the
+ * RECEIVING flag has been dealt with here; zero means the caller must take
+ * the regular RTS_UNSET() path.
+ */
+  int rts;
+  int q;
+  struct proc **rdy_head, **rdy_tail;
+
+  /* Only hand off when the caller is about to block waiting for the reply;
+   * favoring the receiver in any other case would be unfair to the rest of
+   * the run queue.
+   */
+  if (!(caller_ptr->p_misc_flags & MF_REPLY_PEND)) return 0;
+
+  /* Cross-CPU wakeups must go through enqueue() so the remote CPU is
+   * kicked if it is idle.
+   */
+  if (caller_ptr->p_cpu != dst_ptr->p_cpu) return 0;
+
+  /* A process without quantum left must pass through the scheduler. */
+  if (!dst_ptr->p_cpu_time_left) return 0;
+
+  rts = dst_ptr->p_rts_flags;
+  dst_ptr->p_rts_flags &= ~RTS_RECEIVING;
+  if (rts_f_is_runnable(rts) || !proc_is_runnable(dst_ptr)) {
+	/* Some other flag still keeps the receiver off the run queues, or it
+	 * was runnable already; the flag is cleared but there is nothing to
+	 * hand off.
+	 */
+	return 1;
+  }
+
+  /* Put the receiver at the front of its run queue, without the preemption
+   * accounting that enqueue_head() performs for requeued processes.
+   */
+  q = dst_ptr->p_priority;
+  assert(q >= 0);
+  rdy_head = get_cpu_var(dst_ptr->p_cpu, run_q_head);
+  rdy_tail = get_cpu_var(dst_ptr->p_cpu, run_q_tail);
+  if (!rdy_head[q]) {
+	rdy_head[q] = rdy_tail[q] = dst_ptr;
+	dst_ptr->p_nextready = NULL;
+  } else {
+	dst_ptr->p_nextready = rdy_head[q];
+	rdy_head[q] = dst_ptr;
+  }
+
+  /* Make note of when this process was added to queue */
+  read_tsc_64(&dst_ptr->p_accounting.enter_queue);
+
+#if DEBUG_SANITYCHECKS
+  assert(runqueues_ok_local());
+#endif
+  return 1;
+}
+
+/*===========================================================================*
+ *				mini_send				     *
  *===========================================================================*/
 int mini_send(
   register struct proc *caller_ptr,	/* who is trying to send a message? */
@@ -908,6 +1032,9 @@ int mini_send(
 	dst_ptr->p_delivermsg.m_source = caller_ptr->p_endpoint;
 	dst_ptr->p_misc_flags |= MF_DELIVERMSG;
 
+	if (ipc_trace_enabled)
+		ipc_trace_record(dst_ptr);
+
 	call = (caller_ptr->p_misc_flags & MF_REPLY_PEND ? SENDREC
 		: (flags & NON_BLOCKING ? SENDNB : SEND));
 	IPC_STATUS_ADD_CALL(dst_ptr, call);
@@ -915,7 +1042,13 @@ int mini_send(
 	if (dst_ptr->p_misc_flags & MF_REPLY_PEND)
 		dst_ptr->p_misc_flags &= ~MF_REPLY_PEND;
 
-	RTS_UNSET(dst_ptr, RTS_RECEIVING);
+	/* Try a direct handoff first: for the common SENDREC round trip the
+	 * caller blocks right after this delivery, so the receiver may take
+	 * over the CPU immediately instead of waiting at the tail of its run
+	 * queue. Fall back to a regular unblock if the fast path declines.
+	 */
+	if (!ipc_direct_handoff(caller_ptr, dst_ptr))
+		RTS_UNSET(dst_ptr, RTS_RECEIVING);
 
 #if DEBUG_IPC_HOOK
 	hook_ipc_msgsend(&dst_ptr->p_delivermsg, caller_ptr, dst_ptr);
@@ -1030,6 +1163,9 @@ static int mini_receive(struct proc * caller_ptr,
 	    caller_ptr->p_delivermsg.m_source = sender_e;
 	    caller_ptr->p_misc_flags |= MF_DELIVERMSG;
 
+	    if (ipc_trace_enabled)
+		ipc_trace_record(caller_ptr);
+
 	    IPC_STATUS_ADD_CALL(caller_ptr, NOTIFY);
 
 	    goto receive_done;
@@ -1067,6 +1203,9 @@ static int mini_receive(struct proc * caller_ptr,
 	    caller_ptr->p_misc_flags |= MF_DELIVERMSG;
 	    RTS_UNSET(sender, RTS_SENDING);
 
+	    if (ipc_trace_enabled)
+		ipc_trace_record(caller_ptr);
+
 	    call = (sender->p_misc_flags & MF_REPLY_PEND ? SENDREC : SEND);
 	    IPC_STATUS_ADD_CALL(caller_ptr, call);
 
@@ -1151,6 +1290,9 @@ int mini_notify(
       dst_ptr->p_delivermsg.m_source = caller_ptr->p_endpoint;
       dst_ptr->p_misc_flags |= MF_DELIVERMSG;
 
+      if (ipc_trace_enabled)
+	  ipc_trace_record(dst_ptr);
+
       IPC_STATUS_ADD_CALL(dst_ptr, NOTIFY);
       RTS_UNSET(dst_ptr, RTS_RECEIVING);
 
@@ -1284,6 +1426,8 @@ int try_deliver_senda(struct proc *caller_ptr,
 		dst_ptr->p_delivermsg = tabent.msg;
 		dst_ptr->p_delivermsg.m_source = caller_ptr->p_endpoint;
 		dst_ptr->p_misc_flags |= MF_DELIVERMSG;
+		if (ipc_trace_enabled)
+			ipc_trace_record(dst_ptr);
 		IPC_STATUS_ADD_CALL(dst_ptr, SENDA);
 		RTS_UNSET(dst_ptr, RTS_RECEIVING);
 #if DEBUG_IPC_HOOK
@@ -1472,6 +1616,8 @@ static int try_one(endpoint_t receive_e, struct proc *src_ptr,
 	dst_ptr->p_delivermsg = tabent.msg;
 	dst_ptr->p_delivermsg.m_source = src_ptr->p_endpoint;
 	dst_ptr->p_misc_flags |= MF_DELIVERMSG;
+	if (ipc_trace_enabled)
+		ipc_trace_record(dst_ptr);
 #if DEBUG_IPC_HOOK
 	hook_ipc_msgrecv(&dst_ptr->p_delivermsg, src_ptr, dst_ptr);
 #endif
@@ -1625,6 +1771,8 @@ void enqueue(
       rp->p_nextready = NULL;		/* mark new end */
   }
 
+  kcpustats[rp->p_cpu].kcs_rqlen++;
+
   if (cpuid == rp->p_cpu) {
 	  /*
 	   * enqueueing a process with a higher priority than the current one,
@@ -1697,6 +1845,8 @@ static void enqueue_head(struct proc *rp)
 	rdy_head[q] = rp;			/* set new queue head */
   }
 
+  kcpustats[rp->p_cpu].kcs_rqlen++;
+
   /* Make note of when this process was added to queue */
   read_tsc_64(&(get_cpulocal_var(proc_ptr->p_accounting.enter_queue)));
 
@@ -1750,6 +1900,7 @@ void dequeue(struct proc *rp)
           if (rp == rdy_tail[q]) {		/* queue tail removed */
               rdy_tail[q] = prev_xp;		/* set new tail */
 	  }
+          kcpustats[rp->p_cpu].kcs_rqlen--;
 
           break;
       }
@@ -1812,6 +1963,71 @@ static struct proc * pick_proc(void)
   return NULL;
 }
 
+#ifdef CONFIG_SMP
+/*===========================================================================*
+ *				steal_proc				     *
+ *===========================================================================*/
+static struct proc * steal_proc(void)
+{
+/* The local run queues are empty. Try to pull a runnable process over from
+ * another CPU's run queues, so that this CPU does not sit idle while others
+ * have a backlog. As the kernel runs under the big kernel lock, it is safe to
+ * inspect and manipulate the queues of the other CPUs here. On success the
+ * stolen process, now enqueued locally, is returned through pick_proc().
+ */
+  struct proc **rdy_head;
+  struct proc *rp;
+  unsigned cpu;
+  int q;
+
+  for (cpu = 0; cpu < ncpus; cpu++) {
+	if (cpu == cpuid)
+		continue;
+	/* An idle CPU will take care of its own backlog, if any. */
+	if (get_cpu_var(cpu, cpu_is_idle))
+		continue;
+	rdy_head = get_cpu_var(cpu, run_q_head);
+	for (q = 0; q < NR_SCHED_QUEUES; q++) {
+		for (rp = rdy_head[q]; rp != NULL; rp = rp->p_nextready) {
+			/* The queue head may be what the remote CPU is
+			 * currently running; leave it alone.
+			 */
+			if (rp == get_cpu_var(cpu, proc_ptr))
+				continue;
+			/* Only migrate processes that are subject to
+			 * user-space scheduling; system processes stay where
+			 * they were put.
+			 */
+			if (proc_kernel_scheduler(rp))
+				continue;
+			/* Migrating a process whose lazily saved FPU state
+			 * still lives on the remote CPU would require an IPI
+			 * round trip; skip such processes.
+			 */
+			if (proc_used_fpu(rp) &&
+				get_cpu_var(cpu, fpu_owner) == rp)
+				continue;
+			/* Out of quantum means a trip to the scheduler. */
+			if (!rp->p_cpu_time_left)
+				continue;
+
+			/* Move the process over, reusing the stop/unstop
+			 * sequence to keep the queue bookkeeping in one
+			 * place, and pick it up from the local queues.
+			 */
+			RTS_SET(rp, RTS_PROC_STOP);
+			rp->p_cpu = cpuid;
+			RTS_UNSET(rp, RTS_PROC_STOP);
+
+			return pick_proc();
+		}
+	}
+  }
+
+  return NULL;
+}
+#endif /* CONFIG_SMP */
+
 /*===========================================================================*
  *				endpoint_lookup				     *
  *===========================================================================*/
@@ -1824,6 +2040,23 @@ struct proc *endpoint_lookup(endpoint_t e)
 	return proc_addr(n);
 }
 
+/*===========================================================================*
+ *				kendpt_publish				     *
+ *===========================================================================*/
+void kendpt_publish(struct proc *rp)
+{
+	/* Update the given process' entry in the endpoint validation table,
+	 * which is mapped read-only into all processes. This must be called
+	 * whenever a process slot is allocated or freed. Free slots are
+	 * published as NONE, so that a simple load-and-compare suffices to
+	 * reject both stale and never-valid endpoints.
+	 */
+	if (!isokprocn(rp->p_nr)) return;	/* e.g., per-CPU idle procs */
+
+	kendpointinfo.kei_endpoint[rp->p_nr + NR_TASKS] =
+		isemptyp(rp) ? NONE : rp->p_endpoint;
+}
+
 /*===========================================================================*
  *				isokendpt_f				     *
  *===========================================================================*/
@@ -1850,7 +2083,10 @@ int isokendpt_f(endpoint_t e, int * p, const int fatalflag)
 	 */
 	*p = _ENDPOINT_P(e);
 	ok = 0;
-	if(isokprocn(*p) && !isemptyn(*p) && proc_addr(*p)->p_endpoint == e)
+	/* The endpoint table holds NONE for free slots, so this single
+	 * comparison covers both the slot-in-use and the generation check.
+	 */
+	if(isokprocn(*p) && kendpointinfo.kei_endpoint[*p + NR_TASKS] == e)
 		ok = 1;
 	if(!ok && fatalflag)
 		panic("invalid endpoint: %d",  e);
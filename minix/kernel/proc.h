@@ -278,10 +278,34 @@ struct proc {
 #define isusern(n)        ((n) >= 0)
 #define isrootsysn(n)	  ((n) == ROOT_SYS_PROC_NR)
 
+/* System-wide IPC trace. When enabled at run time (DIAGCTL_CODE_IPCTRACE),
+ * every message delivery is logged into the delivering CPU's ring together
+ * with a time stamp counter value, so that the rings can be extracted
+ * (GET_IPCTRACE) and merged by time stamp afterwards. The head counts the
+ * total number of entries ever logged on that CPU; once a ring wraps the
+ * oldest entries are overwritten.
+ */
+#define IPC_TRACE_ENTRIES 4096		/* ring size, per CPU */
+
 #ifndef __ASSEMBLY__
 
+struct ipc_trace_entry {
+  u64_t ite_tsc;			/* time stamp counter at delivery */
+  endpoint_t ite_src;			/* sending endpoint */
+  endpoint_t ite_dst;			/* receiving endpoint */
+  int ite_type;				/* message type */
+};
+
+struct ipc_trace_ring {
+  unsigned itr_head;			/* total # entries logged; next slot
+					 * is itr_head % IPC_TRACE_ENTRIES */
+  struct ipc_trace_entry itr_ent[IPC_TRACE_ENTRIES];
+};
+
 EXTERN struct proc proc[NR_TASKS + NR_PROCS];	/* process table */
 
+extern struct ipc_trace_ring ipc_trace_ring[];	/* one ring per CPU */
+
 int mini_send(struct proc *caller_ptr, endpoint_t dst_e, message *m_ptr,
 	int flags);
 
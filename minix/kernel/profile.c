@@ -48,65 +48,99 @@ void stop_profile_clock(void)
   rm_irq_handler(&profile_clock_hook);
 }
 
-static void sprof_save_sample(struct proc * p, void * pc)
-{
-	struct sprof_sample *s;
-
-	s = (struct sprof_sample *) (sprof_sample_buffer + sprof_info.mem_used);
+/* Bytes reserved for the process name records written out at stop time. */
+#define SPROF_PROC_AREA	((NR_TASKS + NR_PROCS) * sizeof(struct sprof_proc))
 
-	s->proc = p->p_endpoint;
-	s->pc = pc;
+/*===========================================================================*
+ *			sprof_init_buffers				     *
+ *===========================================================================*/
+int sprof_init_buffers(void)
+{
+/* Partition the sample buffer into one slice per CPU, leaving room for the
+ * process name records that are appended when profiling is stopped.
+ */
+  char *p = sprof_sample_buffer;
+  unsigned c;
+  int slice;
+
+#ifdef CONFIG_SMP
+  sprof_ncpus = ncpus;
+#else
+  sprof_ncpus = 1;
+#endif
+
+  slice = (sprof_mem_size - (int) SPROF_PROC_AREA) / (int) sprof_ncpus;
+  if (sprof_mem_size < (int) SPROF_PROC_AREA ||
+		slice < 2 * (int) sizeof(struct sprof_sample))
+	return ENOMEM;
+
+  for (c = 0; c < sprof_ncpus; c++) {
+	sprof_cpu[c].buf = p;
+	sprof_cpu[c].size = slice;
+	sprof_cpu[c].used = 0;
+	sprof_cpu[c].full = 0;
+	sprof_cpu[c].total_samples = 0;
+	sprof_cpu[c].idle_samples = 0;
+	sprof_cpu[c].system_samples = 0;
+	sprof_cpu[c].user_samples = 0;
+	p += slice;
+  }
 
-	sprof_info.mem_used += sizeof(struct sprof_sample);
+  return OK;
 }
 
-static void sprof_save_proc(struct proc * p)
+static void sprof_save_sample(struct sprof_cpu * sc, struct proc * p,
+	void * pc)
 {
-	struct sprof_proc * s;
+	struct sprof_sample *s;
 
-	s = (struct sprof_proc *) (sprof_sample_buffer + sprof_info.mem_used);
+	s = (struct sprof_sample *) (sc->buf + sc->used);
 
 	s->proc = p->p_endpoint;
-	strcpy(s->name, p->p_name);
+	s->pc = pc;
 
-	sprof_info.mem_used += sizeof(struct sprof_proc);
+	sc->used += sizeof(struct sprof_sample);
 }
 
 static void profile_sample(struct proc * p, void * pc)
 {
-/* This executes on every tick of the CMOS timer. */
+/* This executes on every tick of the profiling timer, possibly on several
+ * CPUs at once; all the state it touches lives in the current CPU's slice.
+ */
+  struct sprof_cpu * sc;
 
-  /* Are we profiling, and profiling memory not full? */
-  if (!sprofiling || sprof_info.mem_used == -1)
+  if (!sprofiling)
+	  return;
+
+  sc = &sprof_cpu[cpuid];
+
+  /* Is this CPU's slice of profiling memory full? */
+  if (sc->full)
 	  return;
 
   /* Check if enough memory available before writing sample. */
-  if (sprof_info.mem_used + sizeof(sprof_info) +
-		  2*sizeof(struct sprof_sample) +
-		  2*sizeof(struct sprof_sample) > sprof_mem_size) {
-	sprof_info.mem_used = -1;
+  if (sc->used + 2 * (int) sizeof(struct sprof_sample) > sc->size) {
+	sc->full = 1;
 	return;
   }
 
   /* Runnable system process? */
   if (p->p_endpoint == IDLE)
-	sprof_info.idle_samples++;
+	sc->idle_samples++;
   else if (p->p_endpoint == KERNEL ||
 		(priv(p)->s_flags & SYS_PROC && proc_is_runnable(p))) {
 
-	if (!(p->p_misc_flags & MF_SPROF_SEEN)) {
-		p->p_misc_flags |= MF_SPROF_SEEN;
-		sprof_save_proc(p);
-	}
+	/* The matching process name record is written out at stop time. */
+	p->p_misc_flags |= MF_SPROF_SEEN;
 
-	sprof_save_sample(p, pc);
-	sprof_info.system_samples++;
+	sprof_save_sample(sc, p, pc);
+	sc->system_samples++;
   } else {
 	/* User process. */
-	sprof_info.user_samples++;
+	sc->user_samples++;
   }
-  
-  sprof_info.total_samples++;
+
+  sc->total_samples++;
 }
 
 /*===========================================================================*
@@ -141,8 +175,8 @@ void nmi_sprofile_handler(struct nmi_frame * frame)
 		 * account for idle time rather than taking kernel sample
 		 */
 		if (p->p_endpoint == IDLE) {
-			sprof_info.idle_samples++;
-			sprof_info.total_samples++;
+			sprof_cpu[cpuid].idle_samples++;
+			sprof_cpu[cpuid].total_samples++;
 			return;
 		}
 
@@ -10,6 +10,24 @@
 #define SAMPLE_BUFFER_SIZE	(64 << 20)
 extern char sprof_sample_buffer[SAMPLE_BUFFER_SIZE];
 
+/* Per-CPU slice of the sample buffer. Each CPU logs samples only into its
+ * own slice and its own counters, so profiling interrupt handlers running
+ * on several CPUs at once never contend or race on shared state. The
+ * slices are concatenated when profiling is stopped.
+ */
+struct sprof_cpu {
+	char *buf;		/* start of this CPU's slice */
+	int size;		/* slice size in bytes */
+	int used;		/* bytes of the slice filled so far */
+	int full;		/* set when the slice filled up */
+	int total_samples;	/* per-CPU counters, summed at stop time */
+	int idle_samples;
+	int system_samples;
+	int user_samples;
+};
+EXTERN struct sprof_cpu sprof_cpu[CONFIG_MAX_CPUS];
+EXTERN unsigned sprof_ncpus;	/* # slices in use */
+
 EXTERN int sprofiling;			/* whether profiling is running */
 EXTERN int sprofiling_type;			/* whether profiling is running */
 EXTERN int sprof_mem_size;		/* available user memory for data */
@@ -17,6 +35,7 @@ EXTERN struct sprof_info_s sprof_info;	/* profiling info for user program */
 EXTERN vir_bytes sprof_data_addr_vir;	/* user address to write data */
 EXTERN endpoint_t sprof_ep;		/* user process */
 
+int sprof_init_buffers(void);
 void nmi_sprofile_handler(struct nmi_frame * frame);
 
 #endif /* SPROFILE */
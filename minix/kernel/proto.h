@@ -23,6 +23,8 @@ void set_adjtime_delta(int32_t);
 clock_t get_monotonic(void);
 void set_boottime(time_t);
 time_t get_boottime(void);
+void kclock_write_begin(void);
+void kclock_write_end(void);
 void set_kernel_timer(minix_timer_t *tp, clock_t t, tmr_func_t f, int arg);
 void reset_kernel_timer(minix_timer_t *tp);
 void ser_dump_proc(void);
@@ -42,6 +44,8 @@ void get_cpu_ticks(unsigned int cpu, uint64_t ticks[MINIX_CPUSTATES]);
 int restore_fpu(struct proc *);
 void save_fpu(struct proc *);
 void save_local_fpu(struct proc *, int retain);
+void fpu_state_copyin(struct proc *);
+void fpu_state_copyout(struct proc *);
 void fpu_sigcontext(struct proc *, struct sigframe_sigcontext *fr, struct
 	sigcontext *sc);
 
@@ -53,6 +57,7 @@ void kmain(kinfo_t *cbi);
 void prepare_shutdown(int how);
 __dead void minix_shutdown(int how);
 void bsp_finish_booting(void);
+void boot_event(const char *name);
 
 /* proc.c */
 
@@ -74,6 +79,7 @@ void arch_proc_setcontext(struct proc *rp, struct stackframe_s *state,
 	int user, int restorestyle);
 struct proc * arch_finish_switch_to_user(void);
 struct proc *endpoint_lookup(endpoint_t ep);
+void kendpt_publish(struct proc *rp);
 #if DEBUG_ENABLE_IPC_WARNINGS
 int isokendpt_f(const char *file, int line, endpoint_t e, int *p, int
 	f);
@@ -214,6 +220,11 @@ void do_ser_debug(void);
 int arch_get_params(char *parm, int max);
 void memory_init(void);
 void mem_clear_mapcache(void);
+
+/* ptcache.c */
+int ptcache_lookup(endpoint_t endpt, vir_bytes vir, phys_bytes *phys);
+void ptcache_insert(endpoint_t endpt, vir_bytes vir, phys_bytes phys);
+void ptcache_invalidate(endpoint_t endpt);
 void arch_proc_init(struct proc *pr, u32_t, u32_t, u32_t, char *);
 int arch_do_vmctl(message *m_ptr, struct proc *p);
 int vm_contiguous(const struct proc *targetproc, vir_bytes vir_buf,
@@ -234,6 +245,7 @@ int vm_check_range(struct proc *caller,
 
 int copy_msg_from_user(message * user_mbuf, message * dst);
 int copy_msg_to_user(message * src, message * user_mbuf);
+int copy_msg_status_to_user(message * src, message * user_mbuf);
 void switch_address_space(struct proc * p);
 void release_address_space(struct proc *pr);
 
@@ -0,0 +1,99 @@
+/* This file implements a small cache of virtual-to-physical translations.
+ *
+ * The kernel repeatedly translates the same few virtual addresses for
+ * long-lived objects such as driver DMA buffers and file system cache pages:
+ * every sys_umap() request walks the target process' page tables anew, even
+ * though the underlying mappings rarely change.  This module memoizes the
+ * result of such walks on a per-page basis.
+ *
+ * Staleness is prevented by explicit invalidation.  VM tells the kernel to
+ * drop the translations of a process whenever it overwrites live page table
+ * entries of that process (VMCTL_PTCACHE_INVAL).  In addition, the cache is
+ * flushed whole along with the kernel's own mapping windows
+ * (VMCTL_CLEARMAPCACHE), and the entries of an exiting process are dropped
+ * when its endpoint is cleared.  Newly created mappings need no invalidation:
+ * a page that was not mapped cannot have produced a cache entry.
+ *
+ * All calls are made from kernel call context, which on SMP runs under the
+ * big kernel lock, so no further locking is needed here.
+ */
+
+#include "kernel/kernel.h"
+
+/* The number of cache entries; must be a power of two.  The cache is direct
+ * mapped: each (endpoint, page) pair hashes to exactly one slot.
+ */
+#define PTCACHE_SIZE	64
+
+static struct ptcache_entry {
+  endpoint_t pc_endpt;		/* process the translation belongs to */
+  vir_bytes pc_page;		/* page-aligned virtual address */
+  phys_bytes pc_frame;		/* page-aligned physical address */
+  int pc_valid;			/* is this entry in use? */
+} ptcache[PTCACHE_SIZE];
+
+/*===========================================================================*
+ *				ptcache_slot				     *
+ *===========================================================================*/
+static unsigned int ptcache_slot(endpoint_t endpt, vir_bytes page)
+{
+  return ((page >> CLICK_SHIFT) ^ (unsigned int) endpt) & (PTCACHE_SIZE - 1);
+}
+
+/*===========================================================================*
+ *				ptcache_lookup				     *
+ *===========================================================================*/
+int ptcache_lookup(endpoint_t endpt, vir_bytes vir, phys_bytes *phys)
+{
+/* Look up a cached translation for the given virtual address in the given
+ * process.  Return TRUE with the physical address stored in 'phys' on a hit,
+ * or FALSE on a miss.
+ */
+  struct ptcache_entry *pcp;
+  vir_bytes page;
+
+  page = vir & ~(vir_bytes) (CLICK_SIZE - 1);
+
+  pcp = &ptcache[ptcache_slot(endpt, page)];
+
+  if (!pcp->pc_valid || pcp->pc_endpt != endpt || pcp->pc_page != page)
+	return FALSE;
+
+  *phys = pcp->pc_frame + (vir - page);
+  return TRUE;
+}
+
+/*===========================================================================*
+ *				ptcache_insert				     *
+ *===========================================================================*/
+void ptcache_insert(endpoint_t endpt, vir_bytes vir, phys_bytes phys)
+{
+/* Remember the given translation, evicting whatever occupied its slot. */
+  struct ptcache_entry *pcp;
+  vir_bytes page;
+
+  page = vir & ~(vir_bytes) (CLICK_SIZE - 1);
+
+  pcp = &ptcache[ptcache_slot(endpt, page)];
+
+  pcp->pc_endpt = endpt;
+  pcp->pc_page = page;
+  pcp->pc_frame = phys - (vir - page);
+  pcp->pc_valid = TRUE;
+}
+
+/*===========================================================================*
+ *				ptcache_invalidate			     *
+ *===========================================================================*/
+void ptcache_invalidate(endpoint_t endpt)
+{
+/* Drop all cached translations for the given process, or for all processes
+ * if NONE is given.
+ */
+  int i;
+
+  for (i = 0; i < PTCACHE_SIZE; i++) {
+	if (endpt == NONE || ptcache[i].pc_endpt == endpt)
+		ptcache[i].pc_valid = FALSE;
+  }
+}
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <string.h>
 
 #include "smp.h"
 #include "interrupt.h"
@@ -27,6 +28,79 @@ static volatile unsigned ap_cpus_booted;
 SPINLOCK_DEFINE(big_kernel_lock)
 SPINLOCK_DEFINE(boot_lock)
 
+int lock_stats_enabled;	/* set through DIAGCTL_CODE_LOCKSTATS */
+
+/* The named locks covered by the contention statistics. Arch-private locks
+ * can be added here once they are exported by their headers.
+ */
+static spinlock_t * const lock_stat_locks[] = {
+	&big_kernel_lock,
+	&boot_lock,
+};
+
+#define NR_LOCK_STAT_LOCKS \
+	(sizeof(lock_stat_locks) / sizeof(lock_stat_locks[0]))
+
+#if CONFIG_MAX_CPUS > 1
+void spinlock_lock_stats(spinlock_t * sl)
+{
+	u64_t before, after;
+
+	read_tsc_64(&before);
+	arch_spinlock_lock(&sl->val);
+	read_tsc_64(&after);
+
+	/* Holding the lock serializes updates of its own statistics. */
+	sl->sl_acquisitions++;
+	sl->sl_spin_cycles += after - before;
+	sl->sl_acquired_tsc = after;
+}
+
+void spinlock_unlock_stats(spinlock_t * sl)
+{
+	u64_t now;
+
+	/* The acquisition may predate enabling the statistics, in which
+	 * case there is no timestamp to charge the hold time against.
+	 */
+	read_tsc_64(&now);
+	if (sl->sl_acquired_tsc != 0)
+		sl->sl_hold_cycles += now - sl->sl_acquired_tsc;
+	sl->sl_acquired_tsc = 0;
+	arch_spinlock_unlock(&sl->val);
+}
+#endif /* CONFIG_MAX_CPUS > 1 */
+
+int lock_stats_snapshot(struct lock_stat * buf, int max)
+{
+	int i;
+	spinlock_t *sl;
+
+	for (i = 0; i < max && i < (int) NR_LOCK_STAT_LOCKS; i++) {
+		sl = lock_stat_locks[i];
+		strncpy(buf[i].ls_name, sl->sl_name ? sl->sl_name : "",
+			sizeof(buf[i].ls_name) - 1);
+		buf[i].ls_name[sizeof(buf[i].ls_name) - 1] = '\0';
+		buf[i].ls_acquisitions = sl->sl_acquisitions;
+		buf[i].ls_spin_cycles = sl->sl_spin_cycles;
+		buf[i].ls_hold_cycles = sl->sl_hold_cycles;
+	}
+
+	return i;
+}
+
+void lock_stats_reset(void)
+{
+	unsigned i;
+
+	for (i = 0; i < NR_LOCK_STAT_LOCKS; i++) {
+		lock_stat_locks[i]->sl_acquisitions = 0;
+		lock_stat_locks[i]->sl_spin_cycles = 0;
+		lock_stat_locks[i]->sl_hold_cycles = 0;
+		lock_stat_locks[i]->sl_acquired_tsc = 0;
+	}
+}
+
 void wait_for_APs_to_finish_booting(void)
 {
 	unsigned n = 0;
@@ -4,7 +4,19 @@
 #include "kernel/kernel.h"
 
 typedef struct spinlock {
-	atomic_t val;
+	atomic_t val;		/* ticket lock word: next free ticket in the
+				 * high 16 bits, now-serving number in the
+				 * low 16 bits; equal halves mean the lock
+				 * is free. Must stay first, see arch_clock.c.
+				 */
+#ifdef CONFIG_SMP
+	/* contention statistics, maintained while lock_stats_enabled */
+	const char *sl_name;	/* lock name for reporting */
+	u64_t sl_acquisitions;	/* times the lock was taken */
+	u64_t sl_spin_cycles;	/* cycles spent spinning for it */
+	u64_t sl_hold_cycles;	/* cycles it was held */
+	u64_t sl_acquired_tsc;	/* tsc at which the holder took it */
+#endif
 } spinlock_t;
 
 #ifndef CONFIG_SMP
@@ -19,9 +31,9 @@ typedef struct spinlock {
 #else
 
 /* SMP */
-#define SPINLOCK_DEFINE(name)	spinlock_t name;
+#define SPINLOCK_DEFINE(name)	spinlock_t name = { .sl_name = #name };
 #define PRIVATE_SPINLOCK_DEFINE(name)	PRIVATE SPINLOCK_DEFINE(name)
-#define SPINLOCK_DECLARE(name)	extern SPINLOCK_DEFINE(name)
+#define SPINLOCK_DECLARE(name)	extern spinlock_t name;
 #define spinlock_init(sl) do { (sl)->val = 0; } while (0)
 
 #if CONFIG_MAX_CPUS == 1
@@ -30,8 +42,29 @@ typedef struct spinlock {
 #else
 void arch_spinlock_lock(atomic_t * sl);
 void arch_spinlock_unlock(atomic_t * sl);
-#define spinlock_lock(sl)	arch_spinlock_lock((atomic_t*) sl)
-#define spinlock_unlock(sl)	arch_spinlock_unlock((atomic_t*) sl)
+
+/* Lock contention statistics. Always compiled in, collected only while
+ * enabled through DIAGCTL_CODE_LOCKSTATS so the fast path stays a single
+ * test when they are off.
+ */
+extern int lock_stats_enabled;	/* defined in smp.c */
+void spinlock_lock_stats(spinlock_t * sl);
+void spinlock_unlock_stats(spinlock_t * sl);
+int lock_stats_snapshot(struct lock_stat * buf, int max);
+void lock_stats_reset(void);
+
+#define spinlock_lock(sl) do {					\
+	if (lock_stats_enabled)					\
+		spinlock_lock_stats(sl);			\
+	else							\
+		arch_spinlock_lock(&(sl)->val);			\
+} while (0)
+#define spinlock_unlock(sl) do {				\
+	if (lock_stats_enabled)					\
+		spinlock_unlock_stats(sl);			\
+	else							\
+		arch_spinlock_unlock(&(sl)->val);		\
+} while (0)
 #endif
 
 
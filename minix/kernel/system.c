@@ -56,6 +56,17 @@ static int (*call_vec[NR_SYS_CALLS])(struct proc * caller, message *m_ptr);
     	assert(call_index >= 0 && call_index < NR_SYS_CALLS);			\
     call_vec[call_index] = (handler)  ; }
 
+/* Bitmap of kernel calls that reply with a bare status code. The handlers
+ * of these calls never write to the request message, so only the header of
+ * the reply message has to be copied back to the caller.
+ */
+static bitchunk_t call_statusonly[BITMAP_CHUNKS(NR_SYS_CALLS)];
+
+#define map_statusonly(call_nr) 				\
+    {	int call_index = call_nr-KERNEL_CALL; 				\
+    	assert(call_index >= 0 && call_index < NR_SYS_CALLS);			\
+    SET_BIT(call_statusonly, call_index)  ; }
+
 static void kernel_call_finish(struct proc * caller, message *msg, int result)
 {
   if(result == VMSUSPEND) {
@@ -74,13 +85,28 @@ static void kernel_call_finish(struct proc * caller, message *msg, int result)
 	   */
 	  caller->p_vmrequest.saved.reqmsg.m_source = NONE;
 	  if (result != EDONTREPLY) {
+		  int call_nr, failed;
+
+		  call_nr = msg->m_type - KERNEL_CALL;
+
 		  /* copy the result as a message to the original user buffer */
 		  msg->m_source = SYSTEM;
 		  msg->m_type = result;		/* report status of call */
 #if DEBUG_IPC_HOOK
 	hook_ipc_msgkresult(msg, caller);
 #endif
-		  if (copy_msg_to_user(msg, (message *)caller->p_delivermsg_vir)) {
+		  if (call_nr >= 0 && call_nr < NR_SYS_CALLS &&
+				  GET_BIT(call_statusonly, call_nr)) {
+			  /* the handler did not write a reply payload, so
+			   * only the message header has to reach the caller
+			   */
+			  failed = copy_msg_status_to_user(msg,
+				  (message *)caller->p_delivermsg_vir);
+		  } else {
+			  failed = copy_msg_to_user(msg,
+				  (message *)caller->p_delivermsg_vir);
+		  }
+		  if (failed) {
 			  printf("WARNING wrong user pointer 0x%08x from "
 					  "process %s / %d\n",
 					  caller->p_delivermsg_vir,
@@ -267,6 +293,16 @@ void system_init(void)
   map(SYS_SCHEDULE, do_schedule);	/* reschedule a process */
   map(SYS_SCHEDCTL, do_schedctl);	/* change process scheduler */
 
+  /* Status-only replies. Only calls whose handlers are known never to
+   * write to the request message may be listed here.
+   */
+  map_statusonly(SYS_MEMSET);
+  map_statusonly(SYS_VIRCOPY);
+  map_statusonly(SYS_PHYSCOPY);
+  map_statusonly(SYS_SAFECOPYFROM);
+  map_statusonly(SYS_SAFECOPYTO);
+  map_statusonly(SYS_VSAFECOPY);
+  map_statusonly(SYS_SAFEMEMSET);
 }
 /*===========================================================================*
  *				get_priv				     *
@@ -547,6 +583,9 @@ void clear_endpoint(struct proc * rc)
   hook_ipc_clear(rc);
 #endif
 
+  /* The cached address translations of the process are now meaningless. */
+  ptcache_invalidate(rc->p_endpoint);
+
   /* Make sure that the exiting process is no longer scheduled. */
   RTS_SET(rc, RTS_NO_ENDPOINT);
   if (priv(rc)->s_flags & SYS_PROC)
@@ -699,6 +738,48 @@ int sched_proc(struct proc *p, int priority, int quantum, int cpu, int niced)
 	return OK;
 }
 
+/*===========================================================================*
+ *				compile_ipc_filter			     *
+ *===========================================================================*/
+static void compile_ipc_filter(ipc_filter_t *ipcf)
+{
+/* Order the filter elements so that evaluation does not have to visit every
+ * one of them for each delivery attempt.  Elements that match on the message
+ * type are moved to the front and sorted by type, allowing
+ * allow_ipc_filtered_msg() to binary search them; the source-only elements
+ * end up behind them and are still scanned linearly.  Reordering is safe
+ * because any matching element yields the same verdict for a given filter,
+ * so the outcome does not depend on element order.
+ */
+  ipc_filter_el_t tmp;
+  int i, j, num_elements, num_sorted;
+
+  num_elements = ipcf->num_elements;
+
+  /* Partition: elements matching on m_type first. */
+  num_sorted = 0;
+  for (i = 0; i < num_elements; i++) {
+	if (ipcf->elements[i].flags & IPCF_MATCH_M_TYPE) {
+		tmp = ipcf->elements[i];
+		ipcf->elements[i] = ipcf->elements[num_sorted];
+		ipcf->elements[num_sorted] = tmp;
+		num_sorted++;
+	}
+  }
+
+  /* Insertion-sort the prefix by message type.  Filters are small and
+   * installed only at (re)start time, so simplicity wins here.
+   */
+  for (i = 1; i < num_sorted; i++) {
+	tmp = ipcf->elements[i];
+	for (j = i; j > 0 && ipcf->elements[j - 1].m_type > tmp.m_type; j--)
+		ipcf->elements[j] = ipcf->elements[j - 1];
+	ipcf->elements[j] = tmp;
+  }
+
+  ipcf->num_sorted = num_sorted;
+}
+
 /*===========================================================================*
  *				add_ipc_filter				     *
  *===========================================================================*/
@@ -736,6 +817,9 @@ int add_ipc_filter(struct proc *rp, int type, vir_bytes address,
 		return r;
 	}
 
+	/* Order the elements for fast evaluation. */
+	compile_ipc_filter(ipcf);
+
 	/* Add the new filter at the end of the IPC filter chain. */
 	for (ipcfp = &priv(rp)->s_ipcf; *ipcfp != NULL;
 	    ipcfp = &(*ipcfp)->next)
@@ -797,15 +881,58 @@ int check_ipc_filter(ipc_filter_t *ipcf, int fill_flags)
 	return OK;
 }
 
+/*===========================================================================*
+ *				ipcf_match				     *
+ *===========================================================================*/
+static int ipcf_match(ipc_filter_t *ipcf, message *m_src_p)
+{
+/* Return TRUE iff any element of the given filter matches the message,
+ * using the layout prepared by compile_ipc_filter(): the m_type-sorted
+ * prefix is binary searched, the source-only tail is scanned linearly.
+ */
+  ipc_filter_el_t *ipcf_el;
+  int lo, hi, mid, i, m_type, num_elements;
+
+  /* Find the first sorted element carrying the message's type, then walk
+   * the run of elements with that type checking their source constraint.
+   * The type constraint itself holds by construction.
+   */
+  m_type = m_src_p->m_type;
+  lo = 0;
+  hi = ipcf->num_sorted;
+  while (lo < hi) {
+	mid = lo + (hi - lo) / 2;
+	if (ipcf->elements[mid].m_type < m_type)
+		lo = mid + 1;
+	else
+		hi = mid;
+  }
+  for (i = lo; i < ipcf->num_sorted && ipcf->elements[i].m_type == m_type;
+      i++) {
+	ipcf_el = &ipcf->elements[i];
+	if (IPCF_EL_MATCH_M_SOURCE(ipcf_el, m_src_p))
+		return TRUE;
+  }
+
+  /* Check the remaining source-only elements. */
+  num_elements = ipcf->num_elements;
+  for (i = ipcf->num_sorted; i < num_elements; i++) {
+	ipcf_el = &ipcf->elements[i];
+	if (IPCF_EL_MATCH(ipcf_el, m_src_p))
+		return TRUE;
+  }
+
+  return FALSE;
+}
+
 /*===========================================================================*
  *				allow_ipc_filtered_msg			     *
  *===========================================================================*/
 int allow_ipc_filtered_msg(struct proc *rp, endpoint_t src_e,
 	vir_bytes m_src_v, message *m_src_p)
 {
-	int i, r, num_elements, get_mtype, allow;
+	int r, get_mtype, allow;
 	ipc_filter_t *ipcf;
-	ipc_filter_el_t *ipcf_el;
 	message m_buff;
 
 	ipcf = priv(rp)->s_ipcf;
@@ -853,14 +980,8 @@ int allow_ipc_filtered_msg(struct proc *rp, endpoint_t src_e,
 	allow = (ipcf->type == IPCF_BLACKLIST);
 	do {
 		if (allow != (ipcf->type == IPCF_WHITELIST)) {
-			num_elements = ipcf->num_elements;
-			for (i = 0; i < num_elements; i++) {
-				ipcf_el = &ipcf->elements[i];
-				if (IPCF_EL_MATCH(ipcf_el, m_src_p)) {
-					allow = (ipcf->type == IPCF_WHITELIST);
-					break;
-				}
-			}
+			if (ipcf_match(ipcf, m_src_p))
+				allow = (ipcf->type == IPCF_WHITELIST);
 		}
 		ipcf = ipcf->next;
 	} while (ipcf);
@@ -55,6 +55,7 @@ int do_clear(struct proc * caller, message * m_ptr)
    * and mark slot as FREE. Also mark saved fpu contents as not significant.
    */
   RTS_SETFLAGS(rc, RTS_SLOT_FREE);
+  kendpt_publish(rc);		/* mark slot free in the endpoint table */
   
   /* release FPU */
   release_fpu(rc);
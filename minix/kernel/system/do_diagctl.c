@@ -60,6 +60,31 @@ int do_diagctl(struct proc * caller, message * m_ptr)
 		return EPERM;
 	priv(caller)->s_diag_sig = FALSE;
 	return OK;
+    case DIAGCTL_CODE_IPCTRACE:
+	if (!(priv(caller)->s_flags & SYS_PROC))
+		return EPERM;
+	/* Start each trace run with empty rings, so that extracted entries
+	 * are always from the current run.
+	 */
+	if (m_ptr->m_lsys_krn_sys_diagctl.endpt && !ipc_trace_enabled)
+		memset(ipc_trace_ring, 0, sizeof(struct ipc_trace_ring) *
+			CONFIG_MAX_CPUS);
+	ipc_trace_enabled = !!m_ptr->m_lsys_krn_sys_diagctl.endpt;
+	return OK;
+    case DIAGCTL_CODE_LOCKSTATS:
+	if (!(priv(caller)->s_flags & SYS_PROC))
+		return EPERM;
+#if defined(CONFIG_SMP) && CONFIG_MAX_CPUS > 1
+	/* Start each measuring run with clean counters, so that extracted
+	 * statistics are always from the current run.
+	 */
+	if (m_ptr->m_lsys_krn_sys_diagctl.endpt && !lock_stats_enabled)
+		lock_stats_reset();
+	lock_stats_enabled = !!m_ptr->m_lsys_krn_sys_diagctl.endpt;
+	return OK;
+#else
+	return ENOTSUP;
+#endif
     default:
 	printf("do_diagctl: invalid request %d\n", m_ptr->m_lsys_krn_sys_diagctl.code);
         return(EINVAL);
@@ -26,6 +26,10 @@
 #include <minix/u64.h>
 #include <sys/resource.h>
 
+#ifdef USE_WATCHDOG
+#include "kernel/watchdog.h"
+#endif
+
 /*===========================================================================*
  *			        update_idle_time			     *
  *===========================================================================*/
@@ -181,6 +185,32 @@ int do_getinfo(struct proc * caller, message * m_ptr)
         src_vir = (vir_bytes) irq_actids;
         break;
     }
+    case GET_IRQSTATS: {
+        length = sizeof(irq_stats);
+        src_vir = (vir_bytes) irq_stats;
+        break;
+    }
+    case GET_LOCKSTATS: {
+#if defined(CONFIG_SMP) && CONFIG_MAX_CPUS > 1
+	static struct lock_stat lstats[NR_LOCK_STATS];
+	length = sizeof(struct lock_stat) *
+		lock_stats_snapshot(lstats, NR_LOCK_STATS);
+	src_vir = (vir_bytes) lstats;
+	break;
+#else
+	return ENOTSUP;
+#endif
+    }
+    case GET_BOOTEVENTS: {
+	length = sizeof(boot_events);
+	src_vir = (vir_bytes) boot_events;
+	break;
+    }
+    case GET_SAFECOPYSTATS: {
+	length = sizeof(safecopy_stats);
+	src_vir = (vir_bytes) safecopy_stats;
+	break;
+    }
     case GET_IDLETSC: {
 	struct proc * idl;
 	update_idle_time();
@@ -200,6 +230,28 @@ int do_getinfo(struct proc * caller, message * m_ptr)
 	src_vir = (vir_bytes)ticks;
 	break;
     }
+    case GET_STALLPROF: {
+#ifdef USE_WATCHDOG
+	unsigned int cpu;
+	cpu = (unsigned int)m_ptr->m_lsys_krn_sys_getinfo.val_len2_e;
+	if (cpu >= CONFIG_MAX_CPUS)
+		return EINVAL;
+	length = sizeof(struct stall_prof_ring);
+	src_vir = (vir_bytes) &stall_prof_ring[cpu];
+	break;
+#else
+	return ENOTSUP;
+#endif
+    }
+    case GET_IPCTRACE: {
+	unsigned int cpu;
+	cpu = (unsigned int)m_ptr->m_lsys_krn_sys_getinfo.val_len2_e;
+	if (cpu >= CONFIG_MAX_CPUS)
+		return EINVAL;
+	length = sizeof(struct ipc_trace_ring);
+	src_vir = (vir_bytes) &ipc_trace_ring[cpu];
+	break;
+    }
     default:
 	printf("do_getinfo: invalid request %d\n",
 		m_ptr->m_lsys_krn_sys_getinfo.request);
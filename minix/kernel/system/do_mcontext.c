@@ -50,6 +50,7 @@ int do_getmcontext(struct proc * caller, message * m_ptr)
   if (proc_used_fpu(rp)) {
 	/* make sure that the FPU context is saved into proc structure first */
 	save_fpu(rp);
+	fpu_state_copyout(rp);
 	mc.mc_flags = (rp->p_misc_flags & MF_FPU_INITIALIZED) ? _MC_FPU_SAVED : 0;
 	assert(sizeof(mc.__fpregs.__fp_reg_set) == FPU_XFP_SIZE);
 	memcpy(&(mc.__fpregs.__fp_reg_set), rp->p_seg.fpu_state, FPU_XFP_SIZE);
@@ -94,6 +95,7 @@ int do_setmcontext(struct proc * caller, message * m_ptr)
 	rp->p_misc_flags |= MF_FPU_INITIALIZED;
 	assert(sizeof(mc.__fpregs.__fp_reg_set) == FPU_XFP_SIZE);
 	memcpy(rp->p_seg.fpu_state, &(mc.__fpregs.__fp_reg_set), FPU_XFP_SIZE);
+	fpu_state_copyin(rp);
   } else
 	rp->p_misc_flags &= ~MF_FPU_INITIALIZED;
   /* force reloading FPU in either case */
@@ -284,6 +284,8 @@ static int safecopy(
 	static struct vir_addr v_src, v_dst;
 	static vir_bytes v_offset;
 	endpoint_t new_granter, *src, *dst;
+	unsigned int sizeclass;
+	size_t limit;
 	int r;
 	struct cp_sfinfo sfinfo;
 
@@ -316,6 +318,16 @@ static int safecopy(
 	 */
 	granter = new_granter;
 
+	/* Account the copy in the size class statistics. */
+	sizeclass = 0;
+	limit = 1024;
+	while(sizeclass < NR_SAFECOPY_CLASSES - 1 && bytes >= limit) {
+		sizeclass++;
+		limit <<= 3;
+	}
+	safecopy_stats[sizeclass].ss_calls++;
+	safecopy_stats[sizeclass].ss_bytes += bytes;
+
 	/* Now it's a regular copy. */
 	v_src.proc_nr_e = *src;
 	v_dst.proc_nr_e = *dst;
@@ -42,9 +42,14 @@ int do_settime(struct proc * caller, message * m_ptr)
   /* prevent a negative value for realtime */
   if (m_ptr->m_lsys_krn_sys_settime.sec <= boottime ||
       timediff_ticks < LONG_MIN/2 || timediff_ticks > LONG_MAX/2) {
-  	/* boottime was likely wrong, try to correct it. */
+  	/* boottime was likely wrong, try to correct it. Both fields change,
+	 * so keep userland readers of the clock fields from combining the
+	 * old value of one with the new value of the other.
+	 */
+	kclock_write_begin();
 	set_boottime(m_ptr->m_lsys_krn_sys_settime.sec);
 	set_realtime(1);
+	kclock_write_end();
 	return(OK);
   }
 
@@ -86,6 +86,7 @@ int do_sigreturn(struct proc * caller, message * m_ptr)
   if (sc.sc_flags & MF_FPU_INITIALIZED)
   {
 	memcpy(rp->p_seg.fpu_state, &sc.sc_fpu_state, FPU_XFP_SIZE);
+	fpu_state_copyin(rp);
 	rp->p_misc_flags |=  MF_FPU_INITIALIZED; /* Restore math usage flag. */
 	/* force reloading FPU */
 	release_fpu(rp);
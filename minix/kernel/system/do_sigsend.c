@@ -3,8 +3,16 @@
  *
  * The parameters for this kernel call are:
  * 	m_sigcalls.endpt	# process to call signal handler
- *	m_sigcalls.sigctx	# pointer to sigcontext structure
+ *	m_sigcalls.sigctx	# pointer to sigcontext structure(s)
+ *	m_sigcalls.count	# number of structures (0 means 1)
  *
+ * When more than one sigmsg structure is passed in, a signal handler frame is
+ * set up for each of them, stacked in array order: the frame for the last
+ * structure ends up on top, so its handler runs first, and each sigreturn(2)
+ * then transfers control to the handler of the preceding frame, until the
+ * first frame restores the original process context. This is exactly the
+ * state that repeated single-frame calls would build up, but it allows the
+ * signal manager to deliver a burst of pending signals with one kernel call.
  */
 
 #include "kernel/system.h"
@@ -23,116 +31,161 @@ int do_sigsend(struct proc * caller, message * m_ptr)
   struct sigmsg smsg;
   register struct proc *rp;
   struct sigframe_sigcontext fr, *frp;
-  int proc_nr, r;
+  int proc_nr, r, i, count;
+  reg_t new_sp, new_pc;		/* process context as of the last frame */
 #if defined(__i386__)
   reg_t new_fp;
+#elif defined(__arm__)
+  reg_t new_lr, new_r0, new_r1, new_r2;
 #endif
 
   if (!isokendpt(m_ptr->m_sigcalls.endpt, &proc_nr)) return EINVAL;
   if (iskerneln(proc_nr)) return EPERM;
   rp = proc_addr(proc_nr);
 
-  /* Get the sigmsg structure into our address space.  */
-  if ((r = data_copy_vmcheck(caller, caller->p_endpoint,
-		(vir_bytes)m_ptr->m_sigcalls.sigctx, KERNEL,
-		(vir_bytes)&smsg, (phys_bytes) sizeof(struct sigmsg))) != OK)
-	return r;
+  /* Old callers do not initialize the count field; treat zero as one. */
+  count = m_ptr->m_sigcalls.count;
+  if (count <= 0) count = 1;
+  if (count >= _NSIG) return EINVAL;
 
   /* WARNING: the following code may be run more than once even for a single
-   * signal delivery. Do not change registers here. See the comment below.
+   * call, and each frame may be attempted more than once. Do not change
+   * registers here; track the context in local variables instead, so that
+   * every (re)run derives the exact same frame contents. See the comment
+   * below.
    */
+  new_sp = arch_get_sp(rp);
+  new_pc = rp->p_reg.pc;
+#if defined(__i386__)
+  new_fp = rp->p_reg.fp;
+#elif defined(__arm__)
+  new_lr = rp->p_reg.lr;
+  new_r0 = rp->p_reg.retreg;
+  new_r1 = rp->p_reg.r1;
+  new_r2 = rp->p_reg.r2;
+#endif
 
-  /* Compute the user stack pointer where sigframe will start. */
-  smsg.sm_stkptr = arch_get_sp(rp);
-  frp = (struct sigframe_sigcontext *) smsg.sm_stkptr - 1;
-
-  /* Copy the registers to the sigcontext structure. */
-  memset(&fr, 0, sizeof(fr));
-  fr.sf_scp = &frp->sf_sc;
+  for (i = 0; i < count; i++) {
+	/* Get the next sigmsg structure into our address space. */
+	if ((r = data_copy_vmcheck(caller, caller->p_endpoint,
+			(vir_bytes)m_ptr->m_sigcalls.sigctx +
+			i * sizeof(struct sigmsg), KERNEL,
+			(vir_bytes)&smsg, (phys_bytes) sizeof(struct sigmsg))) != OK)
+		return r;
+
+	/* Compute the user stack pointer where sigframe will start. */
+	smsg.sm_stkptr = new_sp;
+	frp = (struct sigframe_sigcontext *) smsg.sm_stkptr - 1;
+
+	/* Copy the registers to the sigcontext structure. The first frame
+	 * saves the current process context; later frames save the entry
+	 * context of the previously set up handler.
+	 */
+	memset(&fr, 0, sizeof(fr));
+	fr.sf_scp = &frp->sf_sc;
 
 #if defined(__i386__)
-  fr.sf_sc.sc_gs = rp->p_reg.gs;
-  fr.sf_sc.sc_fs = rp->p_reg.fs;
-  fr.sf_sc.sc_es = rp->p_reg.es;
-  fr.sf_sc.sc_ds = rp->p_reg.ds;
-  fr.sf_sc.sc_edi = rp->p_reg.di;
-  fr.sf_sc.sc_esi = rp->p_reg.si;
-  fr.sf_sc.sc_ebp = rp->p_reg.fp;
-  fr.sf_sc.sc_ebx = rp->p_reg.bx;
-  fr.sf_sc.sc_edx = rp->p_reg.dx;
-  fr.sf_sc.sc_ecx = rp->p_reg.cx;
-  fr.sf_sc.sc_eax = rp->p_reg.retreg;
-  fr.sf_sc.sc_eip = rp->p_reg.pc;
-  fr.sf_sc.sc_cs = rp->p_reg.cs;
-  fr.sf_sc.sc_eflags = rp->p_reg.psw;
-  fr.sf_sc.sc_esp = rp->p_reg.sp;
-  fr.sf_sc.sc_ss = rp->p_reg.ss;
-  fr.sf_fp = rp->p_reg.fp;
-  fr.sf_signum = smsg.sm_signo;
-  new_fp = (reg_t) &frp->sf_fp;
-  fr.sf_scpcopy = fr.sf_scp;
-  fr.sf_ra_sigreturn = smsg.sm_sigreturn;
-  fr.sf_ra= rp->p_reg.pc;
-
-  fr.sf_sc.trap_style = rp->p_seg.p_kern_trap_style;
-
-  if (fr.sf_sc.trap_style == KTS_NONE) {
-  	printf("do_sigsend: sigsend an unsaved process\n");
-	return EINVAL;
-  }
-
-  if (proc_used_fpu(rp)) {
-	/* save the FPU context before saving it to the sig context */
-	save_fpu(rp);
-	memcpy(&fr.sf_sc.sc_fpu_state, rp->p_seg.fpu_state, FPU_XFP_SIZE);
-  }
+	fr.sf_sc.sc_gs = rp->p_reg.gs;
+	fr.sf_sc.sc_fs = rp->p_reg.fs;
+	fr.sf_sc.sc_es = rp->p_reg.es;
+	fr.sf_sc.sc_ds = rp->p_reg.ds;
+	fr.sf_sc.sc_edi = rp->p_reg.di;
+	fr.sf_sc.sc_esi = rp->p_reg.si;
+	fr.sf_sc.sc_ebp = new_fp;
+	fr.sf_sc.sc_ebx = rp->p_reg.bx;
+	fr.sf_sc.sc_edx = rp->p_reg.dx;
+	fr.sf_sc.sc_ecx = rp->p_reg.cx;
+	fr.sf_sc.sc_eax = rp->p_reg.retreg;
+	fr.sf_sc.sc_eip = new_pc;
+	fr.sf_sc.sc_cs = rp->p_reg.cs;
+	fr.sf_sc.sc_eflags = rp->p_reg.psw;
+	fr.sf_sc.sc_esp = new_sp;
+	fr.sf_sc.sc_ss = rp->p_reg.ss;
+	fr.sf_fp = new_fp;
+	fr.sf_signum = smsg.sm_signo;
+	fr.sf_scpcopy = fr.sf_scp;
+	fr.sf_ra_sigreturn = smsg.sm_sigreturn;
+	fr.sf_ra = new_pc;
+
+	fr.sf_sc.trap_style = rp->p_seg.p_kern_trap_style;
+
+	if (fr.sf_sc.trap_style == KTS_NONE) {
+		printf("do_sigsend: sigsend an unsaved process\n");
+		return EINVAL;
+	}
+
+	if (i == 0 && proc_used_fpu(rp)) {
+		/* save the FPU context before saving it to the sig context */
+		save_fpu(rp);
+		fpu_state_copyout(rp);
+		memcpy(&fr.sf_sc.sc_fpu_state, rp->p_seg.fpu_state,
+			FPU_XFP_SIZE);
+	}
 #endif
 
 #if defined(__arm__)
-  fr.sf_sc.sc_spsr = rp->p_reg.psr;
-  fr.sf_sc.sc_r0 = rp->p_reg.retreg;
-  fr.sf_sc.sc_r1 = rp->p_reg.r1;
-  fr.sf_sc.sc_r2 = rp->p_reg.r2;
-  fr.sf_sc.sc_r3 = rp->p_reg.r3;
-  fr.sf_sc.sc_r4 = rp->p_reg.r4;
-  fr.sf_sc.sc_r5 = rp->p_reg.r5;
-  fr.sf_sc.sc_r6 = rp->p_reg.r6;
-  fr.sf_sc.sc_r7 = rp->p_reg.r7;
-  fr.sf_sc.sc_r8 = rp->p_reg.r8;
-  fr.sf_sc.sc_r9 = rp->p_reg.r9;
-  fr.sf_sc.sc_r10 = rp->p_reg.r10;
-  fr.sf_sc.sc_r11 = rp->p_reg.fp;
-  fr.sf_sc.sc_r12 = rp->p_reg.r12;
-  fr.sf_sc.sc_usr_sp = rp->p_reg.sp;
-  fr.sf_sc.sc_usr_lr = rp->p_reg.lr;
-  fr.sf_sc.sc_svc_lr = 0;	/* ? */
-  fr.sf_sc.sc_pc = rp->p_reg.pc;	/* R15 */
+	fr.sf_sc.sc_spsr = rp->p_reg.psr;
+	fr.sf_sc.sc_r0 = new_r0;
+	fr.sf_sc.sc_r1 = new_r1;
+	fr.sf_sc.sc_r2 = new_r2;
+	fr.sf_sc.sc_r3 = rp->p_reg.r3;
+	fr.sf_sc.sc_r4 = rp->p_reg.r4;
+	fr.sf_sc.sc_r5 = rp->p_reg.r5;
+	fr.sf_sc.sc_r6 = rp->p_reg.r6;
+	fr.sf_sc.sc_r7 = rp->p_reg.r7;
+	fr.sf_sc.sc_r8 = rp->p_reg.r8;
+	fr.sf_sc.sc_r9 = rp->p_reg.r9;
+	fr.sf_sc.sc_r10 = rp->p_reg.r10;
+	fr.sf_sc.sc_r11 = rp->p_reg.fp;
+	fr.sf_sc.sc_r12 = rp->p_reg.r12;
+	fr.sf_sc.sc_usr_sp = new_sp;
+	fr.sf_sc.sc_usr_lr = new_lr;
+	fr.sf_sc.sc_svc_lr = 0;	/* ? */
+	fr.sf_sc.sc_pc = new_pc;	/* R15 */
 #endif
 
-  /* Finish the sigcontext initialization. */
-  fr.sf_sc.sc_mask = smsg.sm_mask;
-  fr.sf_sc.sc_flags = rp->p_misc_flags & MF_FPU_INITIALIZED;
-  fr.sf_sc.sc_magic = SC_MAGIC;
-
-  /* Initialize the sigframe structure. */
-  fpu_sigcontext(rp, &fr, &fr.sf_sc);
-
-  /* Copy the sigframe structure to the user's stack. */
-  if ((r = data_copy_vmcheck(caller, KERNEL, (vir_bytes)&fr,
-		m_ptr->m_sigcalls.endpt, (vir_bytes)frp,
-		(vir_bytes)sizeof(struct sigframe_sigcontext))) != OK)
-      return r;
+	/* Finish the sigcontext initialization. A handler's entry context
+	 * starts out with a clean FPU.
+	 */
+	fr.sf_sc.sc_mask = smsg.sm_mask;
+	fr.sf_sc.sc_flags = (i == 0) ?
+		(rp->p_misc_flags & MF_FPU_INITIALIZED) : 0;
+	fr.sf_sc.sc_magic = SC_MAGIC;
+
+	/* Initialize the sigframe structure. */
+	fpu_sigcontext(rp, &fr, &fr.sf_sc);
+
+	/* Copy the sigframe structure to the user's stack. */
+	if ((r = data_copy_vmcheck(caller, KERNEL, (vir_bytes)&fr,
+			m_ptr->m_sigcalls.endpt, (vir_bytes)frp,
+			(vir_bytes)sizeof(struct sigframe_sigcontext))) != OK)
+		return r;
+
+	/* Advance the tracked context to the entry point of this frame's
+	 * handler, for the next frame and for the final register update.
+	 */
+	new_sp = (reg_t) frp;
+	new_pc = (reg_t) smsg.sm_sighandler;
+#if defined(__i386__)
+	new_fp = (reg_t) &frp->sf_fp;
+#elif defined(__arm__)
+	new_lr = (reg_t) smsg.sm_sigreturn;
+	new_r0 = (reg_t) smsg.sm_signo;
+	new_r1 = 0;	/* sf_code */
+	new_r2 = (reg_t) fr.sf_scp;
+#endif
+  }
 
   /* WARNING: up to the statement above, the code may run multiple times, since
-   * copying out the frame/context may fail with VMSUSPEND the first time. For
+   * copying out a frame/context may fail with VMSUSPEND the first time. For
    * that reason, changes to process registers *MUST* be deferred until after
    * this last copy -- otherwise, these changes will be made several times,
    * possibly leading to corrupted process state.
    */
 
-  /* Reset user registers to execute the signal handler. */
-  rp->p_reg.sp = (reg_t) frp;
-  rp->p_reg.pc = (reg_t) smsg.sm_sighandler;
+  /* Reset user registers to execute the topmost signal handler. */
+  rp->p_reg.sp = new_sp;
+  rp->p_reg.pc = new_pc;
 
 #if defined(__i386__)
   rp->p_reg.fp = new_fp;
@@ -140,13 +193,13 @@ int do_sigsend(struct proc * caller, message * m_ptr)
   /* use the ARM link register to set the return address from the signal
    * handler
    */
-  rp->p_reg.lr = (reg_t) smsg.sm_sigreturn;
+  rp->p_reg.lr = new_lr;
   if(rp->p_reg.lr & 1) { printf("sigsend: LSB LR makes no sense.\n"); }
 
   /* pass signal handler parameters in registers */
-  rp->p_reg.retreg = (reg_t) smsg.sm_signo;
-  rp->p_reg.r1 = 0;	/* sf_code */
-  rp->p_reg.r2 = (reg_t) fr.sf_scp;
+  rp->p_reg.retreg = new_r0;
+  rp->p_reg.r1 = new_r1;
+  rp->p_reg.r2 = new_r2;
   rp->p_misc_flags |= MF_CONTEXT_SET;
 #endif
 
@@ -163,4 +216,3 @@ int do_sigsend(struct proc * caller, message * m_ptr)
 }
 
 #endif /* USE_SIGSEND */
-
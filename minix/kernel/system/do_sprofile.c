@@ -36,7 +36,8 @@ static void clean_seen_flag(void)
 int do_sprofile(struct proc * caller, message * m_ptr)
 {
   int proc_nr;
-  int err;
+  int err, i;
+  unsigned c;
 
   switch(m_ptr->m_lsys_krn_sys_sprof.action) {
 
@@ -71,6 +72,10 @@ int do_sprofile(struct proc * caller, message * m_ptr)
 		m_ptr->m_lsys_krn_sys_sprof.mem_size < SAMPLE_BUFFER_SIZE ?
 		m_ptr->m_lsys_krn_sys_sprof.mem_size : SAMPLE_BUFFER_SIZE;
 
+	/* Give each CPU its own slice of the sample buffer. */
+	if ((err = sprof_init_buffers()) != OK)
+		return err;
+
 	switch (sprofiling_type = m_ptr->m_lsys_krn_sys_sprof.intr_type) {
 		case PROF_RTC:
 			init_profile_clock(m_ptr->m_lsys_krn_sys_sprof.freq);
@@ -114,10 +119,46 @@ int do_sprofile(struct proc * caller, message * m_ptr)
 			break;
 	}
 
+	/* First write a name record for every process that was sampled, so
+	 * that the analyzer knows each endpoint before it sees any of its
+	 * samples, then append every CPU's slice of samples. The per-CPU
+	 * counters are summed into the info struct handed to the caller.
+	 */
+	for (i = 0; i < NR_TASKS + NR_PROCS; i++) {
+		struct sprof_proc sp;
+
+		if (!(proc[i].p_misc_flags & MF_SPROF_SEEN))
+			continue;
+
+		sp.proc = proc[i].p_endpoint;
+		strcpy(sp.name, proc[i].p_name);
+		data_copy(KERNEL, (vir_bytes) &sp, sprof_ep,
+			sprof_data_addr_vir + sprof_info.mem_used, sizeof(sp));
+		sprof_info.mem_used += sizeof(sp);
+	}
+
+	for (c = 0; c < sprof_ncpus; c++) {
+		struct sprof_cpu *sc = &sprof_cpu[c];
+
+		if (sc->full)
+			printf("SYSTEM: s-profiling: CPU %u sample memory "
+				"filled up; samples were dropped\n", c);
+
+		if (sc->used > 0) {
+			data_copy(KERNEL, (vir_bytes) sc->buf, sprof_ep,
+				sprof_data_addr_vir + sprof_info.mem_used,
+				sc->used);
+			sprof_info.mem_used += sc->used;
+		}
+
+		sprof_info.total_samples += sc->total_samples;
+		sprof_info.idle_samples += sc->idle_samples;
+		sprof_info.system_samples += sc->system_samples;
+		sprof_info.user_samples += sc->user_samples;
+	}
+
 	data_copy(KERNEL, (vir_bytes) &sprof_info,
 		sprof_ep, sprof_info_addr_vir, sizeof(sprof_info));
-	data_copy(KERNEL, (vir_bytes) sprof_sample_buffer,
-		sprof_ep, sprof_data_addr_vir, sprof_info.mem_used);
 
 	clean_seen_flag();
 
@@ -91,9 +91,16 @@ int do_umap_remote(struct proc * caller, message * m_ptr)
 	printf("SYSTEM:do_umap: umap_local failed\n");
 	return EFAULT;
       }
-      if(vm_lookup(targetpr, lin_addr, &phys_addr, NULL) != OK) {
-	printf("SYSTEM:do_umap: vm_lookup failed\n");
-	return EFAULT;
+      /* Long-lived objects such as DMA buffers are typically mapped over
+       * and over again; try the translation cache before walking the page
+       * tables.
+       */
+      if(!ptcache_lookup(targetpr->p_endpoint, lin_addr, &phys_addr)) {
+	      if(vm_lookup(targetpr, lin_addr, &phys_addr, NULL) != OK) {
+		printf("SYSTEM:do_umap: vm_lookup failed\n");
+		return EFAULT;
+	      }
+	      ptcache_insert(targetpr->p_endpoint, lin_addr, phys_addr);
       }
       if(phys_addr == 0)
 	panic("vm_lookup returned zero physical address");
@@ -103,7 +110,12 @@ int do_umap_remote(struct proc * caller, message * m_ptr)
   	return EINVAL;
   }
 
-  if(vm_running && vm_lookup_range(targetpr, lin_addr, NULL, count) != count) {
+  /* A range that does not cross a page boundary is trivially contiguous;
+   * the lookup above already established that the page is mapped.
+   */
+  if(vm_running && (count <= 0 ||
+	(lin_addr + count - 1) >> CLICK_SHIFT != lin_addr >> CLICK_SHIFT) &&
+	vm_lookup_range(targetpr, lin_addr, NULL, count) != count) {
 	printf("SYSTEM:do_umap: not contiguous\n");
 	return EFAULT;
   }
@@ -162,6 +162,13 @@ int do_vmctl(struct proc * caller, message * m_ptr)
 	case VMCTL_CLEARMAPCACHE:
 		/* VM says: forget about old mappings we have cached. */
 		mem_clear_mapcache();
+		ptcache_invalidate(NONE);
+		return OK;
+	case VMCTL_PTCACHE_INVAL:
+		/* VM overwrote live page table entries of this process; drop
+		 * any translations the kernel has cached for it.
+		 */
+		ptcache_invalidate(p->p_endpoint);
 		return OK;
 	case VMCTL_BOOTINHIBIT_CLEAR:
 		RTS_UNSET(p, RTS_BOOTINHIBIT);
@@ -27,4 +27,45 @@ typedef struct irq_hook {
 
 typedef int (*irq_handler_t)(struct irq_hook *);
 
+typedef struct irq_stat {
+  u64_t count;				/* interrupts received on this line */
+  u64_t cycles;				/* cycles spent in its handlers */
+} irq_stat_t;
+
+/* Per-lock contention statistics snapshot as returned by GET_LOCKSTATS.
+ * Only SMP kernels collect these; see spinlock.h.
+ */
+struct lock_stat {
+  char ls_name[16];			/* lock name */
+  u64_t ls_acquisitions;		/* times the lock was taken */
+  u64_t ls_spin_cycles;			/* cycles spent spinning for it */
+  u64_t ls_hold_cycles;			/* cycles it was held */
+};
+
+#define NR_LOCK_STATS	2		/* locks covered by the statistics */
+
+/* Boot-phase event record as returned by GET_BOOTEVENTS.  The kernel logs
+ * these from kmain() onwards; user space correlates the TSC values with its
+ * own startup timestamps to build a boot waterfall.
+ */
+struct boot_event {
+  char bev_name[16];			/* boot phase name, empty if unused */
+  u64_t bev_tsc;			/* TSC value when the phase started */
+};
+
+#define NR_BOOT_EVENTS	16		/* size of the boot event table */
+
+/* Grant copy statistics as returned by GET_SAFECOPYSTATS, kept per size
+ * class.  Class n counts copies smaller than 1024 * 8^n bytes (the last
+ * class takes everything bigger as well), so the classes break at 1K, 8K,
+ * 64K, 512K and 4M.  The 512K boundary is also where the i386 copy engine
+ * switches to non-temporal stores.
+ */
+struct safecopy_stat {
+  u64_t ss_calls;			/* number of grant copies */
+  u64_t ss_bytes;			/* total bytes copied */
+};
+
+#define NR_SAFECOPY_CLASSES	6	/* number of size classes */
+
 #endif /* TYPE_H */
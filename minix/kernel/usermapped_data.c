@@ -13,3 +13,11 @@ struct kuserinfo kuserinfo __section(".usermapped");
 struct arm_frclock arm_frclock __section(".usermapped");
 	/* ARM free running timer information */
 struct kclockinfo kclockinfo __section(".usermapped");	/* clock information */
+struct kcpustats kcpustats[CONFIG_MAX_CPUS] __section(".usermapped");
+	/* per-CPU statistics */
+struct kendpointinfo kendpointinfo __section(".usermapped");
+	/* endpoint validation table */
+
+#if NR_TASKS > KEI_MAX_TASKS
+#error "NR_TASKS exceeds KEI_MAX_TASKS, increase the latter in minix/type.h"
+#endif
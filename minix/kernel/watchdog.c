@@ -11,6 +11,40 @@ unsigned watchdog_local_timer_ticks = 0U;
 struct arch_watchdog *watchdog;
 int watchdog_enabled;
 
+struct stall_prof_ring stall_prof_ring[CONFIG_MAX_CPUS];
+
+static void stall_check(struct nmi_frame * frame)
+{
+	struct stall_prof_ring *spr = &stall_prof_ring[cpuid];
+	struct proc *p = get_cpulocal_var(proc_ptr);
+	struct stall_sample *s;
+
+	/*
+	 * a new process on the cpu resets the count. The idle process may
+	 * hold the cpu forever, that is its job
+	 */
+	if (p->p_endpoint == IDLE || p->p_endpoint != spr->spr_last_proc) {
+		spr->spr_last_proc = p->p_endpoint;
+		spr->spr_ticks = 0;
+		return;
+	}
+
+	if (++spr->spr_ticks < STALLPROF_THRESHOLD)
+		return;
+
+	/*
+	 * the same process has been on the cpu beyond the threshold. Log a
+	 * sample on this and every following tick, so a long stall shows up
+	 * as a run of pc values that can be correlated afterwards
+	 */
+	s = &spr->spr_samples[spr->spr_next];
+	s->ss_proc = p->p_endpoint;
+	s->ss_pc = (void *) frame->pc;
+	s->ss_ticks = spr->spr_ticks;
+	spr->spr_next = (spr->spr_next + 1) % STALLPROF_ENTRIES;
+	spr->spr_stalls++;
+}
+
 static void lockup_check(struct nmi_frame * frame)
 {
 	/* FIXME this should be CPU local */
@@ -56,8 +90,10 @@ void nmi_watchdog_handler(struct nmi_frame * frame)
 	 * Do not check for lockups while profiling, it is extremely likely that
 	 * a false positive is detected if the frequency is high
 	 */
-	if (watchdog_enabled && !sprofiling)
+	if (watchdog_enabled && !sprofiling) {
 		lockup_check(frame);
+		stall_check(frame);
+	}
 	if (sprofiling)
 		nmi_sprofile_handler(frame);
 	
@@ -66,6 +102,7 @@ void nmi_watchdog_handler(struct nmi_frame * frame)
 #else
 	if (watchdog_enabled) {
 		lockup_check(frame);
+		stall_check(frame);
 		if (watchdog->reinit)
 			watchdog->reinit(cpuid);
 	}
@@ -27,6 +27,34 @@ struct arch_watchdog {
 
 extern struct arch_watchdog *watchdog;
 
+/*
+ * Stall profiler. The lockup check only fires when the kernel stops ticking
+ * altogether; soft stalls of a few hundred milliseconds pass it by unseen. On
+ * every watchdog NMI we therefore also check whether the same process is
+ * still on the CPU as on the previous tick, and once it has been there longer
+ * than the threshold we log a sample (same process/pc pair as the statistical
+ * profiler uses, plus the stall length so far) into a per-CPU ring that can
+ * be read out afterwards with sys_getstallprof().
+ */
+#define STALLPROF_THRESHOLD	2	/* watchdog ticks on cpu before we log */
+#define STALLPROF_ENTRIES	64	/* ring entries per cpu */
+
+struct stall_sample {
+	endpoint_t ss_proc;		/* who held the cpu */
+	void *ss_pc;			/* where it was executing */
+	unsigned ss_ticks;		/* consecutive watchdog ticks on cpu */
+};
+
+struct stall_prof_ring {
+	endpoint_t spr_last_proc;	/* on cpu at the previous tick */
+	unsigned spr_ticks;		/* ticks it has been there */
+	unsigned spr_next;		/* next slot to fill */
+	unsigned long spr_stalls;	/* samples logged since boot */
+	struct stall_sample spr_samples[STALLPROF_ENTRIES];
+};
+
+extern struct stall_prof_ring stall_prof_ring[]; /* one ring per CPU */
+
 /* let the arch code do whatever it needs to setup or quit the watchdog */
 int arch_watchdog_init(void);
 void arch_watchdog_stop(void);
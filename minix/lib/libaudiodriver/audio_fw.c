@@ -135,6 +135,8 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
 		sub_dev_ptr->BufFillNext = 0;
 		sub_dev_ptr->RevivePending = FALSE;
 		sub_dev_ptr->OutOfData = FALSE;
+		sub_dev_ptr->Underruns = 0;
+		sub_dev_ptr->Overruns = 0;
 		sub_dev_ptr->Nr = i;
 	}
 
@@ -266,6 +268,8 @@ static int open_sub_dev(int sub_dev_nr, int dma_mode) {
 	sub_dev_ptr->BufLength = 0;
 	sub_dev_ptr->RevivePending = FALSE;
 	sub_dev_ptr->OutOfData = TRUE;
+	sub_dev_ptr->Underruns = 0;
+	sub_dev_ptr->Overruns = 0;
 
 	/* arrange DMA */
 	if (dma_mode != NO_DMA) { /* sub device uses DMA */
@@ -365,6 +369,27 @@ static int msg_ioctl(devminor_t minor, unsigned long request, endpoint_t endpt,
 		return EIO;
 	}
 
+	/* The framework maintains the underrun and overrun counters itself;
+	 * requests for them are not passed down to the device specific part.
+	 */
+	if (request == DSPIOUNDERRUNS || request == DSPIOOVERRUNS) {
+		unsigned int xruns;
+
+		chan = (request == DSPIOUNDERRUNS) ?
+			special_file_ptr->write_chan : special_file_ptr->read_chan;
+		if (chan == NO_CHANNEL) {
+			return EINVAL;
+		}
+		xruns = (request == DSPIOUNDERRUNS) ?
+			sub_dev[chan].Underruns : sub_dev[chan].Overruns;
+
+		if (sys_safecopyto(endpt, grant, 0, (vir_bytes)&xruns,
+		    sizeof(xruns)) != OK) {
+			printf("%s:%d: safecopyto failed\n", __FILE__, __LINE__);
+		}
+		return OK;
+	}
+
 	if (request & IOC_IN) { /* if there is data for us, copy it */
 		len = io_ctl_length(request);
 
@@ -414,8 +439,8 @@ static ssize_t msg_write(devminor_t minor, u64_t UNUSED(position),
 			return EIO;
 		}
 	}
-	if(size != sub_dev_ptr->FragSize) {
-		printf("Fragment size does not match user's buffer length\n");
+	if(size == 0 || size % sub_dev_ptr->FragSize != 0) {
+		printf("Buffer length is not a multiple of the fragment size\n");
 		return EINVAL;
 	}
 	/* if we are busy with something else than writing, return EBUSY */
@@ -427,6 +452,9 @@ static ssize_t msg_write(devminor_t minor, u64_t UNUSED(position),
 	sub_dev_ptr->RevivePending = TRUE;
 	sub_dev_ptr->ReviveId = id;
 	sub_dev_ptr->ReviveGrant = grant;
+	sub_dev_ptr->ReviveSize = size;
+	sub_dev_ptr->ReviveLeft = size;
+	sub_dev_ptr->ReviveOffset = 0;
 	sub_dev_ptr->SourceProcNr = endpt;
 
 	data_from_user(sub_dev_ptr);
@@ -464,8 +492,8 @@ static ssize_t msg_read(devminor_t minor, u64_t UNUSED(position),
 			return EIO;
 		}
 	}
-	if(size != sub_dev_ptr->FragSize) {
-		printf("fragment size does not match message size\n");
+	if(size == 0 || size % sub_dev_ptr->FragSize != 0) {
+		printf("message size is not a multiple of the fragment size\n");
 		return EINVAL;
 	}
 	/* if we are busy with something else than reading, reply EBUSY */
@@ -476,6 +504,9 @@ static ssize_t msg_read(devminor_t minor, u64_t UNUSED(position),
 	sub_dev_ptr->RevivePending = TRUE;
 	sub_dev_ptr->ReviveId = id;
 	sub_dev_ptr->ReviveGrant = grant;
+	sub_dev_ptr->ReviveSize = size;
+	sub_dev_ptr->ReviveLeft = size;
+	sub_dev_ptr->ReviveOffset = 0;
 	sub_dev_ptr->SourceProcNr = endpt;
 
 	if(!sub_dev_ptr->DmaBusy) { /* Dma tranfer not yet started */
@@ -558,6 +589,7 @@ static void handle_int_write(int sub_dev_nr)
 			close_sub_dev(sub_dev_ptr->Nr);
 			return;
 		}
+		sub_dev_ptr->Underruns += 1; /* playback ran dry */
 		drv_pause(sub_dev_ptr->Nr);
 		return;
 	}
@@ -592,11 +624,17 @@ static void handle_int_read(int sub_dev_nr)
 
 		if (sub_dev_ptr->BufLength == sub_dev_ptr->NrOfExtraBuffers) {
 			printf("All buffers full, we have a problem.\n");
+			sub_dev_ptr->Overruns += 1; /* capture data is lost */
 			drv_stop(sub_dev_nr);        /* stop the sub device */
 			sub_dev_ptr->DmaBusy = FALSE;
-			/* no data for user, this is a sad story */
-			chardriver_reply_task(sub_dev_ptr->SourceProcNr,
-				sub_dev_ptr->ReviveId, 0);
+			if (sub_dev_ptr->RevivePending) {
+				/* return whatever was copied out so far */
+				chardriver_reply_task(sub_dev_ptr->SourceProcNr,
+					sub_dev_ptr->ReviveId,
+					sub_dev_ptr->ReviveSize -
+					sub_dev_ptr->ReviveLeft);
+				sub_dev_ptr->RevivePending = 0;
+			}
 			return;
 		} 
 		else { /* dma full, still room in extra buf; 
@@ -649,44 +687,71 @@ static int get_started(sub_dev_t *sub_dev_ptr) {
 static void data_from_user(sub_dev_t *subdev)
 {
 	int r;
-
-	if (subdev->DmaLength == subdev->NrOfDmaFragments &&
-			subdev->BufLength == subdev->NrOfExtraBuffers) return;/* no space */
+	unsigned int frags, limit;
 
 	if (!subdev->RevivePending) return; /* no new data waiting to be copied */
 
-	if (subdev->DmaLength < subdev->NrOfDmaFragments) { /* room in dma buf */
-
-		r = sys_safecopyfrom(subdev->SourceProcNr,
-				(vir_bytes)subdev->ReviveGrant, 0, 
-				(vir_bytes)subdev->DmaPtr + 
-				subdev->DmaFillNext * subdev->FragSize,
-				(phys_bytes)subdev->FragSize);
-		if (r != OK)
-			printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
-
-
-		subdev->DmaLength += 1;
-		subdev->DmaFillNext = 
-			(subdev->DmaFillNext + 1) % subdev->NrOfDmaFragments;
-
-	} else { /* room in extra buf */ 
-
-		r = sys_safecopyfrom(subdev->SourceProcNr,
-				(vir_bytes)subdev->ReviveGrant, 0,
-				(vir_bytes)subdev->ExtraBuf + 
-				subdev->BufFillNext * subdev->FragSize, 
-				(phys_bytes)subdev->FragSize);
-		if (r != OK)
-			printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
-
-		subdev->BufLength += 1;
+	/* Copy in as many whole fragments as there is room for, coalescing
+	 * fragments that are contiguous in the target buffer into a single
+	 * safecopy.  A request larger than the available space stays pending;
+	 * the remainder is copied in as the interrupt handler frees fragments.
+	 */
+	while (subdev->ReviveLeft > 0 &&
+			(subdev->DmaLength < subdev->NrOfDmaFragments ||
+			subdev->BufLength < subdev->NrOfExtraBuffers)) {
+
+		frags = subdev->ReviveLeft / subdev->FragSize;
+
+		if (subdev->DmaLength < subdev->NrOfDmaFragments) {
+			/* room in dma buf */
+			limit = subdev->NrOfDmaFragments - subdev->DmaLength;
+			if (frags > limit) frags = limit;
+			limit = subdev->NrOfDmaFragments - subdev->DmaFillNext;
+			if (frags > limit) frags = limit;
+
+			r = sys_safecopyfrom(subdev->SourceProcNr,
+					(vir_bytes)subdev->ReviveGrant,
+					subdev->ReviveOffset,
+					(vir_bytes)subdev->DmaPtr + 
+					subdev->DmaFillNext * subdev->FragSize,
+					(phys_bytes)frags * subdev->FragSize);
+			if (r != OK)
+				printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
+
+
+			subdev->DmaLength += frags;
+			subdev->DmaFillNext = 
+				(subdev->DmaFillNext + frags) % subdev->NrOfDmaFragments;
+
+		} else { /* room in extra buf */ 
+
+			limit = subdev->NrOfExtraBuffers - subdev->BufLength;
+			if (frags > limit) frags = limit;
+			limit = subdev->NrOfExtraBuffers - subdev->BufFillNext;
+			if (frags > limit) frags = limit;
+
+			r = sys_safecopyfrom(subdev->SourceProcNr,
+					(vir_bytes)subdev->ReviveGrant,
+					subdev->ReviveOffset,
+					(vir_bytes)subdev->ExtraBuf + 
+					subdev->BufFillNext * subdev->FragSize, 
+					(phys_bytes)frags * subdev->FragSize);
+			if (r != OK)
+				printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
+
+			subdev->BufLength += frags;
+
+			subdev->BufFillNext = 
+				(subdev->BufFillNext + frags) % subdev->NrOfExtraBuffers;
 
-		subdev->BufFillNext = 
-			(subdev->BufFillNext + 1) % subdev->NrOfExtraBuffers;
+		}
 
+		subdev->ReviveOffset += frags * subdev->FragSize;
+		subdev->ReviveLeft -= frags * subdev->FragSize;
 	}
-	if(subdev->OutOfData) { /* if device paused (because of lack of data) */
+
+	if(subdev->OutOfData && subdev->DmaLength > 0) {
+		/* if device paused (because of lack of data) */
 		subdev->OutOfData = FALSE;
 		drv_reenable_int(subdev->Nr);
 		/* reenable irq_hook*/
@@ -696,8 +761,10 @@ static void data_from_user(sub_dev_t *subdev)
 		drv_resume(subdev->Nr);  /* resume resume the sub device */
 	}
 
+	if (subdev->ReviveLeft > 0) return; /* request not yet complete */
+
 	chardriver_reply_task(subdev->SourceProcNr, subdev->ReviveId,
-		subdev->FragSize);
+		subdev->ReviveSize);
 
 	/* reset variables */
 	subdev->RevivePending = 0;
@@ -707,44 +774,75 @@ static void data_from_user(sub_dev_t *subdev)
 static void data_to_user(sub_dev_t *sub_dev_ptr)
 {
 	int r;
+	unsigned int frags, limit;
 
 	if (!sub_dev_ptr->RevivePending) return; /* nobody is wating for data */
-	if (sub_dev_ptr->BufLength == 0 && sub_dev_ptr->DmaLength == 0) return; 
-		/* no data for user */
-
-	if(sub_dev_ptr->BufLength != 0) { /* data in extra buffer available */
 
-		r = sys_safecopyto(sub_dev_ptr->SourceProcNr,
-				(vir_bytes)sub_dev_ptr->ReviveGrant,
-				0, (vir_bytes)sub_dev_ptr->ExtraBuf + 
-				sub_dev_ptr->BufReadNext * sub_dev_ptr->FragSize,
-				(phys_bytes)sub_dev_ptr->FragSize);
-		if (r != OK)
-			printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
-
-		/* adjust the buffer status variables */
-		sub_dev_ptr->BufReadNext = 
-			(sub_dev_ptr->BufReadNext + 1) % sub_dev_ptr->NrOfExtraBuffers;
-		sub_dev_ptr->BufLength -= 1;
+	/* Copy out as many whole fragments as are available, coalescing
+	 * fragments that are contiguous in the source buffer into a single
+	 * safecopy.  The extra buffer holds the oldest data, so it is drained
+	 * first.  A request larger than the available data stays pending; the
+	 * remainder is copied out as the interrupt handler fills fragments.
+	 */
+	while (sub_dev_ptr->ReviveLeft > 0 &&
+			(sub_dev_ptr->BufLength != 0 || sub_dev_ptr->DmaLength != 0)) {
+
+		frags = sub_dev_ptr->ReviveLeft / sub_dev_ptr->FragSize;
+
+		if(sub_dev_ptr->BufLength != 0) { /* data in extra buffer available */
+
+			if (frags > sub_dev_ptr->BufLength)
+				frags = sub_dev_ptr->BufLength;
+			limit = sub_dev_ptr->NrOfExtraBuffers - sub_dev_ptr->BufReadNext;
+			if (frags > limit) frags = limit;
+
+			r = sys_safecopyto(sub_dev_ptr->SourceProcNr,
+					(vir_bytes)sub_dev_ptr->ReviveGrant,
+					sub_dev_ptr->ReviveOffset,
+					(vir_bytes)sub_dev_ptr->ExtraBuf + 
+					sub_dev_ptr->BufReadNext * sub_dev_ptr->FragSize,
+					(phys_bytes)frags * sub_dev_ptr->FragSize);
+			if (r != OK)
+				printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
+
+			/* adjust the buffer status variables */
+			sub_dev_ptr->BufReadNext = 
+				(sub_dev_ptr->BufReadNext + frags) %
+				sub_dev_ptr->NrOfExtraBuffers;
+			sub_dev_ptr->BufLength -= frags;
+
+		} else { /* extra buf empty, but data in dma buf*/ 
+
+			if (frags > sub_dev_ptr->DmaLength)
+				frags = sub_dev_ptr->DmaLength;
+			limit = sub_dev_ptr->NrOfDmaFragments - sub_dev_ptr->DmaReadNext;
+			if (frags > limit) frags = limit;
+
+			r = sys_safecopyto(
+					sub_dev_ptr->SourceProcNr, 
+					(vir_bytes)sub_dev_ptr->ReviveGrant,
+					sub_dev_ptr->ReviveOffset,
+					(vir_bytes)sub_dev_ptr->DmaPtr + 
+					sub_dev_ptr->DmaReadNext * sub_dev_ptr->FragSize,
+					(phys_bytes)frags * sub_dev_ptr->FragSize);
+			if (r != OK)
+				printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
 
-	} else { /* extra buf empty, but data in dma buf*/ 
-		r = sys_safecopyto(
-				sub_dev_ptr->SourceProcNr, 
-				(vir_bytes)sub_dev_ptr->ReviveGrant, 0, 
-				(vir_bytes)sub_dev_ptr->DmaPtr + 
-				sub_dev_ptr->DmaReadNext * sub_dev_ptr->FragSize,
-				(phys_bytes)sub_dev_ptr->FragSize);
-		if (r != OK)
-			printf("%s:%d: safecopy failed\n", __FILE__, __LINE__);
+			/* adjust the buffer status variables */
+			sub_dev_ptr->DmaReadNext = 
+				(sub_dev_ptr->DmaReadNext + frags) %
+				sub_dev_ptr->NrOfDmaFragments;
+			sub_dev_ptr->DmaLength -= frags;
+		}
 
-		/* adjust the buffer status variables */
-		sub_dev_ptr->DmaReadNext = 
-			(sub_dev_ptr->DmaReadNext + 1) % sub_dev_ptr->NrOfDmaFragments;
-		sub_dev_ptr->DmaLength -= 1;
+		sub_dev_ptr->ReviveOffset += frags * sub_dev_ptr->FragSize;
+		sub_dev_ptr->ReviveLeft -= frags * sub_dev_ptr->FragSize;
 	}
 
+	if (sub_dev_ptr->ReviveLeft > 0) return; /* request not yet complete */
+
 	chardriver_reply_task(sub_dev_ptr->SourceProcNr, sub_dev_ptr->ReviveId,
-		sub_dev_ptr->FragSize);
+		sub_dev_ptr->ReviveSize);
 
 	/* reset variables */
 	sub_dev_ptr->RevivePending = 0;
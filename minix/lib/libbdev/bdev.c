@@ -171,6 +171,61 @@ static ssize_t bdev_rdwt(int req, dev_t dev, u64_t pos, char *buf,
   return r;
 }
 
+static int bdev_rdwt_grant_setup(int req, dev_t dev, u64_t pos,
+  endpoint_t granter, cp_grant_id_t gr, size_t count, int flags, message *m)
+{
+/* Set up a read/write request that operates directly on a grant made to us by
+ * another process, by forwarding that grant to the driver through an indirect
+ * grant. This allows the driver to transfer data straight from or to the
+ * original grantor's buffer, without intermediate copies in our address space.
+ */
+  endpoint_t endpt;
+  cp_grant_id_t grant;
+
+  assert((ssize_t) count >= 0);
+
+  if ((endpt = bdev_driver_get(dev)) == NONE)
+	return EDEADSRCDST;
+
+  grant = cpf_grant_indirect(endpt, granter, gr);
+
+  if (!GRANT_VALID(grant)) {
+	printf("bdev: unable to allocate grant!\n");
+	return EINVAL;
+  }
+
+  memset(m, 0, sizeof(*m));
+  m->m_type = req;
+  m->m_lbdev_lblockdriver_msg.minor = minor(dev);
+  m->m_lbdev_lblockdriver_msg.pos = pos;
+  m->m_lbdev_lblockdriver_msg.count = count;
+  m->m_lbdev_lblockdriver_msg.grant = grant;
+  m->m_lbdev_lblockdriver_msg.flags = flags;
+
+  return OK;
+}
+
+static ssize_t bdev_rdwt_grant(int req, dev_t dev, u64_t pos,
+  endpoint_t granter, cp_grant_id_t gr, size_t count, int flags)
+{
+/* Perform a synchronous read or write call on a forwarded grant.
+ */
+  message m;
+  int r, driver_tries = 0, transfer_tries = 0;
+
+  do {
+	if ((r = bdev_rdwt_grant_setup(req, dev, pos, granter, gr, count,
+			flags, &m)) != OK)
+		break;
+
+	r = bdev_sendrec(dev, &m);
+
+	bdev_rdwt_cleanup(&m);
+  } while (bdev_retry(&driver_tries, &transfer_tries, &r));
+
+  return r;
+}
+
 static int bdev_vrdwt_setup(int req, dev_t dev, u64_t pos, iovec_t *vec,
   int count, int flags, message *m, iovec_s_t *gvec)
 {
@@ -287,6 +342,26 @@ ssize_t bdev_write(dev_t dev, u64_t pos, char *buf, size_t count, int flags)
   return bdev_rdwt(BDEV_WRITE, dev, pos, buf, count, flags);
 }
 
+ssize_t bdev_read_grant(dev_t dev, u64_t pos, endpoint_t granter,
+  cp_grant_id_t grant, size_t count, int flags)
+{
+/* Perform a synchronous read call directly into another process's buffer,
+ * identified by a grant made out to us.
+ */
+
+  return bdev_rdwt_grant(BDEV_READ, dev, pos, granter, grant, count, flags);
+}
+
+ssize_t bdev_write_grant(dev_t dev, u64_t pos, endpoint_t granter,
+  cp_grant_id_t grant, size_t count, int flags)
+{
+/* Perform a synchronous write call directly from another process's buffer,
+ * identified by a grant made out to us.
+ */
+
+  return bdev_rdwt_grant(BDEV_WRITE, dev, pos, granter, grant, count, flags);
+}
+
 ssize_t bdev_gather(dev_t dev, u64_t pos, iovec_t *vec, int count, int flags)
 {
 /* Perform a synchronous read call into a vector of buffers.
@@ -371,6 +446,32 @@ int bdev_ioctl(dev_t dev, unsigned long request, void *buf,
   return r;
 }
 
+int bdev_discard(dev_t dev, u64_t pos, size_t count)
+{
+/* Perform a synchronous discard request, telling the driver that the given
+ * byte range no longer contains data that must be preserved. Discarding is
+ * advisory; a driver that does not implement it returns ENOTSUP, in which
+ * case the caller would do well to stop issuing discard requests altogether.
+ * File system usage note: typically called after freeing data blocks.
+ */
+  message m;
+  int r, driver_tries = 0;
+
+  assert((ssize_t) count >= 0);
+
+  do {
+	memset(&m, 0, sizeof(m));
+	m.m_type = BDEV_DISCARD;
+	m.m_lbdev_lblockdriver_msg.minor = minor(dev);
+	m.m_lbdev_lblockdriver_msg.pos = pos;
+	m.m_lbdev_lblockdriver_msg.count = count;
+
+	r = bdev_sendrec(dev, &m);
+  } while (bdev_retry(&driver_tries, NULL, &r));
+
+  return r;
+}
+
 void bdev_flush_asyn(dev_t dev)
 {
 /* Flush all ongoing asynchronous requests to the given minor device. This
@@ -19,6 +19,8 @@
  * | BDEV_SCATTER | minor  | elements | grant | flags |  id  |         | pos. |
  * |--------------+--------+----------+-------+-------+------+---------+------|
  * | BDEV_IOCTL   | minor  |          | grant | user  |  id  | request |      |
+ * |--------------+--------+----------+-------+-------+------+---------+------|
+ * | BDEV_DISCARD | minor  |  bytes   |       |       |  id  |         | pos. |
  * ----------------------------------------------------------------------------
  *
  * The following reply message is used for all requests.
@@ -257,6 +259,25 @@ static int do_vrdwt(struct blockdriver *bdp, message *mp, thread_id_t id)
   return r;
 }
 
+/*===========================================================================*
+ *				do_discard				     *
+ *===========================================================================*/
+static int do_discard(struct blockdriver *bdp, message *mp)
+{
+/* Discard a range of data on a minor device. Discarding is advisory: drivers
+ * without support for it simply report that they do not implement the
+ * request, so that the caller can stop issuing discard requests altogether.
+ */
+
+  if (bdp->bdr_discard == NULL)
+	return ENOTSUP;
+
+  if (mp->m_lbdev_lblockdriver_msg.count < 0) return EINVAL;
+
+  return (*bdp->bdr_discard)(mp->m_lbdev_lblockdriver_msg.minor,
+	mp->m_lbdev_lblockdriver_msg.pos, mp->m_lbdev_lblockdriver_msg.count);
+}
+
 /*===========================================================================*
  *				do_dioctl				     *
  *===========================================================================*/
@@ -445,6 +466,7 @@ void blockdriver_process_on_thread(struct blockdriver *bdp, message *m_ptr,
   case BDEV_GATHER:
   case BDEV_SCATTER:	r = do_vrdwt(bdp, m_ptr, id);	break;
   case BDEV_IOCTL:	r = do_ioctl(bdp, m_ptr);	break;
+  case BDEV_DISCARD:	r = do_discard(bdp, m_ptr);	break;
   default:
 	if (bdp->bdr_other != NULL)
 		(*bdp->bdr_other)(m_ptr, ipc_status);
@@ -67,16 +67,20 @@ static int num_exited = 0;
 /*===========================================================================*
  *				enqueue					     *
  *===========================================================================*/
-static void enqueue(device_t *dp, const message *m_src, int ipc_status)
+static int enqueue(device_t *dp, const message *m_src, int ipc_status)
 {
-/* Enqueue a message into the device's queue, and signal the event.
- * Must be called from the master thread.
+/* Enqueue a message into the device's queue, and signal the event. Return
+ * whether the message could be queued: intake may be denied if the device has
+ * filled up its share of the message cell pool, in which case the caller must
+ * push back on the sender. Must be called from the master thread.
  */
 
   if (!mq_enqueue(dp->id, m_src, ipc_status))
-	panic("blockdriver_mt: enqueue failed (message queue full)");
+	return FALSE;
 
   mthread_event_fire(&dp->queue_event);
+
+  return TRUE;
 }
 
 /*===========================================================================*
@@ -343,8 +347,12 @@ static void master_handle_message(message *m_ptr, int ipc_status)
 		master_create_worker(wp, wid, dp->id);
   }
 
-  /* Enqueue the message at the device queue. */
-  enqueue(dp, m_ptr, ipc_status);
+  /* Enqueue the message at the device queue. If the device has exhausted its
+   * share of the message cell pool, push back on the caller rather than
+   * letting this device starve the queues of the other devices.
+   */
+  if (!enqueue(dp, m_ptr, ipc_status))
+	blockdriver_reply(m_ptr, ipc_status, EBUSY);
 }
 
 /*===========================================================================*
@@ -520,6 +528,19 @@ void blockdriver_mt_set_workers(device_id_t id, unsigned int workers)
   dp->workers = workers;
 }
 
+/*===========================================================================*
+ *				blockdriver_mt_set_scheduler		     *
+ *===========================================================================*/
+void blockdriver_mt_set_scheduler(device_id_t id, int sched_policy)
+{
+/* Set the request scheduling policy for the given device's message queue.
+ */
+
+  assert(id >= 0 && id < MAX_DEVICES);
+
+  mq_set_policy(id, sched_policy);
+}
+
 /*===========================================================================*
  *				blockdriver_mt_is_idle			     *
  *===========================================================================*/
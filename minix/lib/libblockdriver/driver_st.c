@@ -92,3 +92,13 @@ int blockdriver_mq_queue(message *m, int status)
 
   return mq_enqueue(SINGLE_THREAD, m, status);
 }
+
+/*===========================================================================*
+ *				blockdriver_set_scheduler		     *
+ *===========================================================================*/
+void blockdriver_set_scheduler(int sched_policy)
+{
+/* Set the request scheduling policy for the driver's message queue. */
+
+  mq_set_policy(SINGLE_THREAD, sched_policy);
+}
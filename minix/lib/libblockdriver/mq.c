@@ -15,15 +15,34 @@
 
 #define MQ_SIZE		128
 
+/* The cell pool is shared between all devices, but each device is guaranteed
+ * a minimum number of cells, and no device may monopolize the pool: a device
+ * may never take so many cells that the other devices can no longer claim
+ * their reserved share. This keeps a device with a deep request backlog from
+ * starving the queues of the other devices.
+ */
+#define MQ_RESERVE	2	/* cells guaranteed to each device */
+#define MQ_DEV_MAX	(MQ_SIZE - (MAX_DEVICES - 1) * MQ_RESERVE)
+
+/* With the elevator policy, a newly queued transfer request may be inserted
+ * ahead of queued transfer requests for higher device positions. To bound the
+ * resulting delay, a queued request may be passed at most MQ_MAX_BYPASS times;
+ * after that, it acts as a barrier that new requests are queued behind.
+ */
+#define MQ_MAX_BYPASS	16
+
 struct mq_cell {
   message mess;
   int ipc_status;
+  unsigned int bypassed;	/* # times later requests went ahead of us */
   STAILQ_ENTRY(mq_cell) next;
 };
 
 static struct mq_cell pool[MQ_SIZE];
 static STAILQ_HEAD(queue, mq_cell) queue[MAX_DEVICES];
 static STAILQ_HEAD(free_list, mq_cell) free_list;
+static unsigned int queued[MAX_DEVICES];
+static int policy[MAX_DEVICES];
 
 /*===========================================================================*
  *				mq_init					     *
@@ -36,13 +55,52 @@ void mq_init(void)
 
   STAILQ_INIT(&free_list);
 
-  for (i = 0; i < MAX_DEVICES; i++)
+  for (i = 0; i < MAX_DEVICES; i++) {
 	STAILQ_INIT(&queue[i]);
+	queued[i] = 0;
+	policy[i] = BLOCKDRIVER_SCHED_FIFO;
+  }
 
   for (i = 0; i < MQ_SIZE; i++)
 	STAILQ_INSERT_HEAD(&free_list, &pool[i], next);
 }
 
+/*===========================================================================*
+ *				mq_set_policy				     *
+ *===========================================================================*/
+void mq_set_policy(device_id_t device_id, int sched_policy)
+{
+/* Set the scheduling policy for the message queue of a device.
+ */
+
+  assert(device_id >= 0 && device_id < MAX_DEVICES);
+  assert(sched_policy == BLOCKDRIVER_SCHED_FIFO ||
+	sched_policy == BLOCKDRIVER_SCHED_ELEVATOR);
+
+  policy[device_id] = sched_policy;
+}
+
+/*===========================================================================*
+ *				mq_transfer_pos				     *
+ *===========================================================================*/
+static int mq_transfer_pos(const message *mess, u64_t *pos)
+{
+/* If the given message is a transfer request, store its device position in
+ * 'pos' and return TRUE; otherwise return FALSE.
+ */
+
+  switch (mess->m_type) {
+  case BDEV_READ:
+  case BDEV_WRITE:
+  case BDEV_GATHER:
+  case BDEV_SCATTER:
+	*pos = mess->m_lbdev_lblockdriver_msg.pos;
+	return TRUE;
+  }
+
+  return FALSE;
+}
+
 /*===========================================================================*
  *				mq_enqueue				     *
  *===========================================================================*/
@@ -52,20 +110,70 @@ int mq_enqueue(device_id_t device_id, const message *mess,
 /* Add a message, including its IPC status, to the message queue of a device.
  * Return TRUE iff the message was added successfully.
  */
-  struct mq_cell *cell;
+  struct mq_cell *cell, *cur, *prev;
+  u64_t pos, cur_pos;
 
   assert(device_id >= 0 && device_id < MAX_DEVICES);
 
   if (STAILQ_EMPTY(&free_list))
 	return FALSE;
 
+  /* Deny the request if the device has reached its pool share; the
+   * remaining free cells are reserved for the other devices.
+   */
+  if (queued[device_id] >= MQ_DEV_MAX)
+	return FALSE;
+
   cell = STAILQ_FIRST(&free_list);
   STAILQ_REMOVE_HEAD(&free_list, next);
 
   cell->mess = *mess;
   cell->ipc_status = ipc_status;
-
-  STAILQ_INSERT_TAIL(&queue[device_id], cell, next);
+  cell->bypassed = 0;
+
+  if (policy[device_id] == BLOCKDRIVER_SCHED_ELEVATOR &&
+	mq_transfer_pos(mess, &pos)) {
+	/* Sort transfer requests on their device position. A new transfer may
+	 * not be reordered around a non-transfer message (such as an I/O
+	 * control request), nor around a transfer that has already been
+	 * passed MQ_MAX_BYPASS times. Find the last such message, if any;
+	 * only the requests queued after it are eligible for insertion.
+	 */
+	prev = NULL;
+	STAILQ_FOREACH(cur, &queue[device_id], next) {
+		if (!mq_transfer_pos(&cur->mess, &cur_pos) ||
+		    cur->bypassed >= MQ_MAX_BYPASS)
+			prev = cur;
+	}
+
+	/* Find the first eligible transfer for a higher position, and insert
+	 * the new request right before it, charging a bypass to each of the
+	 * requests it goes ahead of.
+	 */
+	cur = (prev != NULL) ? STAILQ_NEXT(prev, next) :
+		STAILQ_FIRST(&queue[device_id]);
+	while (cur != NULL) {
+		if (mq_transfer_pos(&cur->mess, &cur_pos) && cur_pos > pos)
+			break;
+		prev = cur;
+		cur = STAILQ_NEXT(cur, next);
+	}
+
+	if (cur != NULL) {
+		for ( ; cur != NULL; cur = STAILQ_NEXT(cur, next))
+			cur->bypassed++;
+
+		if (prev != NULL)
+			STAILQ_INSERT_AFTER(&queue[device_id], prev, cell,
+				next);
+		else
+			STAILQ_INSERT_HEAD(&queue[device_id], cell, next);
+	} else
+		STAILQ_INSERT_TAIL(&queue[device_id], cell, next);
+  } else
+	STAILQ_INSERT_TAIL(&queue[device_id], cell, next);
+
+  queued[device_id]++;
 
   return TRUE;
 }
@@ -103,6 +211,8 @@ int mq_dequeue(device_id_t device_id, message *mess, int *ipc_status)
   *ipc_status = cell->ipc_status;
 
   STAILQ_INSERT_HEAD(&free_list, cell, next);
+  assert(queued[device_id] > 0);
+  queued[device_id]--;
 
   return TRUE;
 }
@@ -2,6 +2,7 @@
 #define _BLOCKDRIVER_MQ_H
 
 void mq_init(void);
+void mq_set_policy(device_id_t device_id, int sched_policy);
 int mq_enqueue(device_id_t device_id, const message *mess, int
 	ipc_status);
 int mq_dequeue(device_id_t device_id, message *mess, int *ipc_status);
@@ -9,6 +9,7 @@ int _cpufeature(int cpufeature)
 {
 	u32_t eax, ebx, ecx, edx;
 	u32_t ef_eax = 0, ef_ebx = 0, ef_ecx = 0, ef_edx = 0;
+	u32_t max_level;
 	unsigned int family, model, stepping;
 	int is_intel = 0, is_amd = 0;
 
@@ -17,6 +18,7 @@ int _cpufeature(int cpufeature)
 	/* We assume >= pentium for cpuid */
 	eax = 0;
 	_cpuid(&eax, &ebx, &ecx, &edx);
+	max_level = eax;
 	if(eax > 0) {
 		char vendor[12];
 		memcpy(vendor,   &ebx, sizeof(ebx));
@@ -94,6 +96,15 @@ int _cpufeature(int cpufeature)
 			if(!is_amd) return 0;
 			if(!(ef_edx & CPUID_EF_EDX_SYSENTER)) return 0;
 			return 1;
+		case _CPUF_I386_XSAVE:
+			return ecx & CPUID1_ECX_XSAVE;
+		case _CPUF_I386_ERMS:
+			/* Feature flags from cpuid leaf 7, subleaf 0 */
+			if(max_level < 7) return 0;
+			eax = 7;
+			ecx = 0;
+			_cpuid(&eax, &ebx, &ecx, &edx);
+			return !!(ebx & CPUID7_EBX_ERMS);
 	}
 
 	return 0;
@@ -3,6 +3,112 @@
 #include "namespace.h"
 #include "extern.h"
 #include <string.h>
+#include <errno.h>
+#include <sys/sysctl.h>
+#include <sys/time.h>
+#include <machine/vmparam.h>
+
+extern struct minix_kerninfo *_minix_kerninfo;
+
+/*
+ * Try to handle a sysctl(2) read locally, from the information page that the
+ * kernel maps into all processes.  Only a handful of hot, read-only nodes are
+ * handled here: they are polled frequently by monitoring code, and for each
+ * of them we can produce the exact same result as the MIB service would,
+ * without any IPC.  Return 1 if the call was handled, in which case *resp is
+ * the call result (with errno set on failure), or 0 to defer to the service.
+ */
+static int
+sysctl_fast(const int * name, unsigned int namelen, void * oldp,
+	size_t * oldlenp, struct minix_kerninfo * ki, int * resp)
+{
+	struct timeval tv;
+	struct clockinfo ci;
+	volatile struct kclockinfo *kci;
+	uint32_t seq;
+	int ival;
+	const void *ptr;
+	size_t size, len;
+
+	if (namelen != 2)
+		return 0;
+
+	switch (name[0]) {
+	case CTL_KERN:
+		if (!(ki->ki_flags & MINIX_KIF_CLOCKINFO))
+			return 0;
+		kci = ki->kclockinfo;
+
+		switch (name[1]) {
+		case KERN_BOOTTIME:
+			/*
+			 * The sequence number is odd while the kernel is
+			 * changing more than one clock field at once; retry
+			 * the reads until we have a consistent snapshot.
+			 */
+			memset(&tv, 0, sizeof(tv));
+			do {
+				seq = kci->seq;
+				tv.tv_sec = kci->boottime;
+			} while ((seq & 1) != 0 || kci->seq != seq);
+			ptr = &tv;
+			size = sizeof(tv);
+			break;
+		case KERN_CLOCKRATE:
+			memset(&ci, 0, sizeof(ci));
+			ci.hz = kci->hz;
+			ci.tick = 1000000 / ci.hz;
+			ci.profhz = ci.hz;
+			ci.stathz = ci.hz;
+			ci.tickadj = ci.tick;
+			ptr = &ci;
+			size = sizeof(ci);
+			break;
+		default:
+			return 0;
+		}
+		break;
+	case CTL_HW:
+		switch (name[1]) {
+		case HW_BYTEORDER:
+			ival = BYTE_ORDER;
+			break;
+		case HW_PAGESIZE:
+			ival = PAGE_SIZE;
+			break;
+		case HW_NCPUONLINE:
+			ival = ki->machine->processors_count;
+			break;
+		default:
+			return 0;
+		}
+		ptr = &ival;
+		size = sizeof(ival);
+		break;
+	default:
+		return 0;
+	}
+
+	/*
+	 * Copy out as much as fits, and report the full data length.  If not
+	 * all of the result fit in the given buffer, return ENOMEM along with
+	 * the partial result, just like the MIB service would.
+	 */
+	len = (oldlenp != NULL) ? *oldlenp : 0;
+	if (len > size)
+		len = size;
+	if (oldp != NULL)
+		memcpy(oldp, ptr, len);
+	if (oldlenp != NULL)
+		*oldlenp = size;
+
+	if (oldp != NULL && len < size) {
+		errno = ENOMEM;
+		*resp = -1;
+	} else
+		*resp = 0;
+	return 1;
+}
 
 /*
  * The sysctl(2) system call, handled by the MIB service.
@@ -12,8 +118,17 @@ __sysctl(const int * name, unsigned int namelen, void * oldp, size_t * oldlenp,
 	const void * newp, size_t newlen)
 {
 	message m;
+	struct minix_kerninfo *ki;
 	int r;
 
+	/*
+	 * Fast path: serve hot read-only nodes from the kernel information
+	 * page.  Writes and all other nodes take the IPC route below.
+	 */
+	if ((ki = _minix_kerninfo) != NULL && newp == NULL && newlen == 0 &&
+	    sysctl_fast(name, namelen, oldp, oldlenp, ki, &r))
+		return r;
+
 	memset(&m, 0, sizeof(m));
 	m.m_lc_mib_sysctl.oldp = (vir_bytes)oldp;
 	m.m_lc_mib_sysctl.oldlen = (oldlenp != NULL) ? *oldlenp : 0;
@@ -0,0 +1,39 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+/*
+ * Accept a connection on a listening socket, creating a new socket.  Unlike
+ * with accept(2), the new socket's O_NONBLOCK and close-on-exec flags are
+ * given by the SOCK_NONBLOCK and SOCK_CLOEXEC bits in 'flags', rather than
+ * inherited from the listening socket.
+ */
+int
+accept4(int fd, struct sockaddr * __restrict address,
+	socklen_t * __restrict address_len, int flags)
+{
+	message m;
+	int r;
+
+	if (address != NULL && address_len == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vfs_sockaddr.fd = fd;
+	m.m_lc_vfs_sockaddr.addr = (vir_bytes)address;
+	m.m_lc_vfs_sockaddr.addr_len = (address != NULL) ? *address_len : 0;
+	m.m_lc_vfs_sockaddr.flags = flags;
+
+	if ((r = _syscall(VFS_PROC_NR, VFS_ACCEPT4, &m)) < 0)
+		return -1;
+
+	if (address != NULL)
+		*address_len = m.m_vfs_lc_socklen.len;
+	return r;
+}
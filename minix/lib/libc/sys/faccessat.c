@@ -0,0 +1,19 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <unistd.h>
+
+int faccessat(int fd, const char *name, int mode, int flags)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_at.dirfd = fd;
+  m.m_lc_vfs_at.name = (vir_bytes)name;
+  m.m_lc_vfs_at.len = strlen(name) + 1;
+  m.m_lc_vfs_at.mode = mode;
+  m.m_lc_vfs_at.flags = flags;
+  return(_syscall(VFS_PROC_NR, VFS_ACCESSAT, &m));
+}
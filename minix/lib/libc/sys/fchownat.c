@@ -0,0 +1,20 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <unistd.h>
+
+int fchownat(int fd, const char *name, uid_t owner, gid_t grp, int flags)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_at.dirfd = fd;
+  m.m_lc_vfs_at.name = (vir_bytes)name;
+  m.m_lc_vfs_at.len = strlen(name) + 1;
+  m.m_lc_vfs_at.owner = owner;
+  m.m_lc_vfs_at.group = grp;
+  m.m_lc_vfs_at.flags = flags;
+  return(_syscall(VFS_PROC_NR, VFS_CHOWNAT, &m));
+}
@@ -0,0 +1,181 @@
+#define _SYSTEM	1
+#define _MINIX_SYSTEM	1
+
+#include <sys/cdefs.h>
+#include <lib.h>
+#include "namespace.h"
+
+#include <minix/futex.h>
+#include <minix/rs.h>
+
+#include <sys/types.h>
+#include <sys/atomic.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+static int get_ipc_endpt(endpoint_t *pt)
+{
+	return minix_rs_lookup("ipc", pt);
+}
+
+/* Wait on a word in a shared memory segment.  */
+int minix_futex_wait(int id, size_t offset, unsigned int value)
+{
+
+	return minix_futex_wait_robust(id, offset, value, 0);
+}
+
+/* Wait on a word in a shared memory segment, checking for owner death.  */
+int minix_futex_wait_robust(int id, size_t offset, unsigned int value,
+	pid_t owner)
+{
+	message m;
+	endpoint_t ipc_pt;
+
+	if (get_ipc_endpt(&ipc_pt) != OK) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_ipc_futex.id = id;
+	m.m_lc_ipc_futex.offset = offset;
+	m.m_lc_ipc_futex.value = value;
+	m.m_lc_ipc_futex.owner = owner;
+
+	return _syscall(ipc_pt, IPC_FUTEX_WAIT, &m);
+}
+
+/* Wake up waiters on a word in a shared memory segment.  */
+int minix_futex_wake(int id, size_t offset, unsigned int max)
+{
+	message m;
+	endpoint_t ipc_pt;
+
+	if (get_ipc_endpt(&ipc_pt) != OK) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_ipc_futex.id = id;
+	m.m_lc_ipc_futex.offset = offset;
+	m.m_lc_ipc_futex.max = max;
+
+	return _syscall(ipc_pt, IPC_FUTEX_WAKE, &m);
+}
+
+/*
+ * Acquire a robust mutex, blocking if necessary.  Return 0 on success, or
+ * EOWNERDEAD if the mutex was acquired but its previous owner died while
+ * holding it, or another error code on failure.
+ */
+int minix_robust_mutex_lock(int id, size_t offset,
+	volatile unsigned int * mutex)
+{
+	unsigned int pid, old;
+
+	pid = (unsigned int)getpid() & MINIX_FUTEX_TID_MASK;
+
+	for (;;) {
+		/* In the uncontended case, no system call is made at all. */
+		old = atomic_cas_32(mutex, 0, pid);
+		if (old == 0)
+			return 0;
+
+		/*
+		 * If the previous owner of the mutex died while holding it,
+		 * try to take over ownership, telling the caller that the
+		 * protected state may need to be repaired.
+		 */
+		if (old & MINIX_FUTEX_OWNERDEAD) {
+			if (atomic_cas_32(mutex, old, pid |
+			    MINIX_FUTEX_OWNERDEAD |
+			    (old & MINIX_FUTEX_WAITERS)) == old)
+				return EOWNERDEAD;
+
+			continue;
+		}
+
+		/* Tell the owner that it must wake us up when unlocking. */
+		if (!(old & MINIX_FUTEX_WAITERS)) {
+			if (atomic_cas_32(mutex, old,
+			    old | MINIX_FUTEX_WAITERS) != old)
+				continue;
+
+			old |= MINIX_FUTEX_WAITERS;
+		}
+
+		/*
+		 * Block until the owner wakes us up.  Any reason for not
+		 * blocking, or for being woken up, requires that we simply
+		 * reexamine the word, except for errors that render the word
+		 * itself unusable.
+		 */
+		if (minix_futex_wait_robust(id, offset, old,
+		    (pid_t)(old & MINIX_FUTEX_TID_MASK)) == -1) {
+			if (errno != EAGAIN && errno != EINTR &&
+			    errno != EOWNERDEAD)
+				return errno;
+		}
+	}
+}
+
+/*
+ * Release a robust mutex held by the calling process.  Return 0 on success,
+ * or EPERM if the calling process does not own the mutex.  If the mutex was
+ * acquired with an EOWNERDEAD result and has not been marked consistent, it
+ * remains in the owner-died state, and the next acquisition will report
+ * EOWNERDEAD again.
+ */
+int minix_robust_mutex_unlock(int id, size_t offset,
+	volatile unsigned int * mutex)
+{
+	unsigned int pid, old, new;
+
+	pid = (unsigned int)getpid() & MINIX_FUTEX_TID_MASK;
+
+	for (;;) {
+		old = *mutex;
+
+		if ((old & MINIX_FUTEX_TID_MASK) != pid)
+			return EPERM;
+
+		new = (old & MINIX_FUTEX_OWNERDEAD);
+
+		if (atomic_cas_32(mutex, old, new) != old)
+			continue;
+
+		if (old & MINIX_FUTEX_WAITERS)
+			(void)minix_futex_wake(id, offset, 1);
+
+		return 0;
+	}
+}
+
+/*
+ * Mark a robust mutex, held by the calling process after an EOWNERDEAD
+ * acquisition, as consistent again.  Return 0 on success, EPERM if the
+ * calling process does not own the mutex, or EINVAL if the mutex is not in
+ * the owner-died state.
+ */
+int minix_robust_mutex_consistent(volatile unsigned int * mutex)
+{
+	unsigned int pid, old;
+
+	pid = (unsigned int)getpid() & MINIX_FUTEX_TID_MASK;
+
+	for (;;) {
+		old = *mutex;
+
+		if ((old & MINIX_FUTEX_TID_MASK) != pid)
+			return EPERM;
+		if (!(old & MINIX_FUTEX_OWNERDEAD))
+			return EINVAL;
+
+		if (atomic_cas_32(mutex, old,
+		    old & ~MINIX_FUTEX_OWNERDEAD) == old)
+			return 0;
+	}
+}
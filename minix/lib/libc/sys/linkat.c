@@ -0,0 +1,21 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <unistd.h>
+
+int linkat(int fd1, const char *name, int fd2, const char *name2, int flags)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_linkat.dirfd1 = fd1;
+  m.m_lc_vfs_linkat.name1 = (vir_bytes)name;
+  m.m_lc_vfs_linkat.len1 = strlen(name) + 1;
+  m.m_lc_vfs_linkat.dirfd2 = fd2;
+  m.m_lc_vfs_linkat.name2 = (vir_bytes)name2;
+  m.m_lc_vfs_linkat.len2 = strlen(name2) + 1;
+  m.m_lc_vfs_linkat.flags = flags;
+  return(_syscall(VFS_PROC_NR, VFS_LINKAT, &m));
+}
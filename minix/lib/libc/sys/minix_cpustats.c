@@ -0,0 +1,56 @@
+#define _MINIX_SYSTEM	1
+
+#include <sys/cdefs.h>
+
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/type.h>
+#include <minix/minlib.h>
+
+#include <errno.h>
+
+extern struct minix_kerninfo *_minix_kerninfo;
+
+/*
+ * Retrieve per-CPU statistics counters, getloadavg(3) style: fill up to
+ * 'nelem' entries of 'kcs' with a snapshot of the statistics of as many CPUs,
+ * and return the number of entries filled, or -1 with errno set on failure.
+ * The counters are read directly from the information page that the kernel
+ * maps into all processes, so sampling them involves no system calls at all.
+ * Since the kernel updates the counters while we copy them, the snapshot is
+ * only approximately consistent; for utilization and rate computations based
+ * on the difference between two snapshots, this is not a problem.
+ */
+int
+minix_getcpustats(struct kcpustats * kcs, int nelem)
+{
+	struct minix_kerninfo *ki;
+	volatile struct kcpustats *src;
+	int i, ncpu;
+
+	if (nelem < 1) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if ((ki = _minix_kerninfo) == NULL ||
+	    !(ki->ki_flags & MINIX_KIF_CPUSTATS)) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	ncpu = ki->machine->processors_count;
+	if (nelem > ncpu)
+		nelem = ncpu;
+
+	src = ki->kcpustats;
+	for (i = 0; i < nelem; i++, src++) {
+		kcs[i].kcs_busy_cycles = src->kcs_busy_cycles;
+		kcs[i].kcs_idle_cycles = src->kcs_idle_cycles;
+		kcs[i].kcs_ctxsw = src->kcs_ctxsw;
+		kcs[i].kcs_rqlen = src->kcs_rqlen;
+		kcs[i].kcs_spare = 0;
+	}
+
+	return nelem;
+}
@@ -0,0 +1,29 @@
+#define _SYSTEM	1
+#define _MINIX_SYSTEM	1
+
+#include <sys/cdefs.h>
+
+#include <minix/sysctl.h>
+
+#include <errno.h>
+#include <lib.h>
+
+/*
+ * Retrieve a snapshot of the entire process table with a single sysctl(2)
+ * call, rather than one call per process.  The caller must supply a buffer
+ * large enough for NR_TASKS + NR_PROCS entries; the result is indexed by
+ * kernel slot, and unused slots have their endpoint set to NONE.  Return 0 on
+ * success, or -1 with errno set on failure.
+ */
+int
+minix_getproctab(struct minix_proc_data * ptab, size_t size)
+{
+	int mib[3] = { CTL_MINIX, MINIX_PROC, PROC_TAB };
+	size_t oldlen;
+
+	oldlen = size;
+	if (__sysctl(mib, __arraycount(mib), ptab, &oldlen, NULL, 0) != 0)
+		return -1;
+
+	return 0;
+}
@@ -0,0 +1,70 @@
+#define _SYSTEM	1
+#define _MINIX_SYSTEM	1
+
+#include <sys/cdefs.h>
+#include "namespace.h"
+
+#include <minix/shm.h>
+
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Fold a shared memory object name into a System V IPC key, using the 32-bit
+ * FNV-1a hash.  The result is truncated to a positive, nonzero value, so that
+ * it can never collide with IPC_PRIVATE.
+ */
+static key_t name_to_key(const char *name)
+{
+	uint32_t hash;
+
+	hash = 2166136261;
+	while (*name != '\0') {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619;
+	}
+
+	hash &= 0x7fffffff;
+	if (hash == (uint32_t)IPC_PRIVATE)
+		hash = 1;
+
+	return (key_t)hash;
+}
+
+/* Open, and possibly create, a named shared memory segment.  */
+int minix_shm_open(const char *name, int oflag, mode_t mode, size_t size)
+{
+	int flag;
+
+	if (name == NULL || name[0] == '\0') {
+		errno = EINVAL;
+		return -1;
+	}
+
+	flag = mode & ACCESSPERMS;
+	if (oflag & O_CREAT)
+		flag |= IPC_CREAT;
+	if (oflag & O_EXCL)
+		flag |= IPC_EXCL;
+
+	return shmget(name_to_key(name), size, flag);
+}
+
+/* Mark a named shared memory segment for removal.  */
+int minix_shm_unlink(const char *name)
+{
+	int id;
+
+	if (name == NULL || name[0] == '\0') {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if ((id = shmget(name_to_key(name), 0, 0)) == -1)
+		return -1;
+
+	return shmctl(id, IPC_RMID, NULL);
+}
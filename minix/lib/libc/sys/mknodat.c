@@ -0,0 +1,19 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <sys/stat.h>
+
+int mknodat(int fd, const char *name, mode_t mode, dev_t dev)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_mknodat.dirfd = fd;
+  m.m_lc_vfs_mknodat.name = (vir_bytes)name;
+  m.m_lc_vfs_mknodat.len = strlen(name) + 1;
+  m.m_lc_vfs_mknodat.mode = mode;
+  m.m_lc_vfs_mknodat.device = dev;
+  return(_syscall(VFS_PROC_NR, VFS_MKNODAT, &m));
+}
@@ -84,6 +84,68 @@ int munmap(void *addr, size_t len)
 	return _syscall(VM_PROC_NR, VM_MUNMAP, &m);
 }
 
+int madvise(void *addr, size_t len, int advice)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vm_madvise.addr = addr;
+	m.m_lc_vm_madvise.len = len;
+	m.m_lc_vm_madvise.advice = advice;
+
+	return _syscall(VM_PROC_NR, VM_MADVISE, &m);
+}
+
+int posix_madvise(void *addr, size_t len, int advice)
+{
+	/* Unlike madvise(), this returns the error instead of setting errno. */
+	if (madvise(addr, len, advice) < 0)
+		return errno;
+
+	return 0;
+}
+
+int mlock(const void *addr, size_t len)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vm_mlock.addr = __UNCONST(addr);
+	m.m_lc_vm_mlock.len = len;
+
+	return _syscall(VM_PROC_NR, VM_MLOCK, &m);
+}
+
+int munlock(const void *addr, size_t len)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vm_mlock.addr = __UNCONST(addr);
+	m.m_lc_vm_mlock.len = len;
+
+	return _syscall(VM_PROC_NR, VM_MUNLOCK, &m);
+}
+
+int mlockall(int flags)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vm_mlock.flags = flags;
+
+	return _syscall(VM_PROC_NR, VM_MLOCKALL, &m);
+}
+
+int munlockall(void)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+
+	return _syscall(VM_PROC_NR, VM_MUNLOCKALL, &m);
+}
+
 
 void *vm_remap(endpoint_t d,
 			endpoint_t s,
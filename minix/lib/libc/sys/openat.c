@@ -0,0 +1,24 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <string.h>
+
+int openat(int fd, const char *name, int flags, ...)
+{
+  va_list argp;
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  va_start(argp, flags);
+  m.m_lc_vfs_at.dirfd = fd;
+  m.m_lc_vfs_at.name = (vir_bytes)name;
+  m.m_lc_vfs_at.len = strlen(name) + 1;
+  m.m_lc_vfs_at.flags = flags;
+  if (flags & O_CREAT)
+	m.m_lc_vfs_at.mode = va_arg(argp, mode_t);
+  va_end(argp);
+  return(_syscall(VFS_PROC_NR, VFS_OPENAT, &m));
+}
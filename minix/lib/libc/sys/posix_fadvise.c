@@ -0,0 +1,26 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+int posix_fadvise(int fd, off_t offset, off_t len, int advice)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_fadvise.fd = fd;
+  m.m_lc_vfs_fadvise.offset = offset;
+  m.m_lc_vfs_fadvise.len = len;
+  m.m_lc_vfs_fadvise.advice = advice;
+
+  /* Unlike most calls, posix_fadvise(2) returns an error number rather than
+   * setting errno.
+   */
+  if (_syscall(VFS_PROC_NR, VFS_FADVISE, &m) < 0)
+	return(errno);
+
+  return(0);
+}
@@ -209,9 +209,11 @@ posix_spawn(pid_t * __restrict pid, const char * __restrict path,
 	int r, error, pfd[2];
 
 	/*
-	 * Due to the lack of vfork() in Minix, an alternative solution with
-	 * pipes is used. The writing end is set to close on exec() and the
-	 * parent performs a read() on it.
+	 * Minix's vfork() gives the child a copy-on-write copy of the
+	 * address space rather than sharing it, so the child cannot report
+	 * an exec failure through the parent's memory.  Instead, a pipe is
+	 * used: the writing end is set to close on exec() and the parent
+	 * performs a read() on it.
 	 *
 	 * On success, a successful 0-length read happens.
 	 * On failure, the child writes the errno to the pipe before exiting,
@@ -222,7 +224,12 @@ posix_spawn(pid_t * __restrict pid, const char * __restrict path,
 	if (pipe(pfd) == -1)
 		return errno;
 
-	p = fork();
+	/*
+	 * vfork() keeps the parent blocked until the child execs or exits,
+	 * so the child can set itself up without competing with the parent
+	 * for memory and CPU time.
+	 */
+	p = vfork();
 	switch (p) {
 	case -1:
 		close(pfd[0]);
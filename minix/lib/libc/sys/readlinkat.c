@@ -0,0 +1,19 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <unistd.h>
+
+ssize_t readlinkat(int fd, const char *name, char *buffer, size_t bufsiz)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_at.dirfd = fd;
+  m.m_lc_vfs_at.name = (vir_bytes)name;
+  m.m_lc_vfs_at.len = strlen(name) + 1;
+  m.m_lc_vfs_at.buf = (vir_bytes)buffer;
+  m.m_lc_vfs_at.bufsize = bufsiz;
+  return(_syscall(VFS_PROC_NR, VFS_READLINKAT, &m));
+}
@@ -0,0 +1,67 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+/*
+ * Receive multiple messages from a socket in one system call.  Return the
+ * number of messages actually received, with the msg_len field of each
+ * received message updated accordingly.
+ */
+int
+recvmmsg(int fd, struct mmsghdr * mmsg, unsigned int vlen, unsigned int flags,
+	struct timespec * timeout)
+{
+	message m;
+	unsigned int i;
+	ssize_t r;
+
+	/* The receive timeout is not supported. */
+	if (timeout != NULL) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	/*
+	 * As for sendmmsg(2): messages with multi-element vectors cannot be
+	 * forwarded to VFS as a batch, so fall back to receiving the messages
+	 * one by one in that case.
+	 */
+	for (i = 0; i < vlen; i++) {
+		if (mmsg[i].msg_hdr.msg_iovlen > 1)
+			break;
+	}
+
+	if (i == vlen) {
+		memset(&m, 0, sizeof(m));
+		m.m_lc_vfs_sockmmsg.fd = fd;
+		m.m_lc_vfs_sockmmsg.mmsgbuf = (vir_bytes)mmsg;
+		m.m_lc_vfs_sockmmsg.vlen = vlen;
+		m.m_lc_vfs_sockmmsg.flags = (int)flags;
+
+		r = _syscall(VFS_PROC_NR, VFS_RECVMMSG, &m);
+		if (r != -1 || errno != ENOSYS)
+			return (int)r;
+
+		/* Fall back for older VFS implementations. */
+	}
+
+	for (i = 0; i < vlen; i++) {
+		r = recvmsg(fd, &mmsg[i].msg_hdr,
+		    (int)(flags & ~MSG_WAITFORONE));
+		if (r < 0)
+			break;
+
+		mmsg[i].msg_len = (unsigned int)r;
+
+		if (flags & MSG_WAITFORONE)
+			flags |= MSG_DONTWAIT;
+	}
+
+	if (i == 0)
+		return -1;	/* errno is already set */
+	return (int)i;
+}
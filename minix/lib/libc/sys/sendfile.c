@@ -0,0 +1,27 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <minix/minlib.h>
+
+/*
+ * Transfer data from a regular file to a socket, without passing the data
+ * through the calling process.  The file is read starting at the given
+ * offset; the file position of neither file descriptor is changed.  Return
+ * the number of bytes actually sent, which may be fewer than requested.
+ */
+ssize_t
+sendfile(int out_fd, int in_fd, off_t offset, size_t count)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vfs_sendfile.out_fd = out_fd;
+	m.m_lc_vfs_sendfile.in_fd = in_fd;
+	m.m_lc_vfs_sendfile.offset = offset;
+	m.m_lc_vfs_sendfile.len = count;
+
+	return _syscall(VFS_PROC_NR, VFS_SENDFILE, &m);
+}
@@ -0,0 +1,59 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+/*
+ * Send multiple messages on a socket in one system call.  Return the number
+ * of messages actually sent, with the msg_len field of each sent message
+ * updated accordingly.
+ */
+int
+sendmmsg(int fd, struct mmsghdr * mmsg, unsigned int vlen, unsigned int flags)
+{
+	message m;
+	unsigned int i;
+	ssize_t r;
+
+	/*
+	 * VFS does not support vectors with more than one element (see
+	 * sendmsg(2)), and unlike for the single-message calls, coalescing
+	 * every element of a whole batch here would largely defeat the
+	 * purpose of the call.  Thus, if any of the messages has a
+	 * multi-element vector, simply fall back to sending the messages one
+	 * by one.
+	 */
+	for (i = 0; i < vlen; i++) {
+		if (mmsg[i].msg_hdr.msg_iovlen > 1)
+			break;
+	}
+
+	if (i == vlen) {
+		memset(&m, 0, sizeof(m));
+		m.m_lc_vfs_sockmmsg.fd = fd;
+		m.m_lc_vfs_sockmmsg.mmsgbuf = (vir_bytes)mmsg;
+		m.m_lc_vfs_sockmmsg.vlen = vlen;
+		m.m_lc_vfs_sockmmsg.flags = (int)flags;
+
+		r = _syscall(VFS_PROC_NR, VFS_SENDMMSG, &m);
+		if (r != -1 || errno != ENOSYS)
+			return (int)r;
+
+		/* Fall back for older VFS implementations. */
+	}
+
+	for (i = 0; i < vlen; i++) {
+		r = sendmsg(fd, &mmsg[i].msg_hdr, (int)flags);
+		if (r < 0)
+			break;
+
+		mmsg[i].msg_len = (unsigned int)r;
+	}
+
+	if (i == 0)
+		return -1;	/* errno is already set */
+	return (int)i;
+}
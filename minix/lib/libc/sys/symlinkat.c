@@ -0,0 +1,19 @@
+#include <sys/cdefs.h>
+#include "namespace.h"
+#include <lib.h>
+
+#include <string.h>
+#include <unistd.h>
+
+int symlinkat(const char *name, int fd, const char *name2)
+{
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lc_vfs_linkat.name1 = (vir_bytes)name;
+  m.m_lc_vfs_linkat.len1 = strlen(name) + 1;
+  m.m_lc_vfs_linkat.dirfd2 = fd;
+  m.m_lc_vfs_linkat.name2 = (vir_bytes)name2;
+  m.m_lc_vfs_linkat.len2 = strlen(name2) + 1;
+  return(_syscall(VFS_PROC_NR, VFS_SYMLINKAT, &m));
+}
@@ -8,19 +8,16 @@
 #include <limits.h>
 #include <errno.h>
 
-/* Implement a very large but not complete subset of the utimensat()
- * Posix:2008/XOpen-7 function.
- * Are handled the following cases:
- * . utimensat(AT_FDCWD, "/some/absolute/path", , )
- * . utimensat(AT_FDCWD, "some/path", , )
- * . utimensat(fd, "/some/absolute/path", , ) although fd is useless here
- * Are not handled the following cases:
- * . utimensat(fd, "some/path", , ) path to a file relative to some open fd
+/* Implement the utimensat() Posix:2008/XOpen-7 function.  A path relative to
+ * an open directory file descriptor requires the newer UTIMENSAT call number,
+ * which, unlike UTIMENS, has a meaningful fd field for named files.  The
+ * other cases keep using UTIMENS for compatibility with older VFS servers.
  */
 int utimensat(int fd, const char *name, const struct timespec tv[2],
     int flags)
 {
   message m;
+  int call;
   static const struct timespec now[2] = { {0, UTIME_NOW}, {0, UTIME_NOW} };
 
   if (tv == NULL) tv = now;
@@ -33,10 +30,6 @@ int utimensat(int fd, const char *name, const struct timespec tv[2],
 	errno = ENOENT;
 	return -1;
   }
-  if (fd != AT_FDCWD && name[0] != '/') { /* Not supported */
-	errno = EINVAL;
-	return -1;
-  }
 
   if ((unsigned)flags > SHRT_MAX) {
 	errno = EINVAL;
@@ -52,5 +45,11 @@ int utimensat(int fd, const char *name, const struct timespec tv[2],
   m.m_vfs_utimens.mnsec = tv[1].tv_nsec;
   m.m_vfs_utimens.flags = flags;
 
-  return(_syscall(VFS_PROC_NR, VFS_UTIMENS, &m));
+  if (fd != AT_FDCWD && name[0] != '/') {
+	m.m_vfs_utimens.fd = fd;
+	call = VFS_UTIMENSAT;
+  } else
+	call = VFS_UTIMENS;
+
+  return(_syscall(VFS_PROC_NR, call, &m));
 }
@@ -126,6 +126,15 @@ readv(int fd, const struct iovec * iov, int iovcnt)
 	 * intermediate buffer.  This approach is preferred over multiple read
 	 * calls, because the actual I/O operation has to be atomic.
 	 */
+
+	/*
+	 * A single-element vector needs no intermediate buffer: the one
+	 * underlying call is atomic by itself.  This saves an allocation and
+	 * a full copy of the data on a common call pattern.
+	 */
+	if (iovcnt == 1)
+		return read(fd, iov[0].iov_base, iov[0].iov_len);
+
 	if ((r = _vectorio_setup(iov, iovcnt, &ptr, _VECTORIO_READ)) <= 0)
 		return r;
 
@@ -150,6 +159,11 @@ writev(int fd, const struct iovec * iov, int iovcnt)
 	 * an intermediate buffer.  This approach is preferred over multiple
 	 * write calls, because the actual I/O operation has to be atomic.
 	 */
+
+	/* As with readv, bypass the intermediate buffer when possible. */
+	if (iovcnt == 1)
+		return write(fd, iov[0].iov_base, iov[0].iov_len);
+
 	if ((r = _vectorio_setup(iov, iovcnt, &ptr, _VECTORIO_WRITE)) <= 0)
 		return r;
 
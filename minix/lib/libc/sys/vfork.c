@@ -13,6 +13,10 @@ pid_t vfork(void)
 {
   message m;
 
+  /* The child gets a copy-on-write copy of the address space rather than
+   * borrowing the parent's, but the parent is blocked until the child
+   * performs an exec or exits, as vfork semantics require.
+   */
   memset(&m, 0, sizeof(m));
-  return(_syscall(PM_PROC_NR, PM_FORK, &m));
+  return(_syscall(PM_PROC_NR, PM_VFORK, &m));
 }
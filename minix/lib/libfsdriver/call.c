@@ -392,6 +392,25 @@ fsdriver_inhibread(const struct fsdriver * __restrict fdp,
 	return OK;
 }
 
+/*
+ * Process a FADVISE request from VFS.
+ */
+int
+fsdriver_fadvise(const struct fsdriver * __restrict fdp,
+	const message * __restrict m_in, message * __restrict __unused m_out)
+{
+	ino_t ino_nr;
+	int advice;
+
+	ino_nr = m_in->m_vfs_fs_fadvise.inode;
+	advice = m_in->m_vfs_fs_fadvise.advice;
+
+	if (fdp->fdr_fadvise == NULL)
+		return ENOSYS;
+
+	return fdp->fdr_fadvise(ino_nr, advice);
+}
+
 /*
  * Process a CREATE request from VFS.
  */
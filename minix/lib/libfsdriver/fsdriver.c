@@ -5,8 +5,12 @@
 dev_t fsdriver_device;
 ino_t fsdriver_root;
 int fsdriver_mounted = FALSE;
+int fsdriver_running;
 
-static int fsdriver_running;
+/* Per-request-type call counts and time spent, for the file server to
+ * publish as it sees fit.
+ */
+struct fsdriver_stat fsdriver_stats[NREQS];
 
 /*
  * Process an incoming VFS request, and send a reply.  If the message is not
@@ -20,6 +24,7 @@ fsdriver_process(const struct fsdriver * __restrict fdp,
 {
 	message m_out;
 	unsigned int call_nr;
+	u64_t tsc_start, tsc_end;
 	int r, transid;
 
 	/* Is this a file system request at all? */
@@ -39,9 +44,15 @@ fsdriver_process(const struct fsdriver * __restrict fdp,
 	if (fsdriver_mounted || call_nr == REQ_READSUPER) {
 		call_nr -= FS_BASE;	/* unsigned; wrapping is intended */
 
-		if (call_nr < NREQS && fsdriver_callvec[call_nr] != NULL)
+		if (call_nr < NREQS && fsdriver_callvec[call_nr] != NULL) {
+			read_tsc_64(&tsc_start);
 			r = (fsdriver_callvec[call_nr])(fdp, m_ptr, &m_out);
-		else
+			read_tsc_64(&tsc_end);
+
+			fsdriver_stats[call_nr].fst_calls++;
+			fsdriver_stats[call_nr].fst_cycles +=
+			    tsc_end - tsc_start;
+		} else
 			r = ENOSYS;
 	} else
 		r = EINVAL;
@@ -19,6 +19,8 @@ extern int fsdriver_chmod(const struct fsdriver * __restrict,
 	const message * __restrict, message * __restrict);
 extern int fsdriver_inhibread(const struct fsdriver * __restrict,
 	const message * __restrict, message * __restrict);
+extern int fsdriver_fadvise(const struct fsdriver * __restrict,
+	const message * __restrict, message * __restrict);
 extern int fsdriver_stat(const struct fsdriver * __restrict,
 	const message * __restrict, message * __restrict);
 extern int fsdriver_utime(const struct fsdriver * __restrict,
@@ -78,6 +80,7 @@ extern int fsdriver_getname(endpoint_t endpt, cp_grant_id_t grant, size_t len,
 extern dev_t fsdriver_device;
 extern ino_t fsdriver_root;
 extern int fsdriver_mounted;
+extern int fsdriver_running;
 extern int (*fsdriver_callvec[])(const struct fsdriver * __restrict,
 	const message * __restrict, message * __restrict);
 
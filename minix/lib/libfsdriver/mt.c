@@ -0,0 +1,459 @@
+/*
+ * This file contains the optional multithreaded file server interface, which
+ * mirrors the design of libblockdriver's multithreaded driver interface.  A
+ * master thread receives incoming messages and hands the actual processing of
+ * file system requests to a pool of worker threads, so that requests that hit
+ * the file system's cache need not wait for an earlier request that is
+ * blocked on disk I/O.
+ *
+ * The entry points into this file are:
+ *   fsdriver_mt_task:	the multithreaded main message loop of a file server
+ *
+ * Concurrency rules.  Requests that only read from a single file (read, peek,
+ * getdents, rdlink, stat) may be processed concurrently, with the restriction
+ * that at most one such request is in flight for any particular inode at any
+ * time.  All other requests are processed exclusively, with no other request
+ * active at the same time: even a seemingly innocent write may allocate
+ * blocks and thus update global file system metadata.  Messages that are not
+ * file system requests from VFS are handled directly from the master thread.
+ *
+ * Note that since mthread threads are scheduled cooperatively, the file
+ * system itself need only be prepared to deal with concurrency across its
+ * blocking calls: the typical case is another thread entering the block cache
+ * while one thread is waiting for the disk driver.  A file system that wants
+ * its requests to be processed concurrently at all must also report the
+ * RES_THREADED flag to VFS as part of its mount reply, since VFS will send
+ * one request at a time otherwise.
+ */
+
+#include "fsdriver.h"
+#include <minix/mthread.h>
+
+/* Worker thread stack size. */
+#ifdef _MINIX_MAGIC
+#define STACK_SIZE	32768
+#else
+#define STACK_SIZE	8192
+#endif
+
+/* The maximum number of worker threads. */
+#define MAX_WORKERS	16
+
+/* The number of slots in the request queue. This should be no smaller than
+ * the maximum number of requests that VFS may send at once, or VFS will be
+ * told to try again, which it does not take lightly.
+ */
+#define MQ_SIZE		64
+
+typedef enum {
+  STATE_DEAD,
+  STATE_RUNNING,
+  STATE_BUSY,
+  STATE_EXITED
+} worker_state;
+
+/* Structure with information about a worker thread. */
+typedef struct {
+  unsigned int id;
+  worker_state state;
+  mthread_thread_t mthread;
+} worker_t;
+
+/* Structure with information about an inode with an active read request. */
+typedef struct {
+  ino_t ino_nr;
+  unsigned int count;
+  mthread_mutex_t lock;
+} ino_lock_t;
+
+static const struct fsdriver *fsdtab;
+
+static worker_t worker[MAX_WORKERS];
+static unsigned int nr_workers;
+
+static worker_t *exited[MAX_WORKERS];
+static unsigned int num_exited = 0;
+
+static struct {
+  message mess;
+  int ipc_status;
+} queue[MQ_SIZE];
+static unsigned int q_head = 0, q_count = 0;
+static mthread_event_t q_event;
+
+/* There can be no more active and blocked read requests than worker threads,
+ * and thus, no more inode locks in use than that either.
+ */
+static ino_lock_t ino_lock[MAX_WORKERS];
+
+static mthread_rwlock_t barrier;
+
+/*
+ * Return whether the given request may be processed concurrently with other
+ * requests, because it only reads from a single file.
+ */
+static int
+is_read_req(unsigned int call_nr)
+{
+
+	switch (call_nr) {
+	case REQ_READ:
+	case REQ_PEEK:
+	case REQ_GETDENTS:
+	case REQ_RDLINK:
+	case REQ_STAT:
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+}
+
+/*
+ * Return the number of the inode targeted by the given read request.
+ */
+static ino_t
+req_inode(const message * m_ptr, unsigned int call_nr)
+{
+
+	switch (call_nr) {
+	case REQ_READ:
+	case REQ_PEEK:
+		return m_ptr->m_vfs_fs_readwrite.inode;
+	case REQ_GETDENTS:
+		return m_ptr->m_vfs_fs_getdents.inode;
+	case REQ_RDLINK:
+		return m_ptr->m_vfs_fs_rdlink.inode;
+	case REQ_STAT:
+		return m_ptr->m_vfs_fs_stat.inode;
+	default:
+		panic("fsdriver: bad read request %u", call_nr);
+	}
+}
+
+/*
+ * Acquire the lock for the given inode, waiting for any other thread that
+ * currently holds it. Return the lock, for a later release.
+ */
+static ino_lock_t *
+ino_lock_acquire(ino_t ino_nr)
+{
+	ino_lock_t *ilp, *free_ilp;
+	unsigned int i;
+
+	free_ilp = NULL;
+	for (i = 0; i < MAX_WORKERS; i++) {
+		ilp = &ino_lock[i];
+
+		if (ilp->count > 0 && ilp->ino_nr == ino_nr)
+			break;
+		if (ilp->count == 0 && free_ilp == NULL)
+			free_ilp = ilp;
+	}
+
+	if (i == MAX_WORKERS) {
+		/* There must always be a free slot (see above). */
+		assert(free_ilp != NULL);
+
+		ilp = free_ilp;
+		ilp->ino_nr = ino_nr;
+	}
+
+	ilp->count++;
+	mthread_mutex_lock(&ilp->lock);
+
+	return ilp;
+}
+
+/*
+ * Release a previously acquired inode lock.
+ */
+static void
+ino_lock_release(ino_lock_t * ilp)
+{
+
+	mthread_mutex_unlock(&ilp->lock);
+	assert(ilp->count > 0);
+	ilp->count--;
+}
+
+/*
+ * Dequeue a request from the request queue, blocking the current worker
+ * thread if necessary. Return TRUE on success, or FALSE if the thread should
+ * terminate instead.
+ */
+static int
+dequeue(message * m_dst, int * ipc_status)
+{
+
+	while (q_count == 0) {
+		mthread_event_wait(&q_event);
+
+		/* We may have been woken up to terminate the thread. */
+		if (!fsdriver_running && !fsdriver_mounted)
+			return FALSE;
+	}
+
+	*m_dst = queue[q_head].mess;
+	*ipc_status = queue[q_head].ipc_status;
+	q_head = (q_head + 1) % MQ_SIZE;
+	q_count--;
+
+	return TRUE;
+}
+
+/*
+ * The worker thread loop: dequeue requests, take the locks appropriate for
+ * each request, and process the request, until termination is requested.
+ */
+static void *
+worker_thread(void * param)
+{
+	worker_t *wp;
+	ino_lock_t *ilp;
+	message m;
+	unsigned int call_nr;
+	int ipc_status;
+
+	wp = (worker_t *)param;
+
+	while (fsdriver_running || fsdriver_mounted) {
+		if (!dequeue(&m, &ipc_status))
+			break;
+
+		wp->state = STATE_BUSY;
+
+		/*
+		 * Single-file read requests take the read barrier lock and
+		 * the lock for the targeted inode. All other requests take
+		 * the write barrier lock, and thus run by themselves.
+		 */
+		call_nr = TRNS_DEL_ID(m.m_type);
+
+		if (is_read_req(call_nr)) {
+			mthread_rwlock_rdlock(&barrier);
+
+			ilp = ino_lock_acquire(req_inode(&m, call_nr));
+		} else {
+			mthread_rwlock_wrlock(&barrier);
+
+			ilp = NULL;
+		}
+
+		/* Handle the request, and send the reply asynchronously. */
+		fsdriver_process(fsdtab, &m, ipc_status, TRUE /*asyn_reply*/);
+
+		if (ilp != NULL)
+			ino_lock_release(ilp);
+		mthread_rwlock_unlock(&barrier);
+
+		wp->state = STATE_RUNNING;
+	}
+
+	wp->state = STATE_EXITED;
+
+	exited[num_exited++] = wp;
+
+	return NULL;
+}
+
+/*
+ * Start a new worker thread.
+ */
+static void
+master_create_worker(worker_t * wp, unsigned int id)
+{
+	mthread_attr_t attr;
+	int r;
+
+	wp->id = id;
+	wp->state = STATE_RUNNING;
+
+	r = mthread_attr_init(&attr);
+	if (r != 0)
+		panic("fsdriver: could not initialize attributes (%d)", r);
+
+	r = mthread_attr_setstacksize(&attr, STACK_SIZE);
+	if (r != 0)
+		panic("fsdriver: could not set stack size (%d)", r);
+
+	r = mthread_create(&wp->mthread, &attr, worker_thread, (void *)wp);
+	if (r != 0)
+		panic("fsdriver: could not start thread %u (%d)", id, r);
+
+	mthread_attr_destroy(&attr);
+}
+
+/*
+ * Clean up the remains of all exited worker threads.
+ */
+static void
+master_handle_exits(void)
+{
+	worker_t *wp;
+	unsigned int i;
+
+	for (i = 0; i < num_exited; i++) {
+		wp = exited[i];
+
+		assert(wp->state == STATE_EXITED);
+
+		if (mthread_join(wp->mthread, NULL))
+			panic("fsdriver: could not join thread %u", wp->id);
+
+		wp->state = STATE_DEAD;
+	}
+
+	num_exited = 0;
+}
+
+/*
+ * Let worker threads run, and clean up any exited threads.
+ */
+static void
+master_yield(void)
+{
+
+	mthread_yield_all();
+
+	if (num_exited > 0)
+		master_handle_exits();
+}
+
+/*
+ * Send a reply for a request that could not be processed, from the master
+ * thread. The master thread must not block on sending.
+ */
+static void
+master_reply(const message * m_ptr, int result)
+{
+	message m_out;
+	int r;
+
+	memset(&m_out, 0, sizeof(m_out));
+	m_out.m_type = TRNS_ADD_ID(result, TRNS_GET_ID(m_ptr->m_type));
+
+	if ((r = asynsend(m_ptr->m_source, &m_out)) != OK)
+		printf("fsdriver: sending reply failed (%d)\n", r);
+}
+
+/*
+ * Dispatch an incoming message. File system requests are enqueued for
+ * processing by a worker thread, starting a new thread first if all running
+ * threads are busy and the thread limit has not been reached yet. All other
+ * messages are handled immediately from the master thread.
+ */
+static void
+master_handle_message(const message * m_ptr, int ipc_status)
+{
+	worker_t *wp;
+	unsigned int wid;
+
+	/*
+	 * If this is not a file system request from VFS, let the master
+	 * thread process it right away: such messages should not block, and
+	 * this way they need not wait for the write barrier lock.
+	 */
+	if (is_ipc_notify(ipc_status) || m_ptr->m_source != VFS_PROC_NR) {
+		fsdriver_process(fsdtab, m_ptr, ipc_status, TRUE);
+
+		return;
+	}
+
+	/* Find a non-busy worker thread, starting it first if needed. */
+	for (wid = 0; wid < nr_workers; wid++)
+		if (worker[wid].state != STATE_BUSY)
+			break;
+
+	if (wid < nr_workers) {
+		wp = &worker[wid];
+
+		assert(wp->state != STATE_EXITED);
+
+		if (wp->state == STATE_DEAD)
+			master_create_worker(wp, wid);
+	}
+
+	/*
+	 * Enqueue the request. The queue is large enough to hold the maximum
+	 * number of requests that VFS will send us at any time, so a full
+	 * queue means that the sender is misbehaving; push back in that case.
+	 */
+	if (q_count == MQ_SIZE) {
+		master_reply(m_ptr, EBUSY);
+
+		return;
+	}
+
+	queue[(q_head + q_count) % MQ_SIZE].mess = *m_ptr;
+	queue[(q_head + q_count) % MQ_SIZE].ipc_status = ipc_status;
+	q_count++;
+
+	mthread_event_fire(&q_event);
+}
+
+/*
+ * Main program of any multithreaded file server task. The given number of
+ * worker threads is the maximum number of requests that will be processed
+ * concurrently, within the limits of the library; worker threads are started
+ * only as the actual workload requires them.
+ */
+void
+fsdriver_mt_task(struct fsdriver * fdp, unsigned int workers)
+{
+	message mess;
+	unsigned int i;
+	int r, ipc_status;
+
+	fsdtab = fdp;
+
+	if (workers < 1)
+		workers = 1;
+	if (workers > MAX_WORKERS)
+		workers = MAX_WORKERS;
+	nr_workers = workers;
+
+	mthread_event_init(&q_event);
+	mthread_rwlock_init(&barrier);
+
+	for (i = 0; i < MAX_WORKERS; i++) {
+		worker[i].state = STATE_DEAD;
+
+		ino_lock[i].count = 0;
+		mthread_mutex_init(&ino_lock[i].lock, NULL);
+	}
+
+	fsdriver_running = TRUE;
+
+	while (fsdriver_running || fsdriver_mounted) {
+		if ((r = sef_receive_status(ANY, &mess, &ipc_status)) != OK) {
+			if (r == EINTR)
+				continue;	/* sef_cancel() was called */
+
+			panic("fsdriver: sef_receive_status failed: %d", r);
+		}
+
+		master_handle_message(&mess, ipc_status);
+
+		master_yield();
+	}
+
+	/* Wake up all worker threads, and wait for them to terminate. */
+	for (;;) {
+		for (i = 0; i < nr_workers; i++)
+			if (worker[i].state != STATE_DEAD)
+				break;
+		if (i == nr_workers)
+			break;
+
+		mthread_event_fire_all(&q_event);
+
+		master_yield();
+	}
+
+	/* Free up resources. */
+	mthread_event_destroy(&q_event);
+	mthread_rwlock_destroy(&barrier);
+	for (i = 0; i < MAX_WORKERS; i++)
+		mthread_mutex_destroy(&ino_lock[i].lock);
+}
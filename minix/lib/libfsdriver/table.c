@@ -36,5 +36,42 @@ int (*fsdriver_callvec[NREQS])(const struct fsdriver * __restrict,
 	CALL(REQ_RDLINK)	= fsdriver_rdlink,
 	CALL(REQ_GETDENTS)	= fsdriver_getdents,
 	CALL(REQ_PEEK)		= fsdriver_peek,
-	CALL(REQ_BPEEK)		= fsdriver_bpeek
+	CALL(REQ_BPEEK)		= fsdriver_bpeek,
+	CALL(REQ_FADVISE)	= fsdriver_fadvise
+};
+
+const char *const fsdriver_callnames[NREQS] = {
+	CALL(REQ_PUTNODE)	= "putnode",
+	CALL(REQ_SLINK)		= "slink",
+	CALL(REQ_FTRUNC)	= "ftrunc",
+	CALL(REQ_CHOWN)		= "chown",
+	CALL(REQ_CHMOD)		= "chmod",
+	CALL(REQ_INHIBREAD)	= "inhibread",
+	CALL(REQ_STAT)		= "stat",
+	CALL(REQ_UTIME)		= "utime",
+	CALL(REQ_STATVFS)	= "statvfs",
+	CALL(REQ_BREAD)		= "bread",
+	CALL(REQ_BWRITE)	= "bwrite",
+	CALL(REQ_UNLINK)	= "unlink",
+	CALL(REQ_RMDIR)		= "rmdir",
+	CALL(REQ_UNMOUNT)	= "unmount",
+	CALL(REQ_SYNC)		= "sync",
+	CALL(REQ_NEW_DRIVER)	= "newdriver",
+	CALL(REQ_FLUSH)		= "flush",
+	CALL(REQ_READ)		= "read",
+	CALL(REQ_WRITE)		= "write",
+	CALL(REQ_MKNOD)		= "mknod",
+	CALL(REQ_MKDIR)		= "mkdir",
+	CALL(REQ_CREATE)	= "create",
+	CALL(REQ_LINK)		= "link",
+	CALL(REQ_RENAME)	= "rename",
+	CALL(REQ_LOOKUP)	= "lookup",
+	CALL(REQ_MOUNTPOINT)	= "mountpoint",
+	CALL(REQ_READSUPER)	= "readsuper",
+	CALL(REQ_NEWNODE)	= "newnode",
+	CALL(REQ_RDLINK)	= "rdlink",
+	CALL(REQ_GETDENTS)	= "getdents",
+	CALL(REQ_PEEK)		= "peek",
+	CALL(REQ_BPEEK)		= "bpeek",
+	CALL(REQ_FADVISE)	= "fadvise"
 };
@@ -12,8 +12,48 @@ static endpoint_t input_endpt = NONE;
 static int kbd_id = INVALID_INPUT_ID;
 static int mouse_id = INVALID_INPUT_ID;
 
+/*
+ * Events are batched into a single message where possible, so that a burst of
+ * events--for example, from one device interrupt--results in one message to
+ * the input server rather than one message per event.  The pending batch is
+ * flushed when it is full, when an event for a different device ID comes in,
+ * and after each processed request, before the driver blocks on receive.
+ */
+static message ev_msg;		/* partially filled batch of input events */
+static unsigned int ev_count;	/* number of events in the batch, 0 = none */
+
 static int running;
 
+/*
+ * Send the pending batch of input events, if any, to the input server.
+ */
+static void
+flush_events(void)
+{
+	unsigned int count;
+
+	if ((count = ev_count) == 0)
+		return;
+
+	ev_count = 0;
+
+	if (input_endpt == NONE)
+		return;
+
+	ev_msg.m_type = INPUT_EVENTS;
+	ev_msg.m_linputdriver_input_events.count = count;
+
+	/*
+	 * Use a blocking send call, for two reasons.  First, this avoids the
+	 * situation that we ever end up queuing too many asynchronous messages
+	 * to the input server.  Second, it allows us to detect trivially if
+	 * the input server has crashed, in which case we should stop sending
+	 * more messages to it.
+	 */
+	if (ipc_send(input_endpt, &ev_msg) != OK)
+		input_endpt = NONE;
+}
+
 /*
  * Announce that we are up after a fresh start or restart.
  */
@@ -43,7 +83,6 @@ void
 inputdriver_send_event(int mouse, unsigned short page, unsigned short code,
 	int value, int flags)
 {
-	message m;
 	int id;
 
 	if (input_endpt == NONE)
@@ -53,24 +92,23 @@ inputdriver_send_event(int mouse, unsigned short page, unsigned short code,
 	if (id == INVALID_INPUT_ID)
 		return;
 
-	memset(&m, 0, sizeof(m));
+	/* A batch carries events for one device ID only. */
+	if (ev_count > 0 && ev_msg.m_linputdriver_input_events.id != id)
+		flush_events();
 
-	m.m_type = INPUT_EVENT;
-	m.m_linputdriver_input_event.id = id;
-	m.m_linputdriver_input_event.page = page;
-	m.m_linputdriver_input_event.code = code;
-	m.m_linputdriver_input_event.value = value;
-	m.m_linputdriver_input_event.flags = flags;
+	if (ev_count == 0) {
+		memset(&ev_msg, 0, sizeof(ev_msg));
 
-	/*
-	 * Use a blocking send call, for two reasons.  First, this avoids the
-	 * situation that we ever end up queuing too many asynchronous messages
-	 * to the input server.  Second, it allows us to detect trivially if
-	 * the input server has crashed, in which case we should stop sending
-	 * more messages to it.
-	 */
-	if (ipc_send(input_endpt, &m) != OK)
-		input_endpt = NONE;
+		ev_msg.m_linputdriver_input_events.id = id;
+	}
+
+	ev_msg.m_linputdriver_input_events.page[ev_count] = page;
+	ev_msg.m_linputdriver_input_events.code[ev_count] = code;
+	ev_msg.m_linputdriver_input_events.value[ev_count] = value;
+	ev_msg.m_linputdriver_input_events.flags[ev_count] = flags;
+
+	if (++ev_count == INPUT_EVENTS_MAX)
+		flush_events();
 }
 
 /*
@@ -100,7 +138,9 @@ do_conf(message *m_ptr)
 		return;
 	}
 
-	/* Save the new state. */
+	/* Save the new state.  Any batched events are stale now; drop them. */
+	ev_count = 0;
+
 	input_endpt = m_ptr->m_source;
 	kbd_id = m_ptr->m_input_linputdriver_input_conf.kbd_id;
 	mouse_id = m_ptr->m_input_linputdriver_input_conf.mouse_id;
@@ -158,17 +198,18 @@ inputdriver_process(struct inputdriver *idp, message *m_ptr, int ipc_status)
 			if (idp->idr_other)
 				idp->idr_other(m_ptr, ipc_status);
 		}
-
-		return;
+	} else {
+		switch (m_ptr->m_type) {
+		case INPUT_CONF:	do_conf(m_ptr);		break;
+		case INPUT_SETLEDS:	do_setleds(idp, m_ptr);	break;
+		default:
+			if (idp->idr_other)
+				idp->idr_other(m_ptr, ipc_status);
+		}
 	}
 
-	switch (m_ptr->m_type) {
-	case INPUT_CONF:		do_conf(m_ptr);		break;
-	case INPUT_SETLEDS:		do_setleds(idp, m_ptr);	break;
-	default:
-		if (idp->idr_other)
-			idp->idr_other(m_ptr, ipc_status);
-	}
+	/* Send out any events batched up while processing the request. */
+	flush_events();
 }
 
 /*
@@ -125,6 +125,11 @@ struct tcp_pcb *tcp_active_pcbs;
 /** List of all TCP PCBs in TIME-WAIT state */
 struct tcp_pcb *tcp_tw_pcbs;
 
+#if defined(__minix)
+/** Hash table over the active PCB list, for fast segment demultiplexing */
+struct tcp_pcb *tcp_active_hash[TCP_ACTIVE_HASH_SIZE];
+#endif /* defined(__minix) */
+
 /** An array with all (non-temporary) PCB lists, mainly used for smaller code size */
 struct tcp_pcb ** const tcp_pcb_lists[] = {&tcp_listen_pcbs.pcbs, &tcp_bound_pcbs,
   &tcp_active_pcbs, &tcp_tw_pcbs};
@@ -1183,6 +1188,9 @@ tcp_slowtmr_start:
       void *err_arg;
       enum tcp_state last_state;
       tcp_pcb_purge(pcb);
+#if defined(__minix)
+      tcp_active_hash_remove(pcb);
+#endif /* defined(__minix) */
       /* Remove PCB from tcp_active_pcbs list. */
       if (prev != NULL) {
         LWIP_ASSERT("tcp_slowtmr: middle tcp != tcp_active_pcbs", pcb != tcp_active_pcbs);
@@ -1877,6 +1885,119 @@ tcp_pcb_purge(struct tcp_pcb *pcb)
   }
 }
 
+#if defined(__minix)
+/**
+ * Computes the active-PCB hash bucket index for a connection tuple.  The
+ * local IP address is left out of the hash: it adds little entropy, and
+ * leaving it out allows callers to hash insertions and removals directly
+ * from the PCB fields.
+ *
+ * @param remote_ip remote IP address, in either address family
+ * @param remote_port remote TCP port, in host byte order
+ * @param local_port local TCP port, in host byte order
+ * @return bucket index into tcp_active_hash[]
+ */
+static unsigned int
+tcp_active_hash_index(const ip_addr_t *remote_ip, u16_t remote_port,
+                      u16_t local_port)
+{
+  u32_t hash;
+
+  hash = ((u32_t)remote_port << 16) | local_port;
+#if LWIP_IPV6
+  if (IP_IS_V6(remote_ip)) {
+    const ip6_addr_t *ip6 = ip_2_ip6(remote_ip);
+    hash ^= ip6->addr[0] ^ ip6->addr[1] ^ ip6->addr[2] ^ ip6->addr[3];
+  } else
+#endif /* LWIP_IPV6 */
+  {
+    hash ^= ip4_addr_get_u32(ip_2_ip4(remote_ip));
+  }
+  /* fold in the upper bits; remote ports are often sequential */
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+  return hash & (TCP_ACTIVE_HASH_SIZE - 1);
+}
+
+/**
+ * Inserts a PCB into the active-PCB hash table. Called whenever a PCB is
+ * registered on the tcp_active_pcbs list (see TCP_REG in tcp_priv.h).
+ *
+ * @param pcb the tcp_pcb to insert; its connection tuple must be final
+ */
+void
+tcp_active_hash_insert(struct tcp_pcb *pcb)
+{
+  unsigned int i;
+
+  i = tcp_active_hash_index(&pcb->remote_ip, pcb->remote_port,
+    pcb->local_port);
+  pcb->hash_next = tcp_active_hash[i];
+  tcp_active_hash[i] = pcb;
+}
+
+/**
+ * Removes a PCB from the active-PCB hash table. Called whenever a PCB is
+ * removed from the tcp_active_pcbs list (see TCP_RMV in tcp_priv.h), and
+ * thus before tcp_pcb_remove() resets the local port.
+ *
+ * @param pcb the tcp_pcb to remove
+ */
+void
+tcp_active_hash_remove(struct tcp_pcb *pcb)
+{
+  struct tcp_pcb **prev;
+  unsigned int i;
+
+  i = tcp_active_hash_index(&pcb->remote_ip, pcb->remote_port,
+    pcb->local_port);
+  for (prev = &tcp_active_hash[i]; *prev != NULL;
+       prev = &(*prev)->hash_next) {
+    if (*prev == pcb) {
+      *prev = pcb->hash_next;
+      pcb->hash_next = NULL;
+      return;
+    }
+  }
+  LWIP_ASSERT("tcp_active_hash_remove: pcb was not in the hash", 0);
+}
+
+/**
+ * Looks up the active PCB for a connection tuple, replacing the linear
+ * tcp_active_pcbs walk in tcp_input().
+ *
+ * @param local_ip local (destination) IP address of the segment
+ * @param local_port local TCP port, in host byte order
+ * @param remote_ip remote (source) IP address of the segment
+ * @param remote_port remote TCP port, in host byte order
+ * @return the matching tcp_pcb, or NULL if there is no active connection
+ */
+struct tcp_pcb *
+tcp_active_hash_lookup(const ip_addr_t *local_ip, u16_t local_port,
+                       const ip_addr_t *remote_ip, u16_t remote_port)
+{
+  struct tcp_pcb *pcb;
+
+  pcb = tcp_active_hash[tcp_active_hash_index(remote_ip, remote_port,
+    local_port)];
+  for (; pcb != NULL; pcb = pcb->hash_next) {
+    LWIP_ASSERT("tcp_active_hash_lookup: pcb->state != CLOSED",
+      pcb->state != CLOSED);
+    LWIP_ASSERT("tcp_active_hash_lookup: pcb->state != TIME-WAIT",
+      pcb->state != TIME_WAIT);
+    LWIP_ASSERT("tcp_active_hash_lookup: pcb->state != LISTEN",
+      pcb->state != LISTEN);
+    if (pcb->remote_port == remote_port &&
+        pcb->local_port == local_port &&
+        ip_addr_cmp(&pcb->remote_ip, remote_ip) &&
+        ip_addr_cmp(&pcb->local_ip, local_ip)) {
+      break;
+    }
+  }
+  return pcb;
+}
+#endif /* defined(__minix) */
+
 /**
  * Purges the PCB and removes it from a PCB list. Any delayed ACKs are sent first.
  *
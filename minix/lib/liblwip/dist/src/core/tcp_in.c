@@ -220,6 +220,13 @@ tcp_input(struct pbuf *p, struct netif *inp)
      for an active connection. */
   prev = NULL;
 
+#if defined(__minix)
+  /* Look the connection up in the active-PCB hash table, so that the
+     demultiplexing cost does not grow with the number of established
+     connections the way the list walk below does. */
+  pcb = tcp_active_hash_lookup(ip_current_dest_addr(), tcphdr->dest,
+    ip_current_src_addr(), tcphdr->src);
+#else /* !defined(__minix) */
   for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
     LWIP_ASSERT("tcp_input: active pcb->state != CLOSED", pcb->state != CLOSED);
     LWIP_ASSERT("tcp_input: active pcb->state != TIME-WAIT", pcb->state != TIME_WAIT);
@@ -244,6 +251,7 @@ tcp_input(struct pbuf *p, struct netif *inp)
     }
     prev = pcb;
   }
+#endif /* defined(__minix) */
 
   if (pcb == NULL) {
     /* If it did not go to an active connection, we check the connections
@@ -339,6 +339,38 @@ extern struct tcp_pcb ** const tcp_pcb_lists[NUM_TCP_PCB_LISTS];
 #ifndef TCP_DEBUG_PCB_LISTS
 #define TCP_DEBUG_PCB_LISTS 0
 #endif
+
+#if defined(__minix)
+/* In addition to the tcp_active_pcbs list, the PCBs of all active
+   connections are kept in a hash table keyed on the connection tuple, so
+   that incoming-segment demultiplexing does not degrade with the number of
+   established connections.  The table is maintained from the TCP_REG and
+   TCP_RMV macros below (and one open-coded list removal in tcp_slowtmr()),
+   which together cover all tcp_active_pcbs membership changes. */
+#ifndef TCP_ACTIVE_HASH_SIZE
+#define TCP_ACTIVE_HASH_SIZE 512 /* number of buckets; must be a power of two */
+#endif
+extern struct tcp_pcb *tcp_active_hash[TCP_ACTIVE_HASH_SIZE];
+void tcp_active_hash_insert(struct tcp_pcb *pcb);
+void tcp_active_hash_remove(struct tcp_pcb *pcb);
+struct tcp_pcb *tcp_active_hash_lookup(const ip_addr_t *local_ip,
+                                       u16_t local_port,
+                                       const ip_addr_t *remote_ip,
+                                       u16_t remote_port);
+#define TCP_HASH_REG(pcbs, npcb)                   \
+  do {                                             \
+    if ((pcbs) == &tcp_active_pcbs)                \
+      tcp_active_hash_insert(npcb);                \
+  } while (0)
+#define TCP_HASH_RMV(pcbs, npcb)                   \
+  do {                                             \
+    if ((pcbs) == &tcp_active_pcbs)                \
+      tcp_active_hash_remove(npcb);                \
+  } while (0)
+#else /* !defined(__minix) */
+#define TCP_HASH_REG(pcbs, npcb)
+#define TCP_HASH_RMV(pcbs, npcb)
+#endif /* defined(__minix) */
 #if TCP_DEBUG_PCB_LISTS
 #define TCP_REG(pcbs, npcb) do {\
                             struct tcp_pcb *tcp_tmp_pcb; \
@@ -352,6 +384,7 @@ extern struct tcp_pcb ** const tcp_pcb_lists[NUM_TCP_PCB_LISTS];
                             (npcb)->next = *(pcbs); \
                             LWIP_ASSERT("TCP_REG: npcb->next != npcb", (npcb)->next != (npcb)); \
                             *(pcbs) = (npcb); \
+                            TCP_HASH_REG(pcbs, npcb); \
                             LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
               tcp_timer_needed(); \
                             } while(0)
@@ -368,6 +401,7 @@ extern struct tcp_pcb ** const tcp_pcb_lists[NUM_TCP_PCB_LISTS];
                                } \
                             } \
                             (npcb)->next = NULL; \
+                            TCP_HASH_RMV(pcbs, npcb); \
                             LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
                             LWIP_DEBUGF(TCP_DEBUG, ("TCP_RMV: removed %p from %p\n", (npcb), *(pcbs))); \
                             } while(0)
@@ -378,6 +412,7 @@ extern struct tcp_pcb ** const tcp_pcb_lists[NUM_TCP_PCB_LISTS];
   do {                                             \
     (npcb)->next = *pcbs;                          \
     *(pcbs) = (npcb);                              \
+    TCP_HASH_REG(pcbs, npcb);                      \
     tcp_timer_needed();                            \
   } while (0)
 
@@ -398,6 +433,7 @@ extern struct tcp_pcb ** const tcp_pcb_lists[NUM_TCP_PCB_LISTS];
       }                                            \
     }                                              \
     (npcb)->next = NULL;                           \
+    TCP_HASH_RMV(pcbs, npcb);                      \
   } while(0)
 
 #endif /* LWIP_DEBUG */
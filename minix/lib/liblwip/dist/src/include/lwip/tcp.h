@@ -206,6 +206,11 @@ struct tcp_pcb {
   /* ports are in host byte order */
   u16_t remote_port;
 
+#if defined(__minix)
+  /* chaining for the active-PCB lookup hash table (see tcp_priv.h) */
+  struct tcp_pcb *hash_next;
+#endif /* defined(__minix) */
+
   tcpflags_t flags;
 #define TF_ACK_DELAY   0x01U   /* Delayed ACK. */
 #define TF_ACK_NOW     0x02U   /* Immediate ACK. */
@@ -24,6 +24,15 @@ extern u32_t lwip_hook_rand(void);
 
 #define LWIP_RAND		lwip_hook_rand
 
+u16_t lwip_minix_chksum(const void *dataptr, int len);
+
+#define LWIP_CHKSUM		lwip_minix_chksum
+
+/* Checksum cost counters, maintained by chksum.c. */
+extern u64_t lwip_minix_chksum_calls;
+extern u64_t lwip_minix_chksum_cycles;
+extern u64_t lwip_minix_chksum_bytes;
+
 #define LWIP_DONT_PROVIDE_BYTEORDER_FUNCTIONS
 
 #define lwip_htons		htons
@@ -0,0 +1,191 @@
+/* LWIP library - chksum.c - optimized Internet checksum computation */
+/*
+ * This module provides the routine used for all of lwIP's checksum
+ * computation, through the LWIP_CHKSUM hook (see arch/cc.h).  The routine
+ * computes the standard one's complement Internet checksum over a buffer.
+ *
+ * The head and tail of the buffer, as well as the alignment handling, follow
+ * lwIP's standard checksum algorithm #3, which this routine replaces.  For
+ * the bulk of the buffer, on x86 processors that support it, a SSE2 vector
+ * loop is selected at run time: the loop widens the buffer's 16-bit words to
+ * 32 bits and accumulates eight running sums in parallel, folding them into
+ * the regular one's complement sum afterwards.  The 32-bit lanes cannot
+ * overflow, since buffers are limited to well under 64 KB of data.  Feature
+ * detection uses the CPUID instruction, which is available in user mode and
+ * on all processors that MINIX3 supports.  On other architectures, and on
+ * processors without SSE2, a portable carry ping-pong loop does the work.
+ */
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/inet_chksum.h"
+
+#include <minix/minlib.h>
+
+/*
+ * Cost counters (see arch/cc.h).  The LWIP service exports these through the
+ * minix.lwip.perf sysctl(7) subtree, so that benchmarks can attribute the
+ * cycles spent on checksum computation separately from the rest of the packet
+ * processing cost.
+ */
+u64_t lwip_minix_chksum_calls;		/* number of checksum computations */
+u64_t lwip_minix_chksum_cycles;		/* TSC cycles spent on checksums */
+u64_t lwip_minix_chksum_bytes;		/* bytes covered by checksums */
+
+#ifdef __i386__
+
+static int chksum_use_sse2 = -1;	/* -1 = not yet determined */
+
+/*
+ * Return whether the processor supports the SSE2 instruction set extension.
+ */
+static int
+chksum_have_sse2(void)
+{
+	u32_t eax, ebx, ecx, edx;
+
+	/*
+	 * The EBX register juggling keeps this code safe for use in
+	 * position-independent code, where EBX is reserved.
+	 */
+	__asm__ volatile (
+	    "xchgl %%ebx, %1\n\t"
+	    "cpuid\n\t"
+	    "xchgl %%ebx, %1"
+	    : "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx)
+	    : "0" (0));
+
+	if (eax < 1)
+		return FALSE;
+
+	__asm__ volatile (
+	    "xchgl %%ebx, %1\n\t"
+	    "cpuid\n\t"
+	    "xchgl %%ebx, %1"
+	    : "=a" (eax), "=r" (ebx), "=c" (ecx), "=d" (edx)
+	    : "0" (1));
+
+	return !!(edx & (1 << 26));	/* CPUID feature flag for SSE2 */
+}
+
+#endif /* __i386__ */
+
+/*
+ * Compute the Internet checksum over the given buffer, which may start at an
+ * odd byte address.  Return the non-inverted one's complement sum.
+ */
+u16_t
+lwip_minix_chksum(const void * dataptr, int len)
+{
+	const u8_t *pb = (const u8_t *)dataptr;
+	const u16_t *ps;
+	const u32_t *pl;
+	u64_t tsc_start, tsc_end;
+	u32_t sum = 0, tmp;
+	u16_t t = 0;
+	int odd;
+
+	read_tsc_64(&tsc_start);
+
+	lwip_minix_chksum_calls++;
+	lwip_minix_chksum_bytes += (u64_t)len;
+
+	/* Take care of a dangling head byte and 16-bit word, for alignment */
+	odd = ((mem_ptr_t)pb & 1);
+
+	if (odd && len > 0) {
+		((u8_t *)&t)[1] = *pb++;
+		len--;
+	}
+
+	ps = (const u16_t *)(const void *)pb;
+
+	if (((mem_ptr_t)ps & 3) && len > 1) {
+		sum += *ps++;
+		len -= 2;
+	}
+
+	pl = (const u32_t *)(const void *)ps;
+
+#ifdef __i386__
+	if (chksum_use_sse2 < 0)
+		chksum_use_sse2 = chksum_have_sse2();
+
+	/* For small buffers, the scalar loop below is just as fast. */
+	if (chksum_use_sse2 && len > 63) {
+		u32_t vsum, n = (u32_t)len >> 4;
+
+		__asm__ volatile (
+		    "pxor %%xmm0, %%xmm0\n\t"
+		    "pxor %%xmm3, %%xmm3\n\t"
+		    "pxor %%xmm4, %%xmm4\n"
+		    "1:\n\t"
+		    "movdqu (%1), %%xmm1\n\t"
+		    "movdqa %%xmm1, %%xmm2\n\t"
+		    "punpcklwd %%xmm0, %%xmm1\n\t"
+		    "punpckhwd %%xmm0, %%xmm2\n\t"
+		    "paddd %%xmm1, %%xmm3\n\t"
+		    "paddd %%xmm2, %%xmm4\n\t"
+		    "addl $16, %1\n\t"
+		    "decl %2\n\t"
+		    "jnz 1b\n\t"
+		    "paddd %%xmm4, %%xmm3\n\t"
+		    "movdqa %%xmm3, %%xmm1\n\t"
+		    "psrldq $8, %%xmm1\n\t"
+		    "paddd %%xmm1, %%xmm3\n\t"
+		    "movdqa %%xmm3, %%xmm1\n\t"
+		    "psrldq $4, %%xmm1\n\t"
+		    "paddd %%xmm1, %%xmm3\n\t"
+		    "movd %%xmm3, %0"
+		    : "=r" (vsum), "+r" (pl), "+r" (n)
+		    :
+		    : "memory", "cc");
+
+		sum += FOLD_U32T(vsum);
+		len &= 15;
+	}
+#endif /* __i386__ */
+
+	/* Sum 32 bits at a time, adding back carries (scalar bulk loop). */
+	while (len > 7) {
+		tmp = sum + *pl++;
+		if (tmp < sum)
+			tmp++;
+
+		sum = tmp + *pl++;
+		if (sum < tmp)
+			sum++;
+
+		len -= 8;
+	}
+
+	/* Make room in the upper bits. */
+	sum = FOLD_U32T(sum);
+
+	ps = (const u16_t *)pl;
+
+	/* 16-bit aligned words remaining? */
+	while (len > 1) {
+		sum += *ps++;
+		len -= 2;
+	}
+
+	/* Dangling tail byte remaining? */
+	if (len > 0)
+		((u8_t *)&t)[0] = *(const u8_t *)ps;
+
+	sum += t;	/* add end bytes */
+
+	/* Fold the 32-bit sum to 16 bits. */
+	sum = FOLD_U32T(sum);
+	sum = FOLD_U32T(sum);
+
+	if (odd)
+		sum = SWAP_BYTES_IN_WORD(sum);
+
+	read_tsc_64(&tsc_end);
+
+	lwip_minix_chksum_cycles += tsc_end - tsc_start;
+
+	return (u16_t)sum;
+}
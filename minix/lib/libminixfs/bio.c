@@ -157,6 +157,39 @@ lmfs_bio(dev_t dev, struct fsdriver_data * data, size_t bytes, off_t pos,
 	block_off = (size_t)(pos % block_size);
 	blocks_left = howmany(block_off + bytes, block_size);
 
+	/*
+	 * Zero-copy fast path for large aligned reads: if the caller resides
+	 * in another process, and the request covers one or more whole blocks
+	 * none of which are present in the local cache, forward the caller's
+	 * own grant to the block driver, so that the data is transferred
+	 * (typically DMA'd) directly into the caller's buffer instead of
+	 * being staged in the cache and copied out afterwards. Dirty blocks
+	 * only ever live in the local cache, so the cache scan guarantees
+	 * that the disk contents are current. Fall through to the regular
+	 * cached path if the driver cannot perform the transfer, for example
+	 * because of buffer alignment restrictions.
+	 */
+	if (call == FSC_READ && data != NULL && data->endpt != SELF &&
+	    block_off == 0 && bytes >= block_size) {
+		size_t nblocks;
+		unsigned int i;
+		ssize_t res;
+
+		nblocks = bytes / block_size;
+
+		for (i = 0; i < nblocks; i++)
+			if (lmfs_cache_contains(dev, block + i))
+				break;
+
+		if (i == nblocks) {
+			res = bdev_read_grant(dev, pos, data->endpt,
+			    data->grant, nblocks * block_size, BDEV_NOFLAGS);
+
+			if (res > 0)
+				return res;
+		}
+	}
+
 	assert(blocks_left > 0);
 
 	/*
@@ -245,6 +278,26 @@ lmfs_bio(dev_t dev, struct fsdriver_data * data, size_t bytes, off_t pos,
 	return off;
 }
 
+/*
+ * Process a message that is not a file system request.  This function can be
+ * used to implement the fdr_other hook, and must be used by file systems that
+ * use this library's asynchronous read-ahead functionality: the replies to
+ * asynchronous block driver requests arrive through this function, and are
+ * forwarded to libbdev here.  Other messages are ignored.
+ */
+void
+lmfs_other(const message * m_ptr, int ipc_status __unused)
+{
+	message m;
+
+	if (m_ptr->m_type == BDEV_REPLY) {
+		/* libbdev requires a non-constant message. */
+		m = *m_ptr;
+
+		bdev_reply_asyn(&m);
+	}
+}
+
 /*
  * Perform a flush request on a block device, flushing and invalidating all
  * blocks associated with this device, both in the local cache and in VM.
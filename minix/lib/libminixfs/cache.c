@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <math.h>
 #include <stdlib.h>
 
@@ -37,6 +38,7 @@
 
 /* Flags to put_block(). */
 #define ONE_SHOT      0x1	/* set if block will not be needed again */
+#define FRONT_ONLY    0x2	/* no reuse expected, but keep the block valid */
 
 #define BUFHASH(b) ((unsigned int)((b) % nr_bufs))
 #define MARKCLEAN  lmfs_markclean
@@ -62,10 +64,46 @@ static int may_use_vmcache;
 
 static size_t fs_block_size = PAGE_SIZE;	/* raw i/o block size */
 
+/* Background-style writeback: the number of dirty blocks in the cache is
+ * tracked, and once it passes the high-water mark (a 1/DIRTY_DENOM fraction of
+ * the cache), all dirty blocks for the device are written out right away
+ * rather than at the next sync or eviction.  The flush path sorts the blocks
+ * by block number and coalesces runs of contiguous blocks into single
+ * transfers (see rw_scattered()), so flushing in bulk replaces a scattered
+ * trickle of LRU-order writes by large sorted sweeps across the disk.
+ */
+#define DIRTY_DENOM	4
+
+static unsigned int dirty_bufs;	/* # bufs currently marked dirty */
+
+/* Memory-pressure-driven resizing: the heuristic buffer count computed at
+ * mount time is only a snapshot of the memory situation, so the cache also
+ * adapts while mounted.  Every PRESSURE_INTERVAL block releases, the amount of
+ * free memory is rechecked with VM.  When free memory (including VM's
+ * evictable secondary cache) drops below a low-water fraction, 'bufs_limit' is
+ * lowered below the pool size and the excess blocks have their data pages
+ * released, clean and least recently used blocks first.  Blocks that were
+ * handed to the VM cache are merely demoted by this: their contents remain in
+ * the secondary cache until VM itself needs the memory, so a shrink costs
+ * repopulation work rather than I/O.  Once memory is plentiful again the limit
+ * is restored and the cache refills lazily as blocks are used; structural
+ * growth beyond the pool size still happens through the regular heuristic
+ * check.
+ */
+#define PRESSURE_INTERVAL	1024	/* # releases between pressure checks */
+#define PRESSURE_LOW_PCT	4	/* shrink when free memory drops below */
+#define PRESSURE_HIGH_PCT	15	/* restore when free memory exceeds */
+
+static unsigned int bufs_limit;	/* current max # bufs that may hold pages */
+static unsigned int bufs_populated; /* # bufs currently holding data pages */
+
 static fsblkcnt_t fs_btotal = 0, fs_bused = 0;
 
 static int quiet = 0;
 
+/* Cache statistics, for file servers to publish as they see fit. */
+struct lmfs_stats lmfs_stats;
+
 typedef struct buf *noxfer_buf_ptr_t; /* annotation for temporary buf ptrs */
 
 void lmfs_setquiet(int q) { quiet = q; }
@@ -163,11 +201,16 @@ void lmfs_change_blockusage(int delta)
 
 void lmfs_markdirty(struct buf *bp)
 {
+	if (lmfs_isclean(bp)) dirty_bufs++;
 	bp->lmfs_flags |= VMMC_DIRTY;
 }
 
 void lmfs_markclean(struct buf *bp)
 {
+	if (!lmfs_isclean(bp)) {
+		assert(dirty_bufs > 0);
+		dirty_bufs--;
+	}
 	bp->lmfs_flags &= ~VMMC_DIRTY;
 }
 
@@ -192,11 +235,31 @@ static void free_unused_blocks(void)
 	printf("libminixfs: freeing; %d blocks, %d bytes\n", freed, bytes);
 }
 
+static void cache_enforce_limit(void)
+{
+/* If the cache is at or over its current memory-pressure limit, release the
+ * data pages of a clean, unused block so that a new block can be populated
+ * without growing the cache.  If all populated blocks are dirty or in use, do
+ * nothing; the next pressure check will flush and retry.
+ */
+  struct buf *bp;
+
+  for (bp = front; bp != NULL && bufs_populated >= bufs_limit;
+      bp = bp->lmfs_next) {
+	if (bp->data == NULL || bp->lmfs_count > 0 || !lmfs_isclean(bp))
+		continue;
+	freeblock(bp);
+  }
+}
+
 static void lmfs_alloc_block(struct buf *bp, size_t block_size)
 {
   ASSERT(!bp->data);
   ASSERT(bp->lmfs_bytes == 0);
 
+  if (bufs_populated >= bufs_limit)
+	cache_enforce_limit();
+
   if((bp->data = mmap(0, block_size, PROT_READ|PROT_WRITE,
       MAP_PREALLOC|MAP_ANON, -1, 0)) == MAP_FAILED) {
 	free_unused_blocks();
@@ -208,6 +271,7 @@ static void lmfs_alloc_block(struct buf *bp, size_t block_size)
   assert(bp->data);
   bp->lmfs_bytes = block_size;
   bp->lmfs_needsetcache = 1;
+  bufs_populated++;
 }
 
 /*===========================================================================*
@@ -268,6 +332,8 @@ static void freeblock(struct buf *bp)
 	munmap_t(bp->data, bp->lmfs_bytes);
 	bp->lmfs_bytes = 0;
 	bp->data = NULL;
+	assert(bufs_populated > 0);
+	bufs_populated--;
   } else assert(!bp->data);
 }
 
@@ -292,6 +358,189 @@ static struct buf *find_block(dev_t dev, block64_t block)
   return NULL;
 }
 
+/*===========================================================================*
+ *				lmfs_cache_contains			     *
+ *===========================================================================*/
+int lmfs_cache_contains(dev_t dev, block64_t block)
+{
+/* Return whether the given block is currently present in the local cache. */
+
+  return find_block(dev, block) != NULL;
+}
+
+/* Read-ahead transfers are issued asynchronously when possible, so that the
+ * access that triggered the read-ahead, as well as subsequent work in the file
+ * server, overlaps with the transfer instead of waiting for it.  With command
+ * queueing drivers, the read-ahead also overlaps with any I/O issued in the
+ * meantime.  At most one asynchronous read-ahead request is outstanding at any
+ * time; its buffers are held (and thus pinned in the cache) until completion.
+ * The file server must hand incoming block driver replies to libbdev for this
+ * to work; if it does not, the first wait below will simply process the reply
+ * from within libbdev.
+ */
+static noxfer_buf_ptr_t aread_bufq[LMFS_MAX_PREFETCH];
+static unsigned int aread_count;	/* # buffers, zero if none pending */
+static bdev_id_t aread_id;		/* ID of the outstanding request */
+static dev_t aread_dev;			/* device being read from */
+static block64_t aread_base;		/* first block of the range */
+
+/*===========================================================================*
+ *				aread_callback				     *
+ *===========================================================================*/
+static void aread_callback(dev_t dev, bdev_id_t id __unused,
+	bdev_param_t param __unused, int result)
+{
+/* An asynchronous read-ahead request has completed.  Process the result and
+ * release the buffers, invalidating any blocks that were not transferred in
+ * full.  Failures are deliberately ignored beyond that; see lmfs_readahead().
+ */
+  struct buf *bp;
+  ssize_t left;
+  unsigned int i;
+
+  assert(aread_count > 0);
+
+  if (result < 0) {
+	printf("fs cache: I/O error %d on device %d/%d, block %"PRIu64"\n",
+	    result, major(dev), minor(dev), aread_bufq[0]->lmfs_blocknr);
+	left = 0;
+  } else
+	left = result;
+
+  for (i = 0; i < aread_count; i++) {
+	bp = aread_bufq[i];
+	if (left < (ssize_t)bp->lmfs_bytes) {
+		bp->lmfs_dev = NO_DEV;	/* invalidate block */
+		left = 0;
+	} else
+		left -= bp->lmfs_bytes;
+	lmfs_put_block(bp);
+  }
+
+  aread_count = 0;
+}
+
+/*===========================================================================*
+ *				aread_wait				     *
+ *===========================================================================*/
+static void aread_wait(void)
+{
+/* Wait for the outstanding asynchronous read-ahead request, if any, to
+ * complete.  Processing its reply invokes aread_callback().
+ */
+  struct buf *bp;
+  unsigned int i;
+
+  if (aread_count == 0)
+	return;
+
+  (void) bdev_wait_asyn(aread_id);
+
+  /* The wait may fail without completing the request, in which case we must
+   * release the buffers ourselves, invalidating them.
+   */
+  for (i = 0; i < aread_count; i++) {
+	bp = aread_bufq[i];
+	bp->lmfs_dev = NO_DEV;	/* invalidate block */
+	lmfs_put_block(bp);
+  }
+
+  aread_count = 0;
+}
+
+/* Dirty block write-back is issued asynchronously as well: each contiguous
+ * run of blocks becomes one vectored write request, and up to MAX_WRITE_RUNS
+ * requests may be in flight at once, so that queueing drivers see more than
+ * one request at a time even when the dirty blocks are scattered across the
+ * device.  All requests are awaited before rw_scattered() returns, keeping
+ * the flush a barrier for its callers.  Blocks whose write failed or fell
+ * short simply remain dirty, to be retried on a later flush.
+ */
+#define MAX_WRITE_RUNS	8	/* max outstanding write requests */
+
+static struct write_run {
+  bdev_id_t wr_id;		/* ID of the outstanding request */
+  noxfer_buf_ptr_t *wr_bufq;	/* blocks covered by the request */
+  unsigned int wr_count;	/* # blocks covered, zero if slot is free */
+} write_run[MAX_WRITE_RUNS];
+
+/*===========================================================================*
+ *				awrite_callback				     *
+ *===========================================================================*/
+static void awrite_callback(dev_t dev, bdev_id_t id __unused,
+	bdev_param_t param, int result)
+{
+/* An asynchronous write request has completed.  Mark the blocks that were
+ * transferred in full as clean; any others remain dirty.
+ */
+  struct write_run *wr = (struct write_run *) param;
+  struct buf *bp;
+  ssize_t left;
+  unsigned int i;
+
+  assert(wr->wr_count > 0);
+
+  if (result < 0) {
+	printf("fs cache: I/O error %d on device %d/%d, block %"PRIu64"\n",
+	    result, major(dev), minor(dev), wr->wr_bufq[0]->lmfs_blocknr);
+	left = 0;
+  } else
+	left = result;
+
+  for (i = 0; i < wr->wr_count; i++) {
+	bp = wr->wr_bufq[i];
+	if (left >= (ssize_t)bp->lmfs_bytes) {
+		MARKCLEAN(bp);
+		left -= bp->lmfs_bytes;
+	} else
+		left = 0;
+  }
+
+  wr->wr_count = 0;
+}
+
+/*===========================================================================*
+ *				awrite_wait				     *
+ *===========================================================================*/
+static void awrite_wait(void)
+{
+/* Wait for all outstanding asynchronous write requests to complete.
+ * Processing their replies invokes awrite_callback().  A wait may fail
+ * without completing its request, in which case the blocks simply remain
+ * dirty.
+ */
+  unsigned int i;
+
+  for (i = 0; i < MAX_WRITE_RUNS; i++) {
+	if (write_run[i].wr_count == 0)
+		continue;
+
+	(void) bdev_wait_asyn(write_run[i].wr_id);
+
+	write_run[i].wr_count = 0;
+  }
+}
+
+/*===========================================================================*
+ *				awrite_get_run				     *
+ *===========================================================================*/
+static struct write_run *awrite_get_run(void)
+{
+/* Return a free write request slot, waiting for an outstanding request to
+ * complete first if all slots are in use.
+ */
+  unsigned int i;
+
+  for (i = 0; i < MAX_WRITE_RUNS; i++)
+	if (write_run[i].wr_count == 0)
+		return(&write_run[i]);
+
+  (void) bdev_wait_asyn(write_run[0].wr_id);
+
+  write_run[0].wr_count = 0;
+  return(&write_run[0]);
+}
+
 /*===========================================================================*
  *				get_block_ino				     *
  *===========================================================================*/
@@ -331,6 +580,14 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 
   assert(block <= UINT64_MAX / fs_block_size);
 
+  /* If the block is part of the outstanding asynchronous read-ahead request,
+   * wait for that request to complete first, so that the block contents are
+   * valid by the time we look at the cache.
+   */
+  if (aread_count > 0 && dev == aread_dev && block >= aread_base &&
+      block < aread_base + aread_count)
+	aread_wait();
+
   dev_off = block * fs_block_size;
 
   if((ino_off % fs_block_size)) {
@@ -351,6 +608,11 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 		return EIO;
 
 	/* Block needed has been found. */
+	lmfs_stats.ls_hits++;
+	if (bp->lmfs_prefetched) {
+		bp->lmfs_prefetched = 0;
+		lmfs_stats.ls_raused++;
+	}
 	if (bp->lmfs_count == 0) {
 		rm_lru(bp);
 		ASSERT(bp->lmfs_needsetcache == 0);
@@ -359,6 +621,7 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 		bp->lmfs_flags |= VMMC_BLOCK_LOCKED;
 	}
 	raisecount(bp);
+	bp->lmfs_refd = 1;	/* proven useful; grant a second chance */
 	ASSERT(bp->lmfs_flags & VMMC_BLOCK_LOCKED);
 	ASSERT(bp->data);
 
@@ -383,6 +646,10 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 	ASSERT(!(bp->lmfs_flags & VMMC_BLOCK_LOCKED));
 	ASSERT(!(bp->lmfs_flags & VMMC_DIRTY));
 	bp->lmfs_dev = NO_DEV;
+	if (bp->lmfs_bytes > 0) {
+		assert(bufs_populated > 0);
+		bufs_populated--;
+	}
 	bp->lmfs_bytes = 0;
 	bp->data = NULL;
   }
@@ -391,7 +658,31 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
   if(bp) {
   	ASSERT(bp->lmfs_flags & VMMC_EVICTED);
   } else {
-	if ((bp = front) == NULL) panic("all buffers in use: %d", nr_bufs);
+	int spared;
+
+	/* Take the block at the front of the LRU chain, but give blocks
+	 * that have been referenced again since they entered the chain a
+	 * second chance: such blocks move to the rear with their reference
+	 * bit cleared instead of being evicted. This way a large one-time
+	 * scan cannot flush the hot metadata set out of the cache. The scan
+	 * is bounded: each spared block has its reference bit cleared, so
+	 * after at most a full round the front block is evictable.
+	 */
+	for (spared = 0; spared <= nr_bufs; spared++) {
+		if ((bp = front) == NULL)
+			panic("all buffers in use: %d", nr_bufs);
+		if (!bp->lmfs_refd)
+			break;
+		bp->lmfs_refd = 0;
+		rm_lru(bp);
+		bp->lmfs_prev = rear;
+		bp->lmfs_next = NULL;
+		if (rear == NULL)
+			front = bp;
+		else
+			rear->lmfs_next = bp;
+		rear = bp;
+	}
   }
   assert(bp);
 
@@ -420,6 +711,9 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 
   bp->lmfs_flags = VMMC_BLOCK_LOCKED;
   bp->lmfs_needsetcache = 0;
+  bp->lmfs_refd = 0;		/* newly loaded blocks start unreferenced */
+  bp->lmfs_prefetched = 0;
+  bp->lmfs_noreuse = 0;
   bp->lmfs_dev = dev;		/* fill in device number */
   bp->lmfs_blocknr = block;	/* fill in block number */
   ASSERT(bp->lmfs_count == 0);
@@ -444,7 +738,9 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 	if((bp->data = vm_map_cacheblock(dev, dev_off, ino, ino_off,
 	    &bp->lmfs_flags, roundup(block_size, PAGE_SIZE))) != MAP_FAILED) {
 		bp->lmfs_bytes = block_size;
+		bufs_populated++;
 		ASSERT(!bp->lmfs_needsetcache);
+		lmfs_stats.ls_vmhits++;
 		*bpp = bp;
 		return OK;
 	}
@@ -472,6 +768,7 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 
   if (how == NORMAL) {
 	/* Try to read the block. Return an error code on failure. */
+	lmfs_stats.ls_misses++;
 	if ((r = read_block(bp, block_size)) != OK) {
 		put_block(bp, 0);
 
@@ -488,13 +785,194 @@ static int get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
   return OK;
 }
 
+/* File access hints, as set through posix_fadvise() and passed down by the
+ * file server.  The table is small and managed LRU-style like the stream
+ * table below: a hint for a file that has not been accessed for a while may
+ * be forgotten, which is harmless, since hints are advisory only.
+ */
+#define LMFS_NR_ADVICE		16	/* # file hints remembered */
+
+static struct advice {
+  dev_t a_dev;			/* device number, or NO_DEV if unused */
+  ino_t a_ino;			/* inode number on the device */
+  int a_advice;			/* the POSIX_FADV_ advice for the file */
+  unsigned int a_seen;		/* advice clock value at last use (for LRU) */
+} advice_tab[LMFS_NR_ADVICE];
+
+static unsigned int advice_clock;
+
+/*===========================================================================*
+ *				advice_lookup				     *
+ *===========================================================================*/
+static int advice_lookup(dev_t dev, ino_t ino)
+{
+/* Return the current advice for the given file, POSIX_FADV_NORMAL if none. */
+  struct advice *ap;
+
+  for (ap = &advice_tab[0]; ap < &advice_tab[LMFS_NR_ADVICE]; ap++) {
+	if (ap->a_dev == dev && ap->a_ino == ino) {
+		ap->a_seen = ++advice_clock;
+		return ap->a_advice;
+	}
+  }
+
+  return POSIX_FADV_NORMAL;
+}
+
+/*===========================================================================*
+ *				lmfs_set_advice				     *
+ *===========================================================================*/
+void lmfs_set_advice(dev_t dev, ino_t ino, int advice)
+{
+/* Set the access hint for the given file.  POSIX_FADV_NORMAL clears it. */
+  struct advice *ap, *lru;
+
+  lru = &advice_tab[0];
+  for (ap = &advice_tab[0]; ap < &advice_tab[LMFS_NR_ADVICE]; ap++) {
+	if (ap->a_dev == dev && ap->a_ino == ino)
+		break;
+	if (ap->a_seen < lru->a_seen || ap->a_dev == NO_DEV)
+		lru = ap;
+  }
+
+  if (ap == &advice_tab[LMFS_NR_ADVICE]) {
+	if (advice == POSIX_FADV_NORMAL)
+		return;		/* no entry to clear */
+	ap = lru;
+  }
+
+  if (advice == POSIX_FADV_NORMAL) {
+	ap->a_dev = NO_DEV;
+	return;
+  }
+
+  ap->a_dev = dev;
+  ap->a_ino = ino;
+  ap->a_advice = advice;
+  ap->a_seen = ++advice_clock;
+}
+
+/* The adaptive read-ahead engine keeps a small table of recently seen access
+ * streams, keyed by (device, inode). Each stream tracks the next device block
+ * it expects to see. When accesses keep hitting the expected next block, the
+ * read-ahead window doubles, up to lmfs_readahead_limit(); a miss shrinks the
+ * window back down. Sequentiality is detected in device blocks rather than
+ * file positions, which works out for the common case of sequentially
+ * allocated files and makes the prefetched blocks contiguous on disk.
+ */
+#define LMFS_NR_STREAMS		16	/* # streams tracked concurrently */
+#define LMFS_STREAM_MIN_RUN	2	/* # sequential hits to start */
+
+static struct stream {
+  dev_t s_dev;			/* device number, or NO_DEV if unused */
+  ino_t s_ino;			/* inode number on the device */
+  block64_t s_next;		/* next device block expected */
+  unsigned int s_window;	/* current read-ahead window (# blocks) */
+  unsigned int s_run;		/* length of the sequential run so far */
+  unsigned int s_seen;	/* stream clock value at last access (for LRU) */
+} stream[LMFS_NR_STREAMS];
+
+static unsigned int stream_clock;
+
+/*===========================================================================*
+ *				stream_access				     *
+ *===========================================================================*/
+static void stream_access(dev_t dev, block64_t block, ino_t ino)
+{
+/* Feed one block access into the read-ahead engine, and issue the resulting
+ * read-ahead I/O, if any. Called for regular cache accesses only; the blocks
+ * obtained by the read-ahead itself do not go through here.
+ */
+  struct stream *sp, *lru;
+  unsigned int count, limit;
+  int adv;
+
+  /* An explicit access hint for the file overrides stream detection. */
+  adv = advice_lookup(dev, ino);
+  if (adv == POSIX_FADV_RANDOM)
+	return;		/* declared random: do not read ahead */
+
+  /* Find the stream for this file, or repurpose the least recently used
+   * entry if there is none yet.
+   */
+  lru = &stream[0];
+  for (sp = &stream[0]; sp < &stream[LMFS_NR_STREAMS]; sp++) {
+	if (sp->s_dev == dev && sp->s_ino == ino)
+		break;
+	if (sp->s_seen < lru->s_seen || sp->s_dev == NO_DEV)
+		lru = sp;
+  }
+
+  if (sp == &stream[LMFS_NR_STREAMS]) {
+	sp = lru;
+	sp->s_dev = dev;
+	sp->s_ino = ino;
+	sp->s_run = 0;
+	sp->s_window = 0;
+  } else if (block != sp->s_next) {
+	/* The file is not (or no longer) being read sequentially. Shrink
+	 * the window rather than discarding the stream altogether, so that
+	 * a stream with occasional seeks ramps up again quickly.
+	 */
+	sp->s_run = 0;
+	sp->s_window /= 2;
+  } else {
+	sp->s_run++;
+  }
+
+  sp->s_next = block + 1;
+  sp->s_seen = ++stream_clock;
+
+  /* A file declared sequential needs no detection run, and its window grows
+   * twice as fast below.
+   */
+  if (sp->s_run < LMFS_STREAM_MIN_RUN && adv != POSIX_FADV_SEQUENTIAL)
+	return;
+
+  /* The stream is sequential; grow the window. */
+  limit = lmfs_readahead_limit();
+  if (sp->s_window < LMFS_STREAM_MIN_RUN)
+	sp->s_window = LMFS_STREAM_MIN_RUN;
+  else if (sp->s_window < limit)
+	sp->s_window = MIN(sp->s_window *
+	    ((adv == POSIX_FADV_SEQUENTIAL) ? 4 : 2), limit);
+
+  /* Read ahead as much of the window as is not yet in the cache. Stop at
+   * the first cached block: lmfs_readahead() must not be given blocks that
+   * are present (and possibly dirty) in the cache.
+   */
+  for (count = 0; count < sp->s_window; count++)
+	if (find_block(dev, sp->s_next + count) != NULL)
+		break;
+
+  if (count > 0)
+	lmfs_readahead(dev, sp->s_next, count, fs_block_size);
+}
+
 /*===========================================================================*
  *				lmfs_get_block_ino			     *
  *===========================================================================*/
 int lmfs_get_block_ino(struct buf **bpp, dev_t dev, block64_t block, int how,
 	ino_t ino, u64_t ino_off)
 {
-  return get_block_ino(bpp, dev, block, how, ino, ino_off, fs_block_size);
+  int r, adv;
+
+  r = get_block_ino(bpp, dev, block, how, ino, ino_off, fs_block_size);
+
+  if (r == OK && ino != VMC_NO_INODE) {
+	/* Blocks of files declared NOREUSE (or DONTNEED) are marked for
+	 * early eviction when they are released.
+	 */
+	adv = advice_lookup(dev, ino);
+	(*bpp)->lmfs_noreuse = (adv == POSIX_FADV_NOREUSE ||
+	    adv == POSIX_FADV_DONTNEED);
+
+	/* Regular accesses to file blocks feed the read-ahead engine. */
+	if (how == NORMAL)
+		stream_access(dev, block, ino);
+  }
+
+  return r;
 }
 
 /*===========================================================================*
@@ -530,7 +1008,8 @@ static void put_block(struct buf *bp, int put_flags)
   if (bp->lmfs_count != 0) return;	/* block is still in use */
 
   /* Put this block back on the LRU chain.  */
-  if (dev == NO_DEV || dev == DEV_RAM || (put_flags & ONE_SHOT)) {
+  if (dev == NO_DEV || dev == DEV_RAM ||
+      (put_flags & (ONE_SHOT | FRONT_ONLY))) {
 	/* Block will not be needed again. Put it on front of chain.
   	 * It will be the next block to be evicted from the cache.
   	 */
@@ -595,16 +1074,109 @@ static void put_block(struct buf *bp, int put_flags)
 	bp->lmfs_dev = NO_DEV;
 }
 
+/*===========================================================================*
+ *				cache_pressure_check			     *
+ *===========================================================================*/
+static void cache_pressure_check(void)
+{
+/* Recheck the system memory situation with VM, and adapt the cache size limit
+ * accordingly.  Called once every PRESSURE_INTERVAL block releases.
+ */
+  struct vm_stats_info vsi;
+  unsigned long free_pct;
+  unsigned int target;
+
+  if (vm_info_stats(&vsi) != OK)
+	return;
+
+  /* Memory held by VM's secondary cache counts as free, since VM evicts that
+   * cache under its own pressure (see the mount-time heuristic).
+   */
+  free_pct = (unsigned long)((u64_t)(vsi.vsi_free + vsi.vsi_cached) * 100 /
+      vsi.vsi_total);
+
+  if (free_pct >= PRESSURE_HIGH_PCT) {
+	/* Memory is plentiful.  Let the cache refill lazily up to the full
+	 * pool size, and if the pool is both idle and fully populated, see
+	 * whether the regular heuristic now wants a larger pool altogether.
+	 */
+	bufs_limit = nr_bufs;
+	if (bufs_populated == nr_bufs && bufs_in_use == 0)
+		cache_heuristic_check();
+	return;
+  }
+
+  if (free_pct >= PRESSURE_LOW_PCT)
+	return;	/* within the hysteresis band; leave the limit as is */
+
+  /* Memory is tight.  Lower the limit below the populated block count, and
+   * release the excess data pages, clean blocks first.  If the clean pass
+   * does not suffice, the remainder is dirty: flush, and release the now
+   * clean blocks in a second pass.
+   */
+  if (bufs_populated <= MINBUFS)
+	return;
+
+  target = MAX(bufs_populated - bufs_populated / 4, MINBUFS);
+  if (target >= bufs_populated)
+	return;
+
+  bufs_limit = target;
+
+  cache_enforce_limit();
+  if (bufs_populated > bufs_limit) {
+	lmfs_flushall();
+	cache_enforce_limit();
+  }
+}
+
 /*===========================================================================*
  *				lmfs_put_block				     *
  *===========================================================================*/
 void lmfs_put_block(struct buf *bp)
 {
 /* User interface to put_block(). */
+  static int flushing = FALSE;
+  static unsigned int put_count = 0;
+  dev_t dev;
 
   if (bp == NULL) return;	/* for poorly written file systems */
 
-  put_block(bp, 0);
+  dev = bp->lmfs_dev;
+
+  /* Blocks of files declared NOREUSE go to the front of the LRU chain, to
+   * be evicted first, instead of displacing blocks that will be reused.
+   * They do remain valid until then, so that a request making several small
+   * accesses to the same block does not reread it every time.
+   */
+  if (bp->lmfs_noreuse && bp->lmfs_count == 1) {
+	bp->lmfs_refd = 0;	/* no second chance either */
+	put_block(bp, FRONT_ONLY);
+  } else
+	put_block(bp, 0);
+
+  /* If releasing this block pushed the cache past the dirty high-water mark,
+   * write out all dirty blocks for the device now, in sorted order.  The
+   * recursion guard is needed because rw_scattered() releases blocks itself
+   * on the read path.
+   */
+  if (dev != NO_DEV && dev != DEV_RAM && !flushing &&
+      dirty_bufs >= nr_bufs / DIRTY_DENOM) {
+	flushing = TRUE;
+	lmfs_flushdev(dev);
+	flushing = FALSE;
+  }
+
+  /* Periodically recheck memory pressure.  The flushing guard doubles as a
+   * recursion guard here: both the flush and read-ahead completion paths
+   * release blocks themselves.
+   */
+  if (++put_count >= PRESSURE_INTERVAL && !flushing) {
+	put_count = 0;
+	flushing = TRUE;
+	cache_pressure_check();
+	flushing = FALSE;
+  }
 }
 
 /*===========================================================================*
@@ -789,6 +1361,10 @@ void lmfs_invalidate(
 
   assert(device != NO_DEV);
 
+  /* Make sure that no read-ahead transfer is ongoing for the device. */
+  if (aread_count > 0 && aread_dev == device)
+	aread_wait();
+
   for (bp = &buf[0]; bp < &buf[nr_bufs]; bp++) {
 	if (bp->lmfs_dev == device) {
 		assert(bp->data);
@@ -797,6 +1373,8 @@ void lmfs_invalidate(
 		bp->lmfs_dev = NO_DEV;
 		bp->lmfs_bytes = 0;
 		bp->data = NULL;
+		assert(bufs_populated > 0);
+		bufs_populated--;
 	}
   }
 
@@ -889,6 +1467,8 @@ static void rw_scattered(
    */
   while (bufqsize > 0) {
 	unsigned int p, nblocks = 0, niovecs = 0;
+	struct write_run *wr;
+	bdev_id_t id;
 	int r;
 	for (iop = iovec; nblocks < bufqsize; nblocks++) {
 		vir_bytes vdata, blockrem;
@@ -917,6 +1497,26 @@ static void rw_scattered(
 	assert(niovecs > 0 && niovecs <= NR_IOREQS);
 
 	pos = (off_t)bufq[0]->lmfs_blocknr * fs_block_size;
+
+	if (rw_flag == WRITING) {
+		/* Issue the write asynchronously, so that several runs can be
+		 * in flight at once.  The blocks are marked clean from the
+		 * completion callback.  If the request cannot be issued, fall
+		 * through to a synchronous transfer.
+		 */
+		wr = awrite_get_run();
+		id = bdev_scatter_asyn(dev, pos, iovec, niovecs, BDEV_NOFLAGS,
+		    awrite_callback, wr);
+		if (id >= 0) {
+			wr->wr_id = id;
+			wr->wr_bufq = bufq;
+			wr->wr_count = nblocks;
+			bufq += nblocks;
+			bufqsize -= nblocks;
+			continue;
+		}
+	}
+
 	if (rw_flag == READING)
 		r = bdev_gather(dev, pos, iovec, niovecs, BDEV_NOFLAGS);
 	else
@@ -971,6 +1571,13 @@ static void rw_scattered(
 	}
   }
 
+  /* Wait for all writes to complete, so that this function remains a barrier
+   * for its callers, and none of the blocks are still in transit (and thus
+   * open to reuse) upon return.
+   */
+  if (rw_flag == WRITING)
+	awrite_wait();
+
 #if !defined(NDEBUG)
   if(rw_flag == READING) {
   	assert(start_in_use >= start_bufqsize);
@@ -996,12 +1603,21 @@ void lmfs_readahead(dev_t dev, block64_t base_block, unsigned int nblocks,
  * be present in the cache afterwards--failures are (deliberately!) ignored.
  */
   static noxfer_buf_ptr_t bufq[LMFS_MAX_PREFETCH]; /* static for size only */
+  static iovec_t iovec[NR_IOREQS];
   struct buf *bp;
-  unsigned int count;
+  unsigned int count, niovecs, iov_per_block, p;
+  vir_bytes vdata, blockrem;
+  bdev_id_t id;
+  off_t pos;
   int r;
 
   assert(nblocks >= 1 && nblocks <= LMFS_MAX_PREFETCH);
 
+  /* At most one asynchronous read-ahead request may be outstanding, and the
+   * get_block() calls below must not find its blocks still in transit.
+   */
+  aread_wait();
+
   for (count = 0; count < nblocks; count++) {
 	if (count == nblocks - 1)
 		r = lmfs_get_partial_block(&bp, dev, base_block + count,
@@ -1019,9 +1635,58 @@ void lmfs_readahead(dev_t dev, block64_t base_block, unsigned int nblocks,
 	 */
 	assert(lmfs_isclean(bp));
 
+	bp->lmfs_prefetched = 1;
 	bufq[count] = bp;
   }
 
+  if (count == 0)
+	return;
+
+  lmfs_stats.ls_rablocks += count;
+
+  /* If the entire range fits in a single driver request, issue the transfer
+   * asynchronously, so that the access that triggered the read-ahead does not
+   * have to wait for it.  Otherwise, fall back to synchronous, chunked
+   * transfers.  The blocks in the range are contiguous by construction.
+   */
+  niovecs = 0;
+  for (p = 0; p < count; p++) {
+	iov_per_block = howmany(bufq[p]->lmfs_bytes, PAGE_SIZE);
+	niovecs += iov_per_block;
+  }
+
+  if (niovecs <= NR_IOREQS) {
+	niovecs = 0;
+	for (p = 0; p < count; p++) {
+		bp = bufq[p];
+		vdata = (vir_bytes) bp->data;
+		for (blockrem = bp->lmfs_bytes; blockrem > 0; niovecs++) {
+			iovec[niovecs].iov_addr = vdata;
+			iovec[niovecs].iov_size =
+			    blockrem < PAGE_SIZE ? blockrem : PAGE_SIZE;
+			vdata += PAGE_SIZE;
+			blockrem -= iovec[niovecs].iov_size;
+		}
+	}
+
+	pos = (off_t)bufq[0]->lmfs_blocknr * fs_block_size;
+	id = bdev_gather_asyn(dev, pos, iovec, niovecs, BDEV_NOFLAGS,
+	    aread_callback, NULL);
+
+	if (id >= 0) {
+		memcpy(aread_bufq, bufq, count * sizeof(bufq[0]));
+		aread_count = count;
+		aread_id = id;
+		aread_dev = dev;
+		aread_base = bufq[0]->lmfs_blocknr;
+		return;
+	}
+
+	/* Issuing the request failed; perform the read-ahead synchronously
+	 * after all.
+	 */
+  }
+
   rw_scattered(dev, bufq, count, READING);
 }
 
@@ -1135,12 +1800,21 @@ void lmfs_prefetch(dev_t dev, const block64_t *blockset, unsigned int nblocks)
  *===========================================================================*/
 void lmfs_flushdev(dev_t dev)
 {
-/* Flush all dirty blocks for one device. */
+/* Flush all dirty blocks for one device.  The blocks that hold file contents
+ * (those with an inode association) are written before the blocks that hold
+ * metadata (those without one, such as bitmaps, inode blocks, and indirect
+ * blocks).  As a result, after a crash in the middle of a flush, on-disk
+ * metadata never refers to file contents that were not yet written: the same
+ * write ordering that journaling file systems provide in their "ordered data"
+ * mode, without an on-disk log.  Each rw_scattered() round completes before
+ * the next one starts, so the two phases form an actual barrier.
+ */
 
   register struct buf *bp;
   static noxfer_buf_ptr_t *dirty;
   static unsigned int dirtylistsize = 0;
   unsigned int ndirty;
+  int phase;
 
   if(dirtylistsize != nr_bufs) {
 	if(dirtylistsize > 0) {
@@ -1152,17 +1826,25 @@ void lmfs_flushdev(dev_t dev)
 	dirtylistsize = nr_bufs;
   }
 
-  for (bp = &buf[0], ndirty = 0; bp < &buf[nr_bufs]; bp++) {
-	/* Do not flush dirty blocks that are in use (lmfs_count>0): the file
-	 * system may mark the block as dirty before changing its contents, in
-	 * which case the new contents could end up being lost.
-	 */
-	if (!lmfs_isclean(bp) && bp->lmfs_dev == dev && bp->lmfs_count == 0) {
+  /* Phase 0 collects file data blocks, phase 1 collects metadata blocks. */
+  for (phase = 0; phase < 2; phase++) {
+	for (bp = &buf[0], ndirty = 0; bp < &buf[nr_bufs]; bp++) {
+		/* Do not flush dirty blocks that are in use (lmfs_count>0):
+		 * the file system may mark the block as dirty before changing
+		 * its contents, in which case the new contents could end up
+		 * being lost.
+		 */
+		if (lmfs_isclean(bp) || bp->lmfs_dev != dev ||
+		    bp->lmfs_count > 0)
+			continue;
+		if ((bp->lmfs_inode == VMC_NO_INODE) != phase)
+			continue;
 		dirty[ndirty++] = bp;
 	}
-  }
 
-  rw_scattered(dev, dirty, ndirty, WRITING);
+	if (ndirty > 0)
+		rw_scattered(dev, dirty, ndirty, WRITING);
+  }
 }
 
 /*===========================================================================*
@@ -1272,8 +1954,11 @@ void lmfs_buf_pool(int new_nr_bufs)
 	panic("couldn't allocate buf hash list (%d)", new_nr_bufs);
 
   nr_bufs = new_nr_bufs;
+  bufs_limit = nr_bufs;	/* lowered again if memory pressure persists */
+  bufs_populated = 0;
 
   bufs_in_use = 0;
+  dirty_bufs = 0;	/* still-dirty blocks were lost along with the pool */
   front = &buf[0];
   rear = &buf[nr_bufs - 1];
 
@@ -465,6 +465,8 @@ mthread_thread_t thread;
   rt->m_tid = thread;
   rt->m_next = NULL;
   rt->m_state = MS_DEAD;
+  rt->m_priority = MTHREAD_PRIO_NORMAL;
+  rt->m_schedstamp = 0;
   rt->m_proc = NULL;
   rt->m_arg = NULL;
   rt->m_result = NULL;
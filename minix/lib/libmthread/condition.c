@@ -12,7 +12,6 @@ static int mthread_cond_valid(mthread_cond_t *c);
 # define mthread_cond_remove(c)		((*c)->mc_magic = MTHREAD_NOT_INUSE)
 # define mthread_cond_valid(c)		((*c)->mc_magic == MTHREAD_INIT_MAGIC)
 #endif
-#define MAIN_COND mainthread.m_cond
 
 /*===========================================================================*
  *				mthread_init_valid_conditions		     *
@@ -54,24 +53,19 @@ mthread_cond_t *c;
 int mthread_cond_broadcast(cond)
 mthread_cond_t *cond;
 {
-/* Signal all threads waiting for condition 'cond'. */
+/* Signal all threads waiting for condition 'cond'. The waiters are all on
+ * the condition's own queue (see mthread_cond_wait), so they can be made
+ * runnable in one batch, without scanning the whole thread table.
+ */
   mthread_thread_t t;
-  mthread_tcb_t *tcb;
 
-  if (cond == NULL) 
+  if (cond == NULL)
   	return(EINVAL);
   else if (!mthread_cond_valid(cond))
   	return(EINVAL);
 
-  tcb = mthread_find_tcb(MAIN_THREAD);
-  if (tcb->m_state == MS_CONDITION && tcb->m_cond == *cond)
-  	mthread_unsuspend(MAIN_THREAD);
-
-  for (t = (mthread_thread_t) 0; t < no_threads; t++) {
-  	tcb = mthread_find_tcb(t);
-	if (tcb->m_state == MS_CONDITION && tcb->m_cond == *cond) 
-		mthread_unsuspend(t);
-  }
+  while ((t = mthread_queue_remove(&(*cond)->mc_queue)) != NO_THREAD)
+	mthread_unsuspend(t);
 
   return(0);
 }
@@ -84,25 +78,16 @@ int mthread_cond_destroy(cond)
 mthread_cond_t *cond;
 {
 /* Destroy a condition variable. Make sure it's not in use */
-  mthread_thread_t t;
-  mthread_tcb_t *tcb;
 
   if (cond == NULL)
   	return(EINVAL);
   else if (!mthread_cond_valid(cond))
   	return(EINVAL);
 
-  /* Is another thread currently using this condition variable? */
-  tcb = mthread_find_tcb(MAIN_THREAD);
-  if (tcb->m_state == MS_CONDITION && tcb->m_cond == *cond)
+  /* Is another thread currently waiting on this condition variable? */
+  if (!mthread_queue_isempty(&(*cond)->mc_queue))
   	return(EBUSY);
 
-  for (t = (mthread_thread_t) 0; t < no_threads; t++) {
-  	tcb = mthread_find_tcb(t);
-	if (tcb->m_state == MS_CONDITION && tcb->m_cond == *cond)
-		return(EBUSY);
-  }
-
   /* Not in use; invalidate it. */
   mthread_cond_remove(cond);
   free(*cond);
@@ -135,6 +120,7 @@ mthread_condattr_t *cattr;
   else if ((c = malloc(sizeof(struct __mthread_cond))) == NULL) 
   	return(ENOMEM);
 
+  mthread_queue_init(&c->mc_queue);
   c->mc_mutex = NULL;
   *cond = (mthread_cond_t) c;
   mthread_cond_add(cond);
@@ -171,26 +157,18 @@ mthread_cond_t *c;
 int mthread_cond_signal(cond)
 mthread_cond_t *cond;
 {
-/* Signal a thread that condition 'cond' was met. Just a single thread. */
+/* Signal a thread that condition 'cond' was met. Just a single thread; the
+ * waiters are queued in order of arrival, so wake-ups are FIFO.
+ */
   mthread_thread_t t;
-  mthread_tcb_t *tcb;
 
   if (cond == NULL)
 	return(EINVAL);
   else if (!mthread_cond_valid(cond))
 	return(EINVAL);
 
-  tcb = mthread_find_tcb(MAIN_THREAD);
-  if (tcb->m_state == MS_CONDITION && tcb->m_cond == *cond)
-  	mthread_unsuspend(MAIN_THREAD);
-
-  for (t = (mthread_thread_t) 0; t < no_threads; t++) {
-  	tcb = mthread_find_tcb(t);
-	if (tcb->m_state == MS_CONDITION && tcb->m_cond == *cond){
-		mthread_unsuspend(t);
-		break;
-	}
-  }
+  if ((t = mthread_queue_remove(&(*cond)->mc_queue)) != NO_THREAD)
+	mthread_unsuspend(t);
 
   return(0);
 }
@@ -259,6 +237,7 @@ mthread_mutex_t *mutex;
 
   tcb = mthread_find_tcb(current_thread);
   tcb->m_cond = c; /* Register condition variable. */
+  mthread_queue_add(&c->mc_queue, current_thread);
   mthread_suspend(MS_CONDITION);
 
   /* When execution returns here, the condition was met. Lock mutex again. */
@@ -25,6 +25,8 @@ typedef enum {
 struct __mthread_tcb {
   mthread_thread_t m_tid;		/* My own ID */
   mthread_state_t m_state;		/* Thread state */
+  int m_priority;			/* Run queue tier (MTHREAD_PRIO_*) */
+  unsigned long m_schedstamp;		/* Switch count at last enqueue */
   struct __mthread_attr m_attr;		/* Thread attributes */
   struct __mthread_cond *m_cond;	/* Condition variable that this thread
   					 * might be blocking on */
@@ -42,6 +44,7 @@ typedef struct __mthread_tcb mthread_tcb_t;
 EXTERN mthread_thread_t current_thread;
 EXTERN mthread_queue_t free_threads;
 EXTERN mthread_queue_t run_queue;		/* FIFO of runnable threads */
+EXTERN mthread_queue_t hi_run_queue;		/* Served before run_queue */
 EXTERN mthread_tcb_t **threads;
 EXTERN mthread_tcb_t mainthread;
 EXTERN int no_threads;
@@ -1,4 +1,5 @@
 #include <minix/mthread.h>
+#include <string.h>
 #include "global.h"
 #include "proto.h"
 
@@ -8,6 +9,7 @@
 #define CURRENT_CTX	&(threads[current_thread]->m_context)
 #define CURRENT_STATE	threads[current_thread]->m_state
 static int yield_all;
+static struct mthread_schedstats schedstats;
 
 /*===========================================================================*
  *				mthread_getcontext			     *
@@ -30,22 +32,29 @@ ucontext_t *ctx;
  *===========================================================================*/
 void mthread_schedule(void)
 {
-/* Pick a new thread to run and run it. In practice, this involves taking the 
- * first thread off the (FIFO) run queue and resuming that thread. 
+/* Pick a new thread to run and run it. In practice, this involves taking the
+ * first thread off the (FIFO) run queue and resuming that thread. Threads on
+ * the high-priority run queue (see mthread_setprio) are served first.
  */
 
   mthread_thread_t old_thread;
   mthread_tcb_t *new_tcb, *old_tcb;
   ucontext_t *new_ctx, *old_ctx;
+  unsigned long latency;
+  int from_queue = 1;
 
   old_thread = current_thread;
 
-  if (mthread_queue_isempty(&run_queue)) {
+  if (!mthread_queue_isempty(&hi_run_queue)) {
+	current_thread = mthread_queue_remove(&hi_run_queue);
+  } else if (!mthread_queue_isempty(&run_queue)) {
+	current_thread = mthread_queue_remove(&run_queue);
+  } else {
 	/* No runnable threads. Let main thread run. */
 
 	/* We keep track whether we're running the program's 'main' thread or
 	 * a spawned thread. In case we're already running the main thread and
-	 * there are no runnable threads, we can't jump back to its context. 
+	 * there are no runnable threads, we can't jump back to its context.
 	 * Instead, we simply return.
 	 */
 	if (running_main_thread) return;
@@ -54,14 +63,25 @@ void mthread_schedule(void)
 	 * thread as there is no work left.
 	 */
 	current_thread = MAIN_THREAD;
-  } else {
-	current_thread = mthread_queue_remove(&run_queue);
+	from_queue = 0;
   }
 
+  schedstats.ms_switches++;
+
   /* Find thread entries in tcb... */
   new_tcb = mthread_find_tcb(current_thread);
   old_tcb = mthread_find_tcb(old_thread);
 
+  /* Account how long the new thread sat on its run queue, measured in
+   * context switches; see mthread_schedstats.
+   */
+  if (from_queue) {
+	latency = schedstats.ms_switches - new_tcb->m_schedstamp;
+	schedstats.ms_latency += latency;
+	if (latency > schedstats.ms_maxlatency)
+		schedstats.ms_maxlatency = latency;
+  }
+
   /* ...and subsequently their contexts */
   new_ctx = &(new_tcb->m_context);
   old_ctx = &(old_tcb->m_context);
@@ -82,11 +102,55 @@ void mthread_init_scheduler(void)
 {
 /* Initialize the scheduler */
   mthread_queue_init(&run_queue);
+  mthread_queue_init(&hi_run_queue);
+  memset(&schedstats, '\0', sizeof(schedstats));
   yield_all = 0;
 
 }
 
 
+/*===========================================================================*
+ *				mthread_schedstats			     *
+ *===========================================================================*/
+void mthread_schedstats(stats)
+struct mthread_schedstats *stats;	/* Where to store the statistics */
+{
+/* Retrieve a snapshot of the scheduler statistics: the number of context
+ * switches and wakeups since startup, and the cumulative and worst-case time
+ * that woken threads spent waiting on a run queue. Latencies are measured in
+ * context switches rather than wall-clock time, which keeps the bookkeeping
+ * free of kernel calls.
+ */
+
+  *stats = schedstats;
+}
+
+
+/*===========================================================================*
+ *				mthread_setprio				     *
+ *===========================================================================*/
+int mthread_setprio(thread, priority)
+mthread_thread_t thread;
+int priority;			/* MTHREAD_PRIO_NORMAL or MTHREAD_PRIO_HIGH */
+{
+/* Set the run queue tier of a thread. High-priority threads are scheduled
+ * before normal ones whenever both are runnable. The new priority takes
+ * effect the next time the thread is made runnable; a thread that is already
+ * on a run queue is not moved.
+ */
+  mthread_tcb_t *tcb;
+
+  if (!isokthreadid(thread)) return(ESRCH);
+  if (priority != MTHREAD_PRIO_NORMAL && priority != MTHREAD_PRIO_HIGH)
+  	return(EINVAL);
+
+  tcb = mthread_find_tcb(thread);
+  tcb->m_priority = priority;
+
+  return(0);
+}
+
+
 /*===========================================================================*
  *				mthread_suspend				     *
  *===========================================================================*/
@@ -132,14 +196,22 @@ mthread_state_t state;
 void mthread_unsuspend(thread)
 mthread_thread_t thread; /* Thread to make runnable */
 {
-/* Mark the state of a thread runnable and add it to the run queue */
+/* Mark the state of a thread runnable and add it to the run queue matching
+ * its priority.
+ */
   mthread_tcb_t *tcb;
 
   if (!isokthreadid(thread)) mthread_panic("Invalid thread id");
-  
+
   tcb = mthread_find_tcb(thread);
   tcb->m_state = MS_RUNNABLE;
-  mthread_queue_add(&run_queue, thread);
+  tcb->m_schedstamp = schedstats.ms_switches;
+  schedstats.ms_wakeups++;
+  if (tcb->m_priority == MTHREAD_PRIO_HIGH) {
+	schedstats.ms_hiwakeups++;
+	mthread_queue_add(&hi_run_queue, thread);
+  } else
+	mthread_queue_add(&run_queue, thread);
 }
 
 
@@ -164,14 +236,20 @@ int mthread_yield(void)
 	}
   }
 
-  if (mthread_queue_isempty(&run_queue)) {	/* No point in yielding. */
+  if (mthread_queue_isempty(&run_queue) &&
+      mthread_queue_isempty(&hi_run_queue)) {	/* No point in yielding. */
   	return(-1);
   } else if (current_thread == NO_THREAD) {
   	/* Can't yield this thread */
   	return(-1);
   }
 
-  mthread_queue_add(&run_queue, current_thread);
+  tcb = mthread_find_tcb(current_thread);
+  tcb->m_schedstamp = schedstats.ms_switches;
+  if (tcb->m_priority == MTHREAD_PRIO_HIGH)
+	mthread_queue_add(&hi_run_queue, current_thread);
+  else
+	mthread_queue_add(&run_queue, current_thread);
   mthread_suspend(MS_RUNNABLE);	/* We're still runnable, but we're just kind
 				 * enough to let someone else run.
 				 */
@@ -200,7 +278,8 @@ void mthread_yield_all(void)
    * or waiting for a lock, they are not on the run queue either. At that
    * point A is the only runnable thread left.
    */
-  while (!mthread_queue_isempty(&run_queue)) {
+  while (!mthread_queue_isempty(&run_queue) ||
+      !mthread_queue_isempty(&hi_run_queue)) {
 	(void) mthread_yield();
   }
 
@@ -12,7 +12,7 @@
  * values in the LWIP service's ndev module.
  */
 #define NETDRIVER_SENDQ_MAX	8
-#define NETDRIVER_RECVQ_MAX	2
+#define NETDRIVER_RECVQ_MAX	8
 
 /*
  * Maximum number of multicast addresses that can be copied in from the TCP/IP
@@ -22,6 +22,16 @@
  */
 #define NETDRIVER_MCAST_MAX	16
 
+/*
+ * Budget limits for interrupt-suppressed polling mode.  The budget is given
+ * to the driver's poll function as the maximum number of packets to process
+ * in one invocation.  It starts at the minimum, and doubles each time the
+ * driver does not manage to run out of work within the budget, so that under
+ * sustained high packet rates, progressively more work is done per pass.
+ */
+#define NETDRIVER_POLL_BUDGET_MIN	16
+#define NETDRIVER_POLL_BUDGET_MAX	256
+
 static const struct netdriver *netdriver_table = NULL;
 
 static int running;
@@ -38,6 +48,9 @@ static unsigned int pending_sends, pending_sendtail;
 static struct netdriver_data pending_recvq[NETDRIVER_RECVQ_MAX];
 static unsigned int pending_recvs, pending_recvtail;
 
+static int polling;
+static unsigned int poll_budget;
+
 static int pending_status;
 static endpoint_t status_endpt;
 
@@ -294,6 +307,61 @@ netdriver_recv(void)
 	}
 }
 
+/*
+ * Switch to polling mode.  Typically called by the driver from its interrupt
+ * function: instead of reenabling its interrupt line right away, the driver
+ * may call this function to have its poll function called from the main
+ * message loop with the interrupt line left masked, thus preventing interrupt
+ * livelock at high packet rates.  Polling continues, with a budget that
+ * adapts to the offered load, until the driver calls netdriver_poll_stop().
+ */
+void
+netdriver_poll_start(void)
+{
+
+	assert(netdriver_table != NULL && netdriver_table->ndr_poll != NULL);
+
+	if (polling)
+		return;
+
+	polling = TRUE;
+	poll_budget = NETDRIVER_POLL_BUDGET_MIN;
+}
+
+/*
+ * Leave polling mode.  Called by the driver, typically from its poll
+ * function, once it has run out of work to do.  It is the responsibility of
+ * the driver to reenable its interrupt line again afterwards.
+ */
+void
+netdriver_poll_stop(void)
+{
+
+	polling = FALSE;
+}
+
+/*
+ * If polling mode is active, let the driver make a polling pass, and adapt
+ * the budget for the next pass to the offered load.
+ */
+static void
+netdriver_poll(const struct netdriver * ndp)
+{
+
+	if (!polling || ndp->ndr_poll == NULL)
+		return;
+
+	ndp->ndr_poll(poll_budget);
+
+	/*
+	 * If the driver did not run out of work within the given budget, it
+	 * will have left polling mode active; allow it to do more work per
+	 * pass next time.
+	 */
+	if (polling && poll_budget < NETDRIVER_POLL_BUDGET_MAX)
+		poll_budget <<= 1;
+}
+
 /*
  * A packet send request has finished.  Send a reply and clean up.
  */
@@ -349,6 +417,20 @@ netdriver_send(void)
 	}
 }
 
+/*
+ * Return TRUE if more send requests are pending beyond the one currently
+ * being processed, or FALSE otherwise.  This function may be called from
+ * within the driver's send function, to decide whether per-packet operations
+ * that are expensive but may cover multiple packets at once (typically device
+ * doorbell writes) can be deferred to a later packet in the same burst.
+ */
+int
+netdriver_send_pending(void)
+{
+
+	return (pending_sends > 1);
+}
+
 /*
  * Process a request to send or receive a packet.
  */
@@ -519,6 +601,13 @@ do_conf(const struct netdriver * __restrict ndp,
 			while (pending_recvs > 0)
 				finish_recv(EINTR);
 
+			/*
+			 * Also leave polling mode; a driver that supports
+			 * being taken down is expected to mask interrupt
+			 * sources itself as part of that.
+			 */
+			polling = FALSE;
+
 			up = FALSE;
 		} else
 			up = TRUE;
@@ -787,6 +876,8 @@ netdriver_process(const struct netdriver * __restrict ndp,
 				ndp->ndr_other(m_ptr, ipc_status);
 		}
 
+		netdriver_poll(ndp);
+
 		return;
 	}
 
@@ -829,6 +920,8 @@ netdriver_process(const struct netdriver * __restrict ndp,
 		if (ndp->ndr_other != NULL)
 			ndp->ndr_other(m_ptr, ipc_status);
 	}
+
+	netdriver_poll(ndp);
 }
 
 /*
@@ -895,6 +988,8 @@ netdriver_init(const struct netdriver * ndp)
 
 	up = FALSE;
 
+	polling = FALSE;
+
 	ticks = 0;
 
 	/* Get the device instance number. */
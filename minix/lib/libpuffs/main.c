@@ -4,6 +4,7 @@
 static message fs_msg;
 static int fs_ipc_status;
 static int fs_pending;
+static int fs_active;	/* number of file system requests being handled */
 
 #define PUFFS_MAX_ARGS 20
 
@@ -61,7 +62,16 @@ static int get_work(message *msg, int *ipc_status)
 	}
 	if (msg->m_source == VFS_PROC_NR)
 		break;
-	lpuffs_debug("libpuffs: unexpected source %d\n", msg->m_source);
+
+	/* Not a VFS request; hand it to the fdr_other hook, if one is set.
+	 * The hook may schedule parked requests.  If any requests are
+	 * parked, return to the main loop, so that scheduled requests get
+	 * resumed and the loop function gets a chance to run.
+	 */
+	fsdriver_process(&puffs_table, msg, *ipc_status, FALSE);
+
+	if (fs_active > 0)
+		return EAGAIN;
   }
 
   return r;
@@ -115,6 +125,41 @@ int __wrap_main(int argc, char *argv[])
   return __real_main(new_argc, new_argv);
 }
 
+/*===========================================================================*
+ *				lpuffs_dispatch				     *
+ *===========================================================================*/
+static void lpuffs_dispatch(struct puffs_cc *pcc)
+{
+/* Handle one VFS request on its own call context.  The file system may park
+ * the request with puffs_cc_yield() while it waits for a slow backend, after
+ * which the main loop resumes serving other requests.  A parked request is
+ * continued once the file system schedules its call context again, using
+ * puffs_cc_schedule().  Since requests may thus complete out of order, the
+ * replies to VFS are sent asynchronously.
+ */
+  message m;
+  int ipc_status;
+
+  /* Copy the request onto this context's own stack before the file system
+   * gets a chance to yield, at which point the global receive buffer will be
+   * reused for the next request.
+   */
+  m = fs_msg;
+  ipc_status = fs_ipc_status;
+
+  fs_active++;
+
+  fsdriver_process(&puffs_table, &m, ipc_status, TRUE /*asyn_reply*/);
+
+  fs_active--;
+
+  /* Mark the context as finished, so that yielding recycles it, and jump
+   * back to whichever context last handed control to this request.
+   */
+  pcc->pcc_flags |= PCC_DONE;
+  puffs_cc_yield(pcc);
+}
+
 /*
  * Receive a message unless one was already pending.  Process the message, and
  * send a reply if necessary.  Return whether puffs should keep running.
@@ -122,14 +167,27 @@ int __wrap_main(int argc, char *argv[])
 int
 lpuffs_pump(void)
 {
+	struct puffs_cc *pcc;
 
 	if (fs_pending == TRUE || get_work(&fs_msg, &fs_ipc_status) == OK) {
 		fs_pending = FALSE;
 
-		fsdriver_process(&puffs_table, &fs_msg, fs_ipc_status, FALSE);
+		/* Handle the request on a call context of its own, so that
+		 * it can be parked and resumed.  If no context can be set
+		 * up, fall back to handling the request on the current
+		 * stack, which merely keeps it from yielding.
+		 */
+		if (puffs__cc_create(global_pu, lpuffs_dispatch, &pcc) == 0)
+			puffs__goto(pcc);
+		else
+			fsdriver_process(&puffs_table, &fs_msg, fs_ipc_status,
+			    TRUE /*asyn_reply*/);
 	}
 
-	return mounted || !exitsignaled;
+	/* Keep running while requests are parked, even past unmount time:
+	 * they must be given a chance to complete and be replied to.
+	 */
+	return mounted || !exitsignaled || fs_active > 0;
 }
 
 /*
@@ -28,7 +28,10 @@ int fs_mount(dev_t __unused dev, unsigned int flags,
   root_node->fn_gid = root_va->va_gid;
   root_node->fn_dev = NO_DEV;
 
-  *res_flags = RES_NOFLAGS;
+  /* Each request is handled on a call context of its own, and may be parked
+   * to make way for other requests, so let VFS send requests concurrently.
+   */
+  *res_flags = RES_THREADED;
 
   mounted = TRUE;
 
@@ -8,11 +8,13 @@
 #include <sys/param.h>
 
 
+/* The buffers below are allocated per request: a request may be parked
+ * inside the file system operation while other requests are being served,
+ * so the buffers cannot be shared between requests.
+ */
 #define GETDENTS_BUFSIZ  4096
-static char getdents_buf[GETDENTS_BUFSIZ];
 
 #define RW_BUFSIZ	(128 * 1024)
-static char rw_buf[RW_BUFSIZ];
 
 
 /*===========================================================================*
@@ -24,6 +26,7 @@ ssize_t fs_read(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
   int r;
   size_t bytes_left, bytes_done;
   struct puffs_node *pn;
+  char *rw_buf;
   PUFFS_MAKECRED(pcr, &global_kcred);
 
   if ((pn = puffs_pn_nodewalk(global_pu, find_inode_cb, &ino_nr)) == NULL) {
@@ -31,28 +34,36 @@ ssize_t fs_read(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
         return(EINVAL);
   }
 
-  if (bytes > sizeof(rw_buf))
-	bytes = sizeof(rw_buf);
-  bytes_left = bytes;
-
   if (global_pu->pu_ops.puffs_node_read == NULL)
 	return(EINVAL);
 
+  if ((rw_buf = malloc(RW_BUFSIZ)) == NULL)
+	return(ENOMEM);
+
+  if (bytes > RW_BUFSIZ)
+	bytes = RW_BUFSIZ;
+  bytes_left = bytes;
+
   r = global_pu->pu_ops.puffs_node_read(global_pu, pn, (uint8_t *)rw_buf,
 						pos, &bytes_left, pcr, 0);
   if (r) {
 	lpuffs_debug("puffs_node_read failed\n");
+	free(rw_buf);
 	return(EINVAL);
   }
 
   bytes_done = bytes - bytes_left;
 
   if (bytes_done > 0) {
-	if ((r = fsdriver_copyout(data, 0, rw_buf, bytes_done)) != OK)
+	if ((r = fsdriver_copyout(data, 0, rw_buf, bytes_done)) != OK) {
+		free(rw_buf);
 		return r;
+	}
 	update_timens(pn, ATIME, NULL);
   }
 
+  free(rw_buf);
+
   return (ssize_t)bytes_done;
 }
 
@@ -68,6 +79,7 @@ ssize_t fs_write(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
   struct puffs_node *pn;
   struct vattr va;
   struct timespec cur_time;
+  char *rw_buf;
   PUFFS_MAKECRED(pcr, &global_kcred);
 
   if ((pn = puffs_pn_nodewalk(global_pu, find_inode_cb, &ino_nr)) == NULL) {
@@ -75,14 +87,15 @@ ssize_t fs_write(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
         return(EINVAL);
   }
 
-  if (bytes > sizeof(rw_buf))
-	bytes = sizeof(rw_buf);
+  if (global_pu->pu_ops.puffs_node_setattr == NULL ||
+      global_pu->pu_ops.puffs_node_write == NULL)
+	return(EINVAL);
+
+  if (bytes > RW_BUFSIZ)
+	bytes = RW_BUFSIZ;
   bytes_left = bytes;
 
   /* At first try to change vattr */
-  if (global_pu->pu_ops.puffs_node_setattr == NULL)
-	return(EINVAL);
-
   (void)clock_time(&cur_time);
 
   puffs_vattr_null(&va);
@@ -94,14 +107,19 @@ ssize_t fs_write(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
   r = global_pu->pu_ops.puffs_node_setattr(global_pu, pn, &va, pcr);
   if (r) return(EINVAL);
 
-  if ((r = fsdriver_copyin(data, 0, rw_buf, bytes)) != OK)
-	return r;
+  if ((rw_buf = malloc(RW_BUFSIZ)) == NULL)
+	return(ENOMEM);
 
-  if (global_pu->pu_ops.puffs_node_write == NULL)
-	return(EINVAL);
+  if ((r = fsdriver_copyin(data, 0, rw_buf, bytes)) != OK) {
+	free(rw_buf);
+	return r;
+  }
 
   r = global_pu->pu_ops.puffs_node_write(global_pu, pn, (uint8_t *)rw_buf,
 						pos, &bytes_left, pcr, 0);
+
+  free(rw_buf);
+
   if (r != OK) return(EINVAL);
 
   return (ssize_t)(bytes - bytes_left);
@@ -119,6 +137,7 @@ ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
   size_t buf_left, written;
   struct dirent *dent;
   int eofflag = 0;
+  char *getdents_buf;
   PUFFS_MAKECRED(pcr, &global_kcred);
 
   if ((pn = puffs_pn_nodewalk(global_pu, find_inode_cb, &ino_nr)) == NULL) {
@@ -126,9 +145,12 @@ ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
         return(EINVAL);
   }
 
-  if (bytes > sizeof(getdents_buf))
-	  bytes = sizeof(getdents_buf);
-  memset(getdents_buf, 0, sizeof(getdents_buf)); /* Avoid leaking any data */
+  if ((getdents_buf = malloc(GETDENTS_BUFSIZ)) == NULL)
+	return(ENOMEM);
+
+  if (bytes > GETDENTS_BUFSIZ)
+	  bytes = GETDENTS_BUFSIZ;
+  memset(getdents_buf, 0, GETDENTS_BUFSIZ); /* Avoid leaking any data */
 
   buf_left = bytes;
 
@@ -138,6 +160,7 @@ ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
 						&buf_left, pcr, &eofflag, 0, 0);
   if (r) {
 	lpuffs_debug("puffs_node_readdir returned error\n");
+	free(getdents_buf);
 	return(EINVAL);
   }
 
@@ -146,14 +169,19 @@ ssize_t fs_getdents(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
 
   if (written == 0 && !eofflag) {
 	lpuffs_debug("The user's buffer is too small\n");
+	free(getdents_buf);
 	return(EINVAL);
   }
 
   if (written) {
-	if ((r = fsdriver_copyout(data, 0, getdents_buf, written)) != OK)
+	if ((r = fsdriver_copyout(data, 0, getdents_buf, written)) != OK) {
+		free(getdents_buf);
 		return r;
+	}
   }
 
+  free(getdents_buf);
+
   update_timens(pn, ATIME, NULL);
 
   /* The puffs readdir call has already updated the position. */
@@ -110,6 +110,8 @@ static void del_one_dentry(struct inode *ino)
 
   ino->i_name[0] = 0;
 
+  flush_attr(ino);
+
   unlink_inode(ino);
 }
 
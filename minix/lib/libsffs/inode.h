@@ -66,11 +66,14 @@ struct inode {
 	sffs_file_t i_file;		/* handle to open file */
 	sffs_dir_t i_dir;		/* handle to open directory */
   };
+  struct sffs_attr i_attr;		/* cached attributes (if I_ATTR set) */
+  clock_t i_attr_time;			/* time the attributes were cached */
   char i_name[NAME_MAX+1];		/* entry name in parent directory */
 };
 
 #define I_DIR		0x01		/* this inode represents a directory */
 #define I_HANDLE	0x02		/* this inode has an open handle */
+#define I_ATTR		0x04		/* this inode has cached attributes */
 
 /* warning: the following line is not a proper macro */
 #define INODE_NR(i)	(((i)->i_gen << NUM_INODE_BITS) | (i)->i_num)
@@ -107,6 +107,9 @@ int do_create(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid,
 
   add_dentry(parent, name, ino);
 
+  /* The directory contents have changed on the host. */
+  flush_attr(parent);
+
   node->fn_ino_nr = INODE_NR(ino);
   node->fn_mode = get_mode(ino, attr.a_mode);
   node->fn_size = attr.a_size;
@@ -157,6 +160,9 @@ int do_mkdir(ino_t dir_nr, char *name, mode_t mode, uid_t uid, gid_t gid)
 	put_inode(ino);
   }
 
+  /* The directory contents have changed on the host. */
+  flush_attr(parent);
+
   return OK;
 }
 
@@ -254,6 +260,9 @@ int do_unlink(ino_t dir_nr, char *name, int call)
 	put_inode(ino);
   }
 
+  /* The directory contents have changed on the host. */
+  flush_attr(parent);
+
   return OK;
 }
 
@@ -295,6 +304,9 @@ int do_rmdir(ino_t dir_nr, char *name, int call)
 	put_inode(ino);
   }
 
+  /* The directory contents have changed on the host. */
+  flush_attr(parent);
+
   return OK;
 }
 
@@ -355,6 +367,8 @@ int do_rename(ino_t old_dir_nr, char *old_name, ino_t new_dir_nr,
 
   /* If the old dentry existed, rename it accordingly. */
   if (old_ino != NULL) {
+	flush_attr(old_ino);
+
 	del_dentry(old_ino);
 
 	add_dentry(new_parent, new_name, old_ino);
@@ -362,5 +376,9 @@ int do_rename(ino_t old_dir_nr, char *old_name, ino_t new_dir_nr,
 	put_inode(old_ino);
   }
 
+  /* The contents of both directories have changed on the host. */
+  flush_attr(old_parent);
+  flush_attr(new_parent);
+
   return OK;
 }
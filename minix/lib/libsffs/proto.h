@@ -69,6 +69,7 @@ int do_chmod(ino_t ino_nr, mode_t *mode);
 int do_utime(ino_t ino_nr, struct timespec *atime, struct timespec *mtime);
 
 /* verify.c */
+void flush_attr(struct inode *ino);
 int verify_path(char *path, struct inode *ino, struct sffs_attr *attr,
 	int *stale);
 int verify_inode(struct inode *ino, char path[PATH_MAX],
@@ -114,6 +114,8 @@ int do_chmod(ino_t ino_nr, mode_t *mode)
   if ((r = sffs_table->t_setattr(path, &attr)) != OK)
 	return r;
 
+  flush_attr(ino);
+
   /* We have no idea what really happened. Query for the mode again. */
   if ((r = verify_path(path, ino, &attr, NULL)) != OK)
 	return r;
@@ -172,5 +174,8 @@ int do_utime(ino_t ino_nr, struct timespec *atime, struct timespec *mtime)
 	break;
   }
 
-  return sffs_table->t_setattr(path, &attr);
+  if ((r = sffs_table->t_setattr(path, &attr)) == OK)
+	flush_attr(ino);
+
+  return r;
 }
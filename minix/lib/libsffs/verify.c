@@ -1,6 +1,7 @@
 /* This file contains routines that verify inodes and paths against the host.
  *
  * The entry points into this file are:
+ *   flush_attr		invalidate the cached attributes of an inode
  *   verify_path	check whether a path,inode pair is still valid
  *   verify_inode	construct a path for an inode and verify the inode
  *   verify_dentry	check a directory inode and look for a directory entry
@@ -11,6 +12,63 @@
 
 #include "inc.h"
 
+#define ALL_ATTRS	(SFFS_ATTR_MODE | SFFS_ATTR_SIZE | SFFS_ATTR_CRTIME | \
+			SFFS_ATTR_ATIME | SFFS_ATTR_MTIME | SFFS_ATTR_CTIME)
+
+/*===========================================================================*
+ *				flush_attr				     *
+ *===========================================================================*/
+void flush_attr(struct inode *ino)
+{
+/* Invalidate the cached attributes of the given inode. Must be called
+ * whenever an operation changes any of the inode's attributes on the host.
+ */
+
+  ino->i_flags &= ~I_ATTR;
+}
+
+/*===========================================================================*
+ *				cache_attr				     *
+ *===========================================================================*/
+static void cache_attr(struct inode *ino, const struct sffs_attr *attr)
+{
+/* Cache a full, freshly retrieved set of attributes for the given inode.
+ */
+
+  if (sffs_params->p_attr_ttl == 0) return;
+
+  ino->i_attr = *attr;
+  ino->i_attr_time = getticks();
+  ino->i_flags |= I_ATTR;
+}
+
+/*===========================================================================*
+ *				get_cached_attr				     *
+ *===========================================================================*/
+static int get_cached_attr(struct inode *ino, struct sffs_attr *attr)
+{
+/* If the given inode has cached attributes that have not yet expired, copy
+ * them into the given attribute structure and return TRUE. Return FALSE
+ * otherwise. Expiration means that changes made on the host side may go
+ * unnoticed for up to the configured number of seconds, which is exactly the
+ * tradeoff that enabling the attribute cache implies.
+ */
+
+  if (!(ino->i_flags & I_ATTR))
+	return FALSE;
+
+  if ((u32_t) (getticks() - ino->i_attr_time) >
+		sffs_params->p_attr_ttl * sys_hz()) {
+	flush_attr(ino);
+
+	return FALSE;
+  }
+
+  *attr = ino->i_attr;
+
+  return TRUE;
+}
+
 /*===========================================================================*
  *				verify_path				     *
  *===========================================================================*/
@@ -31,6 +89,18 @@ int verify_path(char path[PATH_MAX], struct inode *ino,
 
   attr->a_mask |= SFFS_ATTR_MODE;
 
+  /* The inode was checked against the host when its attributes were cached,
+   * so as long as the cached copy is fresh, skip the host round trip.
+   */
+  if (get_cached_attr(ino, attr))
+	return OK;
+
+  /* Always retrieve the full set of attributes, so that the cached copy can
+   * satisfy any subsequent query within the time-to-live.
+   */
+  if (sffs_params->p_attr_ttl > 0)
+	attr->a_mask |= ALL_ATTRS;
+
   r = sffs_table->t_getattr(path, attr);
 
   dprintf(("%s: verify_path: getattr('%s') returned %d\n",
@@ -52,6 +122,8 @@ int verify_path(char path[PATH_MAX], struct inode *ino,
 	return ENOENT; /* path is valid, inode wasn't */
   }
 
+  cache_attr(ino, attr);
+
   return OK; /* path and inode are valid */
 }
 
@@ -56,6 +56,10 @@ static ssize_t write_file(struct inode *ino, off_t pos, size_t count,
 	pos += r;
   }
 
+  /* The write changed the file's size and times on the host. */
+  if (off > 0)
+	flush_attr(ino);
+
   if (r < 0)
 	return r;
 
@@ -114,7 +118,8 @@ int do_trunc(ino_t ino_nr, off_t start, off_t end)
 	attr.a_mask = SFFS_ATTR_SIZE;
 	attr.a_size = start;
 
-	r = sffs_table->t_setattr(path, &attr);
+	if ((r = sffs_table->t_setattr(path, &attr)) == OK)
+		flush_attr(ino);
   } else {
 	/* Write zeroes to the file. We can't create holes. */
 	if (end <= start) return EINVAL;
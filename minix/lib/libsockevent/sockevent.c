@@ -2566,15 +2566,52 @@ sockevent_init(sockevent_socket_cb_t socket_cb)
 }
 
 /*
- * Process a socket driver request message.
+ * Defer processing of events raised through sockevent_raise() until the
+ * matching sockevent_flush() call.  The socket driver may use this around
+ * work that is not initiated by a socket driver request--for example, the
+ * handling of device driver replies--so that events raised on multiple
+ * sockets, or repeatedly on one socket, are coalesced and processed in one
+ * batch rather than one at a time.
  */
 void
-sockevent_process(const message * m_ptr, int ipc_status)
+sockevent_defer(void)
 {
 
-	/* Block events until after we have processed the request. */
 	assert(!sockevent_working);
 	sockevent_working = TRUE;
+}
+
+/*
+ * End a window opened with sockevent_defer(), processing all events that were
+ * raised and queued up since then.
+ */
+void
+sockevent_flush(void)
+{
+
+	assert(sockevent_working);
+
+	if (sockevent_has_events())
+		sockevent_pump();
+
+	sockevent_working = FALSE;
+}
+
+/*
+ * Process a socket driver request message.
+ */
+void
+sockevent_process(const message * m_ptr, int ipc_status)
+{
+	int working;
+
+	/*
+	 * Block events until after we have processed the request.  The caller
+	 * may already have blocked events with sockevent_defer(), in which
+	 * case the events are to be processed by sockevent_flush() instead.
+	 */
+	if ((working = sockevent_working) == FALSE)
+		sockevent_working = TRUE;
 
 	/* Actually process the request. */
 	sockdriver_process(&sockevent_tab, m_ptr, ipc_status);
@@ -2583,8 +2620,10 @@ sockevent_process(const message * m_ptr, int ipc_status)
 	 * If any events were fired while processing the request, they will
 	 * have been queued for later.  Go through them now.
 	 */
-	if (sockevent_has_events())
-		sockevent_pump();
+	if (working == FALSE) {
+		if (sockevent_has_events())
+			sockevent_pump();
 
-	sockevent_working = FALSE;
+		sockevent_working = FALSE;
+	}
 }
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <sys/mman.h>
+#include <sys/param.h>
 #include <minix/sysutil.h>
 
 void *alloc_contig(size_t len, int flags, phys_bytes *phys)
@@ -41,3 +42,82 @@ int free_contig(void *addr, size_t len)
 	return sef_llvm_ac_munmap(addr, len);
 }
 
+/*
+ * Initialize a pool of 'count' DMA buffers of 'bufsize' bytes each.  The
+ * buffers are carved out of a single physically contiguous region, allocated
+ * here with the given AC_* flags, so that the per-buffer operations below
+ * never have to go to VM.  Return OK or an error code.
+ */
+int dma_pool_init(struct dma_pool *pool, size_t bufsize, unsigned int count,
+	int flags)
+{
+	char *buf;
+	unsigned int i;
+
+	if (bufsize == 0 || count == 0)
+		return EINVAL;
+
+	/* The free list is kept in the buffers themselves. */
+	if (bufsize < sizeof(void *))
+		bufsize = sizeof(void *);
+	bufsize = roundup(bufsize, sizeof(void *));
+
+	pool->dp_base = alloc_contig(bufsize * count, flags, &pool->dp_phys);
+	if (pool->dp_base == NULL)
+		return ENOMEM;
+
+	pool->dp_bufsize = bufsize;
+	pool->dp_count = count;
+	pool->dp_free = NULL;
+
+	/* Chain all buffers into the free list. */
+	for (i = 0; i < count; i++) {
+		buf = (char *)pool->dp_base + (size_t)i * bufsize;
+		*(void **)buf = pool->dp_free;
+		pool->dp_free = buf;
+	}
+
+	return OK;
+}
+
+/*
+ * Take a buffer from the pool's free list.  If 'phys' is non-NULL, it is
+ * filled with the physical address of the buffer.  Return the buffer, or NULL
+ * if the pool has run dry.
+ */
+void *dma_pool_alloc(struct dma_pool *pool, phys_bytes *phys)
+{
+	void *buf;
+
+	if ((buf = pool->dp_free) == NULL)
+		return NULL;
+	pool->dp_free = *(void **)buf;
+
+	if (phys != NULL)
+		*phys = pool->dp_phys +
+		    (phys_bytes)((char *)buf - (char *)pool->dp_base);
+
+	return buf;
+}
+
+/*
+ * Return a buffer, previously obtained from dma_pool_alloc, to the pool.
+ */
+void dma_pool_free(struct dma_pool *pool, void *buf)
+{
+
+	*(void **)buf = pool->dp_free;
+	pool->dp_free = buf;
+}
+
+/*
+ * Release the memory of a pool.  All of its buffers must have been freed.
+ */
+void dma_pool_cleanup(struct dma_pool *pool)
+{
+
+	(void)free_contig(pool->dp_base, pool->dp_bufsize * pool->dp_count);
+	pool->dp_base = NULL;
+	pool->dp_free = NULL;
+}
+
@@ -19,25 +19,23 @@ static asynmsg_t msgtable[ASYN_NR];
 static int first_slot = 0, next_slot = 0;
 static int initialized = 0;
 
+static int inside = 0;
+
 /*===========================================================================*
- *				asynsend3				     *
+ *				asyn_put				     *
  *===========================================================================*/
-int asynsend3(dst, mp, fl)
+static int asyn_put(dst, mp, fl)
 endpoint_t dst;
 message *mp;
 int fl;
 {
+/* Claim a free slot in the message table and fill it in. The caller is
+ * responsible for making the kernel rescan the table with senda_reload().
+ */
   int i, r, src_ind, dst_ind;
   unsigned flags;
-  static int inside = 0;
   int needack = 0;
 
-  /* Debug printf() causes asynchronous sends? */
-  if (inside)	/* Panic will not work either then, so exit */
-	exit(1);
-
-  inside = 1;
-
   if(!initialized) {
   	/* Initialize table by marking all entries empty */
 	for (i = 0; i < ASYN_NR; i++) msgtable[i].flags = AMF_EMPTY;
@@ -131,9 +129,65 @@ int fl;
 					 	 */
   next_slot++;
 
+  return OK;
+}
+
+/*===========================================================================*
+ *				asynsend3				     *
+ *===========================================================================*/
+int asynsend3(dst, mp, fl)
+endpoint_t dst;
+message *mp;
+int fl;
+{
+  int r;
+
+  /* Debug printf() causes asynchronous sends? */
+  if (inside)	/* Panic will not work either then, so exit */
+	exit(1);
+
+  inside = 1;
+
+  r = asyn_put(dst, mp, fl);
+
   /* Reload. */
   inside = 0;
-  r = senda_reload();
+  if (r == OK)
+	r = senda_reload();
+
+  return r;
+}
+
+/*===========================================================================*
+ *				asynsendv				     *
+ *===========================================================================*/
+int asynsendv(vec, count, fl)
+asynvec_t *vec;
+int count;
+int fl;
+{
+/* Queue a whole vector of (destination, message) pairs and hand the table to
+ * the kernel in a single SENDA trap, rather than one trap per message as a
+ * run of asynsend() calls would. The kernel walks the table once and
+ * delivers all entries whose destinations are ready.
+ */
+  int i, r;
+
+  if (inside)	/* See asynsend3() */
+	exit(1);
+
+  inside = 1;
+
+  r = OK;
+  for (i = 0; i < count; i++) {
+	if ((r = asyn_put(vec[i].dst, &vec[i].msg, fl)) != OK)
+		break;
+  }
+
+  /* Reload once for the entire batch. */
+  inside = 0;
+  if (r == OK)
+	r = senda_reload();
 
   return r;
 }
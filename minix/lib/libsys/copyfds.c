@@ -0,0 +1,34 @@
+
+#include "syslib.h"
+
+#include <string.h>
+
+/*
+ * Copy a batch of up to COPYFD_MAX file descriptors between this process and
+ * another process, in a single VFS call.  The given array is updated in place
+ * with the resulting file descriptors.  The batch is transferred in its
+ * entirety or not at all: on failure, a negative error code is returned and
+ * no file descriptors have been copied.
+ */
+int
+copyfds(endpoint_t endpt, int * fds, unsigned int nfds, int what)
+{
+	message m;
+	int r;
+
+	if (nfds == 0 || nfds > COPYFD_MAX)
+		return EINVAL;
+
+	memset(&m, 0, sizeof(m));
+	m.m_lsys_vfs_copyfd.endpt = endpt;
+	m.m_lsys_vfs_copyfd.what = what;
+	m.m_lsys_vfs_copyfd.nfds = nfds;
+	memcpy(m.m_lsys_vfs_copyfd.fds, fds, sizeof(fds[0]) * nfds);
+
+	if ((r = _taskcall(VFS_PROC_NR, VFS_COPYFD, &m)) != OK)
+		return r;
+
+	memcpy(fds, m.m_vfs_lsys_copyfds.fds, sizeof(fds[0]) * nfds);
+
+	return OK;
+}
@@ -1,9 +1,18 @@
 
 #include <minix/ds.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "syslib.h"
 
+/* Local copy of the label snapshot exported by DS, used to resolve labels
+ * without a round trip to DS.  See ds_snap_lookup() below.
+ */
+static cp_grant_id_t ds_snap_grant = GRANT_INVALID;
+static struct ds_snap *ds_snap_copy = NULL;
+static u32_t ds_snap_seq = 0;		/* sequence of the local copy */
+static int ds_snap_broken = FALSE;	/* DS does not support snapshots */
+
 static int do_invoke_ds(message *m, int type, const char *ds_name)
 {
 	cp_grant_id_t g_key;
@@ -100,11 +109,100 @@ int ds_retrieve_label_name(char *ds_name, endpoint_t endpoint)
 	return r;
 }
 
+static int ds_snap_lookup(const char *ds_name, endpoint_t *endpoint)
+{
+/* Try to resolve a label using the snapshot that DS exports through a memory
+ * grant (see DS_SNAPSHOT).  On first use, ask DS for the grant; after that,
+ * the only IPC per lookup is a small kernel copy of the sequence number, plus
+ * a copy of the whole table whenever it changed.  Return OK or ESRCH for an
+ * authoritative answer, or any other error to make the caller fall back to a
+ * regular DS_RETRIEVE call.
+ */
+	message m;
+	u32_t seq;
+	int i, tries, r;
+
+	if(ds_snap_broken)
+		return EGENERIC;
+
+	if(ds_snap_copy == NULL &&
+	    (ds_snap_copy = malloc(sizeof(*ds_snap_copy))) == NULL)
+		return ENOMEM;
+
+	/* Obtain the snapshot grant from DS, once. */
+	if(!GRANT_VALID(ds_snap_grant)) {
+		memset(&m, 0, sizeof(m));
+		if((r = _taskcall(DS_PROC_NR, DS_SNAPSHOT, &m)) != OK) {
+			/* Probably an old DS; do not keep trying. */
+			ds_snap_broken = TRUE;
+			return r;
+		}
+		if(m.m_ds_reply.val_len != DS_SNAP_NR) {
+			/* Layout mismatch; do not touch the snapshot. */
+			ds_snap_broken = TRUE;
+			return EGENERIC;
+		}
+		ds_snap_grant = m.m_ds_reply.val_out.grant;
+		ds_snap_seq = 0;
+	}
+
+	for(tries = 0; tries < 5; tries++) {
+		/* Get the current sequence number.  The sequence number is at
+		 * the start of the snapshot, and odd while DS is changing it.
+		 */
+		if((r = sys_safecopyfrom(DS_PROC_NR, ds_snap_grant, 0,
+		    (vir_bytes) &seq, sizeof(seq))) != OK) {
+			/* DS may have restarted; get a new grant next time. */
+			ds_snap_grant = GRANT_INVALID;
+			ds_snap_seq = 0;
+			return r;
+		}
+		if(seq & 1)
+			continue;
+		if(seq != ds_snap_seq) {
+			/* Our copy is stale; fetch the whole table. */
+			if((r = sys_safecopyfrom(DS_PROC_NR, ds_snap_grant, 0,
+			    (vir_bytes) ds_snap_copy,
+			    sizeof(*ds_snap_copy))) != OK) {
+				ds_snap_grant = GRANT_INVALID;
+				ds_snap_seq = 0;
+				return r;
+			}
+			if(ds_snap_copy->ds_seq != seq)
+				continue;	/* raced with an update */
+			ds_snap_seq = seq;
+		}
+
+		/* The local copy is consistent, so a miss means the label
+		 * really is not there.
+		 */
+		for(i = 0; i < DS_SNAP_NR; i++) {
+			if(ds_snap_copy->ds_entry[i].dse_key[0] != '\0' &&
+			    !strcmp(ds_snap_copy->ds_entry[i].dse_key,
+			    ds_name)) {
+				*endpoint =
+				    ds_snap_copy->ds_entry[i].dse_endpt;
+				return OK;
+			}
+		}
+		return ESRCH;
+	}
+
+	return EGENERIC;	/* DS keeps updating; fall back to IPC */
+}
+
 int ds_retrieve_label_endpt(const char *ds_name, endpoint_t *endpoint)
 {
 	message m;
 	int r;
 
+	/* Label lookups are frequent, in particular on service restart
+	 * recovery paths, so first try to resolve the label from the local
+	 * snapshot, without a round trip to DS.
+	 */
+	if((r = ds_snap_lookup(ds_name, endpoint)) == OK || r == ESRCH)
+		return r;
+
 	memset(&m, 0, sizeof(m));
 	m.m_ds_req.flags = DSF_TYPE_LABEL;
 	r = do_invoke_ds(&m, DS_RETRIEVE, ds_name);
@@ -0,0 +1,38 @@
+#include "sysutil.h"
+
+#include <minix/endpoint.h>
+
+/*
+ * Translate the given endpoint to a kernel process slot number, using the
+ * endpoint validation table that the kernel maps read-only into all
+ * processes.  This validates the endpoint, including its generation number,
+ * in two memory loads and without a kernel call.  Return OK with the slot
+ * number stored in 'proc_nr' if the endpoint names a live process, EINVAL if
+ * the endpoint is malformed, EDEADEPT if the endpoint is stale or its slot is
+ * free, or ENOSYS if the kernel does not export the endpoint table.  As with
+ * any endpoint check, a positive result is authoritative only for as long as
+ * the named process cannot exit.
+ */
+int
+endpt_proc_nr(endpoint_t endpt, int * proc_nr)
+{
+	struct minix_kerninfo *minix_kerninfo;
+	volatile struct kendpointinfo *kei;
+	int p;
+
+	minix_kerninfo = get_minix_kerninfo();
+
+	if (!(minix_kerninfo->ki_flags & MINIX_KIF_ENDPTINFO))
+		return ENOSYS;
+	kei = minix_kerninfo->kendpointinfo;
+
+	p = _ENDPOINT_P(endpt);
+	if (p < -kei->kei_nr_tasks || p >= kei->kei_nr_procs)
+		return EINVAL;
+
+	if (kei->kei_endpoint[p + kei->kei_nr_tasks] != endpt)
+		return EDEADEPT;
+
+	*proc_nr = p;
+	return OK;
+}
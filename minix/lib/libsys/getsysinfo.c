@@ -21,7 +21,12 @@ int getsysinfo(
   case RS_PROC_NR: call_nr = RS_GETSYSINFO; break;
   case DS_PROC_NR: call_nr = DS_GETSYSINFO; break;
   default:
-	return ENOSYS;
+	/* Services without a fixed endpoint, such as IS, accept the generic
+	 * request. The caller is expected to have looked up the endpoint of
+	 * a service that actually implements it.
+	 */
+	call_nr = IS_GETSYSINFO;
+	break;
   }
 
   memset(&m, 0, sizeof(m));
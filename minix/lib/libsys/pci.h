@@ -1 +1,8 @@
+#include <minix/syslib.h>	/* for struct pci_dev_info */
+
 extern int pci_procnr;
+
+/* Cached device enumeration snapshot (see pci_get_devs.c). */
+extern struct pci_dev_info pci_devcache[];
+extern int pci_devcache_n;	/* number of cached entries, or -1 */
+int pci_refresh_devcache(void);
@@ -14,29 +14,30 @@ int *devindp;
 u16_t *vidp;
 u16_t *didp;
 {
+/* Walk the locally cached enumeration snapshot instead of doing one
+ * round trip to the PCI server per device.
+ */
 	int r;
-	message m;
 
-	m.m_type= BUSC_PCI_FIRST_DEV;
-	r= ipc_sendrec(pci_procnr, &m);
-	if (r != 0)
-		panic("pci_first_dev: can't talk to PCI: %d", r);
-	if (m.m_type == 1)
+	if (pci_devcache_n < 0)
+	{
+		r= pci_refresh_devcache();
+		if (r != 0)
+			panic("pci_first_dev: got bad reply from PCI: %d", r);
+	}
+	if (pci_devcache_n == 0)
 	{
-		*devindp= m.m1_i1;
-		*vidp= m.m1_i2;
-		*didp= m.m1_i3;
 #ifdef DEBUG
-		printf("pci_first_dev: got device %d, %04x/%04x\n", 
-			*devindp, *vidp, *didp);
+		printf("pci_first_dev: got nothing\n");
 #endif
-		return 1;
+		return 0;
 	}
-	if (m.m_type != 0)
-		panic("pci_first_dev: got bad reply from PCI: %d", m.m_type);
-
+	*devindp= pci_devcache[0].pdi_devind;
+	*vidp= pci_devcache[0].pdi_vid;
+	*didp= pci_devcache[0].pdi_did;
 #ifdef DEBUG
-	printf("pci_first_dev: got nothing\n");
+	printf("pci_first_dev: got device %d, %04x/%04x\n",
+		*devindp, *vidp, *didp);
 #endif
-	return 0;
+	return 1;
 }
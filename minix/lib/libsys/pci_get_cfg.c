@@ -0,0 +1,45 @@
+/*
+pci_get_cfg.c
+*/
+
+#include "pci.h"
+#include "syslib.h"
+#include <minix/sysutil.h>
+
+/*===========================================================================*
+ *				pci_get_cfg				     *
+ *===========================================================================*/
+int pci_get_cfg(devind, buf, count)
+int devind;
+u32_t *buf;
+size_t count;
+{
+/* Read a snapshot of the first 'count' 32-bit registers of the device's
+ * configuration space in a single call, instead of one pci_attr_r32()
+ * round trip per register.
+ */
+	int r;
+	cp_grant_id_t gid;
+	message m;
+
+	gid= cpf_grant_direct(pci_procnr, (vir_bytes)buf,
+		count * sizeof(buf[0]), CPF_WRITE);
+	if (gid == -1)
+	{
+		printf("pci_get_cfg: cpf_grant_direct failed: %d\n",
+			errno);
+		return EINVAL;
+	}
+
+	m.m_type= BUSC_PCI_GET_CFG;
+	m.m1_i1= devind;
+	m.m1_i2= count;
+	m.m1_i3= gid;
+
+	r= ipc_sendrec(pci_procnr, &m);
+	cpf_revoke(gid);
+	if (r != 0)
+		panic("pci_get_cfg: can't talk to PCI: %d", r);
+
+	return m.m_type;
+}
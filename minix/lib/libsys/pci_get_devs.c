@@ -0,0 +1,65 @@
+/*
+pci_get_devs.c
+*/
+
+#include "pci.h"
+#include "syslib.h"
+#include <minix/config.h>
+#include <minix/sysutil.h>
+
+/* Locally cached enumeration snapshot, shared with pci_first_dev.c and
+ * pci_next_dev.c. A fresh snapshot is fetched on first use and invalidated
+ * by pci_init() and pci_rescan_bus().
+ */
+struct pci_dev_info pci_devcache[NR_PCIDEV];
+int pci_devcache_n= -1;
+
+/*===========================================================================*
+ *				pci_get_devs				     *
+ *===========================================================================*/
+int pci_get_devs(buf, max)
+struct pci_dev_info *buf;
+int max;
+{
+/* Fetch the list of devices visible to this driver in a single call,
+ * instead of one pci_first_dev()/pci_next_dev() round trip per device.
+ * Return the number of devices, or a negative error code.
+ */
+	int r;
+	cp_grant_id_t gid;
+	message m;
+
+	gid= cpf_grant_direct(pci_procnr, (vir_bytes)buf,
+		max * sizeof(buf[0]), CPF_WRITE);
+	if (gid == -1)
+	{
+		printf("pci_get_devs: cpf_grant_direct failed: %d\n",
+			errno);
+		return EINVAL;
+	}
+
+	m.m_type= BUSC_PCI_GET_DEVS;
+	m.m1_i1= max;
+	m.m1_i2= gid;
+
+	r= ipc_sendrec(pci_procnr, &m);
+	cpf_revoke(gid);
+	if (r != 0)
+		panic("pci_get_devs: can't talk to PCI: %d", r);
+
+	return m.m_type;
+}
+
+/*===========================================================================*
+ *				pci_refresh_devcache			     *
+ *===========================================================================*/
+int pci_refresh_devcache(void)
+{
+	int r;
+
+	r= pci_get_devs(pci_devcache, NR_PCIDEV);
+	if (r < 0)
+		return r;
+	pci_devcache_n= r;
+	return 0;
+}
@@ -2,6 +2,7 @@
 pci_init.c
 */
 
+#include "pci.h"
 #include "syslib.h"
 #include <minix/ds.h>
 #include <minix/sysutil.h>
@@ -26,5 +27,8 @@ void pci_init(void)
 		panic("pci_init: can't talk to PCI: %d", r);
 	if (m.m_type != 0)
 		panic("pci_init: got bad reply from PCI: %d", m.m_type);
+
+	/* Force a fresh enumeration snapshot on the next lookup. */
+	pci_devcache_n= -1;
 }
 
@@ -14,30 +14,30 @@ int *devindp;
 u16_t *vidp;
 u16_t *didp;
 {
-	int r;
-	message m;
+/* The cached snapshot is in ascending devind order, so the next device
+ * is the first cached entry with a devind above the current one.
+ */
+	int i, r;
 
-	m.m_type= BUSC_PCI_NEXT_DEV;
-	m.m1_i1= *devindp;
-
-	r= ipc_sendrec(pci_procnr, &m);
-	if (r != 0)
-		panic("pci_next_dev: can't talk to PCI: %d", r);
-
-	if (m.m_type == 1)
+	if (pci_devcache_n < 0)
+	{
+		r= pci_refresh_devcache();
+		if (r != 0)
+			panic("pci_next_dev: got bad reply from PCI: %d", r);
+	}
+	for (i= 0; i < pci_devcache_n; i++)
 	{
-		*devindp= m.m1_i1;
-		*vidp= m.m1_i2;
-		*didp= m.m1_i3;
+		if (pci_devcache[i].pdi_devind > *devindp)
+			break;
+	}
+	if (i >= pci_devcache_n)
+		return 0;
+	*devindp= pci_devcache[i].pdi_devind;
+	*vidp= pci_devcache[i].pdi_vid;
+	*didp= pci_devcache[i].pdi_did;
 #if 0
-		printf("pci_next_dev: got device %d, %04x/%04x\n", 
-			*devindp, *vidp, *didp);
+	printf("pci_next_dev: got device %d, %04x/%04x\n",
+		*devindp, *vidp, *didp);
 #endif
-		return 1;
-	}
-	if (m.m_type != 0)
-		panic("pci_next_dev: got bad reply from PCI: %d", m.m_type);
-
-	return 0;
+	return 1;
 }
-
@@ -25,5 +25,8 @@ void pci_rescan_bus(u8_t busnr)
 	{
 		panic("pci_rescan_bus: got bad reply from PCI: %d", m.m_type);
 	}
+
+	/* The rescan may have changed the enumeration. */
+	pci_devcache_n= -1;
 }
 
@@ -1,5 +1,13 @@
 
 /* Library functions to maintain internal data copying tables.
+ *
+ * The grant table is grown dynamically (doubling in size) as more grants are
+ * needed, and free slots are kept on a free list, so both allocating and
+ * revoking a grant take constant time regardless of how many grants are live.
+ * A grant ID consists of a slot index and a per-slot sequence number; the
+ * sequence number is bumped on revocation, so that a stale grant ID neither
+ * passes the checks here nor the kernel's verification, which looks up the
+ * slot by index and compares the sequence number.
  *
  * April 21 2006: Initial version (Ben Gras)
  *
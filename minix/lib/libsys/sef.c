@@ -19,6 +19,17 @@ int sef_self_init_flags;
 int sef_self_receiving;
 int sef_controlled_crash;
 
+/* Heartbeat counter. Bumped for every message the service takes in, and
+ * inspected remotely by RS to see whether the message loop is still making
+ * progress without actually having to ping the service.
+ */
+volatile unsigned long sef_heartbeat_count;
+
+/* Free-running clock value at sef_startup() entry, reported to RS along with
+ * the init result so that it can profile service startup.
+ */
+u64_t sef_startup_timestamp;
+
 /* Extern variables. */
 EXTERN int sef_lu_state;
 EXTERN int __sef_st_before_receive_enabled;
@@ -62,6 +73,12 @@ EXTERN int do_sef_gcov_request(message *m_ptr);
 /* SEF Fault Injection prototypes. */
 EXTERN int do_sef_fi_request(message *m_ptr);
 
+/* SEF Stats prototypes. */
+EXTERN int do_sef_stats_request(message *m_ptr);
+EXTERN void sef_stats_before_receive(void);
+EXTERN void sef_stats_after_receive(int m_type);
+EXTERN int sef_stats_enabled;
+
 /*===========================================================================*
  *				sef_startup				     *
  *===========================================================================*/
@@ -74,6 +91,8 @@ void sef_startup()
   int init_flags;
   int sys_upd_flags = 0;
 
+  read_frclock_64(&sef_startup_timestamp);
+
   /* Get information about self. */
   r = sys_whoami(&sef_self_endpoint, sef_self_name, SEF_SELF_NAME_MAXLEN,
       &priv_flags, &init_flags);
@@ -173,6 +192,13 @@ int sef_receive_status(endpoint_t src, message *m_ptr, int *status_ptr)
       }
 #endif
 
+#if INTERCEPT_SEF_STATS_REQUESTS
+      /* The server is done with the previously handed out message. */
+      if(sef_stats_enabled) {
+          sef_stats_before_receive();
+      }
+#endif
+
       /* Receive and return in case of error. */
       r = ipc_receive(src, m_ptr, &status);
       if(status_ptr) *status_ptr = status;
@@ -180,6 +206,9 @@ int sef_receive_status(endpoint_t src, message *m_ptr, int *status_ptr)
           return r;
       }
 
+      /* Show liveness to RS. */
+      sef_heartbeat_count++;
+
       m_type = m_ptr->m_type;
       if (is_ipc_notify(status)) {
           switch (m_ptr->m_source) {
@@ -260,6 +289,17 @@ int sef_receive_status(endpoint_t src, message *m_ptr, int *status_ptr)
       break;
 #endif
 
+#if INTERCEPT_SEF_STATS_REQUESTS
+      case SEF_STATS_REQUEST_TYPE:
+          /* Intercept SEF Stats requests. */
+          if(IS_SEF_STATS_REQUEST(m_ptr, status)) {
+              if(do_sef_stats_request(m_ptr) == OK) {
+                  continue;
+              }
+          }
+      break;
+#endif
+
       default:
       break;
       }
@@ -270,6 +310,13 @@ int sef_receive_status(endpoint_t src, message *m_ptr, int *status_ptr)
       break;
   }
 
+#if INTERCEPT_SEF_STATS_REQUESTS
+  /* This message is about to be handed to the server. */
+  if(sef_stats_enabled) {
+      sef_stats_after_receive(m_ptr->m_type);
+  }
+#endif
+
   return r;
 }
 
@@ -32,6 +32,8 @@ EXTERN endpoint_t sef_self_endpoint;
 EXTERN endpoint_t sef_self_priv_flags;
 EXTERN endpoint_t sef_self_init_flags;
 EXTERN int sef_controlled_crash;
+EXTERN volatile unsigned long sef_heartbeat_count;
+EXTERN u64_t sef_startup_timestamp;
 
 #ifndef ST_STACK_REFS_BUFF_SIZE
 #define ST_STACK_REFS_BUFF_SIZE           1024
@@ -114,6 +116,13 @@ static int process_init(int type, sef_init_info_t *info)
   m.m_source = sef_self_endpoint;
   m.m_type = RS_INIT;
   m.m_rs_init.result = result;
+  /* Tell RS where our heartbeat counter lives, so that it can check on us
+   * without waking us up.
+   */
+  m.m_rs_init.hb_addr = (vir_bytes) &sef_heartbeat_count;
+  /* Report startup timestamps, so that RS can profile service startup. */
+  m.m_rs_init.sef_tsc = sef_startup_timestamp;
+  read_frclock_64(&m.m_rs_init.init_tsc);
   r = sef_init_cbs.sef_cb_init_response(&m);
   if (r != OK) {
       return r;
@@ -13,6 +13,12 @@
 
 EXTERN endpoint_t sef_self_endpoint;
 
+/* How many memory regions to obtain from VM per call during state transfer.
+ * The old instance is already stopped while its state is copied, so every
+ * round trip to VM saved here directly shortens the live update downtime.
+ */
+#define SEF_STATE_REGION_BATCH	64
+
 /* SEF Live update prototypes for sef_receive(). */
 void do_sef_st_before_receive(void);
 
@@ -49,8 +55,9 @@ int sef_copy_state_region(sef_init_info_t *info,
     vir_bytes address, size_t size, vir_bytes dst_address, int may_have_holes)
 {
   vir_bytes base, top, target;
-  struct vm_region_info vri;
-  int r;
+  struct vm_region_info vris[SEF_STATE_REGION_BATCH];
+  struct vm_region_info *vri;
+  int i, count, done, r;
 
   base = address;
 
@@ -62,15 +69,16 @@ int sef_copy_state_region(sef_init_info_t *info,
       /* memcpy region from current state */
       memcpy((void*) dst_address, (void *)address, size);
   } else if (may_have_holes && sef_self_endpoint != VM_PROC_NR &&
-    vm_info_region(info->old_endpoint, &vri, 1, &base) == 1) {
+    (count = vm_info_region(info->old_endpoint, vris,
+    SEF_STATE_REGION_BATCH, &base)) > 0) {
       /* Perform a safe copy of a region of the old state.  The section may
        * contain holes, so ask VM for the actual regions within the data
-       * section and transfer each one separately.  The alternative, just
-       * copying until a page fault happens, is not possible in the multi-
-       * component-with-VM live update case, where VM may not receive page
-       * faults during the live update window.  For now, we use the region
-       * iteration approach for the data section only; other cases have not
-       * been tested, but may work as well.
+       * section, a batch at a time, and transfer each one separately.  The
+       * alternative, just copying until a page fault happens, is not possible
+       * in the multi-component-with-VM live update case, where VM may not
+       * receive page faults during the live update window.  For now, we use
+       * the region iteration approach for the data section only; other cases
+       * have not been tested, but may work as well.
        */
 #if STATE_TRANS_DEBUG
       printf("sef_copy_state_region: copying %d bytes, addr = 0x%08x -> "
@@ -84,9 +92,9 @@ int sef_copy_state_region(sef_init_info_t *info,
        * find starts above the known base address, blindly copy the area in
        * between.
        */
-      if (vri.vri_addr > address) {
+      if (vris[0].vri_addr > address) {
           if ((r = sys_safecopyfrom(info->old_endpoint, SEF_STATE_TRANSFER_GID,
-            address, dst_address, vri.vri_addr - address)) != OK) {
+            address, dst_address, vris[0].vri_addr - address)) != OK) {
 #if STATE_TRANS_DEBUG
               printf("sef_copy_state_region: sys_safecopyfrom failed\n");
 #endif
@@ -95,25 +103,32 @@ int sef_copy_state_region(sef_init_info_t *info,
       }
 
       top = address + size;
+      done = FALSE;
       do {
-          assert(vri.vri_addr >= address);
-          if (vri.vri_addr >= top)
-              break;
-          if (vri.vri_length > top - vri.vri_addr)
-              vri.vri_length = top - vri.vri_addr;
-          target = dst_address + (vri.vri_addr - address);
-          if ((r = sys_safecopyfrom(info->old_endpoint,
-            SEF_STATE_TRANSFER_GID, vri.vri_addr, target,
-            vri.vri_length)) != OK) {
+          for (i = 0; i < count; i++) {
+              vri = &vris[i];
+              assert(vri->vri_addr >= address);
+              if (vri->vri_addr >= top) {
+                  done = TRUE;
+                  break;
+              }
+              if (vri->vri_length > top - vri->vri_addr)
+                  vri->vri_length = top - vri->vri_addr;
+              target = dst_address + (vri->vri_addr - address);
+              if ((r = sys_safecopyfrom(info->old_endpoint,
+                SEF_STATE_TRANSFER_GID, vri->vri_addr, target,
+                vri->vri_length)) != OK) {
 #if STATE_TRANS_DEBUG
-              printf("sef_copy_state_region: sys_safecopyfrom failed\n");
+                  printf("sef_copy_state_region: sys_safecopyfrom failed\n");
 #endif
-              return r;
+                  return r;
+              }
           }
           /* Save on a VM call if the next address is already too high. */
-          if (base >= top)
+          if (done || base >= top)
               break;
-      } while (vm_info_region(info->old_endpoint, &vri, 1, &base) == 1);
+      } while ((count = vm_info_region(info->old_endpoint, vris,
+        SEF_STATE_REGION_BATCH, &base)) > 0);
   } else {
       /* Perform a safe copy of a region of the old state, without taking into
        * account any holes.  This is the default for anything but the data
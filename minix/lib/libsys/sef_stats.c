@@ -0,0 +1,124 @@
+#include "syslib.h"
+#include <assert.h>
+#include <string.h>
+#include <minix/minlib.h>
+#include <minix/sysutil.h>
+
+/* Whether the SEF message loop should collect statistics. Collection is off
+ * until a SEF_STATS_ENABLE request arrives, so services that nobody watches
+ * pay no more than a flag test per message.
+ */
+int sef_stats_enabled = 0;
+
+static struct sef_stats sef_stats;
+
+static u64_t sef_stats_handout;	/* TSC at the last message handout */
+static int sef_stats_type;	/* type of the message handed out, or 0 */
+
+/*===========================================================================*
+ *			    sef_stats_after_receive			     *
+ *===========================================================================*/
+void sef_stats_after_receive(int m_type)
+{
+/* A message is about to be handed to the server; remember what and when. */
+  read_tsc_64(&sef_stats_handout);
+  sef_stats_type = m_type;
+}
+
+/*===========================================================================*
+ *			    sef_stats_before_receive			     *
+ *===========================================================================*/
+void sef_stats_before_receive(void)
+{
+/* The server is back to receive the next message. If one was handed out
+ * earlier, its service is now complete; bin the elapsed time.
+ */
+  struct sef_stats_slot *slot;
+  u64_t delta;
+  int i, bucket;
+
+  if (sef_stats_type == 0)
+      return;
+
+  read_tsc_64(&delta);
+  delta -= sef_stats_handout;
+
+  bucket = 0;
+  while ((delta >>= 1) != 0 && bucket < SEF_STATS_BUCKETS - 1)
+      bucket++;
+
+  /* Find the slot for this message type, or claim a free one. */
+  slot = NULL;
+  for (i = 0; i < SEF_STATS_SLOTS; i++) {
+      if (sef_stats.st_slot[i].ss_type == sef_stats_type) {
+          slot = &sef_stats.st_slot[i];
+          break;
+      }
+      if (slot == NULL && sef_stats.st_slot[i].ss_type == 0)
+          slot = &sef_stats.st_slot[i];
+  }
+
+  if (slot != NULL) {
+      slot->ss_type = sef_stats_type;
+      slot->ss_count++;
+      slot->ss_bucket[bucket]++;
+  }
+  else {
+      sef_stats.st_untracked++;
+  }
+
+  sef_stats.st_total++;
+  sef_stats_type = 0;
+}
+
+/*===========================================================================*
+ *			     do_sef_stats_request			     *
+ *===========================================================================*/
+int do_sef_stats_request(message *m_ptr)
+{
+/* Process a SEF Stats request and send the reply ourselves, as the server's
+ * own message loop never gets to see the request.
+ */
+  message replymsg;
+  int r = OK;
+
+  switch (m_ptr->m_lsys_getsysinfo.what) {
+  case SEF_STATS_ENABLE:
+      memset(&sef_stats, 0, sizeof(sef_stats));
+      sef_stats_type = 0;
+      sef_stats_enabled = 1;
+      break;
+  case SEF_STATS_DISABLE:
+      sef_stats_enabled = 0;
+      break;
+  case SEF_STATS_RETRIEVE:
+      if (m_ptr->m_lsys_getsysinfo.size != sizeof(sef_stats)) {
+          r = EINVAL;
+          break;
+      }
+      r = sys_datacopy(SELF, (vir_bytes) &sef_stats, m_ptr->m_source,
+          m_ptr->m_lsys_getsysinfo.where, sizeof(sef_stats));
+      break;
+  default:
+      r = EINVAL;
+  }
+
+  memset(&replymsg, 0, sizeof(replymsg));
+  replymsg.m_type = r;
+  return ipc_send(m_ptr->m_source, &replymsg);
+}
+
+/*===========================================================================*
+ *			      sef_stats_request				     *
+ *===========================================================================*/
+int sef_stats_request(endpoint_t who, int action, struct sef_stats *where)
+{
+/* Requester side: control or retrieve the statistics of a system service. */
+  message m;
+
+  memset(&m, 0, sizeof(m));
+  m.m_lsys_getsysinfo.what = action;
+  m.m_lsys_getsysinfo.where = (vir_bytes) where;
+  m.m_lsys_getsysinfo.size = (where != NULL) ? sizeof(*where) : 0;
+  return _taskcall(who, COMMON_REQ_SEF_STATS, &m);
+}
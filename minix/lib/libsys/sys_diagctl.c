@@ -20,6 +20,12 @@ int sys_diagctl(int code, char *arg1, int arg2)
 	break;
   case DIAGCTL_CODE_UNREGISTER:
 	break;
+  case DIAGCTL_CODE_IPCTRACE:
+	m.m_lsys_krn_sys_diagctl.endpt = arg2;
+	break;
+  case DIAGCTL_CODE_LOCKSTATS:
+	m.m_lsys_krn_sys_diagctl.endpt = arg2;
+	break;
   default:
 	panic("Unknown SYS_DIAGCTL request %d\n", code);
   }
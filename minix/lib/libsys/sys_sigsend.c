@@ -12,7 +12,29 @@ struct sigmsg *sig_ctxt;		/* POSIX style handling */
 
     m.m_sigcalls.endpt = proc_ep;
     m.m_sigcalls.sigctx = sig_ctxt;
+    m.m_sigcalls.count = 1;
     result = _kernel_call(SYS_SIGSEND, &m);
     return(result);
 }
 
+/*===========================================================================*
+ *                                sys_sigsendv				     *
+ *===========================================================================*/
+int sys_sigsendv(proc_ep, sig_ctxt, count)
+endpoint_t proc_ep;			/* for which process */
+struct sigmsg *sig_ctxt;		/* array of signal contexts */
+int count;				/* number of signal contexts */
+{
+/* As sys_sigsend(), but set up a whole batch of signal handler frames with
+ * one kernel call. The frames are stacked in array order, so the handler for
+ * the last context runs first.
+ */
+    message m;
+    int result;
+
+    m.m_sigcalls.endpt = proc_ep;
+    m.m_sigcalls.sigctx = sig_ctxt;
+    m.m_sigcalls.count = count;
+    result = _kernel_call(SYS_SIGSEND, &m);
+    return(result);
+}
@@ -7,6 +7,7 @@
  * The entry points into this file are:
  *   init_timer:     initialize a timer structure
  *   set_timer:      reset and existing or set a new watchdog timer
+ *   set_timer_slack:set how late a timer may be delivered
  *   cancel_timer:   remove a timer from the list of timers
  *   expire_timers:  check for expired timers and run watchdog functions
  *
@@ -18,6 +19,9 @@
 
 static minix_timer_t *timers = NULL;
 static int expiring = FALSE;
+static clock_t timer_slack = 0;		/* max ticks a timer may be late */
+static clock_t alarm_time;		/* time of the scheduled alarm, if */
+static int alarm_set = FALSE;		/*   ..any is outstanding at all */
 
 /*
  * Initialize the timer 'tp'.
@@ -40,23 +44,51 @@ init_timer(minix_timer_t * tp)
 void
 set_timer(minix_timer_t *tp, clock_t ticks, tmr_func_t watchdog, int arg)
 {
-	clock_t prev_time, next_time;
-	int r, had_timers;
+	clock_t next_time;
+	int r;
 
 	if (ticks > TMRDIFF_MAX)
 		panic("set_timer: ticks value too large: %u", (int)ticks);
 
 	/* Add the timer to the list. */
-	had_timers = tmrs_settimer(&timers, tp, getticks() + ticks, watchdog,
-	    arg, &prev_time, &next_time);
+	(void)tmrs_settimer(&timers, tp, getticks() + ticks, watchdog, arg,
+	    NULL, &next_time);
+
+	/* Reschedule our synchronous alarm if necessary.  If an alarm is
+	 * already outstanding no earlier than the new head timer, and no more
+	 * than the configured slack after it, leave the alarm in place: the
+	 * head timer will then be delivered slightly late, in one batch with
+	 * any other timers due by then.
+	 */
+	if (!expiring) {
+		/* The (modular) subtraction ensures that an alarm scheduled
+		 * before the new head timer is always reprogrammed.
+		 */
+		if (alarm_set &&
+		    (clock_t)(alarm_time - next_time) <= timer_slack)
+			return;
 
-	/* Reschedule our synchronous alarm if necessary. */
-	if (!expiring && (!had_timers || next_time != prev_time)) {
 		if ((r = sys_setalarm(next_time, TRUE /*abs_time*/)) != OK)
 			panic("set_timer: couldn't set alarm: %d", r);
+		alarm_time = next_time;
+		alarm_set = TRUE;
         }
 }
 
+/*
+ * Set the timer slack: the number of clock ticks by which a timer may be
+ * delivered later than its expiry time.  A nonzero slack allows timers that
+ * expire close to each other to be delivered in one batch, and cuts down on
+ * alarm reprogramming for timers that are continually reset to roughly the
+ * same relative expiry time.  The default slack is zero.
+ */
+void
+set_timer_slack(clock_t slack)
+{
+
+	timer_slack = slack;
+}
+
 /*
  * Cancel the timer 'tp'.  The timer object must have been initialized with
  * init_timer(3) first.  If the timer was not set before, the call is a no-op.
@@ -64,13 +96,13 @@ set_timer(minix_timer_t *tp, clock_t ticks, tmr_func_t watchdog, int arg)
 void
 cancel_timer(minix_timer_t * tp)
 {
-	clock_t next_time, prev_time;
+	clock_t next_time;
 	int r, have_timers;
 
 	if (!tmr_is_set(tp))
 		return;
 
-	have_timers = tmrs_clrtimer(&timers, tp, &prev_time, &next_time);
+	have_timers = tmrs_clrtimer(&timers, tp, NULL, &next_time);
 
 	/*
 	 * If the earliest timer has been removed, we have to set the alarm to
@@ -78,11 +110,15 @@ cancel_timer(minix_timer_t * tp)
 	 * has been canceled.
 	 */
         if (!expiring) {
-		if (!have_timers)
+		if (!have_timers) {
 			r = sys_setalarm(0, FALSE /*abs_time*/);
-		else if (prev_time != next_time)
+			alarm_set = FALSE;
+		} else if (!alarm_set ||
+		    (clock_t)(alarm_time - next_time) > timer_slack) {
 			r = sys_setalarm(next_time, TRUE /*abs_time*/);
-		else
+			alarm_time = next_time;
+			alarm_set = TRUE;
+		} else
 			r = OK;
 
 		if (r != OK)
@@ -113,5 +149,8 @@ expire_timers(clock_t now)
 	if (have_timers) {
 		if ((r = sys_setalarm(next_time, TRUE /*abs_time*/)) != OK)
 			panic("expire_timers: couldn't set alarm: %d", r);
-	}
+		alarm_time = next_time;
+		alarm_set = TRUE;
+	} else
+		alarm_set = FALSE;
 }
@@ -0,0 +1,11 @@
+#ifndef _LIBTIMERS_TMRS_H
+#define _LIBTIMERS_TMRS_H
+
+#include <minix/timers.h>
+
+/* Pairing heap primitives shared by the tmrs_* functions (tmrs_heap.c). */
+minix_timer_t *tmrs_heap_meld(minix_timer_t *a, minix_timer_t *b);
+minix_timer_t *tmrs_heap_pair(minix_timer_t *tp);
+void tmrs_heap_unlink(minix_timer_t **tmrs, minix_timer_t *tp);
+
+#endif /* _LIBTIMERS_TMRS_H */
@@ -1,4 +1,4 @@
-#include <minix/timers.h>
+#include "tmrs.h"
 
 /*
  * Deactivate a timer and remove it from the timers queue.  'tmrs' is a pointer
@@ -14,7 +14,6 @@ int
 tmrs_clrtimer(minix_timer_t ** tmrs, minix_timer_t * tp, clock_t * prev_time,
 	clock_t * next_time)
 {
-	minix_timer_t **atp;
 	int r;
 
 	if (*tmrs != NULL) {
@@ -26,12 +25,9 @@ tmrs_clrtimer(minix_timer_t ** tmrs, minix_timer_t * tp, clock_t * prev_time,
 
 	tp->tmr_func = NULL;	/* clear the timer object */
 
-	for (atp = tmrs; *atp != NULL; atp = &(*atp)->tmr_next) {
-		if (*atp == tp) {
-			*atp = tp->tmr_next;
-			break;
-		}
-	}
+	/* Remove the timer, if it is on this queue at all. */
+	if (*tmrs == tp || tp->tmr_prev != NULL)
+		tmrs_heap_unlink(tmrs, tp);
 
 	if (next_time != NULL) {
 		if (*tmrs != NULL)
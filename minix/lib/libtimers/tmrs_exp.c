@@ -1,7 +1,7 @@
-#include <minix/timers.h>
+#include "tmrs.h"
 
 /*
- * Use the current time to check the timers queue list for expired timers.
+ * Use the current time to check the timers queue for expired timers.
  * Run the watchdog functions for all expired timers and deactivate them.
  * The caller is responsible for scheduling a new alarm if needed.
  */
@@ -12,7 +12,14 @@ tmrs_exptimers(minix_timer_t ** tmrs, clock_t now, clock_t * new_head)
 	tmr_func_t func;
 
 	while ((tp = *tmrs) != NULL && tmr_has_expired(tp, now)) {
-		*tmrs = tp->tmr_next;
+		/*
+		 * Detach the head timer fully before running its watchdog
+		 * function, since the latter may (re)set timers on the queue.
+		 */
+		*tmrs = tmrs_heap_pair(tp->tmr_child);
+		tp->tmr_next = NULL;
+		tp->tmr_prev = NULL;
+		tp->tmr_child = NULL;
 
 		func = tp->tmr_func;
 		tp->tmr_func = NULL;
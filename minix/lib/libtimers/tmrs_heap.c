@@ -0,0 +1,120 @@
+#include "tmrs.h"
+
+/*
+ * The active timers of a queue form an intrusive pairing heap, rooted at the
+ * queue head pointer.  The heap order is on expiry time, so the head is
+ * always the next timer due, as the users of this library expect.  Compared
+ * to the sorted list used previously, this makes adding a timer O(1) instead
+ * of O(n), which matters for services that maintain many timers (network
+ * timers in particular are usually reset or canceled long before they are due,
+ * so they pay for insertion but rarely for removal at the root).
+ *
+ * Each node points to its first child and to its next sibling.  The back
+ * pointer of a first child refers to its parent, that of any other sibling to
+ * the previous sibling; the root and free-standing timers have no back
+ * pointer, which is how membership of a queue is tested.  All functions are
+ * iterative, since this code also runs on the kernel stack.
+ */
+
+/*
+ * Meld two heaps into one, and return the new root.  Either may be NULL.
+ * Both arguments must be proper roots: no parent, no siblings.
+ */
+minix_timer_t *
+tmrs_heap_meld(minix_timer_t * a, minix_timer_t * b)
+{
+	minix_timer_t *tmp;
+
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+
+	/* Make the timer due last a child of the timer due first. */
+	if (!tmr_is_first(a->tmr_exp_time, b->tmr_exp_time)) {
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->tmr_next = a->tmr_child;
+	if (b->tmr_next != NULL)
+		b->tmr_next->tmr_prev = b;
+	b->tmr_prev = a;
+	a->tmr_child = b;
+
+	return a;
+}
+
+/*
+ * Combine a list of siblings, as linked through their tmr_next pointers, into
+ * a single heap, and return its root (NULL for an empty list).  This is the
+ * standard two-pass pairing strategy: meld adjacent pairs from left to right,
+ * then meld the results from right to left.
+ */
+minix_timer_t *
+tmrs_heap_pair(minix_timer_t * tp)
+{
+	minix_timer_t *a, *b, *list;
+
+	/* First pass: meld pairs, stacking the results in reverse order. */
+	list = NULL;
+	while (tp != NULL) {
+		a = tp;
+		tp = tp->tmr_next;
+		a->tmr_next = NULL;
+		a->tmr_prev = NULL;
+
+		if (tp != NULL) {
+			b = tp;
+			tp = tp->tmr_next;
+			b->tmr_next = NULL;
+			b->tmr_prev = NULL;
+			a = tmrs_heap_meld(a, b);
+		}
+
+		a->tmr_next = list;
+		list = a;
+	}
+
+	/* Second pass: meld the pairs back to front. */
+	a = NULL;
+	while (list != NULL) {
+		b = list;
+		list = list->tmr_next;
+		b->tmr_next = NULL;
+		a = tmrs_heap_meld(a, b);
+	}
+
+	return a;
+}
+
+/*
+ * Remove a timer from the heap it is on, which is rooted at '*tmrs', and
+ * restore the heap property.  The timer's children, if any, are melded back
+ * into the heap.  The timer's pointer fields are cleared, marking it as no
+ * longer being on any queue.
+ */
+void
+tmrs_heap_unlink(minix_timer_t ** tmrs, minix_timer_t * tp)
+{
+
+	if (*tmrs == tp) {
+		*tmrs = tmrs_heap_pair(tp->tmr_child);
+	} else {
+		/* Detach the subtree rooted at the timer.. */
+		if (tp->tmr_prev->tmr_child == tp)
+			tp->tmr_prev->tmr_child = tp->tmr_next;
+		else
+			tp->tmr_prev->tmr_next = tp->tmr_next;
+		if (tp->tmr_next != NULL)
+			tp->tmr_next->tmr_prev = tp->tmr_prev;
+
+		/* ..and meld its children back into the heap. */
+		*tmrs = tmrs_heap_meld(*tmrs, tmrs_heap_pair(tp->tmr_child));
+	}
+
+	tp->tmr_next = NULL;
+	tp->tmr_prev = NULL;
+	tp->tmr_child = NULL;
+}
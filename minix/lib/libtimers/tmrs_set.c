@@ -1,9 +1,9 @@
-#include <minix/timers.h>
+#include "tmrs.h"
 
 /*
  * Activate a timer to run function 'watchdog' at absolute time 'exp_time', as
  * part of timers queue 'tmrs'. If the timer is already in use, it is first
- * removed from the timers queue.  Then, it is put in the list of active timers
+ * removed from the timers queue.  Then, it is put in the heap of active timers
  * with the first to expire in front.  The caller responsible for scheduling a
  * new alarm for the timer if needed.  To that end, the function returns three
  * values: its return value (TRUE or FALSE) indicates whether there was an old
@@ -15,7 +15,6 @@ int
 tmrs_settimer(minix_timer_t ** tmrs, minix_timer_t * tp, clock_t exp_time,
 	tmr_func_t watchdog, int arg, clock_t * old_head, clock_t * new_head)
 {
-	minix_timer_t **atp;
 	int r;
 
 	if (*tmrs != NULL) {
@@ -35,12 +34,10 @@ tmrs_settimer(minix_timer_t ** tmrs, minix_timer_t * tp, clock_t exp_time,
 	/*
 	 * Add the timer to the active timers. The next timer due is in front.
 	 */
-	for (atp = tmrs; *atp != NULL; atp = &(*atp)->tmr_next) {
-		if (tmr_is_first(exp_time, (*atp)->tmr_exp_time))
-			break;
-	}
-	tp->tmr_next = *atp;
-	*atp = tp;
+	tp->tmr_next = NULL;
+	tp->tmr_prev = NULL;
+	tp->tmr_child = NULL;
+	*tmrs = tmrs_heap_meld(*tmrs, tp);
 
 	if (new_head != NULL)
 		*new_head = (*tmrs)->tmr_exp_time;
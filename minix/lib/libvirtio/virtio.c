@@ -64,7 +64,10 @@ struct virtio_queue {
 	u16_t free_num;				/* free descriptors */
 	u16_t free_head;			/* next free descriptor */
 	u16_t free_tail;			/* last free descriptor */
-	u16_t last_used;			/* we checked in used */
+	u16_t last_used;			/* we checked in used;
+						 * free-running index
+						 */
+	u16_t num_added;			/* bufs added since last kick */
 
 	void **data;				/* points to pointers */
 };
@@ -87,6 +90,12 @@ struct virtio_device {
 
 	int threads;				/* max number of threads */
 
+	int host_indirect;			/* host supports indirect
+						 * descriptors
+						 */
+	int host_event_idx;			/* host supports the ring
+						 * event index fields
+						 */
 	struct indirect_desc_table *indirect;	/* indirect descriptor tables */
 	int num_indirect;
 };
@@ -102,7 +111,7 @@ static int init_indirect_desc_table(struct indirect_desc_table *desc);
 static int init_indirect_desc_tables(struct virtio_device *dev);
 static void virtio_irq_register(struct virtio_device *dev);
 static void virtio_irq_unregister(struct virtio_device *dev);
-static int wants_kick(struct virtio_queue *q);
+static int wants_kick(struct virtio_device *dev, struct virtio_queue *q);
 static void kick_queue(struct virtio_device *dev, int qidx);
 
 struct virtio_device *
@@ -237,6 +246,27 @@ exchange_features(struct virtio_device *dev)
 		f->host_support =  ((host_features >> f->bit) & 1);
 	}
 
+	/* The ring features are transport level and therefore handled by
+	 * this library, without involving the driver. Indirect descriptors
+	 * may only be used if the host offers the feature, so negotiate it
+	 * here.
+	 */
+	dev->host_indirect =
+		(host_features >> VIRTIO_RING_F_INDIRECT_DESC) & 1;
+
+	if (dev->host_indirect)
+		guest_features |= (1UL << VIRTIO_RING_F_INDIRECT_DESC);
+
+	/* With the event index feature, both sides publish up to which ring
+	 * index they want to be notified, which suppresses most kicks and
+	 * interrupts, and thereby VM exits, under sustained load.
+	 */
+	dev->host_event_idx =
+		(host_features >> VIRTIO_RING_F_EVENT_IDX) & 1;
+
+	if (dev->host_event_idx)
+		guest_features |= (1UL << VIRTIO_RING_F_EVENT_IDX);
+
 	/* let the device know about our features */
 	virtio_write32(dev, VIRTIO_GUEST_F_OFF, guest_features);
 
@@ -399,6 +429,7 @@ init_phys_queue(struct virtio_queue *q)
 	q->free_head = 0;
 	q->free_tail = q->num - 1;
 	q->last_used = 0;
+	q->num_added = 0;
 
 	return;
 }
@@ -411,8 +442,6 @@ virtio_free_device(struct virtio_device *dev)
 
 	assert(dev != NULL);
 
-	assert(dev->num_indirect > 0);
-
 	for (i = 0; i < dev->num_indirect; i++) {
 		desc = &dev->indirect[i];
 		free_contig(desc->descs, desc->len);
@@ -420,9 +449,10 @@ virtio_free_device(struct virtio_device *dev)
 
 	dev->num_indirect = 0;
 
-	assert(dev->indirect != NULL);
-	free(dev->indirect);
-	dev->indirect = NULL;
+	if (dev->indirect != NULL) {
+		free(dev->indirect);
+		dev->indirect = NULL;
+	}
 
 	free(dev);
 }
@@ -448,6 +478,14 @@ init_indirect_desc_tables(struct virtio_device *dev)
 	int i, j, r;
 	struct indirect_desc_table *desc;
 
+	/* Without host support, indirect descriptors are never used and no
+	 * tables are needed.
+	 */
+	if (!dev->host_indirect) {
+		dev->num_indirect = 0;
+		return OK;
+	}
+
 	dev->indirect = malloc(dev->num_indirect * sizeof(dev->indirect[0]));
 
 	if (dev->indirect == NULL) {
@@ -580,6 +618,8 @@ set_direct_descriptors(struct virtio_queue *q, struct vumap_phys *bufs,
 	if (0 == num)
 		return;
 
+	assert(num <= q->free_num);
+
 	for (i = q->free_head, count = 0; count < num; count++) {
 
 		/* The next free descriptor */
@@ -603,8 +643,8 @@ set_direct_descriptors(struct virtio_queue *q, struct vumap_phys *bufs,
 }
 
 int
-virtio_to_queue(struct virtio_device *dev, int qidx, struct vumap_phys *bufs,
-	size_t num, void *data)
+virtio_to_queue_defer(struct virtio_device *dev, int qidx,
+	struct vumap_phys *bufs, size_t num, void *data)
 {
 	u16_t free_first;
 	int left;
@@ -620,7 +660,13 @@ virtio_to_queue(struct virtio_device *dev, int qidx, struct vumap_phys *bufs,
 
 	left = (int)q->free_num - (int)num;
 
-	if (left < dev->threads)
+	/* Use an indirect descriptor table if the host supports them and
+	 * either the chain would occupy more than one ring slot anyway, or
+	 * the ring is running low on free descriptors and other threads
+	 * might not be able to add their descriptors otherwise. Without
+	 * host support, indirect descriptors must never be used.
+	 */
+	if (dev->num_indirect > 0 && (num > 2 || left < dev->threads))
 		set_indirect_descriptors(dev, q, bufs, num);
 	else
 		set_direct_descriptors(q, bufs, num);
@@ -637,9 +683,30 @@ virtio_to_queue(struct virtio_device *dev, int qidx, struct vumap_phys *bufs,
 	/* advance last idx */
 	vring->avail->idx += 1;
 
+	/* for the kick decision with the event index feature */
+	q->num_added += 1;
+
 	/* Make sure the host sees the avail->idx */
 	__insn_barrier();
 
+	return 0;
+}
+
+void
+virtio_queue_kick(struct virtio_device *dev, int qidx)
+{
+	kick_queue(dev, qidx);
+}
+
+int
+virtio_to_queue(struct virtio_device *dev, int qidx, struct vumap_phys *bufs,
+	size_t num, void *data)
+{
+	int r;
+
+	if ((r = virtio_to_queue_defer(dev, qidx, bufs, num, data)) != 0)
+		return r;
+
 	/* kick it! */
 	kick_queue(dev, qidx);
 	return 0;
@@ -666,17 +733,17 @@ virtio_from_queue(struct virtio_device *dev, int qidx, void **data,
 	__insn_barrier();
 
 	/* The index from the host */
-	used_idx = vring->used->idx % q->num;
+	used_idx = vring->used->idx;
 
 	/* We already saw this one, nothing to do here */
 	if (q->last_used == used_idx)
 		return -1;
 
 	/* Get the vring_used element */
-	uel = &q->vring.used->ring[q->last_used];
+	uel = &q->vring.used->ring[q->last_used % q->num];
 
 	/* Update the last used element */
-	q->last_used = (q->last_used + 1) % q->num;
+	q->last_used = q->last_used + 1;
 
 	/* index of the used element */
 	idx = uel->id % q->num;
@@ -729,6 +796,19 @@ virtio_from_queue(struct virtio_device *dev, int qidx, void **data,
 	if (len != NULL)
 		*len = uel->len;
 
+	/* With the event index feature, the host only interrupts once its
+	 * used index moves past the published event index. Keep the event
+	 * index right behind the host: this way, buffers used by the host
+	 * while we are still draining the queue here do not raise further
+	 * interrupts, yet no interrupt for new activity is ever missed.
+	 */
+	if (dev->host_event_idx) {
+		vring_used_event(vring) = q->last_used;
+
+		/* Make sure the host sees the event index */
+		__insn_barrier();
+	}
+
 	return 0;
 }
 
@@ -763,20 +843,40 @@ virtio_irq_disable(struct virtio_device *dev)
 }
 
 static int
-wants_kick(struct virtio_queue *q)
+wants_kick(struct virtio_device *dev, struct virtio_queue *q)
 {
+	u16_t new_idx, old_idx;
+
 	assert(q != NULL);
+
+	/* With the event index feature, the host publishes up to which
+	 * available index it wants to be kicked, and the used ring flags are
+	 * to be ignored. Kick only if any of the buffers added since the last
+	 * kick crossed that index.
+	 */
+	if (dev->host_event_idx) {
+		new_idx = q->vring.avail->idx;
+		old_idx = new_idx - q->num_added;
+
+		return vring_need_event(vring_avail_event(&q->vring), new_idx,
+			old_idx);
+	}
+
 	return !(q->vring.used->flags & VRING_USED_F_NO_NOTIFY);
 }
 
 static void
 kick_queue(struct virtio_device *dev, int qidx)
 {
+	struct virtio_queue *q = &dev->queues[qidx];
+
 	assert(0 <= qidx && qidx < dev->num_queues);
 
-	if (wants_kick(&dev->queues[qidx]))
+	if (wants_kick(dev, q))
 		virtio_write16(dev, VIRTIO_QNOTFIY_OFF, qidx);
 
+	q->num_added = 0;
+
 	return;
 }
 
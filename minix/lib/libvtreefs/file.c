@@ -8,6 +8,33 @@
 static char *buf = NULL;
 static size_t bufsize = 0;
 
+static clock_t data_ttl = 0;	/* validity window of cached file contents */
+
+/*
+ * Set the validity window, in clock ticks, for caching generated file
+ * contents.  Within the window, repeated reads of a file are served from the
+ * contents cached in its inode, rather than by calling the read hook again.
+ * A window of zero (the default) disables content caching altogether.
+ */
+void
+vtreefs_set_data_ttl(clock_t ttl)
+{
+
+	data_ttl = ttl;
+}
+
+/*
+ * Invalidate the cached contents of the given inode, if any.
+ */
+void
+clear_inode_cache(struct inode * node)
+{
+
+	free(node->i_cdata);
+
+	node->i_cdata = NULL;
+}
+
 /*
  * Initialize the main buffer used for I/O.  Return OK or an error code.
  */
@@ -39,6 +66,77 @@ cleanup_buf(void)
 	bufsize = 0;
 }
 
+/*
+ * Try to serve a read request from the cached contents of the given inode,
+ * regenerating and caching the contents first if they are missing or have
+ * expired.  Return TRUE if the request has been handled, in which case *res
+ * is set to the result of the read call.  Return FALSE if the caller must
+ * invoke the read hook directly instead, because content caching is disabled
+ * or because the contents do not fit in the I/O buffer (in which case their
+ * total size is not known).
+ */
+static int
+read_cached(struct inode * node, struct fsdriver_data * data, size_t bytes,
+	off_t pos, ssize_t * res)
+{
+	ssize_t len;
+	char *cdata;
+	int r;
+
+	if (data_ttl == 0)
+		return FALSE;
+
+	/* If the cached contents have expired, throw them away. */
+	if (node->i_cdata != NULL &&
+	    (clock_t)(getticks() - node->i_ctime) > data_ttl)
+		clear_inode_cache(node);
+
+	/* If there are no cached contents, regenerate and cache them. */
+	if (node->i_cdata == NULL) {
+		len = vtreefs_hooks->read_hook(node, buf, bufsize, 0,
+		    get_inode_cbdata(node));
+
+		if (len < 0) {
+			*res = len;
+			return TRUE;
+		}
+
+		/*
+		 * If the buffer has been filled to the brim, the contents may
+		 * be larger than the buffer, and their total size is unknown.
+		 * Leave such files to the regular read path.
+		 */
+		if ((size_t)len == bufsize)
+			return FALSE;
+
+		/* Allocate at least one byte, so that empty contents can be
+		 * cached as well.
+		 */
+		if ((cdata = malloc(len + 1)) == NULL)
+			return FALSE;
+
+		memcpy(cdata, buf, len);
+
+		node->i_cdata = cdata;
+		node->i_clen = (size_t)len;
+		node->i_ctime = getticks();
+	}
+
+	/* Serve the request from the cached contents. */
+	if (pos >= (off_t)node->i_clen) {
+		*res = 0; /* EOF */
+		return TRUE;
+	}
+
+	if (bytes > node->i_clen - pos)
+		bytes = node->i_clen - pos;
+
+	r = fsdriver_copyout(data, 0, node->i_cdata + pos, bytes);
+
+	*res = (r == OK) ? (ssize_t)bytes : r;
+	return TRUE;
+}
+
 /*
  * Read from a file.
  */
@@ -65,6 +163,10 @@ fs_read(ino_t ino_nr, struct fsdriver_data * data, size_t bytes,
 	assert(buf != NULL);
 	assert(bufsize > 0);
 
+	/* See if the request can be served from cached file contents. */
+	if (read_cached(node, data, bytes, pos, &r))
+		return r;
+
 	/*
 	 * Call the read hook to fill the result buffer, repeatedly for as long
 	 * as 1) the request is not yet fully completed, and 2) the read hook
@@ -125,6 +227,9 @@ fs_write(ino_t ino_nr, struct fsdriver_data * data, size_t bytes, off_t pos,
 	if (bytes == 0)
 		return 0;
 
+	/* The file contents are being changed; invalidate any cached copy. */
+	clear_inode_cache(node);
+
 	assert(buf != NULL);
 	assert(bufsize > 0);
 
@@ -180,6 +285,9 @@ fs_trunc(ino_t ino_nr, off_t start_pos, off_t end_pos)
 	if (is_inode_deleted(node) || vtreefs_hooks->trunc_hook == NULL)
 		return EACCES;
 
+	/* The file contents are being changed; invalidate any cached copy. */
+	clear_inode_cache(node);
+
 	/* TODO: translate this case into all-zeroes write callbacks. */
 	if (end_pos != 0)
 		return EINVAL;
@@ -73,6 +73,7 @@ init_inodes(unsigned int inodes, struct inode_stat * istat,
 		node->i_name = NULL;
 		node->i_parent = NULL;
 		node->i_count = 0;
+		node->i_cdata = NULL;
 		TAILQ_INIT(&node->i_children);
 		TAILQ_INSERT_HEAD(&unused_inodes, node, i_unused);
 	}
@@ -94,6 +95,7 @@ init_inodes(unsigned int inodes, struct inode_stat * istat,
 	set_inode_stat(node, istat);
 	node->i_indexed = nr_indexed_entries;
 	node->i_cbdata = NULL;
+	node->i_cdata = NULL;
 
 	return OK;
 }
@@ -104,6 +106,11 @@ init_inodes(unsigned int inodes, struct inode_stat * istat,
 void
 cleanup_inodes(void)
 {
+	unsigned int i;
+
+	/* Free any cached file contents. */
+	for (i = 0; i < nr_inodes; i++)
+		clear_inode_cache(&inode[i]);
 
 	/* Free the inode and hash tables. */
 	free(parent_index_head);
@@ -229,6 +236,8 @@ add_inode(struct inode * parent, const char * name, index_t idx,
 	newnode->i_cbdata = cbdata;
 	strcpy(newnode->i_name, name);
 
+	assert(newnode->i_cdata == NULL);
+
 	/* Clear the extra data for this inode, if present. */
 	clear_inode_extra(newnode);
 
@@ -570,6 +579,9 @@ delete_inode(struct inode * node)
 			free(node->i_name);
 		node->i_name = NULL;
 
+		/* Free any cached file contents. */
+		clear_inode_cache(node);
+
 		node->i_flags |= I_DELETED;
 
 		/*
@@ -37,6 +37,11 @@ struct inode {
 	cixfer_cbdata_t i_cbdata;	/* callback data */
 	unsigned short i_flags;		/* I_DELETED or 0 */
 
+	/* Generated contents cache */
+	char *i_cdata;			/* cached file contents, or NULL */
+	size_t i_clen;			/* length of the cached contents */
+	clock_t i_ctime;		/* time the contents were generated */
+
 	/* Tree structure */
 	struct inode *i_parent;		/* parent of the node */
 	TAILQ_ENTRY(inode) i_siblings;	/* hash list for parent's children */
@@ -8,6 +8,7 @@ void clear_inode_extra(struct inode *node);
 /* file.c */
 int init_buf(size_t size);
 void cleanup_buf(void);
+void clear_inode_cache(struct inode *node);
 ssize_t fs_read(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
 	off_t pos, int call);
 ssize_t fs_write(ino_t ino_nr, struct fsdriver_data *data, size_t bytes,
@@ -21,30 +21,68 @@
 #include "lwip.h"
 
 /*
- * Obtain an unsigned 32-bit value in network byte order from the pbuf chain
- * 'pbuf' at offset 'k'.  The given offset is guaranteed to be within bounds.
+ * Position cache for loads from a pbuf chain, maintained across the loads
+ * performed by a single filter run.  Since read locality within one filter
+ * program is high, remembering which pbuf the last load fell in, and at which
+ * absolute packet offset that pbuf starts, allows most subsequent loads to
+ * skip the O(n) walk along the chain from its head.
  */
-static uint32_t
-bpf_get32_ext(const struct pbuf * pbuf, uint32_t k)
+struct bpf_pos {
+	const struct pbuf *bp_pbuf;	/* pbuf containing offset 'bp_off' */
+	uint32_t bp_off;		/* absolute offset of its first byte */
+};
+
+/*
+ * Find the pbuf in the chain 'pbuf' that contains the absolute packet offset
+ * pointed to by 'kp', using and updating the position cache 'pos'.  Return
+ * the pbuf, and replace the value pointed to by 'kp' with the corresponding
+ * relative offset within that pbuf.  The given offset is guaranteed to be
+ * within bounds.
+ */
+static const struct pbuf *
+bpf_seek_ext(const struct pbuf * pbuf, struct bpf_pos * pos, uint32_t * kp)
 {
-	uint32_t val;
-	unsigned int i;
+	uint32_t k;
+
+	k = *kp;
 
 	/*
-	 * Find the pbuf that contains the first byte.  We expect that most
-	 * filters will operate only on the headers of packets, so that we
-	 * mostly avoid going through this O(n) loop.  Since only the superuser
-	 * can open BPF devices at all, we need not be worried about abuse in
-	 * this regard.  However, it turns out that this loop is particularly
-	 * CPU-intensive after all, we can probably improve it by caching the
-	 * last visited pbuf, as read locality is likely high.
+	 * We expect that most filters will operate only on the headers of
+	 * packets, so that most loads fall in the first pbuf anyway.  For the
+	 * other cases, start from the cached position whenever the target
+	 * offset is not before it, rather than from the start of the chain.
 	 */
+	if (k >= pos->bp_off) {
+		pbuf = pos->bp_pbuf;
+		k -= pos->bp_off;
+	}
+
 	while (k >= pbuf->len) {
 		k -= pbuf->len;
 		pbuf = pbuf->next;
 		assert(pbuf != NULL);
 	}
 
+	pos->bp_pbuf = pbuf;
+	pos->bp_off = *kp - k;
+
+	*kp = k;
+
+	return pbuf;
+}
+
+/*
+ * Obtain an unsigned 32-bit value in network byte order from the pbuf chain
+ * 'pbuf' at offset 'k'.  The given offset is guaranteed to be within bounds.
+ */
+static uint32_t
+bpf_get32_ext(const struct pbuf * pbuf, struct bpf_pos * pos, uint32_t k)
+{
+	uint32_t val;
+	unsigned int i;
+
+	pbuf = bpf_seek_ext(pbuf, pos, &k);
+
 	/*
 	 * We assume that every pbuf has some data, but we make no assumptions
 	 * about any minimum amount of data per pbuf.  Therefore, we may have
@@ -71,15 +109,10 @@ bpf_get32_ext(const struct pbuf * pbuf, uint32_t k)
  * 'pbuf' at offset 'k'.  The given offset is guaranteed to be within bounds.
  */
 static uint32_t
-bpf_get16_ext(const struct pbuf * pbuf, uint32_t k)
+bpf_get16_ext(const struct pbuf * pbuf, struct bpf_pos * pos, uint32_t k)
 {
 
-	/* As above. */
-	while (k >= pbuf->len) {
-		k -= pbuf->len;
-		pbuf = pbuf->next;
-		assert(pbuf != NULL);
-	}
+	pbuf = bpf_seek_ext(pbuf, pos, &k);
 
 	/*
 	 * There are only two possible cases to cover here: either the two
@@ -87,7 +120,7 @@ bpf_get16_ext(const struct pbuf * pbuf, uint32_t k)
 	 */
 	if (k < (uint32_t)pbuf->len - 1) {
 		return ((uint32_t)(((u_char *)pbuf->payload)[k]) << 8) |
-		    (uint32_t)(((u_char *)pbuf->next->payload)[k + 1]);
+		    (uint32_t)(((u_char *)pbuf->payload)[k + 1]);
 	} else {
 		assert(pbuf->next != NULL);
 		return ((uint32_t)(((u_char *)pbuf->payload)[k]) << 8) |
@@ -100,15 +133,10 @@ bpf_get16_ext(const struct pbuf * pbuf, uint32_t k)
  * The given offset is guaranteed to be within bounds.
  */
 static uint32_t
-bpf_get8_ext(const struct pbuf * pbuf, uint32_t k)
+bpf_get8_ext(const struct pbuf * pbuf, struct bpf_pos * pos, uint32_t k)
 {
 
-	/* As above. */
-	while (k >= pbuf->len) {
-		k -= pbuf->len;
-		pbuf = pbuf->next;
-		assert(pbuf != NULL);
-	}
+	pbuf = bpf_seek_ext(pbuf, pos, &k);
 
 	return (uint32_t)(((u_char *)pbuf->payload)[k]);
 }
@@ -151,6 +179,12 @@ bpf_filter_ext(const struct bpf_insn * pc, const struct pbuf * pbuf,
 #endif /* _MINIX_SYSTEM */
 {
 	uint32_t k, a, x, mem[BPF_MEMWORDS];
+#ifdef _MINIX_SYSTEM
+	struct bpf_pos pos;
+
+	pos.bp_pbuf = pbuf;
+	pos.bp_off = 0;
+#endif /* _MINIX_SYSTEM */
 
 	/* An empty program accepts all packets. */
 	if (pc == NULL)
@@ -185,7 +219,7 @@ bpf_filter_ext(const struct bpf_insn * pc, const struct pbuf * pbuf,
 				    (uint32_t)packet[k + 3];
 #ifdef _MINIX_SYSTEM
 			else if (total >= 3 && k < total - 3)
-				a = bpf_get32_ext(pbuf, k);
+				a = bpf_get32_ext(pbuf, &pos, k);
 #endif /* _MINIX_SYSTEM */
 			else
 				return 0;
@@ -202,7 +236,7 @@ bpf_filter_ext(const struct bpf_insn * pc, const struct pbuf * pbuf,
 				    (uint32_t)packet[k + 1];
 #ifdef _MINIX_SYSTEM
 			else if (total >= 1 && k < total - 1)
-				a = bpf_get16_ext(pbuf, k);
+				a = bpf_get16_ext(pbuf, &pos, k);
 #endif /* _MINIX_SYSTEM */
 			else
 				return 0;
@@ -217,7 +251,7 @@ bpf_filter_ext(const struct bpf_insn * pc, const struct pbuf * pbuf,
 				a = (uint32_t)packet[k];
 #ifdef _MINIX_SYSTEM
 			else if (k < total)
-				a = bpf_get8_ext(pbuf, k);
+				a = bpf_get8_ext(pbuf, &pos, k);
 #endif /* _MINIX_SYSTEM */
 			else
 				return 0;
@@ -246,7 +280,7 @@ bpf_filter_ext(const struct bpf_insn * pc, const struct pbuf * pbuf,
 				x = ((uint32_t)packet[k] & 0xf) << 2;
 #ifdef _MINIX_SYSTEM
 			else if (k < total)
-				x = (bpf_get8_ext(pbuf, k) & 0xf) << 2;
+				x = (bpf_get8_ext(pbuf, &pos, k) & 0xf) << 2;
 #endif /* _MINIX_SYSTEM */
 			else
 				return 0;
@@ -40,10 +40,22 @@
 /* The number of BPF devices. */
 #define NR_BPFDEV		16
 
+/* Maximum number of values tested by the early-reject fast path. */
+#define BPF_FASTPATH_MAX	4
+
 /* BPF receive buffer size: allowed range and default. */
 #define BPF_BUF_MIN		BPF_WORDALIGN(sizeof(struct bpf_hdr))
 #define BPF_BUF_DEF		32768
-#define BPF_BUF_MAX		262144
+
+/*
+ * The maximum size that may be set for a BPF device's packet buffers, as
+ * adjustable through the net.bpf.maxbufsize sysctl(7) node within the bounds
+ * set by NetBSD's BPF_MINBUFSIZE and BPF_MAXBUFSIZE.  Capture consumers that
+ * cannot keep up with high packet rates lose packets whenever the store
+ * buffer fills up before the hold buffer has been read and released; their
+ * only recourse is larger buffers, so the default limit is fairly generous.
+ */
+static int bpf_maxbufsize = BPF_DFLTBUFSIZE;
 
 /*
  * By opening /dev/bpf, one will obtain a cloned device with a different minor
@@ -64,6 +76,11 @@ static struct bpfdev {
 	size_t bpf_hlen;		/* used part of hold buffer */
 	struct bpf_insn *bpf_filter;	/* verified BPF filter, or NULL */
 	size_t bpf_filterlen;		/* length of filter, for munmap */
+	struct {			/* early-reject fast path state */
+		uint32_t bfp_off;	/* packet offset of 16-bit field */
+		unsigned int bfp_count;	/* nr of values, 0 = no fast path */
+		uint16_t bfp_val[BPF_FASTPATH_MAX];	/* accepted values */
+	} bpf_fastpath;
 	pid_t bpf_pid;			/* process ID of last using process */
 	clock_t bpf_timeout;		/* timeout for read calls (0 = none) */
 	struct {			/* state for pending read request */
@@ -94,13 +111,15 @@ static TAILQ_HEAD(, bpfdev_link) bpfl_freelist;	/* list of free BPF devices */
 
 static struct bpf_stat bpf_stat;
 
+static ssize_t bpfdev_maxbufsize(struct rmib_call *, struct rmib_node *,
+	struct rmib_oldp *, struct rmib_newp *);
 static ssize_t bpfdev_peers(struct rmib_call *, struct rmib_node *,
 	struct rmib_oldp *, struct rmib_newp *);
 
 /* The CTL_NET NET_BPF subtree.  All nodes are dynamically numbered. */
 static struct rmib_node net_bpf_table[] = {
-	RMIB_INT(RMIB_RO, BPF_BUF_MAX, "maxbufsize",
-	    "Maximum size for data capture buffer"), /* TODO: read-write */
+	RMIB_FUNC(RMIB_RW | CTLTYPE_INT, sizeof(int), bpfdev_maxbufsize,
+	    "maxbufsize", "Maximum size for data capture buffer"),
 	RMIB_STRUCT(RMIB_RO, sizeof(bpf_stat), &bpf_stat, "stats",
 	    "BPF stats"),
 	RMIB_FUNC(RMIB_RO | CTLTYPE_NODE, 0, bpfdev_peers, "peers",
@@ -233,6 +252,7 @@ bpfdev_close(devminor_t minor)
 			panic("munmap failed: %d", -errno);
 
 		bpf->bpf_filter = NULL;
+		bpf->bpf_fastpath.bfp_count = 0;
 	}
 
 	/*
@@ -689,6 +709,69 @@ bpfdev_flush(struct bpfdev * bpf)
 	bpf->bpf_stat.bs_capt = 0;
 }
 
+/*
+ * Precompute an early-reject fast path for the BPF device's current filter,
+ * if possible.  Filter programs generated from common pcap expressions (for
+ * example "port 80", "tcp", or "host" filters) all start by loading a 16-bit
+ * field--the ethertype--and comparing it against a small set of constants,
+ * rejecting the packet if none of them match.  We recognize that shape here:
+ * a leading 16-bit absolute load, followed by a chain of equality tests that
+ * are linked through their false branches and that ends in an unconditional
+ * rejection.  Since a packet whose 16-bit field matches none of the tested
+ * constants is then guaranteed to be rejected, such packets--typically the
+ * vast majority--can be dropped without running the filter interpreter at
+ * all.  The accept side of each test is left to the interpreter as usual.
+ * Note that the program has already been validated, which among other things
+ * guarantees that all jumps are forward, so the chain walk terminates.
+ */
+static void
+bpfdev_precompute(struct bpfdev * bpf)
+{
+	const struct bpf_insn *insn;
+	unsigned int pc, count, nval;
+	uint32_t off;
+	uint16_t val[BPF_FASTPATH_MAX];
+
+	bpf->bpf_fastpath.bfp_count = 0;
+
+	if (bpf->bpf_filter == NULL)
+		return;
+	count = bpf->bpf_filterlen / sizeof(struct bpf_insn);
+
+	insn = &bpf->bpf_filter[0];
+
+	if (insn->code != BPF_LD+BPF_H+BPF_ABS || insn->k > UINT16_MAX)
+		return;
+	off = insn->k;
+
+	nval = 0;
+
+	for (pc = 1; pc < count; pc += 1 + insn->jf) {
+		insn = &bpf->bpf_filter[pc];
+
+		if (insn->code != BPF_JMP+BPF_JEQ+BPF_K)
+			break;
+
+		/* A test for a value over 16 bits can never match. */
+		if (insn->k > UINT16_MAX)
+			continue;
+
+		/* Give up on filters testing more values than we can store. */
+		if (nval == BPF_FASTPATH_MAX)
+			return;
+
+		val[nval++] = (uint16_t)insn->k;
+	}
+
+	/* The chain must end in an unconditional rejection. */
+	if (insn->code != BPF_RET+BPF_K || insn->k != 0 || nval == 0)
+		return;
+
+	bpf->bpf_fastpath.bfp_off = off;
+	memcpy(bpf->bpf_fastpath.bfp_val, val, nval * sizeof(val[0]));
+	bpf->bpf_fastpath.bfp_count = nval;
+}
+
 /*
  * Install a filter program on the BPF device.  A new filter replaces any old
  * one.  A zero-sized filter simply clears a previous filter.  On success,
@@ -740,6 +823,8 @@ bpfdev_setfilter(struct bpfdev * bpf, endpoint_t endpt, cp_grant_id_t grant)
 	bpf->bpf_filter = filter;
 	bpf->bpf_filterlen = len;
 
+	bpfdev_precompute(bpf);
+
 	bpfdev_flush(bpf);
 
 	return OK;
@@ -798,8 +883,8 @@ bpfdev_ioctl(devminor_t minor, unsigned long request, endpoint_t endpt,
 
 		if (uval < BPF_BUF_MIN)
 			uval = BPF_BUF_MIN;
-		else if (uval > BPF_BUF_MAX)
-			uval = BPF_BUF_MAX;
+		else if (uval > (unsigned int)bpf_maxbufsize)
+			uval = bpf_maxbufsize;
 
 		/* Is this the right thing to do?  It doesn't matter for us. */
 		uval = BPF_WORDALIGN(uval);
@@ -1115,6 +1200,8 @@ bpfdev_input(struct bpfdev_link * bpfl, const struct pbuf * pbuf)
 	struct bpf_hdr bh;
 	const struct pbuf *pptr;
 	size_t caplen, hdrlen, totlen, off, chunk;
+	uint32_t fval;
+	unsigned int i;
 	int hfull;
 
 	/*
@@ -1125,6 +1212,27 @@ bpfdev_input(struct bpfdev_link * bpfl, const struct pbuf * pbuf)
 	bpf->bpf_stat.bs_recv++;
 	bpf_stat.bs_recv++;
 
+	/*
+	 * If an early-reject fast path was derived from the current filter,
+	 * and the tested 16-bit field is contained in the first pbuf of the
+	 * chain, see if the field matches any of the accepted values.  If not,
+	 * the filter is guaranteed to reject the packet, and we need not run
+	 * the filter interpreter at all.
+	 */
+	if (bpf->bpf_fastpath.bfp_count > 0 &&
+	    (uint32_t)pbuf->len >= bpf->bpf_fastpath.bfp_off + 2) {
+		fval = (uint32_t)((u_char *)
+		    pbuf->payload)[bpf->bpf_fastpath.bfp_off] << 8 |
+		    ((u_char *)pbuf->payload)[bpf->bpf_fastpath.bfp_off + 1];
+
+		for (i = 0; i < bpf->bpf_fastpath.bfp_count; i++)
+			if (fval == bpf->bpf_fastpath.bfp_val[i])
+				break;
+
+		if (i == bpf->bpf_fastpath.bfp_count)
+			return;	/* no match; ignore packet */
+	}
+
 	/*
 	 * Run the packet through the BPF device's filter to see whether the
 	 * packet should be stored and if so, how much of it.  If no filter is
@@ -1290,6 +1398,38 @@ bpfdev_get_info(struct bpf_d_ext * bde, const struct bpfdev * bpf)
 		    sizeof(bde->bde_ifname));
 }
 
+/*
+ * Set and/or retrieve the limit on the size of a BPF device's packet buffers,
+ * through sysctl(7).
+ */
+static ssize_t
+bpfdev_maxbufsize(struct rmib_call * call __unused,
+	struct rmib_node * node __unused, struct rmib_oldp * oldp,
+	struct rmib_newp * newp)
+{
+	int r, val;
+
+	/* Copy out the old (current) buffer size limit. */
+	if (oldp != NULL) {
+		if ((r = rmib_copyout(oldp, 0, &bpf_maxbufsize,
+		    sizeof(bpf_maxbufsize))) < 0)
+			return r;
+	}
+
+	if (newp != NULL) {
+		if ((r = rmib_copyin(newp, &val, sizeof(val))) != OK)
+			return r;
+
+		if (val < BPF_MINBUFSIZE || val > BPF_MAXBUFSIZE)
+			return EINVAL;
+
+		bpf_maxbufsize = val;
+	}
+
+	/* Return the length of the node. */
+	return sizeof(bpf_maxbufsize);
+}
+
 /*
  * Obtain statistics about open BPF devices ("peers").  This node may be
  * accessed by the superuser only.  Used by netstat(1).
@@ -434,6 +434,7 @@ ethif_poll(struct ifdev * ifdev)
 {
 	struct ethif *ethif = (struct ethif *)ifdev;
 	struct pbuf *pbuf, *pref;
+	size_t padding;
 
 	/*
 	 * If a configuration request is desired, see if we can send it to the
@@ -460,7 +461,17 @@ ethif_poll(struct ifdev * ifdev)
 			else
 				pbuf = pref;
 
-			if (ndev_send(ethif->ethif_ndev, pbuf) == OK)
+			/*
+			 * Undersized packets are padded by the ndev layer,
+			 * through an extra I/O vector element referring to a
+			 * buffer of zeroes; see ethif_output().
+			 */
+			if (NDEV_ETH_PACKET_MIN > pbuf->tot_len)
+				padding = NDEV_ETH_PACKET_MIN - pbuf->tot_len;
+			else
+				padding = 0;
+
+			if (ndev_send(ethif->ethif_ndev, pbuf, padding) == OK)
 				ethif->ethif_snd.es_unsentp =
 				    pchain_end(pref);
 			else
@@ -620,13 +631,13 @@ ethif_output(struct ifdev * ifdev, struct pbuf * pbuf, struct netif * netif)
 	 */
 
 	/*
-	 * There are two cases in which we need to make a copy of the packet
-	 * after all:
-	 *
-	 * 1) in the case that the packet needs to be padded in order to reach
-	 *    the minimum ethernet packet size (for drivers' convenience);
-	 * 2) in the (much more exceptional) case that the given pbuf chain
-	 *    exceeds the maximum vector size for network driver requests.
+	 * Undersized packets are padded to the minimum ethernet packet size
+	 * by the ndev layer, which adds a reference to a static buffer of
+	 * zeroes as an extra I/O vector element, rather than by copying the
+	 * packet into a larger buffer here.  Thus, we need to make a copy of
+	 * the packet only in the (exceptional) case that the pbuf chain,
+	 * including any padding element, exceeds the maximum vector size for
+	 * network driver requests.
 	 */
 	if (NDEV_ETH_PACKET_MIN > pbuf->tot_len)
 		padding = NDEV_ETH_PACKET_MIN - pbuf->tot_len;
@@ -635,7 +646,7 @@ ethif_output(struct ifdev * ifdev, struct pbuf * pbuf, struct netif * netif)
 
 	count = pbuf_clen(pbuf);
 
-	if (padding != 0 || count > NDEV_IOV_MAX) {
+	if (count + !!padding > NDEV_IOV_MAX) {
 		pcopy = pchain_alloc(PBUF_RAW, pbuf->tot_len + padding);
 		if (pcopy == NULL) {
 			ifdev_output_drop(ifdev);
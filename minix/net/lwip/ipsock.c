@@ -492,6 +492,12 @@ ipsock_setsockopt(struct ipsock * ip, int level, int name,
 
 			ip->ip_sndbuf = val;
 
+			/*
+			 * An explicitly set buffer size disables any
+			 * automatic buffer size tuning for the socket.
+			 */
+			ipsock_set_flag(ip, IPF_SNDBUF_SET);
+
 			return OK;
 
 		case SO_RCVBUF:
@@ -505,6 +511,9 @@ ipsock_setsockopt(struct ipsock * ip, int level, int name,
 
 			ip->ip_rcvbuf = val;
 
+			/* See the SO_SNDBUF case right above. */
+			ipsock_set_flag(ip, IPF_RCVBUF_SET);
+
 			return OK;
 		}
 
@@ -20,6 +20,8 @@ struct ipsock {
  */
 #define IPF_IPV6		0x0000001	/* socket is IPv6 */
 #define IPF_V6ONLY		0x0000002	/* socket is IPv6 only */
+#define IPF_SNDBUF_SET		0x0000004	/* send buf size set by user */
+#define IPF_RCVBUF_SET		0x0000008	/* recv buf size set by user */
 
 #define PKTF_RECVINFO		0x0000010	/* receive ancillary PKTINFO */
 #define PKTF_RECVTTL		0x0000020	/* receive ancillary TTL */
@@ -31,6 +33,8 @@ struct ipsock {
 #define TCPF_RCVD_FIN		0x0004000	/* received FIN from peer */
 #define TCPF_FULL		0x0008000	/* PCB send buffer is full */
 #define TCPF_OOM		0x0010000	/* memory allocation failed */
+#define TCPF_DEFER_ACCEPT	0x0020000	/* hand out connections only
+						 * once data has arrived */
 
 #define ipsock_get_sock(ip)		(&(ip)->ip_sock)
 #define ipsock_is_ipv6(ip)		((ip)->ip_flags & IPF_IPV6)
@@ -41,6 +45,8 @@ struct ipsock {
 #define ipsock_clear_flag(ip,fl)	((ip)->ip_flags &= ~(fl))
 #define ipsock_get_sndbuf(ip)		((ip)->ip_sndbuf)
 #define ipsock_get_rcvbuf(ip)		((ip)->ip_rcvbuf)
+#define ipsock_set_sndbuf(ip,sz)	((ip)->ip_sndbuf = (sz))
+#define ipsock_set_rcvbuf(ip,sz)	((ip)->ip_rcvbuf = (sz))
 
 /*
  * IP-level option pointers.  This is necessary because even though lwIP's
@@ -4,6 +4,23 @@
  * loop back packets sent on other interfaces to the local interface address.
  * Therefore, not all packets on the loopback device have a source or
  * destination address corresponding to the loopback device.
+ *
+ * A note on performance.  Loopback traffic takes the full IP input path,
+ * including one packet copy in loopif_output().  Both are less wasteful than
+ * they may seem, and attempts to shortcut this path should mind the
+ * following.  IP, UDP and TCP checksumming is already disabled on loopback
+ * interfaces (see loopif_init()), so the input path does not actually
+ * checksum anything.  The copy cannot be avoided by taking a reference to the
+ * original pbuf: the protocol layers above us keep using the buffer after we
+ * return--TCP holds on to its segments for retransmission, and UDP strips
+ * off the headers it prepended in place--so by delivery time the contents
+ * would no longer be the packet as it was handed to us.  Finally, handing
+ * data directly from socket to socket, bypassing IP encapsulation entirely,
+ * is not an option in this design: for TCP, the entire protocol state machine
+ * lives inside lwIP and is driven by the segments themselves, and for all
+ * protocols, such a bypass would hide local traffic from BPF devices attached
+ * to the loopback interface, from matching raw sockets, and from the
+ * interface and protocol statistics.
  */
 
 #include "lwip.h"
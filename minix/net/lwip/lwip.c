@@ -209,6 +209,7 @@ init(int type __unused, sef_init_info_t * init __unused)
 	sockevent_init(alloc_socket);
 
 	/* Initialize various helper modules. */
+	perfstat_init();
 	mempool_init();
 	tcpisn_init();
 	mcast_init();
@@ -253,9 +254,17 @@ init(int type __unused, sef_init_info_t * init __unused)
 	 * Initialize the master timer for all the lwIP timers.  Just in case
 	 * lwIP starts a timer right away, perform a first check upon entry of
 	 * the message loop.
+	 *
+	 * Allow the timer to be delivered one tick late.  The conversions
+	 * between lwIP's relative milliseconds and absolute clock ticks in
+	 * set_lwip_timer() introduce that much jitter anyway, and the slack
+	 * stops the timers library from reprogramming the kernel alarm on
+	 * every such conversion wobble (see the comment in set_lwip_timer).
 	 */
 	init_timer(&lwip_timer);
 
+	set_timer_slack(1);
+
 	recheck_timer = TRUE;
 
 	running = TRUE;
@@ -299,6 +308,15 @@ main(void)
 	startup();
 
 	while (running) {
+		/*
+		 * Defer all socket event processing, so that socket events
+		 * raised while handling this loop iteration are batched and
+		 * coalesced per socket rather than processed one at a time.
+		 * The deferral window must not span the blocking receive
+		 * below, as that would delay wakeups of user processes.
+		 */
+		sockevent_defer();
+
 		/*
 		 * For various reasons, the loopback interface does not pass
 		 * packets back into the stack right away.  Instead, it queues
@@ -314,6 +332,8 @@ main(void)
 		 */
 		check_lwip_timer();
 
+		sockevent_flush();
+
 		if ((r = sef_receive_status(ANY, &m, &ipc_status)) != OK) {
 			if (r == EINTR)
 				continue;	/* sef_cancel() was called */
@@ -321,6 +341,8 @@ main(void)
 			panic("sef_receive_status failed: %d", r);
 		}
 
+		sockevent_defer();
+
 		/* Process the received message. */
 		if (is_ipc_notify(ipc_status)) {
 			switch (m.m_source) {
@@ -340,6 +362,8 @@ main(void)
 				    m.m_source);
 			}
 
+			sockevent_flush();
+
 			continue;
 		}
 
@@ -376,6 +400,8 @@ main(void)
 			printf("unexpected message %d from %d\n",
 			    m.m_type, m.m_source);
 		}
+
+		sockevent_flush();
 	}
 
 	return 0;
@@ -80,6 +80,22 @@ void mempool_init(void);
 unsigned int mempool_cur_buffers(void);
 unsigned int mempool_max_buffers(void);
 
+/* perfstat.c */
+struct perfstat {
+	uint64_t ps_calls;	/* number of measured invocations */
+	uint64_t ps_cycles;	/* total TSC cycles spent */
+	uint64_t ps_bytes;	/* total number of bytes processed */
+};
+
+extern struct perfstat perfstat_ndev_send;
+extern struct perfstat perfstat_ndev_recv;
+extern struct perfstat perfstat_tcp_sent;
+extern struct perfstat perfstat_tcp_recv;
+
+void perfstat_init(void);
+uint64_t perfstat_enter(void);
+void perfstat_leave(struct perfstat * ps, uint64_t start, size_t bytes);
+
 /* pchain.c */
 struct pbuf **pchain_end(struct pbuf * pbuf);
 size_t pchain_size(struct pbuf * pbuf);
@@ -244,6 +244,36 @@ static int mempool_nr_large;	/* current number of large buffers */
 static int mempool_used_large;	/* large buffers currently in use */
 static int mempool_used_small;	/* small buffers currently in use */
 
+/*
+ * Allocation statistics, mainly to aid sizing the pools for a particular
+ * deployment: a high miss rate suggests raising the maximum number of slabs
+ * (and failures mean packets were in fact dropped), while an allocation
+ * pattern consisting of virtually only hits suggests room for shrinking it.
+ * A "hit" is an allocation served from the buffers already in the pool; a
+ * "miss" is an allocation that found no free buffer and had to grow the pool
+ * first; a "fail" is an allocation that returned no buffer at all, because
+ * the configured maximum was reached or the system was out of memory.
+ */
+static uint64_t mempool_large_hits;	/* large buffer allocation hits */
+static uint64_t mempool_large_misses;	/* large buffer allocation misses */
+static uint64_t mempool_large_fails;	/* failed large buffer allocations */
+static uint64_t mempool_small_hits;	/* small buffer allocation hits */
+static uint64_t mempool_small_misses;	/* small buffer allocation misses */
+static uint64_t mempool_small_fails;	/* failed small buffer allocations */
+static uint64_t mempool_denied;		/* denied excessive allocations */
+
+/*
+ * The low water mark on the number of free large buffers.  If, at the time of
+ * the regular timer invocation, fewer than this many large buffers are free,
+ * a new slab is allocated in advance (policy and memory permitting), so that
+ * a subsequent traffic burst does not have to go to VM for more memory in the
+ * middle of packet processing.  The mark is changeable through sysctl(7), and
+ * thus possibly completely arbitrary; zero or less disables preallocation.
+ */
+#define MEMPOOL_DEFAULT_LOWAT	(MEMPOOL_LARGE_COUNT / 8)
+
+static int mempool_lowat;	/* low water mark on free large buffers */
+
 /*
  * Number of clock ticks between timer invocations.  The timer is used to
  * deallocate unused slabs.
@@ -274,6 +304,22 @@ static struct rmib_node minix_lwip_mempool_table[] = {
 	    "Current number of used small buffers"),
 	RMIB_INT(RMIB_RO, MEMPOOL_SMALL_SIZE, "small_size",
 	    "Byte size of a single small buffer"),
+	RMIB_INTPTR(RMIB_RW, &mempool_lowat, "lowat",
+	    "Low water mark on free large buffers (configurable)"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_large_hits, "large_hits",
+	    "Large buffer allocations served from the pool"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_large_misses, "large_misses",
+	    "Large buffer allocations that had to grow the pool"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_large_fails, "large_fails",
+	    "Failed large buffer allocations"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_small_hits, "small_hits",
+	    "Small buffer allocations served from the pool"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_small_misses, "small_misses",
+	    "Small buffer allocations that had to grow the pool"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_small_fails, "small_fails",
+	    "Failed small buffer allocations"),
+	RMIB_QUADPTR(RMIB_RO, &mempool_denied, "denied",
+	    "Denied excessively large allocations"),
 };
 
 static struct rmib_node minix_lwip_mempool_node =
@@ -418,15 +464,30 @@ mempool_tick(int arg __unused)
 
 	/*
 	 * Go through all the empty slabs, destroying marked slabs and marking
-	 * unmarked slabs.
+	 * unmarked slabs.  Leave slabs around as long as destroying them would
+	 * drop the number of free large buffers below the low water mark.
 	 */
 	LIST_FOREACH_SAFE(mls, &mempool_empty_slabs, mls_next, tmls) {
+		if (mempool_nr_large - mempool_used_large -
+		    MEMPOOL_LARGE_COUNT < mempool_lowat)
+			break;
+
 		if (mls->mls_header.mh_flags & MHF_MARKED)
 			mempool_destroy_slab(mls);
 		else
 			mls->mls_header.mh_flags |= MHF_MARKED;
 	}
 
+	/*
+	 * Preallocate a slab if the number of free large buffers has dropped
+	 * below the low water mark, so that a traffic burst does not force us
+	 * to go to VM for more memory in the middle of packet processing.
+	 * Allocation of additional slabs beyond this one, as well as enforcing
+	 * the configured maximum, is left to the regular allocation path.
+	 */
+	if (mempool_nr_large - mempool_used_large < mempool_lowat)
+		mempool_new_slab();
+
 	/*
 	 * If allocation failed during the last interval, allow a new attempt
 	 * during the next.
@@ -466,6 +527,16 @@ mempool_init(void)
 	mempool_used_large = 0;
 	mempool_used_small = 0;
 
+	mempool_large_hits = 0;
+	mempool_large_misses = 0;
+	mempool_large_fails = 0;
+	mempool_small_hits = 0;
+	mempool_small_misses = 0;
+	mempool_small_fails = 0;
+	mempool_denied = 0;
+
+	mempool_lowat = MEMPOOL_DEFAULT_LOWAT;
+
 	mempool_defer_alloc = FALSE;
 
 	/* Initialize the static pool of small buffers. */
@@ -534,15 +605,23 @@ mempool_alloc_large(void)
 	 * eventual consolidation.  If both lists are empty, try allocating a
 	 * new slab.  If that fails, we are out of memory, and return NULL.
 	 */
-	if (!LIST_EMPTY(&mempool_partial_slabs))
+	if (!LIST_EMPTY(&mempool_partial_slabs)) {
+		mempool_large_hits++;
+
 		mls = LIST_FIRST(&mempool_partial_slabs);
-	else {
+	} else {
 		if (LIST_EMPTY(&mempool_empty_slabs)) {
 			mempool_new_slab();
 
-			if (LIST_EMPTY(&mempool_empty_slabs))
+			if (LIST_EMPTY(&mempool_empty_slabs)) {
+				mempool_large_fails++;
+
 				return NULL; /* out of memory */
-		}
+			}
+
+			mempool_large_misses++;
+		} else
+			mempool_large_hits++;
 
 		mls = LIST_FIRST(&mempool_empty_slabs);
 	}
@@ -605,6 +684,8 @@ mempool_alloc_small(void)
 	 * divvy up into small blocks.  If that fails, we are out of memory.
 	 */
 	if (!TAILQ_EMPTY(&mempool_small_static_freelist)) {
+		mempool_small_hits++;
+
 		msb = TAILQ_FIRST(&mempool_small_static_freelist);
 
 		TAILQ_REMOVE(&mempool_small_static_freelist, msb, msb_next);
@@ -613,12 +694,18 @@ mempool_alloc_small(void)
 			mss =
 			    (struct mempool_small_slab *)mempool_alloc_large();
 
-			if (mss == NULL)
+			if (mss == NULL) {
+				mempool_small_fails++;
+
 				return NULL; /* out of memory */
+			}
 
 			/* Initialize the small slab, including its blocks. */
 			mempool_prepare_small(mss, FALSE /*is_static*/);
-		}
+
+			mempool_small_misses++;
+		} else
+			mempool_small_hits++;
 
 		msb = TAILQ_FIRST(&mempool_small_dynamic_freelist);
 		assert(msb != NULL);
@@ -657,8 +744,11 @@ mempool_malloc(size_t size)
 	 * warnings here.  For now, refusing these excessive allocations should
 	 * not be a problem in practice.
 	 */
-	if (size > MEMPOOL_LARGE_SIZE)
+	if (size > MEMPOOL_LARGE_SIZE) {
+		mempool_denied++;
+
 		return NULL;
+	}
 
 	if (size <= MEMPOOL_SMALL_SIZE)
 		return mempool_alloc_small();
@@ -70,7 +70,7 @@
 #define LABEL_MAX	16	/* FIXME: this should be in a system header */
 
 #define NDEV_SENDQ	2	/* minimum guaranteed send queue depth */
-#define NDEV_RECVQ	2	/* guaranteed receive queue depth */
+#define NDEV_RECVQ	8	/* guaranteed receive queue depth */
 #define NREQ_SPARES	8	/* spare send queue (request) objects */
 #define NR_NREQ		((NDEV_SENDQ + NDEV_RECVQ) * NR_NDEV + NREQ_SPARES)
 
@@ -84,6 +84,14 @@ static struct ndev_req {
 
 static unsigned int nreq_spares;	/* number of free spare objects */
 
+/*
+ * All-zeroes buffer, granted to drivers as the last element of the I/O vector
+ * of undersized packets in order to pad them to the minimum packet size.
+ * Sharing one static buffer this way saves the ethif layer from having to
+ * copy each undersized packet into a larger buffer just to add the padding.
+ */
+static const char ndev_zero_pad[NDEV_ETH_PACKET_MIN];
+
 struct ndev_queue {
 	uint32_t nq_head;		/* ID of oldest pending request */
 	uint8_t nq_count;		/* current nr of pending requests */
@@ -144,8 +152,8 @@ ndev_init(void)
 	 * concurrently.  Even though it is extremely unlikely that we will
 	 * ever need that many grants in practice, the alternative is runtime
 	 * dynamic memory (re)allocation which is something we prefer to avoid
-	 * altogether.  At time of writing, we end up preallocating 320 grants
-	 * using up a total of a bit under 9KB of memory.
+	 * altogether.  At time of writing, we end up preallocating 704 grants
+	 * using up a total of a bit under 20KB of memory.
 	 */
 	cpf_prealloc(NR_NREQ * NDEV_IOV_MAX);
 
@@ -740,19 +748,24 @@ ndev_conf_reply(struct ndev * ndev, const message * m_ptr)
  */
 static int
 ndev_transfer(struct ndev * ndev, const struct pbuf * pbuf, int do_send,
-	uint32_t seq, struct ndev_req * nreq)
+	size_t padding, uint32_t seq, struct ndev_req * nreq)
 {
 	cp_grant_id_t grant;
 	message m;
 	unsigned int i;
-	size_t left;
+	uint64_t tsc;
+	size_t total, left;
 	int r;
 
+	tsc = perfstat_enter();
+
+	total = pbuf->tot_len;
+
 	memset(&m, 0, sizeof(m));
 	m.m_type = (do_send) ? NDEV_SEND : NDEV_RECV;
 	m.m_ndev_netdriver_transfer.id = seq;
 
-	left = pbuf->tot_len;
+	left = total;
 
 	for (i = 0; left > 0; i++) {
 		assert(i < NDEV_IOV_MAX);
@@ -778,6 +791,33 @@ ndev_transfer(struct ndev * ndev, const struct pbuf * pbuf, int do_send,
 		pbuf = pbuf->next;
 	}
 
+	/*
+	 * For undersized packets, grant the driver read access to the static
+	 * all-zeroes buffer as the final element of the I/O vector, padding
+	 * the packet to the minimum packet size.
+	 */
+	if (padding > 0) {
+		assert(do_send);
+		assert(i < NDEV_IOV_MAX);
+		assert(padding <= sizeof(ndev_zero_pad));
+
+		grant = cpf_grant_direct(ndev->ndev_endpt,
+		    (vir_bytes)ndev_zero_pad, padding, CPF_READ);
+
+		if (!GRANT_VALID(grant)) {
+			while (i-- > 0)
+				(void)cpf_revoke(nreq->nreq_grant[i]);
+
+			return ENOMEM;
+		}
+
+		m.m_ndev_netdriver_transfer.grant[i] = grant;
+		m.m_ndev_netdriver_transfer.len[i] = padding;
+
+		nreq->nreq_grant[i] = grant;
+		i++;
+	}
+
 	m.m_ndev_netdriver_transfer.count = i;
 
 	/*
@@ -790,6 +830,13 @@ ndev_transfer(struct ndev * ndev, const struct pbuf * pbuf, int do_send,
 	if ((r = asynsend3(ndev->ndev_endpt, &m, AMF_NOREPLY)) != OK)
 		panic("asynsend to driver failed: %d", r);
 
+	/*
+	 * Account the cycles spent on granting access to, and dispatching,
+	 * the packet, separately for the send and receive paths.
+	 */
+	perfstat_leave((do_send) ? &perfstat_ndev_send : &perfstat_ndev_recv,
+	    tsc, total);
+
 	return OK;
 }
 
@@ -803,7 +850,7 @@ ndev_transfer(struct ndev * ndev, const struct pbuf * pbuf, int do_send,
  * for the data being sent.  The same applies to ndev_receive().
  */
 int
-ndev_send(ndev_id_t id, const struct pbuf * pbuf)
+ndev_send(ndev_id_t id, const struct pbuf * pbuf, size_t padding)
 {
 	struct ndev *ndev;
 	struct ndev_req *nreq;
@@ -820,7 +867,8 @@ ndev_send(ndev_id_t id, const struct pbuf * pbuf)
 	    &seq)) == NULL)
 		return EBUSY;
 
-	if ((r = ndev_transfer(ndev, pbuf, TRUE /*do_send*/, seq, nreq)) != OK)
+	if ((r = ndev_transfer(ndev, pbuf, TRUE /*do_send*/, padding, seq,
+	    nreq)) != OK)
 		return r;
 
 	ndev_queue_add(&ndev->ndev_sendq, nreq);
@@ -895,8 +943,8 @@ ndev_recv(ndev_id_t id, struct pbuf * pbuf)
 	    &seq)) == NULL)
 		return EBUSY;
 
-	if ((r = ndev_transfer(ndev, pbuf, FALSE /*do_send*/, seq,
-	    nreq)) != OK)
+	if ((r = ndev_transfer(ndev, pbuf, FALSE /*do_send*/, 0 /*padding*/,
+	    seq, nreq)) != OK)
 		return r;
 
 	ndev_queue_add(&ndev->ndev_recvq, nreq);
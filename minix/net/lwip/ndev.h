@@ -26,7 +26,7 @@ void ndev_check(void);
 void ndev_process(const message * m_ptr, int ipc_status);
 
 int ndev_conf(ndev_id_t id, const struct ndev_conf * nconf);
-int ndev_send(ndev_id_t id, const struct pbuf * pbuf);
+int ndev_send(ndev_id_t id, const struct pbuf * pbuf, size_t padding);
 int ndev_can_recv(ndev_id_t id);
 int ndev_recv(ndev_id_t id, struct pbuf * pbuf);
 
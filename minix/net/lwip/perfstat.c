@@ -0,0 +1,116 @@
+/* LWIP service - perfstat.c - per-stage performance counters */
+/*
+ * This module maintains counters that attribute the cost of packet processing
+ * to the individual stages of the stack: communication with network drivers
+ * (the ndev module), Internet checksum computation (liblwip's chksum module),
+ * and TCP event processing (the tcpsock module).  Each instrumented stage
+ * accounts the number of times it ran, the number of TSC cycles it spent, and
+ * where applicable the number of bytes it processed.  The counters are
+ * exported read-only through the minix.lwip sysctl(7) subtree, so that a
+ * benchmark can take a snapshot of the counters before and after a run and
+ * break down where the run spent its cycles.  The counters are raw TSC cycle
+ * totals; the estimated TSC frequency is exported along with them for
+ * conversion to time units.
+ *
+ * The instrumented code paths invoke perfstat_enter() and perfstat_leave()
+ * around the work to be measured.  The measurement overhead is a pair of TSC
+ * reads per invocation, which is small compared to the per-packet work being
+ * measured here, and which is the reason that the stages are instrumented at
+ * (e.g.) packet rather than byte granularity.
+ */
+
+#include "lwip.h"
+
+#include <minix/minlib.h>
+
+struct perfstat perfstat_ndev_send;	/* driver send requests (ndev) */
+struct perfstat perfstat_ndev_recv;	/* driver receive requests (ndev) */
+struct perfstat perfstat_tcp_sent;	/* TCP data-acknowledged events */
+struct perfstat perfstat_tcp_recv;	/* TCP data-received events */
+
+static int perfstat_tsc_khz;		/* estimated TSC frequency, in kHz */
+
+/* The CTL_MINIX MINIX_LWIP "perf" subtree.  Dynamically numbered. */
+static struct rmib_node minix_lwip_perf_table[] = {
+	RMIB_INTPTR(RMIB_RO, &perfstat_tsc_khz, "tsc_khz",
+	    "Estimated TSC frequency in kHz"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_ndev_send.ps_calls, "ndev_send_pkts",
+	    "Packet send requests issued to network drivers"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_ndev_send.ps_cycles,
+	    "ndev_send_cycles",
+	    "TSC cycles spent issuing packet send requests"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_ndev_send.ps_bytes, "ndev_send_bytes",
+	    "Bytes covered by packet send requests"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_ndev_recv.ps_calls, "ndev_recv_pkts",
+	    "Packet receive requests issued to network drivers"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_ndev_recv.ps_cycles,
+	    "ndev_recv_cycles",
+	    "TSC cycles spent issuing packet receive requests"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_ndev_recv.ps_bytes, "ndev_recv_bytes",
+	    "Bytes covered by packet receive requests"),
+	RMIB_QUADPTR(RMIB_RO, &lwip_minix_chksum_calls, "chksum_calls",
+	    "Internet checksum computations"),
+	RMIB_QUADPTR(RMIB_RO, &lwip_minix_chksum_cycles, "chksum_cycles",
+	    "TSC cycles spent computing Internet checksums"),
+	RMIB_QUADPTR(RMIB_RO, &lwip_minix_chksum_bytes, "chksum_bytes",
+	    "Bytes covered by Internet checksum computations"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_tcp_sent.ps_calls, "tcp_sent_calls",
+	    "TCP data-acknowledged events processed"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_tcp_sent.ps_cycles, "tcp_sent_cycles",
+	    "TSC cycles spent processing TCP data-acknowledged events"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_tcp_sent.ps_bytes, "tcp_sent_bytes",
+	    "Bytes acknowledged in TCP data-acknowledged events"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_tcp_recv.ps_calls, "tcp_recv_calls",
+	    "TCP data-received events processed"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_tcp_recv.ps_cycles, "tcp_recv_cycles",
+	    "TSC cycles spent processing TCP data-received events"),
+	RMIB_QUADPTR(RMIB_RO, &perfstat_tcp_recv.ps_bytes, "tcp_recv_bytes",
+	    "Bytes delivered in TCP data-received events"),
+};
+
+static struct rmib_node minix_lwip_perf_node =
+    RMIB_NODE(RMIB_RO, minix_lwip_perf_table, "perf",
+	"Per-stage packet processing cost counters");
+
+/*
+ * Initialize the performance counter module.
+ */
+void
+perfstat_init(void)
+{
+
+	perfstat_tsc_khz = (int)tsc_get_khz();
+
+	mibtree_register_lwip(&minix_lwip_perf_node);
+}
+
+/*
+ * Start a measurement.  Return the current TSC value, to be passed to
+ * perfstat_leave() when the measured work has been completed.
+ */
+uint64_t
+perfstat_enter(void)
+{
+	u64_t tsc;
+
+	read_tsc_64(&tsc);
+
+	return tsc;
+}
+
+/*
+ * Finish a measurement.  Account the cycles spent since the matching
+ * perfstat_enter() call, as well as the given number of processed bytes, to
+ * the given counter set.
+ */
+void
+perfstat_leave(struct perfstat * ps, uint64_t start, size_t bytes)
+{
+	u64_t tsc;
+
+	read_tsc_64(&tsc);
+
+	ps->ps_calls++;
+	ps->ps_cycles += tsc - start;
+	ps->ps_bytes += bytes;
+}
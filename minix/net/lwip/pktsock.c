@@ -63,6 +63,7 @@ pktsock_socket(struct pktsock * pkt, int domain, size_t sndbuf, size_t rcvbuf,
 	pkt->pkt_rcvhead = NULL;
 	pkt->pkt_rcvtailp = &pkt->pkt_rcvhead;
 	pkt->pkt_rcvlen = 0;
+	pkt->pkt_rcvdrops = 0;
 
 	mcast_reset(&pkt->pkt_mcast);
 
@@ -133,9 +134,11 @@ pktsock_test_input(struct pktsock * pkt, struct pbuf * pbuf)
 
 /*
  * A packet has arrived on a packet socket.  We own the given packet buffer,
- * and so we must free it if we do not want to keep it.
+ * and so we must free it if we do not want to keep it.  Return TRUE if the
+ * packet was enqueued on the socket's receive queue, or FALSE if it was
+ * dropped, so that the caller may maintain statistics.
  */
-void
+int
 pktsock_input(struct pktsock * pkt, struct pbuf * pbuf,
 	const ip_addr_t * srcaddr, uint16_t port)
 {
@@ -158,9 +161,19 @@ pktsock_input(struct pktsock * pkt, struct pbuf * pbuf,
 
 	/* If the packet should not be received on this socket, drop it. */
 	if (!pktsock_may_recv(pkt, pbuf)) {
+		/*
+		 * Count the drop on the socket if it is due to a full receive
+		 * buffer, for SO_OVERFLOWED.  The only other possible cause
+		 * for dropping here is the multicast awareness policy, which
+		 * is not an overflow condition.
+		 */
+		if (pkt->pkt_rcvlen + pbuf->tot_len >
+		    ipsock_get_rcvbuf(&pkt->pkt_ipsock))
+			pkt->pkt_rcvdrops++;
+
 		pbuf_free(pbuf);
 
-		return;
+		return FALSE;
 	}
 
 	/*
@@ -240,6 +253,8 @@ pktsock_input(struct pktsock * pkt, struct pbuf * pbuf,
 	pkt->pkt_rcvlen += pchain_size(pbuf);
 
 	sockevent_raise(ipsock_get_sock(&pkt->pkt_ipsock), SEV_RECV);
+
+	return TRUE;
 }
 
 /*
@@ -1111,6 +1126,21 @@ pktsock_getsockopt(struct pktsock * pkt, int level, int name,
 	int val;
 
 	switch (level) {
+	case SOL_SOCKET:
+		switch (name) {
+		case SO_OVERFLOWED:
+			/*
+			 * The number of packets dropped because the receive
+			 * buffer was full.  This option cannot be set.
+			 */
+			val = (int)pkt->pkt_rcvdrops;
+
+			return sockdriver_copyout_opt(data, &val, sizeof(val),
+			    len);
+		}
+
+		break;
+
 	case IPPROTO_IP:
 		if (ipsock_is_ipv6(&pkt->pkt_ipsock))
 			break;
@@ -9,6 +9,7 @@ struct pktsock {
 	struct pbuf *pkt_rcvhead;	/* receive buffer, first packet */
 	struct pbuf **pkt_rcvtailp;	/* receive buffer, last ptr-ptr */
 	size_t pkt_rcvlen;		/* receive buffer, length in bytes */
+	unsigned long pkt_rcvdrops;	/* packets dropped, buffer full */
 	struct mcast_head pkt_mcast;	/* multicast membership list */
 	ip6_addr_p_t pkt_srcaddr;	/* IPV6_PKTINFO: source address */
 	uint32_t pkt_ifindex;		/* IPV6_KPTINFO: interface index */
@@ -34,7 +35,7 @@ struct pktopt {
 int pktsock_socket(struct pktsock * pkt, int domain, size_t sndbuf,
 	size_t rcvbuf, struct sock ** sockp);
 int pktsock_test_input(struct pktsock * pkt, struct pbuf * pbuf);
-void pktsock_input(struct pktsock * pkt, struct pbuf * pbuf,
+int pktsock_input(struct pktsock * pkt, struct pbuf * pbuf,
 	const ip_addr_t * srcaddr, uint16_t port);
 int pktsock_get_pktinfo(struct pktsock * pkt, struct pktopt * pkto,
 	struct ifdev ** ifdevp, ip_addr_t * src_addrp);
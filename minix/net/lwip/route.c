@@ -137,25 +137,59 @@ static SIMPLEQ_HEAD(, route_entry) route_freelist;	/* free entry list */
 
 static struct rttree route_tree[NR_ROUTE_TREE];
 
-/* We support a single cached routing entry per address family (IPv4, IPv6). */
-static int rtcache_v4set;
-static ip4_addr_t rtcache_v4addr;
-static struct route_entry *rtcache_v4route;
-
-static int rtcache_v6set;
-static ip6_addr_t rtcache_v6addr;
-static struct route_entry *rtcache_v6route;
+/*
+ * We maintain a small direct-mapped cache of recent routing lookup results
+ * per address family (IPv4, IPv6).  Negative results are cached as well, as a
+ * NULL routing entry pointer.  Rather than clearing the cache on a routing
+ * change, each cache entry is stamped with the generation number of its
+ * address family at the time of the lookup; bumping the generation number
+ * invalidates all cached results at once, in constant time.  A generation
+ * number of zero marks a cache slot as unused, so the generation counters
+ * themselves start at one and skip zero when they wrap around.
+ */
+#define RTCACHE_SLOTS	16	/* per address family; must be a power of 2 */
+
+static struct {
+	ip4_addr_t rc4_addr;
+	struct route_entry *rc4_route;
+	uint32_t rc4_gen;
+} rtcache_v4[RTCACHE_SLOTS];
+static uint32_t rtcache_v4gen;
+
+static struct {
+	ip6_addr_t rc6_addr;
+	struct route_entry *rc6_route;
+	uint32_t rc6_gen;
+} rtcache_v6[RTCACHE_SLOTS];
+static uint32_t rtcache_v6gen;
 
 /*
- * Initialize the routing cache.  There are a lot of trivial functions here,
- * but this is designed to be extended in the future.
+ * Initialize the routing cache.
  */
 static void
 rtcache_init(void)
 {
 
-	rtcache_v4set = FALSE;
-	rtcache_v6set = FALSE;
+	memset(rtcache_v4, 0, sizeof(rtcache_v4));
+	rtcache_v4gen = 1;
+
+	memset(rtcache_v6, 0, sizeof(rtcache_v6));
+	rtcache_v6gen = 1;
+}
+
+/*
+ * Return the routing cache slot number for the given IPv4 address.
+ */
+static inline unsigned int
+rtcache_slot_v4(const ip4_addr_t * ipaddr)
+{
+	uint32_t val;
+
+	val = ip4_addr_get_u32(ipaddr);
+	val ^= val >> 16;
+	val ^= val >> 8;
+
+	return val & (RTCACHE_SLOTS - 1);
 }
 
 /*
@@ -167,9 +201,13 @@ rtcache_init(void)
 static inline int
 rtcache_lookup_v4(const ip4_addr_t * ipaddr, struct route_entry ** route)
 {
+	unsigned int slot;
+
+	slot = rtcache_slot_v4(ipaddr);
 
-	if (rtcache_v4set && ip4_addr_cmp(&rtcache_v4addr, ipaddr)) {
-		*route = rtcache_v4route;
+	if (rtcache_v4[slot].rc4_gen == rtcache_v4gen &&
+	    ip4_addr_cmp(&rtcache_v4[slot].rc4_addr, ipaddr)) {
+		*route = rtcache_v4[slot].rc4_route;
 
 		return TRUE;
 	} else
@@ -183,10 +221,13 @@ rtcache_lookup_v4(const ip4_addr_t * ipaddr, struct route_entry ** route)
 static inline void
 rtcache_add_v4(const ip4_addr_t * ipaddr, struct route_entry * route)
 {
+	unsigned int slot;
 
-	rtcache_v4addr = *ipaddr;
-	rtcache_v4route = route;
-	rtcache_v4set = TRUE;
+	slot = rtcache_slot_v4(ipaddr);
+
+	rtcache_v4[slot].rc4_addr = *ipaddr;
+	rtcache_v4[slot].rc4_route = route;
+	rtcache_v4[slot].rc4_gen = rtcache_v4gen;
 }
 
 /*
@@ -196,7 +237,26 @@ static void
 rtcache_reset_v4(void)
 {
 
-	rtcache_v4set = FALSE;
+	if (++rtcache_v4gen == 0) {
+		memset(rtcache_v4, 0, sizeof(rtcache_v4));
+		rtcache_v4gen = 1;
+	}
+}
+
+/*
+ * Return the routing cache slot number for the given IPv6 address.
+ */
+static inline unsigned int
+rtcache_slot_v6(const ip6_addr_t * ipaddr)
+{
+	uint32_t val;
+
+	val = ipaddr->addr[0] ^ ipaddr->addr[1] ^ ipaddr->addr[2] ^
+	    ipaddr->addr[3];
+	val ^= val >> 16;
+	val ^= val >> 8;
+
+	return val & (RTCACHE_SLOTS - 1);
 }
 
 /*
@@ -208,9 +268,13 @@ rtcache_reset_v4(void)
 static inline int
 rtcache_lookup_v6(const ip6_addr_t * ipaddr, struct route_entry ** route)
 {
+	unsigned int slot;
+
+	slot = rtcache_slot_v6(ipaddr);
 
-	if (rtcache_v6set && ip6_addr_cmp(&rtcache_v6addr, ipaddr)) {
-		*route = rtcache_v6route;
+	if (rtcache_v6[slot].rc6_gen == rtcache_v6gen &&
+	    ip6_addr_cmp(&rtcache_v6[slot].rc6_addr, ipaddr)) {
+		*route = rtcache_v6[slot].rc6_route;
 
 		return TRUE;
 	} else
@@ -225,10 +289,13 @@ rtcache_lookup_v6(const ip6_addr_t * ipaddr, struct route_entry ** route)
 static inline void
 rtcache_add_v6(const ip6_addr_t * ipaddr, struct route_entry * route)
 {
+	unsigned int slot;
+
+	slot = rtcache_slot_v6(ipaddr);
 
-	rtcache_v6addr = *ipaddr;
-	rtcache_v6route = route;
-	rtcache_v6set = TRUE;
+	rtcache_v6[slot].rc6_addr = *ipaddr;
+	rtcache_v6[slot].rc6_route = route;
+	rtcache_v6[slot].rc6_gen = rtcache_v6gen;
 }
 
 /*
@@ -238,7 +305,10 @@ static void
 rtcache_reset_v6(void)
 {
 
-	rtcache_v6set = FALSE;
+	if (++rtcache_v6gen == 0) {
+		memset(rtcache_v6, 0, sizeof(rtcache_v6));
+		rtcache_v6gen = 1;
+	}
 }
 
 /*
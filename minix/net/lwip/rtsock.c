@@ -41,10 +41,14 @@ struct rtsock_rta {
 
 static const char rtsock_padbuf[RT_ROUNDUP(0)];
 
+/* The message type filter bitmap covers all possible (8-bit) RTM_ types. */
+#define RT_MSGFILTER_BYTES	(256 / NBBY)
+
 static struct rtsock {
 	struct sock rt_sock;		/* socket object, MUST be first */
 	int rt_family;			/* address family filter if not zero */
 	unsigned int rt_flags;		/* routing socket flags (RTF_) */
+	uint8_t rt_msgfilter[RT_MSGFILTER_BYTES];	/* RTM_ type filter */
 	struct pbuf *rt_rcvhead;	/* receive buffer, first packet */
 	struct pbuf **rt_rcvtailp;	/* receive buffer, last ptr-ptr */
 	size_t rt_rcvlen;		/* receive buffer, length in bytes */
@@ -53,6 +57,12 @@ static struct rtsock {
 } rt_array[NR_RTSOCK];
 
 #define RTF_NOLOOPBACK		0x1	/* suppress reply messages */
+#define RTF_MSGFILTER		0x2	/* deliver only filtered types */
+
+#define RT_MSGFILTER_ISSET(rt, type)	\
+	((rt)->rt_msgfilter[(type) >> 3] & (1 << ((type) & 7)))
+#define RT_MSGFILTER_SET(rt, type)	\
+	((rt)->rt_msgfilter[(type) >> 3] |= (1 << ((type) & 7)))
 
 static TAILQ_HEAD(, rtsock) rt_freelist;	/* free routing sockets */
 static TAILQ_HEAD(, rtsock) rt_activelist;	/* active routing sockets */
@@ -360,13 +370,14 @@ rtsock_enqueue(struct rtsock * rt, struct pbuf * pbuf)
 }
 
 /*
- * Determine whether a routing message for address family 'family', originated
- * from routing socket 'rtsrc' if not NULL, should be sent to routing socket
- * 'rt'.  Return TRUE if the message should be sent to this socket, or FALSE
- * if it should not.
+ * Determine whether a routing message of type 'type' for address family
+ * 'family', originated from routing socket 'rtsrc' if not NULL, should be sent
+ * to routing socket 'rt'.  Return TRUE if the message should be sent to this
+ * socket, or FALSE if it should not.
  */
 static int
-rtsock_can_send(struct rtsock *rt, struct rtsock *rtsrc, int family)
+rtsock_can_send(struct rtsock *rt, struct rtsock *rtsrc, unsigned int type,
+	int family)
 {
 
 	/* Do not send anything on sockets shut down for reading. */
@@ -380,6 +391,16 @@ rtsock_can_send(struct rtsock *rt, struct rtsock *rtsrc, int family)
 	if (rt == rtsrc && (rt->rt_flags & RTF_NOLOOPBACK))
 		return FALSE;
 
+	/*
+	 * If the socket has a message type filter, check the message type
+	 * against it.  As with the address family check below, make an
+	 * exception if the socket was the source of the request, so that it
+	 * always receives the replies to its own requests.
+	 */
+	if ((rt->rt_flags & RTF_MSGFILTER) && rt != rtsrc &&
+	    !RT_MSGFILTER_ISSET(rt, type))
+		return FALSE;
+
 	/*
 	 * For address family specific messages, make sure the routing socket
 	 * is interested in that family.  Make an exception if the socket was
@@ -408,14 +429,16 @@ rtsock_can_send(struct rtsock *rt, struct rtsock *rtsrc, int family)
  * NULL.  In the former case, the function takes ownership of 'pbuf'.  The
  * given routing socket is assumed to be the source of the routing request that
  * generated this message.  In the latter case, the function returns TRUE if
- * the socket would take the message or FALSE if not.  If 'family' is not
- * AF_UNSPEC, it is to be the address family of the message.
+ * the socket would take the message or FALSE if not.  'type' is to be the
+ * message type (RTM_) of the message.  If 'family' is not AF_UNSPEC, it is to
+ * be the address family of the message.
  */
 static int
-rtsock_msg_one(struct rtsock * rt, int family, struct pbuf * pbuf)
+rtsock_msg_one(struct rtsock * rt, unsigned int type, int family,
+	struct pbuf * pbuf)
 {
 
-	if (rtsock_can_send(rt, rt, family)) {
+	if (rtsock_can_send(rt, rt, type, family)) {
 		if (pbuf != NULL)
 			rtsock_enqueue(rt, pbuf);
 
@@ -434,11 +457,13 @@ rtsock_msg_one(struct rtsock * rt, int family, struct pbuf * pbuf)
  * the former case, the function takes ownership of 'pbuf'.  In the latter
  * case, the function returns TRUE if there are any matching sockets or FALSE
  * if there are none.  If 'rtsrc' is not NULL, it is to be the routing socket
- * that is the source of the message.  If 'family' is not AF_UNSPEC, it is to
- * be the address family of the message.
+ * that is the source of the message.  'type' is to be the message type (RTM_)
+ * of the message.  If 'family' is not AF_UNSPEC, it is to be the address
+ * family of the message.
  */
 static int
-rtsock_msg_match(struct rtsock * rtsrc, int family, struct pbuf * pbuf)
+rtsock_msg_match(struct rtsock * rtsrc, unsigned int type, int family,
+	struct pbuf * pbuf)
 {
 	struct rtsock *rt, *rtprev;
 	struct pbuf *pcopy;
@@ -446,7 +471,7 @@ rtsock_msg_match(struct rtsock * rtsrc, int family, struct pbuf * pbuf)
 	rtprev = NULL;
 
 	TAILQ_FOREACH(rt, &rt_activelist, rt_next) {
-		if (!rtsock_can_send(rt, rtsrc, family))
+		if (!rtsock_can_send(rt, rtsrc, type, family))
 			continue;
 
 		/*
@@ -701,7 +726,7 @@ rtsock_send(struct sock * sock, const struct sockdriver_data * data,
 	 * to other parties.  By sending failure replies only to the requestor,
 	 * we eliminate the need for security-sensitive request validation.
 	 */
-	if (r != OK && rtsock_can_send(rt, rt, AF_UNSPEC)) {
+	if (r != OK && rtsock_can_send(rt, rt, rtm.rtm_type, AF_UNSPEC)) {
 		rtm.rtm_errno = -r;
 
 		if ((pbuf = rtsock_alloc(len)) == NULL)
@@ -806,8 +831,46 @@ rtsock_setsockopt(struct sock * sock, int level, int name,
 	const struct sockdriver_data * data, socklen_t len)
 {
 	struct rtsock *rt = (struct rtsock *)sock;
+	uint8_t types[RT_MSGFILTER_BYTES * NBBY];
+	unsigned int i;
 	int r, val;
 
+	if (level == AF_ROUTE) {
+		switch (name) {
+		case RO_MSGFILTER:
+			/*
+			 * The option value is an array of message types (RTM_)
+			 * that are to be delivered to this socket.  An empty
+			 * array restores delivery of all messages.  As in
+			 * NetBSD, replies to this socket's own requests are
+			 * always delivered, regardless of any filter.
+			 */
+			if (len > sizeof(types))
+				return EINVAL;
+
+			if ((r = sockdriver_copyin(data, 0, types,
+			    len)) != OK)
+				return r;
+
+			memset(rt->rt_msgfilter, 0, sizeof(rt->rt_msgfilter));
+
+			if (len == 0) {
+				rt->rt_flags &= ~RTF_MSGFILTER;
+
+				return OK;
+			}
+
+			for (i = 0; i < (unsigned int)len; i++)
+				RT_MSGFILTER_SET(rt, types[i]);
+
+			rt->rt_flags |= RTF_MSGFILTER;
+
+			return OK;
+		}
+
+		return ENOPROTOOPT;
+	}
+
 	if (level == SOL_SOCKET) {
 		switch (name) {
 		case SO_USELOOPBACK:
@@ -847,8 +910,32 @@ rtsock_getsockopt(struct sock * sock, int level, int name,
 	const struct sockdriver_data * data, socklen_t * len)
 {
 	struct rtsock *rt = (struct rtsock *)sock;
+	uint8_t types[RT_MSGFILTER_BYTES * NBBY];
+	unsigned int i, count;
 	int val;
 
+	if (level == AF_ROUTE) {
+		switch (name) {
+		case RO_MSGFILTER:
+			/*
+			 * Reconstruct an array of message types from the
+			 * filter bitmap.  The original order of the types as
+			 * set is not retained, but that should not matter.
+			 */
+			count = 0;
+
+			if (rt->rt_flags & RTF_MSGFILTER) {
+				for (i = 0; i < __arraycount(types); i++)
+					if (RT_MSGFILTER_ISSET(rt, i))
+						types[count++] = i;
+			}
+
+			return sockdriver_copyout_opt(data, types, count, len);
+		}
+
+		return ENOPROTOOPT;
+	}
+
 	if (level == SOL_SOCKET) {
 		switch (name) {
 		case SO_USELOOPBACK:
@@ -961,7 +1048,8 @@ rtsock_msg_ifannounce(struct ifdev * ifdev, int arrival)
 	struct if_announcemsghdr ifan;
 	struct pbuf *pbuf;
 
-	if (!rtsock_msg_match(NULL /*rtsrc*/, AF_UNSPEC, NULL /*pbuf*/))
+	if (!rtsock_msg_match(NULL /*rtsrc*/, RTM_IFANNOUNCE, AF_UNSPEC,
+	    NULL /*pbuf*/))
 		return;
 
 	memset(&ifan, 0, sizeof(ifan));
@@ -976,7 +1064,7 @@ rtsock_msg_ifannounce(struct ifdev * ifdev, int arrival)
 		return;
 	memcpy(pbuf->payload, &ifan, sizeof(ifan));
 
-	rtsock_msg_match(NULL /*rtsrc*/, AF_UNSPEC, pbuf);
+	rtsock_msg_match(NULL /*rtsrc*/, RTM_IFANNOUNCE, AF_UNSPEC, pbuf);
 }
 
 /*
@@ -988,7 +1076,8 @@ rtsock_msg_ifinfo(struct ifdev * ifdev)
 	struct if_msghdr ifm;
 	struct pbuf *pbuf;
 
-	if (!rtsock_msg_match(NULL /*rtsrc*/, AF_UNSPEC, NULL /*pbuf*/))
+	if (!rtsock_msg_match(NULL /*rtsrc*/, RTM_IFINFO, AF_UNSPEC,
+	    NULL /*pbuf*/))
 		return;
 
 	memset(&ifm, 0, sizeof(ifm));
@@ -1004,7 +1093,7 @@ rtsock_msg_ifinfo(struct ifdev * ifdev)
 		return;
 	memcpy(pbuf->payload, &ifm, sizeof(ifm));
 
-	rtsock_msg_match(NULL /*rtsrc*/, AF_UNSPEC, pbuf);
+	rtsock_msg_match(NULL /*rtsrc*/, RTM_IFINFO, AF_UNSPEC, pbuf);
 }
 
 /*
@@ -1063,7 +1152,7 @@ rtsock_msg_addr_dl(struct ifdev * ifdev, unsigned int type,
 	struct sockaddr_dlx name, addr;
 	struct pbuf *pbuf;
 
-	if (!rtsock_msg_match(NULL /*rtsrc*/, AF_LINK, NULL /*pbuf*/))
+	if (!rtsock_msg_match(NULL /*rtsrc*/, type, AF_LINK, NULL /*pbuf*/))
 		return;
 
 	rtsock_rta_init_ifam(&rta, &ifam, ifdev, type, &name);
@@ -1072,7 +1161,7 @@ rtsock_msg_addr_dl(struct ifdev * ifdev, unsigned int type,
 
 	if (rtsock_rta_finalize(&ifam, sizeof(ifam), &ifam.ifam_msglen,
 	    &ifam.ifam_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_match(NULL /*rtsrc*/, AF_LINK, pbuf);
+		rtsock_msg_match(NULL /*rtsrc*/, type, AF_LINK, pbuf);
 }
 
 /*
@@ -1115,7 +1204,7 @@ rtsock_msg_addr_v4(struct ifdev * ifdev, unsigned int type,
 	struct sockaddr_in sin[4];
 	struct pbuf *pbuf;
 
-	if (!rtsock_msg_match(NULL /*rtsrc*/, AF_INET, NULL /*pbuf*/))
+	if (!rtsock_msg_match(NULL /*rtsrc*/, type, AF_INET, NULL /*pbuf*/))
 		return;
 
 	rtsock_rta_init_ifam(&rta, &ifam, ifdev, type, &name);
@@ -1124,7 +1213,7 @@ rtsock_msg_addr_v4(struct ifdev * ifdev, unsigned int type,
 
 	if (rtsock_rta_finalize(&ifam, sizeof(ifam), &ifam.ifam_msglen,
 	    &ifam.ifam_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_match(NULL /*rtsrc*/, AF_INET, pbuf);
+		rtsock_msg_match(NULL /*rtsrc*/, type, AF_INET, pbuf);
 }
 
 /*
@@ -1165,7 +1254,7 @@ rtsock_msg_addr_v6(struct ifdev * ifdev, unsigned int type,
 	struct sockaddr_in6 sin6[3];
 	struct pbuf *pbuf;
 
-	if (!rtsock_msg_match(NULL /*rtsrc*/, AF_INET6, NULL /*pbuf*/))
+	if (!rtsock_msg_match(NULL /*rtsrc*/, type, AF_INET6, NULL /*pbuf*/))
 		return;
 
 	rtsock_rta_init_ifam(&rta, &ifam, ifdev, type, &name);
@@ -1174,7 +1263,7 @@ rtsock_msg_addr_v6(struct ifdev * ifdev, unsigned int type,
 
 	if (rtsock_rta_finalize(&ifam, sizeof(ifam), &ifam.ifam_msglen,
 	    &ifam.ifam_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_match(NULL /*rtsrc*/, AF_INET6, pbuf);
+		rtsock_msg_match(NULL /*rtsrc*/, type, AF_INET6, pbuf);
 }
 
 /*
@@ -1194,7 +1283,8 @@ rtsock_msg_miss(const struct sockaddr * addr)
 	 * 'addr'), which is a big part of the work.  Still, skip the rest if
 	 * there is no routing socket to deliver the message to.
 	 */
-	if (!rtsock_msg_match(NULL /*rtsrc*/, addr->sa_family, NULL /*pbuf*/))
+	if (!rtsock_msg_match(NULL /*rtsrc*/, RTM_MISS, addr->sa_family,
+	    NULL /*pbuf*/))
 		return;
 
 	memset(&rtm, 0, sizeof(rtm));
@@ -1207,7 +1297,8 @@ rtsock_msg_miss(const struct sockaddr * addr)
 
 	if (rtsock_rta_finalize(&rtm, sizeof(rtm), &rtm.rtm_msglen,
 	    &rtm.rtm_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_match(NULL /*rtsrc*/, addr->sa_family, pbuf);
+		rtsock_msg_match(NULL /*rtsrc*/, RTM_MISS, addr->sa_family,
+		    pbuf);
 }
 
 /*
@@ -1279,7 +1370,7 @@ rtsock_msg_route(const struct route_entry * route, unsigned int type,
 	rtsrc = (rtr != NULL) ? rtr->rtr_src : NULL;
 	family = (route_is_ipv6(route)) ? AF_INET6 : AF_INET;
 
-	if (!rtsock_msg_match(rtsrc, family, NULL /*pbuf*/))
+	if (!rtsock_msg_match(rtsrc, type, family, NULL /*pbuf*/))
 		return;
 
 	getif = (rtr != NULL && rtr->rtr_getif);
@@ -1295,7 +1386,7 @@ rtsock_msg_route(const struct route_entry * route, unsigned int type,
 
 	if (rtsock_rta_finalize(&rtm, sizeof(rtm), &rtm.rtm_msglen,
 	    &rtm.rtm_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_match(rtsrc, family, pbuf);
+		rtsock_msg_match(rtsrc, type, family, pbuf);
 }
 
 /*
@@ -1436,7 +1527,7 @@ rtsock_msg_arp(lldata_arp_num_t num, unsigned int type,
 	 * previously unreported entries), send these routing messages to the
 	 * source of the routing request only.
 	 */
-	if (!rtsock_msg_one(rtr->rtr_src, AF_INET, NULL /*pbuf*/))
+	if (!rtsock_msg_one(rtr->rtr_src, type, AF_INET, NULL /*pbuf*/))
 		return;
 
 	rtsock_get_arp(&rtm, &rta, &addr, &gateway, num, type);
@@ -1449,7 +1540,7 @@ rtsock_msg_arp(lldata_arp_num_t num, unsigned int type,
 
 	if (rtsock_rta_finalize(&rtm, sizeof(rtm), &rtm.rtm_msglen,
 	    &rtm.rtm_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_one(rtr->rtr_src, AF_INET, pbuf);
+		rtsock_msg_one(rtr->rtr_src, type, AF_INET, pbuf);
 }
 
 /*
@@ -1548,7 +1639,7 @@ rtsock_msg_ndp(lldata_ndp_num_t num, unsigned int type,
 	 * previously unreported entries), send these routing messages to the
 	 * source of the routing request only.
 	 */
-	if (!rtsock_msg_one(rtr->rtr_src, AF_INET6, NULL /*pbuf*/))
+	if (!rtsock_msg_one(rtr->rtr_src, type, AF_INET6, NULL /*pbuf*/))
 		return;
 
 	rtsock_get_ndp(&rtm, &rta, &addr, &gateway, num, type);
@@ -1561,7 +1652,7 @@ rtsock_msg_ndp(lldata_ndp_num_t num, unsigned int type,
 
 	if (rtsock_rta_finalize(&rtm, sizeof(rtm), &rtm.rtm_msglen,
 	    &rtm.rtm_addrs, &rta, &pbuf, NULL, 0) > 0)
-		rtsock_msg_one(rtr->rtr_src, AF_INET6, pbuf);
+		rtsock_msg_one(rtr->rtr_src, type, AF_INET6, pbuf);
 }
 
 /*
@@ -8,6 +8,16 @@
  * Ideally, the secret should remain the same across system reboots; it is left
  * up to userland to take care of that.
  *
+ * In order to keep the per-connection cost low, the secret is hashed into the
+ * SHA256 state ahead of time, whenever it is set.  Establishing a connection
+ * then resumes from a copy of that precomputed intermediate state, and only
+ * has to hash the TCP 4-tuple of the new connection.  Since the 4-tuple and
+ * the final SHA256 padding together fit in a single hash input block, each
+ * generated ISN costs one SHA256 block transform rather than two, on top of
+ * skipping rehashing of the secret itself.  The ISN offsets themselves cannot
+ * be pooled up in advance: each offset depends on the connection's 4-tuple,
+ * which is the whole point of the algorithm.
+ *
  * TODO: while this module provides the strongest possible implementation of
  * the algorithm, it is also quite heavyweight.  We should consider allowing
  * for a more configurable level of strength, perhaps with the possibility for
@@ -20,27 +30,49 @@
 #include <sys/sha2.h>
 
 /*
- * The TCP ISN hash input consists of the TCP 4-tuple of the new connection and
- * a static secret.  The 4-tuple consists of two IP addresses, at most 16 bytes
- * (128 bits, for IPv6) each, and two port numbers, two bytes (16 bits) each.
- * We use the SHA256 input block size of 64 bytes to avoid copying, so that
- * leaves us with 28 bytes of room for the static secret.  We use 16 bytes, and
- * leave the rest blank.  As a sidenote, while hardcoding sizes is not nice, we
- * really need to get the layout exactly right in this case.
+ * The TCP ISN hash input consists of a static secret and the TCP 4-tuple of
+ * the new connection.  The secret is hashed as a full separate input block,
+ * allowing the resulting intermediate state to be precomputed.  The 4-tuple
+ * consists of two IP addresses, at most 16 bytes (128 bits, for IPv6) each,
+ * and two port numbers, two bytes (16 bits) each.  The 4-tuple must leave
+ * enough room in its hash input block for the SHA256 padding, so that the
+ * final hash computation takes no more than one block transform.  As a
+ * sidenote, while hardcoding sizes is not nice, we really need to get the
+ * layout exactly right in this case.
  */
 #define TCPISN_TUPLE_LENGTH	(16 * 2 + 2 * 2)
 
-#if TCPISN_SECRET_LENGTH > (SHA256_BLOCK_LENGTH - TCPISN_TUPLE_LENGTH)
-#error "TCP ISN secret length exceeds remainder of hash block"
+#if TCPISN_SECRET_LENGTH > SHA256_BLOCK_LENGTH
+#error "TCP ISN secret length exceeds hash block length"
+#endif
+
+#if TCPISN_TUPLE_LENGTH > (SHA256_BLOCK_LENGTH - 8 - 1)
+#error "TCP ISN tuple length leaves no room for hash padding"
 #endif
 
 /* We are using memchr() on this, so do not remove the '32' size here! */
 static const uint8_t tcpisn_hextab[32] = "0123456789abcdef0123456789ABCDEF";
 
-static uint8_t tcpisn_input[SHA256_BLOCK_LENGTH] __aligned(4);
+static uint8_t tcpisn_secret_block[SHA256_BLOCK_LENGTH] __aligned(4);
+
+static SHA256_CTX tcpisn_secret_ctx;
 
 static int tcpisn_set;
 
+/*
+ * Precompute the intermediate hash state resulting from the first input
+ * block, which contains the current ISN secret and padding only.  The result
+ * is used as the starting state for each subsequently generated ISN.
+ */
+static void
+tcpisn_precompute(void)
+{
+
+	SHA256_Init(&tcpisn_secret_ctx);
+	SHA256_Update(&tcpisn_secret_ctx, tcpisn_secret_block,
+	    sizeof(tcpisn_secret_block));
+}
+
 /*
  * Initialize the TCP ISN module.
  */
@@ -50,20 +82,21 @@ tcpisn_init(void)
 	time_t boottime;
 
 	/*
-	 * Part of the input to the hash function is kept as is between calls
-	 * to the TCP ISN hook.  In particular, we zero the entire input here,
-	 * so that the padding is zero.  We also zero the area where the secret
-	 * will be stored, but we put in the system boot time as a last effort
-	 * to try to create at least some minimal amount of unpredictability.
-	 * The boot time is by no means sufficient though, so issue a warning
-	 * if a TCP ISN is requested before an actual secret is set.  Note that
-	 * an actual secret will overwrite the boot time based pseudo-secret.
+	 * The secret input block is kept as is between calls to the TCP ISN
+	 * hook.  In particular, we zero the entire block here, so that the
+	 * padding is zero.  We also zero the area where the secret will be
+	 * stored, but we put in the system boot time as a last effort to try
+	 * to create at least some minimal amount of unpredictability.  The
+	 * boot time is by no means sufficient though, so issue a warning if a
+	 * TCP ISN is requested before an actual secret is set.  Note that an
+	 * actual secret will overwrite the boot time based pseudo-secret.
 	 */
-	memset(tcpisn_input, 0, sizeof(tcpisn_input));
+	memset(tcpisn_secret_block, 0, sizeof(tcpisn_secret_block));
 
 	(void)getuptime(NULL, NULL, &boottime);
-	memcpy(&tcpisn_input[TCPISN_TUPLE_LENGTH], &boottime,
-	    sizeof(boottime));
+	memcpy(tcpisn_secret_block, &boottime, sizeof(boottime));
+
+	tcpisn_precompute();
 
 	tcpisn_set = FALSE;
 }
@@ -84,7 +117,7 @@ tcpisn_secret(struct rmib_call * call __unused,
 	/* First copy out the old (current) ISN secret. */
 	if (oldp != NULL) {
 		for (i = 0; i < TCPISN_SECRET_LENGTH; i++) {
-			byte = tcpisn_input[TCPISN_TUPLE_LENGTH + i];
+			byte = tcpisn_secret_block[i];
 			secret[i * 2] = tcpisn_hextab[byte >> 4];
 			secret[i * 2 + 1] = tcpisn_hextab[byte & 0xf];
 		}
@@ -119,8 +152,9 @@ tcpisn_secret(struct rmib_call * call __unused,
 		}
 
 		/* Once fully validated, switch to the new secret. */
-		memcpy(&tcpisn_input[TCPISN_TUPLE_LENGTH], secret,
-		    TCPISN_SECRET_LENGTH);
+		memcpy(tcpisn_secret_block, secret, TCPISN_SECRET_LENGTH);
+
+		tcpisn_precompute();
 
 		tcpisn_set = TRUE;
 	}
@@ -136,6 +170,7 @@ uint32_t
 lwip_hook_tcp_isn(const ip_addr_t * local_ip, uint16_t local_port,
 	const ip_addr_t * remote_ip, uint16_t remote_port)
 {
+	uint8_t input[TCPISN_TUPLE_LENGTH] __aligned(4);
 	uint8_t output[SHA256_DIGEST_LENGTH] __aligned(4);
 	SHA256_CTX ctx;
 	clock_t realtime;
@@ -151,8 +186,8 @@ lwip_hook_tcp_isn(const ip_addr_t * local_ip, uint16_t local_port,
 	if (IP_IS_V6(local_ip)) {
 		assert(IP_IS_V6(remote_ip));
 
-		memcpy(&tcpisn_input[0], &ip_2_ip6(local_ip)->addr, 16);
-		memcpy(&tcpisn_input[16], &ip_2_ip6(remote_ip)->addr, 16);
+		memcpy(&input[0], &ip_2_ip6(local_ip)->addr, 16);
+		memcpy(&input[16], &ip_2_ip6(remote_ip)->addr, 16);
 	} else {
 		assert(IP_IS_V4(local_ip));
 		assert(IP_IS_V4(remote_ip));
@@ -164,25 +199,24 @@ lwip_hook_tcp_isn(const ip_addr_t * local_ip, uint16_t local_port,
 		 * no potential abuse of IPv6 addresses in order to predict
 		 * ISNs for IPv4 connections.
 		 */
-		memset(&tcpisn_input[0], 0, 10);
-		tcpisn_input[10] = 0xff;
-		tcpisn_input[11] = 0xff;
-		memcpy(&tcpisn_input[12], &ip_2_ip4(local_ip)->addr, 4);
-		memset(&tcpisn_input[16], 0, 10);
-		tcpisn_input[26] = 0xff;
-		tcpisn_input[27] = 0xff;
-		memcpy(&tcpisn_input[28], &ip_2_ip4(local_ip)->addr, 4);
+		memset(&input[0], 0, 10);
+		input[10] = 0xff;
+		input[11] = 0xff;
+		memcpy(&input[12], &ip_2_ip4(local_ip)->addr, 4);
+		memset(&input[16], 0, 10);
+		input[26] = 0xff;
+		input[27] = 0xff;
+		memcpy(&input[28], &ip_2_ip4(remote_ip)->addr, 4);
 	}
 
-	tcpisn_input[32] = local_port >> 8;
-	tcpisn_input[33] = local_port & 0xff;
-	tcpisn_input[34] = remote_port >> 8;
-	tcpisn_input[35] = remote_port & 0xff;
-
-	/* The rest of the input (secret and padding) is already filled in. */
+	input[32] = local_port >> 8;
+	input[33] = local_port & 0xff;
+	input[34] = remote_port >> 8;
+	input[35] = remote_port & 0xff;
 
-	SHA256_Init(&ctx); /* this call zeroes a buffer we don't use.. */
-	SHA256_Update(&ctx, tcpisn_input, sizeof(tcpisn_input));
+	/* The secret has already been hashed into the precomputed state. */
+	memcpy(&ctx, &tcpisn_secret_ctx, sizeof(ctx));
+	SHA256_Update(&ctx, input, sizeof(input));
 	SHA256_Final(output, &ctx);
 
 	/* Arbitrarily take the first 32 bits from the generated hash. */
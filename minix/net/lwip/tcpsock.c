@@ -100,6 +100,21 @@ static const unsigned int NETBSD_TF_NODELAY = TF_NODELAY;
  */
 #define TCP_MAX_SENDBUFS	(mempool_max_buffers() * 3 / 4)
 
+/*
+ * Buffer size auto-tuning.  Unless the user has fixed a socket's buffer size
+ * explicitly with SO_SNDBUF or SO_RCVBUF, we adjust the socket's buffer size
+ * limits dynamically within their default-to-maximum range: a connection's
+ * send buffer is grown when it fills up while the peer's advertised window
+ * suggests that the connection could have more data in flight, and its
+ * receive buffer is grown when the enqueued data would otherwise force us to
+ * reduce the receive window.  Since the buffer sizes are mere limits on the
+ * number of enqueued bytes, with actual memory allocated on demand only,
+ * idle connections with grown buffers cost nothing; still, when the buffer
+ * pool runs low, we shrink the buffers of connections with empty queues back
+ * to the default size, and stop growing buffers altogether.
+ */
+#define TCP_LOWMEM_RATIO	3 / 4	/* pool usage deemed "running low" */
+
 /* Polling intervals, in 500-millsecond units. */
 #define TCP_POLL_REG_INTERVAL	10	/* interval for reattempting sends */
 #define TCP_POLL_CLOSE_INTERVAL	1	/* interval while closing connection */
@@ -771,6 +786,80 @@ tcpsock_pcb_send(struct tcpsock * tcp, int raise_error)
 		return OK;
 }
 
+/*
+ * Check whether the buffer pool is running low.  If it is, we stop growing
+ * socket buffers, and shrink the buffers of sockets with empty queues back to
+ * their default size.
+ */
+static int
+tcpsock_low_on_bufs(void)
+{
+
+	return (mempool_cur_buffers() >= mempool_max_buffers() *
+	    TCP_LOWMEM_RATIO);
+}
+
+/*
+ * Attempt to grow the send buffer size of the given TCP socket, in response
+ * to finding its send queue full.  The buffer is grown only if its size has
+ * not been fixed by the user, the peer's advertised window exceeds the
+ * current buffer size--meaning that the connection could have more data in
+ * flight if only we could enqueue more--and the buffer pool is not running
+ * low.  Note that without TCP window scaling, advertised windows cannot
+ * exceed 64KB, which effectively also bounds the growth applied here.
+ */
+static void
+tcpsock_grow_sndbuf(struct tcpsock * tcp)
+{
+	size_t sndbuf;
+
+	assert(tcp->tcp_pcb != NULL);
+
+	sndbuf = tcpsock_get_sndbuf(tcp);
+
+	if ((tcpsock_get_flags(tcp) & IPF_SNDBUF_SET) ||
+	    sndbuf >= TCP_SNDBUF_MAX)
+		return;
+
+	if ((size_t)tcp->tcp_pcb->snd_wnd <= sndbuf)
+		return;
+
+	if (tcpsock_low_on_bufs())
+		return;
+
+	if ((sndbuf *= 2) > TCP_SNDBUF_MAX)
+		sndbuf = TCP_SNDBUF_MAX;
+
+	ipsock_set_sndbuf(tcpsock_get_ipsock(tcp), sndbuf);
+}
+
+/*
+ * Attempt to grow the receive buffer size of the given TCP socket, in
+ * response to finding that the amount of enqueued data no longer allows the
+ * receive window to be kept fully open.  The buffer is grown only if its
+ * size has not been fixed by the user and the buffer pool is not running
+ * low.
+ */
+static void
+tcpsock_grow_rcvbuf(struct tcpsock * tcp)
+{
+	size_t rcvbuf;
+
+	rcvbuf = tcpsock_get_rcvbuf(tcp);
+
+	if ((tcpsock_get_flags(tcp) & IPF_RCVBUF_SET) ||
+	    rcvbuf >= TCP_RCVBUF_MAX)
+		return;
+
+	if (tcpsock_low_on_bufs())
+		return;
+
+	if ((rcvbuf *= 2) > TCP_RCVBUF_MAX)
+		rcvbuf = TCP_RCVBUF_MAX;
+
+	ipsock_set_rcvbuf(tcpsock_get_ipsock(tcp), rcvbuf);
+}
+
 /*
  * Callback from lwIP.  The given number of data bytes have been acknowledged
  * as received by the remote end.  Dequeue and free data from the TCP socket's
@@ -835,6 +924,17 @@ tcpsock_event_sent(void * arg, struct tcp_pcb * pcb __unused, uint16_t len)
 		assert(tcp->tcp_snd.ts_len == 0);
 		assert(tcp->tcp_snd.ts_unsent == NULL);
 		tcp->tcp_snd.ts_tail = NULL;
+
+		/*
+		 * The connection no longer has data in transit.  If the
+		 * buffer pool is running low, shrink an auto-tuned send
+		 * buffer back to the default size.
+		 */
+		if (!(tcpsock_get_flags(tcp) & IPF_SNDBUF_SET) &&
+		    tcpsock_get_sndbuf(tcp) > TCP_SNDBUF_DEF &&
+		    tcpsock_low_on_bufs())
+			ipsock_set_sndbuf(tcpsock_get_ipsock(tcp),
+			    TCP_SNDBUF_DEF);
 	} else
 		assert(tcp->tcp_snd.ts_len > 0);
 
@@ -869,6 +969,27 @@ tcpsock_event_sent(void * arg, struct tcp_pcb * pcb __unused, uint16_t len)
 	return ERR_OK;
 }
 
+/*
+ * Measurement wrapper around the "sent" event callback.  The cycles spent
+ * processing the event are attributed to the TCP layer through the perfstat
+ * module.  This wrapper, rather than tcpsock_event_sent() itself, is
+ * registered with lwIP as the event callback.
+ */
+static err_t
+tcpsock_event_sent_timed(void * arg, struct tcp_pcb * pcb, uint16_t len)
+{
+	uint64_t tsc;
+	err_t err;
+
+	tsc = perfstat_enter();
+
+	err = tcpsock_event_sent(arg, pcb, len);
+
+	perfstat_leave(&perfstat_tcp_sent, tsc, len);
+
+	return err;
+}
+
 /*
  * Check whether any (additional) data previously received on a TCP socket
  * should be acknowledged, possibly allowing the remote end to send additional
@@ -890,6 +1011,17 @@ tcpsock_ack_recv(struct tcpsock * tcp)
 	 */
 	rcvbuf = tcpsock_get_rcvbuf(tcp);
 
+	/*
+	 * If the queued data would force us to reduce the receive window,
+	 * the socket's receive buffer size is the bottleneck for this
+	 * connection: attempt to grow it now.
+	 */
+	if (rcvbuf < tcp->tcp_rcv.tr_len + TCP_WND) {
+		tcpsock_grow_rcvbuf(tcp);
+
+		rcvbuf = tcpsock_get_rcvbuf(tcp);
+	}
+
 	if (rcvbuf > tcp->tcp_rcv.tr_len && tcp->tcp_rcv.tr_unacked > 0) {
 		/*
 		 * The number of bytes that lwIP can still give us at any time
@@ -1041,6 +1173,17 @@ tcpsock_event_recv(void * arg, struct tcp_pcb * pcb __unused,
 		if (!tcpsock_is_shutdown(tcp, SFL_SHUT_RD))
 			sockevent_raise(tcpsock_get_sock(tcp), SEV_RECV);
 
+		/*
+		 * If this connection is pending acceptance on a listening
+		 * socket that defers accepts, the FIN makes the connection
+		 * acceptable: no data will ever arrive on it anymore.
+		 */
+		if (tcp->tcp_listener != NULL &&
+		    (tcpsock_get_flags(tcp->tcp_listener) &
+		    TCPF_DEFER_ACCEPT))
+			sockevent_raise(tcpsock_get_sock(tcp->tcp_listener),
+			    SEV_ACCEPT);
+
 		/*
 		 * If we were in the process of closing the socket, and we
 		 * receive a FIN before our FIN got acknowledged, we close the
@@ -1176,9 +1319,44 @@ tcpsock_event_recv(void * arg, struct tcp_pcb * pcb __unused,
 	/* Also wake up any receivers now. */
 	sockevent_raise(tcpsock_get_sock(tcp), SEV_RECV);
 
+	/*
+	 * If this connection is pending acceptance on a listening socket that
+	 * defers accepts, the arrival of data makes the connection acceptable
+	 * now; see tcpsock_may_accept().
+	 */
+	if (tcp->tcp_listener != NULL &&
+	    (tcpsock_get_flags(tcp->tcp_listener) & TCPF_DEFER_ACCEPT))
+		sockevent_raise(tcpsock_get_sock(tcp->tcp_listener),
+		    SEV_ACCEPT);
+
 	return ERR_OK;
 }
 
+/*
+ * Measurement wrapper around the "recv" event callback.  The cycles spent
+ * processing the event are attributed to the TCP layer through the perfstat
+ * module.  This wrapper, rather than tcpsock_event_recv() itself, is
+ * registered with lwIP as the event callback.
+ */
+static err_t
+tcpsock_event_recv_timed(void * arg, struct tcp_pcb * pcb, struct pbuf * pbuf,
+	err_t err)
+{
+	uint64_t tsc;
+	size_t len;
+
+	/* The callback may free the buffer, so get its size in advance. */
+	len = (pbuf != NULL) ? pbuf->tot_len : 0;
+
+	tsc = perfstat_enter();
+
+	err = tcpsock_event_recv(arg, pcb, pbuf, err);
+
+	perfstat_leave(&perfstat_tcp_recv, tsc, len);
+
+	return err;
+}
+
 /*
  * Callback from lwIP.  The PCB corresponding to the socket identified by 'arg'
  * has been closed by lwIP, with the reason specified in 'err': either the
@@ -1372,6 +1550,26 @@ tcpsock_bind(struct sock * sock, const struct sockaddr * addr,
 	return util_convert_err(err);
 }
 
+/*
+ * Check whether the connection 'tcp', pending on the accept queue of the
+ * listening socket 'listener', may be handed out to userland.  Normally, any
+ * queued connection may be accepted right away.  With TCP_DEFER_ACCEPT
+ * enabled on the listening socket, a pending connection is handed out only
+ * once it has received data, or a FIN, from its peer.
+ */
+static int
+tcpsock_may_accept(struct tcpsock * listener, struct tcpsock * tcp)
+{
+
+	assert(tcp->tcp_listener == listener);
+
+	if (!(tcpsock_get_flags(listener) & TCPF_DEFER_ACCEPT))
+		return TRUE;
+
+	return (tcp->tcp_rcv.tr_len > 0 ||
+	    (tcpsock_get_flags(tcp) & TCPF_RCVD_FIN));
+}
+
 /*
  * Callback from lwIP.  A new connection 'pcb' has arrived on the listening
  * socket identified by 'arg'.  Note that 'pcb' may be NULL in the case that
@@ -1414,12 +1612,18 @@ tcpsock_event_accept(void * arg, struct tcp_pcb * pcb, err_t err)
 	tcp_backlog_delayed(pcb);
 
 	/* Set the callback functions. */
-	tcp_recv(pcb, tcpsock_event_recv);
-	tcp_sent(pcb, tcpsock_event_sent);
+	tcp_recv(pcb, tcpsock_event_recv_timed);
+	tcp_sent(pcb, tcpsock_event_sent_timed);
 	tcp_err(pcb, tcpsock_event_err);
 	tcp_poll(pcb, tcpsock_event_poll, TCP_POLL_REG_INTERVAL);
 
-	sockevent_raise(tcpsock_get_sock(tcp), SEV_ACCEPT);
+	/*
+	 * Wake up blocked accept calls, unless accepts on this listening
+	 * socket are deferred until data arrives on the new connection, in
+	 * which case tcpsock_event_recv() will generate the event later.
+	 */
+	if (!(tcpsock_get_flags(tcp) & TCPF_DEFER_ACCEPT))
+		sockevent_raise(tcpsock_get_sock(tcp), SEV_ACCEPT);
 
 	return ERR_OK;
 }
@@ -1593,8 +1797,8 @@ tcpsock_connect(struct sock * sock, const struct sockaddr * addr,
 		return util_convert_err(err);
 
 	/* Set the other callback functions. */
-	tcp_recv(tcp->tcp_pcb, tcpsock_event_recv);
-	tcp_sent(tcp->tcp_pcb, tcpsock_event_sent);
+	tcp_recv(tcp->tcp_pcb, tcpsock_event_recv_timed);
+	tcp_sent(tcp->tcp_pcb, tcpsock_event_sent_timed);
 	tcp_err(tcp->tcp_pcb, tcpsock_event_err);
 	tcp_poll(tcp->tcp_pcb, tcpsock_event_poll, TCP_POLL_REG_INTERVAL);
 
@@ -1614,14 +1818,16 @@ static int
 tcpsock_test_accept(struct sock * sock)
 {
 	struct tcpsock *tcp = (struct tcpsock *)sock;
+	struct tcpsock *queued;
 
 	/* Is this socket in listening mode at all? */
 	if (!tcpsock_is_listening(tcp))
 		return EINVAL;
 
 	/* Are there any connections to accept right now? */
-	if (!TAILQ_EMPTY(&tcp->tcp_queue.tq_head))
-		return OK;
+	TAILQ_FOREACH(queued, &tcp->tcp_queue.tq_head, tcp_queue.tq_next)
+		if (tcpsock_may_accept(tcp, queued))
+			return OK;
 
 	/* If the socket has been shut down, we return ECONNABORTED. */
 	if (tcp->tcp_pcb == NULL)
@@ -1647,8 +1853,15 @@ tcpsock_accept(struct sock * sock, struct sockaddr * addr,
 		return r;
 	/* Below, we must not assume that the listener has a PCB. */
 
-	tcp = TAILQ_FIRST(&listener->tcp_queue.tq_head);
-	assert(tcp->tcp_listener == listener);
+	/*
+	 * Take the first acceptable connection off the queue.  Without
+	 * TCP_DEFER_ACCEPT, that is simply the head of the queue; with it,
+	 * connections still waiting for data are skipped over.
+	 */
+	TAILQ_FOREACH(tcp, &listener->tcp_queue.tq_head, tcp_queue.tq_next)
+		if (tcpsock_may_accept(listener, tcp))
+			break;
+	assert(tcp != NULL);
 	assert(tcp->tcp_pcb != NULL);
 
 	TAILQ_REMOVE(&listener->tcp_queue.tq_head, tcp, tcp_queue.tq_next);
@@ -1718,10 +1931,20 @@ tcpsock_test_send(struct sock * sock, size_t min)
 	if (min > sndbuf)
 		min = sndbuf;
 
-	if (tcp->tcp_snd.ts_len + min > sndbuf)
-		return SUSPEND;
-	else
-		return OK;
+	if (tcp->tcp_snd.ts_len + min > sndbuf) {
+		/*
+		 * The send queue is full.  If the connection could have more
+		 * data in flight, the socket's send buffer size is the
+		 * bottleneck: attempt to grow it now, which may allow the
+		 * caller to proceed right away after all.
+		 */
+		tcpsock_grow_sndbuf(tcp);
+
+		if (tcp->tcp_snd.ts_len + min > tcpsock_get_sndbuf(tcp))
+			return SUSPEND;
+	}
+
+	return OK;
 }
 
 /*
@@ -2058,6 +2281,17 @@ tcpsock_recv(struct sock * sock, const struct sockdriver_data * data,
 		} else {
 			assert(tcp->tcp_rcv.tr_pre_tailp == NULL);
 			assert(tcp->tcp_rcv.tr_len == 0);
+
+			/*
+			 * The receive queue is now empty.  If the buffer pool
+			 * is running low, shrink an auto-tuned receive buffer
+			 * back to the default size.
+			 */
+			if (!(tcpsock_get_flags(tcp) & IPF_RCVBUF_SET) &&
+			    tcpsock_get_rcvbuf(tcp) > TCP_RCVBUF_DEF &&
+			    tcpsock_low_on_bufs())
+				ipsock_set_rcvbuf(tcpsock_get_ipsock(tcp),
+				    TCP_RCVBUF_DEF);
 		}
 
 		/*
@@ -2237,6 +2471,37 @@ tcpsock_setsockopt(struct sock * sock, int level, int name,
 			tcp->tcp_pcb->keep_cnt = (uint32_t)val;
 
 			return OK;
+
+		case TCP_DEFER_ACCEPT:
+			/*
+			 * Hand out pending connections only once data has
+			 * arrived on them; see tcpsock_may_accept().  The
+			 * option is a boolean toggle here, and connections
+			 * are deferred indefinitely, unlike on Linux where
+			 * the option value is a timeout in seconds.  The
+			 * option is stored on the socket object rather than
+			 * the PCB, so that it can be set both before and
+			 * after the listen call.
+			 */
+			if ((r = sockdriver_copyin_opt(data, &val, sizeof(val),
+			    len)) != OK)
+				return r;
+
+			if (val)
+				tcpsock_set_flag(tcp, TCPF_DEFER_ACCEPT);
+			else
+				tcpsock_clear_flag(tcp, TCPF_DEFER_ACCEPT);
+
+			/*
+			 * Disabling the option may make previously deferred
+			 * connections acceptable right away.
+			 */
+			if (!val && tcpsock_is_listening(tcp) &&
+			    !TAILQ_EMPTY(&tcp->tcp_queue.tq_head))
+				sockevent_raise(tcpsock_get_sock(tcp),
+				    SEV_ACCEPT);
+
+			return OK;
 		}
 
 		return EOPNOTSUPP;
@@ -2327,6 +2592,12 @@ tcpsock_getsockopt(struct sock * sock, int level, int name,
 
 			val = (int)tcp->tcp_pcb->keep_cnt;
 
+			return sockdriver_copyout_opt(data, &val, sizeof(val),
+			    len);
+
+		case TCP_DEFER_ACCEPT:
+			val = !!(tcpsock_get_flags(tcp) & TCPF_DEFER_ACCEPT);
+
 			return sockdriver_copyout_opt(data, &val, sizeof(val),
 			    len);
 		}
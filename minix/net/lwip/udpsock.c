@@ -9,6 +9,7 @@
 #include <netinet/udp.h>
 #include <netinet/ip_var.h>
 #include <netinet/udp_var.h>
+#include <netinet6/udp6_var.h>
 
 /* The number of UDP sockets.  Inherited from the lwIP configuration. */
 #define NR_UDPSOCK	MEMP_NUM_UDP_PCB
@@ -49,9 +50,21 @@ static const struct sockevent_ops udpsock_ops;
 #define udpsock_is_conn(udp)	\
 	(udp_flags((udp)->udp_pcb) & UDP_FLAGS_CONNECTED)
 
+static ssize_t udpsock_stats(struct rmib_call *, struct rmib_node *,
+	struct rmib_oldp *, struct rmib_newp *);
 static ssize_t udpsock_pcblist(struct rmib_call *, struct rmib_node *,
 	struct rmib_oldp *, struct rmib_newp *);
 
+/*
+ * UDP statistics, in NetBSD layout.  The IPv4 and IPv6 sets of counters are
+ * maintained separately, as NetBSD uses a different format for each.  We can
+ * maintain only the counters for packets that pass through this module;
+ * counters for cases handled inside lwIP's UDP input code (e.g., checksum
+ * failures and unmatched ports) always remain zero.
+ */
+static uint64_t udpstat[UDP_NSTATS];
+static uint64_t udp6stat[UDP6_NSTATS];
+
 /* The CTL_NET {PF_INET,PF_INET6} IPPROTO_UDP subtree. */
 /* TODO: add many more and make some of them writable.. */
 static struct rmib_node net_inet_udp_table[] = {
@@ -66,6 +79,9 @@ static struct rmib_node net_inet_udp_table[] = {
 /* 4*/	[UDPCTL_LOOPBACKCKSUM]	= RMIB_FUNC(RMIB_RW | CTLTYPE_INT, sizeof(int),
 				    loopif_cksum, "do_loopback_cksum",
 				    "Perform UDP checksum on loopback"),
+/* 5*/	[UDPCTL_STATS]		= RMIB_FUNC(RMIB_RO | CTLTYPE_STRUCT, 0,
+				    udpsock_stats, "stats",
+				    "UDP statistics"),
 /*+0*/	[UDPCTL_MAXID]		= RMIB_FUNC(RMIB_RO | CTLTYPE_NODE, 0,
 				    udpsock_pcblist, "pcblist",
 				    "UDP protocol control block list"),
@@ -105,8 +121,18 @@ udpsock_input(void * arg, struct udp_pcb * pcb __unused, struct pbuf * pbuf,
 {
 	struct udpsock *udp = (struct udpsock *)arg;
 
+	if (ip_current_is_v6())
+		udp6stat[UDP6_STAT_IPACKETS]++;
+	else
+		udpstat[UDP_STAT_IPACKETS]++;
+
 	/* All UDP input processing is handled by pktsock. */
-	pktsock_input(&udp->udp_pktsock, pbuf, ipaddr, port);
+	if (!pktsock_input(&udp->udp_pktsock, pbuf, ipaddr, port)) {
+		if (ip_current_is_v6())
+			udp6stat[UDP6_STAT_FULLSOCK]++;
+		else
+			udpstat[UDP_STAT_FULLSOCK]++;
+	}
 }
 
 /*
@@ -532,8 +558,14 @@ udpsock_send(struct sock * sock, const struct sockdriver_data * data,
 	 * On success, make sure to return the size of the sent packet as well.
 	 * As an aside: ctl_off need not be updated, as it is not returned.
 	 */
-	if ((r = util_convert_err(err)) == OK)
+	if ((r = util_convert_err(err)) == OK) {
+		if (IP_IS_V6(dst_addrp))
+			udp6stat[UDP6_STAT_OPACKETS]++;
+		else
+			udpstat[UDP_STAT_OPACKETS]++;
+
 		*off = len;
+	}
 	return r;
 }
 
@@ -966,6 +998,36 @@ udpsock_enum(const void * last)
 	return pcb;
 }
 
+/*
+ * Obtain the UDP statistics, for sysctl(7).
+ */
+static ssize_t
+udpsock_stats(struct rmib_call * call, struct rmib_node * node __unused,
+	struct rmib_oldp * oldp, struct rmib_newp * newp __unused)
+{
+	void *ptr;
+	size_t size;
+	int r;
+
+	/*
+	 * The second name field is the domain: the IPv4 and IPv6 statistics
+	 * are kept in separate arrays, each in its own NetBSD layout.
+	 */
+	if (call->call_oname[1] == PF_INET6) {
+		ptr = udp6stat;
+		size = sizeof(udp6stat);
+	} else {
+		ptr = udpstat;
+		size = sizeof(udpstat);
+	}
+
+	if (oldp != NULL && (r = rmib_copyout(oldp, 0, ptr, size)) < 0)
+		return r;
+
+	/* Return the length of the node. */
+	return size;
+}
+
 /*
  * Obtain the list of UDP protocol control blocks, for sysctl(7).
  */
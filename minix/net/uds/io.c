@@ -95,6 +95,19 @@ static SIMPLEQ_HEAD(uds_freefds, uds_fd) uds_freefds;
 static char uds_ctlbuf[UDS_CTL_MAX];
 static int uds_ctlfds[UDS_CTL_MAX / sizeof(int)];
 
+/*
+ * Pool of unused receive buffers.  Allocating a receive buffer requires a
+ * round trip to VM, and the resulting memory is faulted in one page at a time
+ * as the buffer is filled, which is costly for workloads that create and
+ * destroy many short-lived sockets.  Therefore, rather than freeing the
+ * receive buffer of a closed socket right away, we cache a limited number of
+ * such buffers for reuse by sockets created later.
+ */
+#define UDS_BUFPOOL	64	/* max. number of cached receive buffers */
+
+static char *uds_bufpool[UDS_BUFPOOL];
+static unsigned int uds_bufs;	/* number of buffers currently in the pool */
+
 /*
  * Initialize the input/output part of the UDS service.
  */
@@ -111,15 +124,17 @@ uds_io_init(void)
 
 /*
  * Set up all input/output state for the given socket, which has just been
- * allocated.  As part of this, allocate memory for the receive buffer of the
- * socket.  Return OK or a negative error code.
+ * allocated.  As part of this, obtain memory for the receive buffer of the
+ * socket, preferably from the buffer pool.  Return OK or a negative error
+ * code.
  */
 int
 uds_io_setup(struct udssock * uds)
 {
 
-	/* TODO: decide if we should preallocate the memory. */
-	if ((uds->uds_buf = mmap(NULL, UDS_BUF, PROT_READ | PROT_WRITE,
+	if (uds_bufs > 0)
+		uds->uds_buf = uds_bufpool[--uds_bufs];
+	else if ((uds->uds_buf = mmap(NULL, UDS_BUF, PROT_READ | PROT_WRITE,
 	    MAP_ANON | MAP_PRIVATE, -1, 0)) == MAP_FAILED)
 		return ENOMEM;
 
@@ -134,8 +149,8 @@ uds_io_setup(struct udssock * uds)
 
 /*
  * Clean up the input/output state for the given socket, which is about to be
- * freed.  As part of this, deallocate memory for the receive buffer and close
- * any file descriptors still in flight on the socket.
+ * freed.  As part of this, release the memory for the receive buffer of the
+ * socket, and close any file descriptors still in flight on the socket.
  */
 void
 uds_io_cleanup(struct udssock * uds)
@@ -144,8 +159,10 @@ uds_io_cleanup(struct udssock * uds)
 	/* Close any in-flight file descriptors. */
 	uds_io_reset(uds);
 
-	/* Free the receive buffer memory. */
-	if (munmap(uds->uds_buf, UDS_BUF) != 0)
+	/* Return the receive buffer memory to the pool, or free it. */
+	if (uds_bufs < __arraycount(uds_bufpool))
+		uds_bufpool[uds_bufs++] = uds->uds_buf;
+	else if (munmap(uds->uds_buf, UDS_BUF) != 0)
 		panic("UDS: munmap failed: %d", errno);
 }
 
@@ -852,43 +869,56 @@ uds_send_fds(struct udssock * peer, unsigned int nfds, endpoint_t user_endpt)
 {
 	SIMPLEQ_HEAD(, uds_fd) fds;
 	struct uds_fd *ufd;
-	unsigned int i;
+	unsigned int i, chunk, ncopied;
 	int r;
 
-	SIMPLEQ_INIT(&fds);
+	/*
+	 * Copy in the file descriptors first, in batches of up to COPYFD_MAX
+	 * at a time, so that each batch takes just one call to VFS.  The
+	 * resulting local file descriptors replace the originals in the
+	 * temporary buffer.
+	 *
+	 * The caller may have given an invalid FD, or UDS itself may
+	 * unexpectedly have run out of available file descriptors etc.
+	 */
+	r = OK;
+	for (ncopied = 0; ncopied < nfds; ncopied += chunk) {
+		chunk = MIN(nfds - ncopied, (unsigned int)COPYFD_MAX);
 
-	for (i = 0; i < nfds; i++) {
-		if (SIMPLEQ_EMPTY(&uds_freefds)) {
-			/* UDS itself may already have OPEN_MAX FDs. */
-			r = ENFILE;
+		if ((r = copyfds(user_endpt, &uds_ctlfds[ncopied], chunk,
+		    COPYFD_FROM)) < 0)
 			break;
-		}
+	}
 
-		/*
-		 * The caller may have given an invalid FD, or UDS itself may
-		 * unexpectedly have run out of available file descriptors etc.
-		 */
-		if ((r = copyfd(user_endpt, uds_ctlfds[i], COPYFD_FROM)) < 0)
-			break;
+	SIMPLEQ_INIT(&fds);
 
-		ufd = SIMPLEQ_FIRST(&uds_freefds);
-		SIMPLEQ_REMOVE_HEAD(&uds_freefds, ufd_next);
+	if (r == OK) {
+		for (i = 0; i < nfds; i++) {
+			if (SIMPLEQ_EMPTY(&uds_freefds)) {
+				/* UDS itself may already have OPEN_MAX FDs. */
+				r = ENFILE;
+				break;
+			}
 
-		ufd->ufd_fd = r;
-		ufd->ufd_count = 0;
+			ufd = SIMPLEQ_FIRST(&uds_freefds);
+			SIMPLEQ_REMOVE_HEAD(&uds_freefds, ufd_next);
 
-		SIMPLEQ_INSERT_TAIL(&fds, ufd, ufd_next);
+			ufd->ufd_fd = uds_ctlfds[i];
+			ufd->ufd_count = 0;
 
-		dprintf(("UDS: copied in fd %d -> %d\n", uds_ctlfds[i], r));
+			SIMPLEQ_INSERT_TAIL(&fds, ufd, ufd_next);
+
+			dprintf(("UDS: copied in fd -> %d\n", uds_ctlfds[i]));
+		}
 	}
 
-	/* Did we experience an error while copying in the file descriptors? */
+	/* Did we experience an error along the way? */
 	if (r < 0) {
-		/* Revert the successful copyfd() calls made so far. */
-		SIMPLEQ_FOREACH(ufd, &fds, ufd_next) {
-			dprintf(("UDS: closing local fd %d\n", ufd->ufd_fd));
+		/* Close the local copies made so far. */
+		for (i = 0; i < ncopied; i++) {
+			dprintf(("UDS: closing local fd %d\n", uds_ctlfds[i]));
 
-			closenb(ufd->ufd_fd);
+			closenb(uds_ctlfds[i]);
 		}
 
 		SIMPLEQ_CONCAT(&uds_freefds, &fds);
@@ -1318,9 +1348,9 @@ uds_recv_fds(struct udssock * uds, const struct sockdriver_data * ctl,
 	struct msghdr msghdr;
 	struct cmsghdr *cmsg;
 	struct uds_fd *ufd;
-	unsigned int i, nfds;
+	unsigned int i, j, nfds, chunk;
 	socklen_t chunklen, chunkspace;
-	int r, fd, what;
+	int r, what;
 
 	/* See how many file descriptors should be part of this chunk. */
 	assert(!SIMPLEQ_EMPTY(&uds->uds_fds));
@@ -1355,30 +1385,42 @@ uds_recv_fds(struct udssock * uds, const struct sockdriver_data * ctl,
 	cmsg->cmsg_type = SCM_RIGHTS;
 
 	/*
-	 * Copy the group's local file descriptors to the target endpoint, and
-	 * store the resulting remote file descriptors in the chunk buffer.
+	 * Gather the group's local file descriptors into the temporary array,
+	 * so that they can be copied out in batches.
 	 */
-	r = OK;
-
 	for (i = 0; i < nfds; i++) {
 		assert(ufd != SIMPLEQ_END(&uds->uds_fds));
 		assert(i == 0 || ufd->ufd_count == 0);
 
-		what = COPYFD_TO;
-		if (flags & MSG_CMSG_CLOEXEC)
-			what |= COPYFD_CLOEXEC;
+		uds_ctlfds[i] = ufd->ufd_fd;
 
-		/* Failure may happen legitimately here (e.g., EMFILE). */
-		if ((r = copyfd(user_endpt, ufd->ufd_fd, what)) < 0)
-			break; /* we keep our progress so far in 'i' */
+		ufd = SIMPLEQ_NEXT(ufd, ufd_next);
+	}
 
-		fd = r;
+	what = COPYFD_TO;
+	if (flags & MSG_CMSG_CLOEXEC)
+		what |= COPYFD_CLOEXEC;
 
-		dprintf(("UDS: copied out fd %d -> %d\n", ufd->ufd_fd, fd));
+	/*
+	 * Copy the local file descriptors to the target endpoint, in batches
+	 * of up to COPYFD_MAX at a time so that each batch takes just one
+	 * call to VFS, and store the resulting remote file descriptors in the
+	 * chunk buffer.
+	 */
+	r = OK;
 
-		memcpy(&((int *)CMSG_DATA(cmsg))[i], &fd, sizeof(int));
+	for (i = 0; i < nfds; i += chunk) {
+		chunk = MIN(nfds - i, (unsigned int)COPYFD_MAX);
 
-		ufd = SIMPLEQ_NEXT(ufd, ufd_next);
+		/* Failure may happen legitimately here (e.g., EMFILE). */
+		if ((r = copyfds(user_endpt, &uds_ctlfds[i], chunk,
+		    what)) < 0)
+			break; /* we keep our progress so far in 'i' */
+
+		dprintf(("UDS: copied out %u fds\n", chunk));
+
+		memcpy(&((int *)CMSG_DATA(cmsg))[i], &uds_ctlfds[i],
+		    sizeof(int) * chunk);
 	}
 
 	/* If everything went well so far, copy out the produced chunk. */
@@ -1390,11 +1432,15 @@ uds_recv_fds(struct udssock * uds, const struct sockdriver_data * ctl,
 	 * of file descriptors that have already been successfully copied out.
 	 */
 	if (r < 0) {
-		/* Revert the successful copyfd() calls made so far. */
-		while (i-- > 0) {
-			memcpy(&fd, &((int *)CMSG_DATA(cmsg))[i], sizeof(int));
+		/* Revert the successful copies made so far, also in batches.
+		 * The remote file descriptor numbers are still in the
+		 * temporary array at this point.
+		 */
+		for (j = 0; j < i; j += chunk) {
+			chunk = MIN(i - j, (unsigned int)COPYFD_MAX);
 
-			(void)copyfd(user_endpt, fd, COPYFD_CLOSE);
+			(void)copyfds(user_endpt, &uds_ctlfds[j], chunk,
+			    COPYFD_CLOSE);
 		}
 
 		return r;
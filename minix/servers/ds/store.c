@@ -5,6 +5,12 @@
 static struct data_store ds_store[NR_DS_KEYS];
 static struct subscription ds_subs[NR_DS_SUBS];
 
+/* Read-only mirror of the label entries, exported through a memory grant so
+ * that services can resolve labels without calling us (see DS_SNAPSHOT).
+ */
+static struct ds_snap ds_snap;
+static cp_grant_id_t ds_snap_grant = GRANT_INVALID;
+
 /*===========================================================================*
  *			      alloc_data_slot				     *
  *===========================================================================*/
@@ -187,9 +193,20 @@ static int check_sub_match(const struct subscription *subp,
 		struct data_store *dsp, endpoint_t ep)
 {
 /* Check if an entry matches a subscription. Return 1 in case of match. */
-  return (check_auth(dsp, ep, DSF_PRIV_SUBSCRIBE)
-	  && regexec(&subp->regex, dsp->key, 0, NULL, 0) == 0)
-	  ? 1 : 0;
+  if (!check_auth(dsp, ep, DSF_PRIV_SUBSCRIBE))
+	return 0;
+
+  /* The pattern can only match keys that start with its literal prefix, so
+   * compare that first and reject non-matching subscriptions without going
+   * through the regex machinery. Fully literal patterns (the common case: a
+   * subscription on one specific label) never need regexec() at all.
+   */
+  if (strncmp(dsp->key, subp->prefix, subp->prefix_len) != 0)
+	return 0;
+  if (subp->exact)
+	return dsp->key[subp->prefix_len] == '\0';
+
+  return regexec(&subp->regex, dsp->key, 0, NULL, 0) == 0 ? 1 : 0;
 }
 
 /*===========================================================================*
@@ -223,6 +240,37 @@ static void update_subscribers(struct data_store *dsp, int set)
 	}
 }
 
+/*===========================================================================*
+ *			     update_label_snap				     *
+ *===========================================================================*/
+static void update_label_snap(void)
+{
+/* Rebuild the exported label snapshot from the store. Readers copy the
+ * snapshot through a memory grant without involving us, so bump the sequence
+ * number around the update to let them detect that they raced with a change.
+ */
+  unsigned int s;
+  int i;
+
+  ds_snap.ds_seq++;		/* odd: update in progress */
+
+  s = 0;
+  for (i = 0; i < NR_DS_KEYS; i++) {
+	if (!(ds_store[i].flags & DSF_IN_USE)
+		|| !(ds_store[i].flags & DSF_TYPE_LABEL))
+		continue;
+	assert(s < DS_SNAP_NR);
+	strlcpy(ds_snap.ds_entry[s].dse_key, ds_store[i].key,
+		sizeof(ds_snap.ds_entry[s].dse_key));
+	ds_snap.ds_entry[s].dse_endpt = (endpoint_t) ds_store[i].u.u32;
+	s++;
+  }
+  for (; s < DS_SNAP_NR; s++)
+	ds_snap.ds_entry[s].dse_key[0] = '\0';
+
+  ds_snap.ds_seq++;		/* even: consistent again */
+}
+
 /*===========================================================================*
  *		               map_service                                   *
  *===========================================================================*/
@@ -278,6 +326,8 @@ int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *info)
 		}
 	}
 
+	update_label_snap();
+
 	return(OK);
 }
 
@@ -374,6 +424,10 @@ int do_publish(message *m_ptr)
   /* Update subscribers having a matching subscription. */
   update_subscribers(dsp, 1);
 
+  /* Labels also show up in the exported snapshot. */
+  if(flags & DSF_TYPE_LABEL)
+	update_label_snap();
+
   return(OK);
 }
 
@@ -458,9 +512,9 @@ int do_subscribe(message *m_ptr)
   char regex[DS_MAX_KEYLEN+2];
   struct subscription *subp;
   char errbuf[80];
-  char *owner;
+  char *owner, *p;
   int type_set;
-  int r, e, b;
+  int r, e, b, n;
 
   /* Find the owner. */
   owner = ds_getprocname(m_ptr->m_source);
@@ -497,6 +551,19 @@ int do_subscribe(message *m_ptr)
 	return EINVAL;
   }
 
+  /* Extract the leading run of characters with no special meaning in an
+   * extended regular expression. Matching compares this literal prefix before
+   * resorting to regexec(); if the scan reaches the anchoring "$" we added
+   * above, the pattern is fully literal and regexec() is never needed.
+   */
+  p = regex + 1;
+  n = 0;
+  while (*p != '\0' && strchr("^$.[]()|*+?{}\\", *p) == NULL)
+	subp->prefix[n++] = *p++;
+  subp->prefix[n] = '\0';
+  subp->prefix_len = n;
+  subp->exact = (p[0] == '$' && p[1] == '\0');
+
   /* If type_set = 0, then subscribe all types. */
   type_set = m_ptr->m_ds_req.flags & DSF_MASK_TYPE;
   if(type_set == 0)
@@ -644,6 +711,32 @@ int do_delete(message *m_ptr)
   /* Clear the entry. */
   dsp->flags = 0;
 
+  if(type == DSF_TYPE_LABEL)
+	update_label_snap();
+
+  return OK;
+}
+
+/*===========================================================================*
+ *				do_snapshot				     *
+ *===========================================================================*/
+int do_snapshot(message *m_ptr)
+{
+/* Hand out a read-only grant for the label snapshot, so that the caller can
+ * do further label lookups without consulting us.  The grant is created once
+ * and deliberately made valid for any endpoint: the snapshot contains only
+ * label-to-endpoint mappings, which any service may retrieve anyway.
+ */
+  if(!GRANT_VALID(ds_snap_grant)) {
+	ds_snap_grant = cpf_grant_direct(ANY, (vir_bytes) &ds_snap,
+		sizeof(ds_snap), CPF_READ);
+	if(!GRANT_VALID(ds_snap_grant))
+		return ENOMEM;
+  }
+
+  m_ptr->m_ds_reply.val_out.grant = ds_snap_grant;
+  m_ptr->m_ds_reply.val_len = DS_SNAP_NR;
+
   return OK;
 }
 
@@ -32,7 +32,10 @@ struct subscription {
 	int		flags;
 	char		owner[DS_MAX_KEYLEN];
 	regex_t		regex;
-	bitchunk_t	old_subs[BITMAP_CHUNKS(NR_DS_KEYS)];	
+	char		prefix[DS_MAX_KEYLEN];	/* literal prefix of pattern */
+	int		prefix_len;
+	int		exact;			/* pattern is fully literal */
+	bitchunk_t	old_subs[BITMAP_CHUNKS(NR_DS_KEYS)];
 };
 
 #endif /* _DS_STORE_H_ */
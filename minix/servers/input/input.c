@@ -187,6 +187,7 @@ input_read(devminor_t minor, u64_t UNUSED(position), endpoint_t endpt,
 		input_dev->caller = endpt;
 		input_dev->grant = grant;
 		input_dev->req_id = id;
+		input_dev->req_count = event_count;
 
 		/* We should now wake up any selector, but that's lame.. */
 		return EDONTREPLY;
@@ -326,14 +327,16 @@ input_select(devminor_t minor, unsigned int ops, endpoint_t endpt)
 }
 
 /*
- * An input device receives an input event.  Enqueue it, and possibly unsuspend
- * a read request or wake up a selector.
+ * An input device receives an input event.  Enqueue it in the device's ring
+ * buffer.  The caller must wake up any waiting reader or selector afterwards,
+ * with input_wakeup(); this separation allows a whole batch of events to be
+ * enqueued with a single wakeup.
  */
 static void
-input_process(struct input_dev *input_dev, const message *m)
+input_process(struct input_dev *input_dev, int id, unsigned short page,
+	unsigned short code, int value, int flags)
 {
 	unsigned int next;
-	int r;
 
 	if (input_dev_buf_full(input_dev)) {
 		/* Overflow.  Overwrite the oldest event. */
@@ -345,22 +348,37 @@ input_process(struct input_dev *input_dev, const message *m)
 #endif
 	}
 	next = (input_dev->tail + input_dev->count) % EVENTBUF_SIZE;
-	input_dev->eventbuf[next].page = m->m_linputdriver_input_event.page;
-	input_dev->eventbuf[next].code = m->m_linputdriver_input_event.code;
-	input_dev->eventbuf[next].value = m->m_linputdriver_input_event.value;
-	input_dev->eventbuf[next].flags = m->m_linputdriver_input_event.flags;
-	input_dev->eventbuf[next].devid = m->m_linputdriver_input_event.id;
+	input_dev->eventbuf[next].page = page;
+	input_dev->eventbuf[next].code = code;
+	input_dev->eventbuf[next].value = value;
+	input_dev->eventbuf[next].flags = flags;
+	input_dev->eventbuf[next].devid = id;
 	input_dev->eventbuf[next].rsvd[0] = 0;
 	input_dev->eventbuf[next].rsvd[1] = 0;
 	input_dev->count++;
+}
+
+/*
+ * There is new input on a device.  Revive a suspended reader if there was
+ * one, giving it as many events as it asked for and are available.  Otherwise
+ * see if we should reply to a select query.
+ */
+static void
+input_wakeup(struct input_dev *input_dev)
+{
+	unsigned int event_count;
+	int r;
+
+	if (input_dev_buf_empty(input_dev))
+		return;
 
-	/*
-	 * There is new input.  Revive a suspended reader if there was one.
-	 * Otherwise see if we should reply to a select query.
-	 */
 	if (input_dev->suspended) {
-		r = input_copy_events(input_dev->caller, input_dev->grant, 1,
-		    input_dev);
+		event_count = input_dev->req_count;
+		if (event_count > input_dev->count)
+			event_count = input_dev->count;
+
+		r = input_copy_events(input_dev->caller, input_dev->grant,
+		    event_count, input_dev);
 		chardriver_reply_task(input_dev->caller, input_dev->req_id, r);
 		input_dev->suspended = FALSE;
 	} else if (input_dev->selector != NONE) {
@@ -371,23 +389,25 @@ input_process(struct input_dev *input_dev, const message *m)
 }
 
 /*
- * An input event has arrived from a driver.
+ * Deliver an event from a driver to the input device with the given ID, or to
+ * the corresponding multiplexer, or forward it to TTY.  Return the device
+ * that received the event, or NULL if it was forwarded or dropped.
  */
-static void
-input_event(message *m)
+static struct input_dev *
+input_deliver(endpoint_t source, int id, unsigned short page,
+	unsigned short code, int value, int flags)
 {
 	struct input_dev *input_dev, *mux_dev;
-	int r, id;
+	int r;
 
 	/* Unlike minor numbers, device IDs are in fact array indices. */
-	id = m->m_linputdriver_input_event.id;
 	if (id < 0 || id >= INPUT_DEV_MAX)
-		return;
+		return NULL;
 
 	/* The sender must owner the device. */
 	input_dev = &devs[id];
-	if (input_dev->owner != m->m_source)
-		return;
+	if (input_dev->owner != source)
+		return NULL;
 
 	/* Input events are also delivered to the respective multiplexer. */
 	if (input_dev->minor >= KBD0_MINOR &&
@@ -401,24 +421,82 @@ input_event(message *m)
 	 * corresponding multiplexer.  If neither are opened, forward the event
 	 * to TTY.
 	 */
-	if (input_dev->opened)
-		input_process(input_dev, m);
-	else if (mux_dev->opened)
-		input_process(mux_dev, m);
-	else {
+	if (input_dev->opened) {
+		input_process(input_dev, id, page, code, value, flags);
+
+		return input_dev;
+	} else if (mux_dev->opened) {
+		input_process(mux_dev, id, page, code, value, flags);
+
+		return mux_dev;
+	} else {
 		message fwd;
 		mess_input_tty_event *tty_event = &(fwd.m_input_tty_event);
 
 		fwd.m_type = TTY_INPUT_EVENT;
-		tty_event->id = m->m_linputdriver_input_event.id;
-		tty_event->page = m->m_linputdriver_input_event.page;
-		tty_event->code = m->m_linputdriver_input_event.code;
-		tty_event->value = m->m_linputdriver_input_event.value;
-		tty_event->flags = m->m_linputdriver_input_event.flags;
+		tty_event->id = id;
+		tty_event->page = page;
+		tty_event->code = code;
+		tty_event->value = value;
+		tty_event->flags = flags;
 
 		if ((r = ipc_send(TTY_PROC_NR, &fwd)) != OK)
 			printf("INPUT: send to TTY failed (%d)\n", r);
+
+		return NULL;
+	}
+}
+
+/*
+ * A single input event has arrived from a driver.
+ */
+static void
+input_event(message *m)
+{
+	struct input_dev *input_dev;
+
+	input_dev = input_deliver(m->m_source,
+	    m->m_linputdriver_input_event.id,
+	    m->m_linputdriver_input_event.page,
+	    m->m_linputdriver_input_event.code,
+	    m->m_linputdriver_input_event.value,
+	    m->m_linputdriver_input_event.flags);
+
+	if (input_dev != NULL)
+		input_wakeup(input_dev);
+}
+
+/*
+ * A batch of input events has arrived from a driver.  All events in a batch
+ * carry the same device ID.  Enqueue all of them before waking up a reader,
+ * so that the whole burst takes a single wakeup.
+ */
+static void
+input_events(message *m)
+{
+	struct input_dev *input_dev, *wake_dev;
+	unsigned int i, count;
+	int id;
+
+	id = m->m_linputdriver_input_events.id;
+	count = m->m_linputdriver_input_events.count;
+	if (count > INPUT_EVENTS_MAX)
+		return;
+
+	wake_dev = NULL;
+	for (i = 0; i < count; i++) {
+		input_dev = input_deliver(m->m_source, id,
+		    m->m_linputdriver_input_events.page[i],
+		    m->m_linputdriver_input_events.code[i],
+		    m->m_linputdriver_input_events.value[i],
+		    m->m_linputdriver_input_events.flags[i]);
+
+		if (input_dev != NULL)
+			wake_dev = input_dev;
 	}
+
+	if (wake_dev != NULL)
+		input_wakeup(wake_dev);
 }
 
 /*
@@ -627,6 +705,11 @@ input_other(message *m, int ipc_status)
 
 		break;
 
+	case INPUT_EVENTS:
+		input_events(m);
+
+		break;
+
 	case INPUT_SETLEDS:
 		if (m->m_source == TTY_PROC_NR) {
 			input_set_leds(KBDMUX_MINOR, m->m_input_linputdriver_setleds.led_mask);
@@ -38,6 +38,7 @@ struct input_dev {
 	endpoint_t caller;		/* endpoint for suspended read */
 	cp_grant_id_t grant;		/* grant for suspended read */
 	cdev_id_t req_id;		/* request ID for suspended read */
+	unsigned int req_count;		/* event count for suspended read */
 	endpoint_t selector;		/* read-selecting endpoint, or NONE */
 	unsigned int leds;		/* LED mask - saved across connects */
 };
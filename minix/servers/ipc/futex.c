@@ -0,0 +1,305 @@
+#include "inc.h"
+
+#include <minix/futex.h>
+
+/*
+ * Futex-style wait/wake support on 32-bit words in System V shared memory
+ * segments.  A futex word is addressed by a segment identifier and a byte
+ * offset into the segment, which is a canonical name for the word that is
+ * valid in every process that has the segment attached, regardless of where
+ * each of them mapped it.
+ *
+ * The memory accesses on the word itself are performed by the processes
+ * sharing it, using atomic instructions on their own mappings; no message
+ * needs to be sent for an uncontended lock or unlock.  Only a process that
+ * finds the word in a contended state calls us to go to sleep, and only a
+ * process that changes the word from a contended state calls us to wake up
+ * sleepers.  Since we have every shared memory segment mapped into our own
+ * address space (see shm.c), we can recheck the word after the wait request
+ * has reached us, and since we serve requests one at a time, that recheck
+ * cannot race with a wake request: a waiter is either denied with EAGAIN
+ * because the word changed before its request was served, or enqueued before
+ * any subsequent wake request is looked at.  This provides the usual
+ * guarantee that no wakeup can be lost between a caller's last test of the
+ * word and its suspension.
+ */
+
+struct fwaiter {
+	int fw_inuse;			/* is this process blocked on a wait? */
+	int fw_id;			/* shm segment identifier */
+	vir_bytes fw_offset;		/* offset of the word in the segment */
+	endpoint_t fw_endpt;		/* process endpoint */
+	pid_t fw_owner;			/* robust waits: PID of the owner */
+	TAILQ_ENTRY(fwaiter) fw_next;	/* next waiting process */
+};
+
+static struct fwaiter fwaiter[NR_PROCS];
+
+/*
+ * All waiting processes, in FCFS order, on one list: we expect contention on
+ * any particular word to be low, and a wake request has to scan the list for
+ * matching waiters anyway.
+ */
+static TAILQ_HEAD(fw_list, fwaiter) fw_waiters =
+    TAILQ_HEAD_INITIALIZER(fw_waiters);
+
+static unsigned int fw_waiters_nr = 0;	/* number of blocked processes */
+
+/*
+ * Send a reply for a wait call suspended earlier, thus waking up the process.
+ */
+static void
+send_reply(endpoint_t who, int ret)
+{
+	message m;
+
+	memset(&m, 0, sizeof(m));
+	m.m_type = ret;
+
+	ipc_sendnb(who, &m);
+}
+
+/*
+ * Terminate the wait call on which the given process is blocked, and send the
+ * given reply code (OK or a negative error code) to wake it up, unless the
+ * given code is EDONTREPLY.
+ */
+static void
+complete_wait(struct fwaiter * fw, int code)
+{
+
+	assert(fw->fw_inuse);
+	assert(fw_waiters_nr > 0);
+
+	TAILQ_REMOVE(&fw_waiters, fw, fw_next);
+	fw_waiters_nr--;
+
+	fw->fw_inuse = FALSE;
+
+	if (code != EDONTREPLY)
+		send_reply(fw->fw_endpt, code);
+}
+
+/*
+ * The owner of the robust mutex at the given word has died while holding it.
+ * Put the word in the owner-died state, and wake up all processes blocked on
+ * it with an EOWNERDEAD reply, so that one of them can take over ownership
+ * and repair the state protected by the mutex.
+ */
+static void
+futex_owner_dead(int id, vir_bytes offset)
+{
+	struct fwaiter *fw, *next;
+
+	if (shm_write_word(id, offset, MINIX_FUTEX_OWNERDEAD) != OK)
+		return;
+
+	for (fw = TAILQ_FIRST(&fw_waiters); fw != NULL; fw = next) {
+		next = TAILQ_NEXT(fw, fw_next);
+
+		if (fw->fw_id == id && fw->fw_offset == offset)
+			complete_wait(fw, EOWNERDEAD);
+	}
+}
+
+/*
+ * Return TRUE iff the process with the given PID no longer exists.
+ */
+static int
+is_pid_dead(pid_t pid)
+{
+
+	return (kill(pid, 0) == -1 && errno == ESRCH);
+}
+
+/*
+ * Implementation of the futex wait call.  Suspend the calling process until
+ * a wake call is issued on the same word, but only if the word still holds
+ * the value that the caller saw when it decided to block.
+ */
+int
+do_futex_wait(message * m)
+{
+	struct fwaiter *fw;
+	unsigned int slot, cur;
+	vir_bytes offset;
+	pid_t owner;
+	int r, id;
+
+	id = m->m_lc_ipc_futex.id;
+	offset = m->m_lc_ipc_futex.offset;
+
+	if ((r = shm_read_word(m->m_source, id, offset, &cur)) != OK)
+		return r;
+
+	/*
+	 * If the word no longer holds the expected value, another process
+	 * changed it after the caller decided to block.  Deny the call; the
+	 * caller must reevaluate the word before trying again, or it could
+	 * miss a wakeup sent in the meantime.
+	 */
+	if (cur != m->m_lc_ipc_futex.value)
+		return EAGAIN;
+
+	/*
+	 * For robust waits, the caller passes in the PID of the process that
+	 * it believes to own the word.  If that process has already died, no
+	 * unlock operation will ever wake up the caller, so the wait must be
+	 * denied.  If the word indeed still names the dead owner, we also put
+	 * it in the owner-died state right away.
+	 */
+	owner = m->m_lc_ipc_futex.owner;
+
+	if (owner > 0 && is_pid_dead(owner)) {
+		if ((cur & MINIX_FUTEX_TID_MASK) == (unsigned int)owner) {
+			futex_owner_dead(id, offset);
+
+			return EOWNERDEAD;
+		}
+
+		return EAGAIN;
+	}
+
+	slot = _ENDPOINT_P(m->m_source);
+	assert(slot < __arraycount(fwaiter));
+
+	fw = &fwaiter[slot];
+
+	/* The caller is blocked in sendrec, so it cannot wait twice. */
+	assert(!fw->fw_inuse);
+
+	fw->fw_inuse = TRUE;
+	fw->fw_id = id;
+	fw->fw_offset = offset;
+	fw->fw_endpt = m->m_source;
+	fw->fw_owner = owner;
+
+	TAILQ_INSERT_TAIL(&fw_waiters, fw, fw_next);
+	fw_waiters_nr++;
+
+	return SUSPEND;
+}
+
+/*
+ * Implementation of the futex wake call.  Wake up blocked waiters on the
+ * given word, at most as many as the caller requested.  Return the number of
+ * processes actually woken up.
+ */
+int
+do_futex_wake(message * m)
+{
+	struct fwaiter *fw, *next;
+	unsigned int cur, max, woken;
+	vir_bytes offset;
+	int r, id;
+
+	id = m->m_lc_ipc_futex.id;
+	offset = m->m_lc_ipc_futex.offset;
+	max = m->m_lc_ipc_futex.max;
+
+	/*
+	 * The word value itself is of no interest here, but performing the
+	 * read validates the segment, the offset, and the caller's access
+	 * permission, with the same error codes as for the wait call.
+	 */
+	if ((r = shm_read_word(m->m_source, id, offset, &cur)) != OK)
+		return r;
+
+	woken = 0;
+
+	for (fw = TAILQ_FIRST(&fw_waiters); fw != NULL && woken < max;
+	    fw = next) {
+		next = TAILQ_NEXT(fw, fw_next);
+
+		if (fw->fw_id != id || fw->fw_offset != offset)
+			continue;
+
+		complete_wait(fw, OK);
+		woken++;
+	}
+
+	return woken;
+}
+
+/*
+ * The shared memory segment with the given identifier is being destroyed.
+ * Wake up any processes still blocked on a word in it, with an EIDRM reply.
+ */
+void
+futex_segment_gone(int id)
+{
+	struct fwaiter *fw, *next;
+
+	for (fw = TAILQ_FIRST(&fw_waiters); fw != NULL; fw = next) {
+		next = TAILQ_NEXT(fw, fw_next);
+
+		if (fw->fw_id == id)
+			complete_wait(fw, EIDRM);
+	}
+}
+
+/*
+ * Return TRUE iff no processes are blocked on a futex wait call.
+ */
+int
+is_futex_nil(void)
+{
+
+	return (fw_waiters_nr == 0);
+}
+
+/*
+ * Check if the given endpoint is blocked on a futex wait call.  If so, cancel
+ * the call, because either it is interrupted by a signal or the process was
+ * killed.  In the former case, unblock the process by replying with EINTR.
+ * If the process has exited, also check whether it owned any robust mutexes
+ * that other processes are blocked on.
+ */
+void
+futex_process_event(endpoint_t endpt, int has_exited)
+{
+	unsigned int slot, cur;
+	struct fwaiter *fw;
+
+	slot = _ENDPOINT_P(endpt);
+	assert(slot < __arraycount(fwaiter));
+
+	fw = &fwaiter[slot];
+
+	/* Was the process blocked on a wait call at all? */
+	if (fw->fw_inuse) {
+		assert(fw->fw_endpt == endpt);
+
+		complete_wait(fw, has_exited ? EDONTREPLY : EINTR);
+	}
+
+	/*
+	 * The process that is gone may have been the owner of a robust mutex
+	 * on which other processes are blocked.  Check the registered owner of
+	 * every robust wait; if the owner has died while the word still names
+	 * it, put the word in the owner-died state and wake up its waiters.
+	 * Since waking up waiters modifies the list we are iterating over, we
+	 * simply restart the scan after each match; every restart is paired
+	 * with the removal of at least one waiter, so this terminates.
+	 */
+	if (!has_exited)
+		return;
+
+restart:
+	TAILQ_FOREACH(fw, &fw_waiters, fw_next) {
+		if (fw->fw_owner <= 0)
+			continue;
+		if (!is_pid_dead(fw->fw_owner))
+			continue;
+
+		if (shm_read_word(fw->fw_endpt, fw->fw_id, fw->fw_offset,
+		    &cur) != OK)
+			continue;
+		if ((cur & MINIX_FUTEX_TID_MASK) != (unsigned int)fw->fw_owner)
+			continue;
+
+		futex_owner_dead(fw->fw_id, fw->fw_offset);
+
+		goto restart;
+	}
+}
@@ -42,8 +42,16 @@
 #define IPCID_TO_SEQ(id)	(((id) >> 16) & 0xffff)
 
 /* main.c */
+void update_futex_sub(int);
 void update_sem_sub(int);
 
+/* futex.c */
+int do_futex_wait(message *);
+int do_futex_wake(message *);
+void futex_segment_gone(int);
+int is_futex_nil(void);
+void futex_process_event(endpoint_t, int);
+
 /* shm.c */
 int do_shmget(message *);
 int do_shmat(message *);
@@ -52,6 +60,8 @@ int do_shmctl(message *);
 int get_shm_mib_info(struct rmib_oldp *);
 int is_shm_nil(void);
 void update_refcount_and_destroy(void);
+int shm_read_word(endpoint_t, int, vir_bytes, unsigned int *);
+int shm_write_word(int, vir_bytes, unsigned int);
 
 /* sem.c */
 int do_semget(message *);
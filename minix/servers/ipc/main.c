@@ -1,6 +1,7 @@
 #include "inc.h"
 
 #define SEM_EVENTS	0x01	/* semaphore code wants process events */
+#define FUTEX_EVENTS	0x02	/* futex code wants process events */
 static unsigned int event_mask = 0;
 
 static int verbose = 0;
@@ -17,6 +18,8 @@ static int (* const call_vec[])(message *) = {
 	CALL(IPC_SEMGET)	= do_semget,
 	CALL(IPC_SEMCTL)	= do_semctl,
 	CALL(IPC_SEMOP)		= do_semop,
+	CALL(IPC_FUTEX_WAIT)	= do_futex_wait,
+	CALL(IPC_FUTEX_WAKE)	= do_futex_wake,
 };
 
 /*
@@ -108,7 +111,7 @@ sef_cb_signal_handler(int signo)
 	 * Check if there are still IPC keys around.  If not, we can safely
 	 * exit immediately.  Otherwise, warn the system administrator.
 	 */
-	if (is_sem_nil() && is_shm_nil()) {
+	if (is_sem_nil() && is_shm_nil() && is_futex_nil()) {
 		rmib_deregister(&kern_ipc_node);
 
 		sef_exit(0);
@@ -184,6 +187,21 @@ update_sem_sub(int want_events)
 	update_sub(new_mask);
 }
 
+/*
+ * Update the process event subscription mask for the futex code.
+ */
+void
+update_futex_sub(int want_events)
+{
+	unsigned int new_mask;
+
+	new_mask = event_mask & ~FUTEX_EVENTS;
+	if (want_events)
+		new_mask |= FUTEX_EVENTS;
+
+	update_sub(new_mask);
+}
+
 /*
  * PM sent us a process event message.  Handle it, and reply.
  */
@@ -197,11 +215,14 @@ got_proc_event(message * m)
 	has_exited = (m->m_pm_lsys_proc_event.event == PROC_EVENT_EXIT);
 
 	/*
-	 * Currently, only semaphore handling needs to know about processes
-	 * being signaled and exiting.
+	 * Both the semaphore and the futex code need to know about processes
+	 * being signaled and exiting, so that they can unblock any pending
+	 * calls from those processes.
 	 */
 	if (event_mask & SEM_EVENTS)
 		sem_process_event(endpt, has_exited);
+	if (event_mask & FUTEX_EVENTS)
+		futex_process_event(endpt, has_exited);
 
 	/* Echo the request as a reply back to PM. */
 	m->m_type = PROC_EVENT_REPLY;
@@ -118,8 +118,21 @@ do_shmget(message * m)
 		shm->vm_id = vm_getphys(sef_self(), page);
 
 		assert(i <= shm_list_nr);
-		if (i == shm_list_nr)
+		if (i == shm_list_nr) {
+			/*
+			 * If no segments were allocated before, subscribe to
+			 * process events now, on behalf of the futex code.  A
+			 * futex word always lives in a shared memory segment,
+			 * so no process can block on a futex wait call before
+			 * this point.  Subscribing from a call that cannot
+			 * itself block avoids the signal delivery race
+			 * described in main.c.
+			 */
+			if (shm_list_nr == 0)
+				update_futex_sub(TRUE /*want_events*/);
+
 			shm_list_nr++;
+		}
 	}
 
 	m->m_lc_ipc_shmget.retid = IXSEQ_TO_IPCID(i, shm->shmid_ds.shm_perm);
@@ -188,6 +201,10 @@ update_refcount_and_destroy(void)
 
 		if (shm_list[i].shmid_ds.shm_nattch == 0 &&
 		    (shm_list[i].shmid_ds.shm_perm.mode & SHM_DEST)) {
+			/* Wake up any processes blocked on a word in it. */
+			futex_segment_gone(IXSEQ_TO_IPCID(i,
+			    shm_list[i].shmid_ds.shm_perm));
+
 			munmap((void *)shm_list[i].page,
 			    roundup(shm_list[i].shmid_ds.shm_segsz,
 			    PAGE_SIZE));
@@ -201,8 +218,13 @@ update_refcount_and_destroy(void)
 	 * shm_list_nr again equals the highest in-use slot number plus one.
 	 */
 	while (shm_list_nr > 0 &&
-	    !(shm_list[shm_list_nr - 1].shmid_ds.shm_perm.mode & SHM_ALLOC))
+	    !(shm_list[shm_list_nr - 1].shmid_ds.shm_perm.mode & SHM_ALLOC)) {
 		shm_list_nr--;
+
+		/* If the last segment is gone, stop getting process events. */
+		if (shm_list_nr == 0)
+			update_futex_sub(FALSE /*want_events*/);
+	}
 }
 
 int
@@ -461,6 +483,62 @@ list_shm_ds(void)
 }
 #endif
 
+/*
+ * Read the current value of a 32-bit word in a shared memory segment, on
+ * behalf of the futex code.  The word is identified by the segment identifier
+ * and a byte offset into the segment; since we have the segment mapped into
+ * our own address space, we can simply read the word from our own mapping.
+ * Return OK, with the value stored in 'valuep', on success.  Return EINVAL if
+ * the segment identifier is invalid or the offset does not name a properly
+ * aligned word within the segment, or EACCES if the given caller has no read
+ * permission on the segment.
+ */
+int
+shm_read_word(endpoint_t who, int id, vir_bytes offset, unsigned int * valuep)
+{
+	struct shm_struct *shm;
+
+	if ((shm = shm_find_id(id)) == NULL)
+		return EINVAL;
+
+	if (!check_perm(&shm->shmid_ds.shm_perm, who, IPC_R))
+		return EACCES;
+
+	if (offset % sizeof(*valuep) != 0)
+		return EINVAL;
+	if (offset >= shm->shmid_ds.shm_segsz ||
+	    shm->shmid_ds.shm_segsz - offset < sizeof(*valuep))
+		return EINVAL;
+
+	*valuep = *(volatile unsigned int *)(shm->page + offset);
+	return OK;
+}
+
+/*
+ * Write a new value into a 32-bit word in a shared memory segment, again on
+ * behalf of the futex code, which uses this to put robust mutexes in the
+ * owner-died state.  This is a server-initiated write, so unlike for
+ * shm_read_word there is no calling process whose permissions are to be
+ * checked.  Return OK or EINVAL, as for shm_read_word.
+ */
+int
+shm_write_word(int id, vir_bytes offset, unsigned int value)
+{
+	struct shm_struct *shm;
+
+	if ((shm = shm_find_id(id)) == NULL)
+		return EINVAL;
+
+	if (offset % sizeof(value) != 0)
+		return EINVAL;
+	if (offset >= shm->shmid_ds.shm_segsz ||
+	    shm->shmid_ds.shm_segsz - offset < sizeof(value))
+		return EINVAL;
+
+	*(volatile unsigned int *)(shm->page + offset) = value;
+	return OK;
+}
+
 int
 is_shm_nil(void)
 {
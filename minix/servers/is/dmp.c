@@ -32,6 +32,9 @@ struct hook_entry {
 	{ SF6,	rproc_dmp, "Reincarnation server process table" },
 	{ SF8,  data_store_dmp, "Data store contents" },
 	{ SF9,  procstack_dmp, "Processes with stack traces" },
+	{ SF10, ipctrace_dmp, "IPC trace (toggle and dump)" },
+	{ SF11, sef_stats_dmp, "SEF statistics (toggle and dump)" },
+	{ SF12, lockstats_dmp, "Lock statistics (toggle and dump)" },
 };
 
 /* Define hooks for the debugging dumps. This table maps function keys
@@ -130,3 +133,83 @@ void mapping_dmp(void)
       printf(" %10s.  %s\n", key_name(hooks[h].key), hooks[h].name);
   printf("\n");
 }
+
+/*===========================================================================*
+ *				sef_stats_dmp				     *
+ *===========================================================================*/
+void sef_stats_dmp(void)
+{
+/* Toggle SEF service time statistics. The first press enables collection in
+ * a fixed set of servers; the next press retrieves and prints the tables and
+ * disables collection again. Service times are printed as the log2 of the
+ * elapsed time stamp counter cycles; p50 and p99 are the buckets holding the
+ * 50th and 99th percentile of the messages of that type.
+ */
+  static struct sef_stats stats;
+  static int collecting = 0;
+  static struct {
+	endpoint_t endpoint;
+	const char *name;
+  } targets[] = {
+	{ PM_PROC_NR, "pm" },
+	{ VFS_PROC_NR, "vfs" },
+	{ VM_PROC_NR, "vm" },
+	{ RS_PROC_NR, "rs" },
+	{ DS_PROC_NR, "ds" },
+  };
+  struct sef_stats_slot *slot;
+  unsigned int t, i, b, p50, p99;
+  u32_t seen;
+  int r;
+
+  if (!collecting) {
+	for (t = 0; t < sizeof(targets)/sizeof(targets[0]); t++) {
+		r = sef_stats_request(targets[t].endpoint, SEF_STATS_ENABLE,
+			NULL);
+		if (r != OK)
+			printf("IS: warning: couldn't enable SEF stats for "
+				"%s: %d\n", targets[t].name, r);
+	}
+	collecting = 1;
+	printf("SEF statistics collection started; press again to dump\n");
+	return;
+  }
+
+  collecting = 0;
+
+  for (t = 0; t < sizeof(targets)/sizeof(targets[0]); t++) {
+	r = sef_stats_request(targets[t].endpoint, SEF_STATS_RETRIEVE,
+		&stats);
+	if (r != OK) {
+		printf("IS: warning: couldn't get SEF stats of %s: %d\n",
+			targets[t].name, r);
+		continue;
+	}
+	sef_stats_request(targets[t].endpoint, SEF_STATS_DISABLE, NULL);
+
+	printf("%s: %u messages handled, %u of untracked types\n",
+		targets[t].name, stats.st_total, stats.st_untracked);
+	if (stats.st_total == 0) continue;
+	printf("--type--  --count--  -p50-  -p99-  (log2 TSC cycles)\n");
+
+	for (i = 0; i < SEF_STATS_SLOTS; i++) {
+		slot = &stats.st_slot[i];
+		if (slot->ss_type == 0 || slot->ss_count == 0) continue;
+
+		p50 = p99 = 0;
+		seen = 0;
+		for (b = 0; b < SEF_STATS_BUCKETS; b++) {
+			seen += slot->ss_bucket[b];
+			if (p50 == 0 && 2 * seen >= slot->ss_count)
+				p50 = b;
+			if (100 * seen >= 99 * slot->ss_count) {
+				p99 = b;
+				break;
+			}
+		}
+
+		printf("0x%06x  %9u  %5u  %5u\n", (unsigned) slot->ss_type,
+			slot->ss_count, p50, p99);
+	}
+  }
+}
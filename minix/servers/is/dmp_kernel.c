@@ -379,6 +379,151 @@ procstack_dmp(void)
   }
 }
 
+/*===========================================================================*
+ *				ipctrace_dmp 				     *
+ *===========================================================================*/
+void
+ipctrace_dmp(void)
+{
+/* Toggle IPC tracing. The first press starts a trace run; the next press
+ * stops it, extracts every CPU's trace ring from the kernel and prints the
+ * most recent message deliveries. The time stamps are raw time stamp counter
+ * values, which is enough to order the entries.
+ */
+  static struct ipc_trace_ring ring;	/* copy of one kernel ring */
+  static int tracing = 0;
+  struct machine mach;
+  struct ipc_trace_entry *ite;
+  unsigned int cpu, count, i;
+  int r;
+
+  if (!tracing) {
+	if ((r = sys_diagctl_ipctrace(1)) != OK) {
+		printf("IS: warning: couldn't start IPC tracing: %d\n", r);
+		return;
+	}
+	tracing = 1;
+	printf("IPC tracing started; press again to dump and stop\n");
+	return;
+  }
+
+  sys_diagctl_ipctrace(0);
+  tracing = 0;
+
+  /* Obtain the machine information to learn the number of CPUs, and a fresh
+   * copy of the process table so the endpoints can be given names.
+   */
+  if ((r = sys_getmachine(&mach)) != OK) {
+	printf("IS: warning: couldn't get machine information: %d\n", r);
+	return;
+  }
+  if ((r = sys_getproctab(proc)) != OK) {
+	printf("IS: warning: couldn't get copy of process table: %d\n", r);
+	return;
+  }
+
+  for (cpu = 0; cpu < mach.processors_count; cpu++) {
+	if ((r = sys_getipctrace(&ring, cpu)) != OK) {
+		printf("IS: warning: couldn't get IPC trace of cpu %u: %d\n",
+			cpu, r);
+		continue;
+	}
+
+	count = ring.itr_head < IPC_TRACE_ENTRIES ?
+		ring.itr_head : IPC_TRACE_ENTRIES;
+	printf("CPU %u: %u deliveries logged, %u kept\n", cpu,
+		ring.itr_head, count);
+	if (count == 0) continue;
+	if (count > LINES) count = LINES;	/* newest screenful only */
+
+	printf("---------tsc--------  ---source---  ----dest----  -type-\n");
+	for (i = ring.itr_head - count; i != ring.itr_head; i++) {
+		ite = &ring.itr_ent[i % IPC_TRACE_ENTRIES];
+		printf("0x%08lx%08lx  %-7.7s %5d  %-7.7s %5d  %6d\n",
+			(unsigned long) ex64hi(ite->ite_tsc),
+			(unsigned long) ex64lo(ite->ite_tsc),
+			proc_name(_ENDPOINT_P(ite->ite_src)), ite->ite_src,
+			proc_name(_ENDPOINT_P(ite->ite_dst)), ite->ite_dst,
+			ite->ite_type);
+	}
+  }
+}
+
+/*===========================================================================*
+ *				lockstats_dmp 				     *
+ *===========================================================================*/
+void
+lockstats_dmp(void)
+{
+/* Toggle kernel lock statistics. The first press starts a measuring run; the
+ * next press stops it, extracts the per-lock counters from the kernel and
+ * prints them. Spin and hold times are raw time stamp counter cycles. Only
+ * SMP kernels collect these statistics.
+ */
+  static struct lock_stat stats[NR_LOCK_STATS];
+  static int collecting = 0;
+  int r, i;
+
+  if (!collecting) {
+	if ((r = sys_diagctl_lockstats(1)) != OK) {
+		printf("IS: warning: couldn't start lock statistics: %d\n", r);
+		return;
+	}
+	collecting = 1;
+	printf("Lock statistics started; press again to dump and stop\n");
+	return;
+  }
+
+  sys_diagctl_lockstats(0);
+  collecting = 0;
+
+  if ((r = sys_getlockstats(stats)) != OK) {
+	printf("IS: warning: couldn't get lock statistics: %d\n", r);
+	return;
+  }
+
+  printf("------lock------  --acquisitions--  ---spin cycles--  ---hold cycles--\n");
+  for (i = 0; i < NR_LOCK_STATS; i++) {
+	printf("%-16.16s  %16llu  %16llu  %16llu\n",
+		stats[i].ls_name,
+		(unsigned long long) stats[i].ls_acquisitions,
+		(unsigned long long) stats[i].ls_spin_cycles,
+		(unsigned long long) stats[i].ls_hold_cycles);
+  }
+}
+
+/*===========================================================================*
+ *				do_getsysinfo				     *
+ *===========================================================================*/
+int
+do_getsysinfo(message *m_ptr)
+{
+/* Copy out a raw snapshot of one of the tables kept here. This lets
+ * monitoring tools sample system state programmatically, instead of scraping
+ * the formatted console dumps that the function keys produce.
+ */
+  vir_bytes src_addr;
+  size_t len;
+  int r;
+
+  switch (m_ptr->m_lsys_getsysinfo.what) {
+  case SI_KPROC_TAB:		/* copy of the kernel process table */
+	if ((r = sys_getproctab(proc)) != OK)
+		return r;
+	src_addr = (vir_bytes) proc;
+	len = sizeof(proc);
+	break;
+  default:
+	return(EINVAL);
+  }
+
+  if (len != m_ptr->m_lsys_getsysinfo.size)
+	return(EINVAL);
+
+  return sys_datacopy(SELF, src_addr, m_ptr->m_source,
+	m_ptr->m_lsys_getsysinfo.where, len);
+}
+
 /*===========================================================================*
  *				proc_name    				     *
  *===========================================================================*/
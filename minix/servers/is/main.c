@@ -57,9 +57,16 @@ int main(int argc, char **argv)
 	      }
       }
       else {
-          printf("IS: warning, got illegal request %d from %d\n",
-          	callnr, m_in.m_source);
-          result = EDONTREPLY;
+	      switch (callnr) {
+		      case IS_GETSYSINFO:
+			      result = do_getsysinfo(&m_in);
+			      break;
+		      default:
+			      printf("IS: warning, got illegal request %d from %d\n",
+				      callnr, m_in.m_source);
+			      result = EDONTREPLY;
+			      break;
+	      }
       }
 
       /* Finally send reply message, unless disabled. */
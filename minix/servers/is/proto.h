@@ -8,6 +8,7 @@ void map_unmap_fkeys(int map);
 int do_fkey_pressed(message *m);
 void mapping_dmp(void);
 void vm_dmp(void);
+void sef_stats_dmp(void);
 
 /* dmp_kernel.c */
 void proctab_dmp(void);
@@ -18,6 +19,9 @@ void irqtab_dmp(void);
 void kmessages_dmp(void);
 void monparams_dmp(void);
 void kenv_dmp(void);
+void ipctrace_dmp(void);
+void lockstats_dmp(void);
+int do_getsysinfo(message *m_ptr);
 
 /* dmp_pm.c */
 void mproc_dmp(void);
@@ -380,6 +380,8 @@ ssize_t mib_minix_proc_list(struct mib_call *, struct mib_node *,
 	struct mib_oldp *, struct mib_newp *);
 ssize_t mib_minix_proc_data(struct mib_call *, struct mib_node *,
 	struct mib_oldp *, struct mib_newp *);
+ssize_t mib_minix_proc_tab(struct mib_call *, struct mib_node *,
+	struct mib_oldp *, struct mib_newp *);
 
 /* subtree modules */
 void mib_kern_init(struct mib_node *);
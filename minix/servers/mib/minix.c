@@ -63,6 +63,9 @@ static struct mib_node mib_minix_proc_table[] = {
 /* 2*/	[PROC_DATA]		= MIB_FUNC(_P | _RO | CTLTYPE_NODE, 0,
 				    mib_minix_proc_data, "data",
 				    "Process data"),
+/* 3*/	[PROC_TAB]		= MIB_FUNC(_P | _RO | CTLTYPE_STRUCT, 0,
+				    mib_minix_proc_tab, "tab",
+				    "Full process table"),
 };
 
 static struct mib_node mib_minix_table[] = {
@@ -76,6 +79,10 @@ static struct mib_node mib_minix_table[] = {
 /* 2*/	[MINIX_PROC]		= MIB_NODE(_P | _RO, mib_minix_proc_table,
 				    "proc", "Process information for ProcFS"),
 /* 3*/	/* MINIX_LWIP is mounted through RMIB and thus not present here. */
+/* 4*/	[MINIX_FS]		= MIB_ENODE(_P | _RO, "fs", "Per-mount file "
+				    "system statistics, mounted through RMIB "
+				    "by file servers"),
+/* 5*/	/* MINIX_RS is mounted through RMIB and thus not present here. */
 };
 
 /*
@@ -1210,6 +1210,50 @@ mib_minix_proc_list(struct mib_call * call __unused,
 	return mib_copyout(oldp, 0, &mpl, sizeof(mpl));
 }
 
+/*
+ * Fill the given minix_proc_data structure for the process in the given
+ * kernel slot, using the corresponding PM slot, or NO_SLOT for kernel tasks.
+ * The caller must have updated the local copies of the tables already.
+ */
+static void
+fill_proc_data(struct minix_proc_data * mpd, int kslot, int mslot)
+{
+	struct proc *kp;
+	unsigned int mflags;
+
+	kp = &proc_tab[kslot];
+
+	mflags = (mslot != NO_SLOT) ? mproc_tab[mslot].mp_flags : 0;
+
+	memset(mpd, 0, sizeof(*mpd));
+	mpd->mpd_endpoint = kp->p_endpoint;
+	if (mflags & PRIV_PROC)
+		mpd->mpd_flags |= MPDF_SYSTEM;
+	if (mflags & (TRACE_ZOMBIE | ZOMBIE))
+		mpd->mpd_flags |= MPDF_ZOMBIE;
+	else if ((mflags & TRACE_STOPPED) || RTS_ISSET(kp, RTS_P_STOP))
+		mpd->mpd_flags |= MPDF_STOPPED;
+	else if (proc_is_runnable(kp))
+		mpd->mpd_flags |= MPDF_RUNNABLE;
+	mpd->mpd_blocked_on = P_BLOCKEDON(kp);
+	mpd->mpd_priority = kp->p_priority;
+	mpd->mpd_user_time = kp->p_user_time;
+	mpd->mpd_sys_time = kp->p_sys_time;
+	mpd->mpd_cycles = kp->p_cycles;
+	mpd->mpd_kipc_cycles = kp->p_kipc_cycles;
+	mpd->mpd_kcall_cycles = kp->p_kcall_cycles;
+	if (mslot != NO_SLOT) {
+		mpd->mpd_pid = mproc_tab[mslot].mp_pid;
+		mpd->mpd_nice = mproc_tab[mslot].mp_nice;
+		mpd->mpd_uid = mproc_tab[mslot].mp_effuid;
+		strlcpy(mpd->mpd_name, mproc_tab[mslot].mp_name,
+		    sizeof(mpd->mpd_name));
+	} else {
+		mpd->mpd_pid = kslot - NR_TASKS; /* ProcFS task "PID" */
+		strlcpy(mpd->mpd_name, kp->p_name, sizeof(mpd->mpd_name));
+	}
+}
+
 /*
  * Implementation of CTL_MINIX MINIX_PROC PROC_DATA.
  */
@@ -1218,9 +1262,7 @@ mib_minix_proc_data(struct mib_call * call, struct mib_node * node __unused,
 	struct mib_oldp * oldp, struct mib_newp * newp __unused)
 {
 	struct minix_proc_data mpd;
-	struct proc *kp;
-	int kslot, mslot = 0;
-	unsigned int mflags;
+	int kslot, mslot = NO_SLOT;
 	pid_t pid;
 
 	/*
@@ -1256,33 +1298,47 @@ mib_minix_proc_data(struct mib_call * call, struct mib_node * node __unused,
 	if (oldp == NULL)
 		return sizeof(mpd);
 
-	kp = &proc_tab[kslot];
+	fill_proc_data(&mpd, kslot, mslot);
 
-	mflags = (pid > 0) ? mproc_tab[mslot].mp_flags : 0;
+	return mib_copyout(oldp, 0, &mpd, sizeof(mpd));
+}
 
-	memset(&mpd, 0, sizeof(mpd));
-	mpd.mpd_endpoint = kp->p_endpoint;
-	if (mflags & PRIV_PROC)
-		mpd.mpd_flags |= MPDF_SYSTEM;
-	if (mflags & (TRACE_ZOMBIE | ZOMBIE))
-		mpd.mpd_flags |= MPDF_ZOMBIE;
-	else if ((mflags & TRACE_STOPPED) || RTS_ISSET(kp, RTS_P_STOP))
-		mpd.mpd_flags |= MPDF_STOPPED;
-	else if (proc_is_runnable(kp))
-		mpd.mpd_flags |= MPDF_RUNNABLE;
-	mpd.mpd_blocked_on = P_BLOCKEDON(kp);
-	mpd.mpd_priority = kp->p_priority;
-	mpd.mpd_user_time = kp->p_user_time;
-	mpd.mpd_sys_time = kp->p_sys_time;
-	mpd.mpd_cycles = kp->p_cycles;
-	mpd.mpd_kipc_cycles = kp->p_kipc_cycles;
-	mpd.mpd_kcall_cycles = kp->p_kcall_cycles;
-	if (kslot >= NR_TASKS) {
-		mpd.mpd_nice = mproc_tab[mslot].mp_nice;
-		strlcpy(mpd.mpd_name, mproc_tab[mslot].mp_name,
-		    sizeof(mpd.mpd_name));
-	} else
-		strlcpy(mpd.mpd_name, kp->p_name, sizeof(mpd.mpd_name));
+/*
+ * Implementation of CTL_MINIX MINIX_PROC PROC_TAB.
+ */
+ssize_t
+mib_minix_proc_tab(struct mib_call * call __unused,
+	struct mib_node * node __unused, struct mib_oldp * oldp,
+	struct mib_newp * newp __unused)
+{
+	/* The full table is too large to allocate on the stack. */
+	static struct minix_proc_data mpd[NR_TASKS + NR_PROCS];
+	unsigned int mslot;
+	int kslot;
 
-	return mib_copyout(oldp, 0, &mpd, sizeof(mpd));
+	if (oldp == NULL)
+		return sizeof(mpd);
+
+	if (!update_tables())
+		return EINVAL;
+
+	/* The kernel tasks are always present. */
+	for (kslot = 0; kslot < NR_TASKS; kslot++)
+		fill_proc_data(&mpd[kslot], kslot, NO_SLOT);
+
+	/* For the user processes, mark unused slots as free. */
+	for (mslot = 0; mslot < NR_PROCS; mslot++) {
+		kslot = NR_TASKS + mslot;
+
+		if (!(mproc_tab[mslot].mp_flags & IN_USE) ||
+		    mproc_tab[mslot].mp_pid <= 0) {
+			memset(&mpd[kslot], 0, sizeof(mpd[kslot]));
+			mpd[kslot].mpd_endpoint = NONE;
+			continue;
+		}
+
+		fill_proc_data(&mpd[kslot], kslot, mslot);
+	}
+
+	return mib_copyout(oldp, 0, mpd, sizeof(mpd));
 }
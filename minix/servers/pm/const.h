@@ -10,7 +10,10 @@
 
 #define NO_TRACER	   0	/* process is not being traced */
 
-#define NO_EVENTSUB	((char)-1) /* no current process event subscriber */
+#define NO_PROC		  -1	/* 'mproc' slot number indicating no process */
+
+#define PID_HASH_SIZE	 256	/* buckets in the ID hash tables, power of 2 */
+#define PID_HASH(pid)	((pid) & (PID_HASH_SIZE - 1))
 
 #define MAX_SECS	( (clock_t) (TMRDIFF_MAX/system_hz) )
 				/* max.secs for setitimer() ((2^31-1)/HZ) */
@@ -8,21 +8,20 @@
  * that uses this facility is the System V IPC server.
  *
  * Each of these events will be published to subscribing services right after
- * VFS has acknowledged that it has processed the same event.  For each
- * subscriber, in turn, the process will be blocked (with the EVENT_CALL flag
- * set) until the subscriber acknowledges the event or PM learns that the
- * subscriber has died.  Thus, each subscriber adds a serialized messaging
- * roundtrip for each subscribed event.
+ * VFS has acknowledged that it has processed the same event.  All interested
+ * subscribers are notified at once, and the process will be blocked (with the
+ * EVENT_CALL flag set) until every notified subscriber has acknowledged the
+ * event or PM has learned that the subscriber died.  Thus, a slow subscriber
+ * delays the affected process by at most one messaging roundtrip, rather than
+ * adding its roundtrip to those of the other subscribers.
  *
- * The one and only reason for this synchronous, serialized approach is that it
- * avoids PM queuing up too many asynchronous messages.  In theory, each
- * running process may have an event pending, and thus, the serial synchronous
- * approach requires NR_PROCS asynsend slots.  For a parallel synchronous
- * approach, this would increase to (NR_PROCS*NR_SUBS).  Worse yet, for an
- * asynchronous event notification approach, the number of messages that PM can
- * end up queuing is potentially unbounded, so that is certainly not an option.
- * At this moment, we expect only one subscriber (the IPC server) which makes
- * the serial vs parallel point less relevant.
+ * The number of asynchronous messages that PM can end up queuing this way is
+ * bounded by (NR_PROCS*NR_SUBS): in theory, each running process may have an
+ * event pending with each subscriber.  This is the reason that NR_SUBS must
+ * remain small.  A fully asynchronous event notification approach would have
+ * no bound on the number of queued messages at all, so that is certainly not
+ * an option.  At this moment, we expect only one subscriber (the IPC server)
+ * which makes the bound a non-issue in practice.
  *
  * It is not possible to subscribe to events from certain processes only.  If
  * a service were to subscribe to process events as part of a system call by
@@ -51,9 +50,8 @@
 
 /*
  * A realistic upper bound for the number of subscribing services.  The process
- * event notification system adds a round trip to a service for each subscriber
- * and uses asynchronous messaging to boot, so clearly it does not scale to
- * numbers larger than this.
+ * event notification system may queue an asynchronous message per process for
+ * each subscriber, so clearly it does not scale to numbers larger than this.
  */
 #define NR_SUBS		4
 
@@ -67,20 +65,18 @@ static unsigned int nsubs = 0;
 static unsigned int nested = 0;
 
 /*
- * For the current event of the given process, as determined by its flags, send
- * a process event message to the next subscriber, or resume handling the
- * event itself if there are no more subscribers to notify.
+ * All subscribers that were notified of the current event of the given
+ * process, as determined by its flags, have acknowledged the event.  Resume
+ * handling the event itself.
  */
 static void
 resume_event(struct mproc * rmp)
 {
-	message m;
-	unsigned int i, event;
-	int r;
+	unsigned int event;
 
 	assert(rmp->mp_flags & IN_USE);
 	assert(rmp->mp_flags & EVENT_CALL);
-	assert(rmp->mp_eventsub != NO_EVENTSUB);
+	assert(rmp->mp_eventwait == 0);
 
 	/* Which event should we be concerned about? */
 	if (rmp->mp_flags & EXITING)
@@ -90,31 +86,7 @@ resume_event(struct mproc * rmp)
 	else
 		panic("unknown event for flags %x", rmp->mp_flags);
 
-	/*
-	 * If there are additional services interested in this event, send a
-	 * message to the next one.
-	 */
-	for (i = rmp->mp_eventsub; i < nsubs; i++, rmp->mp_eventsub++) {
-		if (subs[i].mask & event) {
-			memset(&m, 0, sizeof(m));
-			m.m_type = PROC_EVENT;
-			m.m_pm_lsys_proc_event.endpt = rmp->mp_endpoint;
-			m.m_pm_lsys_proc_event.event = event;
-
-			r = asynsend3(subs[i].endpt, &m, AMF_NOREPLY);
-			if (r != OK)
-				panic("asynsend failed: %d", r);
-
-			assert(subs[i].waiting < NR_PROCS);
-			subs[i].waiting++;
-
-			return;
-		}
-	}
-
-	/* No more subscribers to be notified, resume the actual event. */
 	rmp->mp_flags &= ~EVENT_CALL;
-	rmp->mp_eventsub = NO_EVENTSUB;
 
 	if (event == PROC_EVENT_EXIT)
 		exit_restart(rmp);
@@ -131,19 +103,26 @@ static void
 remove_sub(unsigned int slot)
 {
 	struct mproc *rmp;
-	unsigned int i;
+	unsigned int i, low, high;
 
-	/* The loop below needs the remaining items to be kept in order. */
+	/* The bitmask update below needs the remaining items kept in order. */
 	for (i = slot; i < nsubs - 1; i++)
 		subs[i] = subs[i + 1];
 	nsubs--;
 
-	/* Adjust affected processes' event subscriber indexes to match. */
+	/*
+	 * Adjust affected processes' wait bitmasks to match: the removed
+	 * subscriber will never acknowledge, so clear its bit, and shift the
+	 * bits for the higher slots down by one position.
+	 */
 	for (rmp = &mproc[0]; rmp < &mproc[NR_PROCS]; rmp++) {
 		if ((rmp->mp_flags & (IN_USE | EVENT_CALL)) !=
 		    (IN_USE | EVENT_CALL))
 			continue;
-		assert(rmp->mp_eventsub != NO_EVENTSUB);
+
+		low = rmp->mp_eventwait & ((1U << slot) - 1);
+		high = ((unsigned int)rmp->mp_eventwait >> (slot + 1)) << slot;
+		rmp->mp_eventwait = low | high;
 
 		/*
 		 * While resuming a process could trigger new events, event
@@ -151,12 +130,11 @@ remove_sub(unsigned int slot)
 		 * making this nesting-safe.  Check anyway, because if nesting
 		 * does occur, we are in serious (un-debuggable) trouble.
 		 */
-		if ((unsigned int)rmp->mp_eventsub == slot) {
+		if (rmp->mp_eventwait == 0) {
 			nested++;
 			resume_event(rmp);
 			nested--;
-		} else if ((unsigned int)rmp->mp_eventsub > slot)
-			rmp->mp_eventsub--;
+		}
 	}
 }
 
@@ -249,16 +227,17 @@ do_proc_event_reply(void)
 		    who_e, endpt);
 		return SUSPEND;
 	}
-	if (rmp->mp_eventsub == NO_EVENTSUB ||
-	    (unsigned int)rmp->mp_eventsub >= nsubs) {
-		printf("PM: proc event reply from %d for endpt %d index %d\n",
-		    who_e, endpt, rmp->mp_eventsub);
+	for (i = 0; i < nsubs; i++)
+		if (subs[i].endpt == who_e)
+			break;
+	if (i == nsubs) {
+		printf("PM: proc event reply from non-subscriber %d for %d\n",
+		    who_e, endpt);
 		return SUSPEND;
 	}
-	i = rmp->mp_eventsub;
-	if (subs[i].endpt != who_e) {
-		printf("PM: proc event reply for %d from %d instead of %d\n",
-		    endpt, who_e, subs[i].endpt);
+	if (!(rmp->mp_eventwait & (1U << i))) {
+		printf("PM: proc event reply from %d for endpt %d, "
+		    "not waiting for it\n", who_e, endpt);
 		return SUSPEND;
 	}
 
@@ -289,18 +268,18 @@ do_proc_event_reply(void)
 	assert(subs[i].waiting > 0);
 	subs[i].waiting--;
 
+	rmp->mp_eventwait &= ~(1U << i);
+
 	/*
 	 * If we are now no longer waiting for any replies from an already
 	 * unsubscribed (but alive) service, remove it from the set now; this
 	 * will also resume events for the current process.  In the normal case
-	 * however, let the current process move on to the next subscriber if
-	 * there are more, and the actual event otherwise.
+	 * however, resume the actual event once the last outstanding
+	 * acknowledgment for it has come in.
 	 */
 	if (subs[i].mask == 0 && subs[i].waiting == 0) {
 		remove_sub(i);
-	} else {
-		rmp->mp_eventsub++;
-
+	} else if (rmp->mp_eventwait == 0) {
 		resume_event(rmp);
 	}
 
@@ -316,11 +295,13 @@ do_proc_event_reply(void)
 void
 publish_event(struct mproc * rmp)
 {
-	unsigned int i;
+	message m;
+	unsigned int i, event;
+	int r;
 
 	assert(nested == 0);
 	assert((rmp->mp_flags & (IN_USE | EVENT_CALL)) == IN_USE);
-	assert(rmp->mp_eventsub == NO_EVENTSUB);
+	assert(rmp->mp_eventwait == 0);
 
 	/*
 	 * If a system service exited, we have to check if it was subscribed to
@@ -342,12 +323,40 @@ publish_event(struct mproc * rmp)
 		}
 	}
 
+	/* Which event should we be concerned about? */
+	if (rmp->mp_flags & EXITING)
+		event = PROC_EVENT_EXIT;
+	else if (rmp->mp_flags & UNPAUSED)
+		event = PROC_EVENT_SIGNAL;
+	else
+		panic("unknown event for flags %x", rmp->mp_flags);
+
 	/*
-	 * Either send an event message to the first subscriber, or if there
-	 * are no subscribers, resume processing the event right away.
+	 * Send an event message to all interested subscribers at once, and
+	 * block the process until each of them has acknowledged the event.
+	 * If no subscriber is interested, resume the event right away.
 	 */
 	rmp->mp_flags |= EVENT_CALL;
-	rmp->mp_eventsub = 0;
 
-	resume_event(rmp);
+	for (i = 0; i < nsubs; i++) {
+		if (!(subs[i].mask & event))
+			continue;
+
+		memset(&m, 0, sizeof(m));
+		m.m_type = PROC_EVENT;
+		m.m_pm_lsys_proc_event.endpt = rmp->mp_endpoint;
+		m.m_pm_lsys_proc_event.event = event;
+
+		r = asynsend3(subs[i].endpt, &m, AMF_NOREPLY);
+		if (r != OK)
+			panic("asynsend failed: %d", r);
+
+		assert(subs[i].waiting < NR_PROCS);
+		subs[i].waiting++;
+
+		rmp->mp_eventwait |= 1U << i;
+	}
+
+	if (rmp->mp_eventwait == 0)
+		resume_event(rmp);
 }
@@ -172,6 +172,11 @@ void exec_restart(struct mproc *rmp, int result, vir_bytes pc, vir_bytes sp,
 
 	rmp->mp_flags &= ~PARTIAL_EXEC;
 
+	/* If this process was created with vfork, the successful exec ends
+	 * the vfork window: wake up the blocked parent.
+	 */
+	vfork_done(rmp);
+
 	/* Fix 'mproc' fields, tell kernel that exec is done, reset caught
 	 * sigs.
 	 */
@@ -8,8 +8,9 @@
  * WAIT4.
  *
  * The entry points into this file are:
- *   do_fork:		perform the FORK system call
+ *   do_fork:		perform the FORK system call (also used for VFORK)
  *   do_srv_fork:	special FORK, used by RS to create sys services
+ *   vfork_done:	wake up the parent of a vfork child on exec or exit
  *   do_exit:		perform the EXIT system call (by calling exit_proc())
  *   exit_proc:		actually do the exiting, and tell VFS about it
  *   exit_restart:	continue exiting a process after VFS has replied
@@ -88,11 +89,16 @@ do_fork(void)
   rmc->mp_sigact = mpsigact[next_child];	/* restore mp_sigact ptr */
   memcpy(rmc->mp_sigact, rmp->mp_sigact, sizeof(mpsigact[next_child]));
   rmc->mp_parent = who_p;			/* record child's parent */
+  rmc->mp_child = rmc->mp_zombie = NO_PROC;	/* child has no children yet */
+  rmc->mp_zombie_next = NO_PROC;
+  attach_child(rmc);				/* link into parent's list */
+  attach_pgrp(rmc);				/* inherited process group */
   if (!(rmc->mp_trace_flags & TO_TRACEFORK)) {
 	rmc->mp_tracer = NO_TRACER;		/* no tracer attached */
 	rmc->mp_trace_flags = 0;
 	(void) sigemptyset(&rmc->mp_sigtrace);
-  }
+  } else if (rmc->mp_tracer != NO_TRACER)
+	num_traced++;				/* child inherits the tracer */
 
   /* Some system servers like to call regular fork, such as RS spawning
    * recovery scripts; in this case PM will take care of their scheduling
@@ -104,6 +110,20 @@ do_fork(void)
 
   /* Inherit only these flags. In normal fork(), PRIV_PROC is not inherited. */
   rmc->mp_flags &= (IN_USE|DELAY_CALL|TAINTED);
+
+  /* For vfork, the parent stays blocked until the child execs or exits.  The
+   * child's address space is still a (copy-on-write) copy of the parent's;
+   * blocking the parent merely keeps it from competing with the child, which
+   * is expected to perform an exec right away.  Mark the parent as well, so
+   * that sig_proc() defers all signal delivery to it for the duration: the
+   * parent is blocked in the middle of a sendrec(2), and setting up a signal
+   * handler for it now would cause the subsequent sigreturn(2) to clobber the
+   * vfork call's return value.
+   */
+  if (call_nr == PM_VFORK) {
+	rmc->mp_flags |= VFORK_CHILD;
+	rmp->mp_flags |= VFORK_WAIT;
+  }
   rmc->mp_child_utime = 0;		/* reset administration */
   rmc->mp_child_stime = 0;		/* reset administration */
   rmc->mp_exitstatus = 0;
@@ -113,11 +133,12 @@ do_fork(void)
 	rmc->mp_interval[i] = 0;	/* reset timer intervals */
   rmc->mp_started = getticks();		/* remember start time, for ps(1) */
 
-  assert(rmc->mp_eventsub == NO_EVENTSUB);
+  assert(rmc->mp_eventwait == 0);
 
   /* Find a free pid for the child and put it in the table. */
   new_pid = get_free_pid();
   rmc->mp_pid = new_pid;	/* assign pid to child */
+  attach_pid(rmc);		/* make the pid findable */
 
   memset(&m, 0, sizeof(m));
   m.m_type = VFS_PM_FORK;
@@ -191,11 +212,16 @@ do_srv_fork(void)
   rmc->mp_sigact = mpsigact[next_child];	/* restore mp_sigact ptr */
   memcpy(rmc->mp_sigact, rmp->mp_sigact, sizeof(mpsigact[next_child]));
   rmc->mp_parent = who_p;			/* record child's parent */
+  rmc->mp_child = rmc->mp_zombie = NO_PROC;	/* child has no children yet */
+  rmc->mp_zombie_next = NO_PROC;
+  attach_child(rmc);				/* link into parent's list */
+  attach_pgrp(rmc);				/* inherited process group */
   if (!(rmc->mp_trace_flags & TO_TRACEFORK)) {
 	rmc->mp_tracer = NO_TRACER;		/* no tracer attached */
 	rmc->mp_trace_flags = 0;
 	(void) sigemptyset(&rmc->mp_sigtrace);
-  }
+  } else if (rmc->mp_tracer != NO_TRACER)
+	num_traced++;				/* child inherits the tracer */
   /* inherit only these flags */
   rmc->mp_flags &= (IN_USE|PRIV_PROC|DELAY_CALL);
   rmc->mp_child_utime = 0;		/* reset administration */
@@ -213,11 +239,12 @@ do_srv_fork(void)
 	rmc->mp_interval[i] = 0;	/* reset timer intervals */
   rmc->mp_started = getticks();		/* remember start time, for ps(1) */
 
-  assert(rmc->mp_eventsub == NO_EVENTSUB);
+  assert(rmc->mp_eventwait == 0);
 
   /* Find a free pid for the child and put it in the table. */
   new_pid = get_free_pid();
   rmc->mp_pid = new_pid;	/* assign pid to child */
+  attach_pid(rmc);		/* make the pid findable */
 
   memset(&m, 0, sizeof(m));
   m.m_type = VFS_PM_SRV_FORK;
@@ -239,6 +266,37 @@ do_srv_fork(void)
   return rmc->mp_pid;
 }
 
+/*===========================================================================*
+ *				vfork_done				     *
+ *===========================================================================*/
+void
+vfork_done(struct mproc *rmp)
+{
+/* The given process was created with vfork, and has now performed a
+ * successful exec or is exiting.  Wake up its parent, which has been blocked
+ * on the vfork call since the child was created.
+ */
+  struct mproc *parent;
+
+  if (!(rmp->mp_flags & VFORK_CHILD)) return;
+
+  rmp->mp_flags &= ~VFORK_CHILD;
+
+  /* Do not wake up the parent if it is already dead or dying. */
+  parent = &mproc[rmp->mp_parent];
+  if ((parent->mp_flags & (IN_USE | EXITING)) != IN_USE) return;
+
+  parent->mp_flags &= ~VFORK_WAIT;
+
+  reply(rmp->mp_parent, rmp->mp_pid);
+
+  /* Now that the vfork call has completed, deliver any signals that came in
+   * for the parent while it was blocked.  The existing delay-call machinery
+   * takes care of the case where the reply has not reached the parent yet.
+   */
+  check_pending(parent);
+}
+
 /*===========================================================================*
  *				do_exit					     *
  *===========================================================================*/
@@ -276,7 +334,8 @@ exit_proc(
  * become a zombie.
  */
   register int proc_nr, proc_nr_e;
-  int r;
+  struct mproc *t_mp;
+  int r, i;
   pid_t procgrp;
   clock_t user_time, sys_time;
   message m;
@@ -294,6 +353,11 @@ exit_proc(
   proc_nr = (int) (rmp - mproc);	/* get process slot number */
   proc_nr_e = rmp->mp_endpoint;
 
+  /* If this is a vfork child that never performed an exec, wake up the
+   * blocked parent now.
+   */
+  vfork_done(rmp);
+
   /* Remember a session leader's process group. */
   procgrp = (rmp->mp_pid == mp->mp_procgrp) ? mp->mp_procgrp : 0;
 
@@ -384,30 +448,50 @@ exit_proc(
   if (!dump_core)
 	zombify(rmp);
 
-  /* If the process has children, disinherit them.  INIT is the new parent. */
-  for (rmp = &mproc[0]; rmp < &mproc[NR_PROCS]; rmp++) {
-	if (!(rmp->mp_flags & IN_USE)) continue;
-	if (rmp->mp_tracer == proc_nr) {
-		/* This child's tracer died. Do something sensible. */
-		tracer_died(rmp);
-	}
-	if (rmp->mp_parent == proc_nr) {
-		/* 'rmp' now points to a child to be disinherited. */
-		rmp->mp_parent = INIT_PROC_NR;
-
-		/* If the process is making a VFS call, remember that we set
-		 * a new parent. This prevents FORK from replying to the wrong
-		 * parent upon completion.
-		 */
-		if (rmp->mp_flags & VFS_CALL)
-			rmp->mp_flags |= NEW_PARENT;
-
-		/* Notify new parent. */
-		if (rmp->mp_flags & ZOMBIE)
-			check_parent(rmp, TRUE /*try_cleanup*/);
+  /* If the process was tracing other processes, let those know their tracer
+   * died. A per-process administration is not kept for tracer relationships,
+   * but tracing is rare, so a table scan is acceptable when it is in use.
+   */
+  if (num_traced > 0) {
+	for (t_mp = &mproc[0]; t_mp < &mproc[NR_PROCS]; t_mp++) {
+		if (!(t_mp->mp_flags & IN_USE)) continue;
+		if (t_mp->mp_tracer == proc_nr)
+			tracer_died(t_mp);
 	}
   }
 
+  /* If the process has children, disinherit them.  INIT is the new parent. */
+  while ((i = mproc[proc_nr].mp_child) != NO_PROC) {
+	t_mp = &mproc[i];	/* points to a child to be disinherited */
+
+	/* Move the child, and its zombie queue entry if it has one, from the
+	 * dead parent's administration to that of INIT.
+	 */
+	detach_child(t_mp);
+	if (t_mp->mp_flags & ZOMBIE)
+		detach_zombie(t_mp);
+	t_mp->mp_parent = INIT_PROC_NR;
+	attach_child(t_mp);
+	if (t_mp->mp_flags & ZOMBIE)
+		attach_zombie(t_mp);
+
+	/* If the process is making a VFS call, remember that we set
+	 * a new parent. This prevents FORK from replying to the wrong
+	 * parent upon completion.
+	 */
+	if (t_mp->mp_flags & VFS_CALL)
+		t_mp->mp_flags |= NEW_PARENT;
+
+	/* If the process is a vfork child, there no longer is a blocked
+	 * parent waiting for it to exec or exit.
+	 */
+	t_mp->mp_flags &= ~VFORK_CHILD;
+
+	/* Notify new parent. */
+	if (t_mp->mp_flags & ZOMBIE)
+		check_parent(t_mp, TRUE /*try_cleanup*/);
+  }
+
   /* Send a hangup to the process' process group if it was a session leader. */
   if (procgrp != 0) check_sig(-procgrp, SIGHUP, FALSE /* ksig */);
 }
@@ -498,18 +582,54 @@ do_wait4(void)
    *	pidarg  < -1 means wait for any child whose process group = -pidarg
    */
   children = 0;
-  for (rp = &mproc[0]; rp < &mproc[NR_PROCS]; rp++) {
-	if ((rp->mp_flags & (IN_USE | TOLD_PARENT)) != IN_USE) continue;
-	if (rp->mp_parent != who_p && rp->mp_tracer != who_p) continue;
-	if (rp->mp_parent != who_p && (rp->mp_flags & ZOMBIE)) continue;
 
-	/* The value of pidarg determines which children qualify. */
-	if (pidarg  > 0 && pidarg != rp->mp_pid) continue;
-	if (pidarg < -1 && -pidarg != rp->mp_procgrp) continue;
+  /* Fast path: if the caller is not tracing any process, look for a
+   * qualifying zombie child directly, using the per-parent zombie queue
+   * and the PID hash table.
+   */
+  if (num_traced == 0) {
+	rp = NULL;
+	if (pidarg == -1) {
+		if (mp->mp_zombie != NO_PROC)
+			rp = &mproc[mp->mp_zombie];
+	} else if (pidarg > 0) {
+		if ((rp = find_proc(pidarg)) != NULL &&
+		    (rp->mp_parent != who_p || !(rp->mp_flags & ZOMBIE) ||
+		     (rp->mp_flags & TOLD_PARENT)))
+			rp = NULL;
+	} else {
+		for (i = mp->mp_zombie; i != NO_PROC;
+			i = mproc[i].mp_zombie_next)
+			if (mproc[i].mp_procgrp == -pidarg) break;
+		if (i != NO_PROC) rp = &mproc[i];
+	}
+	if (rp != NULL) {
+		/* This child meets the pid test and has exited. */
+		waited_for = tell_parent(rp, addr);
 
-	children++;			/* this child is acceptable */
+		if (waited_for && !(rp->mp_flags & (VFS_CALL | EVENT_CALL)))
+			cleanup(rp);
+		return(SUSPEND);
+	}
+  } else {
+	/* Check children traced by the caller. No per-process administration
+	 * is kept for tracer relationships, but tracing is rare, so a table
+	 * scan is acceptable then.
+	 */
+	for (rp = &mproc[0]; rp < &mproc[NR_PROCS]; rp++) {
+		if ((rp->mp_flags & (IN_USE | TOLD_PARENT)) != IN_USE)
+			continue;
+		if (rp->mp_tracer != who_p) continue;
+		if (rp->mp_parent != who_p && (rp->mp_flags & ZOMBIE))
+			continue;
+
+		/* The value of pidarg determines which children qualify. */
+		if (pidarg  > 0 && pidarg != rp->mp_pid) continue;
+		if (pidarg < -1 && -pidarg != rp->mp_procgrp) continue;
+
+		if (rp->mp_parent != who_p)
+			children++;	/* otherwise counted below */
 
-	if (rp->mp_tracer == who_p) {
 		if (rp->mp_flags & TRACE_ZOMBIE) {
 			/* Traced child meets the pid test and has exited. */
 			tell_tracer(rp);
@@ -533,17 +653,29 @@ do_wait4(void)
 			}
 		}
 	}
+  }
 
-	if (rp->mp_parent == who_p) {
-		if (rp->mp_flags & ZOMBIE) {
-			/* This child meets the pid test and has exited. */
-			waited_for = tell_parent(rp, addr);
+  /* Go through the caller's own children, counting the ones that qualify
+   * and dealing with any qualifying zombie among them.
+   */
+  for (i = mp->mp_child; i != NO_PROC; i = rp->mp_sibling) {
+	rp = &mproc[i];
+	if (rp->mp_flags & TOLD_PARENT) continue;
 
-			if (waited_for &&
-			    !(rp->mp_flags & (VFS_CALL | EVENT_CALL)))
-				cleanup(rp);
-			return(SUSPEND);
-		}
+	/* The value of pidarg determines which children qualify. */
+	if (pidarg  > 0 && pidarg != rp->mp_pid) continue;
+	if (pidarg < -1 && -pidarg != rp->mp_procgrp) continue;
+
+	children++;			/* this child is acceptable */
+
+	if (rp->mp_flags & ZOMBIE) {
+		/* This child meets the pid test and has exited. */
+		waited_for = tell_parent(rp, addr);
+
+		if (waited_for &&
+		    !(rp->mp_flags & (VFS_CALL | EVENT_CALL)))
+			cleanup(rp);
+		return(SUSPEND);
 	}
   }
 
@@ -617,6 +749,7 @@ zombify(struct mproc *rmp)
   }
   else {
 	rmp->mp_flags |= ZOMBIE;
+	attach_zombie(rmp);
   }
 
   /* No tracer, or tracer is parent, or tracer has now been notified. */
@@ -713,6 +846,7 @@ static int tell_parent(struct mproc *child, vir_bytes addr)
 	W_EXITCODE(child->mp_exitstatus, child->mp_sigstatus);
   reply(child->mp_parent, child->mp_pid);
   parent->mp_flags &= ~WAITING;		/* parent no longer waiting */
+  detach_zombie(child);			/* remove from parent's queue */
   child->mp_flags &= ~ZOMBIE;		/* child no longer a zombie */
   child->mp_flags |= TOLD_PARENT;	/* avoid informing parent twice */
 
@@ -751,6 +885,7 @@ tell_tracer(
   tracer->mp_flags &= ~WAITING;		/* tracer no longer waiting */
   child->mp_flags &= ~TRACE_ZOMBIE;	/* child no longer zombie to tracer */
   child->mp_flags |= ZOMBIE;		/* child is now zombie to parent */
+  attach_zombie(child);
 }
 
 /*===========================================================================*
@@ -767,6 +902,7 @@ tracer_died(
 
   child->mp_tracer = NO_TRACER;
   child->mp_flags &= ~TRACE_EXIT;
+  num_traced--;
 
   /* If the tracer died while the child was running or stopped, we have no
    * idea what state the child is in. Avoid a trainwreck, by killing the child.
@@ -784,6 +920,7 @@ tracer_died(
   if (child->mp_flags & TRACE_ZOMBIE) {
 	child->mp_flags &= ~TRACE_ZOMBIE;
 	child->mp_flags |= ZOMBIE;
+	attach_zombie(child);
 
 	check_parent(child, TRUE /*try_cleanup*/);
   }
@@ -797,6 +934,16 @@ cleanup(
 	register struct mproc *rmp	/* tells which process is exiting */
 )
 {
+  /* Remove the process from the relationship administration. */
+  detach_child(rmp);
+  detach_pid(rmp);
+  detach_pgrp(rmp);
+  if (rmp->mp_tracer != NO_TRACER) {
+	/* The tracee died before the tracer detached from it. */
+	rmp->mp_tracer = NO_TRACER;
+	num_traced--;
+  }
+
   /* Release the process table entry and reinitialize some field. */
   rmp->mp_pid = 0;
   rmp->mp_flags = 0;
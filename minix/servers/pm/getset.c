@@ -204,7 +204,9 @@ do_set(void)
 		break;
 	case PM_SETSID:
 		if (rmp->mp_procgrp == rmp->mp_pid) return(EPERM);
+		detach_pgrp(rmp);
 		rmp->mp_procgrp = rmp->mp_pid;
+		attach_pgrp(rmp);
 
 		m.m_type = VFS_PM_SETSID;
 		m.VFS_PM_ENDPT = rmp->mp_endpoint;
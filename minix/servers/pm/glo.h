@@ -7,6 +7,7 @@
 /* Global variables. */
 EXTERN struct mproc *mp;	/* ptr to 'mproc' slot of current process */
 EXTERN int procs_in_use;	/* how many processes are marked as IN_USE */
+EXTERN int num_traced;		/* how many processes have a tracer attached */
 EXTERN char monitor_params[MULTIBOOT_PARAM_BUF_SIZE];
 
 /* Misc.c */
@@ -131,7 +131,7 @@ sef_local_startup(void)
 static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
 {
 /* Initialize the process manager. */
-  int s;
+  int s, h;
   static struct boot_image image[NR_BOOT_PROCS];
   register struct boot_image *ip;
   static char core_sigs[] = { SIGQUIT, SIGILL, SIGTRAP, SIGABRT,
@@ -148,7 +148,20 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
 	init_timer(&rmp->mp_timer);
 	rmp->mp_magic = MP_MAGIC;
 	rmp->mp_sigact = mpsigact[rmp - mproc];
-	rmp->mp_eventsub = NO_EVENTSUB;
+	rmp->mp_eventwait = 0;
+	rmp->mp_child = NO_PROC;
+	rmp->mp_sibling = NO_PROC;
+	rmp->mp_sibling_prev = NO_PROC;
+	rmp->mp_zombie = NO_PROC;
+	rmp->mp_zombie_next = NO_PROC;
+	rmp->mp_pidhash_next = NO_PROC;
+	rmp->mp_pgrphash_next = NO_PROC;
+  }
+
+  /* Initialize the process and process group ID hash tables. */
+  for (h = 0; h < PID_HASH_SIZE; h++) {
+	pid_hash[h] = NO_PROC;
+	pgrp_hash[h] = NO_PROC;
   }
 
   /* Build the set of signals which cause core dumps, and the set of signals
@@ -217,6 +230,11 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
 		/* Get kernel endpoint identifier. */
 		rmp->mp_endpoint = ip->endpoint;
 
+		/* Register the process in the relationship administration. */
+		attach_child(rmp);
+		attach_pid(rmp);
+		attach_pgrp(rmp);
+
 		/* Tell VFS about this system process. */
 		memset(&mess, 0, sizeof(mess));
 		mess.m_type = VFS_PM_INIT;
@@ -378,18 +396,29 @@ handle_vfs_reply(void)
 	if (r != OK) {
 		/* Tear down the newly created process */
 		rmp->mp_scheduler = NONE; /* don't try to stop scheduling */
+		rmp->mp_flags &= ~VFORK_CHILD; /* fail the vfork call below */
 		exit_proc(rmp, -1, FALSE /*dump_core*/);
 
-		/* Wake up the parent with a failed fork (unless dead) */
-		if (!new_parent)
+		/* Wake up the parent with a failed fork (unless dead).  For
+		 * vfork, also resume delivery of any deferred signals.
+		 */
+		if (!new_parent) {
 			reply(rmp->mp_parent, -1);
+			if (mproc[rmp->mp_parent].mp_flags & VFORK_WAIT) {
+				mproc[rmp->mp_parent].mp_flags &= ~VFORK_WAIT;
+				check_pending(&mproc[rmp->mp_parent]);
+			}
+		}
 	}
 	else {
 		/* Wake up the child */
 		reply(proc_n, OK);
 
-		/* Wake up the parent, unless the parent is already dead */
-		if (!new_parent)
+		/* Wake up the parent, unless the parent is already dead.  For
+		 * vfork, the parent stays blocked until the child performs an
+		 * exec or exits.
+		 */
+		if (!new_parent && !(rmp->mp_flags & VFORK_CHILD))
 			reply(rmp->mp_parent, rmp->mp_pid);
 	}
 
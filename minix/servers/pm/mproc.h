@@ -24,7 +24,7 @@ EXTERN ixfer_sigaction mpsigact[NR_PROCS][_NSIG];
 EXTERN struct mproc {
   char mp_exitstatus;		/* storage for status when process exits */
   char mp_sigstatus;		/* storage for signal # for killed procs */
-  char mp_eventsub;		/* process event subscriber, or NO_EVENTSUB */
+  unsigned char mp_eventwait;	/* bit mask of event subscribers to reply */
   pid_t mp_pid;			/* process id */
   endpoint_t mp_endpoint;	/* kernel endpoint id */
   pid_t mp_procgrp;		/* pid of process group (used for signals) */
@@ -33,6 +33,18 @@ EXTERN struct mproc {
   int mp_parent;		/* index of parent process */
   int mp_tracer;		/* index of tracer process, or NO_TRACER */
 
+  /* Process relationship administration, maintained to avoid full process
+   * table scans. All of these fields are mproc slot numbers, with NO_PROC
+   * meaning "none".
+   */
+  int mp_child;			/* head of the list of child processes */
+  int mp_sibling;		/* next process in the parent's child list */
+  int mp_sibling_prev;		/* previous process in that list */
+  int mp_zombie;		/* head of the queue of zombie children */
+  int mp_zombie_next;		/* next zombie in the parent's queue */
+  int mp_pidhash_next;		/* next process in the same PID hash chain */
+  int mp_pgrphash_next;		/* next process in the same group hash chain */
+
   /* Child user and system times. Accounting done on child exit. */
   clock_t mp_child_utime;	/* cumulative user time of children */
   clock_t mp_child_stime;	/* cumulative sys time of children */
@@ -82,6 +94,13 @@ EXTERN struct mproc {
   int mp_magic;			/* sanity check, MP_MAGIC */
 } mproc[NR_PROCS];
 
+/* Hash tables mapping process IDs and process group IDs to mproc slot
+ * numbers; the chains run through mp_pidhash_next and mp_pgrphash_next
+ * respectively. Only slots that are in use are in the tables.
+ */
+EXTERN int pid_hash[PID_HASH_SIZE];
+EXTERN int pgrp_hash[PID_HASH_SIZE];
+
 /* Flag values */
 #define IN_USE		0x00001	/* set when 'mproc' slot in use */
 #define WAITING		0x00002	/* set by WAIT4 system call */
@@ -102,5 +121,11 @@ EXTERN struct mproc {
 #define DELAY_CALL	0x20000	/* waiting for call before sending signal */
 #define TAINTED		0x40000 /* process is 'tainted' */
 #define EVENT_CALL	0x80000	/* waiting for process event subscriber */
+#define VFORK_CHILD	0x100000 /* created with vfork; parent is blocked
+				  * until this process execs or exits
+				  */
+#define VFORK_WAIT	0x200000 /* blocked on vfork until the child execs or
+				  * exits; defer all signal delivery
+				  */
 
 #define MP_MAGIC	0xC0FFEE0
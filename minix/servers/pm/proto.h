@@ -24,6 +24,7 @@ void exec_restart(struct mproc *rmp, int result, vir_bytes pc, vir_bytes sp,
 /* forkexit.c */
 int do_fork(void);
 int do_srv_fork(void);
+void vfork_done(struct mproc *rmp);
 int do_exit(void);
 void exit_proc(struct mproc *rmp, int exit_status, int dump_core);
 void exit_restart(struct mproc *rmp);
@@ -89,6 +90,15 @@ void trace_stop(struct mproc *rmp, int signo);
 pid_t get_free_pid(void);
 char *find_param(const char *key);
 struct mproc *find_proc(pid_t lpid);
+struct mproc *find_pgrp(pid_t pgrp);
+void attach_child(struct mproc *rmp);
+void detach_child(struct mproc *rmp);
+void attach_zombie(struct mproc *rmp);
+void detach_zombie(struct mproc *rmp);
+void attach_pid(struct mproc *rmp);
+void detach_pid(struct mproc *rmp);
+void attach_pgrp(struct mproc *rmp);
+void detach_pgrp(struct mproc *rmp);
 int nice_to_priority(int nice, unsigned *new_q);
 int pm_isokendpt(int ep, int *proc);
 void tell_vfs(struct mproc *rmp, message *m_ptr);
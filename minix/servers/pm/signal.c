@@ -33,6 +33,18 @@
 static int unpause(struct mproc *rmp);
 static int sig_send(struct mproc *rmp, int signo);
 static void sig_proc_exit(struct mproc *rmp, int signo);
+static void sigbatch_flush(void);
+
+/* While check_pending() runs, signal handler frames are staged here rather
+ * than set up with one kernel call each; sigbatch_flush() then submits them
+ * all at once. The frames are stacked in staging order, which yields the same
+ * process state as separate sys_sigsend() calls would.
+ */
+static struct {
+  struct mproc *sb_rmp;		/* process being batched for, or NULL */
+  int sb_count;			/* number of staged signal contexts */
+  struct sigmsg sb_msg[_NSIG];	/* staged signal contexts */
+} sigbatch;
 
 /*===========================================================================*
  *				do_sigaction				     *
@@ -422,6 +434,20 @@ sig_proc(
 	return;
   }
 
+  if (rmp->mp_flags & VFORK_WAIT) {
+	/* The process is blocked on a vfork(2) call until its child execs or
+	 * exits.  It is in the middle of a sendrec(2) to PM, and the vfork
+	 * reply may cross any attempt to stop it, so setting up a signal
+	 * handler now could cause the later sigreturn(2) to clobber the vfork
+	 * call's return value.  Defer all signal delivery until the vfork call
+	 * completes; vfork_done() will then call check_pending().
+	 */
+	sigaddset(&rmp->mp_sigpending, signo);
+	if(ksig)
+		sigaddset(&rmp->mp_ksigpending, signo);
+	return;
+  }
+
   if (rmp->mp_flags & (VFS_CALL | EVENT_CALL)) {
 	sigaddset(&rmp->mp_sigpending, signo);
 	if(ksig)
@@ -661,6 +687,12 @@ check_pending(register struct mproc *rmp)
   int i;
   int ksig;
 
+  /* Batch the signal handler frames for all signals delivered below, so that
+   * they can be set up with a single kernel call; see sig_send().
+   */
+  assert(sigbatch.sb_rmp == NULL);
+  sigbatch.sb_rmp = rmp;
+
   for (i = 1; i < _NSIG; i++) {
 	if (sigismember(&rmp->mp_sigpending, i) &&
 		!sigismember(&rmp->mp_sigmask, i)) {
@@ -679,6 +711,8 @@ check_pending(register struct mproc *rmp)
 		}
 	}
   }
+
+  sigbatch_flush();
 }
 
 /*===========================================================================*
@@ -814,6 +848,21 @@ sig_send(
   sigdelset(&rmp->mp_sigpending, signo);
   sigdelset(&rmp->mp_ksigpending, signo);
 
+  /* If check_pending() is delivering a batch of signals to this process, just
+   * stage the signal context; sigbatch_flush() will ask the kernel to set up
+   * all the handler frames with one call. Blocking PM calls must still be
+   * interrupted and the process resumed right away, so those deliveries take
+   * the immediate path below.
+   */
+  if (sigbatch.sb_rmp == rmp && !(rmp->mp_flags & (WAITING | SIGSUSPENDED))) {
+	assert(rmp->mp_flags & UNPAUSED);
+	assert(sigbatch.sb_count < _NSIG);
+
+	sigbatch.sb_msg[sigbatch.sb_count++] = sigmsg;
+
+	return(TRUE);
+  }
+
   /* Ask the kernel to deliver the signal */
   r = sys_sigsend(rmp->mp_endpoint, &sigmsg);
   /* sys_sigsend can fail legitimately with EFAULT or ENOMEM if the process
@@ -853,3 +902,48 @@ sig_send(
 
   return(TRUE);
 }
+
+/*===========================================================================*
+ *				sigbatch_flush				     *
+ *===========================================================================*/
+static void
+sigbatch_flush(void)
+{
+/* Ask the kernel to set up all the signal handler frames that sig_send() has
+ * staged since check_pending() opened the batch. The frames are stacked in
+ * staging order, so the last staged handler runs first, and each sigreturn
+ * transfers control to the handler staged before it -- just as if the frames
+ * had been set up with separate kernel calls.
+ */
+  struct mproc *rmp;
+  int r, count, signo;
+
+  rmp = sigbatch.sb_rmp;
+  sigbatch.sb_rmp = NULL;
+
+  if (sigbatch.sb_count == 0) return;
+
+  signo = sigbatch.sb_msg[0].sm_signo;
+  count = sigbatch.sb_count;
+  sigbatch.sb_count = 0;
+
+  /* If one of the signals terminated the process after frames were staged,
+   * the staged frames are now meaningless; simply discard them.
+   */
+  if (rmp->mp_flags & EXITING) return;
+
+  r = sys_sigsendv(rmp->mp_endpoint, sigbatch.sb_msg, count);
+  /* As with a single delivery, EFAULT and ENOMEM mean that the process memory
+   * cannot accommodate the signal handler frames. Kill the process, as
+   * sig_proc() would have done had the failure been detected there.
+   */
+  if (r == EFAULT || r == ENOMEM) {
+	printf("PM: %d can't catch signal %d - killing\n",
+		rmp->mp_pid, signo);
+	sig_proc_exit(rmp, signo);
+	return;
+  }
+  if (r != OK) {
+	panic("sys_sigsendv failed: %d", r);
+  }
+}
@@ -56,6 +56,7 @@ do_trace(void)
 	if (mp->mp_tracer != NO_TRACER) return(EBUSY);
 
 	mp->mp_tracer = mp->mp_parent;
+	if (mp->mp_tracer != NO_TRACER) num_traced++;
 	mp->mp_reply.m_pm_lc_ptrace.data = 0;
 	return(OK);
 
@@ -86,6 +87,7 @@ do_trace(void)
 
 	child->mp_tracer = who_p;
 	child->mp_trace_flags = TO_NOEXEC;
+	num_traced++;
 
 	sig_proc(child, SIGSTOP, TRUE /*trace*/, FALSE /* ksig */);
 
@@ -192,6 +194,7 @@ do_trace(void)
 		return(EINVAL);
 
 	child->mp_tracer = NO_TRACER;
+	num_traced--;
 
 	/* Let all tracer-pending signals through the filter. */
 	for (i = 1; i < _NSIG; i++) {
@@ -4,6 +4,15 @@
  *   get_free_pid:	get a free process or group id
  *   find_param:	look up a boot monitor parameter
  *   find_proc:		return process pointer from pid number
+ *   find_pgrp:		return a process group member from group id number
+ *   attach_child:	link a process into its parent's child list
+ *   detach_child:	remove a process from its parent's child list
+ *   attach_zombie:	queue a zombie at its parent
+ *   detach_zombie:	remove a zombie from its parent's queue
+ *   attach_pid:	enter a process into the PID hash table
+ *   detach_pid:	remove a process from the PID hash table
+ *   attach_pgrp:	enter a process into the process group hash table
+ *   detach_pgrp:	remove a process from the process group hash table
  *   nice_to_priority	convert nice level to priority queue
  *   pm_isokendpt:	check the validity of an endpoint
  *   tell_vfs:		send a request to VFS on behalf of a process
@@ -34,19 +43,13 @@
 pid_t get_free_pid()
 {
   static pid_t next_pid = INIT_PID + 1;		/* next pid to be assigned */
-  register struct mproc *rmp;			/* check process table */
-  int t;					/* zero if pid still free */
 
-  /* Find a free pid for the child and put it in the table. */
+  /* Find a free pid for the child and put it in the table. A pid is free if
+   * no process uses it as its process ID or as its process group ID.
+   */
   do {
-	t = 0;
 	next_pid = (next_pid < NR_PIDS ? next_pid + 1 : INIT_PID + 1);
-	for (rmp = &mproc[0]; rmp < &mproc[NR_PROCS]; rmp++)
-		if (rmp->mp_pid == next_pid || rmp->mp_procgrp == next_pid) {
-			t = 1;
-			break;
-		}
-  } while (t);					/* 't' = 0 means pid free */
+  } while (find_proc(next_pid) != NULL || find_pgrp(next_pid) != NULL);
   return(next_pid);
 }
 
@@ -76,15 +79,178 @@ find_param(const char *name)
 struct mproc *find_proc(lpid)
 pid_t lpid;
 {
-  register struct mproc *rmp;
+  register int i;
 
-  for (rmp = &mproc[0]; rmp < &mproc[NR_PROCS]; rmp++)
-	if ((rmp->mp_flags & IN_USE) && rmp->mp_pid == lpid)
-		return(rmp);
+  for (i = pid_hash[PID_HASH(lpid)]; i != NO_PROC; i = mproc[i].mp_pidhash_next)
+	if (mproc[i].mp_pid == lpid)
+		return(&mproc[i]);
 
   return(NULL);
 }
 
+/*===========================================================================*
+ *				find_pgrp  				     *
+ *===========================================================================*/
+struct mproc *find_pgrp(pid_t pgrp)
+{
+/* Return an arbitrary member of the given process group, or NULL if the
+ * group has no members.
+ */
+  register int i;
+
+  for (i = pgrp_hash[PID_HASH(pgrp)]; i != NO_PROC;
+	i = mproc[i].mp_pgrphash_next)
+	if (mproc[i].mp_procgrp == pgrp)
+		return(&mproc[i]);
+
+  return(NULL);
+}
+
+/*===========================================================================*
+ *				attach_child				     *
+ *===========================================================================*/
+void attach_child(struct mproc *rmp)
+{
+/* Link a process into its parent's list of child processes. */
+  struct mproc *parent;
+
+  parent = &mproc[rmp->mp_parent];
+
+  rmp->mp_sibling = parent->mp_child;
+  rmp->mp_sibling_prev = NO_PROC;
+  if (parent->mp_child != NO_PROC)
+	mproc[parent->mp_child].mp_sibling_prev = (int) (rmp - mproc);
+  parent->mp_child = (int) (rmp - mproc);
+}
+
+/*===========================================================================*
+ *				detach_child				     *
+ *===========================================================================*/
+void detach_child(struct mproc *rmp)
+{
+/* Remove a process from its parent's list of child processes. */
+  struct mproc *parent;
+
+  parent = &mproc[rmp->mp_parent];
+
+  if (rmp->mp_sibling_prev != NO_PROC)
+	mproc[rmp->mp_sibling_prev].mp_sibling = rmp->mp_sibling;
+  else {
+	if (parent->mp_child != (int) (rmp - mproc))
+		panic("detach_child: not on parent's child list");
+	parent->mp_child = rmp->mp_sibling;
+  }
+  if (rmp->mp_sibling != NO_PROC)
+	mproc[rmp->mp_sibling].mp_sibling_prev = rmp->mp_sibling_prev;
+
+  rmp->mp_sibling = rmp->mp_sibling_prev = NO_PROC;
+}
+
+/*===========================================================================*
+ *				attach_zombie				     *
+ *===========================================================================*/
+void attach_zombie(struct mproc *rmp)
+{
+/* Queue a process that has just become a zombie at its parent, so that the
+ * parent's wait4() calls need not search its live children.
+ */
+  struct mproc *parent;
+
+  parent = &mproc[rmp->mp_parent];
+
+  rmp->mp_zombie_next = parent->mp_zombie;
+  parent->mp_zombie = (int) (rmp - mproc);
+}
+
+/*===========================================================================*
+ *				detach_zombie				     *
+ *===========================================================================*/
+void detach_zombie(struct mproc *rmp)
+{
+/* Remove a process from its parent's zombie queue. The queue only holds the
+ * parent's zombie children, so the search is short.
+ */
+  int *link;
+
+  link = &mproc[rmp->mp_parent].mp_zombie;
+  while (*link != (int) (rmp - mproc)) {
+	if (*link == NO_PROC)
+		panic("detach_zombie: not on parent's zombie queue");
+	link = &mproc[*link].mp_zombie_next;
+  }
+  *link = rmp->mp_zombie_next;
+  rmp->mp_zombie_next = NO_PROC;
+}
+
+/*===========================================================================*
+ *				attach_pid				     *
+ *===========================================================================*/
+void attach_pid(struct mproc *rmp)
+{
+/* Enter a process into the PID hash table, keyed on its process ID. */
+  int *head;
+
+  head = &pid_hash[PID_HASH(rmp->mp_pid)];
+  rmp->mp_pidhash_next = *head;
+  *head = (int) (rmp - mproc);
+}
+
+/*===========================================================================*
+ *				detach_pid				     *
+ *===========================================================================*/
+void detach_pid(struct mproc *rmp)
+{
+/* Remove a process from the PID hash table. */
+  int *link;
+
+  link = &pid_hash[PID_HASH(rmp->mp_pid)];
+  while (*link != (int) (rmp - mproc)) {
+	if (*link == NO_PROC)
+		panic("detach_pid: pid %d not in hash table", rmp->mp_pid);
+	link = &mproc[*link].mp_pidhash_next;
+  }
+  *link = rmp->mp_pidhash_next;
+  rmp->mp_pidhash_next = NO_PROC;
+}
+
+/*===========================================================================*
+ *				attach_pgrp				     *
+ *===========================================================================*/
+void attach_pgrp(struct mproc *rmp)
+{
+/* Enter a process into the process group hash table, keyed on its process
+ * group ID. Processes without a process group are not entered.
+ */
+  int *head;
+
+  if (rmp->mp_procgrp == 0) return;
+
+  head = &pgrp_hash[PID_HASH(rmp->mp_procgrp)];
+  rmp->mp_pgrphash_next = *head;
+  *head = (int) (rmp - mproc);
+}
+
+/*===========================================================================*
+ *				detach_pgrp				     *
+ *===========================================================================*/
+void detach_pgrp(struct mproc *rmp)
+{
+/* Remove a process from the process group hash table. */
+  int *link;
+
+  if (rmp->mp_procgrp == 0) return;
+
+  link = &pgrp_hash[PID_HASH(rmp->mp_procgrp)];
+  while (*link != (int) (rmp - mproc)) {
+	if (*link == NO_PROC)
+		panic("detach_pgrp: pgrp %d not in hash table",
+			rmp->mp_procgrp);
+	link = &mproc[*link].mp_pgrphash_next;
+  }
+  *link = rmp->mp_pgrphash_next;
+  rmp->mp_pgrphash_next = NO_PROC;
+}
+
 /*===========================================================================*
  *				nice_to_priority			     *
  *===========================================================================*/
@@ -0,0 +1,146 @@
+/* This file implements boot-time profiling for RS.  RS is in a unique
+ * position to account for where system startup time goes: it initializes
+ * every system service and receives every initialization reply.  This module
+ * combines three sources into a single profile:
+ *
+ *   - the kernel's boot-phase event table, fetched once through the
+ *     GET_BOOTEVENTS kernel call;
+ *   - the timestamps that each service reports in its RS_INIT reply, taken
+ *     at sef_startup() entry and at the end of initialization;
+ *   - RS's own records of when it requested and acknowledged each service's
+ *     initialization, kept in the system process table.
+ *
+ * The profile is exported through the minix.rs.boot sysctl subtree, with all
+ * times converted to microseconds relative to the first kernel event, so
+ * that user land needs no knowledge of the clock frequency.
+ */
+
+#include "inc.h"
+
+#include <minix/rmib.h>
+#include <minix/sysctl.h>
+
+static struct boot_event kernel_events[NR_BOOT_EVENTS];
+static u64_t bootprof_epoch;	/* first kernel event; time zero of profile */
+
+static ssize_t bootprof_kernel(struct rmib_call *, struct rmib_node *,
+	struct rmib_oldp *, struct rmib_newp *);
+static ssize_t bootprof_services(struct rmib_call *, struct rmib_node *,
+	struct rmib_oldp *, struct rmib_newp *);
+
+/* The minix.rs.boot subtree. */
+static struct rmib_node bootprof_mib_table[] = {
+	RMIB_FUNC(RMIB_RO | CTLTYPE_STRUCT, 0, bootprof_kernel, "kernel",
+	    "Kernel boot-phase events (struct rs_bootprof_kev)"),
+	RMIB_FUNC(RMIB_RO | CTLTYPE_STRUCT, 0, bootprof_services, "services",
+	    "Per-service startup timestamps (struct rs_bootprof_srv)"),
+};
+
+/* The minix.rs subtree. */
+static struct rmib_node rs_mib_table[] = {
+	RMIB_NODE(RMIB_RO, bootprof_mib_table, "boot",
+	    "Boot-time profiling information"),
+};
+
+static struct rmib_node rs_mib_node = RMIB_NODE(RMIB_RO, rs_mib_table, "rs",
+    "Reincarnation server information");
+
+/*===========================================================================*
+ *				bootprof_micros				     *
+ *===========================================================================*/
+static u32_t bootprof_micros(u64_t ts)
+{
+/* Convert a raw free-running clock value to microseconds since the profile
+ * epoch.  Zero is returned for timestamps that were never recorded.
+ */
+  if (ts < bootprof_epoch)
+	return 0;
+
+  return frclock_64_to_micros(ts - bootprof_epoch);
+}
+
+/*===========================================================================*
+ *				bootprof_kernel				     *
+ *===========================================================================*/
+static ssize_t bootprof_kernel(struct rmib_call *call __unused,
+	struct rmib_node *node __unused, struct rmib_oldp *oldp,
+	struct rmib_newp *newp __unused)
+{
+/* Copy out the kernel boot-phase events, converted to microseconds. */
+  struct rs_bootprof_kev kevs[RS_BOOTPROF_NR_KERNEL];
+  unsigned int i;
+
+  memset(kevs, 0, sizeof(kevs));
+
+  for (i = 0; i < NR_BOOT_EVENTS && i < __arraycount(kevs); i++) {
+	if (kernel_events[i].bev_name[0] == '\0')
+		break;
+	strlcpy(kevs[i].ke_name, kernel_events[i].bev_name,
+	    sizeof(kevs[i].ke_name));
+	kevs[i].ke_micros = bootprof_micros(kernel_events[i].bev_tsc);
+  }
+
+  return rmib_copyout(oldp, 0, kevs, i * sizeof(kevs[0]));
+}
+
+/*===========================================================================*
+ *				bootprof_services			     *
+ *===========================================================================*/
+static ssize_t bootprof_services(struct rmib_call *call __unused,
+	struct rmib_node *node __unused, struct rmib_oldp *oldp,
+	struct rmib_newp *newp __unused)
+{
+/* Copy out the per-service startup timestamps.  The records are built from
+ * the live system process table, so services started after boot show up as
+ * well, at their actual start time.
+ */
+  struct rs_bootprof_srv srvs[NR_SYS_PROCS];
+  struct rproc *rp;
+  unsigned int count;
+
+  memset(srvs, 0, sizeof(srvs));
+
+  count = 0;
+  for (rp = BEG_RPROC_ADDR; rp < END_RPROC_ADDR; rp++) {
+	if (!(rp->r_flags & RS_IN_USE) || rp->r_start_ts == 0)
+		continue;
+
+	strlcpy(srvs[count].sv_label, rp->r_pub->label,
+	    sizeof(srvs[count].sv_label));
+	srvs[count].sv_start = bootprof_micros(rp->r_start_ts);
+	srvs[count].sv_sef = bootprof_micros(rp->r_sef_ts);
+	srvs[count].sv_init = bootprof_micros(rp->r_init_ts);
+	srvs[count].sv_ready = bootprof_micros(rp->r_ready_ts);
+	count++;
+  }
+
+  return rmib_copyout(oldp, 0, srvs, count * sizeof(srvs[0]));
+}
+
+/*===========================================================================*
+ *				bootprof_init				     *
+ *===========================================================================*/
+void bootprof_init(void)
+{
+/* Fetch the kernel's boot-phase event table and publish the minix.rs
+ * subtree.  Called from the main loop setup, after RS itself has fully
+ * initialized: the kernel events were all recorded before RS even started,
+ * and the service records are read live at query time.
+ */
+  const int mib[] = { CTL_MINIX, MINIX_RS };
+  int r;
+
+  if ((r = sys_getinfo(GET_BOOTEVENTS, kernel_events,
+      sizeof(kernel_events), 0, 0)) != OK) {
+	printf("RS: unable to get kernel boot events (%d)\n", r);
+	memset(kernel_events, 0, sizeof(kernel_events));
+  }
+
+  bootprof_epoch = kernel_events[0].bev_tsc;
+
+  /* Only local failures are reported; remote failures are silently ignored.
+   * Either way, RS works fine without the subtree.
+   */
+  if ((r = rmib_register(mib, __arraycount(mib), &rs_mib_node)) != OK)
+	printf("RS: unable to register remote MIB tree (%d)\n", r);
+}
@@ -41,6 +41,8 @@
 #define RS_CLEANUP_DETACH 0x2000   /* detach at cleanup time */
 #define RS_CLEANUP_SCRIPT 0x4000   /* run script at cleanup time */
 #define RS_REINCARNATE    0x8000   /* after exit, restart with a new endpoint */
+#define RS_START_PENDING  0x10000  /* start deferred until deps are ready */
+#define RS_RESTART_PENDING 0x20000 /* restart deferred until deps are ready */
 
 #define RS_SRV_IS_IDLE(S) (((S)->r_flags & RS_DEAD) || ((S)->r_flags & ~(RS_IN_USE|RS_ACTIVE|RS_CLEANUP_DETACH|RS_CLEANUP_SCRIPT)) == 0)
 
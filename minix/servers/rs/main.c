@@ -53,11 +53,17 @@ int main(void)
   if (OK != (s=sys_getmachine(&machine)))
 	  panic("couldn't get machine info: %d", s);
 
+  /* Now that the system is up, publish the boot-time profile. */
+  bootprof_init();
+
   /* Main loop - get work and do it, forever. */         
   while (TRUE) {              
       /* Perform sensitive background operations when RS is idle. */
       rs_idle_period();
 
+      /* Start pending services whose dependencies have become ready. */
+      start_pending_services();
+
       /* Wait for request message. */
       get_work(&m, &ipc_status);
       who_e = m.m_source;
@@ -332,6 +338,8 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
       rp->r_uid = 0;                           /* root */
       rp->r_check_tm = 0;                      /* not checked yet */
       rp->r_alive_tm = getticks();             /* currently alive */
+      rp->r_hb_addr = 0;                       /* no heartbeat counter yet */
+      rp->r_hb_count = 0;
       rp->r_stop_tm = 0;                       /* not exiting yet */
       rp->r_asr_count = 0;                     /* no ASR updates yet */
       rp->r_restarts = 0;                      /* no restarts so far */
@@ -814,6 +822,15 @@ endpoint_t endpoint;
       reply(m.m_source, rp, &m);
   }
 
+  /* Record where the service keeps its heartbeat counter. */
+  rp->r_hb_addr = m.m_rs_init.hb_addr;
+  rp->r_hb_count = 0;
+
+  /* Record the startup timestamps for the boot profile. */
+  rp->r_sef_ts = m.m_rs_init.sef_tsc;
+  rp->r_init_ts = m.m_rs_init.init_tsc;
+  read_frclock_64(&rp->r_ready_ts);
+
   /* Mark the slot as no longer initializing. */
   rp->r_flags &= ~RS_INITIALIZING;
   rp->r_check_tm = 0;
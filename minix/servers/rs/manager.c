@@ -352,6 +352,25 @@ void end_srv_init(struct rproc *rp)
           printf("RS: %s completed restart\n", srv_to_string(rp));
   }
   rp->r_next_rp = NULL;
+
+  /* If the service is to keep a warm standby replica, create it right away,
+   * rather than leaving that to rs_idle_period(): on a busy system an idle
+   * period may be a long time coming, and the whole point of the standby is
+   * that it is already there by the time the service crashes. This also
+   * replenishes the standby directly after a restart has consumed it, so
+   * that back-to-back failures are handled by activation as well. The idle
+   * period remains as a fallback in case creating the replica fails here.
+   */
+  if((rp->r_flags & RS_ACTIVE) && (rpub->sys_flags & SF_USE_REPL)
+      && rp->r_next_rp == NULL) {
+      if(rpub->endpoint == VM_PROC_NR && (rp->r_old_rp || rp->r_new_rp)) {
+          /* Only one replica at the time for VM. */
+          return;
+      }
+      if((r = clone_service(rp, RST_SYS_PROC, 0)) != OK)
+          printf("RS: warning: unable to clone %s (error %d)\n",
+              srv_to_string(rp), r);
+  }
 }
 
 /*===========================================================================*
@@ -591,6 +610,8 @@ struct rproc *rp;
   rp->r_pid = child_pid;			/* set child pid */
   rp->r_check_tm = 0;				/* not checked yet */
   rp->r_alive_tm = getticks(); 			/* currently alive */
+  rp->r_hb_addr = 0;				/* no heartbeat counter yet */
+  rp->r_hb_count = 0;
   rp->r_stop_tm = 0;				/* not exiting yet */
   rp->r_backoff = 0;				/* not to be restarted */
   rproc_ptr[child_proc_nr_n] = rp;		/* mapping for fast access */
@@ -1272,6 +1293,25 @@ void restart_service(struct rproc *rp)
   }
   replica_rp = rp->r_next_rp;
 
+  /* When several services fail together, restart them in dependency order:
+   * defer this restart while services it depends on are themselves still
+   * restarting or initializing, and resume from start_pending_services()
+   * once they are ready. Independent services restart concurrently. The
+   * replica has been cloned above already, so a deferred restart completes
+   * quickly once it is issued.
+   */
+  if (rp->r_flags & RS_RESTART_PENDING) {
+      rp->r_flags &= ~RS_RESTART_PENDING;	/* deferred restart resumes */
+  }
+  else if (!shutting_down && !service_deps_ready(rp)) {
+      rp->r_flags |= RS_RESTART_PENDING;
+      rp->r_check_tm = getticks();
+      if (rs_verbose)
+          printf("RS: %s restart deferred until dependencies are ready\n",
+              srv_to_string(rp));
+      return;
+  }
+
   /* Update the service into the replica. */
   r = update_service(&rp, &replica_rp, RS_SWAP, 0);
   if(r != OK) {
@@ -2151,6 +2191,115 @@ char *caller_label;
 	return NULL; /* done */
 }
 
+/*===========================================================================*
+ *			     service_deps_ready				     *
+ *===========================================================================*/
+int service_deps_ready(struct rproc *rp)
+{
+/* Check whether all the services that the given (not yet started) service
+ * depends on have completed initialization. The dependencies of a service are
+ * approximated by its IPC target list: a service cannot usefully talk to a
+ * peer that is not up yet. Dependencies are only ever unsatisfied when
+ * services are started concurrently (RSS_NOBLOCK); sequential startup
+ * trivially satisfies them. Names in the IPC list that do not match a known
+ * service (kernel tasks, "SYSTEM", "USER", not-yet-requested services) do not
+ * count as dependencies.
+ */
+  char name[RS_MAX_LABEL_LEN+1], *p;
+  struct rproc *rrp;
+
+  /* Services with a wildcard IPC list have no specific dependencies. */
+  if (!rp->r_ipc_list[0] || !strcmp(rp->r_ipc_list, RSS_IPC_ALL)
+      || !strcmp(rp->r_ipc_list, RSS_IPC_ALL_SYS)) {
+      return TRUE;
+  }
+
+  p = rp->r_ipc_list;
+
+  while ((p = get_next_name(p, name, rp->r_pub->label)) != NULL) {
+      for (rrp = BEG_RPROC_ADDR; rrp < END_RPROC_ADDR; rrp++) {
+          if (!(rrp->r_flags & RS_IN_USE) || rrp == rp) {
+              continue;
+          }
+          if (strcmp(rrp->r_pub->proc_name, name) != 0) {
+              continue;
+          }
+          if (rrp->r_flags &
+              (RS_INITIALIZING|RS_START_PENDING|RS_RESTART_PENDING)) {
+              return FALSE;
+          }
+      }
+  }
+
+  return TRUE;
+}
+
+/*===========================================================================*
+ *			   start_pending_services			     *
+ *===========================================================================*/
+void start_pending_services(void)
+{
+/* Start services whose start was deferred until their dependencies completed
+ * initialization. This implements dependency-ordered concurrent startup: a
+ * batch of noblock RS_UP requests is accepted right away, while the actual
+ * starts are issued from here as the services they depend on become ready.
+ * As a safety net against dependency cycles and wedged dependencies, a
+ * service is started unconditionally once it has been pending for as long as
+ * we allow initialization to take.
+ */
+  struct rproc *rp;
+  message m;
+  endpoint_t caller;
+  int r, force, late;
+
+  if (shutting_down) {
+      return;
+  }
+
+  for (rp = BEG_RPROC_ADDR; rp < END_RPROC_ADDR; rp++) {
+      if (!(rp->r_flags & (RS_START_PENDING|RS_RESTART_PENDING))) {
+          continue;
+      }
+
+      force = (getticks() - rp->r_check_tm > RS_INIT_T);
+      if (!force && !service_deps_ready(rp)) {
+          continue;
+      }
+
+      if (rs_verbose)
+          printf("RS: %s dependencies %s, starting\n", srv_to_string(rp),
+              force ? "timed out" : "ready");
+
+      /* A deferred restart resumes where restart_service() left off; the
+       * function clears the pending flag itself.
+       */
+      if (rp->r_flags & RS_RESTART_PENDING) {
+          restart_service(rp);
+          continue;
+      }
+
+      /* Save the late reply state: start_service() rewrites the flags, and
+       * on failure it cleans up the slot entirely.
+       */
+      caller = rp->r_caller;
+      late = !!(rp->r_flags & RS_LATEREPLY);
+      rp->r_flags &= ~(RS_START_PENDING|RS_LATEREPLY);
+
+      r = start_service(rp, rp->r_init_flags);
+      if (r == OK && late) {
+          /* Reply when the service completes initialization. */
+          rp->r_flags |= RS_LATEREPLY;
+          rp->r_caller = caller;
+          rp->r_caller_request = RS_UP;
+      }
+      else if (r != OK && late) {
+          /* The slot has already been cleaned up; unblock the caller. */
+          m.m_type = r;
+          reply(caller, NULL, &m);
+      }
+  }
+}
+
 /*===========================================================================*
  *				add_forward_ipc				     *
  *===========================================================================*/
@@ -2190,6 +2339,10 @@ struct priv *privp;
 				if (!(rrp->r_flags & RS_IN_USE))
 					continue;
 
+				/* Pending services have no privileges yet. */
+				if (rrp->r_flags & RS_START_PENDING)
+					continue;
+
 				if (!strcmp(rrp->r_pub->proc_name, name)) {
 #if PRIV_DEBUG
 					printf("  RS: add_forward_ipc: setting"
@@ -2249,6 +2402,10 @@ struct priv *privp;
 		if (!(rrp->r_flags & RS_IN_USE))
 			continue;
 
+		/* Pending services have no privileges yet. */
+		if (rrp->r_flags & RS_START_PENDING)
+			continue;
+
 		if (!rrp->r_ipc_list[0])
 			continue;
 
@@ -64,6 +64,8 @@ int publish_service(struct rproc *rp);
 int unpublish_service(struct rproc *rp);
 int run_service(struct rproc *rp, int init_type, int init_flags);
 int start_service(struct rproc *rp, int init_flags);
+int service_deps_ready(struct rproc *rp);
+void start_pending_services(void);
 void stop_service(struct rproc *rp,int how);
 void activate_service(struct rproc *rp, struct rproc *ex_rp);
 void terminate_service(struct rproc *rp);
@@ -123,6 +125,9 @@ int abort_update_proc(int reason);
 void end_update_debug(char *file, int line,
         int result, int reply_flag);
 
+/* bootprof.c */
+void bootprof_init(void);
+
 /* utility.c */
 int init_service(struct rproc *rp, int type, int flags);
 int fi_service(struct rproc *rp);
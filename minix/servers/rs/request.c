@@ -86,6 +86,38 @@ message *m_ptr;					/* request message pointer */
       }
   }
 
+  /* If the service declares IPC dependencies on services that are still
+   * initializing or are themselves pending, defer the start until those
+   * services are ready. This lets a batch of concurrent (noblock) RS_UP
+   * requests be issued in any order, with RS starting the services in
+   * dependency order; see start_pending_services(). Sequentially issued
+   * requests always have their dependencies satisfied and start right away.
+   */
+  if(!service_deps_ready(rp)) {
+      if(rs_verbose)
+          printf("RS: deferring start of '%s' until its dependencies are"
+              " ready\n", rpub->label);
+      rp->r_flags = RS_IN_USE | RS_ACTIVE | RS_START_PENDING;
+      rp->r_init_flags = init_flags;
+      rp->r_pid = -1;                    /* no process yet */
+      rp->r_backoff = 0;
+      rp->r_stop_tm = 0;
+      rp->r_alive_tm = getticks();
+      rp->r_check_tm = getticks();       /* time the start went pending */
+
+      /* Unblock the caller immediately if requested. */
+      if(noblock) {
+          return OK;
+      }
+
+      /* Late reply - send a reply when service completes initialization. */
+      rp->r_flags |= RS_LATEREPLY;
+      rp->r_caller = m_ptr->m_source;
+      rp->r_caller_request = RS_UP;
+
+      return EDONTREPLY;
+  }
+
   /* All information was gathered. Now try to start the system service. */
   r = start_service(rp, init_flags);
   if(r != OK) {
@@ -133,6 +165,17 @@ int do_down(message *m_ptr)
   if((s = check_call_permission(m_ptr->m_source, RS_DOWN, rp)) != OK)
       return s;
 
+  /* If the service has not actually been started yet, simply cancel the
+   * pending start: there is no process to stop. This also unblocks the
+   * RS_UP caller, if any.
+   */
+  if (rp->r_flags & RS_START_PENDING) {
+      if(rs_verbose)
+          printf("RS: cancelling pending start of '%s'\n", rp->r_pub->label);
+      free_slot(rp);
+      return(OK);
+  }
+
   /* Stop service. */
   if (rp->r_flags & RS_TERMINATED) {
         /* A recovery script is requesting us to bring down the service.
@@ -499,6 +542,17 @@ int do_init_ready(message *m_ptr)
   if(rs_verbose)
       printf("RS: %s initialized\n", srv_to_string(rp));
 
+  /* Remember where this instance keeps its heartbeat counter, so that the
+   * periodic check can read it instead of pinging the service.
+   */
+  rp->r_hb_addr = m_ptr->m_rs_init.hb_addr;
+  rp->r_hb_count = 0;
+
+  /* Record the startup timestamps for the boot profile. */
+  rp->r_sef_ts = m_ptr->m_rs_init.sef_tsc;
+  rp->r_init_ts = m_ptr->m_rs_init.init_tsc;
+  read_frclock_64(&rp->r_ready_ts);
+
   /* If updating, check if there is no service to update left. In that case,
    * end the update process. If VM has completed initialization as part of
    * multi-component live update, let the other services under update run now.
@@ -948,6 +1002,7 @@ message *m_ptr;
   clock_t now = m_ptr->m_notify.timestamp;
   int s;
   long period;
+  unsigned long hb_count;
 
   /* If an update is in progress, check its status. */
   if(RUPDATE_IS_UPDATING() && !RUPDATE_IS_INITIALIZING()) {
@@ -960,7 +1015,10 @@ message *m_ptr;
   for (rp=BEG_RPROC_ADDR; rp<END_RPROC_ADDR; rp++) {
       rpub = rp->r_pub;
 
-      if ((rp->r_flags & RS_ACTIVE) && (!SRV_IS_UPDATING(rp) || ((rp->r_flags & (RS_INITIALIZING|RS_INIT_DONE|RS_INIT_PENDING)) == RS_INITIALIZING))) {
+      /* Pending services have no process to check yet; they are taken care
+       * of by start_pending_services().
+       */
+      if ((rp->r_flags & RS_ACTIVE) && !(rp->r_flags & (RS_START_PENDING|RS_RESTART_PENDING)) && (!SRV_IS_UPDATING(rp) || ((rp->r_flags & (RS_INITIALIZING|RS_INIT_DONE|RS_INIT_PENDING)) == RS_INITIALIZING))) {
 
           /* Compute period. */
           period = rp->r_period;
@@ -1004,16 +1062,21 @@ message *m_ptr;
               if (rp->r_alive_tm < rp->r_check_tm) { 
 	          if (now - rp->r_alive_tm > 2*period &&
 		      rp->r_pid > 0 && !(rp->r_flags & RS_NOPINGREPLY)) {
-		      struct rproc *rp2;
-		      int init_flag;
+		      int deps_ready, init_flag;
 		      if(rs_verbose)
                            printf("RS: %s reported late\n", srv_to_string(rp)); 
                       init_flag = rp->r_flags & RS_INITIALIZING;
                       rp->r_flags &= ~RS_INITIALIZING;
-                      rp2 = lookup_slot_by_flags(RS_INITIALIZING);
+                      deps_ready = service_deps_ready(rp);
                       rp->r_flags |= init_flag;
-		      if(rp2 != NULL && !SRV_IS_UPDATING(rp)) {
-                           /* Skip for now. */
+		      if(!deps_ready && !SRV_IS_UPDATING(rp)) {
+                           /* The service may only be late because one of its
+                            * dependencies is restarting or initializing; give
+                            * it a free pass for now. Unrelated initializing
+                            * services no longer delay detection, so that
+                            * correlated failures are detected and restarted
+                            * concurrently rather than one after another.
+                            */
                            if(rs_verbose)
                                printf("RS: %s gets a free pass\n",
                                    srv_to_string(rp)); 
@@ -1030,11 +1093,25 @@ message *m_ptr;
 	      }
 
 	      /* No answer pending. Check if a period expired since the last
-	       * check and, if so request the system service's status.
+	       * check and, if so request the system service's status. First
+	       * look at the service's heartbeat counter; if the message loop
+	       * has taken in messages since the last check, the service is
+	       * demonstrably alive and there is no need to wake it up with a
+	       * ping. Only idle or wedged services get the actual IPC ping.
 	       */
 	      else if (now - rp->r_check_tm > rp->r_period) {
-  		  ipc_notify(rpub->endpoint);		/* request status */
-		  rp->r_check_tm = now;			/* mark time */
+		  if (rp->r_hb_addr != 0 &&
+		      sys_datacopy(rpub->endpoint, rp->r_hb_addr,
+			SELF, (vir_bytes) &hb_count, sizeof(hb_count)) == OK &&
+		      hb_count != rp->r_hb_count) {
+		      rp->r_hb_count = hb_count;	/* made progress */
+		      rp->r_alive_tm = now;
+		      rp->r_check_tm = now;
+		  }
+		  else {
+  		      ipc_notify(rpub->endpoint);	/* request status */
+		      rp->r_check_tm = now;		/* mark time */
+		  }
               }
           }
       }
@@ -67,11 +67,20 @@ struct rproc {
   long r_backoff;		/* number of periods to wait before revive */
   unsigned r_flags; 		/* status and policy flags */
   int r_init_err;               /* error code at initialization time */
+  int r_init_flags;             /* init flags saved for a pending start */
 
   long r_period;		/* heartbeat period (or zero) */
   clock_t r_check_tm;		/* timestamp of last check */
   clock_t r_alive_tm;		/* timestamp of last heartbeat */
+  vir_bytes r_hb_addr;		/* heartbeat counter address (or zero) */
+  unsigned long r_hb_count;	/* last heartbeat counter value seen */
   clock_t r_stop_tm;		/* timestamp of SIGTERM signal */
+
+  /* Startup profiling: free-running clock values, as exported by bootprof.c */
+  u64_t r_start_ts;		/* initialization request sent */
+  u64_t r_sef_ts;		/* service entered sef_startup() */
+  u64_t r_init_ts;		/* service completed initialization */
+  u64_t r_ready_ts;		/* initialization reply received */
   endpoint_t r_caller;		/* RS_LATEREPLY caller */
   int r_caller_request;		/* RS_LATEREPLY caller request */
 
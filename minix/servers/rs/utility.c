@@ -24,6 +24,10 @@ int init_service(struct rproc *rp, int type, int flags)
   rp->r_flags |= RS_INITIALIZING;              /* now initializing */
   rp->r_alive_tm = getticks();
   rp->r_check_tm = rp->r_alive_tm + 1;         /* expect reply within period */
+  rp->r_hb_addr = 0;                           /* new instance reports its own */
+  rp->r_hb_count = 0;
+  read_frclock_64(&rp->r_start_ts);            /* startup profiling epoch */
+  rp->r_sef_ts = rp->r_init_ts = rp->r_ready_ts = 0;
 
   /* In case of RS initialization, we are done. */
   if(rp->r_priv.s_flags & ROOT_SYS_PROC) {
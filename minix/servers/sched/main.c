@@ -65,6 +65,12 @@ int main(void)
 		case SCHEDULING_SET_NICE:
 			result = do_nice(&m_in);
 			break;
+		case SCHEDULING_SET_BUDGET:
+			result = do_set_budget(&m_in);
+			break;
+		case SCHEDULING_SET_CPU:
+			result = do_set_cpu(&m_in);
+			break;
 		case SCHEDULING_NO_QUANTUM:
 			/* This message was sent from the kernel, don't reply */
 			if (IPC_STATUS_FLAGS_TEST(ipc_status,
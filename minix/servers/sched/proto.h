@@ -11,6 +11,8 @@ int do_noquantum(message *m_ptr);
 int do_start_scheduling(message *m_ptr);
 int do_stop_scheduling(message *m_ptr);
 int do_nice(message *m_ptr);
+int do_set_budget(message *m_ptr);
+int do_set_cpu(message *m_ptr);
 void init_scheduling(void);
 void balance_queues(void);
 
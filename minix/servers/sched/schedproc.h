@@ -26,6 +26,21 @@ EXTERN struct schedproc {
 	unsigned time_slice;		/* this process's time slice */
 	unsigned tickets;		/* this process's tickets */
 	unsigned is_sys_proc;   /* this process's is_proc bit */
+
+	/* Budget scheduling class */
+	unsigned budget;	/* reserved quanta per balance period (0 = off) */
+	unsigned budget_left;	/* quanta left in the current period */
+
+	int cpu;		/* cpu the process is pinned to, or -1 */
+
+	/* Kernel accounting, copied out of the out-of-quantum message. The
+	 * kernel resets its counters after each message, so these cover the
+	 * last full quantum only.
+	 */
+	unsigned acnt_queue;	/* ms spent waiting in the run queue */
+	unsigned acnt_deqs;	/* number of times dequeued */
+	unsigned acnt_preempt;	/* involuntary preemptions */
+	unsigned bonus_tickets;	/* extra tickets for starved processes */
 } schedproc[NR_PROCS];
 
 /* Flag values */
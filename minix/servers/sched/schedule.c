@@ -26,6 +26,13 @@ FORWARD _PROTOTYPE( void balance_queues, (struct timer *tp)		);
 
 #define DYNAMIC 0
 
+/* Queue that budget-class processes run in while they still have quanta
+ * left in the current balance period. It sits above the lottery queues
+ * (14/15) but below the queues used by system processes, so a reservation
+ * cannot starve the servers and drivers it depends on.
+ */
+#define RT_USER_Q 13
+
 /*===========================================================================*
  *				lottery				     *
  *===========================================================================*/
@@ -40,7 +47,7 @@ FORWARD _PROTOTYPE( void balance_queues, (struct timer *tp)		);
 	/* Add each participants tickets to the total pile of tickets*/
 	for (proc_nr=0, rmp=schedproc; proc_nr < NR_PROCS; proc_nr++, rmp++) {
 		if ((rmp->flags & IN_USE && rmp->is_sys_proc != 1) && rmp->priority == 15) {
-			total_tickets += rmp->tickets;
+			total_tickets += rmp->tickets + rmp->bonus_tickets;
 		}
 	}
 	
@@ -50,7 +57,7 @@ FORWARD _PROTOTYPE( void balance_queues, (struct timer *tp)		);
 		for (proc_nr=0, rmp=schedproc; proc_nr < NR_PROCS; proc_nr++, rmp++) {
 			if ((rmp->flags & IN_USE && rmp->is_sys_proc != 1) && rmp->priority == 15) {
 				if (winner > 0) {
-					winner -= rmp->tickets;
+					winner -= rmp->tickets + rmp->bonus_tickets;
 					/*printf("Winners previous priority: %d\n", rmp->priority);*/
 					if (winner <=0 && rmp->priority == 15) {
 						/*printf("Winners previous priority: %d\n", rmp->priority);*/
@@ -82,6 +89,26 @@ PUBLIC int do_noquantum(message *m_ptr)
 	}
 
 	rmp = &schedproc[proc_nr_n];
+
+	/* Record the accounting that the kernel collected over this quantum,
+	 * so the policy below gets to see actual run-queue delays instead of
+	 * deciding blind.
+	 */
+	rmp->acnt_queue   = (unsigned) m_ptr->m_krn_lsys_schedule.acnt_queue;
+	rmp->acnt_deqs    = (unsigned) m_ptr->m_krn_lsys_schedule.acnt_deqs;
+	rmp->acnt_preempt = (unsigned) m_ptr->m_krn_lsys_schedule.acnt_preempt;
+
+	/* Latency compensation: a lottery-class process that spent much
+	 * longer waiting in the run queue than its own slice is being starved
+	 * by the rest of the pool. Grant it bonus tickets so the coming
+	 * drawings favor it; balance_queues() decays the bonus again.
+	 */
+	if (rmp->is_sys_proc != 1 && rmp->budget == 0 &&
+			rmp->acnt_queue > 4 * rmp->time_slice &&
+			rmp->bonus_tickets < rmp->tickets) {
+		rmp->bonus_tickets++;
+	}
+
 	if (rmp->is_sys_proc == 1 && rmp->priority < (MAX_USER_Q - 1)) {
 		rmp->priority += 1; /* lower priority */
 	}
@@ -89,7 +116,20 @@ PUBLIC int do_noquantum(message *m_ptr)
 	if (rmp->is_sys_proc == 1 && (rv = schedule_process(rmp)) != OK) {
 		return rv;
 	}
-	
+
+	/* Budget-class procs burn one quantum of their reservation. They keep
+	 * their high queue while quanta remain and drop into the lottery pool
+	 * when the reservation for this period is used up; balance_queues()
+	 * replenishes them. They never take part in the ticket accounting.
+	 */
+	if (rmp->is_sys_proc != 1 && rmp->budget > 0) {
+		if (rmp->budget_left > 0)
+			rmp->budget_left--;
+		if (rmp->budget_left == 0 && rmp->priority == RT_USER_Q)
+			rmp->priority = MIN_USER_Q;
+		return schedule_process(rmp);
+	}
+
 	if(DYNAMIC){
 		/* This part of our code decreases the number of tickets if a process uses all of its quantum */
 		if(rmp->is_sys_proc != 1 && rmp->priority == MAX_USER_Q){
@@ -183,9 +223,17 @@ PUBLIC int do_start_scheduling(message *m_ptr)
 		return EINVAL;
 	}
 	
-	/* Give 20 tickets */
+	/* Give 20 tickets. Budget reservations are per process and are not
+	 * inherited across fork; they have to be requested explicitly. */
 	rmp->tickets = 20;
 	rmp->is_sys_proc = 0;
+	rmp->budget = 0;
+	rmp->budget_left = 0;
+	rmp->cpu = -1;
+	rmp->acnt_queue = 0;
+	rmp->acnt_deqs = 0;
+	rmp->acnt_preempt = 0;
+	rmp->bonus_tickets = 0;
 	switch (m_ptr->m_type) {
 
 	case SCHEDULING_START:
@@ -209,6 +257,8 @@ PUBLIC int do_start_scheduling(message *m_ptr)
 		/* New user-proc get set to priority 15*/
 		rmp->priority = 15;
 		rmp->time_slice = schedproc[parent_nr_n].time_slice;
+		/* A child starts out on the cpu its parent is pinned to. */
+		rmp->cpu = schedproc[parent_nr_n].cpu;
 		break;
 		
 	default: 
@@ -306,6 +356,81 @@ PUBLIC int do_nice(message *m_ptr)
 	return rv;
 }
 
+/*===========================================================================*
+ *				do_set_budget				     *
+ *===========================================================================*/
+PUBLIC int do_set_budget(message *m_ptr)
+{
+	struct schedproc *rmp;
+	int proc_nr_n;
+	int budget;
+
+	/* check who can send you requests */
+	if (!accept_message(m_ptr))
+		return EPERM;
+
+	if (sched_isokendpt(m_ptr->SCHEDULING_ENDPOINT, &proc_nr_n) != OK) {
+		printf("SCHED: WARNING: got an invalid endpoint in OOQ msg "
+		"%ld\n", m_ptr->SCHEDULING_ENDPOINT);
+		return EBADEPT;
+	}
+
+	rmp = &schedproc[proc_nr_n];
+
+	/* System processes already run at a fixed high priority; a budget on
+	 * top of that makes no sense. */
+	if (rmp->is_sys_proc == 1)
+		return EINVAL;
+
+	/* The reservation, in quanta per balance period, travels in the same
+	 * message field that do_nice uses for its value. Zero switches the
+	 * process back to the plain lottery class. */
+	budget = m_ptr->SCHEDULING_MAXPRIO;
+	if (budget < 0)
+		return EINVAL;
+
+	rmp->budget = (unsigned) budget;
+	rmp->budget_left = rmp->budget;
+	rmp->priority = (rmp->budget > 0) ? RT_USER_Q : MIN_USER_Q;
+
+	return schedule_process(rmp);
+}
+
+/*===========================================================================*
+ *				do_set_cpu				     *
+ *===========================================================================*/
+PUBLIC int do_set_cpu(message *m_ptr)
+{
+	struct schedproc *rmp;
+	int proc_nr_n;
+	int cpu;
+
+	/* check who can send you requests */
+	if (!accept_message(m_ptr))
+		return EPERM;
+
+	if (sched_isokendpt(m_ptr->SCHEDULING_ENDPOINT, &proc_nr_n) != OK) {
+		printf("SCHED: WARNING: got an invalid endpoint in OOQ msg "
+		"%ld\n", m_ptr->SCHEDULING_ENDPOINT);
+		return EBADEPT;
+	}
+
+	rmp = &schedproc[proc_nr_n];
+
+	/* The cpu to pin to travels in the same message field that do_nice
+	 * uses for its value; -1 releases the pin and lets the kernel place
+	 * the process again. The kernel migrates a runnable process when its
+	 * cpu changes, so a reschedule is all that is needed here.
+	 */
+	cpu = m_ptr->SCHEDULING_MAXPRIO;
+	if (cpu < -1 || cpu >= (int) machine.processors_count)
+		return EINVAL;
+
+	rmp->cpu = cpu;
+
+	return schedule_process(rmp);
+}
+
 /*===========================================================================*
  *				schedule_process			     *
  *===========================================================================*/
@@ -314,7 +439,7 @@ PRIVATE int schedule_process(struct schedproc * rmp)
 	int rv;
 
 	if ((rv = sys_schedule(rmp->endpoint, rmp->priority,
-			rmp->time_slice)) != OK) {
+			rmp->time_slice, rmp->cpu, 0)) != OK) {
 		printf("SCHED: An error occurred when trying to schedule %d: %d\n",
 		rmp->endpoint, rv);
 	}
@@ -354,6 +479,21 @@ PRIVATE void balance_queues(struct timer *tp)
 
 	for (proc_nr=0, rmp=schedproc; proc_nr < NR_PROCS; proc_nr++, rmp++) {
 		if (rmp->flags & IN_USE) {
+			/* Start a new period for budget-class procs: refill
+			 * the reservation and put them back in their queue.
+			 */
+			if (rmp->is_sys_proc != 1 && rmp->budget > 0) {
+				rmp->budget_left = rmp->budget;
+				if (rmp->priority != RT_USER_Q) {
+					rmp->priority = RT_USER_Q;
+					schedule_process(rmp);
+				}
+				continue;
+			}
+			/* Let latency bonuses fade out so a once-starved
+			 * process does not keep its edge forever.
+			 */
+			rmp->bonus_tickets /= 2;
 			if (rmp->priority > rmp->max_priority &&
 				rmp->priority < 14) {
 				rmp->priority -= 1; /* increase priority */
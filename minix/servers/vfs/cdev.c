@@ -125,10 +125,9 @@ cdev_clone(int fd, dev_t dev, devminor_t new_minor)
 	unlock_vnode(fp->fp_filp[fd]->filp_vno);
 	put_vnode(fp->fp_filp[fd]->filp_vno);
 
-	vp->v_fs_e = res.fs_e;
+	enter_vnode(vp, res.fs_e, res.inode_nr);
 	vp->v_vmnt = NULL;
 	vp->v_dev = NO_DEV;
-	vp->v_inode_nr = res.inode_nr;
 	vp->v_mode = res.fmode;
 	vp->v_sdev = dev;
 	vp->v_fs_count = 1;
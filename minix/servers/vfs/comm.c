@@ -66,21 +66,48 @@ void fs_cancel(struct vmnt *vmp)
 void fs_sendmore(struct vmnt *vmp)
 {
   struct worker_thread *worker;
+  asynvec_t batch[NR_WTHREADS];
+  int nbatch = 0, r, transid;
 
   /* Can we send more requests? */
   if (vmp->m_fs_e == NONE) return;
-  if ((worker = vmp->m_comm.c_req_queue) == NULL) /* No process is queued */
-	return;
-  if (vmp->m_comm.c_cur_reqs >= vmp->m_comm.c_max_reqs)/*No room to send more*/
-	return;
   if (vmp->m_flags & VMNT_CALLBACK)	/* Hold off for now */
 	return;
 
-  vmp->m_comm.c_req_queue = worker->w_next; /* Remove head */
-  worker->w_next = NULL;
-  sending--;
-  assert(sending >= 0);
-  (void) sendmsg(vmp, vmp->m_fs_e, worker);
+  /* Drain as many queued requests as the FS allows us to have outstanding.
+   * The request headers are handed to the kernel in a single vectored
+   * asynchronous send, so that working off a backlog costs one kernel trap
+   * instead of one trap per request. This matters for metadata-heavy
+   * workloads where many workers queue up small requests on the same vmnt.
+   */
+  while ((worker = vmp->m_comm.c_req_queue) != NULL &&
+	vmp->m_comm.c_cur_reqs < vmp->m_comm.c_max_reqs) {
+
+	assert(nbatch < NR_WTHREADS);
+
+	vmp->m_comm.c_req_queue = worker->w_next; /* Remove head */
+	worker->w_next = NULL;
+	sending--;
+	assert(sending >= 0);
+
+	vmp->m_comm.c_cur_reqs++;	/* One more request awaiting a reply */
+	transid = worker->w_tid + VFS_TRANSID;
+	worker->w_sendrec->m_type = TRNS_ADD_ID(worker->w_sendrec->m_type,
+		transid);
+	worker->w_task = vmp->m_fs_e;
+
+	batch[nbatch].dst = vmp->m_fs_e;
+	batch[nbatch].msg = *worker->w_sendrec;
+	nbatch++;
+  }
+
+  if (nbatch == 0) return;
+
+  if ((r = asynsendv(batch, nbatch, AMF_NOREPLY)) != OK) {
+	printf("VFS: fs_sendmore: error sending %d message(s). "
+		"dest: %d err: %d\n", nbatch, vmp->m_fs_e, r);
+	util_stacktrace();
+  }
 }
 
 /*===========================================================================*
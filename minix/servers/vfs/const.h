@@ -6,12 +6,18 @@
 #define NR_LOCKS           8	/* # slots in the file locking table */
 #define NR_MNTS           16 	/* # slots in mount table */
 #define NR_VNODES       1024	/* # slots in vnode table */
-#define NR_WTHREADS	   9	/* # slots in worker thread table */
+#define NR_WTHREADS	  32	/* # slots in worker thread table */
+#define DFLT_NR_WTHREADS  16	/* default # worker threads started */
 #define NR_SOCKDEVS	   8	/* # slots in smap table */
+#define NR_PIPE_BUFS	  32	/* # in-VFS pipe data buffers */
 
 #define NR_NONEDEVS	NR_MNTS	/* # slots in nonedev bitmap */
 
 /* Miscellaneous constants */
+#define NR_SENDFILE_BUFS  16	/* # in-VFS sendfile data buffers */
+#define SENDFILE_BUFSIZ	65536	/* sendfile(2) per-transfer buffer size */
+#define STATCACHE_TTL	(system_hz)	/* attribute cache validity period,
+					 * in ticks; see cached_stat() */
 #define SU_UID 	 ((uid_t) 0)	/* super_user's uid_t */
 #define SYS_UID  ((uid_t) 0)	/* uid_t for system processes and INIT */
 #define SYS_GID  ((gid_t) 0)	/* gid_t for system processes and INIT */
@@ -0,0 +1,123 @@
+/* This file implements the directory name cache: a cache of recently looked
+ * up directory entries, mapping the identity of a directory plus a component
+ * name to the identity of the vnode that the name resolved to. It allows
+ * advance() to resolve repeated lookups of hot names without sending a
+ * lookup request to the FS, provided the result is still in the vnode table.
+ *
+ * Entries are keyed on identities rather than vnode slots, so slot reuse
+ * cannot cause a stale hit; a stale entry simply misses. Name bindings can
+ * only change through VFS itself, which invalidates affected entries on
+ * unlink, rmdir, and rename, and flushes the whole cache on mount and
+ * unmount.
+ *
+ * The entry points into this file are:
+ *  lookup_dcache - find a cached (directory, name) to identity mapping
+ *  enter_dcache  - add a mapping to the cache
+ *  del_dcache    - remove a mapping from the cache
+ *  flush_dcache  - remove all mappings from the cache
+ */
+
+#include "fs.h"
+#include <string.h>
+
+#define NR_DENTRIES	1024	/* # slots in the name cache */
+#define DNAME_MAX	47	/* only short names are worth caching */
+
+static struct dentry {
+  endpoint_t d_dir_fs_e;	/* FS endpoint of the directory, or NONE */
+  ino_t d_dir_inode_nr;		/* inode number of the directory */
+  char d_name[DNAME_MAX+1];	/* component name within the directory */
+  endpoint_t d_fs_e;		/* FS endpoint the name maps to */
+  ino_t d_inode_nr;		/* inode number the name maps to */
+} dcache[NR_DENTRIES];
+
+/*===========================================================================*
+ *				dcache_slot				     *
+ *===========================================================================*/
+static struct dentry *dcache_slot(endpoint_t dir_fs_e, ino_t dir_ino,
+	const char *name)
+{
+/* Return the cache slot for the given directory and component name. The
+ * cache is direct-mapped: each (directory, name) pair maps to exactly one
+ * slot, which keeps lookup and invalidation trivial.
+ */
+  unsigned int h;
+  const char *cp;
+
+  h = (unsigned int) dir_fs_e ^ (unsigned int) dir_ino;
+  for (cp = name; *cp != '\0'; cp++)
+	h = h * 33 + (unsigned char) *cp;
+
+  return(&dcache[h % NR_DENTRIES]);
+}
+
+/*===========================================================================*
+ *				lookup_dcache				     *
+ *===========================================================================*/
+int lookup_dcache(endpoint_t dir_fs_e, ino_t dir_ino, const char *name,
+	endpoint_t *fs_e, ino_t *ino)
+{
+/* See if the cache knows what identity 'name' within the given directory
+ * maps to. Return TRUE with the identity stored in 'fs_e' and 'ino' iff a
+ * mapping was found.
+ */
+  struct dentry *dp;
+
+  if (strlen(name) > DNAME_MAX) return(FALSE);
+
+  dp = dcache_slot(dir_fs_e, dir_ino, name);
+  if (dp->d_dir_fs_e != dir_fs_e || dp->d_dir_inode_nr != dir_ino ||
+      strcmp(dp->d_name, name) != 0)
+	return(FALSE);
+
+  *fs_e = dp->d_fs_e;
+  *ino = dp->d_inode_nr;
+  return(TRUE);
+}
+
+/*===========================================================================*
+ *				enter_dcache				     *
+ *===========================================================================*/
+void enter_dcache(endpoint_t dir_fs_e, ino_t dir_ino, const char *name,
+	endpoint_t fs_e, ino_t ino)
+{
+/* Add a mapping to the cache, replacing whatever happens to be in its slot. */
+  struct dentry *dp;
+
+  if (strlen(name) > DNAME_MAX) return;
+
+  dp = dcache_slot(dir_fs_e, dir_ino, name);
+  dp->d_dir_fs_e = dir_fs_e;
+  dp->d_dir_inode_nr = dir_ino;
+  strlcpy(dp->d_name, name, sizeof(dp->d_name));
+  dp->d_fs_e = fs_e;
+  dp->d_inode_nr = ino;
+}
+
+/*===========================================================================*
+ *				del_dcache				     *
+ *===========================================================================*/
+void del_dcache(endpoint_t dir_fs_e, ino_t dir_ino, const char *name)
+{
+/* Remove the mapping for 'name' within the given directory, if cached. */
+  struct dentry *dp;
+
+  if (strlen(name) > DNAME_MAX) return;
+
+  dp = dcache_slot(dir_fs_e, dir_ino, name);
+  if (dp->d_dir_fs_e == dir_fs_e && dp->d_dir_inode_nr == dir_ino &&
+      strcmp(dp->d_name, name) == 0)
+	dp->d_dir_fs_e = NONE;
+}
+
+/*===========================================================================*
+ *				flush_dcache				     *
+ *===========================================================================*/
+void flush_dcache(void)
+{
+/* Remove all mappings from the cache. */
+  struct dentry *dp;
+
+  for (dp = &dcache[0]; dp < &dcache[NR_DENTRIES]; dp++)
+	dp->d_dir_fs_e = NONE;
+}
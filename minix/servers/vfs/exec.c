@@ -327,6 +327,7 @@ int pm_exec(vir_bytes path, size_t path_len, vir_bytes frame, size_t frame_len,
 			newfilp->filp_vno = vp;
 			newfilp->filp_flags = O_RDONLY;
 			vmfp->fp_filp[newfd] = newfilp;
+			SET_BIT(vmfp->fp_filp_map, newfd);
 			/* dup_vnode(vp); */
 			execi.vmfd = newfd;
 			execi.args.memmap = vfs_memmap;
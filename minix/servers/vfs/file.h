@@ -2,13 +2,16 @@
 #define __VFS_FILE_H__
 
 /* This is the filp table.  It is an intermediary between file descriptors and
- * inodes.  A slot is free if filp_count == 0.
+ * inodes.  A slot is free if filp_count == 0.  Free slots are linked on a
+ * free list; a slot that is not on the free list has filp_free_next pointing
+ * to the slot itself.
  */
 
 EXTERN struct filp {
   mode_t filp_mode;		/* RW bits, telling how file is opened */
   int filp_flags;		/* flags from open and fcntl */
   int filp_count;		/* how many file descriptors share this slot?*/
+  struct filp *filp_free_next;	/* next free slot, or this slot if in use */
   struct vnode *filp_vno;	/* vnode belonging to this file */
   off_t filp_pos;		/* file position */
   mutex_t filp_lock;		/* lock to gain exclusive access */
@@ -4,20 +4,24 @@
  *   get_fd:	    look for free file descriptor and free filp slots
  *   get_filp:	    look up the filp entry for a given file descriptor
  *   find_filp:	    find a filp slot that points to a given vnode
+ *   release_filp:  return an unused filp slot to the free list
  *   inval_filp:    invalidate a filp and associated fd's, only let close()
  *                  happen on it
- *   do_copyfd:     copies a file descriptor from or to another endpoint
+ *   do_copyfd:     copies file descriptors from or to another endpoint
  */
 
 #include <sys/select.h>
 #include <minix/callnr.h>
 #include <minix/u64.h>
+#include <minix/bitmap.h>
 #include <assert.h>
 #include <sys/stat.h>
 #include "fs.h"
 #include "file.h"
 #include "vnode.h"
 
+static struct filp *filp_freelist;	/* list of free filp slots */
+
 
 #if LOCK_DEBUG
 /*===========================================================================*
@@ -72,12 +76,15 @@ void check_filp_locks(void)
  *===========================================================================*/
 void init_filps(void)
 {
-/* Initialize filps */
+/* Initialize filps, putting all of them on the free list. */
   struct filp *f;
 
-  for (f = &filp[0]; f < &filp[NR_FILPS]; f++) {
+  filp_freelist = NULL;
+  for (f = &filp[NR_FILPS-1]; f >= &filp[0]; f--) {
 	if (mutex_init(&f->filp_lock, NULL) != 0)
 		panic("Failed to initialize filp mutex");
+	f->filp_free_next = filp_freelist;
+	filp_freelist = f;
   }
 
 }
@@ -95,7 +102,7 @@ int check_fds(struct fproc *rfp, int nfds)
   assert(nfds >= 1);
 
   for (i = 0; i < OPEN_MAX; i++) {
-	if (rfp->fp_filp[i] == NULL) {
+	if (!GET_BIT(rfp->fp_filp_map, i)) {
 		if (--nfds == 0)
 			return OK;
 	}
@@ -117,13 +124,21 @@ int get_fd(struct fproc *rfp, int start, mode_t bits, int *k, struct filp **fpt)
   register struct filp *f;
   register int i;
 
-  /* Search the fproc fp_filp table for a free file descriptor. */
-  for (i = start; i < OPEN_MAX; i++) {
-	if (rfp->fp_filp[i] == NULL) {
+  /* Search the in-use bitmap for a free file descriptor, skipping over whole
+   * chunks of taken slots at once.
+   */
+  for (i = start; i < OPEN_MAX; ) {
+	if (MAP_CHUNK(rfp->fp_filp_map, i) == (bitchunk_t) ~0) {
+		i = (i / BITCHUNK_BITS + 1) * BITCHUNK_BITS;
+		continue;
+	}
+	if (!GET_BIT(rfp->fp_filp_map, i)) {
 		/* A file descriptor has been located. */
+		assert(rfp->fp_filp[i] == NULL);
 		*k = i;
 		break;
 	}
+	i++;
   }
 
   /* Check to see if a file descriptor has been found. */
@@ -132,29 +147,56 @@ int get_fd(struct fproc *rfp, int start, mode_t bits, int *k, struct filp **fpt)
   /* If we don't care about a filp, return now */
   if (fpt == NULL) return(OK);
 
-  /* Now that a file descriptor has been found, look for a free filp slot. */
-  for (f = &filp[0]; f < &filp[NR_FILPS]; f++) {
-	assert(f->filp_count >= 0);
-	if (f->filp_count == 0 && mutex_trylock(&f->filp_lock) == 0) {
-		f->filp_mode = bits;
-		f->filp_pos = 0;
-		f->filp_selectors = 0;
-		f->filp_select_ops = 0;
-		f->filp_pipe_select_ops = 0;
-		f->filp_select_dev = NO_DEV;
-		f->filp_flags = 0;
-		f->filp_select_flags = 0;
-		f->filp_softlock = NULL;
-		f->filp_ioctl_fp = NULL;
-		*fpt = f;
-		return(OK);
-	}
+  /* Now that a file descriptor has been found, take a filp slot off the free
+   * list. The slot is not claimed yet: until the caller either claims it or
+   * releases it again, it is not on the free list, has a zero reference
+   * count, and is locked.
+   */
+  if ((f = filp_freelist) != NULL) {
+	assert(f->filp_count == 0);
+	if (mutex_trylock(&f->filp_lock) != 0)
+		panic("filp on free list is locked");
+	filp_freelist = f->filp_free_next;
+	f->filp_free_next = f;		/* mark as not on the free list */
+	f->filp_mode = bits;
+	f->filp_pos = 0;
+	f->filp_selectors = 0;
+	f->filp_select_ops = 0;
+	f->filp_pipe_select_ops = 0;
+	f->filp_select_dev = NO_DEV;
+	f->filp_flags = 0;
+	f->filp_select_flags = 0;
+	f->filp_softlock = NULL;
+	f->filp_ioctl_fp = NULL;
+	*fpt = f;
+	return(OK);
   }
 
   /* If control passes here, the filp table must be full.  Report that back. */
   return(ENFILE);
 }
 
+/*===========================================================================*
+ *				release_filp				     *
+ *===========================================================================*/
+void release_filp(struct filp *f)
+{
+/* Return an unused filp slot to the free list. The slot must either have just
+ * had its reference count drop to zero, or have come from get_fd() without
+ * being claimed after all. Releasing a slot that is already back on the free
+ * list is a harmless no-op; see common_open() for a case where the same slot
+ * may be abandoned through two paths.
+ */
+
+  assert(f->filp_count == 0);
+
+  if (f->filp_free_next != f)
+	return;				/* already on the free list */
+
+  f->filp_free_next = filp_freelist;
+  filp_freelist = f;
+}
+
 
 /*===========================================================================*
  *				get_filp				     *
@@ -494,9 +536,10 @@ close_filp(struct filp * f, int may_suspend)
   }
 
   if (--f->filp_count == 0) {
-	if (S_ISFIFO(vp->v_mode)) {
+	if (S_ISFIFO(vp->v_mode) && vp->v_pipe_buf == NULL) {
 		/* Last reader or writer is going. Tell PFS about latest
-		 * pipe size.
+		 * pipe size. Pipes buffered in VFS never store data on
+		 * PFS, so there is nothing to tell in that case.
 		 */
 		truncate_vnode(vp, vp->v_size);
 	}
@@ -506,6 +549,7 @@ close_filp(struct filp * f, int may_suspend)
 	f->filp_vno = NULL;
 	f->filp_mode = FILP_CLOSED;
 	f->filp_count = 0;
+	release_filp(f);
   } else if (f->filp_count < 0) {
 	panic("VFS: invalid filp count: %d ino %llx/%llu", f->filp_count,
 	      vp->v_dev, vp->v_inode_nr);
@@ -519,40 +563,19 @@ close_filp(struct filp * f, int may_suspend)
 }
 
 /*===========================================================================*
- *				do_copyfd				     *
+ *				copy_fd					     *
  *===========================================================================*/
-int do_copyfd(void)
+static int copy_fd(struct fproc *rfp, int fd, int what, int flags)
 {
-/* Copy a file descriptor between processes, or close a remote file descriptor.
- * This call is used as back-call by device drivers (UDS, VND), and is expected
- * to be used in response to either an IOCTL to VND or a SEND or RECV socket
- * request to UDS.
+/* Copy, or close, one file descriptor between the caller and the process
+ * identified by 'rfp', on behalf of do_copyfd() below.  Return the resulting
+ * file descriptor number (or OK for a close) on success, or a negative error
+ * code on failure.
  */
-  struct fproc *rfp;
   struct filp *rfilp;
   struct vnode *vp;
   struct smap *sp;
-  endpoint_t endpt;
-  int r, fd, what, flags, slot;
-
-  /* This should be replaced with an ACL check. */
-  if (!super_user) return(EPERM);
-
-  endpt = job_m_in.m_lsys_vfs_copyfd.endpt;
-  fd = job_m_in.m_lsys_vfs_copyfd.fd;
-  what = job_m_in.m_lsys_vfs_copyfd.what;
-
-  flags = what & COPYFD_FLAGS;
-  what &= ~COPYFD_FLAGS;
-
-  if (isokendpt(endpt, &slot) != OK) return(EINVAL);
-  rfp = &fproc[slot];
-
-  /* FIXME: we should now check that the user process is indeed blocked on an
-   * IOCTL or socket call, so that we can safely mess with its file
-   * descriptors.  We currently do not have the necessary state to verify this,
-   * so we assume that the call is always used in the right way.
-   */
+  int r;
 
   /* Depending on the operation, get the file descriptor from the caller or the
    * user process.  Do not lock the filp yet: we first need to make sure that
@@ -617,19 +640,15 @@ int do_copyfd(void)
 	/* FALLTHROUGH */
   case COPYFD_TO:
 	/* Find a free file descriptor slot in the local or remote process. */
-	for (fd = 0; fd < OPEN_MAX; fd++)
-		if (rfp->fp_filp[fd] == NULL)
-			break;
-
-	/* If found, fill the slot and return the slot number. */
-	if (fd < OPEN_MAX) {
+	if ((r = get_fd(rfp, 0, 0, &fd, NULL)) == OK) {
+		/* Fill the slot and return the slot number. */
 		rfp->fp_filp[fd] = rfilp;
+		SET_BIT(rfp->fp_filp_map, fd);
 		if (flags & COPYFD_CLOEXEC)
 			FD_SET(fd, &rfp->fp_cloexec_set);
 		rfilp->filp_count++;
 		r = fd;
-	} else
-		r = EMFILE;
+	}
 
 	break;
 
@@ -640,6 +659,7 @@ int do_copyfd(void)
 	if (rfilp->filp_count > 1) {
 		rfilp->filp_count--;
 		rfp->fp_filp[fd] = NULL;
+		UNSET_BIT(rfp->fp_filp_map, fd);
 		r = OK;
 	} else
 		r = EBADF;
@@ -654,3 +674,74 @@ int do_copyfd(void)
 
   return(r);
 }
+
+/*===========================================================================*
+ *				do_copyfd				     *
+ *===========================================================================*/
+int do_copyfd(void)
+{
+/* Copy file descriptors between processes, or close remote file descriptors.
+ * This call is used as back-call by device drivers (UDS, VND), and is expected
+ * to be used in response to either an IOCTL to VND or a SEND or RECV socket
+ * request to UDS.  A zero FD count denotes the original single-descriptor
+ * form of the call, which returns the resulting file descriptor number.  The
+ * batched form transfers up to COPYFD_MAX descriptors in one call, either all
+ * of them or none at all, and returns the resulting descriptor numbers in the
+ * reply message.
+ */
+  struct fproc *rfp;
+  endpoint_t endpt;
+  unsigned int i, j, nfds;
+  int r, fd, what, flags, slot;
+  int fds[COPYFD_MAX];
+
+  /* This should be replaced with an ACL check. */
+  if (!super_user) return(EPERM);
+
+  endpt = job_m_in.m_lsys_vfs_copyfd.endpt;
+  fd = job_m_in.m_lsys_vfs_copyfd.fd;
+  what = job_m_in.m_lsys_vfs_copyfd.what;
+  nfds = job_m_in.m_lsys_vfs_copyfd.nfds;
+
+  flags = what & COPYFD_FLAGS;
+  what &= ~COPYFD_FLAGS;
+
+  if (isokendpt(endpt, &slot) != OK) return(EINVAL);
+  rfp = &fproc[slot];
+
+  /* FIXME: we should now check that the user process is indeed blocked on an
+   * IOCTL or socket call, so that we can safely mess with its file
+   * descriptors.  We currently do not have the necessary state to verify this,
+   * so we assume that the call is always used in the right way.
+   */
+
+  if (nfds == 0)
+	return copy_fd(rfp, fd, what, flags);
+
+  if (nfds > COPYFD_MAX) return(EINVAL);
+
+  memcpy(fds, job_m_in.m_lsys_vfs_copyfd.fds, sizeof(fds[0]) * nfds);
+
+  r = OK;
+  for (i = 0; i < nfds; i++) {
+	if ((r = copy_fd(rfp, fds[i], what, flags)) < 0)
+		break;
+	fds[i] = r;
+  }
+
+  if (r < 0) {
+	/* All or nothing: revert the descriptors copied so far.  For a close
+	 * batch there is nothing to revert; the caller may retry the rest.
+	 */
+	if (what != COPYFD_CLOSE) {
+		for (j = 0; j < i; j++)
+			(void)copy_fd((what == COPYFD_TO) ? rfp : fp, fds[j],
+			    COPYFD_CLOSE, 0);
+	}
+	return(r);
+  }
+
+  memcpy(job_m_out.m_vfs_lsys_copyfds.fds, fds, sizeof(fds[0]) * nfds);
+
+  return(OK);
+}
@@ -4,6 +4,7 @@
 #include "threads.h"
 
 #include <sys/select.h>
+#include <minix/bitmap.h>
 #include <minix/safecopies.h>
 #include <minix/sef.h>
 
@@ -20,8 +21,11 @@ EXTERN struct fproc {
 
   struct vnode *fp_wd;		/* working directory; NULL during reboot */
   struct vnode *fp_rd;		/* root directory; NULL during reboot */
+  struct vnode *fp_atdir;	/* start directory for the current *at()
+				 * call, or NULL to use fp_wd */
 
   struct filp *fp_filp[OPEN_MAX];/* the file descriptor table (free if NULL) */
+  bitchunk_t fp_filp_map[BITMAP_CHUNKS(OPEN_MAX)];/* in-use map of fp_filp */
   fd_set fp_cloexec_set;	/* bit map for POSIX Table 6-2 FD_CLOEXEC */
 
   dev_t fp_tty;			/* major/minor of controlling tty */
@@ -54,8 +58,28 @@ EXTERN struct fproc {
 		int callnr;		/* user call: a VFS_ socket call */
 		cp_grant_id_t grant[3];	/* data grant(s) */
 		union ixfer_u_aux {
-			int fd;		/* listener file descr. (VFS_ACCEPT) */
+			struct {	/* VFS_ACCEPT and VFS_ACCEPT4 */
+				int fd;	     /* listener file descriptor */
+				int flags;   /* O_xx flags for the new FD
+					      * (VFS_ACCEPT4 only) */
+			} acc;
 			vir_bytes buf;	/* user buffer address (VFS_RECVMSG) */
+			struct {	/* VFS_SENDFILE */
+				int in_fd;   /* input file descriptor */
+				int bufidx;  /* sendfile data buffer index */
+				int filp_flags; /* socket file ptr flags */
+				off_t offset;	/* file offset of call */
+				size_t len;  /* total requested byte count */
+				size_t chunk;	/* byte count in flight */
+				size_t cum_io;	/* bytes sent so far */
+			} sf;
+			struct {	/* VFS_SENDMMSG, VFS_RECVMMSG */
+				vir_bytes base;	/* address of mmsghdr array */
+				unsigned int vlen;   /* # array elements */
+				unsigned int next;   /* element in flight */
+				int flags;   /* call flags (MSG_WAITFORONE) */
+				int filp_flags; /* socket file ptr flags */
+			} mmsg;
 		} aux;			/* call-specific auxiliary data */
 	} u_sdev;
   } fp_u;
@@ -70,6 +94,7 @@ EXTERN struct fproc {
 
   mutex_t fp_lock;		/* mutex to lock fproc object */
   struct worker_thread *fp_worker;/* active worker thread, or NULL */
+  struct fproc *fp_pend_next;	/* next process in pending work queue */
   void (*fp_func)(void);		/* handler function for pending work */
   message fp_msg;		/* pending or active message from process */
   message fp_pm_msg;		/* pending/active postponed PM request */
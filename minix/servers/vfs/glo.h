@@ -35,6 +35,7 @@ EXTERN struct worker_thread *self;
 EXTERN int deadlock_resolving;
 EXTERN mutex_t bsf_lock;/* Global lock for access to block special files */
 EXTERN struct worker_thread workers[NR_WTHREADS];
+EXTERN int nr_wthreads;	/* # worker threads in use (<= NR_WTHREADS) */
 EXTERN char mount_label[LABEL_MAX];	/* label of file system to mount */
 
 /* The following variables are used for returning results to the caller. */
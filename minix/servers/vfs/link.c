@@ -14,6 +14,7 @@
 #include "fs.h"
 #include <sys/stat.h>
 #include <string.h>
+#include <fcntl.h>
 #include <minix/com.h>
 #include <minix/callnr.h>
 #include <minix/vfsif.h>
@@ -28,8 +29,10 @@
  *===========================================================================*/
 int do_link(void)
 {
-/* Perform the link(name1, name2) system call. */
-  int r = OK;
+/* Perform the link(name1, name2) and linkat(dirfd1, name1, dirfd2, name2,
+ * flags) system calls.
+ */
+  int r = OK, lookup_flags;
   struct vnode *vp = NULL, *dirp = NULL;
   struct vmnt *vmp1 = NULL, *vmp2 = NULL;
   char fullpath[PATH_MAX];
@@ -37,12 +40,30 @@ int do_link(void)
   vir_bytes vname1, vname2;
   size_t vname1_length, vname2_length;
 
-  vname1 = job_m_in.m_lc_vfs_link.name1;
-  vname1_length = job_m_in.m_lc_vfs_link.len1;
-  vname2 = job_m_in.m_lc_vfs_link.name2;
-  vname2_length = job_m_in.m_lc_vfs_link.len2;
+  lookup_flags = PATH_NOFLAGS;
+
+  if (job_call_nr == VFS_LINKAT) {
+	vname1 = job_m_in.m_lc_vfs_linkat.name1;
+	vname1_length = job_m_in.m_lc_vfs_linkat.len1;
+	vname2 = job_m_in.m_lc_vfs_linkat.name2;
+	vname2_length = job_m_in.m_lc_vfs_linkat.len2;
+
+	if (job_m_in.m_lc_vfs_linkat.flags & ~AT_SYMLINK_FOLLOW)
+		return(EINVAL);
+	/* Unlike link(2), linkat(2) follows 'name1' only on request. */
+	if (!(job_m_in.m_lc_vfs_linkat.flags & AT_SYMLINK_FOLLOW))
+		lookup_flags = PATH_RET_SYMLINK;
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_linkat.dirfd1)) != OK)
+		return(r);
+  } else {
+	vname1 = job_m_in.m_lc_vfs_link.name1;
+	vname1_length = job_m_in.m_lc_vfs_link.len1;
+	vname2 = job_m_in.m_lc_vfs_link.name2;
+	vname2_length = job_m_in.m_lc_vfs_link.len2;
+  }
 
-  lookup_init(&resolve, fullpath, PATH_NOFLAGS, &vmp1, &vp);
+  lookup_init(&resolve, fullpath, lookup_flags, &vmp1, &vp);
   resolve.l_vmnt_lock = VMNT_WRITE;
   resolve.l_vnode_lock = VNODE_READ;
 
@@ -50,6 +71,18 @@ int do_link(void)
   if (fetch_name(vname1, vname1_length, fullpath) != OK) return(err_code);
   if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
 
+  /* Switch to the second directory file descriptor, if any. */
+  if (job_call_nr == VFS_LINKAT) {
+	clear_atdir();
+	if ((r = set_atdir(job_m_in.m_lc_vfs_linkat.dirfd2)) != OK) {
+		unlock_vnode(vp);
+		unlock_vmnt(vmp1);
+		put_vnode(vp);
+		return(r);
+	}
+	r = OK;
+  }
+
   /* Does the final directory of 'name2' exist? */
   lookup_init(&resolve, fullpath, PATH_NOFLAGS, &vmp2, &dirp);
   resolve.l_vmnt_lock = VMNT_READ;
@@ -72,9 +105,15 @@ int do_link(void)
   else
 	r = forbidden(fp, dirp, W_BIT | X_BIT);
 
-  if (r == OK)
+  if (r == OK) {
 	r = req_link(vp->v_fs_e, dirp->v_inode_nr, fullpath,
 		     vp->v_inode_nr);
+	if (r == OK) {
+		/* Link count changes for 'vp', times for both. */
+		vp->v_stat_ticks = 0;
+		dirp->v_stat_ticks = 0;
+	}
+  }
 
   unlock_vnode(vp);
   unlock_vnode(dirp);
@@ -97,12 +136,26 @@ int do_unlink(void)
  */
   struct vnode *dirp, *dirp_l, *vp;
   struct vmnt *vmp, *vmp2;
-  int r;
+  int r, remove_dir;
   char fullpath[PATH_MAX];
   struct lookup resolve, stickycheck;
 
-  if (copy_path(fullpath, sizeof(fullpath)) != OK)
-	return(err_code);
+  if (job_call_nr == VFS_UNLINKAT) {
+	if (job_m_in.m_lc_vfs_at.flags & ~AT_REMOVEDIR)
+		return(EINVAL);
+	remove_dir = !!(job_m_in.m_lc_vfs_at.flags & AT_REMOVEDIR);
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+	if (fetch_name(job_m_in.m_lc_vfs_at.name, job_m_in.m_lc_vfs_at.len,
+	    fullpath) != OK)
+		return(err_code);
+  } else {
+	remove_dir = (job_call_nr == VFS_RMDIR);
+
+	if (copy_path(fullpath, sizeof(fullpath)) != OK)
+		return(err_code);
+  }
 
   lookup_init(&resolve, fullpath, PATH_RET_SYMLINK, &vmp, &dirp_l);
   resolve.l_vmnt_lock = VMNT_WRITE;
@@ -153,10 +206,14 @@ int do_unlink(void)
 
   upgrade_vmnt_lock(vmp);
 
-  if (job_call_nr == VFS_UNLINK)
+  if (!remove_dir)
 	  r = req_unlink(dirp->v_fs_e, dirp->v_inode_nr, fullpath);
   else
 	  r = req_rmdir(dirp->v_fs_e, dirp->v_inode_nr, fullpath);
+  if (r == OK) {
+	del_dcache(dirp->v_fs_e, dirp->v_inode_nr, fullpath);
+	dirp->v_stat_ticks = 0;		/* directory contents changed */
+  }
   unlock_vnode(dirp);
   unlock_vmnt(vmp);
   put_vnode(dirp);
@@ -168,7 +225,9 @@ int do_unlink(void)
  *===========================================================================*/
 int do_rename(void)
 {
-/* Perform the rename(name1, name2) system call. */
+/* Perform the rename(name1, name2) and renameat(dirfd1, name1, dirfd2,
+ * name2) system calls.
+ */
   int r = OK, r1;
   struct vnode *old_dirp = NULL, *new_dirp = NULL, *new_dirp_l = NULL, *vp;
   struct vmnt *oldvmp, *newvmp, *vmp2;
@@ -178,10 +237,23 @@ int do_rename(void)
   vir_bytes vname1, vname2;
   size_t vname1_length, vname2_length;
 
-  vname1 = job_m_in.m_lc_vfs_link.name1;
-  vname1_length = job_m_in.m_lc_vfs_link.len1;
-  vname2 = job_m_in.m_lc_vfs_link.name2;
-  vname2_length = job_m_in.m_lc_vfs_link.len2;
+  if (job_call_nr == VFS_RENAMEAT) {
+	vname1 = job_m_in.m_lc_vfs_linkat.name1;
+	vname1_length = job_m_in.m_lc_vfs_linkat.len1;
+	vname2 = job_m_in.m_lc_vfs_linkat.name2;
+	vname2_length = job_m_in.m_lc_vfs_linkat.len2;
+
+	if (job_m_in.m_lc_vfs_linkat.flags != 0)
+		return(EINVAL);
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_linkat.dirfd1)) != OK)
+		return(r);
+  } else {
+	vname1 = job_m_in.m_lc_vfs_link.name1;
+	vname1_length = job_m_in.m_lc_vfs_link.len1;
+	vname2 = job_m_in.m_lc_vfs_link.name2;
+	vname2_length = job_m_in.m_lc_vfs_link.len2;
+  }
 
   lookup_init(&resolve, fullpath, PATH_RET_SYMLINK, &oldvmp, &old_dirp);
   /* Do not yet request exclusive lock on vmnt to prevent deadlocks later on */
@@ -225,6 +297,18 @@ int do_rename(void)
   }
   strlcpy(old_name, fullpath, PATH_MAX);
 
+  /* Switch to the second directory file descriptor, if any. */
+  if (job_call_nr == VFS_RENAMEAT) {
+	clear_atdir();
+	if ((r = set_atdir(job_m_in.m_lc_vfs_linkat.dirfd2)) != OK) {
+		unlock_vnode(old_dirp);
+		unlock_vmnt(oldvmp);
+		put_vnode(old_dirp);
+		return(r);
+	}
+	r = OK;
+  }
+
   /* See if 'name2' (new name) exists.  Get dir inode */
   lookup_init(&resolve, fullpath, PATH_RET_SYMLINK, &newvmp, &new_dirp_l);
   resolve.l_vmnt_lock = VMNT_READ;
@@ -257,6 +341,12 @@ int do_rename(void)
 	upgrade_vmnt_lock(oldvmp); /* Upgrade to exclusive access */
 	r = req_rename(old_dirp->v_fs_e, old_dirp->v_inode_nr, old_name,
 		       new_dirp->v_inode_nr, fullpath);
+	if (r == OK) {
+		del_dcache(old_dirp->v_fs_e, old_dirp->v_inode_nr, old_name);
+		del_dcache(new_dirp->v_fs_e, new_dirp->v_inode_nr, fullpath);
+		old_dirp->v_stat_ticks = 0;	/* contents changed */
+		new_dirp->v_stat_ticks = 0;
+	}
   }
 
   unlock_vnode(old_dirp);
@@ -375,8 +465,10 @@ truncate_vnode(struct vnode *vp, off_t newsize)
    * called for open(2), which requires an update to the file times if O_TRUNC
    * is given, even if the file size remains the same.
    */
-  if ((r = req_ftrunc(vp->v_fs_e, vp->v_inode_nr, newsize, 0)) == OK)
+  if ((r = req_ftrunc(vp->v_fs_e, vp->v_inode_nr, newsize, 0)) == OK) {
 	vp->v_size = newsize;
+	vp->v_stat_ticks = 0;	/* size and times changed */
+  }
   return(r);
 }
 
@@ -386,7 +478,9 @@ truncate_vnode(struct vnode *vp, off_t newsize)
  *===========================================================================*/
 int do_slink(void)
 {
-/* Perform the symlink(name1, name2) system call. */
+/* Perform the symlink(name1, name2) and symlinkat(name1, dirfd, name2)
+ * system calls.
+ */
   int r;
   struct vnode *vp;
   struct vmnt *vmp;
@@ -399,10 +493,21 @@ int do_slink(void)
   resolve.l_vmnt_lock = VMNT_WRITE;
   resolve.l_vnode_lock = VNODE_WRITE;
 
-  vname1 = job_m_in.m_lc_vfs_link.name1;
-  vname1_length = job_m_in.m_lc_vfs_link.len1;
-  vname2 = job_m_in.m_lc_vfs_link.name2;
-  vname2_length = job_m_in.m_lc_vfs_link.len2;
+  if (job_call_nr == VFS_SYMLINKAT) {
+	vname1 = job_m_in.m_lc_vfs_linkat.name1;
+	vname1_length = job_m_in.m_lc_vfs_linkat.len1;
+	vname2 = job_m_in.m_lc_vfs_linkat.name2;
+	vname2_length = job_m_in.m_lc_vfs_linkat.len2;
+
+	/* The directory file descriptor applies to 'name2' only. */
+	if ((r = set_atdir(job_m_in.m_lc_vfs_linkat.dirfd2)) != OK)
+		return(r);
+  } else {
+	vname1 = job_m_in.m_lc_vfs_link.name1;
+	vname1_length = job_m_in.m_lc_vfs_link.len1;
+	vname2 = job_m_in.m_lc_vfs_link.name2;
+	vname2_length = job_m_in.m_lc_vfs_link.len2;
+  }
 
   if (vname1_length <= 1) return(ENOENT);
   if (vname1_length >= _POSIX_SYMLINK_MAX) return(ENAMETOOLONG);
@@ -414,6 +519,7 @@ int do_slink(void)
 	r = req_slink(vp->v_fs_e, vp->v_inode_nr, fullpath, who_e,
 		      vname1, vname1_length - 1, fp->fp_effuid,
 		      fp->fp_effgid);
+	if (r == OK) vp->v_stat_ticks = 0;	/* contents changed */
   }
 
   unlock_vnode(vp);
@@ -470,7 +576,9 @@ rdlink_direct(
  *===========================================================================*/
 int do_rdlink(void)
 {
-/* Perform the readlink(name, buf, bufsize) system call. */
+/* Perform the readlink(name, buf, bufsize) and readlinkat(dirfd, name, buf,
+ * bufsize) system calls.
+ */
   int r;
   struct vnode *vp;
   struct vmnt *vmp;
@@ -480,10 +588,20 @@ int do_rdlink(void)
   size_t vname_length, buf_size;
   vir_bytes buf;
 
-  vname = job_m_in.m_lc_vfs_readlink.name;
-  vname_length = job_m_in.m_lc_vfs_readlink.namelen;
-  buf = job_m_in.m_lc_vfs_readlink.buf;
-  buf_size = job_m_in.m_lc_vfs_readlink.bufsize;
+  if (job_call_nr == VFS_READLINKAT) {
+	vname = job_m_in.m_lc_vfs_at.name;
+	vname_length = job_m_in.m_lc_vfs_at.len;
+	buf = job_m_in.m_lc_vfs_at.buf;
+	buf_size = job_m_in.m_lc_vfs_at.bufsize;
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+  } else {
+	vname = job_m_in.m_lc_vfs_readlink.name;
+	vname_length = job_m_in.m_lc_vfs_readlink.namelen;
+	buf = job_m_in.m_lc_vfs_readlink.buf;
+	buf_size = job_m_in.m_lc_vfs_readlink.bufsize;
+  }
   if (buf_size > SSIZE_MAX) return(EINVAL);
 
   lookup_init(&resolve, fullpath, PATH_RET_SYMLINK, &vmp, &vp);
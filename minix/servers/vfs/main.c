@@ -63,7 +63,7 @@ int main(void)
   /* SEF local startup. */
   sef_local_startup();
 
-  printf("Started VFS: %d worker thread(s)\n", NR_WTHREADS);
+  printf("Started VFS: %d worker thread(s)\n", nr_wthreads);
 
   /* This is the main loop that gets work, processes it, and sends replies. */
   while (TRUE) {
@@ -293,6 +293,8 @@ static void do_work(void)
   } else
 	error = ENOSYS;
 
+  clear_atdir();	/* in case an *at() call set a start directory */
+
   /* Copy the results back to the user and send reply. */
   if (error != SUSPEND) reply(&job_m_out, fp->fp_endpoint, error);
 }
@@ -479,8 +481,10 @@ static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *info)
 	 */
 	for (i = 0; i < OPEN_MAX; i++)
 		rfp->fp_filp[i] = NULL;
+	memset(rfp->fp_filp_map, 0, sizeof(rfp->fp_filp_map));
 	rfp->fp_rd = NULL;
 	rfp->fp_wd = NULL;
+	rfp->fp_atdir = NULL;
   }
 
   init_vnodes();		/* init vnodes */
@@ -6,6 +6,7 @@
  *   do_fcntl:	  perform the FCNTL system call
  *   do_sync:	  perform the SYNC system call
  *   do_fsync:	  perform the FSYNC system call
+ *   do_fadvise:  perform the FADVISE system call
  *   pm_setsid:	  perform VFS's side of setsid system call
  *   pm_reboot:	  sync disks and prepare for shutdown
  *   pm_fork:	  adjust the tables after PM has performed a FORK system call
@@ -29,6 +30,7 @@
 #include <minix/com.h>
 #include <minix/sysinfo.h>
 #include <minix/u64.h>
+#include <sys/stat.h>
 #include <sys/ptrace.h>
 #include <sys/svrctl.h>
 #include <sys/resource.h>
@@ -140,6 +142,7 @@ int do_fcntl(void)
 	else if ((r = get_fd(fp, fcntl_argx, 0, &new_fd, NULL)) == OK) {
 		f->filp_count++;
 		fp->fp_filp[new_fd] = f;
+		SET_BIT(fp->fp_filp_map, new_fd);
 		assert(!FD_ISSET(new_fd, &fp->fp_cloexec_set));
 		if (fcntl_req == F_DUPFD_CLOEXEC)
 			FD_SET(new_fd, &fp->fp_cloexec_set);
@@ -310,12 +313,11 @@ int do_fsync(void)
   dev = rfilp->filp_vno->v_dev;
   unlock_filp(rfilp);
 
-  for (vmp = &vmnt[0]; vmp < &vmnt[NR_MNTS]; ++vmp) {
-	if (vmp->m_dev != dev) continue;
-	if ((r = lock_vmnt(vmp, VMNT_READ)) != OK)
-		break;
-	if (vmp->m_dev != NO_DEV && vmp->m_dev == dev &&
-		vmp->m_fs_e != NONE && vmp->m_root_node != NULL) {
+  if ((vmp = find_vmnt_by_dev(dev)) != NULL &&
+      (r = lock_vmnt(vmp, VMNT_READ)) == OK) {
+	/* Recheck: the file system may have been unmounted while blocked. */
+	if (vmp->m_dev == dev && vmp->m_fs_e != NONE &&
+	    vmp->m_root_node != NULL) {
 
 		req_sync(vmp->m_fs_e);
 	}
@@ -325,6 +327,54 @@ int do_fsync(void)
   return(r);
 }
 
+/*===========================================================================*
+ *				do_fadvise				     *
+ *===========================================================================*/
+int do_fadvise(void)
+{
+/* Perform the posix_fadvise() system call.  The access pattern hint is
+ * forwarded to the file system, which may use it to adapt its read-ahead and
+ * cache-retention policy for the file.  The offset and length are not
+ * forwarded: the hint state is kept per inode, and in practice advice spans
+ * whole files.
+ */
+  struct filp *rfilp;
+  int fd, advice, r = OK;
+
+  fd = job_m_in.m_lc_vfs_fadvise.fd;
+  advice = job_m_in.m_lc_vfs_fadvise.advice;
+
+  switch (advice) {
+  case POSIX_FADV_NORMAL:
+  case POSIX_FADV_RANDOM:
+  case POSIX_FADV_SEQUENTIAL:
+  case POSIX_FADV_WILLNEED:
+  case POSIX_FADV_DONTNEED:
+  case POSIX_FADV_NOREUSE:
+	break;
+  default:
+	return(EINVAL);
+  }
+
+  if (job_m_in.m_lc_vfs_fadvise.offset < 0 ||
+      job_m_in.m_lc_vfs_fadvise.len < 0)
+	return(EINVAL);
+
+  if ((rfilp = get_filp(fd, VNODE_READ)) == NULL)
+	return(err_code);
+
+  /* Advice applies to regular files only; accept and ignore it for other
+   * file types, as POSIX requires.
+   */
+  if (S_ISREG(rfilp->filp_vno->v_mode))
+	r = req_fadvise(rfilp->filp_vno->v_fs_e, rfilp->filp_vno->v_inode_nr,
+	    advice);
+
+  unlock_filp(rfilp);
+
+  return(r);
+}
+
 int dupvm(struct fproc *rfp, int pfd, int *vmfd, struct filp **newfilp)
 {
 	int result, procfd;
@@ -368,6 +418,7 @@ int dupvm(struct fproc *rfp, int pfd, int *vmfd, struct filp **newfilp)
 	f->filp_count++;
 	assert(f->filp_count > 0);
 	vmf->fp_filp[procfd] = f;
+	SET_BIT(vmf->fp_filp_map, procfd);
 
 	*newfilp = f;
 
@@ -471,6 +522,23 @@ int do_vm_call(void)
 
 			break;
 		}
+		case VMVFSREQ_FDWRITE:
+		{
+			/* Write out a page of VM's own memory, for page-out
+			 * to swap. The buffer is a virtual address in VM.
+			 */
+			vir_bytes buf = job_m_in.VFS_VMCALL_BUF;
+
+			result = actual_lseek(fp, req_fd, SEEK_SET, offset,
+				NULL);
+
+			if(result == OK) {
+				result = actual_read_write_peek(fp, WRITING,
+					req_fd, buf, length);
+			}
+
+			break;
+		}
 		default:
 			panic("VFS: bad request code from VM\n");
 			break;
@@ -658,6 +726,7 @@ static void free_proc(int flags)
   /* Release root and working directories. */
   if (fp->fp_rd) { put_vnode(fp->fp_rd); fp->fp_rd = NULL; }
   if (fp->fp_wd) { put_vnode(fp->fp_wd); fp->fp_wd = NULL; }
+  clear_atdir();
 
   /* The rest of these actions is only done when processes actually exit. */
   if (!(flags & FP_EXITING)) return;
@@ -868,7 +937,7 @@ int do_svrctl(void)
 				sysgetenv.vallen = 0;
 				r = OK;
 			} else if (!strcmp(search_key, "active_threads")) {
-				int active = NR_WTHREADS - worker_available();
+				int active = nr_wthreads - worker_available();
 				snprintf(small_buf, sizeof(small_buf) - 1,
 					 "%d", active);
 				sysgetenv.vallen = strlen(small_buf);
@@ -162,7 +162,7 @@ int flags,
 char mount_type[FSTYPE_MAX],
 char mount_label[LABEL_MAX] )
 {
-  int i, r = OK, found, isroot, mount_root, slot;
+  int i, r = OK, isroot, mount_root, slot;
   struct fproc *tfp, *rfp;
   struct dmap *dp;
   struct vnode *root_node, *vp = NULL;
@@ -187,12 +187,8 @@ char mount_label[LABEL_MAX] )
 	assert(strlen(label) > 0);
   }
 
-  /* Scan vmnt table to see if dev already mounted. If not, find a free slot.*/
-  found = FALSE;
-  for (i = 0; i < NR_MNTS; ++i) {
-	if (vmnt[i].m_dev == dev) found = TRUE;
-  }
-  if (found) {
+  /* See if dev is already mounted. If not, find a free slot. */
+  if (find_vmnt_by_dev(dev) != NULL) {
 	return(EBUSY);
   } else if ((new_vmp = get_free_vmnt()) == NULL) {
 	return(ENOMEM);
@@ -262,8 +258,7 @@ char mount_label[LABEL_MAX] )
   rfp->fp_flags |= FP_SRV_PROC;	/* File Servers are also services */
 
   /* Store some essential vmnt data first */
-  new_vmp->m_fs_e = fs_e;
-  new_vmp->m_dev = dev;
+  enter_vmnt(new_vmp, fs_e, dev);
   if (flags & MNT_RDONLY) new_vmp->m_flags |= VMNT_READONLY;
   else new_vmp->m_flags &= ~VMNT_READONLY;
 
@@ -293,8 +288,7 @@ char mount_label[LABEL_MAX] )
   lock_bsf();
 
   /* Fill in root node's fields */
-  root_node->v_fs_e = res.fs_e;
-  root_node->v_inode_nr = res.inode_nr;
+  enter_vnode(root_node, res.fs_e, res.inode_nr);
   root_node->v_mode = res.fmode;
   root_node->v_uid = res.uid;
   root_node->v_gid = res.gid;
@@ -309,7 +303,7 @@ char mount_label[LABEL_MAX] )
   if (!(new_vmp->m_fs_flags & RES_THREADED))
 	new_vmp->m_comm.c_max_reqs = 1;
   else
-	new_vmp->m_comm.c_max_reqs = NR_WTHREADS;
+	new_vmp->m_comm.c_max_reqs = nr_wthreads;
   new_vmp->m_comm.c_cur_reqs = 0;
 
   /* No more blocking operations, so we can now report on this file system. */
@@ -366,9 +360,13 @@ char mount_label[LABEL_MAX] )
 
   /* Nothing else can go wrong.  Perform the mount. */
   new_vmp->m_mounted_on = vp;
+  vp->v_mountedhere = new_vmp;
   new_vmp->m_root_node = root_node;
   strlcpy(new_vmp->m_label, mount_label, LABEL_MAX);
 
+  /* The mount point no longer resolves to what the name cache says. */
+  flush_dcache();
+
   /* Allocate the pseudo device that was found, if not using a real device. */
   if (is_nonedev(dev)) alloc_nonedev(dev);
 
@@ -409,8 +407,7 @@ void mount_pfs(void)
 
   alloc_nonedev(dev);
 
-  vmp->m_dev = dev;
-  vmp->m_fs_e = PFS_PROC_NR;
+  enter_vmnt(vmp, PFS_PROC_NR, dev);
   vmp->m_fs_flags = 0;
   strlcpy(vmp->m_label, "pfs", LABEL_MAX);
   strlcpy(vmp->m_mount_path, "pipe", PATH_MAX);
@@ -473,19 +470,11 @@ int unmount(
 )
 {
   struct vnode *vp;
-  struct vmnt *vmp_i = NULL, *vmp = NULL;
+  struct vmnt *vmp;
   int count, locks, r;
 
-  /* Find vmnt that is to be unmounted */
-  for (vmp_i = &vmnt[0]; vmp_i < &vmnt[NR_MNTS]; ++vmp_i) {
-	  if (vmp_i->m_dev == dev) {
-		  if(vmp) panic("device mounted more than once: %llx", dev);
-		  vmp = vmp_i;
-	  }
-  }
-
-  /* Did we find the vmnt (i.e., was dev a mounted device)? */
-  if(!vmp) return(EINVAL);
+  /* Find vmnt that is to be unmounted; was dev a mounted device at all? */
+  if ((vmp = find_vmnt_by_dev(dev)) == NULL) return(EINVAL);
 
   if ((r = lock_vmnt(vmp, VMNT_EXCL)) != OK) return(r);
 
@@ -510,6 +499,7 @@ int unmount(
   vnode_clean_refs(vmp->m_root_node);
 
   if (vmp->m_mounted_on) {
+	vmp->m_mounted_on->v_mountedhere = NULL;
 	put_vnode(vmp->m_mounted_on);
 	vmp->m_mounted_on = NULL;
   }
@@ -528,13 +518,16 @@ int unmount(
   if (label != NULL) strlcpy(label, vmp->m_label, LABEL_MAX);
 
   if (vmp->m_root_node) {	/* PFS lacks a root node */
-	vmp->m_root_node->v_ref_count = 0;
+	mark_vnode_free(vmp->m_root_node);
 	vmp->m_root_node->v_fs_count = 0;
 	vmp->m_root_node->v_sdev = NO_DEV;
 	vmp->m_root_node = NULL;
   }
   mark_vmnt_free(vmp);
 
+  /* The FS endpoint may be reused; do not let the name cache refer to it. */
+  flush_dcache();
+
   unlock_vmnt(vmp);
 
   /* The root FS will handle block I/O requests for this device now. */
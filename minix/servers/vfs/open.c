@@ -37,10 +37,25 @@ static int pipe_open(int fd, struct vnode *vp, mode_t bits, int oflags);
  *===========================================================================*/
 int do_open(void)
 {
-/* Perform the open(name, flags) system call with O_CREAT *not* set. */
-  int open_flags;
+/* Perform the open(name, flags) system call with O_CREAT *not* set, or the
+ * openat(dirfd, name, flags, mode) system call.
+ */
+  int r, open_flags;
   char fullpath[PATH_MAX];
 
+  if (job_call_nr == VFS_OPENAT) {
+	open_flags = job_m_in.m_lc_vfs_at.flags;
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+	if (fetch_name(job_m_in.m_lc_vfs_at.name, job_m_in.m_lc_vfs_at.len,
+	    fullpath) != OK)
+		return(err_code);
+
+	return common_open(fullpath, open_flags, job_m_in.m_lc_vfs_at.mode,
+	    FALSE /*for_exec*/);
+  }
+
   open_flags = job_m_in.m_lc_vfs_path.flags;
 
   if (open_flags & O_CREAT)
@@ -113,6 +128,7 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
 	else if (r != EEXIST) {		/* other error */
 		if (vp) unlock_vnode(vp);
 		unlock_filp(filp);
+		release_filp(filp);
 		return(r);
 	}
 	else exist = !(oflags & O_EXCL);/* file exists, if the O_EXCL
@@ -123,6 +139,7 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
 	resolve.l_vnode_lock = VNODE_OPCL;
 	if ((vp = eat_path(&resolve, fp)) == NULL) {
 		unlock_filp(filp);
+		release_filp(filp);
 		return(err_code);
 	}
 
@@ -131,6 +148,7 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
 
   /* Claim the file descriptor and filp slot and fill them in. */
   fp->fp_filp[fd] = filp;
+  SET_BIT(fp->fp_filp_map, fd);
   filp->filp_count = 1;
   filp->filp_vno = vp;
   filp->filp_flags = oflags;
@@ -193,11 +211,9 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
 			 * Otherwise we default to ROOT_FS.
 			 */
 			vp->v_bfs_e = ROOT_FS_E; /* By default */
-			for (vmp = &vmnt[0]; vmp < &vmnt[NR_MNTS]; ++vmp)
-				if (vmp->m_dev == vp->v_sdev &&
-				    !(vmp->m_flags & VMNT_FORCEROOTBSF)) {
-					vp->v_bfs_e = vmp->m_fs_e;
-				}
+			if ((vmp = find_vmnt_by_dev(vp->v_sdev)) != NULL &&
+			    !(vmp->m_flags & VMNT_FORCEROOTBSF))
+				vp->v_bfs_e = vmp->m_fs_e;
 
 			/* Send the driver label to the file system that will
 			 * handle the block I/O requests (even when its label
@@ -233,6 +249,11 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
 				filp->filp_flags = oflags;
 			}
 			if (r == OK) {
+				/* Buffer the pipe data in VFS if possible,
+				 * avoiding PFS round trips on reads and
+				 * writes.
+				 */
+				pipe_buf_attach(vp);
 				r = pipe_open(fd, vp, bits, oflags);
 			}
 			if (r != ENXIO) {
@@ -257,6 +278,9 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
 				     */
 				    unlock_vnode(vp);
 				    put_vnode(vp);
+
+				    /* The original filp is now unused. */
+				    release_filp(filp);
 				} else {
 				    /* Nobody else found. Restore filp. */
 				    filp->filp_count = 1;
@@ -281,8 +305,10 @@ int common_open(char path[PATH_MAX], int oflags, mode_t omode, int for_exec)
   if (r != OK) {
 	if (r != SUSPEND) {
 		fp->fp_filp[fd] = NULL;
+		UNSET_BIT(fp->fp_filp_map, fd);
 		filp->filp_count = 0;
 		filp->filp_vno = NULL;
+		release_filp(filp);
 		put_vnode(vp);
 	}
   } else {
@@ -442,8 +468,7 @@ static struct vnode *new_node(struct lookup *resolve, int oflags, mode_t bits)
 
 	/* Store results and mark vnode in use */
 
-	vp->v_fs_e = res.fs_e;
-	vp->v_inode_nr = res.inode_nr;
+	enter_vnode(vp, res.fs_e, res.inode_nr);
 	vp->v_mode = res.fmode;
 	vp->v_size = res.fsize;
 	vp->v_uid = res.uid;
@@ -513,7 +538,9 @@ static int pipe_open(int fd, struct vnode *vp, mode_t bits, int oflags)
  *===========================================================================*/
 int do_mknod(void)
 {
-/* Perform the mknod(name, mode, addr) system call. */
+/* Perform the mknod(name, mode, addr) and mknodat(dirfd, name, mode, addr)
+ * system calls.
+ */
   register mode_t bits, mode_bits;
   int r;
   struct vnode *vp;
@@ -524,10 +551,20 @@ int do_mknod(void)
   size_t vname1_length;
   dev_t dev;
 
-  vname1 = job_m_in.m_lc_vfs_mknod.name;
-  vname1_length = job_m_in.m_lc_vfs_mknod.len;
-  mode_bits = job_m_in.m_lc_vfs_mknod.mode;
-  dev = job_m_in.m_lc_vfs_mknod.device;
+  if (job_call_nr == VFS_MKNODAT) {
+	vname1 = job_m_in.m_lc_vfs_mknodat.name;
+	vname1_length = job_m_in.m_lc_vfs_mknodat.len;
+	mode_bits = job_m_in.m_lc_vfs_mknodat.mode;
+	dev = job_m_in.m_lc_vfs_mknodat.device;
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_mknodat.dirfd)) != OK)
+		return(r);
+  } else {
+	vname1 = job_m_in.m_lc_vfs_mknod.name;
+	vname1_length = job_m_in.m_lc_vfs_mknod.len;
+	mode_bits = job_m_in.m_lc_vfs_mknod.mode;
+	dev = job_m_in.m_lc_vfs_mknod.device;
+  }
 
   /* If the path names a symbolic link, mknod() shall fail with EEXIST. */
   lookup_init(&resolve, fullpath, PATH_RET_SYMLINK, &vmp, &vp);
@@ -550,6 +587,7 @@ int do_mknod(void)
   } else if ((r = forbidden(fp, vp, W_BIT|X_BIT)) == OK) {
 	r = req_mknod(vp->v_fs_e, vp->v_inode_nr, fullpath, fp->fp_effuid,
 		      fp->fp_effgid, bits, dev);
+	if (r == OK) vp->v_stat_ticks = 0;	/* contents changed */
   }
 
   unlock_vnode(vp);
@@ -563,7 +601,9 @@ int do_mknod(void)
  *===========================================================================*/
 int do_mkdir(void)
 {
-/* Perform the mkdir(name, mode) system call. */
+/* Perform the mkdir(name, mode) and mkdirat(dirfd, name, mode) system
+ * calls.
+ */
   mode_t bits;			/* mode bits for the new inode */
   int r;
   struct vnode *vp;
@@ -572,9 +612,19 @@ int do_mkdir(void)
   struct lookup resolve;
   mode_t dirmode;
 
-  if (copy_path(fullpath, sizeof(fullpath)) != OK)
-	return(err_code);
-  dirmode = job_m_in.m_lc_vfs_path.mode;
+  if (job_call_nr == VFS_MKDIRAT) {
+	dirmode = job_m_in.m_lc_vfs_at.mode;
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+	if (fetch_name(job_m_in.m_lc_vfs_at.name, job_m_in.m_lc_vfs_at.len,
+	    fullpath) != OK)
+		return(err_code);
+  } else {
+	if (copy_path(fullpath, sizeof(fullpath)) != OK)
+		return(err_code);
+	dirmode = job_m_in.m_lc_vfs_path.mode;
+  }
 
   lookup_init(&resolve, fullpath, PATH_NOFLAGS, &vmp, &vp);
   resolve.l_vmnt_lock = VMNT_WRITE;
@@ -589,6 +639,7 @@ int do_mkdir(void)
   } else if ((r = forbidden(fp, vp, W_BIT|X_BIT)) == OK) {
 	r = req_mkdir(vp->v_fs_e, vp->v_inode_nr, fullpath, fp->fp_effuid,
 		      fp->fp_effgid, bits);
+	if (r == OK) vp->v_stat_ticks = 0;	/* contents changed */
   }
 
   unlock_vnode(vp);
@@ -704,6 +755,7 @@ close_fd(struct fproc * rfp, int fd_nr, int may_suspend)
    * we might try to close the same fd in different threads
    */
   rfp->fp_filp[fd_nr] = NULL;
+  UNSET_BIT(rfp->fp_filp_map, fd_nr);
 
   r = close_filp(rfilp, may_suspend);
 
@@ -11,11 +11,13 @@
 #include <minix/endpoint.h>
 #include <stddef.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <assert.h>
 #include <minix/vfsif.h>
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/dirent.h>
+#include "file.h"
 #include "vmnt.h"
 #include "vnode.h"
 #include "path.h"
@@ -33,6 +35,92 @@
 static int lookup(struct vnode *dirp, struct lookup *resolve,
 	node_details_t *node, struct fproc *rfp);
 
+/*===========================================================================*
+ *				advance_dcache				     *
+ *===========================================================================*/
+static struct vnode *
+advance_dcache(struct vnode *dirp, struct lookup *resolve, struct fproc *rfp)
+{
+/* Try to resolve the single path component in 'resolve' through the name
+ * cache. On a hit, we take a new reference on a vnode that VFS already holds,
+ * so no FS interaction is needed at all. Return the referenced and locked
+ * vnode on a hit, or NULL to let the caller take the regular lookup path.
+ * Only plain read-only resolutions are attempted: mutating calls take
+ * stronger vmnt locks, and VFS_ACCESS checks against the real instead of the
+ * effective user and group IDs used by forbidden().
+ */
+  struct vnode *vp;
+  struct vmnt *vmpres;
+  endpoint_t fs_e;
+  ino_t ino;
+  tll_access_t initial_locktype;
+  int r, do_downgrade;
+
+  if (resolve->l_vmnt_lock != VMNT_READ) return(NULL);
+  if (job_call_nr == VFS_ACCESS) return(NULL);
+
+  /* The caller must be allowed to search the directory. */
+  if (forbidden(rfp, dirp, X_BIT) != OK) return(NULL);
+
+  if (!lookup_dcache(dirp->v_fs_e, dirp->v_inode_nr, resolve->l_path, &fs_e,
+      &ino))
+	return(NULL);
+
+  /* Results on another FS (i.e., mount roots) always take the long path. */
+  if (fs_e != dirp->v_fs_e) return(NULL);
+
+  if ((vp = find_vnode(fs_e, ino)) == NULL) return(NULL);
+
+  /* Symbolic links need the FS to resolve them, and vnodes that are mounted
+   * on must resolve to the root of the file system covering them instead. */
+  if (S_ISLNK(vp->v_mode)) return(NULL);
+  if (vp->v_mountedhere != NULL) return(NULL);
+
+  /* Lock the vmnt and the vnode the same way lookup() and advance() would,
+   * so that the result is indistinguishable from a regular lookup. */
+  if ((vmpres = find_vmnt(fs_e)) == NULL) return(NULL);
+
+  if ((r = lock_vmnt(vmpres, VMNT_WRITE)) != OK) {
+	if (r != EBUSY) return(NULL);
+	vmpres = NULL;	/* Already locked by this thread */
+  }
+
+  if (resolve->l_vnode_lock == VNODE_READ)
+	initial_locktype = VNODE_OPCL;
+  else
+	initial_locktype = resolve->l_vnode_lock;
+
+  do_downgrade = (lock_vnode(vp, initial_locktype) != EBUSY);
+
+  /* While waiting for the lock, the vnode may have lost its references. In
+   * that case fall back to the regular lookup path: unlike advance(), we
+   * have no reference from the FS to revive the vnode with. */
+  if (vp->v_ref_count == 0 || vp->v_fs_e != fs_e || vp->v_inode_nr != ino) {
+	if (do_downgrade) unlock_vnode(vp);
+	if (vmpres != NULL) unlock_vmnt(vmpres);
+	return(NULL);
+  }
+
+  dup_vnode(vp);
+
+  *(resolve->l_vmp) = vmpres;
+
+  if (do_downgrade) {
+	/* Only downgrade a lock if we managed to lock it in the first place */
+	*(resolve->l_vnode) = vp;
+
+	if (initial_locktype != resolve->l_vnode_lock)
+		tll_downgrade(&vp->v_lock);
+
+#if LOCK_DEBUG
+	if (resolve->l_vnode_lock == VNODE_READ)
+		fp->fp_vp_rdlocks++;
+#endif
+  }
+
+  return(vp);
+}
+
 /*===========================================================================*
  *				advance					     *
  *===========================================================================*/
@@ -46,6 +134,8 @@ advance(struct vnode *dirp, struct lookup *resolve, struct fproc *rfp)
   struct vmnt *vmp;
   struct node_details res = {0,0,0,0,0,0,0};
   tll_access_t initial_locktype;
+  int cacheable;
+  char name[NAME_MAX+1];
 
   assert(dirp);
   assert(resolve->l_vnode_lock != TLL_NONE);
@@ -56,6 +146,21 @@ advance(struct vnode *dirp, struct lookup *resolve, struct fproc *rfp)
   else
 	initial_locktype = resolve->l_vnode_lock;
 
+  /* A single, plain path component may be served from the name cache, and
+   * is entered into it after a successful lookup. Save the name now: the
+   * lookup may rewrite the path on mount crossings and symlinks.
+   */
+  cacheable = strchr(resolve->l_path, '/') == NULL &&
+	strlen(resolve->l_path) <= NAME_MAX && resolve->l_path[0] != '\0' &&
+	strcmp(resolve->l_path, ".") != 0 && strcmp(resolve->l_path, "..") != 0;
+
+  if (cacheable) {
+	strlcpy(name, resolve->l_path, sizeof(name));
+
+	if ((vp = advance_dcache(dirp, resolve, rfp)) != NULL)
+		return(vp);
+  }
+
   /* Get a free vnode and lock it */
   if ((new_vp = get_free_vnode()) == NULL) return(NULL);
   lock_vnode(new_vp, initial_locktype);
@@ -91,8 +196,7 @@ advance(struct vnode *dirp, struct lookup *resolve, struct fproc *rfp)
   } else {
 	/* Vnode not found, fill in the free vnode's fields */
 
-	new_vp->v_fs_e = res.fs_e;
-	new_vp->v_inode_nr = res.inode_nr;
+	enter_vnode(new_vp, res.fs_e, res.inode_nr);
 	new_vp->v_mode = res.fmode;
 	new_vp->v_size = res.fsize;
 	new_vp->v_uid = res.uid;
@@ -109,6 +213,16 @@ advance(struct vnode *dirp, struct lookup *resolve, struct fproc *rfp)
 	vp = new_vp;
   }
 
+  /* Remember where the name led, so future lookups can skip the FS. Only
+   * PATH_RET_SYMLINK lookups are guaranteed to return the direct binding of
+   * the name rather than where a symlink chain ended up, so anything else
+   * must not be cached. Mount roots and symlinks themselves are left to the
+   * regular lookup path. */
+  if (cacheable && (resolve->l_flags & PATH_RET_SYMLINK) &&
+      vp->v_fs_e == dirp->v_fs_e && !S_ISLNK(vp->v_mode))
+	enter_dcache(dirp->v_fs_e, dirp->v_inode_nr, name, vp->v_fs_e,
+		vp->v_inode_nr);
+
   dup_vnode(vp);
   if (do_downgrade) {
 	/* Only downgrade a lock if we managed to lock it in the first place */
@@ -135,7 +249,10 @@ eat_path(struct lookup *resolve, struct fproc *rfp)
 /* Resolve path to a vnode. advance does the actual work. */
   struct vnode *start_dir;
 
-  start_dir = (resolve->l_path[0] == '/' ? rfp->fp_rd : rfp->fp_wd);
+  if (resolve->l_path[0] == '/')
+	start_dir = rfp->fp_rd;
+  else
+	start_dir = (rfp->fp_atdir != NULL) ? rfp->fp_atdir : rfp->fp_wd;
   return advance(start_dir, resolve, rfp);
 }
 
@@ -175,8 +292,10 @@ last_dir(struct lookup *resolve, struct fproc *rfp)
 	 */
 	if (loop_start != NULL)
 		start_dir = loop_start;
+	else if (resolve->l_path[0] == '/')
+		start_dir = rfp->fp_rd;
 	else
-		start_dir = (resolve->l_path[0] == '/' ? rfp->fp_rd:rfp->fp_wd);
+		start_dir = (rfp->fp_atdir != NULL) ? rfp->fp_atdir:rfp->fp_wd;
 
 	len = strlen(resolve->l_path);
 
@@ -391,7 +510,7 @@ lookup(struct vnode *start_node, struct lookup *resolve, node_details_t *result_
   ino_t dir_ino, root_ino;
   uid_t uid;
   gid_t gid;
-  struct vnode *dir_vp;
+  struct vnode *dir_vp, *mp_vp;
   struct vmnt *vmp, *vmpres;
   struct lookup_res res;
   tll_access_t mnt_lock_type;
@@ -478,16 +597,12 @@ lookup(struct vnode *start_node, struct lookup *resolve, node_details_t *result_
 	} else if (r == EENTERMOUNT) {
 		/* Entering a new partition */
 		dir_vp = NULL;
-		/* Start node is now the mounted partition's root node */
-		for (vmp = &vmnt[0]; vmp != &vmnt[NR_MNTS]; ++vmp) {
-			if (vmp->m_dev != NO_DEV && vmp->m_mounted_on) {
-			   if (vmp->m_mounted_on->v_inode_nr == res.inode_nr &&
-			       vmp->m_mounted_on->v_fs_e == res.fs_e) {
-				dir_vp = vmp->m_root_node;
-				break;
-			   }
-			}
-		}
+		/* Start node is now the mounted partition's root node. The
+		 * mount point is always in the vnode table: the vmnt holds a
+		 * reference to it. */
+		if ((mp_vp = find_vnode(res.fs_e, res.inode_nr)) != NULL &&
+		    mp_vp->v_mountedhere != NULL)
+			dir_vp = mp_vp->v_mountedhere->m_root_node;
 		if (dir_vp == NULL) {
 			printf("VFS: path lookup error; root node not found\n");
 			if (vmpres) unlock_vmnt(vmpres);
@@ -587,6 +702,53 @@ lookup_init(struct lookup *resolve, char *path, int flags, struct vmnt **vmp, st
   *vp = NULL;
 }
 
+/*===========================================================================*
+ *				set_atdir				     *
+ *===========================================================================*/
+int
+set_atdir(int dirfd)
+{
+/* Make relative path lookups for the current *at() call start at the
+ * directory referenced by 'dirfd' instead of at the working directory. The
+ * main loop clears the start directory again when the call has completed, so
+ * a suspended and restarted call simply resolves 'dirfd' anew. As long as the
+ * caller keeps 'dirfd' open, the vnode cannot go away, but we take our own
+ * reference so that we need not rely on that here.
+ */
+  struct filp *flp;
+  struct vnode *vp;
+
+  assert(fp->fp_atdir == NULL);
+
+  if (dirfd == AT_FDCWD) return(OK);	/* keep using the working directory */
+
+  if ((flp = get_filp(dirfd, VNODE_READ)) == NULL) return(err_code);
+  vp = flp->filp_vno;
+  if (!S_ISDIR(vp->v_mode)) {
+	unlock_filp(flp);
+	return(ENOTDIR);
+  }
+  dup_vnode(vp);
+  unlock_filp(flp);
+
+  fp->fp_atdir = vp;
+  return(OK);
+}
+
+/*===========================================================================*
+ *				clear_atdir				     *
+ *===========================================================================*/
+void
+clear_atdir(void)
+{
+/* Release the *at() start directory of the current call, if any. */
+
+  if (fp->fp_atdir != NULL) {
+	put_vnode(fp->fp_atdir);
+	fp->fp_atdir = NULL;
+  }
+}
+
 /*===========================================================================*
  *				get_name				     *
  *===========================================================================*/
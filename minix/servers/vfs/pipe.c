@@ -33,6 +33,24 @@
 
 static int create_pipe(int fil_des[2], int flags);
 
+/* Pool of in-VFS pipe data buffers. A pipe with a buffer assigned stores its
+ * data right here in VFS, so that reads and writes are plain data copies
+ * rather than full request round trips to PFS. When the pool is exhausted,
+ * new pipes simply keep using PFS for their data; the choice is made once at
+ * pipe creation time and never changes during the lifetime of the pipe, as
+ * switching midway would lose or reorder buffered data.
+ *
+ * The buffer is a ring: pb_off is the read position, and the number of bytes
+ * buffered is the vnode's v_size, which VFS maintains for all pipes already.
+ * Since pipe_check() caps the amount buffered at PIPE_BUF, a buffer of that
+ * size never overflows.
+ */
+static struct pipe_buf {
+  struct vnode *pb_vp;		/* vnode using this buffer, or NULL if free */
+  size_t pb_off;		/* read position in the ring */
+  char pb_data[PIPE_BUF];	/* pipe data */
+} pipe_buf[NR_PIPE_BUFS];
+
 /*===========================================================================*
  *				do_pipe2				     *
  *===========================================================================*/
@@ -85,16 +103,20 @@ static int create_pipe(int fil_des[2], int flags)
 	return(r);
   }
   rfp->fp_filp[fil_des[0]] = fil_ptr0;
+  SET_BIT(rfp->fp_filp_map, fil_des[0]);
   fil_ptr0->filp_count = 1;		/* mark filp in use */
   if ((r = get_fd(fp, 0, W_BIT, &fil_des[1], &fil_ptr1)) != OK) {
 	rfp->fp_filp[fil_des[0]] = NULL;
+	UNSET_BIT(rfp->fp_filp_map, fil_des[0]);
 	fil_ptr0->filp_count = 0;	/* mark filp free */
 	unlock_filp(fil_ptr0);
+	release_filp(fil_ptr0);
 	unlock_vnode(vp);
 	unlock_vmnt(vmp);
 	return(r);
   }
   rfp->fp_filp[fil_des[1]] = fil_ptr1;
+  SET_BIT(rfp->fp_filp_map, fil_des[1]);
   fil_ptr1->filp_count = 1;
 
   /* Create a named pipe inode on PipeFS */
@@ -103,20 +125,23 @@ static int create_pipe(int fil_des[2], int flags)
 
   if (r != OK) {
 	rfp->fp_filp[fil_des[0]] = NULL;
+	UNSET_BIT(rfp->fp_filp_map, fil_des[0]);
 	fil_ptr0->filp_count = 0;
 	rfp->fp_filp[fil_des[1]] = NULL;
+	UNSET_BIT(rfp->fp_filp_map, fil_des[1]);
 	fil_ptr1->filp_count = 0;
 	unlock_filp(fil_ptr1);
+	release_filp(fil_ptr1);
 	unlock_filp(fil_ptr0);
+	release_filp(fil_ptr0);
 	unlock_vnode(vp);
 	unlock_vmnt(vmp);
 	return(r);
   }
 
   /* Fill in vnode */
-  vp->v_fs_e = res.fs_e;
+  enter_vnode(vp, res.fs_e, res.inode_nr);
   vp->v_mapfs_e = res.fs_e;
-  vp->v_inode_nr = res.inode_nr;
   vp->v_mapinode_nr = res.inode_nr;
   vp->v_mode = res.fmode;
   vp->v_fs_count = 1;
@@ -126,6 +151,11 @@ static int create_pipe(int fil_des[2], int flags)
   vp->v_vmnt = NULL;
   vp->v_dev = NO_DEV;
 
+  /* Keep the pipe data in VFS itself if a buffer is available, avoiding PFS
+   * round trips for reads and writes.
+   */
+  pipe_buf_attach(vp);
+
   /* Fill in filp objects */
   fil_ptr0->filp_vno = vp;
   dup_vnode(vp);
@@ -181,6 +211,109 @@ map_vnode(struct vnode *vp, endpoint_t map_to_fs_e)
   return(r);
 }
 
+/*===========================================================================*
+ *				pipe_buf_attach				     *
+ *===========================================================================*/
+void
+pipe_buf_attach(struct vnode *vp)
+{
+/* Try to assign a free in-VFS data buffer to the given pipe vnode. If none
+ * is available, the pipe will store its data on PFS instead.
+ */
+  struct pipe_buf *pb;
+
+  if (vp->v_pipe_buf != NULL) return;	/* already has a buffer */
+  if (vp->v_size != 0) return;	/* size is nonzero but our buffer would be
+				 * empty; leave this pipe on PFS */
+
+  for (pb = &pipe_buf[0]; pb < &pipe_buf[NR_PIPE_BUFS]; pb++) {
+	if (pb->pb_vp == NULL) {
+		pb->pb_vp = vp;
+		pb->pb_off = 0;
+		vp->v_pipe_buf = pb;
+		return;
+	}
+  }
+}
+
+/*===========================================================================*
+ *				pipe_buf_detach				     *
+ *===========================================================================*/
+void
+pipe_buf_detach(struct vnode *vp)
+{
+/* Release the in-VFS data buffer of the given pipe vnode, if it has one. */
+  struct pipe_buf *pb;
+
+  if ((pb = vp->v_pipe_buf) == NULL) return;
+
+  assert(pb->pb_vp == vp);
+  pb->pb_vp = NULL;
+  vp->v_pipe_buf = NULL;
+}
+
+/*===========================================================================*
+ *				pipe_buf_rw				     *
+ *===========================================================================*/
+int
+pipe_buf_rw(int rw_flag, endpoint_t usr_e, struct vnode *vp, vir_bytes buf,
+	size_t size, size_t *cum_iop)
+{
+/* Copy pipe data between a user buffer and the in-VFS data buffer of the
+ * given pipe vnode. The caller (rw_pipe) has already bounded the size: reads
+ * never exceed the v_size bytes buffered, and writes never push v_size beyond
+ * PIPE_BUF. The transfer may wrap around the end of the ring, in which case
+ * it is performed as two copies.
+ */
+  struct pipe_buf *pb;
+  size_t off, chunk;
+  int r;
+
+  pb = vp->v_pipe_buf;
+  assert(pb != NULL);
+  assert(pb->pb_vp == vp);
+  assert(size > 0 && size <= PIPE_BUF);
+
+  if (rw_flag == READING) {
+	assert((off_t) size <= vp->v_size);
+	off = pb->pb_off;
+  } else {
+	assert(vp->v_size + (off_t) size <= PIPE_BUF);
+	off = (pb->pb_off + (size_t) vp->v_size) % PIPE_BUF;
+  }
+
+  chunk = size;
+  if (off + chunk > PIPE_BUF)
+	chunk = PIPE_BUF - off;
+
+  if (rw_flag == READING)
+	r = sys_datacopy_wrapper(SELF, (vir_bytes) &pb->pb_data[off],
+				 usr_e, buf, chunk);
+  else
+	r = sys_datacopy_wrapper(usr_e, buf,
+				 SELF, (vir_bytes) &pb->pb_data[off], chunk);
+
+  if (r == OK && chunk < size) {
+	/* Wrapped; copy the remainder at the start of the ring. */
+	if (rw_flag == READING)
+		r = sys_datacopy_wrapper(SELF, (vir_bytes) &pb->pb_data[0],
+					 usr_e, buf + chunk, size - chunk);
+	else
+		r = sys_datacopy_wrapper(usr_e, buf + chunk,
+					 SELF, (vir_bytes) &pb->pb_data[0],
+					 size - chunk);
+  }
+
+  if (r != OK)
+	return(r);
+
+  if (rw_flag == READING)
+	pb->pb_off = (off + size) % PIPE_BUF;
+
+  *cum_iop = size;
+  return(OK);
+}
+
 /*===========================================================================*
  *				pipe_check				     *
  *===========================================================================*/
@@ -396,7 +529,8 @@ void release(struct vnode * vp, int op, int count)
   /* Search the proc table. */
   for (rp = &fproc[0]; rp < &fproc[NR_PROCS] && count > 0; rp++) {
 	/* Just to make sure:
-	 * - FP_BLOCKED_ON_POPEN implies the original request was VFS_OPEN;
+	 * - FP_BLOCKED_ON_POPEN implies the original request was VFS_OPEN
+	 *   or VFS_OPENAT, and callers pass VFS_OPEN for either;
 	 * - FP_BLOCKED_ON_PIPE may be the result of VFS_READ and VFS_WRITE,
 	 *   and one of those two numbers is stored in fp_pipe.callnr.
 	 */
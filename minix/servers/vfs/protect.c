@@ -11,6 +11,7 @@
 #include "fs.h"
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <assert.h>
 #include <minix/callnr.h>
 #include "file.h"
@@ -24,7 +25,8 @@
  *===========================================================================*/
 int do_chmod(void)
 {
-/* Perform the chmod(name, mode) and fchmod(fd, mode) system calls.
+/* Perform the chmod(name, mode), fchmod(fd, mode), and fchmodat(dirfd, name,
+ * mode, flags) system calls.
  * syscall might provide 'name' embedded in the message.
  */
 
@@ -49,6 +51,20 @@ int do_chmod(void)
 	if (copy_path(fullpath, sizeof(fullpath)) != OK)
 		return(err_code);
 	if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
+  } else if (job_call_nr == VFS_CHMODAT) {
+	new_mode = job_m_in.m_lc_vfs_at.mode;
+	if (job_m_in.m_lc_vfs_at.flags & ~AT_SYMLINK_NOFOLLOW)
+		return(EINVAL);
+	/* There is no way to change the mode of a symlink itself. */
+	if (job_m_in.m_lc_vfs_at.flags & AT_SYMLINK_NOFOLLOW)
+		return(EOPNOTSUPP);
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+	/* Temporarily open the file */
+	if (fetch_name(job_m_in.m_lc_vfs_at.name, job_m_in.m_lc_vfs_at.len,
+	    fullpath) != OK)
+		return(err_code);
+	if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
   } else {	/* call_nr == VFS_FCHMOD */
 	rfd = job_m_in.m_lc_vfs_fchmod.fd;
 	new_mode = job_m_in.m_lc_vfs_fchmod.mode;
@@ -76,14 +92,16 @@ int do_chmod(void)
 		new_mode &= ~I_SET_GID_BIT;
 
 	r = req_chmod(vp->v_fs_e, vp->v_inode_nr, new_mode, &result_mode);
-	if (r == OK)
+	if (r == OK) {
 		vp->v_mode = result_mode;
+		vp->v_stat_ticks = 0;	/* mode and ctime changed */
+	}
   }
 
-  if (job_call_nr == VFS_CHMOD) {
+  if (job_call_nr != VFS_FCHMOD) {
 	unlock_vnode(vp);
 	unlock_vmnt(vmp);
-  } else {	/* VFS_FCHMOD */
+  } else {
 	unlock_filp(flp);
   }
 
@@ -97,12 +115,12 @@ int do_chmod(void)
  *===========================================================================*/
 int do_chown(void)
 {
-/* Perform the chown(path, owner, group) and fchmod(fd, owner, group) system
- * calls. */
+/* Perform the chown(path, owner, group), fchown(fd, owner, group), and
+ * fchownat(dirfd, path, owner, group, flags) system calls. */
   struct filp *flp;
   struct vnode *vp;
   struct vmnt *vmp;
-  int r, rfd;
+  int r, rfd, lookup_flags;
   uid_t uid, new_uid;
   gid_t gid, new_gid;
   mode_t new_mode;
@@ -112,14 +130,35 @@ int do_chown(void)
   size_t vname1_length;
 
   flp = NULL;
-  uid = job_m_in.m_lc_vfs_chown.owner;
-  gid = job_m_in.m_lc_vfs_chown.group;
 
-  if (job_call_nr == VFS_CHOWN) {
-	vname1 = job_m_in.m_lc_vfs_chown.name;
-	vname1_length = job_m_in.m_lc_vfs_chown.len;
+  if (job_call_nr == VFS_CHOWNAT) {
+	uid = job_m_in.m_lc_vfs_at.owner;
+	gid = job_m_in.m_lc_vfs_at.group;
+  } else {
+	uid = job_m_in.m_lc_vfs_chown.owner;
+	gid = job_m_in.m_lc_vfs_chown.group;
+  }
+
+  if (job_call_nr == VFS_CHOWN || job_call_nr == VFS_CHOWNAT) {
+	lookup_flags = PATH_NOFLAGS;
+
+	if (job_call_nr == VFS_CHOWNAT) {
+		vname1 = job_m_in.m_lc_vfs_at.name;
+		vname1_length = job_m_in.m_lc_vfs_at.len;
+
+		if (job_m_in.m_lc_vfs_at.flags & ~AT_SYMLINK_NOFOLLOW)
+			return(EINVAL);
+		if (job_m_in.m_lc_vfs_at.flags & AT_SYMLINK_NOFOLLOW)
+			lookup_flags = PATH_RET_SYMLINK; /* lchown(2) style */
+
+		if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+			return(r);
+	} else {
+		vname1 = job_m_in.m_lc_vfs_chown.name;
+		vname1_length = job_m_in.m_lc_vfs_chown.len;
+	}
 
-	lookup_init(&resolve, fullpath, PATH_NOFLAGS, &vmp, &vp);
+	lookup_init(&resolve, fullpath, lookup_flags, &vmp, &vp);
 	resolve.l_vmnt_lock = VMNT_READ;
 	resolve.l_vnode_lock = VNODE_WRITE;
 
@@ -162,13 +201,14 @@ int do_chown(void)
 		vp->v_uid = new_uid;
 		vp->v_gid = new_gid;
 		vp->v_mode = new_mode;
+		vp->v_stat_ticks = 0;	/* ownership and ctime changed */
 	}
   }
 
-  if (job_call_nr == VFS_CHOWN) {
+  if (job_call_nr != VFS_FCHOWN) {
 	unlock_vnode(vp);
 	unlock_vmnt(vmp);
-  } else {	/* VFS_FCHOWN */
+  } else {
 	unlock_filp(flp);
   }
 
@@ -197,7 +237,8 @@ int do_umask(void)
  *===========================================================================*/
 int do_access(void)
 {
-/* Perform the access(name, mode) system call.
+/* Perform the access(name, mode) and faccessat(dirfd, name, mode, flags)
+ * system calls.
  * syscall might provide 'name' embedded in the message.
  */
   int r;
@@ -207,7 +248,10 @@ int do_access(void)
   struct lookup resolve;
   mode_t access;
 
-  access = job_m_in.m_lc_vfs_path.mode;
+  if (job_call_nr == VFS_ACCESSAT)
+	access = job_m_in.m_lc_vfs_at.mode;
+  else
+	access = job_m_in.m_lc_vfs_path.mode;
 
   lookup_init(&resolve, fullpath, PATH_NOFLAGS, &vmp, &vp);
   resolve.l_vmnt_lock = VMNT_READ;
@@ -217,9 +261,20 @@ int do_access(void)
   if ( (access & ~(R_OK | W_OK | X_OK)) != 0 && access != F_OK)
 	return(EINVAL);
 
-  /* Temporarily open the file. */
-  if (copy_path(fullpath, sizeof(fullpath)) != OK)
-	return(err_code);
+  if (job_call_nr == VFS_ACCESSAT) {
+	if (job_m_in.m_lc_vfs_at.flags & ~AT_EACCESS)
+		return(EINVAL);
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+	if (fetch_name(job_m_in.m_lc_vfs_at.name, job_m_in.m_lc_vfs_at.len,
+	    fullpath) != OK)
+		return(err_code);
+  } else {
+	/* Temporarily open the file. */
+	if (copy_path(fullpath, sizeof(fullpath)) != OK)
+		return(err_code);
+  }
   if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
 
   r = forbidden(fp, vp, access);
@@ -250,10 +305,18 @@ int forbidden(struct fproc *rfp, struct vnode *vp, mode_t access_desired)
 
   if (vp->v_uid == (uid_t) -1 || vp->v_gid == (gid_t) -1) return(EACCES);
 
-  /* Isolate the relevant rwx bits from the mode. */
+  /* Isolate the relevant rwx bits from the mode. access(2) and, unless
+   * AT_EACCESS is given, faccessat(2) check against the real IDs.
+   */
   bits = vp->v_mode;
-  uid = (job_call_nr == VFS_ACCESS ? rfp->fp_realuid : rfp->fp_effuid);
-  gid = (job_call_nr == VFS_ACCESS ? rfp->fp_realgid : rfp->fp_effgid);
+  if (job_call_nr == VFS_ACCESS || (job_call_nr == VFS_ACCESSAT &&
+      !(job_m_in.m_lc_vfs_at.flags & AT_EACCESS))) {
+	uid = rfp->fp_realuid;
+	gid = rfp->fp_realgid;
+  } else {
+	uid = rfp->fp_effuid;
+	gid = rfp->fp_effgid;
+  }
 
   if (uid == SU_UID) {
 	/* Grant read and write permission.  Grant search permission for
@@ -82,6 +82,7 @@ int get_fd(struct fproc *rfp, int start, mode_t bits, int *k,
 	struct filp **fpt);
 struct filp *get_filp(int fild, tll_access_t locktype);
 struct filp *get_filp2(struct fproc *rfp, int fild, tll_access_t locktype);
+void release_filp(struct filp *f);
 void lock_filp(struct filp *filp, tll_access_t locktype);
 void unlock_filp(struct filp *filp);
 void unlock_filps(struct filp *filp1, struct filp *filp2);
@@ -127,6 +128,7 @@ void pm_setgroups(endpoint_t proc_e, int ngroups, gid_t *addr);
 void pm_setsid(endpoint_t proc_e);
 int do_sync(void);
 int do_fsync(void);
+int do_fadvise(void);
 void pm_reboot(void);
 int do_svrctl(void);
 int do_getsysinfo(void);
@@ -170,6 +172,8 @@ void lookup_init(struct lookup *resolve, char *path, int flags, struct
 	vmnt **vmp, struct vnode **vp);
 int get_name(struct vnode *dirp, struct vnode *entry, char *_name);
 int canonical_path(char *orig_path, struct fproc *rfp);
+int set_atdir(int dirfd);
+void clear_atdir(void);
 int do_socketpath(void);
 
 /* pipe.c */
@@ -178,6 +182,10 @@ int map_vnode(struct vnode *vp, endpoint_t fs_e);
 void unpause(void);
 int pipe_check(struct filp *filp, int rw_flag, int oflags, int bytes,
 	int notouch);
+void pipe_buf_attach(struct vnode *vp);
+void pipe_buf_detach(struct vnode *vp);
+int pipe_buf_rw(int rw_flag, endpoint_t usr_e, struct vnode *vp,
+	vir_bytes buf, size_t size, size_t *cum_iop);
 void release(struct vnode *vp, int op, int count);
 void revive(endpoint_t proc_e, int returned);
 void suspend(int why);
@@ -197,6 +205,8 @@ int read_only(struct vnode *vp);
 /* read.c */
 int do_read(void);
 int do_getdents(void);
+int do_sendfile(void);
+void resume_sendfile(struct fproc *rfp, int status, int may_continue);
 void lock_bsf(void);
 void unlock_bsf(void);
 void check_bsf_lock(void);
@@ -224,6 +234,7 @@ int req_ftrunc(endpoint_t fs_e, ino_t inode_nr, off_t start, off_t end);
 int req_getdents(endpoint_t fs_e, ino_t inode_nr, off_t pos, vir_bytes buf,
 	size_t size, off_t *new_pos, int direct);
 int req_inhibread(endpoint_t fs_e, ino_t inode_nr);
+int req_fadvise(endpoint_t fs_e, ino_t inode_nr, int advice);
 int req_link(endpoint_t fs_e, ino_t link_parent, char *lastc,
 	ino_t linked_file);
 int req_lookup(endpoint_t fs_e, ino_t dir_ino, ino_t root_ino, uid_t uid,
@@ -267,11 +278,16 @@ int sdev_connect(dev_t dev, vir_bytes addr, unsigned int addr_len,
 	int filp_flags);
 int sdev_listen(dev_t dev, int backlog);
 int sdev_accept(dev_t dev, vir_bytes addr, unsigned int addr_len,
-	int filp_flags, int fd);
+	int filp_flags, int fd, int fd_flags);
 int sdev_readwrite(dev_t dev, vir_bytes data_buf, size_t data_len,
 	vir_bytes ctl_buf, unsigned int ctl_len, vir_bytes addr_buf,
 	unsigned int addr_len, int flags, int rw_flag, int filp_flags,
 	vir_bytes user_buf);
+int sdev_sendfile(dev_t dev, char * buf, size_t len, int filp_flags);
+int sdev_mmsg(struct fproc *rfp, dev_t dev, vir_bytes data_buf,
+	size_t data_len, vir_bytes ctl_buf, unsigned int ctl_len,
+	vir_bytes addr_buf, unsigned int addr_len, int flags, int rw_flag,
+	int filp_flags);
 int sdev_ioctl(dev_t dev, unsigned long request, vir_bytes buf,
 	int filp_flags);
 int sdev_setsockopt(dev_t dev, int level, int name, vir_bytes addr,
@@ -311,6 +327,9 @@ int do_sendto(void);
 int do_recvfrom(void);
 void resume_recvfrom(struct fproc *rfp, int status, unsigned int addr_len);
 int do_sockmsg(void);
+int do_sockmmsg(void);
+void resume_sockmmsg(struct fproc *rfp, int status, unsigned int ctl_len,
+	unsigned int addr_len, int flags, int may_continue);
 void resume_recvmsg(struct fproc *rfp, int status, unsigned int ctl_len,
 	unsigned int addr_len, int flags, vir_bytes msg_buf);
 int do_setsockopt(void);
@@ -360,9 +379,11 @@ int sys_datacopy_wrapper(endpoint_t src, vir_bytes srcv, endpoint_t dst,
 /* vmnt.c */
 void check_vmnt_locks(void);
 void check_vmnt_locks_by_me(struct fproc *rfp);
+void enter_vmnt(struct vmnt *vmp, endpoint_t fs_e, dev_t dev);
 void mark_vmnt_free(struct vmnt *vmp);
 struct vmnt *get_free_vmnt(void);
 struct vmnt *find_vmnt(endpoint_t fs_e);
+struct vmnt *find_vmnt_by_dev(dev_t dev);
 struct vmnt *get_locked_vmnt(struct fproc *rfp);
 void init_vmnts(void);
 int lock_vmnt(struct vmnt *vp, tll_access_t locktype);
@@ -372,11 +393,21 @@ void fetch_vmnt_paths(void);
 void upgrade_vmnt_lock(struct vmnt *vmp);
 void downgrade_vmnt_lock(struct vmnt *vmp);
 
+/* dcache.c */
+int lookup_dcache(endpoint_t dir_fs_e, ino_t dir_ino, const char *name,
+	endpoint_t *fs_e, ino_t *ino);
+void enter_dcache(endpoint_t dir_fs_e, ino_t dir_ino, const char *name,
+	endpoint_t fs_e, ino_t ino);
+void del_dcache(endpoint_t dir_fs_e, ino_t dir_ino, const char *name);
+void flush_dcache(void);
+
 /* vnode.c */
 void check_vnode_locks(void);
 void check_vnode_locks_by_me(struct fproc *rfp);
 struct vnode *get_free_vnode(void);
 struct vnode *find_vnode(int fs_e, ino_t inode);
+void enter_vnode(struct vnode *vp, int fs_e, ino_t inode);
+void mark_vnode_free(struct vnode *vp);
 void init_vnodes(void);
 int is_vnode_locked(struct vnode *vp);
 int lock_vnode(struct vnode *vp, tll_access_t locktype);
@@ -6,6 +6,7 @@
  * The entry points into this file are
  *   do_read:	 perform the READ system call by calling read_write
  *   do_getdents: read entries from a directory (GETDENTS)
+ *   do_sendfile: transfer data from a regular file to a socket (SENDFILE)
  *   read_write: actually do the work of READ and WRITE
  *
  */
@@ -250,6 +251,9 @@ int read_write(struct fproc *rfp, int rw_flag, int fd, struct filp *f,
         }
   }
 
+  /* Reads and writes change the file times, so drop cached attributes. */
+  if (rw_flag != PEEKING) vp->v_stat_ticks = 0;
+
   /* On write, update file size and access time. */
   if (rw_flag == WRITING) {
 	if (S_ISREG(vp->v_mode) || S_ISDIR(vp->v_mode)) {
@@ -310,12 +314,243 @@ int do_getdents(void)
 	    rfilp->filp_pos, buf, size, &new_pos, 0);
 
 	if (r > 0) rfilp->filp_pos = new_pos;
+
+	/* Reading the directory changes its access time. */
+	rfilp->filp_vno->v_stat_ticks = 0;
+  }
+
+  unlock_filp(rfilp);
+  return(r);
+}
+
+
+/* Intermediate buffers for sendfile(2) transfers.  Since the calling process
+ * is suspended while each chunk's socket send is in flight, a buffer stays in
+ * use for the full duration of a transfer, across worker threads.  The
+ * buffers are therefore kept in a fixed pool, with each in-use buffer owned
+ * by the process performing the transfer.
+ */
+static char sendfile_buf[NR_SENDFILE_BUFS][SENDFILE_BUFSIZ];
+static struct fproc *sendfile_user[NR_SENDFILE_BUFS];	/* owner, or NULL */
+
+/*===========================================================================*
+ *				get_sendfile_buf			     *
+ *===========================================================================*/
+static int get_sendfile_buf(struct fproc *rfp)
+{
+/* Claim a free sendfile buffer for the given process.  Return its index, or
+ * -1 if all buffers are currently in use.
+ */
+  int i;
+
+  for (i = 0; i < NR_SENDFILE_BUFS; i++) {
+	if (sendfile_user[i] == NULL) {
+		sendfile_user[i] = rfp;
+		return(i);
+	}
   }
+  return(-1);
+}
+
+/*===========================================================================*
+ *				put_sendfile_buf			     *
+ *===========================================================================*/
+static void put_sendfile_buf(struct fproc *rfp, int bufidx)
+{
+/* Release a sendfile buffer previously claimed by the given process. */
+
+  assert(bufidx >= 0 && bufidx < NR_SENDFILE_BUFS);
+  assert(sendfile_user[bufidx] == rfp);
+
+  sendfile_user[bufidx] = NULL;
+}
+
+/*===========================================================================*
+ *				sendfile_chunk				     *
+ *===========================================================================*/
+static int sendfile_chunk(void)
+{
+/* Read the next chunk of an ongoing sendfile(2) transfer from the file system
+ * into the transfer's buffer, and hand it to the socket driver, suspending
+ * the calling process until the send reply comes in.  The transfer state is
+ * kept in fp->fp_sdev.aux.sf.  This function is called from the worker thread
+ * of the sending process, both for the original system call and, through
+ * resume_sendfile(), for each chunk continuation.  Return SUSPEND if a chunk
+ * was put in flight, 0 on end of file, or a negative error code on failure.
+ */
+  struct filp *rfilp;
+  off_t new_pos;
+  size_t chunk, cum_io_incr;
+  char *buf;
+  int r;
+
+  buf = sendfile_buf[fp->fp_sdev.aux.sf.bufidx];
+
+  chunk = fp->fp_sdev.aux.sf.len - fp->fp_sdev.aux.sf.cum_io;
+  if (chunk > SENDFILE_BUFSIZ) chunk = SENDFILE_BUFSIZ;
+  if (chunk == 0) return(0);
+
+  /* Look up and lock the input file.  Since the calling process is blocked
+   * for the duration of the call, its file descriptor table cannot change,
+   * and the descriptor is revalidated only as a side effect of the lookup.
+   */
+  if ((rfilp = get_filp(fp->fp_sdev.aux.sf.in_fd, VNODE_READ)) == NULL)
+	return(err_code);
+
+  /* Read the next chunk from the file system into our own buffer. */
+  r = req_readwrite(rfilp->filp_vno->v_fs_e, rfilp->filp_vno->v_inode_nr,
+	fp->fp_sdev.aux.sf.offset + (off_t)fp->fp_sdev.aux.sf.cum_io, READING,
+	VFS_PROC_NR, (vir_bytes)buf, chunk, &new_pos, &cum_io_incr);
+  unlock_filp(rfilp);
+
+  if (r != OK) return(r);
+  if (cum_io_incr == 0) return(0);	/* end of file */
 
+  /* Hand the chunk to the socket driver, and suspend the process until the
+   * reply comes in.  Note that sdev_sendfile() overwrites part of the
+   * fp_sdev state, so the chunk size must be saved before the call.
+   */
+  fp->fp_sdev.aux.sf.chunk = cum_io_incr;
+
+  return sdev_sendfile(fp->fp_sdev.dev, buf, cum_io_incr,
+	fp->fp_sdev.aux.sf.filp_flags);
+}
+
+/*===========================================================================*
+ *				do_sendfile				     *
+ *===========================================================================*/
+int do_sendfile(void)
+{
+/* Perform the sendfile(out_fd, in_fd, offset, count) system call.  Transfer
+ * data from a regular file directly to a socket, using a VFS-local buffer as
+ * intermediate storage, thus bypassing the calling process's address space
+ * entirely.  The file is read at the explicitly given offset; the file
+ * position of neither file descriptor is changed.  The transfer is chunked:
+ * each chunk is read from the file system into the transfer's buffer and then
+ * handed to the socket driver, with the calling process suspended until the
+ * driver's reply arrives, just as for regular socket sends.  The reply then
+ * triggers resume_sendfile(), which puts the next chunk in flight or finishes
+ * the call.  The call's result is the number of bytes actually sent, which
+ * may be fewer than requested--due to EOF, a filled-up socket send buffer, or
+ * an error after a partial transfer.
+ */
+  int r, in_fd, out_fd, bufidx;
+  off_t offset;
+  size_t len;
+  struct filp *rfilp, *wfilp;
+  dev_t dev;
+  int filp_flags;
+
+  out_fd = job_m_in.m_lc_vfs_sendfile.out_fd;
+  in_fd = job_m_in.m_lc_vfs_sendfile.in_fd;
+  offset = job_m_in.m_lc_vfs_sendfile.offset;
+  len = job_m_in.m_lc_vfs_sendfile.len;
+
+  if (offset < 0) return(EINVAL);
+  if (len > SSIZE_MAX) return(EINVAL);
+
+  /* The input file must be a regular file, open for reading. */
+  if ((rfilp = get_filp(in_fd, VNODE_READ)) == NULL)
+	return(err_code);
+  r = OK;
+  if (!(rfilp->filp_mode & R_BIT)) r = EBADF;
+  else if (!S_ISREG(rfilp->filp_vno->v_mode)) r = EINVAL;
   unlock_filp(rfilp);
+  if (r != OK) return(r);
+
+  /* The output file must be a socket, open for writing. */
+  if ((wfilp = get_filp(out_fd, VNODE_WRITE)) == NULL)
+	return(err_code);
+  dev = wfilp->filp_vno->v_sdev;
+  filp_flags = wfilp->filp_flags;
+  if (!(wfilp->filp_mode & W_BIT)) r = EBADF;
+  else if (!S_ISSOCK(wfilp->filp_vno->v_mode)) r = EINVAL;
+  else if (dev == NO_DEV)
+	panic("VFS: sendfile tries to access sock dev NO_DEV");
+  unlock_filp(wfilp);
+  if (r != OK) return(r);
+
+  /* Claim an intermediate buffer for the duration of the transfer. */
+  if ((bufidx = get_sendfile_buf(fp)) < 0)
+	return(ENOMEM);
+
+  /* Initialize the transfer state, and put the first chunk in flight. */
+  fp->fp_sdev.dev = dev;
+  fp->fp_sdev.aux.sf.in_fd = in_fd;
+  fp->fp_sdev.aux.sf.bufidx = bufidx;
+  fp->fp_sdev.aux.sf.filp_flags = filp_flags;
+  fp->fp_sdev.aux.sf.offset = offset;
+  fp->fp_sdev.aux.sf.len = len;
+  fp->fp_sdev.aux.sf.cum_io = 0;
+
+  /* On EPIPE, the socket driver itself takes care of raising SIGPIPE, since
+   * we pass it MSG_NOSIGNAL only if O_NOSIGPIPE is set on the socket.
+   */
+  r = sendfile_chunk();
+
+  if (r != SUSPEND) {
+	/* Zero-length request, immediate EOF, or error before any progress
+	 * was made: finish the call right away.
+	 */
+	put_sendfile_buf(fp, bufidx);
+  }
   return(r);
 }
 
+/*===========================================================================*
+ *				resume_sendfile				     *
+ *===========================================================================*/
+void resume_sendfile(struct fproc *rfp, int status, int may_continue)
+{
+/* Resume a previously suspended sendfile(2) system call.  The 'status'
+ * parameter contains either the number of data bytes accepted by the socket
+ * driver for the chunk in flight, or a negative error code.  If
+ * 'may_continue' is set, we are called from a worker thread associated with
+ * the process, and may thus read and put in flight the next chunk of the
+ * transfer, suspending the process again.  Otherwise, the call was canceled
+ * due to a signal or socket driver death, and must be finished now; in that
+ * case this function MUST NOT block its calling thread.
+ */
+  size_t chunk, cum_io;
+  int r;
+
+  chunk = rfp->fp_sdev.aux.sf.chunk;
+
+  if (status > 0) {
+	if ((size_t)status > chunk) {
+		printf("VFS: bad sendfile reply length %d from driver\n",
+			status);
+		status = EIO;
+	} else {
+		rfp->fp_sdev.aux.sf.cum_io += status;
+
+		/* If the socket took all of the chunk, and more data is to be
+		 * sent, continue with the next chunk.  If the socket took
+		 * less, do not read any further; the caller will offer the
+		 * remainder again on its next call.
+		 */
+		if ((size_t)status == chunk && may_continue) {
+			assert(fp == rfp);
+
+			r = sendfile_chunk();
+			if (r == SUSPEND)
+				return;	/* the next chunk is in flight */
+
+			/* On EOF, or an error after partial progress, finish
+			 * the call with the progress made so far.
+			 */
+		}
+	}
+  }
+
+  put_sendfile_buf(rfp, rfp->fp_sdev.aux.sf.bufidx);
+
+  cum_io = rfp->fp_sdev.aux.sf.cum_io;
+  if (cum_io > 0)
+	replycode(rfp->fp_endpoint, cum_io);
+  else
+	replycode(rfp->fp_endpoint, (status < 0) ? status : 0);
+}
 
 /*===========================================================================*
  *				rw_pipe					     *
@@ -362,8 +597,11 @@ int rw_pipe(int rw_flag, endpoint_t usr_e, struct filp *f, int callnr, int fd,
   if (vp->v_mapfs_e == 0)
 	panic("unmapped pipe");
 
-  r = req_readwrite(vp->v_mapfs_e, vp->v_mapinode_nr, position, rw_flag, usr_e,
-		    buf, size, &new_pos, &cum_io_incr);
+  if (vp->v_pipe_buf != NULL)
+	r = pipe_buf_rw(rw_flag, usr_e, vp, buf, size, &cum_io_incr);
+  else
+	r = req_readwrite(vp->v_mapfs_e, vp->v_mapinode_nr, position, rw_flag,
+			  usr_e, buf, size, &new_pos, &cum_io_incr);
 
   if (r != OK) {
 	assert(r != SUSPEND);
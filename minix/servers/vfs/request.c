@@ -384,6 +384,30 @@ int req_inhibread(endpoint_t fs_e, ino_t inode_nr)
 }
 
 
+/*===========================================================================*
+ *				req_fadvise	  			     *
+ *===========================================================================*/
+int req_fadvise(endpoint_t fs_e, ino_t inode_nr, int advice)
+{
+  message m;
+  int r;
+
+  /* Fill in request message */
+  m.m_type = REQ_FADVISE;
+  m.m_vfs_fs_fadvise.inode = inode_nr;
+  m.m_vfs_fs_fadvise.advice = advice;
+
+  /* Send/rec request */
+  r = fs_sendrec(fs_e, &m);
+
+  /* Not all file systems know the request; the hint simply is not applied. */
+  if (r == ENOSYS)
+	r = OK;
+
+  return(r);
+}
+
+
 /*===========================================================================*
  *				req_link	       			     *
  *===========================================================================*/
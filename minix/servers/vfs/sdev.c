@@ -90,10 +90,10 @@ sdev_suspend(dev_t dev, cp_grant_id_t grant0, cp_grant_id_t grant1,
 	fp->fp_sdev.grant[1] = grant1;
 	fp->fp_sdev.grant[2] = grant2;
 
-	if (job_call_nr == VFS_ACCEPT) {
+	if (job_call_nr == VFS_ACCEPT || job_call_nr == VFS_ACCEPT4) {
 		assert(fd != -1);
 		assert(buf == 0);
-		fp->fp_sdev.aux.fd = fd;
+		fp->fp_sdev.aux.acc.fd = fd;
 	} else if (job_call_nr == VFS_RECVMSG) {
 		assert(fd == -1);
 		/*
@@ -290,7 +290,7 @@ sdev_listen(dev_t dev, int backlog)
  */
 int
 sdev_accept(dev_t dev, vir_bytes addr, unsigned int addr_len, int filp_flags,
-	int listen_fd)
+	int listen_fd, int fd_flags)
 {
 	struct smap *sp;
 	sockid_t sock_id;
@@ -325,6 +325,14 @@ sdev_accept(dev_t dev, vir_bytes addr, unsigned int addr_len, int filp_flags,
 	if ((r = asynsend3(sp->smap_endpt, &m, AMF_NOREPLY)) != OK)
 		panic("VFS: asynsend in sdev_accept failed: %d", r);
 
+	/*
+	 * Save the O_xx flags that accept4(2) requested for the new file
+	 * descriptor.  This field is independent from the auxiliary data set
+	 * by sdev_suspend() below, and is used by resume_accept() only for
+	 * VFS_ACCEPT4 calls.
+	 */
+	fp->fp_sdev.aux.acc.flags = fd_flags;
+
 	/* Suspend the process until the reply arrives. */
 	return sdev_suspend(dev, grant, GRANT_INVALID, GRANT_INVALID,
 	    listen_fd, 0);
@@ -410,6 +418,162 @@ sdev_readwrite(dev_t dev, vir_bytes data_buf, size_t data_len,
 	    user_buf);
 }
 
+/*
+ * Send data from a VFS-local buffer to a socket, on behalf of a sendfile(2)
+ * call.  This is a long-lived request: the calling process is suspended until
+ * the socket driver replies, just as in sdev_readwrite().  The reply is then
+ * processed by resume_sendfile(), which may call back into this function to
+ * put the next chunk of file data in flight.  This function is called from
+ * the worker thread of the process identified by 'fp', either for the
+ * original system call or for a chunk continuation, and always returns
+ * SUSPEND on success, or a negative error code on failure.
+ */
+int
+sdev_sendfile(dev_t dev, char * buf, size_t len, int filp_flags)
+{
+	struct smap *sp;
+	sockid_t sock_id;
+	cp_grant_id_t grant;
+	message m;
+	int r;
+
+	if ((sp = get_smap_by_dev(dev, &sock_id)) == NULL)
+		return EIO;
+
+	/* The buffer is owned by VFS itself, so use a direct grant. */
+	grant = cpf_grant_direct(sp->smap_endpt, (vir_bytes)buf, len,
+	    CPF_READ);
+	if (!GRANT_VALID(grant))
+		panic("VFS: cpf_grant_direct failed");
+
+	/* Prepare the request message. */
+	memset(&m, 0, sizeof(m));
+	m.m_type = SDEV_SEND;
+	m.m_vfs_lsockdriver_sendrecv.req_id = (sockid_t)fp->fp_endpoint;
+	m.m_vfs_lsockdriver_sendrecv.sock_id = sock_id;
+	m.m_vfs_lsockdriver_sendrecv.data_grant = grant;
+	m.m_vfs_lsockdriver_sendrecv.data_len = len;
+	m.m_vfs_lsockdriver_sendrecv.ctl_grant = GRANT_INVALID;
+	m.m_vfs_lsockdriver_sendrecv.addr_grant = GRANT_INVALID;
+	m.m_vfs_lsockdriver_sendrecv.user_endpt = fp->fp_endpoint;
+	m.m_vfs_lsockdriver_sendrecv.flags = 0;
+	if (filp_flags & O_NONBLOCK)
+		m.m_vfs_lsockdriver_sendrecv.flags |= MSG_DONTWAIT;
+	if (filp_flags & O_NOSIGPIPE)
+		m.m_vfs_lsockdriver_sendrecv.flags |= MSG_NOSIGNAL;
+
+	/* Send the request to the driver. */
+	if ((r = asynsend3(sp->smap_endpt, &m, AMF_NOREPLY)) != OK)
+		panic("VFS: asynsend in sdev_sendfile failed: %d", r);
+
+	/*
+	 * Suspend the process until the reply arrives.  We do not use
+	 * sdev_suspend() here, because for chunk continuations, the call
+	 * number of the current job is a socket driver reply code rather than
+	 * the original VFS_SENDFILE.  The sendfile-specific auxiliary state
+	 * (fp_sdev.aux.sf) is managed by the upper socket layer.
+	 */
+	fp->fp_sdev.dev = dev;
+	fp->fp_sdev.callnr = VFS_SENDFILE;
+	fp->fp_sdev.grant[0] = grant;
+	fp->fp_sdev.grant[1] = GRANT_INVALID;
+	fp->fp_sdev.grant[2] = GRANT_INVALID;
+
+	suspend(FP_BLOCKED_ON_SDEV);
+	return SUSPEND;
+}
+
+/*
+ * Send or receive a single datagram, on behalf of a sendmmsg(2) or
+ * recvmmsg(2) call.  This is the same request-making procedure as in
+ * sdev_readwrite(), except that it operates on the given process rather than
+ * the current one: the batch's second and further elements are put in flight
+ * from the reply handler for the previous element, which runs on the main
+ * thread.  For the same reason, the process's stored call number, which is
+ * set by do_sockmmsg() for the batch as a whole, is left untouched here.  On
+ * success, suspend the given process and return SUSPEND.  Return a negative
+ * error code on failure.
+ */
+int
+sdev_mmsg(struct fproc * rfp, dev_t dev, vir_bytes data_buf, size_t data_len,
+	vir_bytes ctl_buf, unsigned int ctl_len, vir_bytes addr_buf,
+	unsigned int addr_len, int flags, int rw_flag, int filp_flags)
+{
+	struct smap *sp;
+	sockid_t sock_id;
+	cp_grant_id_t data_grant, ctl_grant, addr_grant;
+	message m;
+	int r, bits;
+
+	if ((sp = get_smap_by_dev(dev, &sock_id)) == NULL)
+		return EIO;
+
+	/* Allocate resources. */
+	data_grant = GRANT_INVALID;
+	ctl_grant = GRANT_INVALID;
+	addr_grant = GRANT_INVALID;
+	bits = (rw_flag == WRITING) ? CPF_READ : CPF_WRITE;
+
+	if (data_buf != 0) {
+		data_grant = cpf_grant_magic(sp->smap_endpt, rfp->fp_endpoint,
+		    data_buf, data_len, bits);
+		if (!GRANT_VALID(data_grant))
+			panic("VFS: cpf_grant_magic failed");
+	}
+
+	if (ctl_buf != 0) {
+		ctl_grant = cpf_grant_magic(sp->smap_endpt, rfp->fp_endpoint,
+		    ctl_buf, ctl_len, bits);
+		if (!GRANT_VALID(ctl_grant))
+			panic("VFS: cpf_grant_magic failed");
+	}
+
+	if (addr_buf != 0) {
+		addr_grant = cpf_grant_magic(sp->smap_endpt, rfp->fp_endpoint,
+		    addr_buf, addr_len, bits);
+		if (!GRANT_VALID(addr_grant))
+			panic("VFS: cpf_grant_magic failed");
+	}
+
+	/* Prepare the request message. */
+	memset(&m, 0, sizeof(m));
+	m.m_type = (rw_flag == WRITING) ? SDEV_SEND : SDEV_RECV;
+	m.m_vfs_lsockdriver_sendrecv.req_id = (sockid_t)rfp->fp_endpoint;
+	m.m_vfs_lsockdriver_sendrecv.sock_id = sock_id;
+	m.m_vfs_lsockdriver_sendrecv.data_grant = data_grant;
+	m.m_vfs_lsockdriver_sendrecv.data_len = data_len;
+	m.m_vfs_lsockdriver_sendrecv.ctl_grant = ctl_grant;
+	m.m_vfs_lsockdriver_sendrecv.ctl_len = ctl_len;
+	m.m_vfs_lsockdriver_sendrecv.addr_grant = addr_grant;
+	m.m_vfs_lsockdriver_sendrecv.addr_len = addr_len;
+	m.m_vfs_lsockdriver_sendrecv.user_endpt = rfp->fp_endpoint;
+	m.m_vfs_lsockdriver_sendrecv.flags = flags;
+	if (filp_flags & O_NONBLOCK)
+		m.m_vfs_lsockdriver_sendrecv.flags |= MSG_DONTWAIT;
+	if (rw_flag == WRITING && (filp_flags & O_NOSIGPIPE))
+		m.m_vfs_lsockdriver_sendrecv.flags |= MSG_NOSIGNAL;
+
+	/* Send the request to the driver. */
+	if ((r = asynsend3(sp->smap_endpt, &m, AMF_NOREPLY)) != OK)
+		panic("VFS: asynsend in sdev_mmsg failed: %d", r);
+
+	/*
+	 * Suspend the process until the reply arrives.  We do not use
+	 * sdev_suspend() or suspend() here: those operate on the current
+	 * process, while this function may be called from the main thread on
+	 * behalf of another process.
+	 */
+	assert(rfp->fp_blocked_on == FP_BLOCKED_ON_NONE);
+
+	rfp->fp_sdev.dev = dev;
+	rfp->fp_sdev.grant[0] = data_grant;
+	rfp->fp_sdev.grant[1] = ctl_grant;
+	rfp->fp_sdev.grant[2] = addr_grant;
+
+	rfp->fp_blocked_on = FP_BLOCKED_ON_SDEV;
+	return SUSPEND;
+}
+
 /*
  * Perform I/O control.
  */
@@ -684,7 +848,8 @@ sdev_finish_accept(struct fproc * rfp, message * m_ptr)
 	unsigned int len;
 	int status;
 
-	assert(rfp->fp_sdev.callnr == VFS_ACCEPT);
+	assert(rfp->fp_sdev.callnr == VFS_ACCEPT ||
+	    rfp->fp_sdev.callnr == VFS_ACCEPT4);
 	assert(m_ptr->m_type == SDEV_ACCEPT_REPLY);
 	assert(m_ptr->m_lsockdriver_vfs_accept_reply.sock_id >= 0);
 
@@ -722,7 +887,7 @@ sdev_finish_accept(struct fproc * rfp, message * m_ptr)
 	}
 
 	/* Let the upper socket layer handle the rest. */
-	resume_accept(rfp, status, dev, len, rfp->fp_sdev.aux.fd);
+	resume_accept(rfp, status, dev, len, rfp->fp_sdev.aux.acc.fd);
 }
 
 /*
@@ -735,6 +900,51 @@ do_accept_reply(void)
 	sdev_finish_accept(fp, &job_m_in);
 }
 
+/*
+ * A reply has arrived for the in-flight chunk of an ongoing sendfile(2) call.
+ * Process the low-level aspects of the reply, and call resume_sendfile() to
+ * let the upper socket layer account the progress and, possibly, put the next
+ * chunk in flight.  This function is always called from a worker thread
+ * associated with the suspended process, and may thus block, for example to
+ * read the next chunk from the file system.
+ */
+static void
+sdev_finish_sendfile(struct fproc * rfp, message * m_ptr)
+{
+	int status;
+
+	assert(rfp->fp_sdev.callnr == VFS_SENDFILE);
+
+	/* Free resources.  Sendfile requests use one grant. */
+	if (GRANT_VALID(rfp->fp_sdev.grant[0]))
+		cpf_revoke(rfp->fp_sdev.grant[0]);
+	assert(!GRANT_VALID(rfp->fp_sdev.grant[1]));
+	assert(!GRANT_VALID(rfp->fp_sdev.grant[2]));
+
+	if (m_ptr->m_type == SDEV_REPLY)
+		status = m_ptr->m_lsockdriver_vfs_reply.status;
+	else if (m_ptr->m_type < 0)
+		status = m_ptr->m_type;	/* the socket driver died */
+	else {
+		printf("VFS: %d sent bad reply type %d for sendfile\n",
+		    m_ptr->m_source, m_ptr->m_type);
+		status = EIO;
+	}
+
+	/* Let the upper socket layer handle the rest. */
+	resume_sendfile(rfp, status, TRUE /*may_continue*/);
+}
+
+/*
+ * Worker thread stub for processing sendfile chunk replies.
+ */
+static void
+do_sendfile_reply(void)
+{
+
+	sdev_finish_sendfile(fp, &job_m_in);
+}
+
 /*
  * With the exception of successful accept requests, this function is called
  * whenever a reply is received for a socket driver request for which the
@@ -754,9 +964,16 @@ do_accept_reply(void)
  * MUST NOT block its calling thread.  This function is called for failed
  * accept requests; successful accept requests have their replies routed
  * through sdev_finish_accept() instead, because those require a worker thread.
+ *
+ * The 'may_continue' parameter indicates whether the finished socket driver
+ * request may be followed up with another request on behalf of the same
+ * system call, as is the case for the batch calls sendmmsg(2) and
+ * recvmmsg(2).  It is set when processing a regular reply, and cleared when
+ * the call is being canceled or the socket driver has died, in which case the
+ * system call must be finished now, possibly with partial results.
  */
 static void
-sdev_finish(struct fproc * rfp, message * m_ptr)
+sdev_finish(struct fproc * rfp, message * m_ptr, int may_continue)
 {
 	unsigned int ctl_len, addr_len;
 	int callnr, status, flags;
@@ -788,11 +1005,13 @@ sdev_finish(struct fproc * rfp, message * m_ptr)
 	case VFS_WRITE:
 	case VFS_SENDTO:
 	case VFS_SENDMSG:
+	case VFS_SENDMMSG:
 	case VFS_IOCTL:
 	case VFS_CLOSE:
 		/*
-		 * These calls all use the same SDEV_REPLY reply type and only
-		 * need to reply an OK-or-error status code back to userland.
+		 * These calls all use the same SDEV_REPLY reply type and,
+		 * with the exception of sendmmsg(2), only need to reply an
+		 * OK-or-error status code back to userland.
 		 */
 		if (m_ptr->m_type == SDEV_REPLY) {
 			status = m_ptr->m_lsockdriver_vfs_reply.status;
@@ -811,12 +1030,17 @@ sdev_finish(struct fproc * rfp, message * m_ptr)
 			    m_ptr->m_source, m_ptr->m_type, callnr);
 			status = EIO;
 		}
+		if (callnr == VFS_SENDMMSG) {
+			resume_sockmmsg(rfp, status, 0, 0, 0, may_continue);
+			break;
+		}
 		replycode(rfp->fp_endpoint, status);
 		break;
 
 	case VFS_READ:
 	case VFS_RECVFROM:
 	case VFS_RECVMSG:
+	case VFS_RECVMMSG:
 		/*
 		 * These calls use SDEV_RECV_REPLY.  The action to take depends
 		 * on the exact call.
@@ -848,10 +1072,37 @@ sdev_finish(struct fproc * rfp, message * m_ptr)
 			resume_recvmsg(rfp, status, ctl_len, addr_len, flags,
 			    rfp->fp_sdev.aux.buf);
 			break;
+		case VFS_RECVMMSG:
+			resume_sockmmsg(rfp, status, ctl_len, addr_len, flags,
+			    may_continue);
+			break;
+		}
+		break;
+
+	case VFS_SENDFILE:
+		/*
+		 * This call also uses SDEV_REPLY, but we only get here if the
+		 * call was canceled or the socket driver died: replies for the
+		 * normal chunk sequence are routed through
+		 * sdev_finish_sendfile() instead, because putting the next
+		 * chunk in flight requires a worker thread.  Either way, the
+		 * call must be finished now, which is why we do not allow
+		 * resume_sendfile() to continue with the next chunk here.
+		 */
+		if (m_ptr->m_type == SDEV_REPLY) {
+			status = m_ptr->m_lsockdriver_vfs_reply.status;
+		} else if (m_ptr->m_type < 0) {
+			status = m_ptr->m_type;
+		} else {
+			printf("VFS: %d sent bad reply type %d for call %d\n",
+			    m_ptr->m_source, m_ptr->m_type, callnr);
+			status = EIO;
 		}
+		resume_sendfile(rfp, status, FALSE /*may_continue*/);
 		break;
 
 	case VFS_ACCEPT:
+	case VFS_ACCEPT4:
 		/*
 		 * This call uses SDEV_ACCEPT_REPLY.  We only get here if the
 		 * accept call has failed without creating a new socket, in
@@ -888,7 +1139,7 @@ sdev_finish(struct fproc * rfp, message * m_ptr)
 			status = EIO;
 		}
 		resume_accept(rfp, status, NO_DEV, addr_len,
-		    rfp->fp_sdev.aux.fd);
+		    rfp->fp_sdev.aux.acc.fd);
 		break;
 
 	default:
@@ -924,7 +1175,7 @@ sdev_stop(struct fproc * rfp)
 	 * this case in non-suspending calls as well as in sdev_finish().
 	 */
 	m.m_type = EIO;
-	sdev_finish(rfp, &m);
+	sdev_finish(rfp, &m, FALSE /*may_continue*/);
 }
 
 /*
@@ -976,7 +1227,7 @@ sdev_cancel(void)
 	    m.m_lsockdriver_vfs_accept_reply.sock_id >= 0)
 		sdev_finish_accept(fp, &m);
 	else
-		sdev_finish(fp, &m);
+		sdev_finish(fp, &m, FALSE /*may_continue*/);
 }
 
 /*
@@ -1106,9 +1357,23 @@ sdev_reply(void)
 		 * entirely unchecked.  --dcvmoole
 		 */
 		rfp->fp_blocked_on = FP_BLOCKED_ON_NONE;
+	} else if (rfp->fp_sdev.callnr == VFS_SENDFILE) {
+		/*
+		 * Replies to sendfile chunks also require a worker thread,
+		 * because after accounting the chunk's result, the next chunk
+		 * of file data may have to be read from the file system, which
+		 * is a blocking operation.  The same caveats as for the accept
+		 * case above apply here: the reply may instead be picked up by
+		 * sdev_cancel(), and a second reply arriving in the worker
+		 * thread activation gap is discarded because we unsuspend the
+		 * process now.
+		 */
+		worker_start(rfp, do_sendfile_reply, &m_in, FALSE /*use_spare*/);
+
+		rfp->fp_blocked_on = FP_BLOCKED_ON_NONE;
 	} else {
 		rfp->fp_blocked_on = FP_BLOCKED_ON_NONE;
 
-		sdev_finish(rfp, &m_in);
+		sdev_finish(rfp, &m_in, TRUE /*may_continue*/);
 	}
 }
@@ -52,6 +52,22 @@ static struct selectentry {
   minix_timer_t timer;	/* if expiry > 0 */
 } selecttab[MAXSELECTS];
 
+/* max. number of concurrently pending select queries to socket drivers */
+#define SDEV_QUERIES 64
+
+/* Table of pending SDEV_SELECT queries. Unlike character drivers, socket
+ * drivers identify the object of a select reply by its socket device number,
+ * which allows us to keep many queries outstanding at once, rather than just
+ * one per driver. At most one query may be pending per socket device at any
+ * time; subsequent queries for the same socket are deferred until the reply to
+ * the pending query has come in.
+ */
+static struct sdev_query {
+  struct smap *sq_smap;		/* socket driver, or NULL if slot is free */
+  dev_t sq_dev;			/* socket device being queried */
+  struct filp *sq_filp;		/* filp being selected on, may be NULL */
+} sdev_queries[SDEV_QUERIES];
+
 static int copy_fdsets(struct selectentry *se, int nfds, int direction);
 static void filp_status(struct filp *fp, int status);
 static int is_deferred(struct selectentry *se);
@@ -72,6 +88,7 @@ static int select_request_pipe(struct filp *f, int *ops, int block,
 	struct fproc *rfp);
 static void select_cancel_all(struct selectentry *e);
 static void select_cancel_filp(struct filp *f);
+static struct sdev_query *sdev_query_find(struct smap *sp, dev_t dev);
 static void select_return(struct selectentry *);
 static void select_restart_filps(void);
 static int tab2ops(int fd, struct selectentry *e);
@@ -533,6 +550,7 @@ static int select_request_sock(struct filp *f, int *ops, int block,
  * thread. The given filp may or may not be locked.
  */
   struct smap *sp;
+  struct sdev_query *sq;
   dev_t dev;
   int r, rops;
 
@@ -546,7 +564,16 @@ static int select_request_sock(struct filp *f, int *ops, int block,
   if ((rops = select_filter(f, ops, block)) <= 0)
 	return(rops); /* OK or suspend: nothing to do for now */
 
-  if (sp->smap_sel_busy)
+  /* If a (possibly stale) query is still pending for this socket, defer the
+   * new query until the reply to the pending one has come in.
+   */
+  if (sdev_query_find(sp, dev) != NULL)
+	return(SUSPEND);
+
+  /* Claim a free query slot. If there is none, try again later as well. */
+  for (sq = sdev_queries; sq < &sdev_queries[SDEV_QUERIES]; sq++)
+	if (sq->sq_smap == NULL) break;
+  if (sq == &sdev_queries[SDEV_QUERIES])
 	return(SUSPEND);
 
   f->filp_select_flags &= ~FSF_UPDATE;
@@ -554,13 +581,31 @@ static int select_request_sock(struct filp *f, int *ops, int block,
   if (r != OK)
 	return(r);
 
-  sp->smap_sel_busy = TRUE;
-  sp->smap_sel_filp = f;
+  sq->sq_smap = sp;
+  sq->sq_dev = dev;
+  sq->sq_filp = f;
   f->filp_select_flags |= FSF_BUSY;
 
   return(SUSPEND);
 }
 
+/*===========================================================================*
+ *				sdev_query_find				     *
+ *===========================================================================*/
+static struct sdev_query *sdev_query_find(struct smap *sp, dev_t dev)
+{
+/* Find the pending select query for the given socket device, if any. This
+ * function MUST NOT block its calling thread.
+ */
+  struct sdev_query *sq;
+
+  for (sq = sdev_queries; sq < &sdev_queries[SDEV_QUERIES]; sq++)
+	if (sq->sq_smap == sp && sq->sq_dev == dev)
+		return(sq);
+
+  return(NULL);
+}
+
 /*===========================================================================*
  *				select_request_file			     *
  *===========================================================================*/
@@ -744,6 +789,7 @@ static void select_cancel_filp(struct filp *f)
  */
   devmajor_t major;
   struct smap *sp;
+  struct sdev_query *sq;
 
   assert(f);
   assert(f->filp_selectors > 0);
@@ -770,8 +816,9 @@ static void select_cancel_filp(struct filp *f)
 		f->filp_select_dev = NO_DEV;
 	} else if (is_sock_device(f) && f->filp_select_dev != NO_DEV) {
 		if ((sp = get_smap_by_dev(f->filp_select_dev, NULL)) != NULL &&
-		    sp->smap_sel_busy && sp->smap_sel_filp == f)
-			sp->smap_sel_filp = NULL;	/* leave _busy set */
+		    (sq = sdev_query_find(sp, f->filp_select_dev)) != NULL &&
+		    sq->sq_filp == f)
+			sq->sq_filp = NULL;	/* leave the slot in use */
 		f->filp_select_dev = NO_DEV;
 	}
   }
@@ -886,6 +933,7 @@ void select_unsuspend_by_endpt(endpoint_t proc_e)
 /* Revive blocked processes when a driver has disappeared */
   struct dmap *dp;
   struct smap *sp;
+  struct sdev_query *sq;
   devmajor_t major;
   int fd, s, is_driver, restart;
   struct selectentry *se;
@@ -945,8 +993,11 @@ void select_unsuspend_by_endpt(endpoint_t proc_e)
 	dp->dmap_sel_busy = FALSE;
   }
   if (sp != NULL) {
-	assert(sp->smap_sel_filp == NULL);
-	sp->smap_sel_busy = FALSE;
+	for (sq = sdev_queries; sq < &sdev_queries[SDEV_QUERIES]; sq++) {
+		if (sq->sq_smap != sp) continue;
+		assert(sq->sq_filp == NULL);
+		sq->sq_smap = NULL;
+	}
   }
 }
 
@@ -1063,13 +1114,14 @@ void select_sdev_reply1(dev_t dev, int status)
  * block its calling thread.
  */
   struct smap *sp;
+  struct sdev_query *sq;
   struct filp *f;
 
   if ((sp = get_smap_by_dev(dev, NULL)) == NULL)
 	return;
 
-  /* Get the file pointer for the socket device. */
-  if (!sp->smap_sel_busy) {
+  /* Find the query to which this is the reply. */
+  if ((sq = sdev_query_find(sp, dev)) == NULL) {
 	printf("VFS: was not expecting a SDEV_SELECT reply from %d\n",
 	    sp->smap_endpt);
 	return;
@@ -1079,23 +1131,15 @@ void select_sdev_reply1(dev_t dev, int status)
    * unpaused in the meantime. In that case, we ignore the result, but we do
    * look for other filps to restart later.
    */
-  if ((f = sp->smap_sel_filp) != NULL) {
+  if ((f = sq->sq_filp) != NULL) {
 	/* Find vnode and check we got a reply from the device we expected */
 	assert(is_sock_device(f));
-	assert(f->filp_select_dev != NO_DEV);
-	if (f->filp_select_dev != dev) {
-		/* This should never happen. The driver may be misbehaving.
-		 * For now we assume that the reply we want will arrive later..
-		 */
-		printf("VFS: expected reply from sock dev %llx, not %llx\n",
-		    f->filp_select_dev, dev);
-		return;
-	}
+	assert(f->filp_select_dev == dev);
   }
 
-  /* We are no longer waiting for a reply from this socket driver. */
-  sp->smap_sel_busy = FALSE;
-  sp->smap_sel_filp = NULL;
+  /* The query has been answered, so free up its slot. */
+  sq->sq_smap = NULL;
+  sq->sq_filp = NULL;
 
   /* Process the status change, if still applicable. */
   if (f != NULL)
@@ -1360,6 +1404,7 @@ select_dump(void)
 	struct filp *f;
 	struct dmap *dp;
 	struct smap *sp;
+	struct sdev_query *sq;
 	dev_t dev;
 	sockid_t sockid;
 	int s, fd;
@@ -1402,10 +1447,11 @@ select_dump(void)
 				printf("sock (dev ");
 				sp = get_smap_by_dev(dev, &sockid);
 				if (sp != NULL) {
-					printf("<%d,%d>, smap busy %d filp "
+					sq = sdev_query_find(sp, dev);
+					printf("<%d,%d>, query %d filp "
 					    "%p)\n", sp->smap_num, sockid,
-					    sp->smap_sel_busy,
-					    sp->smap_sel_filp);
+					    sq != NULL,
+					    sq != NULL ? sq->sq_filp : NULL);
 				} else
 					printf("<0x%"PRIx64">, smap "
 					    "unknown)\n", dev);
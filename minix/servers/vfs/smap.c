@@ -131,8 +131,6 @@ smap_map(const char * label, endpoint_t endpt, const int * domains,
 	sp = &smap[num];
 	sp->smap_endpt = endpt;
 	strlcpy(sp->smap_label, label, sizeof(sp->smap_label));
-	sp->smap_sel_busy = FALSE;
-	sp->smap_sel_filp = NULL;
 
 	for (i = 0; i < ndomains; i++)
 		pfmap[domains[i]] = sp;
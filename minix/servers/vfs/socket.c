@@ -20,10 +20,13 @@
  * VFS_CONNECT		sockaddr
  * VFS_LISTEN		listen
  * VFS_ACCEPT		sockaddr		socklen
+ * VFS_ACCEPT4		sockaddr		socklen
  * VFS_SENDTO		sendrecv
  * VFS_RECVFROM		sendrecv		socklen
  * VFS_SENDMSG		sockmsg
  * VFS_RECVMSG		sockmsg
+ * VFS_SENDMMSG		sockmmsg
+ * VFS_RECVMMSG		sockmmsg
  * VFS_SETSOCKOPT	sockopt
  * VFS_GETSOCKOPT	sockopt			socklen
  * VFS_GETSOCKNAME	sockaddr		socklen
@@ -138,14 +141,14 @@ make_sock_fd(dev_t dev, int flags)
 	if ((r = req_newnode(PFS_PROC_NR, fp->fp_effuid, fp->fp_effgid,
 	    S_IFSOCK | ACCESSPERMS, dev, &res)) != OK) {
 		unlock_filp(filp);
+		release_filp(filp);
 		unlock_vnode(vp);
 		unlock_vmnt(vmp);
 		return r;
 	}
 
 	/* Fill in the objects, and link them together. */
-	vp->v_fs_e = res.fs_e;
-	vp->v_inode_nr = res.inode_nr;
+	enter_vnode(vp, res.fs_e, res.inode_nr);
 	vp->v_mode = res.fmode;
 	vp->v_sdev = dev;
 	vp->v_fs_count = 1;
@@ -159,6 +162,7 @@ make_sock_fd(dev_t dev, int flags)
 	filp->filp_count = 1;
 
 	fp->fp_filp[fd] = filp;
+	SET_BIT(fp->fp_filp_map, fd);
 	if (flags & O_CLOEXEC)
 		FD_SET(fd, &fp->fp_cloexec_set);
 
@@ -359,16 +363,29 @@ do_listen(void)
 }
 
 /*
- * Accept a connection on a listening socket, creating a new socket.
+ * Accept a connection on a listening socket, creating a new socket.  This
+ * function implements both accept(2) and, with an extra flags argument for
+ * the new socket's file descriptor, accept4(2).
  */
 int
 do_accept(void)
 {
 	dev_t dev;
-	int r, fd, flags;
+	int r, fd, sock_flags, flags, fd_flags;
 
 	fd = job_m_in.m_lc_vfs_sockaddr.fd;
 
+	if (job_call_nr == VFS_ACCEPT4) {
+		sock_flags = job_m_in.m_lc_vfs_sockaddr.flags;
+
+		if (sock_flags &
+		    ~(SOCK_CLOEXEC | SOCK_NONBLOCK | SOCK_NOSIGPIPE))
+			return EINVAL;
+
+		fd_flags = get_sock_flags(sock_flags);
+	} else
+		fd_flags = 0;
+
 	if ((r = get_sock(fd, &dev, &flags)) != OK)
 		return r;
 
@@ -376,7 +393,7 @@ do_accept(void)
 		return r;
 
 	return sdev_accept(dev, job_m_in.m_lc_vfs_sockaddr.addr,
-	    job_m_in.m_lc_vfs_sockaddr.addr_len, flags, fd);
+	    job_m_in.m_lc_vfs_sockaddr.addr_len, flags, fd, fd_flags);
 }
 
 /*
@@ -455,7 +472,12 @@ resume_accept(struct fproc * rfp, int status, dev_t dev, unsigned int addr_len,
 	 * to close the new socket after all.  That is not great, but we have
 	 * no way to prevent this except by preallocating all objects for the
 	 * duration of the accept call, which is not exactly great either.
+	 *
+	 * For accept4(2), the new descriptor's flags are given by the caller
+	 * rather than inherited from the listening socket.
 	 */
+	if (rfp->fp_sdev.callnr == VFS_ACCEPT4)
+		flags = rfp->fp_sdev.aux.acc.flags;
 	flags &= O_CLOEXEC | O_NONBLOCK | O_NOSIGPIPE;
 
 	if ((r = make_sock_fd(dev, flags)) < 0) {
@@ -594,6 +616,185 @@ do_sockmsg(void)
 	    (job_call_nr == VFS_RECVMSG) ? msg_buf : 0);
 }
 
+/*
+ * Put the next element of an ongoing sendmmsg(2) or recvmmsg(2) call in
+ * flight: copy in the corresponding mmsghdr structure from the caller, and
+ * issue the socket driver request for it, suspending the calling process.
+ * The batch state is kept in the process's fp_sdev.aux.mmsg structure.  This
+ * function is called both from the worker thread performing the original
+ * system call and, through resume_sockmmsg(), from the main thread; it
+ * therefore operates on the given process and MUST NOT block.  Return SUSPEND
+ * if the element's request was put in flight, or a negative error code on
+ * failure.
+ */
+static int
+sockmmsg_element(struct fproc * rfp)
+{
+	struct mmsghdr mmsg;
+	struct iovec iov;
+	vir_bytes data_buf;
+	size_t data_len;
+	unsigned int i;
+	int r, call_flags, dgram_flags, rw_flag;
+
+	rw_flag = (rfp->fp_sdev.callnr == VFS_RECVMMSG) ? READING : WRITING;
+	i = rfp->fp_sdev.aux.mmsg.next;
+	call_flags = rfp->fp_sdev.aux.mmsg.flags;
+
+	if ((r = sys_datacopy_wrapper(rfp->fp_endpoint,
+	    rfp->fp_sdev.aux.mmsg.base + i * sizeof(mmsg), SELF,
+	    (vir_bytes)&mmsg, sizeof(mmsg))) != OK)
+		return r;
+
+	data_buf = 0;
+	data_len = 0;
+	if (mmsg.msg_hdr.msg_iovlen > 0) {
+		/* As in do_sockmsg(): no multi-element vectors. */
+		if (mmsg.msg_hdr.msg_iovlen > 1)
+			return EMSGSIZE;
+
+		if ((r = sys_datacopy_wrapper(rfp->fp_endpoint,
+		    (vir_bytes)mmsg.msg_hdr.msg_iov, SELF, (vir_bytes)&iov,
+		    sizeof(iov))) != OK)
+			return r;
+
+		if (iov.iov_len > SSIZE_MAX)
+			return EINVAL;
+
+		if (iov.iov_len > 0) {
+			data_buf = (vir_bytes)iov.iov_base;
+			data_len = iov.iov_len;
+		}
+	}
+
+	/*
+	 * With MSG_WAITFORONE, wait for the first message only; all further
+	 * receives are nonblocking.  The flag itself is not passed on to the
+	 * socket driver.
+	 */
+	dgram_flags = call_flags & ~MSG_WAITFORONE;
+	if (rw_flag == READING && (call_flags & MSG_WAITFORONE) && i > 0)
+		dgram_flags |= MSG_DONTWAIT;
+
+	return sdev_mmsg(rfp, rfp->fp_sdev.dev, data_buf, data_len,
+	    (vir_bytes)mmsg.msg_hdr.msg_control, mmsg.msg_hdr.msg_controllen,
+	    (vir_bytes)mmsg.msg_hdr.msg_name, mmsg.msg_hdr.msg_namelen,
+	    dgram_flags, rw_flag, rfp->fp_sdev.aux.mmsg.filp_flags);
+}
+
+/*
+ * Send or receive a batch of messages on a socket, for sendmmsg(2) and
+ * recvmmsg(2).  Each message is still passed to the socket driver
+ * individually, since the socket driver protocol is strictly per-message, but
+ * the system call overhead between the user process and VFS is paid only once
+ * for the entire vector.  Every element follows the normal suspended-call
+ * path: the calling process is suspended while an element's request is in
+ * flight, and the driver's reply triggers resume_sockmmsg(), which puts the
+ * next element in flight or finishes the call.
+ */
+int
+do_sockmmsg(void)
+{
+	unsigned int vlen;
+	dev_t dev;
+	int r, fd, flags;
+
+	assert(job_call_nr == VFS_SENDMMSG || job_call_nr == VFS_RECVMMSG);
+
+	fd = job_m_in.m_lc_vfs_sockmmsg.fd;
+	vlen = job_m_in.m_lc_vfs_sockmmsg.vlen;
+
+	if ((r = get_sock(fd, &dev, &flags)) != OK)
+		return r;
+
+	if (vlen == 0)
+		return 0;
+
+	/* Initialize the batch state, and put the first element in flight. */
+	fp->fp_sdev.dev = dev;
+	fp->fp_sdev.callnr = job_call_nr;
+	fp->fp_sdev.aux.mmsg.base = job_m_in.m_lc_vfs_sockmmsg.mmsgbuf;
+	fp->fp_sdev.aux.mmsg.vlen = vlen;
+	fp->fp_sdev.aux.mmsg.next = 0;
+	fp->fp_sdev.aux.mmsg.flags = job_m_in.m_lc_vfs_sockmmsg.flags;
+	fp->fp_sdev.aux.mmsg.filp_flags = flags;
+
+	return sockmmsg_element(fp);
+}
+
+/*
+ * Resume a previously suspended sendmmsg(2) or recvmmsg(2) system call, after
+ * the reply for the element in flight has come in.  The 'status' parameter
+ * contains either the number of data bytes transferred for that element or a
+ * negative error code.  For receive requests, the resulting control and
+ * address lengths and flags are given as well.  Copy out the element's
+ * updated mmsghdr structure, and then either put the next element of the
+ * batch in flight, suspending the process again, or finish the call.  If
+ * 'may_continue' is not set, the call was canceled or the socket driver died,
+ * and the call must be finished with the progress made so far.  This function
+ * may be called from the main thread and therefore MUST NOT block.
+ */
+void
+resume_sockmmsg(struct fproc * rfp, int status, unsigned int ctl_len,
+	unsigned int addr_len, int flags, int may_continue)
+{
+	struct mmsghdr mmsg;
+	vir_bytes mmsg_buf;
+	int r;
+
+	if (status >= 0) {
+		mmsg_buf = rfp->fp_sdev.aux.mmsg.base +
+		    rfp->fp_sdev.aux.mmsg.next * sizeof(mmsg);
+
+		/*
+		 * Update and copy out the message header.  As in
+		 * resume_recvmsg(), we copy in the header again in order to
+		 * update only a subset of its fields.
+		 */
+		if ((r = sys_datacopy_wrapper(rfp->fp_endpoint, mmsg_buf,
+		    SELF, (vir_bytes)&mmsg, sizeof(mmsg))) != OK) {
+			/* We copied it in before, how could it fail now? */
+			printf("VFS: resume_sockmmsg cannot copy in mmsghdr? "
+			    "(%d)\n", r);
+			status = r;
+		} else {
+			mmsg.msg_len = status;
+			if (rfp->fp_sdev.callnr == VFS_RECVMMSG) {
+				mmsg.msg_hdr.msg_controllen = ctl_len;
+				mmsg.msg_hdr.msg_flags = flags;
+				if (addr_len > 0)
+					mmsg.msg_hdr.msg_namelen = addr_len;
+			}
+
+			if ((r = sys_datacopy_wrapper(SELF, (vir_bytes)&mmsg,
+			    rfp->fp_endpoint, mmsg_buf, sizeof(mmsg))) != OK)
+				status = r;
+		}
+	}
+
+	if (status >= 0) {
+		rfp->fp_sdev.aux.mmsg.next++;
+
+		if (rfp->fp_sdev.aux.mmsg.next < rfp->fp_sdev.aux.mmsg.vlen &&
+		    may_continue) {
+			r = sockmmsg_element(rfp);
+			if (r == SUSPEND)
+				return;	/* the next element is in flight */
+			status = r;	/* failed to put element in flight */
+		}
+	}
+
+	/*
+	 * If any messages were transferred, return how many; an error on a
+	 * later message will show up again on the caller's next call.
+	 * Otherwise, return the error code.
+	 */
+	if (rfp->fp_sdev.aux.mmsg.next > 0)
+		replycode(rfp->fp_endpoint, rfp->fp_sdev.aux.mmsg.next);
+	else
+		replycode(rfp->fp_endpoint, (status < 0) ? status : 0);
+}
+
 /*
  * Resume a previously suspended recvmsg(2) system call.  The 'status'
  * parameter contains either the number of data bytes received or a negative
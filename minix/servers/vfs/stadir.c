@@ -14,6 +14,7 @@
 
 #include "fs.h"
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <minix/com.h>
 #include <minix/u64.h>
 #include <string.h>
@@ -134,13 +135,48 @@ static int change_into(struct vnode **result, struct vnode *vp)
   return(OK);
 }
 
+/*===========================================================================*
+ *				cached_stat				     *
+ *===========================================================================*/
+static int cached_stat(struct vnode *vp, vir_bytes statbuf)
+{
+/* Copy the attributes of 'vp' to the caller's buffer, going through the
+ * per-vnode attribute cache. All attribute changes made through VFS
+ * invalidate the cached copy right away; on top of that, a cached copy older
+ * than STATCACHE_TTL ticks is refetched, which bounds the staleness of
+ * changes that do not pass through VFS (for example, mapped file access).
+ * Stat-heavy workloads such as build systems ask for the same attributes over
+ * and over, and this cache turns most of those requests from a full FS
+ * round trip into a local copy.
+ */
+  clock_t now;
+  int r;
+
+  now = getticks();
+
+  if (vp->v_stat_ticks == 0 ||
+      (clock_t) (now - vp->v_stat_ticks) >= STATCACHE_TTL) {
+	r = req_stat(vp->v_fs_e, vp->v_inode_nr, VFS_PROC_NR,
+	    (vir_bytes) &vp->v_stat);
+	if (r != OK)
+		return(r);
+	/* Zero is reserved to mean "invalid". */
+	vp->v_stat_ticks = (now != 0) ? now : 1;
+  }
+
+  return sys_datacopy_wrapper(SELF, (vir_bytes) &vp->v_stat, who_e, statbuf,
+	sizeof(vp->v_stat));
+}
+
 /*===========================================================================*
  *				do_stat					     *
  *===========================================================================*/
 int do_stat(void)
 {
-/* Perform the stat(name, buf) system call. */
-  int r;
+/* Perform the stat(name, buf) and fstatat(dirfd, name, buf, flags) system
+ * calls.
+ */
+  int r, lookup_flags;
   struct vnode *vp;
   struct vmnt *vmp;
   char fullpath[PATH_MAX];
@@ -148,17 +184,33 @@ int do_stat(void)
   vir_bytes vname1, statbuf;
   size_t vname1_length;
 
-  vname1 = job_m_in.m_lc_vfs_stat.name;
-  vname1_length = job_m_in.m_lc_vfs_stat.len;
-  statbuf = job_m_in.m_lc_vfs_stat.buf;
+  lookup_flags = PATH_NOFLAGS;
 
-  lookup_init(&resolve, fullpath, PATH_NOFLAGS, &vmp, &vp);
+  if (job_call_nr == VFS_STATAT) {
+	vname1 = job_m_in.m_lc_vfs_at.name;
+	vname1_length = job_m_in.m_lc_vfs_at.len;
+	statbuf = job_m_in.m_lc_vfs_at.buf;
+
+	if (job_m_in.m_lc_vfs_at.flags & ~AT_SYMLINK_NOFOLLOW)
+		return(EINVAL);
+	if (job_m_in.m_lc_vfs_at.flags & AT_SYMLINK_NOFOLLOW)
+		lookup_flags = PATH_RET_SYMLINK;	/* lstat(2) style */
+
+	if ((r = set_atdir(job_m_in.m_lc_vfs_at.dirfd)) != OK)
+		return(r);
+  } else {
+	vname1 = job_m_in.m_lc_vfs_stat.name;
+	vname1_length = job_m_in.m_lc_vfs_stat.len;
+	statbuf = job_m_in.m_lc_vfs_stat.buf;
+  }
+
+  lookup_init(&resolve, fullpath, lookup_flags, &vmp, &vp);
   resolve.l_vmnt_lock = VMNT_READ;
   resolve.l_vnode_lock = VNODE_READ;
 
   if (fetch_name(vname1, vname1_length, fullpath) != OK) return(err_code);
   if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
-  r = req_stat(vp->v_fs_e, vp->v_inode_nr, who_e, statbuf);
+  r = cached_stat(vp, statbuf);
 
   unlock_vnode(vp);
   unlock_vmnt(vmp);
@@ -183,8 +235,7 @@ int do_fstat(void)
   /* Is the file descriptor valid? */
   if ((rfilp = get_filp(rfd, VNODE_READ)) == NULL) return(err_code);
 
-  r = req_stat(rfilp->filp_vno->v_fs_e, rfilp->filp_vno->v_inode_nr,
-	       who_e, statbuf);
+  r = cached_stat(rfilp->filp_vno, statbuf);
 
   unlock_filp(rfilp);
 
@@ -436,7 +487,7 @@ int do_lstat(void)
 
   if (fetch_name(vname1, vname1_length, fullpath) != OK) return(err_code);
   if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
-  r = req_stat(vp->v_fs_e, vp->v_inode_nr, who_e, statbuf);
+  r = cached_stat(vp, statbuf);
 
   unlock_vnode(vp);
   unlock_vmnt(vmp);
@@ -79,4 +79,22 @@ int (* const call_vec[NR_VFS_CALLS])(void) = {
 	CALL(VFS_GETSOCKNAME)	= do_getsockname,	/* getsockname(2) */
 	CALL(VFS_GETPEERNAME)	= do_getpeername,	/* getpeername(2) */
 	CALL(VFS_SHUTDOWN)	= do_shutdown,		/* shutdown(2) */
+	CALL(VFS_SENDFILE)	= do_sendfile,		/* sendfile(2) */
+	CALL(VFS_SENDMMSG)	= do_sockmmsg,		/* sendmmsg(2) */
+	CALL(VFS_RECVMMSG)	= do_sockmmsg,		/* recvmmsg(2) */
+	CALL(VFS_OPENAT)	= do_open,		/* openat(2) */
+	CALL(VFS_MKDIRAT)	= do_mkdir,		/* mkdirat(2) */
+	CALL(VFS_MKNODAT)	= do_mknod,		/* mknodat(2) */
+	CALL(VFS_UNLINKAT)	= do_unlink,		/* unlinkat(2) */
+	CALL(VFS_LINKAT)	= do_link,		/* linkat(2) */
+	CALL(VFS_RENAMEAT)	= do_rename,		/* renameat(2) */
+	CALL(VFS_SYMLINKAT)	= do_slink,		/* symlinkat(2) */
+	CALL(VFS_READLINKAT)	= do_rdlink,		/* readlinkat(2) */
+	CALL(VFS_STATAT)	= do_stat,		/* fstatat(2) */
+	CALL(VFS_ACCESSAT)	= do_access,		/* faccessat(2) */
+	CALL(VFS_CHMODAT)	= do_chmod,		/* fchmodat(2) */
+	CALL(VFS_CHOWNAT)	= do_chown,		/* fchownat(2) */
+	CALL(VFS_UTIMENSAT)	= do_utimens,		/* utimensat(2) */
+	CALL(VFS_ACCEPT4)	= do_accept,		/* accept4(2) */
+	CALL(VFS_FADVISE)	= do_fadvise,		/* posix_fadvise(2) */
 };
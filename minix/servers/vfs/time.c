@@ -26,17 +26,10 @@
 int do_utimens(void)
 {
 /* Perform the utimens(name, times, flag) system call, and its friends.
- * Implement a very large but not complete subset of the utimensat()
- * Posix:2008/XOpen-7 function.
- * Are handled all the following cases:
- * . utimensat(AT_FDCWD, "/some/absolute/path", , )
- * . utimensat(AT_FDCWD, "some/path", , )
- * . utimens("anything", ) really special case of the above two
- * . lutimens("anything", ) also really special case of the above
- * . utimensat(fd, "/some/absolute/path", , ) although fd is useless here
- * . futimens(fd, )
- * Are not handled the following cases:
- * . utimensat(fd, "some/path", , ) path to a file relative to some open fd
+ * Implement the utimensat() Posix:2008/XOpen-7 function.
+ * The UTIMENSAT call number covers the case of a path relative to an open
+ * directory file descriptor; the older UTIMENS call number cannot carry one,
+ * as old callers do not initialize the fd field for named files.
  */
   int r, kind, lookup_flags;
   struct vnode *vp;
@@ -70,6 +63,10 @@ int do_utimens(void)
 	lookup_init(&resolve, fullpath, lookup_flags, &vmp, &vp);
 	resolve.l_vmnt_lock = VMNT_READ;
 	resolve.l_vnode_lock = VNODE_READ;
+	/* Only utimensat(2) passes in a meaningful directory descriptor. */
+	if (job_call_nr == VFS_UTIMENSAT &&
+	    (r = set_atdir(job_m_in.m_vfs_utimens.fd)) != OK)
+		return(r);
 	/* Temporarily open the file */
 	if (fetch_name(vname, vname_length, fullpath) != OK) return(err_code);
 	if ((vp = eat_path(&resolve, fp)) == NULL) return(err_code);
@@ -141,6 +138,7 @@ int do_utimens(void)
   if (r == OK)
 	/* Issue request */
 	r = req_utime(vp->v_fs_e, vp->v_inode_nr, &newactim, &newmodtim);
+  if (r == OK) vp->v_stat_ticks = 0;	/* times changed */
 
   if (kind == UTIMENS_STYLE) {
 	/* Close the temporary */
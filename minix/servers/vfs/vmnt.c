@@ -4,11 +4,25 @@
 
 #include "fs.h"
 #include "vmnt.h"
+#include "vnode.h"
 #include <assert.h>
 #include <string.h>
 
 static int is_vmnt_locked(struct vmnt *vmp);
 static void clear_vmnt(struct vmnt *vmp);
+static void hash_vmnt(struct vmnt *vmp);
+static void unhash_vmnt(struct vmnt *vmp);
+
+/* In-use vmnts are kept on hash chains, keyed both by FS endpoint and by
+ * device number, so that find_vmnt() and find_vmnt_by_dev() need not scan
+ * the whole table on every FS request and mount crossing.
+ */
+#define VMNTHASH	16	/* size of the hash tables; power of two */
+#define VMNT_FS_HASH(e)		(((unsigned int) (e)) & (VMNTHASH - 1))
+#define VMNT_DEV_HASH(d)	(((unsigned int) (d)) & (VMNTHASH - 1))
+
+static struct vmnt *vmnt_fs_hash[VMNTHASH];
+static struct vmnt *vmnt_dev_hash[VMNTHASH];
 
 /* Is vmp pointer reasonable? */
 #define SANEVMP(v) ((((v) >= &vmnt[0] && (v) < &vmnt[NR_MNTS])))
@@ -59,6 +73,64 @@ check_vmnt_locks(void)
 #endif
 }
 
+/*===========================================================================*
+ *                             hash_vmnt				     *
+ *===========================================================================*/
+static void hash_vmnt(struct vmnt *vmp)
+{
+/* Add an in-use vmnt to the endpoint and device hash chains */
+  unsigned int h;
+
+  h = VMNT_FS_HASH(vmp->m_fs_e);
+  vmp->m_fs_hash_next = vmnt_fs_hash[h];
+  vmnt_fs_hash[h] = vmp;
+
+  h = VMNT_DEV_HASH(vmp->m_dev);
+  vmp->m_dev_hash_next = vmnt_dev_hash[h];
+  vmnt_dev_hash[h] = vmp;
+}
+
+/*===========================================================================*
+ *                             unhash_vmnt				     *
+ *===========================================================================*/
+static void unhash_vmnt(struct vmnt *vmp)
+{
+/* Remove a vmnt from the endpoint and device hash chains */
+  struct vmnt **vpp;
+
+  for (vpp = &vmnt_fs_hash[VMNT_FS_HASH(vmp->m_fs_e)]; *vpp != NULL;
+       vpp = &(*vpp)->m_fs_hash_next) {
+	if (*vpp == vmp) {
+		*vpp = vmp->m_fs_hash_next;
+		break;
+	}
+  }
+  vmp->m_fs_hash_next = NULL;
+
+  for (vpp = &vmnt_dev_hash[VMNT_DEV_HASH(vmp->m_dev)]; *vpp != NULL;
+       vpp = &(*vpp)->m_dev_hash_next) {
+	if (*vpp == vmp) {
+		*vpp = vmp->m_dev_hash_next;
+		break;
+	}
+  }
+  vmp->m_dev_hash_next = NULL;
+}
+
+/*===========================================================================*
+ *                             enter_vmnt				     *
+ *===========================================================================*/
+void enter_vmnt(struct vmnt *vmp, endpoint_t fs_e, dev_t dev)
+{
+/* Assign an FS endpoint and device to a free vmnt, making it findable */
+  ASSERTVMP(vmp);
+  assert(vmp->m_dev == NO_DEV);
+
+  vmp->m_fs_e = fs_e;
+  vmp->m_dev = dev;
+  hash_vmnt(vmp);
+}
+
 /*===========================================================================*
  *                             mark_vmnt_free				     *
  *===========================================================================*/
@@ -66,6 +138,8 @@ void mark_vmnt_free(struct vmnt *vmp)
 {
   ASSERTVMP(vmp);
 
+  if (vmp->m_dev != NO_DEV) unhash_vmnt(vmp);
+
   vmp->m_fs_e = NONE;
   vmp->m_dev = NO_DEV;
 }
@@ -111,11 +185,29 @@ struct vmnt *get_free_vmnt(void)
  *===========================================================================*/
 struct vmnt *find_vmnt(endpoint_t fs_e)
 {
-/* Find the vmnt belonging to an FS with endpoint 'fs_e' iff it's in use */
+/* Find the vmnt belonging to an FS with endpoint 'fs_e' iff it's in use.
+ * Only in-use vmnts are on the hash chains. */
   struct vmnt *vp;
 
-  for (vp = &vmnt[0]; vp < &vmnt[NR_MNTS]; ++vp)
-	if (vp->m_fs_e == fs_e && vp->m_dev != NO_DEV)
+  for (vp = vmnt_fs_hash[VMNT_FS_HASH(fs_e)]; vp != NULL;
+       vp = vp->m_fs_hash_next)
+	if (vp->m_fs_e == fs_e)
+		return(vp);
+
+  return(NULL);
+}
+
+/*===========================================================================*
+ *                             find_vmnt_by_dev				     *
+ *===========================================================================*/
+struct vmnt *find_vmnt_by_dev(dev_t dev)
+{
+/* Find the vmnt of the FS mounted from device 'dev' iff it's in use */
+  struct vmnt *vp;
+
+  for (vp = vmnt_dev_hash[VMNT_DEV_HASH(dev)]; vp != NULL;
+       vp = vp->m_dev_hash_next)
+	if (vp->m_dev == dev)
 		return(vp);
 
   return(NULL);
@@ -128,9 +220,15 @@ void init_vmnts(void)
 {
 /* Initialize vmnt table */
   struct vmnt *vmp;
+  unsigned int h;
+
+  for (h = 0; h < VMNTHASH; h++)
+	vmnt_fs_hash[h] = vmnt_dev_hash[h] = NULL;
 
   for (vmp = &vmnt[0]; vmp < &vmnt[NR_MNTS]; vmp++) {
 	clear_vmnt(vmp);
+	vmp->m_fs_hash_next = NULL;
+	vmp->m_dev_hash_next = NULL;
 	tll_init(&vmp->m_lock);
   }
 }
@@ -188,6 +286,7 @@ void vmnt_unmap_by_endpt(endpoint_t proc_e)
 	if (vmp->m_mounted_on) {
 		/* Only put mount point when it was actually used as mount
 		 * point. That is, the mount was succesful. */
+		vmp->m_mounted_on->v_mountedhere = NULL;
 		put_vnode(vmp->m_mounted_on);
 	}
   }
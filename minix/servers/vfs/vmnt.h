@@ -18,6 +18,8 @@ EXTERN struct vmnt {
   char m_mount_dev[PATH_MAX];	/* device from which vmnt is mounted */
   char m_fstype[FSTYPE_MAX];	/* file system type */
   struct statvfs_cache m_stats;	/* cached file system statistics */
+  struct vmnt *m_fs_hash_next;	/* next vmnt on its endpoint hash chain */
+  struct vmnt *m_dev_hash_next;	/* next vmnt on its device hash chain */
 } vmnt[NR_MNTS];
 
 /* vmnt flags */
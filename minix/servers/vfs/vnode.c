@@ -4,6 +4,8 @@
  *  get_vnode - increase counter and get details of an inode
  *  get_free_vnode - get a pointer to a free vnode obj
  *  find_vnode - find a vnode according to the FS endpoint and the inode num.
+ *  enter_vnode - assign a new identity to a vnode
+ *  mark_vnode_free - return a vnode to the pool of free vnodes
  *  dup_vnode - duplicate vnode (i.e. increase counter)
  *  put_vnode - drop vnode (i.e. decrease counter)
  */
@@ -36,6 +38,100 @@
 	BADVP(v, __FILE__, __LINE__); panic("bad vp"); }
 #endif
 
+/* Hash table for (FS endpoint, inode number) to vnode lookups. Every vnode is
+ * always on the hash chain matching its current identity fields; enter_vnode()
+ * moves a vnode between chains when it is given a new identity. This keeps
+ * find_vnode() O(1) regardless of NR_VNODES.
+ */
+#define VNODEHASH(fs_e, ino) \
+	(((unsigned int)(fs_e) ^ (unsigned int)(ino)) % NR_VNODES)
+
+static struct vnode *vnode_hash[NR_VNODES];
+
+/* List of unused vnodes (v_ref_count == 0), so that get_free_vnode() does not
+ * have to scan the whole table either. A vnode leaves the list when it is
+ * given a new identity or revived (see dup_vnode()), and rejoins it when its
+ * reference count drops back to zero.
+ */
+static struct vnode *vnode_free_head, *vnode_free_tail;
+
+/*===========================================================================*
+ *				hash_vnode				     *
+ *===========================================================================*/
+static void hash_vnode(struct vnode *vp)
+{
+/* Add a vnode to the front of the hash chain for its current identity. */
+  struct vnode **head;
+
+  head = &vnode_hash[VNODEHASH(vp->v_fs_e, vp->v_inode_nr)];
+  vp->v_hash_prev = NULL;
+  vp->v_hash_next = *head;
+  if (*head != NULL) (*head)->v_hash_prev = vp;
+  *head = vp;
+}
+
+/*===========================================================================*
+ *				unhash_vnode				     *
+ *===========================================================================*/
+static void unhash_vnode(struct vnode *vp)
+{
+/* Remove a vnode from the hash chain for its current identity. */
+
+  if (vp->v_hash_prev != NULL)
+	vp->v_hash_prev->v_hash_next = vp->v_hash_next;
+  else
+	vnode_hash[VNODEHASH(vp->v_fs_e, vp->v_inode_nr)] = vp->v_hash_next;
+  if (vp->v_hash_next != NULL)
+	vp->v_hash_next->v_hash_prev = vp->v_hash_prev;
+}
+
+/*===========================================================================*
+ *				is_free_vnode				     *
+ *===========================================================================*/
+static int is_free_vnode(struct vnode *vp)
+{
+/* Return whether the vnode is currently on the free list. */
+
+  return(vp->v_free_prev != NULL || vnode_free_head == vp);
+}
+
+/*===========================================================================*
+ *				add_free_vnode				     *
+ *===========================================================================*/
+static void add_free_vnode(struct vnode *vp)
+{
+/* Append a vnode to the free list. */
+
+  assert(!is_free_vnode(vp));
+
+  vp->v_free_next = NULL;
+  vp->v_free_prev = vnode_free_tail;
+  if (vnode_free_tail != NULL)
+	vnode_free_tail->v_free_next = vp;
+  else
+	vnode_free_head = vp;
+  vnode_free_tail = vp;
+}
+
+/*===========================================================================*
+ *				rm_free_vnode				     *
+ *===========================================================================*/
+static void rm_free_vnode(struct vnode *vp)
+{
+/* Remove a vnode from the free list. */
+
+  if (vp->v_free_prev != NULL)
+	vp->v_free_prev->v_free_next = vp->v_free_next;
+  else
+	vnode_free_head = vp->v_free_next;
+  if (vp->v_free_next != NULL)
+	vp->v_free_next->v_free_prev = vp->v_free_prev;
+  else
+	vnode_free_tail = vp->v_free_prev;
+  vp->v_free_prev = NULL;
+  vp->v_free_next = NULL;
+}
+
 #if LOCK_DEBUG
 /*===========================================================================*
  *				check_vnode_locks_by_me			     *
@@ -87,14 +183,17 @@ get_free_vnode(void)
 /* Find a free vnode slot in the vnode table (it's not actually allocated) */
   struct vnode *vp;
 
-  for (vp = &vnode[0]; vp < &vnode[NR_VNODES]; ++vp) {
-	if (vp->v_ref_count == 0 && !is_vnode_locked(vp)) {
+  for (vp = vnode_free_head; vp != NULL; vp = vp->v_free_next) {
+	assert(vp->v_ref_count == 0);
+	if (!is_vnode_locked(vp)) {
 		vp->v_uid  = -1;
 		vp->v_gid  = -1;
 		vp->v_sdev = NO_DEV;
 		vp->v_mapfs_e = NONE;
 		vp->v_mapfs_count = 0;
 		vp->v_mapinode_nr = 0;
+		vp->v_mountedhere = NULL;
+		vp->v_stat_ticks = 0;
 		return(vp);
 	}
   }
@@ -113,13 +212,46 @@ struct vnode *find_vnode(int fs_e, ino_t ino)
  * vnode table */
   struct vnode *vp;
 
-  for (vp = &vnode[0]; vp < &vnode[NR_VNODES]; ++vp)
+  for (vp = vnode_hash[VNODEHASH(fs_e, ino)]; vp != NULL; vp = vp->v_hash_next)
 	if (vp->v_ref_count > 0 && vp->v_inode_nr == ino && vp->v_fs_e == fs_e)
 		return(vp);
 
   return(NULL);
 }
 
+/*===========================================================================*
+ *				enter_vnode				     *
+ *===========================================================================*/
+void enter_vnode(struct vnode *vp, int fs_e, ino_t ino)
+{
+/* Give a vnode a new (FS endpoint, inode number) identity, and move it to the
+ * matching hash chain so that find_vnode() can locate it. The caller is
+ * expected to set the reference counters right after. */
+  ASSERTVP(vp);
+  assert(vp->v_ref_count == 0);
+
+  unhash_vnode(vp);
+  vp->v_fs_e = fs_e;
+  vp->v_inode_nr = ino;
+  vp->v_stat_ticks = 0;	/* new identity, cached attributes are stale */
+  hash_vnode(vp);
+
+  if (is_free_vnode(vp)) rm_free_vnode(vp);
+}
+
+/*===========================================================================*
+ *				mark_vnode_free				     *
+ *===========================================================================*/
+void mark_vnode_free(struct vnode *vp)
+{
+/* Drop all references to a vnode at once, returning it to the pool of free
+ * vnodes. Used when force-unmounting a file system. */
+  ASSERTVP(vp);
+
+  vp->v_ref_count = 0;
+  if (!is_free_vnode(vp)) add_free_vnode(vp);
+}
+
 /*===========================================================================*
  *				is_vnode_locked				     *
  *===========================================================================*/
@@ -138,6 +270,10 @@ int is_vnode_locked(struct vnode *vp)
 void init_vnodes(void)
 {
   struct vnode *vp;
+  unsigned int b;
+
+  for (b = 0; b < NR_VNODES; b++) vnode_hash[b] = NULL;
+  vnode_free_head = vnode_free_tail = NULL;
 
   for (vp = &vnode[0]; vp < &vnode[NR_VNODES]; ++vp) {
 	vp->v_fs_e = NONE;
@@ -147,6 +283,13 @@ void init_vnodes(void)
 	vp->v_fs_count = 0;
 	vp->v_mapfs_count = 0;
 	tll_init(&vp->v_lock);
+	vp->v_pipe_buf = NULL;
+	vp->v_mountedhere = NULL;
+	vp->v_stat_ticks = 0;
+	vp->v_hash_next = vp->v_hash_prev = NULL;
+	vp->v_free_next = vp->v_free_prev = NULL;
+	hash_vnode(vp);
+	add_free_vnode(vp);
   }
 }
 
@@ -230,6 +373,12 @@ void dup_vnode(struct vnode *vp)
  * referred inode's counter.
  */
   ASSERTVP(vp);
+
+  /* A thread may revive a vnode that lost all its references while the thread
+   * was waiting for its lock (see advance()); such a vnode must leave the
+   * free list again. */
+  if (vp->v_ref_count == 0 && is_free_vnode(vp)) rm_free_vnode(vp);
+
   vp->v_ref_count++;
 }
 
@@ -295,6 +444,10 @@ void put_vnode(struct vnode *vp)
   vp->v_ref_count = 0;
   vp->v_mapfs_count = 0;
 
+  pipe_buf_detach(vp);
+
+  add_free_vnode(vp);
+
   unlock_vnode(vp);
 }
 
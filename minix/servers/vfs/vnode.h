@@ -1,6 +1,10 @@
 #ifndef __VFS_VNODE_H__
 #define __VFS_VNODE_H__
 
+#include <sys/stat.h>
+
+struct pipe_buf;		/* in-VFS pipe data buffer (see pipe.c) */
+
 EXTERN struct vnode {
   endpoint_t v_fs_e;            /* FS process' endpoint number */
   endpoint_t v_mapfs_e;		/* mapped FS process' endpoint number */
@@ -19,7 +23,16 @@ EXTERN struct vnode {
                                    inode resides */
   dev_t v_sdev;                 /* device number for special files */
   struct vmnt *v_vmnt;          /* vmnt object of the partition */
+  struct vmnt *v_mountedhere;	/* vmnt mounted on this vnode, or NULL */
+  struct pipe_buf *v_pipe_buf;	/* in-VFS pipe data buffer, or NULL */
+  struct stat v_stat;		/* cached attributes; valid iff v_stat_ticks
+				   is nonzero (see cached_stat()) */
+  clock_t v_stat_ticks;		/* time v_stat was fetched, or 0 if invalid */
   tll_t v_lock;			/* three-level-lock */
+  struct vnode *v_hash_next;	/* next vnode on its hash chain */
+  struct vnode *v_hash_prev;	/* previous vnode on its hash chain */
+  struct vnode *v_free_next;	/* next vnode on the free list */
+  struct vnode *v_free_prev;	/* previous vnode on the free list */
 } vnode[NR_VNODES];
 
 /* vnode lock types mapping */
@@ -5,11 +5,18 @@
 static void *worker_main(void *arg);
 static void worker_sleep(void);
 static void worker_wake(struct worker_thread *worker);
+static void worker_free_push(struct worker_thread *worker);
+static struct worker_thread *worker_free_pop(void);
+static void worker_free_remove(struct worker_thread *worker);
+static void worker_pending_push(struct fproc *rfp);
+static struct fproc *worker_pending_pop(void);
 
 static mthread_attr_t tattr;
 static unsigned int pending;
 static unsigned int busy;
 static int block_all;
+static struct worker_thread *free_workers;	/* LIFO of free threads */
+static struct fproc *pend_head, *pend_tail;	/* FIFO of pending work */
 
 #if defined(_MINIX_MAGIC)
 # define TH_STACKSIZE (64 * 1024)
@@ -19,7 +26,109 @@ static int block_all;
 # define TH_STACKSIZE (28 * 1024)
 #endif
 
-#define ASSERTW(w) assert((w) >= &workers[0] && (w) < &workers[NR_WTHREADS])
+#define ASSERTW(w) assert((w) >= &workers[0] && (w) < &workers[nr_wthreads])
+
+/*===========================================================================*
+ *				worker_free_push			     *
+ *===========================================================================*/
+static void worker_free_push(struct worker_thread *worker)
+{
+/* Push a worker thread onto the free list. A worker thread is on the free list
+ * if and only if it has no work assigned to it (w_fp is NULL). Free threads
+ * are never blocked in sendmsg() or on a lock, so we can safely reuse the
+ * w_next field to link them up.
+ */
+
+  assert(worker->w_fp == NULL);
+
+  worker->w_next = free_workers;
+  free_workers = worker;
+}
+
+/*===========================================================================*
+ *				worker_free_pop				     *
+ *===========================================================================*/
+static struct worker_thread *worker_free_pop(void)
+{
+/* Remove and return the head of the free worker thread list. The caller must
+ * ensure that the list is not empty.
+ */
+  struct worker_thread *worker;
+
+  worker = free_workers;
+  assert(worker != NULL);
+  free_workers = worker->w_next;
+  worker->w_next = NULL;
+
+  return worker;
+}
+
+/*===========================================================================*
+ *				worker_free_remove			     *
+ *===========================================================================*/
+static void worker_free_remove(struct worker_thread *worker)
+{
+/* Remove the given worker thread from the free list. The thread is usually at
+ * the head of the list, since it is typically the thread that last completed
+ * work, but this is not guaranteed.
+ */
+  struct worker_thread **wpp;
+
+  for (wpp = &free_workers; *wpp != NULL; wpp = &(*wpp)->w_next) {
+	if (*wpp == worker) {
+		*wpp = worker->w_next;
+		worker->w_next = NULL;
+		return;
+	}
+  }
+
+  panic("worker not on free list");
+}
+
+/*===========================================================================*
+ *				worker_pending_push			     *
+ *===========================================================================*/
+static void worker_pending_push(struct fproc *rfp)
+{
+/* Append the given process to the tail of the pending work queue, so that
+ * pending work is picked up in order of arrival.
+ */
+
+  assert(!(rfp->fp_flags & FP_PENDING));
+
+  rfp->fp_flags |= FP_PENDING;
+  rfp->fp_pend_next = NULL;
+  if (pend_tail != NULL)
+	pend_tail->fp_pend_next = rfp;
+  else
+	pend_head = rfp;
+  pend_tail = rfp;
+  pending++;
+}
+
+/*===========================================================================*
+ *				worker_pending_pop			     *
+ *===========================================================================*/
+static struct fproc *worker_pending_pop(void)
+{
+/* Remove and return the head of the pending work queue. The caller must ensure
+ * that the queue is not empty.
+ */
+  struct fproc *rfp;
+
+  rfp = pend_head;
+  assert(rfp != NULL);
+  assert(rfp->fp_flags & FP_PENDING);
+  pend_head = rfp->fp_pend_next;
+  if (pend_head == NULL)
+	pend_tail = NULL;
+  rfp->fp_pend_next = NULL;
+  rfp->fp_flags &= ~FP_PENDING;	/* No longer pending */
+  assert(pending > 0);
+  pending--;
+
+  return rfp;
+}
 
 /*===========================================================================*
  *				worker_init				     *
@@ -28,6 +137,7 @@ void worker_init(void)
 {
 /* Initialize worker threads */
   struct worker_thread *wp;
+  long v;
   int i;
 
   if (mthread_attr_init(&tattr) != 0)
@@ -35,16 +145,26 @@ void worker_init(void)
   if (mthread_attr_setstacksize(&tattr, TH_STACKSIZE) != 0)
 	panic("couldn't set default thread stack size");
 
+  /* The number of worker threads may be set with a boot monitor variable,
+   * within the limits of the statically allocated worker thread table. At
+   * least two threads are required: one for regular work and the spare.
+   */
+  v = DFLT_NR_WTHREADS;
+  (void) env_parse("vfs_wthreads", "d", 0, &v, 2, NR_WTHREADS);
+  nr_wthreads = (int) v;
+
   pending = 0;
   busy = 0;
   block_all = FALSE;
+  free_workers = NULL;
+  pend_head = pend_tail = NULL;
 
-  for (i = 0; i < NR_WTHREADS; i++) {
+  for (i = nr_wthreads - 1; i >= 0; i--) {
 	wp = &workers[i];
 
 	wp->w_fp = NULL;		/* Mark not in use */
-	wp->w_next = NULL;
 	wp->w_task = NONE;
+	worker_free_push(wp);
 	if (mutex_init(&wp->w_event_mutex, NULL) != 0)
 		panic("failed to initialize mutex");
 	if (cond_init(&wp->w_event, NULL) != 0)
@@ -73,7 +193,7 @@ void worker_cleanup(void)
   assert(worker_idle());
 
   /* First terminate all threads. */
-  for (i = 0; i < NR_WTHREADS; i++) {
+  for (i = 0; i < nr_wthreads; i++) {
 	wp = &workers[i];
 
 	assert(wp->w_fp == NULL);
@@ -85,7 +205,7 @@ void worker_cleanup(void)
   worker_yield();
 
   /* Then clean up their resources. */
-  for (i = 0; i < NR_WTHREADS; i++) {
+  for (i = 0; i < nr_wthreads; i++) {
 	wp = &workers[i];
 
 	if (mthread_join(wp->w_tid, NULL) != 0)
@@ -101,6 +221,7 @@ void worker_cleanup(void)
 	panic("failed to destroy attribute");
 
   memset(workers, 0, sizeof(workers));
+  free_workers = NULL;
 }
 
 /*===========================================================================*
@@ -122,22 +243,23 @@ static void worker_assign(struct fproc *rfp)
  * ensure that there is in fact at least one free thread.
  */
   struct worker_thread *worker;
-  int i;
 
-  /* Find a free worker thread. */
-  for (i = 0; i < NR_WTHREADS; i++) {
-	worker = &workers[i];
-
-	if (worker->w_fp == NULL)
-		break;
-  }
-  assert(worker != NULL);
+  /* Take a thread off the free list. The most recently freed thread is taken
+   * first, as its stack is most likely to be cached.
+   */
+  worker = worker_free_pop();
 
-  /* Assign work to it. */
+  /* Assign work to it. The thread may still be marked high-priority from a
+   * previous request (see worker_signal); fresh requests are run at normal
+   * priority, so that requests already in progress go first.
+   */
   rfp->fp_worker = worker;
   worker->w_fp = rfp;
   busy++;
 
+  if (mthread_setprio(worker->w_tid, MTHREAD_PRIO_NORMAL) != 0)
+	panic("unable to lower worker thread priority");
+
   worker_wake(worker);
 }
 
@@ -169,20 +291,10 @@ void worker_allow(int allow)
 
   block_all = !allow;
 
-  if (!worker_may_do_pending())
-	return;
-
   /* Assign any pending work to workers. */
-  for (rfp = &fproc[0]; rfp < &fproc[NR_PROCS]; rfp++) {
-	if (rfp->fp_flags & FP_PENDING) {
-		rfp->fp_flags &= ~FP_PENDING; /* No longer pending */
-		assert(pending > 0);
-		pending--;
-		worker_assign(rfp);
-
-		if (!worker_may_do_pending())
-			return;
-	}
+  while (worker_may_do_pending()) {
+	rfp = worker_pending_pop();
+	worker_assign(rfp);
   }
 }
 
@@ -201,19 +313,13 @@ static int worker_get_work(void)
 
   /* Is there pending work, and should we do it? */
   if (worker_may_do_pending()) {
-	/* Find pending work */
-	for (rfp = &fproc[0]; rfp < &fproc[NR_PROCS]; rfp++) {
-		if (rfp->fp_flags & FP_PENDING) {
-			self->w_fp = rfp;
-			rfp->fp_worker = self;
-			busy++;
-			rfp->fp_flags &= ~FP_PENDING; /* No longer pending */
-			assert(pending > 0);
-			pending--;
-			return TRUE;
-		}
-	}
-	panic("Pending work inconsistency");
+	/* Take the pending work, and ourselves off the free list. */
+	rfp = worker_pending_pop();
+	worker_free_remove(self);
+	self->w_fp = rfp;
+	rfp->fp_worker = self;
+	busy++;
+	return TRUE;
   }
 
   /* Wait for work to come to us */
@@ -230,7 +336,7 @@ int worker_available(void)
 /* Return the number of threads that are available, including the spare thread.
  */
 
-  return(NR_WTHREADS - busy);
+  return(nr_wthreads - busy);
 }
 
 /*===========================================================================*
@@ -284,6 +390,7 @@ static void *worker_main(void *arg)
 	self->w_fp = NULL;
 	assert(busy > 0);
 	busy--;
+	worker_free_push(self);
   }
 
   return(NULL);
@@ -349,8 +456,7 @@ static void worker_try_activate(struct fproc *rfp, int use_spare)
   if (needed <= worker_available() && (!block_all || use_spare)) {
 	worker_assign(rfp);
   } else {
-	rfp->fp_flags |= FP_PENDING;
-	pending++;
+	worker_pending_push(rfp);
   }
 }
 
@@ -526,6 +632,15 @@ void worker_wait(void)
 void worker_signal(struct worker_thread *worker)
 {
   ASSERTW(worker);		/* Make sure we have a valid thread */
+
+  /* The worker is resuming a request that is already in progress. Prefer it
+   * over workers that would start new requests: finishing nearly-complete
+   * requests first releases their resources sooner and bounds the amount of
+   * work in flight.
+   */
+  if (mthread_setprio(worker->w_tid, MTHREAD_PRIO_HIGH) != 0)
+	panic("unable to raise worker thread priority");
+
   worker_wake(worker);
 }
 
@@ -546,6 +661,11 @@ void worker_stop(struct worker_thread *worker)
 	worker->w_sendrec = NULL;
   } else
 	panic("reply storage consistency error");	/* Oh dear */
+
+  /* As in worker_signal, let the interrupted request finish first. */
+  if (mthread_setprio(worker->w_tid, MTHREAD_PRIO_HIGH) != 0)
+	panic("unable to raise worker thread priority");
+
   worker_wake(worker);
 }
 
@@ -559,7 +679,7 @@ void worker_stop_by_endpt(endpoint_t proc_e)
 
   if (proc_e == NONE) return;
 
-  for (i = 0; i < NR_WTHREADS; i++) {
+  for (i = 0; i < nr_wthreads; i++) {
 	worker = &workers[i];
 	if (worker->w_fp != NULL && worker->w_task == proc_e)
 		worker_stop(worker);
@@ -573,7 +693,7 @@ struct worker_thread *worker_get(thread_t worker_tid)
 {
   int i;
 
-  for (i = 0; i < NR_WTHREADS; i++)
+  for (i = 0; i < nr_wthreads; i++)
 	if (workers[i].w_tid == worker_tid)
 		return(&workers[i]);
 
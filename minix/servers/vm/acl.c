@@ -100,6 +100,16 @@ acl_set(struct vmproc *vmp, bitchunk_t *mask, int sys_proc)
 		memcpy(&acl_mask[vmp->vm_acl], mask, sizeof(acl_mask[0]));
 }
 
+/*
+ * Return whether the given process is a regular user process, i.e., it shares
+ * the user process call mask.
+ */
+int
+acl_is_user(struct vmproc *vmp)
+{
+	return vmp->vm_acl == USER_ACL;
+}
+
 /*
  * A process has forked.  User processes inherit their parent's ACL by default,
  * although they may be turned into system processes later.  System processes
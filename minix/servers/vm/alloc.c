@@ -33,6 +33,34 @@
 #define NUMBER_PHYSICAL_PAGES (int)(0x100000000ULL/VM_PAGE_SIZE)
 #define PAGE_BITMAP_CHUNKS BITMAP_CHUNKS(NUMBER_PHYSICAL_PAGES)
 static bitchunk_t free_pages_bitmap[PAGE_BITMAP_CHUNKS];
+
+/* Summary bitmap over the free pages bitmap: one bit per chunk, set if and
+ * only if that chunk has at least one free page. A zero summary word proves
+ * that a whole range of chunks is fully allocated, so the allocator can skip
+ * over it in one step instead of inspecting every page, which keeps the
+ * search from degrading as memory fills up and fragments.
+ */
+static bitchunk_t free_chunks_summary[BITMAP_CHUNKS(PAGE_BITMAP_CHUNKS)];
+
+/* Bitmap of free pages that have already been zeroed by the scrubber. A set
+ * bit implies the corresponding free_pages_bitmap bit is set as well; pages
+ * lose their clean bit when allocated and are dirty when freed. PAF_CLEAR
+ * allocations skip the synchronous memset for pages marked clean here, which
+ * takes the zeroing cost out of the anonymous page fault path. The scrubber
+ * (scrub_cycle) zeroes dirty free pages in small batches from the main loop,
+ * whenever 'scrub_pending' indicates there is work left.
+ */
+static bitchunk_t clean_pages_bitmap[PAGE_BITMAP_CHUNKS];
+int scrub_pending = 0;		/* # free pages not yet pre-zeroed */
+
+/* Running count of free pages, so that the page-out code can check for
+ * memory pressure without scanning the bitmap every time.
+ */
+static int nr_free_pages = 0;
+
+#define SCRUB_BATCH	32	/* max pages zeroed per scrub_cycle() call */
+
+#define FULL_BITCHUNK ((bitchunk_t)~0)
 #define PAGE_CACHE_MAX 10000
 static int free_page_cache[PAGE_CACHE_MAX];
 static int free_page_cache_size = 0;
@@ -319,6 +347,10 @@ void mem_init(struct memory *chunks)
   total_pages = 0;
 
   memset(free_pages_bitmap, 0, sizeof(free_pages_bitmap));
+  memset(free_chunks_summary, 0, sizeof(free_chunks_summary));
+  memset(clean_pages_bitmap, 0, sizeof(clean_pages_bitmap));
+  scrub_pending = 0;
+  nr_free_pages = 0;
 
   /* Use the chunks of physical memory to allocate holes. */
   for (i=NR_MEMS-1; i>=0; i--) {
@@ -368,30 +400,57 @@ void memstats(int *nodes, int *pages, int *largest)
 
 static int findbit(int low, int startscan, int pages, int memflags, int *len)
 {
+/* Scan the free pages bitmap downwards from startscan for a run of at least
+ * 'pages' free pages, hierarchically: a zero word in the summary bitmap lets
+ * us skip BITCHUNK_BITS fully allocated chunks in one step, a zero chunk
+ * skips BITCHUNK_BITS pages, and an all-ones chunk extends the current run
+ * by BITCHUNK_BITS pages at once. Only partially free chunks are walked bit
+ * by bit. While a run is open, it covers pages [freerange_start,
+ * freerange_start+run_length-1] and i is the next page to examine.
+ */
 	int run_length = 0, i;
 	int freerange_start = startscan;
 
-	for(i = startscan; i >= low; i--) {
-		if(!page_isfree(i)) {
-			int pi;
-			int chunk = i/BITCHUNK_BITS, moved = 0;
+	for(i = startscan; i >= low; ) {
+		bitchunk_t chunk;
+		int bit = CHUNK_OFFSET(i), ci = i / BITCHUNK_BITS;
+
+		if(!MAP_CHUNK(free_chunks_summary, ci)) {
+			/* No free page in any chunk of this summary word. */
 			run_length = 0;
-			pi = i;
-			while(chunk > 0 &&
-			   !MAP_CHUNK(free_pages_bitmap, chunk*BITCHUNK_BITS)) {
-				chunk--;
-				moved = 1;
-			}
-			if(moved) { i = chunk * BITCHUNK_BITS + BITCHUNK_BITS; }
+			i -= CHUNK_OFFSET(ci) * BITCHUNK_BITS + bit + 1;
+			continue;
+		}
+
+		chunk = MAP_CHUNK(free_pages_bitmap, i);
+
+		if(chunk == 0) {
+			/* No free page in this chunk. */
+			run_length = 0;
+			i -= bit + 1;
 			continue;
 		}
-		if(!run_length) { freerange_start = i; run_length = 1; }
-		else { freerange_start--; run_length++; }
-		assert(run_length <= pages);
-		if(run_length == pages) {
+
+		if(chunk == FULL_BITCHUNK && bit == BITCHUNK_BITS - 1 &&
+		   i - (BITCHUNK_BITS - 1) >= low) {
+			/* Whole chunk free; add all of it to the run. */
+			if(!run_length) freerange_start = i + 1;
+			freerange_start -= BITCHUNK_BITS;
+			run_length += BITCHUNK_BITS;
+			i -= BITCHUNK_BITS;
+		} else if(chunk & (1 << bit)) {
+			if(!run_length) { freerange_start = i; run_length = 1; }
+			else { freerange_start--; run_length++; }
+			i--;
+		} else {
+			run_length = 0;
+			i--;
+		}
+
+		if(run_length >= pages) {
 			/* good block found! */
-			*len = run_length;
-			return freerange_start;
+			*len = pages;
+			return freerange_start + run_length - pages;
 		}
 	}
 
@@ -447,13 +506,43 @@ static phys_bytes alloc_pages(int pages, int memflags)
 
 	for(i = mem; i < mem + pages; i++) {
 		UNSET_BIT(free_pages_bitmap, i);
+		if(!MAP_CHUNK(free_pages_bitmap, i))
+			UNSET_BIT(free_chunks_summary, i / BITCHUNK_BITS);
 	}
+	nr_free_pages -= pages;
 
 	if(memflags & PAF_CLEAR) {
 		int s;
-		if ((s= sys_memset(NONE, 0, CLICK_SIZE*mem,
-			VM_PAGE_SIZE*pages)) != OK) 
-			panic("alloc_mem: sys_memset failed: %d", s);
+		phys_bytes dirty_start;
+
+		/* Zero only the pages the scrubber has not pre-zeroed yet,
+		 * in as few kernel calls as possible. In the common case of
+		 * a single-page fault on a scrubbed page, no call is needed
+		 * at all.
+		 */
+		for(i = mem; i < mem + pages; ) {
+			if(GET_BIT(clean_pages_bitmap, i)) {
+				i++;
+				continue;
+			}
+			dirty_start = i;
+			while(i < mem + pages &&
+			   !GET_BIT(clean_pages_bitmap, i))
+				i++;
+			if ((s= sys_memset(NONE, 0, CLICK_SIZE*dirty_start,
+				VM_PAGE_SIZE*(i-dirty_start))) != OK)
+				panic("alloc_mem: sys_memset failed: %d", s);
+		}
+	}
+
+	/* The pages are no longer free; retire their clean bits and take the
+	 * still-dirty ones out of the scrub backlog.
+	 */
+	for(i = mem; i < mem + pages; i++) {
+		if(GET_BIT(clean_pages_bitmap, i))
+			UNSET_BIT(clean_pages_bitmap, i);
+		else
+			scrub_pending--;
 	}
 
 	return mem;
@@ -474,10 +563,73 @@ static void free_pages(phys_bytes pageno, int npages)
 
 	for(i = pageno; i <= lim; i++) {
 		SET_BIT(free_pages_bitmap, i);
+		SET_BIT(free_chunks_summary, i / BITCHUNK_BITS);
+		assert(!GET_BIT(clean_pages_bitmap, i));
+		scrub_pending++;
 		if(free_page_cache_size < PAGE_CACHE_MAX) {
 			free_page_cache[free_page_cache_size++] = i;
 		}
 	}
+	nr_free_pages += npages;
+}
+
+/*===========================================================================*
+ *				mem_free_pages				     *
+ *===========================================================================*/
+int mem_free_pages(void)
+{
+	return nr_free_pages;
+}
+
+/*===========================================================================*
+ *				scrub_cycle				     *
+ *===========================================================================*/
+void scrub_cycle(void)
+{
+/* Pre-zero a batch of dirty free pages, so that later PAF_CLEAR allocations
+ * can skip the synchronous memset. Called from the main loop between
+ * requests, like alloc_cycle(); the batch is kept small so that an incoming
+ * request is never delayed for long.
+ */
+	static int scan_chunk = 0;
+	int nchunks = (NUMBER_PHYSICAL_PAGES+BITCHUNK_BITS-1)/BITCHUNK_BITS;
+	int scrubbed = 0, steps, b;
+
+	for(steps = 0; steps < nchunks && scrubbed < SCRUB_BATCH &&
+	   scrub_pending > 0; steps++, scan_chunk++) {
+		bitchunk_t dirty;
+
+		if(scan_chunk >= nchunks) scan_chunk = 0;
+
+		dirty = free_pages_bitmap[scan_chunk] &
+			~clean_pages_bitmap[scan_chunk];
+		if(dirty == 0)
+			continue;
+
+		for(b = 0; b < BITCHUNK_BITS; ) {
+			int run_start, run_len, p;
+
+			if(!(dirty & (1 << b))) {
+				b++;
+				continue;
+			}
+			run_start = b;
+			while(b < BITCHUNK_BITS && (dirty & (1 << b)))
+				b++;
+			run_len = b - run_start;
+			p = scan_chunk * BITCHUNK_BITS + run_start;
+
+			if(sys_memset(NONE, 0,
+			   VM_PAGE_SIZE * (phys_bytes) p,
+			   VM_PAGE_SIZE * run_len) != OK)
+				panic("scrub_cycle: sys_memset failed");
+
+			while(run_len-- > 0)
+				SET_BIT(clean_pages_bitmap, p + run_len);
+			scrub_pending -= b - run_start;
+			scrubbed += b - run_start;
+		}
+	}
 }
 
 /*===========================================================================*
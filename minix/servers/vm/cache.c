@@ -289,18 +289,26 @@ int cache_freepages(int pages)
 {
 	struct cached_page *cp, *newercp;
 	int freed = 0;
-	int oldsteps = 0;
-	int skips = 0;
-
-	for(cp = lru_oldest; cp && freed < pages; cp = newercp) {
-		newercp = cp->newer;
-		assert(cp->page->refcount >= 1);
-		if(cp->page->refcount == 1) {
+	int pass;
+
+	/* Prefer evicting pages without an inode association. Those are file
+	 * system metadata blocks, which the FS holds in its own buffer cache
+	 * as well. Inode-associated pages are the ones that back file
+	 * mappings (program text, shared libraries) and can be reused by any
+	 * process mapping the same file, so they are only evicted in a
+	 * second pass, if the first one did not free enough.
+	 */
+	for(pass = 0; pass < 2 && freed < pages; pass++) {
+		for(cp = lru_oldest; cp && freed < pages; cp = newercp) {
+			newercp = cp->newer;
+			assert(cp->page->refcount >= 1);
+			if(cp->page->refcount > 1)
+				continue;
+			if(pass == 0 && cp->ino != VMC_NO_INODE)
+				continue;
 			rmcache(cp);
 			freed++;
-			skips = 0;
-		} else skips++;
-		oldsteps++;
+		}
 	}
 
 	return freed;
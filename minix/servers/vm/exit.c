@@ -32,6 +32,15 @@ static void reset_vm_rusage(struct vmproc *vmp)
 
 void free_proc(struct vmproc *vmp)
 {
+	/* The kernel may have cached address translations for this process.
+	 * Those must be dropped before the page tables are freed: pt_free()
+	 * bypasses the pt_writemap() invalidation hook, and letting stale
+	 * (endpoint, page) entries survive here would make a later reuse of
+	 * the endpoint - in particular a service refresh via VMPPARAM_CLEAR -
+	 * hand out frames that have since been freed or reassigned.
+	 */
+	if(vmp->vm_endpoint != NONE && vmp->vm_endpoint != VM_PROC_NR)
+		sys_vmctl(vmp->vm_endpoint, VMCTL_PTCACHE_INVAL, 0);
 	map_free_proc(vmp);
 	pt_free(&vmp->vm_pt);
 	region_init(&vmp->vm_regions_avl);
@@ -148,7 +148,7 @@ void fdref_deref(struct vir_region *region)
 	 * will print a diagnostic.
 	 */
 	if(vfs_request(VMVFSREQ_FDCLOSE, fd, region->parent,
-		0, 0, NULL, NULL, NULL, 0) != OK) {
+		0, 0, 0, NULL, NULL, NULL, 0) != OK) {
 		panic("fdref_deref: could not send close request");
 	}
 }
@@ -165,7 +165,7 @@ struct fdref *fdref_dedup_or_new(struct vmproc *owner,
 			}
 			if(!mayclose) continue;
 			if(vfs_request(VMVFSREQ_FDCLOSE, fd, owner,
-				0, 0, NULL, NULL, NULL, 0) != OK) {
+				0, 0, 0, NULL, NULL, NULL, 0) != OK) {
 				printf("fdref_dedup_or_new: could not close\n");
 			}
 			return fr;
@@ -34,6 +34,8 @@
 #include "sanitycheck.h"
 
 extern int missing_spares;
+extern int scrub_pending;
+extern int swap_enabled;
 
 #include <machine/archtypes.h>
 #include <sys/param.h>
@@ -118,6 +120,12 @@ int main(void)
 	if(missing_spares > 0) {
 		alloc_cycle();	/* mem alloc code wants to be called */
 	}
+	if(scrub_pending > 0) {
+		scrub_cycle();	/* pre-zero free pages between requests */
+	}
+	if(swap_enabled) {
+		swap_cycle();	/* page out memory under pressure */
+	}
 
   	if ((r=sef_receive_status(ANY, &msg, &rcv_sts)) != OK)
 		panic("sef_receive_status() error: %d", r);
@@ -538,6 +546,11 @@ void init_vm(void)
 	CALLMAP(VM_MUNMAP, do_munmap);
 	CALLMAP(VM_MAP_PHYS, do_map_phys);
 	CALLMAP(VM_UNMAP_PHYS, do_munmap);
+	CALLMAP(VM_MADVISE, do_madvise);
+	CALLMAP(VM_MLOCK, do_mlock);
+	CALLMAP(VM_MUNLOCK, do_mlock);
+	CALLMAP(VM_MLOCKALL, do_mlockall);
+	CALLMAP(VM_MUNLOCKALL, do_mlockall);
 
 	/* Calls from PM. */
 	CALLMAP(VM_EXIT, do_exit);
@@ -574,6 +587,9 @@ void init_vm(void)
 	/* getrusage */
 	CALLMAP(VM_GETRUSAGE, do_getrusage);
 
+	/* Swap space management. */
+	CALLMAP(VM_SWAPON, do_swapon);
+
 	/* Mark VM instances. */
 	num_vm_instances = 1;
 	vmproc[VM_PROC_NR].vm_flags |= VMF_VM_INSTANCE;
@@ -56,7 +56,11 @@ static int anon_pt_flags(struct vir_region *vr){
 static int anon_unreference(struct phys_region *pr)
 {
 	assert(pr->ph->refcount == 0);
-	if(pr->ph->phys != MAP_NONE)
+	if(pr->ph->flags & PBF_PAGEOUT)
+		swap_pageout_cancel(pr->ph);
+	if(pr->ph->flags & PBF_SWAPPED)
+		swap_slot_free(pr->ph);
+	else if(pr->ph->phys != MAP_NONE)
 		free_mem(ABS2CLICK(pr->ph->phys), 1);
 	return OK;
 }
@@ -67,37 +71,56 @@ static int anon_pagefault(struct vmproc *vmp, struct vir_region *region,
 {
 	phys_bytes new_page, new_page_cl;
 	u32_t allocflags;
+	int r;
 
 	allocflags = vrallocflags(region->flags);
 
 	assert(ph->ph->refcount > 0);
 
-	if((new_page_cl = alloc_mem(1, allocflags)) == NO_MEM) {
-		printf("anon_pagefault: out of memory\n");
-		return ENOMEM;
+	/* If a page-out of this block is in flight, cancel it: the contents
+	 * are about to be referenced (and possibly changed) again.
+	 */
+	if(ph->ph->flags & PBF_PAGEOUT)
+		swap_pageout_cancel(ph->ph);
+
+	/* If the block was paged out to swap, page it back in first. This
+	 * may suspend the fault for a disk read. Once the block has its page
+	 * frame back, the normal checks below apply, e.g. for copy-on-write.
+	 */
+	if(ph->ph->flags & PBF_SWAPPED) {
+		if((r = swap_pagein(vmp, ph->ph, allocflags, cb, state, len,
+			io)) != OK)
+			return r;
 	}
-	new_page = CLICK2ABS(new_page_cl);
 
-	/* Totally new block? Create it. */
-	if(ph->ph->phys == MAP_NONE) {
-		ph->ph->phys = new_page;
-		assert(ph->ph->phys != MAP_NONE);
+	if(ph->ph->phys != MAP_NONE) {
+		if(ph->ph->refcount < 2 || !write) {
+			/* memory is ready already */
+			return OK;
+		}
 
-		return OK;
+		assert(region->flags & VR_WRITABLE);
+
+		return mem_cow(region, ph, MAP_NONE, MAP_NONE);
 	}
 
-	if(ph->ph->refcount < 2 || !write) {
-		/* memory is ready already */
-		return OK;
-	}	
+	/* Totally new block? Create it. */
+	if((new_page_cl = alloc_mem(1, allocflags)) == NO_MEM) {
+		printf("anon_pagefault: out of memory\n");
+		return ENOMEM;
+	}
+	new_page = CLICK2ABS(new_page_cl);
 
-        assert(region->flags & VR_WRITABLE);
+	ph->ph->phys = new_page;
+	assert(ph->ph->phys != MAP_NONE);
 
-	return mem_cow(region, ph, new_page_cl, new_page);
+	return OK;
 }
 
 static int anon_sanitycheck(struct phys_region *pr, const char *file, int line)
 {
+	if(pr->ph->flags & PBF_SWAPPED)
+		return OK;
 	MYASSERT(usedpages_add(pr->ph->phys, VM_PAGE_SIZE) == OK);
 	return OK;
 }
@@ -105,6 +128,8 @@ static int anon_sanitycheck(struct phys_region *pr, const char *file, int line)
 static int anon_writable(struct phys_region *pr)
 {
 	assert(pr->ph->refcount > 0);
+	if(pr->ph->flags & PBF_SWAPPED)
+		return 0;
 	if(pr->ph->phys == MAP_NONE)
 		return 0;
 	if(pr->parent->remaps > 0)
@@ -27,6 +27,14 @@ static int mappedfile_lowshrink(struct vir_region *vr, vir_bytes len);
 static void mappedfile_delete(struct vir_region *region);
 static int mappedfile_pt_flags(struct vir_region *vr);
 
+/* On a hard page fault, ask the file system for up to this many bytes,
+ * starting at the faulting page, instead of just the single page we need.
+ * The FS puts every page it loads into the VM cache, so subsequent faults
+ * on the following pages are satisfied from the cache without another
+ * VFS/FS round trip each.
+ */
+#define FAULT_AROUND_BYTES	(16 * VM_PAGE_SIZE)
+
 struct mem_type mem_type_mappedfile = {
 	.name = "file-mapped memory",
 	.ev_unreference = mappedfile_unreference,
@@ -86,6 +94,7 @@ static int mappedfile_pagefault(struct vmproc *vmp, struct vir_region *region,
 	void *state, int statelen, int *io)
 {
 	u32_t allocflags;
+	vir_bytes iolen;
 	int procfd = region->param.file.fdref->fd;
 
 	allocflags = vrallocflags(region->flags);
@@ -145,8 +154,19 @@ static int mappedfile_pagefault(struct vmproc *vmp, struct vir_region *region,
 			return EFAULT;
 		}
 
+		/* Fault around: have the FS load a run of pages rather than
+		 * just the faulting one. Matters in particular for exec():
+		 * program text is demand paged, and a freshly executed
+		 * process would otherwise pay a fault and a round trip per
+		 * page of text it touches. A short read near the end of the
+		 * file is fine; the FS caches what it can.
+		 */
+		iolen = region->length - ph->offset;
+		if(iolen > FAULT_AROUND_BYTES)
+			iolen = FAULT_AROUND_BYTES;
+
                 if(vfs_request(VMVFSREQ_FDIO, procfd, vmp, referenced_offset,
-			VM_PAGE_SIZE, cb, NULL, state, statelen) != OK) {
+			iolen, 0, cb, NULL, state, statelen) != OK) {
 			printf("VM: mappedfile_pagefault: vfs_request failed\n");
 			return ENOMEM;
 		}
@@ -207,6 +227,8 @@ int mappedfile_setfile(struct vmproc *owner,
 
 	if(!prefill) return OK;
 
+	pt_batch_start(owner);
+
 	for(vaddr = 0; vaddr < region->length; vaddr+=VM_PAGE_SIZE) {
 		struct cached_page *cp = NULL;
 		struct phys_region *pr;
@@ -243,9 +265,77 @@ int mappedfile_setfile(struct vmproc *owner,
 		}
 	}
 
+	pt_batch_end(owner);
+
 	return OK;
 }
 
+void mappedfile_fault_around(struct vmproc *vmp, struct vir_region *region,
+	vir_bytes offset)
+{
+/* A page fault on this file-backed region has just been resolved. Also map
+ * in the surrounding pages that are already present in the VM cache, so
+ * that sequential access does not pay a fault per page. This pairs with the
+ * FAULT_AROUND_BYTES read-ahead above: a hard fault pulls a run of pages
+ * into the cache, and this maps the run in as soon as the next fault lands
+ * in the same window. Only pages that take no I/O and no copying are
+ * mapped; everything else still goes through the regular fault path.
+ */
+	struct cached_page *cp;
+	struct phys_region *pr;
+	vir_bytes start, end, v;
+	u64_t referenced_offset;
+
+	assert(region->def_memtype == &mem_type_mappedfile);
+	assert(region->param.file.inited);
+
+	offset -= offset % VM_PAGE_SIZE;
+
+	/* Align the window, so that repeated sequential faults tile the
+	 * region instead of mapping overlapping runs.
+	 */
+	start = offset - (offset % FAULT_AROUND_BYTES);
+	end = start + FAULT_AROUND_BYTES;
+	if(end > region->length)
+		end = region->length;
+
+	pt_batch_start(vmp);
+
+	for(v = start; v < end; v += VM_PAGE_SIZE) {
+		if(v == offset) continue;		/* just resolved */
+		if(physblock_get(region, v)) continue;	/* already mapped */
+
+		/* The page overlapping the partial-page tail must be copied
+		 * and cleared, which is for the regular fault path to do.
+		 */
+		if(roundup(v + region->param.file.clearend, VM_PAGE_SIZE) >=
+			region->length)
+			break;
+
+		referenced_offset = region->param.file.offset + v;
+
+		if(region->param.file.fdref->ino == VMC_NO_INODE) {
+			cp = find_cached_page_bydev(region->param.file.fdref->dev,
+				referenced_offset, VMC_NO_INODE, 0, 1);
+		} else {
+			cp = find_cached_page_byino(region->param.file.fdref->dev,
+				region->param.file.fdref->ino, referenced_offset, 1);
+		}
+		/* One-time-use pages must take the full fault path too. */
+		if(!cp || (cp->flags & VMSF_ONCE)) continue;
+
+		if(!(pr = pb_reference(cp->page, v, region,
+			&mem_type_mappedfile)))
+			break;	/* out of memory; the fault itself succeeded */
+		if(map_ph_writept(vmp, region, pr) != OK) {
+			printf("mappedfile_fault_around: map_ph_writept failed\n");
+			break;
+		}
+	}
+
+	pt_batch_end(vmp);
+}
+
 static void mappedfile_split(struct vmproc *vmp, struct vir_region *vr,
 	struct vir_region *r1, struct vir_region *r2)
 {
@@ -48,6 +48,16 @@ static struct vir_region *mmap_region(struct vmproc *vmp, vir_bytes addr,
 		if(!execpriv) return NULL;
 		vrflags |= VR_UNINITIALIZED;
 	}
+	if((vmm_flags & MAP_WIRED) || (vmp->vm_flags & VMF_MLOCKALL)) {
+		/* Pin the mapping, and pre-fault what we can here: anonymous
+		 * memory entirely, file-backed memory as far as the VM cache
+		 * goes. File pages that still come in through faults stay
+		 * resident once they do, since the region is pinned.
+		 */
+		vrflags |= VR_PINNED;
+		if(mt != &mem_type_mappedfile)
+			mfflags |= MF_PREALLOC;
+	}
 
 	if(len <= 0) {
 		return NULL;
@@ -262,7 +272,7 @@ int do_mmap(message *m)
 			return ENXIO;
 		}
 
-		if(vfs_request(VMVFSREQ_FDLOOKUP, m->m_mmap.fd, vmp, 0, 0,
+		if(vfs_request(VMVFSREQ_FDLOOKUP, m->m_mmap.fd, vmp, 0, 0, 0,
 			mmap_file_cont, NULL, m, sizeof(*m)) != OK) {
 			printf("VM: vfs_request for mmap failed\n");
 			return ENXIO;
@@ -278,6 +288,138 @@ int do_mmap(message *m)
 	return OK;
 }
 
+/*===========================================================================*
+ *				do_madvise		     		     *
+ *===========================================================================*/
+int do_madvise(message *m)
+{
+	int r, n;
+	struct vmproc *vmp;
+	vir_bytes addr = (vir_bytes) m->m_lc_vm_madvise.addr;
+	size_t len = m->m_lc_vm_madvise.len;
+	int advice = m->m_lc_vm_madvise.advice;
+
+	if((r=vm_isokendpt(m->m_source, &n)) != OK) {
+		panic("do_madvise: message from strange source: %d",
+			m->m_source);
+	}
+
+	vmp = &vmproc[n];
+
+	if(addr % VM_PAGE_SIZE) return EINVAL;
+	if(len == 0) return EINVAL;
+	len = roundup(len, VM_PAGE_SIZE);
+	if(addr + len <= addr) return EINVAL;
+
+	switch(advice) {
+	case MADV_NORMAL:
+	case MADV_RANDOM:
+	case MADV_SEQUENTIAL:
+	case MADV_SPACEAVAIL:
+		/* Accepted, but no behavior is attached to these (yet). */
+		return OK;
+
+	case MADV_WILLNEED:
+		/* Populate the range now, going to VFS for file-backed pages
+		 * that are not in the VM cache. The reply is sent by
+		 * handle_memory_final once the range is resident, as for
+		 * VMPPARAM_HANDLEMEM.
+		 */
+		handle_memory_start(vmp, addr, len, 0 /*wrflag*/,
+			m->m_source, m->m_source, 0 /*transid*/,
+			1 /*vfs_avail*/);
+		return SUSPEND;
+
+	case MADV_DONTNEED:
+	case MADV_FREE:
+		/* Return the backing pages to the allocator. The range stays
+		 * mapped, and faults in fresh when touched again.
+		 */
+		return map_madvise_release(vmp, addr, len);
+
+	default:
+		return EINVAL;
+	}
+}
+
+/*===========================================================================*
+ *				do_mlock		     		     *
+ *===========================================================================*/
+int do_mlock(message *m)
+{
+	int r, n;
+	struct vmproc *vmp;
+	vir_bytes addr = (vir_bytes) m->m_lc_vm_mlock.addr;
+	size_t len = m->m_lc_vm_mlock.len;
+	vir_bytes o;
+
+	if((r=vm_isokendpt(m->m_source, &n)) != OK) {
+		panic("do_mlock: message from strange source: %d",
+			m->m_source);
+	}
+
+	vmp = &vmproc[n];
+
+	if(len == 0) return EINVAL;
+	if((o = addr % VM_PAGE_SIZE)) {
+		addr -= o;
+		len += o;
+	}
+	len = roundup(len, VM_PAGE_SIZE);
+	if(addr + len <= addr) return EINVAL;
+
+	if(m->m_type == VM_MUNLOCK) {
+		map_set_pinned_range(vmp, addr, len, 0);
+		return OK;
+	}
+
+	/* Locked memory must be resident: pin the regions first, then
+	 * populate the range. The reply is sent by handle_memory_final once
+	 * the range is resident.
+	 */
+	map_set_pinned_range(vmp, addr, len, 1);
+
+	handle_memory_start(vmp, addr, len, 0 /*wrflag*/, m->m_source,
+		m->m_source, 0 /*transid*/, 1 /*vfs_avail*/);
+
+	return SUSPEND;
+}
+
+/*===========================================================================*
+ *				do_mlockall		     		     *
+ *===========================================================================*/
+int do_mlockall(message *m)
+{
+	int r, n;
+	struct vmproc *vmp;
+	int flags = m->m_lc_vm_mlock.flags;
+
+	if((r=vm_isokendpt(m->m_source, &n)) != OK) {
+		panic("do_mlockall: message from strange source: %d",
+			m->m_source);
+	}
+
+	vmp = &vmproc[n];
+
+	if(m->m_type == VM_MUNLOCKALL) {
+		vmp->vm_flags &= ~VMF_MLOCKALL;
+		map_set_pinned_all(vmp, 0);
+		return OK;
+	}
+
+	if(!(flags & (MCL_CURRENT|MCL_FUTURE))) return EINVAL;
+
+	if(flags & MCL_FUTURE)
+		vmp->vm_flags |= VMF_MLOCKALL;
+	if(flags & MCL_CURRENT)
+		map_set_pinned_all(vmp, 1);
+
+	/* Unlike mlock(), this does not populate anything: pages are pinned
+	 * as they become resident.
+	 */
+	return OK;
+}
+
 /*===========================================================================*
  *				map_perm_check		     		     *
  *===========================================================================*/
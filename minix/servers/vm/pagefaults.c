@@ -150,6 +150,12 @@ static void handle_pagefault(endpoint_t ep, vir_bytes addr, u32_t err, int retry
 		return;
 	}
 
+	/* Fault around: for file-backed regions, also map in any surrounding
+	 * pages that are already in the VM cache, without further faults.
+	 */
+	if(region->def_memtype == &mem_type_mappedfile)
+		mappedfile_fault_around(vmp, region, offset);
+
         pt_clearmapcache();
 
 	/* Pagefault is handled, so now reactivate the process. */
@@ -376,6 +382,11 @@ static int handle_memory_step(struct hm_state *hmstate, int retry)
 		 * retrying a single page, and that is not possible if this is
 		 * hidden in map_handle_memory.
 		 */
+		/* Stop the target process once for the whole range, rather
+		 * than once per page below.
+		 */
+		pt_batch_start(hmstate->vmp);
+
 		while (length > 0) {
 			sublen = VM_PAGE_SIZE;
 
@@ -402,7 +413,10 @@ static int handle_memory_step(struct hm_state *hmstate, int retry)
 				    sizeof(*hmstate));
 			}
 
-			if(r != OK) return r;
+			if(r != OK) {
+				pt_batch_end(hmstate->vmp);
+				return r;
+			}
 
 			hmstate->len -= sublen;
 			hmstate->mem += sublen;
@@ -411,6 +425,8 @@ static int handle_memory_step(struct hm_state *hmstate, int retry)
 			length -= sublen;
 			retry = FALSE;
 		}
+
+		pt_batch_end(hmstate->vmp);
 	}
 
 	return OK;
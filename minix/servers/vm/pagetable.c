@@ -71,6 +71,8 @@ struct vmproc *vmprocess = &vmproc[VM_PROC_NR];
 
 #ifdef __i386__
 static u32_t global_bit = 0;
+
+static int pt_demote_bigpage(pt_t *pt, int pde);
 #endif
 
 #define SPAREPAGEDIRS 1
@@ -556,7 +558,9 @@ int pt_ptalloc_in_range(pt_t *pt, vir_bytes start, vir_bytes end,
 
 	/* Scan all page-directory entries in the range. */
 	for(pde = first_pde; pde <= last_pde; pde++) {
-		assert(!(pt->pt_dir[pde] & ARCH_VM_BIGPAGE));
+		/* A bigpage mapping has no page table to allocate. */
+		if(pt->pt_dir[pde] & ARCH_VM_BIGPAGE)
+			continue;
 		if(!(pt->pt_dir[pde] & ARCH_VM_PDE_PRESENT)) {
 			int r;
 			if(verify) {
@@ -663,6 +667,12 @@ int pt_map_in_range(struct vmproc *src_vmp, struct vmproc *dst_vmp,
 			if(viraddr == VM_DATATOP) break;
 			continue;
 		}
+#if defined(__i386__)
+		/* Transfer bigpages as individual entries. */
+		if((pt->pt_dir[pde] & ARCH_VM_BIGPAGE) &&
+		   pt_demote_bigpage(pt, pde) != OK)
+			return ENOMEM;
+#endif
 		pte = ARCH_VM_PTE(viraddr);
 		if(!(pt->pt_pt[pde][pte] & ARCH_VM_PTE_PRESENT)) {
 			if(viraddr == VM_DATATOP) break;
@@ -724,6 +734,10 @@ int pt_ptmap(struct vmproc *src_vmp, struct vmproc *dst_vmp)
 			continue;
 		}
 
+		/* A bigpage has no page table to transfer. */
+		if(pt->pt_dir[pde] & ARCH_VM_BIGPAGE)
+			continue;
+
 		if(!pt->pt_pt[pde]) { panic("pde %d empty\n", pde); }
 
 		/* Transfer mapping to the page table. */
@@ -767,6 +781,12 @@ int pt_writable(struct vmproc *vmp, vir_bytes v)
 	int pte = ARCH_VM_PTE(v);
 
 	assert(pt->pt_dir[pde] & ARCH_VM_PDE_PRESENT);
+
+#if defined(__i386__)
+	if(pt->pt_dir[pde] & ARCH_VM_BIGPAGE)
+		return((pt->pt_dir[pde] & PTF_WRITE) ? 1 : 0);
+#endif
+
 	assert(pt->pt_pt[pde]);
 
 	entry = pt->pt_pt[pde][pte];
@@ -778,6 +798,154 @@ int pt_writable(struct vmproc *vmp, vir_bytes v)
 #endif
 }
 
+#if defined(__i386__)
+/*===========================================================================*
+ *				pt_demote_bigpage	     		     *
+ *===========================================================================*/
+static int pt_demote_bigpage(pt_t *pt, int pde)
+{
+/* Split a 4 MB bigpage directory entry into a regular page table with the
+ * equivalent 4 KB mappings, because part of it is about to be changed.
+ */
+	phys_bytes pt_phys, addr;
+	u32_t entry, flags, *p;
+	int i;
+
+	entry = pt->pt_dir[pde];
+
+	assert(entry & ARCH_VM_PDE_PRESENT);
+	assert(entry & ARCH_VM_BIGPAGE);
+	assert(!pt->pt_pt[pde]);
+
+	if(!(p = vm_allocpage(&pt_phys, VMP_PAGETABLE)))
+		return ENOMEM;
+
+	addr = entry & I386_VM_ADDR_MASK_4MB;
+	flags = entry & PTF_ALLFLAGS;
+
+	for(i = 0; i < ARCH_VM_PT_ENTRIES; i++)
+		p[i] = (addr + i * VM_PAGE_SIZE) | flags;
+
+	pt->pt_pt[pde] = p;
+	pt->pt_dir[pde] = (pt_phys & ARCH_VM_ADDR_MASK) | ARCH_VM_PDE_PRESENT
+		| ARCH_VM_PTE_USER | ARCH_VM_PTE_RW;
+
+	return OK;
+}
+
+/*===========================================================================*
+ *				pt_bigpage_promote	     		     *
+ *===========================================================================*/
+void pt_bigpage_promote(pt_t *pt, vir_bytes v, size_t bytes)
+{
+/* Collapse fully populated page tables in the given range into single 4 MB
+ * bigpage directory entries where the hardware allows it: every entry must be
+ * present with identical flags and the physical addresses must be one
+ * contiguous, bigpage-aligned stretch, as with MAP_CONTIG memory. Mapping
+ * large regions with one TLB entry apiece instead of a thousand relieves TLB
+ * pressure considerably. pt_writemap() demotes a bigpage back into a page
+ * table whenever a later request changes only part of it.
+ */
+	int pde, first_pde, npdes, n, pte;
+	vir_bytes first_v;
+
+	if(!bigpage_ok)
+		return;
+
+	/* Only page directory entries that lie entirely inside the range. */
+	first_v = v % ARCH_BIG_PAGE_SIZE ?
+		v + ARCH_BIG_PAGE_SIZE - v % ARCH_BIG_PAGE_SIZE : v;
+	if(v + bytes < first_v + ARCH_BIG_PAGE_SIZE)
+		return;
+	first_pde = ARCH_VM_PDE(first_v);
+	npdes = (v + bytes - first_v) / ARCH_BIG_PAGE_SIZE;
+
+	for(n = 0; n < npdes; n++) {
+		u32_t *ptab;
+		phys_bytes addr;
+		u32_t flags;
+
+		pde = first_pde + n;
+		ptab = pt->pt_pt[pde];
+
+		if(pt->pt_dir[pde] & ARCH_VM_BIGPAGE)
+			continue;
+		if(!(pt->pt_dir[pde] & ARCH_VM_PDE_PRESENT))
+			continue;
+		assert(ptab);
+
+		if(!(ptab[0] & ARCH_VM_PTE_PRESENT))
+			continue;
+		addr = ptab[0] & ARCH_VM_ADDR_MASK;
+		flags = ptab[0] & PTF_ALLFLAGS;
+		if(addr % ARCH_BIG_PAGE_SIZE)
+			continue;
+
+		for(pte = 1; pte < ARCH_VM_PT_ENTRIES; pte++) {
+			u32_t e = ptab[pte] & ~(I386_VM_ACC|I386_VM_DIRTY);
+			if(e != ((addr + pte * VM_PAGE_SIZE) | flags))
+				break;
+		}
+		if(pte < ARCH_VM_PT_ENTRIES)
+			continue;
+
+		pt->pt_dir[pde] = (addr & I386_VM_ADDR_MASK_4MB)
+			| ARCH_VM_BIGPAGE | flags;
+		pt->pt_pt[pde] = NULL;
+		vm_freepages((vir_bytes) ptab, 1);
+	}
+}
+#endif
+
+#ifdef CONFIG_SMP
+static struct vmproc *vminhibit_vmp = NULL;	/* process stopped for batch */
+static int vminhibit_depth = 0;
+#endif
+
+/*===========================================================================*
+ *				pt_batch_start		     		     *
+ *===========================================================================*/
+void pt_batch_start(struct vmproc *vmp)
+{
+/* Stop the target process once for a whole batch of pt_writemap calls,
+ * instead of paying a synchronous stop/resume IPI round trip per call on
+ * SMP. The TLB shootdown itself is already coalesced by the kernel: the
+ * resume marks the process's TLB stale on all CPUs, and each CPU flushes
+ * once when it next runs the process. Batches for the same process may
+ * nest; a batch for a second process falls back to per-call stops.
+ */
+#ifdef CONFIG_SMP
+	if (!vmp || vmp->vm_endpoint == NONE || vmp->vm_endpoint == VM_PROC_NR
+		|| (vmp->vm_flags & VMF_EXITING))
+		return;
+	if (vminhibit_vmp == vmp) {
+		vminhibit_depth++;
+		return;
+	}
+	if (vminhibit_vmp != NULL)
+		return;
+	sys_vmctl(vmp->vm_endpoint, VMCTL_VMINHIBIT_SET, 0);
+	vminhibit_vmp = vmp;
+	vminhibit_depth = 1;
+#endif
+}
+
+/*===========================================================================*
+ *				pt_batch_end		     		     *
+ *===========================================================================*/
+void pt_batch_end(struct vmproc *vmp)
+{
+#ifdef CONFIG_SMP
+	if (vminhibit_vmp != vmp)
+		return;
+	assert(vminhibit_depth > 0);
+	if (--vminhibit_depth > 0)
+		return;
+	vminhibit_vmp = NULL;
+	sys_vmctl(vmp->vm_endpoint, VMCTL_VMINHIBIT_CLEAR, 0);
+#endif
+}
+
 /*===========================================================================*
  *				pt_writemap		     		     *
  *===========================================================================*/
@@ -793,17 +961,16 @@ int pt_writemap(struct vmproc * vmp,
 /* Page directory and table entries for this virtual address. */
 	int p, pages;
 	int verify = 0;
+	int was_present = 0;
 	int ret = OK;
 
 #ifdef CONFIG_SMP
 	int vminhibit_clear = 0;
-	/* FIXME
-	 * don't do it everytime, stop the process only on the first change and
-	 * resume the execution on the last change. Do in a wrapper of this
-	 * function
+	/* Skip the stop/resume round trip if a pt_batch_start for this
+	 * process is active; the process is stopped already.
 	 */
 	if (vmp && vmp->vm_endpoint != NONE && vmp->vm_endpoint != VM_PROC_NR &&
-			!(vmp->vm_flags & VMF_EXITING)) {
+			!(vmp->vm_flags & VMF_EXITING) && vminhibit_vmp != vmp) {
 		sys_vmctl(vmp->vm_endpoint, VMCTL_VMINHIBIT_SET, 0);
 		vminhibit_clear = 1;
 	}
@@ -824,6 +991,41 @@ int pt_writemap(struct vmproc * vmp,
 	assert(physaddr == MAP_NONE || (flags & ARCH_VM_PTE_PRESENT));
 	assert(physaddr != MAP_NONE || !flags);
 
+#if defined(__i386__)
+	/* Demote any bigpage that this request changes only partially, or
+	 * whose individual entries it wants to inspect or modify, back into
+	 * a regular page table. A bigpage that is unmapped whole is handled
+	 * as such in the write loop below.
+	 */
+	{
+		int pde, first_pde, last_pde;
+
+		first_pde = ARCH_VM_PDE(v);
+		last_pde = ARCH_VM_PDE(v + VM_PAGE_SIZE*pages - 1);
+
+		for(pde = first_pde; pde <= last_pde; pde++) {
+			vir_bytes pde_v = (vir_bytes) pde * ARCH_BIG_PAGE_SIZE;
+			int covered;
+
+			if(!(pt->pt_dir[pde] & ARCH_VM_BIGPAGE))
+				continue;
+
+			covered = pde_v >= v && pde_v + ARCH_BIG_PAGE_SIZE <=
+				v + VM_PAGE_SIZE*pages;
+
+			if(covered && physaddr == MAP_NONE && !verify &&
+			   (writemapflags & WMF_OVERWRITE) &&
+			   !(writemapflags & (WMF_WRITEFLAGSONLY|WMF_FREE)))
+				continue;
+
+			if((ret = pt_demote_bigpage(pt, pde)) != OK) {
+				printf("VM: writemap: bigpage demotion failed\n");
+				goto resume_exit;
+			}
+		}
+	}
+#endif
+
 	/* First make sure all the necessary page tables are allocated,
 	 * before we start writing in any of them, because it's a pain
 	 * to undo our work properly.
@@ -847,8 +1049,28 @@ int pt_writemap(struct vmproc * vmp,
 		/* Page table has to be there. */
 		assert(pt->pt_dir[pde] & ARCH_VM_PDE_PRESENT);
 
+#if defined(__i386__)
+		if(pt->pt_dir[pde] & ARCH_VM_BIGPAGE) {
+			/* Only a bigpage that this request unmaps whole can
+			 * still be here; the demotion pass above split all
+			 * others. Clear the directory entry and skip over the
+			 * rest of the bigpage.
+			 */
+			int skip = ARCH_VM_PT_ENTRIES - pte;
+
+			assert(pte == 0);
+			assert(!(flags & ARCH_VM_PTE_PRESENT));
+			pt->pt_dir[pde] = 0;
+			was_present = 1;
+			p += skip - 1;
+			physaddr += skip * VM_PAGE_SIZE;
+			v += skip * VM_PAGE_SIZE;
+			continue;
+		}
+#else
 		/* We do not expect it to be a bigpage. */
 		assert(!(pt->pt_dir[pde] & ARCH_VM_BIGPAGE));
+#endif
 
 		/* Make sure page directory entry for this page table
 		 * is marked present and page table entry is available.
@@ -917,6 +1139,8 @@ int pt_writemap(struct vmproc * vmp,
 			}
 		} else {
 			/* Write pagetable entry. */
+			if(pt->pt_pt[pde][pte] & ARCH_VM_PTE_PRESENT)
+				was_present = 1;
 			pt->pt_pt[pde][pte] = entry;
 		}
 
@@ -926,6 +1150,15 @@ int pt_writemap(struct vmproc * vmp,
 
 resume_exit:
 
+	/* If live mappings were overwritten, the kernel must drop any address
+	 * translations it has cached for this process.  Fresh mappings need
+	 * no such call: an absent page cannot have produced a cached
+	 * translation.
+	 */
+	if(was_present && vmp && vmp->vm_endpoint != NONE &&
+			vmp->vm_endpoint != VM_PROC_NR)
+		sys_vmctl(vmp->vm_endpoint, VMCTL_PTCACHE_INVAL, 0);
+
 #ifdef CONFIG_SMP
 	if (vminhibit_clear) {
 		assert(vmp && vmp->vm_endpoint != NONE && vmp->vm_endpoint != VM_PROC_NR &&
@@ -961,6 +1194,18 @@ int pt_checkrange(pt_t *pt, vir_bytes v,  size_t bytes,
 		if(!(pt->pt_dir[pde] & ARCH_VM_PDE_PRESENT))
 			return EFAULT;
 
+#if defined(__i386__)
+		if(pt->pt_dir[pde] & ARCH_VM_BIGPAGE) {
+			/* The protection of a bigpage is in the
+			 * directory entry itself.
+			 */
+			if(write && !(pt->pt_dir[pde] & ARCH_VM_PTE_RW))
+				return EFAULT;
+			v += VM_PAGE_SIZE;
+			continue;
+		}
+#endif
+
 		/* Make sure page directory entry for this page table
 		 * is marked present and page table entry is available.
 		 */
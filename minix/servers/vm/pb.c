@@ -61,6 +61,14 @@ void pb_free(struct phys_block *pb)
 void pb_link(struct phys_region *newphysr, struct phys_block *newpb,
 	vir_bytes offset, struct vir_region *parent)
 {
+	/* If a page-out of this block is in flight, cancel it: the block is
+	 * gaining a reference (fork makes it copy-on-write shared), and the
+	 * write completion would free the frame even though it is now in use
+	 * through more than the mapping the page-out scan unmapped.
+	 */
+	if(newpb->refcount > 0 && (newpb->flags & PBF_PAGEOUT))
+		swap_pageout_cancel(newpb);
+
 USE(newphysr,
 	newphysr->offset = offset;
 	newphysr->ph = newpb;
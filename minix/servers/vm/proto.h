@@ -19,6 +19,7 @@ struct phys_region;
 /* acl.c */
 void acl_init(void);
 int acl_check(struct vmproc *vmp, int call);
+int acl_is_user(struct vmproc *vmp);
 void acl_set(struct vmproc *vmp, bitchunk_t *mask, int sys_proc);
 void acl_fork(struct vmproc *vmp);
 void acl_clear(struct vmproc *vmp);
@@ -28,8 +29,10 @@ void *reservedqueue_new(int, int, int, int);
 int reservedqueue_alloc(void *, phys_bytes *, void **);
 void reservedqueue_add(void *, void *, phys_bytes);
 void alloc_cycle(void);
+void scrub_cycle(void);
 void mem_sanitycheck(const char *file, int line);
 phys_clicks alloc_mem(phys_clicks clicks, u32_t flags);
+int mem_free_pages(void);
 void memstats(int *nodes, int *pages, int *largest);
 void printmemstats(void);
 void usedpages_reset(void);
@@ -76,6 +79,9 @@ int unmap_memory(endpoint_t sour, endpoint_t dest, vir_bytes virt_s,
 /* mmap.c */
 int do_mmap(message *msg);
 int do_munmap(message *msg);
+int do_madvise(message *msg);
+int do_mlock(message *msg);
+int do_mlockall(message *msg);
 int do_map_phys(message *msg);
 int do_unmap_phys(message *msg);
 int do_remap(message *m);
@@ -108,7 +114,10 @@ int pt_ptalloc_in_range(pt_t *pt, vir_bytes start, vir_bytes end, u32_t
 void pt_clearmapcache(void);
 int pt_writemap(struct vmproc * vmp, pt_t *pt, vir_bytes v, phys_bytes
 	physaddr, size_t bytes, u32_t flags, u32_t writemapflags);
+void pt_batch_start(struct vmproc *vmp);
+void pt_batch_end(struct vmproc *vmp);
 int pt_checkrange(pt_t *pt, vir_bytes v, size_t bytes, int write);
+void pt_bigpage_promote(pt_t *pt, vir_bytes v, size_t bytes);
 int pt_bind(pt_t *pt, struct vmproc *who);
 void *vm_mappages(phys_bytes p, int pages);
 void *vm_allocpage(phys_bytes *p, int cat);
@@ -151,6 +160,10 @@ int map_region_extend_upto_v(struct vmproc *vmp, vir_bytes vir);
 int map_unmap_region(struct vmproc *vmp, struct vir_region *vr,
 	vir_bytes offset, vir_bytes len);
 int map_unmap_range(struct vmproc *vmp, vir_bytes, vir_bytes);
+int map_madvise_release(struct vmproc *vmp, vir_bytes start, vir_bytes length);
+void map_set_pinned_range(struct vmproc *vmp, vir_bytes start,
+	vir_bytes length, int pin);
+void map_set_pinned_all(struct vmproc *vmp, int pin);
 int map_free_proc(struct vmproc *vmp);
 int map_proc_copy(struct vmproc *dst, struct vmproc *src);
 int map_proc_copy_range(struct vmproc *dst, struct vmproc *src, struct
@@ -177,6 +190,7 @@ int map_ph_writept(struct vmproc *vmp, struct vir_region *vr,
         struct phys_region *pr);
 
 struct vir_region* map_region_lookup_type(struct vmproc *vmp, u32_t flags);
+void region_gaps_recompute(struct vir_region *vr);
 int map_get_phys(struct vmproc *vmp, vir_bytes addr, phys_bytes *r);
 int map_get_ref(struct vmproc *vmp, vir_bytes addr, u8_t *cnt);
 unsigned int physregions(struct vir_region *vr);
@@ -235,14 +249,24 @@ void clear_cache_bydev(dev_t dev);
 
 /* vfs.c */
 int vfs_request(int reqno, int fd, struct vmproc *vmp, u64_t offset,
-	u32_t len, vfs_callback_t reply_callback, void *cbarg, void *state,
-	int statelen);
+	u32_t len, vir_bytes buf, vfs_callback_t reply_callback, void *cbarg,
+	void *state, int statelen);
 int do_vfs_reply(message *m);
 
+/* swap.c */
+int do_swapon(message *m);
+void swap_cycle(void);
+int swap_pagein(struct vmproc *vmp, struct phys_block *pb, u32_t allocflags,
+	vfs_callback_t cb, void *state, int statelen, int *io);
+void swap_pageout_cancel(struct phys_block *pb);
+void swap_slot_free(struct phys_block *pb);
+
 /* mem_file.c */
 int mappedfile_setfile(struct vmproc *owner, struct vir_region *region,
 	int fd, u64_t offset,
 	dev_t dev, ino_t ino, u16_t clearend, int prefill, int mayclose);
+void mappedfile_fault_around(struct vmproc *vmp, struct vir_region *region,
+	vir_bytes offset);
 
 /* fdref.c */
 struct fdref *fdref_new(struct vmproc *owner, ino_t ino, dev_t dev, int fd);
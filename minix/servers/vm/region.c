@@ -145,6 +145,10 @@ static int map_sanitycheck_pt(struct vmproc *vmp,
 	int rw;
 	int r;
 
+	/* Swapped-out blocks have no page table entry to verify. */
+	if(pb->flags & PBF_SWAPPED)
+		return OK;
+
 	if(pr_writable(vr, pr))
 		rw = PTF_WRITE;
 	else
@@ -215,7 +219,14 @@ void map_sanitycheck(const char *file, int line)
 			MYASSERT(vr->vaddr + vr->length <= nextvr->vaddr);
 		}
 		}
-		MYASSERT(!(vr->vaddr % VM_PAGE_SIZE));,	
+		{ vir_bytes a_minv = vr->sub_minv, a_maxend = vr->sub_maxend,
+			a_maxgap = vr->sub_maxgap;
+		region_gaps_recompute(vr);
+		MYASSERT(vr->sub_minv == a_minv);
+		MYASSERT(vr->sub_maxend == a_maxend);
+		MYASSERT(vr->sub_maxgap == a_maxgap);
+		}
+		MYASSERT(!(vr->vaddr % VM_PAGE_SIZE));,
 		if(pr->ph->flags & PBF_INCACHE) pr->ph->seencount++;
 		if(pr->ph->refcount != pr->ph->seencount) {
 			map_printmap(vmp);
@@ -268,6 +279,29 @@ int map_ph_writept(struct vmproc *vmp, struct vir_region *vr,
 	assert(!(pr->offset % VM_PAGE_SIZE));
 	assert(pb->refcount > 0);
 
+	/* Re-establishing a mapping for a block whose page-out write is still
+	 * in flight would let the frame be accessed - and then freed by the
+	 * write completion - while mapped. Cancel the page-out instead; the
+	 * frame is still intact at this point. This covers fork, which
+	 * write-protects the parent's pages and copies its page tables into
+	 * the child while a page-out may be under way.
+	 */
+	if(pb->flags & PBF_PAGEOUT)
+		swap_pageout_cancel(pb);
+
+	/* A swapped-out block has no page frame. Clear the mapping instead,
+	 * so that the next access faults and triggers a page-in.
+	 */
+	if(pb->flags & PBF_SWAPPED) {
+		if(pt_writemap(vmp, &vmp->vm_pt, vr->vaddr + pr->offset,
+				MAP_NONE, VM_PAGE_SIZE, 0,
+				WMF_OVERWRITE) != OK) {
+			printf("VM: map_writept: pt_writemap failed\n");
+			return ENOMEM;
+		}
+		return OK;
+	}
+
 	if(pr_writable(vr, pr))
 		flags |= PTF_WRITE;
 	else
@@ -294,8 +328,67 @@ int map_ph_writept(struct vmproc *vmp, struct vir_region *vr,
 	return OK;
 }
 
+/*===========================================================================*
+ *				region_gaps_recompute			     *
+ *===========================================================================*/
+void region_gaps_recompute(struct vir_region *vr)
+{
+/* Recompute the augmented subtree data of this AVL node from its own
+ * address range and that of its children. The AVL code invokes this
+ * through the AVL_SET_LESS/AVL_SET_GREATER macros whenever it changes
+ * a child pointer, which keeps the data consistent through removals
+ * and rotations; insertions and region resizes additionally require a
+ * region_fix_gaps() pass over the search path, as the AVL code does
+ * not revisit ancestors it leaves untouched.
+ */
+	vir_bytes minv, maxend, maxgap = 0, gap;
+
+	minv = vr->lower ? vr->lower->sub_minv : vr->vaddr;
+	maxend = vr->higher ? vr->higher->sub_maxend : vr->vaddr + vr->length;
+
+	if(vr->lower) {
+		maxgap = vr->lower->sub_maxgap;
+		gap = vr->vaddr - vr->lower->sub_maxend;
+		if(gap > maxgap)
+			maxgap = gap;
+	}
+	if(vr->higher) {
+		if(vr->higher->sub_maxgap > maxgap)
+			maxgap = vr->higher->sub_maxgap;
+		gap = vr->higher->sub_minv - (vr->vaddr + vr->length);
+		if(gap > maxgap)
+			maxgap = gap;
+	}
+
+	USE(vr,
+	vr->sub_minv = minv;
+	vr->sub_maxend = maxend;
+	vr->sub_maxgap = maxgap;);
+}
+
+/*===========================================================================*
+ *				region_fix_gaps				     *
+ *===========================================================================*/
+static void region_fix_gaps(struct vir_region *vr, vir_bytes vaddr)
+{
+/* Recompute, bottom-up, the augmented gap data on the search path
+ * towards the given address. Called after a region has been inserted
+ * or has changed size.
+ */
+	if(!vr)
+		return;
+	if(vaddr < vr->vaddr)
+		region_fix_gaps(vr->lower, vaddr);
+	else if(vaddr > vr->vaddr)
+		region_fix_gaps(vr->higher, vaddr);
+	region_gaps_recompute(vr);
+}
+
 #define SLOT_FAIL ((vir_bytes) -1)
 
+static int region_gaps_search(struct vir_region *vr, vir_bytes minv,
+	vir_bytes maxv, vir_bytes length, vir_bytes *found);
+
 /*===========================================================================*
  *				region_find_slot_range			     *
  *===========================================================================*/
@@ -368,14 +461,22 @@ static vir_bytes region_find_slot_range(struct vmproc *vmp,
 	}
 
 	if(!foundflag) {
-		struct vir_region *vr;
-		while((vr = region_get_iter(&iter)) && !foundflag) {
-			struct vir_region *nextvr;
-			region_decr_iter(&iter);
-			nextvr = region_get_iter(&iter);
-			FREEVRANGE(nextvr ? nextvr->vaddr+nextvr->length : 0,
-			  vr->vaddr);
-		}
+		struct vir_region *root = vmp->vm_regions_avl.root;
+
+		/* Find the highest gap between two regions that satisfies
+		 * the request, guided by the augmented subtree data in the
+		 * nodes, so that subtrees without a large enough gap are
+		 * skipped entirely.
+		 */
+		if(root && region_gaps_search(root, minv, maxv, length,
+			&startv))
+			foundflag = 1;
+
+		/* The range below the lowest region is not a gap between
+		 * two regions; try it separately.
+		 */
+		if(!foundflag && root)
+			FREEVRANGE(0, root->sub_minv);
 	}
 
 	if(!foundflag) {
@@ -415,6 +516,52 @@ static vir_bytes region_find_slot(struct vmproc *vmp,
 	return region_find_slot_range(vmp, minv, maxv, length);
 }
 
+/*===========================================================================*
+ *				region_gaps_search			     *
+ *===========================================================================*/
+static int region_gaps_search(struct vir_region *vr, vir_bytes minv,
+	vir_bytes maxv, vir_bytes length, vir_bytes *found)
+{
+/* Find the highest gap between two neighbouring regions in this subtree
+ * that satisfies a region_find_slot_range() request, in O(log n) in the
+ * common case: the sub_maxgap data prunes subtrees without a fitting
+ * gap, and sub_minv/sub_maxend prune subtrees outside the range.
+ */
+	vir_bytes startv = 0;
+	int foundflag = 0;
+
+	if(!vr || vr->sub_maxgap < length)
+		return 0;
+	if(vr->sub_minv >= maxv || vr->sub_maxend <= minv)
+		return 0;
+
+	/* Try the highest addresses first: the gaps in the higher subtree,
+	 * then the gap between this region and the higher subtree, then
+	 * the gap between the lower subtree and this region, and finally
+	 * the gaps in the lower subtree.
+	 */
+	if(region_gaps_search(vr->higher, minv, maxv, length, found))
+		return 1;
+
+	if(vr->higher) {
+		FREEVRANGE(vr->vaddr + vr->length, vr->higher->sub_minv);
+		if(foundflag) {
+			*found = startv;
+			return 1;
+		}
+	}
+
+	if(vr->lower) {
+		FREEVRANGE(vr->lower->sub_maxend, vr->vaddr);
+		if(foundflag) {
+			*found = startv;
+			return 1;
+		}
+	}
+
+	return region_gaps_search(vr->lower, minv, maxv, length, found);
+}
+
 static unsigned int phys_slot(vir_bytes len)
 {
 	assert(!(len % VM_PAGE_SIZE));
@@ -505,6 +652,7 @@ struct vir_region *map_page_region(struct vmproc *vmp, vir_bytes minv,
 
 	/* Link it. */
 	region_insert(&vmp->vm_regions_avl, newregion);
+	region_fix_gaps(vmp->vm_regions_avl.root, newregion->vaddr);
 
 #if SANITYCHECKS
 	assert(startv == newregion->vaddr);
@@ -765,10 +913,26 @@ int map_handle_memory(struct vmproc *vmp,
 	lim = start_offset + length;
 	assert(lim > start_offset);
 
+	pt_batch_start(vmp);
+
 	for(offset = start_offset; offset < lim; offset += VM_PAGE_SIZE)
 		if((r = map_pf(vmp, region, offset, write,
-		   cb, state, statelen, &io)) != OK)
+		   cb, state, statelen, &io)) != OK) {
+			pt_batch_end(vmp);
 			return r;
+		}
+
+	pt_batch_end(vmp);
+
+#if defined(__i386__)
+	/* A large stretch that is now fully mapped may be eligible for 4 MB
+	 * bigpage mappings if it is physically contiguous, as with MAP_CONTIG
+	 * memory.
+	 */
+	if(length >= ARCH_BIG_PAGE_SIZE)
+		pt_bigpage_promote(&vmp->vm_pt, region->vaddr + start_offset,
+			length);
+#endif
 
 	return OK;
 }
@@ -969,6 +1133,7 @@ int map_proc_copy_range(struct vmproc *dst, struct vmproc *src,
 			return ENOMEM;
 		}
 		region_insert(&dst->vm_regions_avl, newvr);
+		region_fix_gaps(dst->vm_regions_avl.root, newvr->vaddr);
 		assert(vr->length == newvr->length);
 
 #if SANITYCHECKS
@@ -992,8 +1157,46 @@ int map_proc_copy_range(struct vmproc *dst, struct vmproc *src,
 		region_incr_iter(&v_iter);
 	}
 
-	map_writept(src);
-	map_writept(dst);
+	/* Write-protect the source's writable regions, so that writes to the
+	 * now-shared pages fault and get copied. Read-only regions (text,
+	 * shared libraries) already have the right page table entries, so
+	 * leave them untouched. The destination then gets a verbatim copy of
+	 * the relevant page table ranges, which is much cheaper than
+	 * rebuilding them with one pt_writemap() call per page.
+	 */
+	region_start_iter(&src->vm_regions_avl, &v_iter,
+		start_src_vr->vaddr, AVL_EQUAL);
+	while((vr = region_get_iter(&v_iter))) {
+		vir_bytes last = vr->vaddr + vr->length - VM_PAGE_SIZE;
+
+		if(vr->flags & VR_WRITABLE) {
+			struct phys_region *ph;
+			vir_bytes p;
+
+			for(p = 0; p < vr->length; p += VM_PAGE_SIZE) {
+				if(!(ph = physblock_get(vr, p))) continue;
+				if(map_ph_writept(src, vr, ph) != OK)
+					printf("VM: map_writept: failed\n");
+			}
+		}
+
+		/* 'last' of zero would make pt_map_in_range() cover the whole
+		 * address space; a region that both starts at address zero and
+		 * is a single page long has nothing mapped above it anyway.
+		 */
+		if(pt_ptalloc_in_range(&dst->vm_pt, vr->vaddr,
+		   vr->vaddr + vr->length, 0, 0) != OK ||
+		   (last != 0 && pt_map_in_range(src, dst, vr->vaddr,
+		   last) != OK)) {
+			map_free_proc(dst);
+			return ENOMEM;
+		}
+
+		if(vr == end_src_vr) {
+			break;
+		}
+		region_incr_iter(&v_iter);
+	}
 
 	SANITYCHECK(SCL_FUNCTIONS);
 	return OK;
@@ -1056,6 +1259,11 @@ int map_region_extend_upto_v(struct vmproc *vmp, vir_bytes v)
 
 	r = vr->def_memtype->ev_resize(vmp, vr, offset - vr->vaddr);
 
+	/* The region may have changed size; update the gap data on its
+	 * search path.
+	 */
+	region_fix_gaps(vmp->vm_regions_avl.root, vr->vaddr);
+
 	return r;
 }
 
@@ -1129,9 +1337,11 @@ int map_unmap_region(struct vmproc *vmp, struct vir_region *r,
 			memmove(r->physblocks, r->physblocks + freeslots,
 				remslots * sizeof(struct phys_region *));
 		USE(r, r->length -= len;);
+		region_fix_gaps(vmp->vm_regions_avl.root, r->vaddr);
 	} else if(offset + len == r->length) {
 		assert(len <= r->length);
 		r->length -= len;
+		region_fix_gaps(vmp->vm_regions_avl.root, r->vaddr);
 	}
 
 	SANITYCHECK(SCL_DETAIL);
@@ -1203,7 +1413,9 @@ static int split_region(struct vmproc *vmp, struct vir_region *vr,
 	region_remove(&vmp->vm_regions_avl, vr->vaddr);
 	map_free(vr);
 	region_insert(&vmp->vm_regions_avl, r1);
+	region_fix_gaps(vmp->vm_regions_avl.root, r1->vaddr);
 	region_insert(&vmp->vm_regions_avl, r2);
+	region_fix_gaps(vmp->vm_regions_avl.root, r2->vaddr);
 
 	*vr1 = r1;
 	*vr2 = r2;
@@ -1297,6 +1509,129 @@ int map_unmap_range(struct vmproc *vmp, vir_bytes unmap_start, vir_bytes length)
 
 }
 
+/*========================================================================*
+ *			     map_madvise_release	     	  	*
+ *========================================================================*/
+int map_madvise_release(struct vmproc *vmp, vir_bytes start, vir_bytes length)
+{
+/* Return the memory backing the given range to the allocator, without
+ * changing the region layout: the range stays mapped and faults in fresh
+ * (zeroes for anonymous memory, file contents for mapped files) when it is
+ * touched again. Region types that cannot refault their contents are
+ * silently skipped; madvise() is advisory.
+ */
+	vir_bytes limit;
+	region_iter v_iter;
+	struct vir_region *vr;
+
+	assert(!(start % VM_PAGE_SIZE));
+	assert(!(length % VM_PAGE_SIZE));
+
+	limit = start + length;
+	if(limit <= start) return EINVAL;
+
+	region_start_iter(&vmp->vm_regions_avl, &v_iter, start,
+		AVL_LESS_EQUAL);
+	if(!(vr = region_get_iter(&v_iter))) {
+		region_start_iter(&vmp->vm_regions_avl, &v_iter, start,
+			AVL_GREATER);
+		if(!(vr = region_get_iter(&v_iter)))
+			return OK;
+	}
+
+	for(; vr && vr->vaddr < limit; vr = region_get_iter(&v_iter)) {
+		vir_bytes thislimit = vr->vaddr + vr->length;
+		vir_bytes this_start, this_limit;
+
+		region_incr_iter(&v_iter);
+
+		this_start = MAX(start, vr->vaddr);
+		this_limit = MIN(limit, thislimit);
+		if(this_start >= this_limit) continue;
+
+		if(vr->def_memtype != &mem_type_anon &&
+		   vr->def_memtype != &mem_type_mappedfile)
+			continue;
+
+		/* Shared memory must keep its contents. */
+		if(vr->flags & VR_SHARED)
+			continue;
+
+		map_subfree(vr, this_start - vr->vaddr,
+			this_limit - this_start);
+
+		if(pt_writemap(vmp, &vmp->vm_pt, this_start, MAP_NONE,
+		   this_limit - this_start, 0, WMF_OVERWRITE) != OK) {
+			printf("VM: map_madvise_release: pt_writemap failed\n");
+			return ENOMEM;
+		}
+	}
+
+	return OK;
+}
+
+/*========================================================================*
+ *			     map_set_pinned_range	     	  	*
+ *========================================================================*/
+void map_set_pinned_range(struct vmproc *vmp, vir_bytes start,
+	vir_bytes length, int pin)
+{
+/* Set or clear VR_PINNED on all regions overlapping the given range.
+ * Pinning is per region: a range covering part of a region pins the whole
+ * region, which errs on the safe side.
+ */
+	vir_bytes limit;
+	region_iter v_iter;
+	struct vir_region *vr;
+
+	assert(!(start % VM_PAGE_SIZE));
+	assert(!(length % VM_PAGE_SIZE));
+
+	limit = start + length;
+
+	region_start_iter(&vmp->vm_regions_avl, &v_iter, start,
+		AVL_LESS_EQUAL);
+	if(!(vr = region_get_iter(&v_iter))) {
+		region_start_iter(&vmp->vm_regions_avl, &v_iter, start,
+			AVL_GREATER);
+		if(!(vr = region_get_iter(&v_iter)))
+			return;
+	}
+
+	for(; vr && vr->vaddr < limit; vr = region_get_iter(&v_iter)) {
+		region_incr_iter(&v_iter);
+
+		if(vr->vaddr + vr->length <= start) continue;
+
+		if(pin) {
+			USE(vr, vr->flags |= VR_PINNED;);
+		} else {
+			USE(vr, vr->flags &= ~VR_PINNED;);
+		}
+	}
+}
+
+/*========================================================================*
+ *			     map_set_pinned_all		     	  	*
+ *========================================================================*/
+void map_set_pinned_all(struct vmproc *vmp, int pin)
+{
+/* Set or clear VR_PINNED on all of a process's regions, for mlockall(). */
+	region_iter v_iter;
+	struct vir_region *vr;
+
+	region_start_iter_least(&vmp->vm_regions_avl, &v_iter);
+	while((vr = region_get_iter(&v_iter))) {
+		region_incr_iter(&v_iter);
+
+		if(pin) {
+			USE(vr, vr->flags |= VR_PINNED;);
+		} else {
+			USE(vr, vr->flags &= ~VR_PINNED;);
+		}
+	}
+}
+
 /*========================================================================*
  *			  map_region_lookup_type			  *
  *========================================================================*/
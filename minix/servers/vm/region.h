@@ -33,6 +33,13 @@ struct phys_block {
 };
 
 #define PBF_INCACHE		0x01
+#define PBF_SWAPPED		0x02	/* contents are on swap; the 'phys'
+					 * field holds the byte offset into
+					 * the swap space instead of a frame
+					 */
+#define PBF_PAGEOUT		0x04	/* a page-out of this block is in
+					 * flight; the frame is still valid
+					 */
 
 typedef struct vir_region {
 	vir_bytes	vaddr;	/* virtual address, offset from pagetable */
@@ -63,6 +70,16 @@ typedef struct vir_region {
 	/* AVL fields */
 	struct vir_region *lower, *higher;
 	int		factor;
+
+	/* Augmented per-subtree data, kept up to date by region.c, for
+	 * free virtual address range searches without visiting every
+	 * region.
+	 */
+	vir_bytes	sub_minv;	/* lowest vaddr in this subtree */
+	vir_bytes	sub_maxend;	/* highest vaddr+length in subtree */
+	vir_bytes	sub_maxgap;	/* largest gap between neighbouring
+					 * regions in this subtree
+					 */
 } region_t;
 
 /* Mapping flags: */
@@ -72,6 +89,7 @@ typedef struct vir_region {
 #define VR_LOWER1MB	0x010
 #define VR_SHARED	0x040
 #define VR_UNINITIALIZED 0x080	/* Do not clear after allocation  */
+#define VR_PINNED	0x800	/* mlock()ed; exempt from page-out */
 
 /* Mapping type: */
 #define VR_ANON		0x100	/* Memory to be cleared and allocated */
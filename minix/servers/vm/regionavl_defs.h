@@ -7,8 +7,15 @@
 #define AVL_NULL NULL
 #define AVL_GET_LESS(h, a) (h)->lower
 #define AVL_GET_GREATER(h, a) (h)->higher
-#define AVL_SET_LESS(h1, h2) USE((h1), (h1)->lower = h2;);
-#define AVL_SET_GREATER(h1, h2) USE((h1), (h1)->higher = h2;);
+/* Whenever the AVL code rewires a child pointer (insertion, removal,
+ * rotation), recompute the augmented subtree gap data of the node; the
+ * AVL code changes child pointers bottom-up, so children are final by
+ * the time their parent is set. See region_gaps_recompute() in region.c.
+ */
+#define AVL_SET_LESS(h1, h2) USE((h1), (h1)->lower = h2; \
+	region_gaps_recompute(h1););
+#define AVL_SET_GREATER(h1, h2) USE((h1), (h1)->higher = h2; \
+	region_gaps_recompute(h1););
 #define AVL_GET_BALANCE_FACTOR(h) (h)->factor
 #define AVL_SET_BALANCE_FACTOR(h, f) USE((h), (h)->factor = f;);
 #define AVL_SET_ROOT(h, v) (h)->root = v;
@@ -28,6 +28,16 @@
 
 #define SLABSIZES 200
 
+/* Per-size magazines: small stacks of recently freed objects, so that the
+ * frequent allocate/free pairs for the same object sizes (regions, phys
+ * regions, phys blocks) are satisfied in constant time, without walking slab
+ * lists or scanning use bitmaps. Objects in a magazine stay marked in use in
+ * their slab page; a full magazine is drained back into the slabs in batches
+ * of half its capacity. Under SANITYCHECKS the magazines are disabled, so
+ * that every allocation and free goes through the full checking paths.
+ */
+#define MAGSIZE 16
+
 #define ITEMSPERPAGE(bytes) (int)(DATABYTES / (bytes))
 
 #define ELBITS		(sizeof(element_t)*8)
@@ -122,6 +132,10 @@ struct slabdata {
 
 static struct slabheader {
 	struct slabdata *list_head;
+#if !SANITYCHECKS
+	int magcount;
+	void *magazine[MAGSIZE];
+#endif
 } slabs[SLABSIZES];
 
 static int objstats(void *, int, struct slabheader **, struct slabdata
@@ -272,6 +286,15 @@ void *slaballoc(int bytes)
 	GETSLAB(bytes, s);
 	assert(s);
 
+#if !SANITYCHECKS
+	/* Satisfy the common case from the magazine. */
+	if(s->magcount > 0) {
+		ret = s->magazine[--s->magcount];
+		assert(!((vir_bytes) ret % OBJALIGN));
+		return ret;
+	}
+#endif
+
 	if(!(newslab = s->list_head)) {
 		/* Make sure there is something on the freelist. */
 		newslab = newslabdata();
@@ -401,18 +424,15 @@ static inline int objstats(void *mem, int bytes,
 }
 
 /*===========================================================================*
- *				void *slabfree				     *
+ *				void slabfree_object			     *
  *===========================================================================*/
-void slabfree(void *mem, int bytes)
+static void slabfree_object(void *mem, int bytes)
 {
+/* Return an object to its slab page; 'bytes' has been rounded already. */
 	int i;
 	struct slabheader *s;
 	struct slabdata *f;
 
-	bytes = roundup(bytes, OBJALIGN);
-
-	SLABSANITYCHECK(SCL_FUNCTIONS);
-
 	if(objstats(mem, bytes, &s, &f, &i) != OK) {
 		panic("slabfree objstats failed");
 	}
@@ -452,6 +472,37 @@ void slabfree(void *mem, int bytes)
 		ADDHEAD(f, s);
 	}
 
+	return;
+}
+
+/*===========================================================================*
+ *				void slabfree				     *
+ *===========================================================================*/
+void slabfree(void *mem, int bytes)
+{
+	bytes = roundup(bytes, OBJALIGN);
+
+	SLABSANITYCHECK(SCL_FUNCTIONS);
+
+#if !SANITYCHECKS
+	{
+		struct slabheader *s;
+
+		GETSLAB(bytes, s);
+
+		/* Make room by draining half of a full magazine. */
+		if(s->magcount >= MAGSIZE) {
+			while(s->magcount > MAGSIZE/2)
+				slabfree_object(s->magazine[--s->magcount],
+					bytes);
+		}
+
+		s->magazine[s->magcount++] = mem;
+	}
+#else
+	slabfree_object(mem, bytes);
+#endif
+
 	SLABSANITYCHECK(SCL_FUNCTIONS);
 
 	return;
@@ -0,0 +1,526 @@
+
+/* This file implements paging anonymous memory out to swap space.
+ *
+ * Swap space is a file or block device that a privileged process opens and
+ * hands to VM with the VM_SWAPON call. VM imports the file descriptor with a
+ * VMVFSREQ_FDLOOKUP request, exactly as it does for memory-mapped files, and
+ * from then on owns it. All swap I/O then goes through the asynchronous
+ * VM-to-VFS request path in vfs.c: VM must never make blocking calls to VFS,
+ * as VFS itself can get blocked on VM at any time.
+ *
+ * Page-out is driven from the main loop: when the number of free pages drops
+ * below a threshold, swap_cycle() picks an anonymous page from a user
+ * process, unmaps it, copies it into a holding buffer and sends an
+ * asynchronous write request (VMVFSREQ_FDWRITE) to VFS. When the write
+ * completes, the page frame is freed and the phys block is marked PBF_SWAPPED
+ * with its 'phys' field holding the byte offset into the swap space. Any
+ * page fault on the block while the write is in flight cancels the page-out;
+ * the frame is still intact at that point, so cancellation costs nothing.
+ *
+ * Page-in happens from the anonymous page fault handler: faults on a
+ * PBF_SWAPPED block call swap_pagein(), which has VFS peek the page from the
+ * swap space (VMVFSREQ_FDIO) into the VM cache, suspending the fault just
+ * like a fault on a memory-mapped file. When the fault is retried, the page
+ * is copied out of the cache into a fresh frame and the swap slot is freed.
+ */
+
+#define _SYSTEM 1
+
+#include <minix/com.h>
+#include <minix/callnr.h>
+#include <minix/type.h>
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/sysutil.h>
+#include <minix/syslib.h>
+#include <minix/debug.h>
+#include <minix/bitmap.h>
+
+#include <sys/mman.h>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "vm.h"
+#include "proto.h"
+#include "util.h"
+#include "glo.h"
+#include "region.h"
+#include "sanitycheck.h"
+#include "cache.h"
+#include "regionavl.h"
+
+/* Page-out starts when fewer than this many pages are free, and one page is
+ * written out per main loop iteration until the pressure is gone. Keeping
+ * only a single write in flight bounds the bookkeeping to one holding buffer
+ * and makes cancellation trivial.
+ */
+#define SWAP_LOWWATER_PAGES	1024
+
+/* Consecutive write failures after which the swap space is abandoned. */
+#define SWAP_MAX_ERRORS		5
+
+int swap_enabled = 0;		/* checked by the main loop */
+
+static int swap_fd = -1;	/* swap file descriptor, in VM's own fproc */
+static dev_t swap_dev;		/* device holding the swap space */
+static ino_t swap_ino;		/* inode; VMC_NO_INODE for block devices */
+
+static bitchunk_t *swap_bitmap;	/* bit set: slot in use */
+static u32_t swap_slots;	/* total number of page-sized swap slots */
+static u32_t swap_slots_free;	/* number of free swap slots */
+static u32_t swap_nextslot;	/* allocation scan position */
+
+static int swapon_inflight;	/* a VM_SWAPON lookup is outstanding */
+
+/* The page-out holding buffer, and the state of the in-flight write. The
+ * buffer is needed because the victim frame may be modified, or even freed,
+ * between the write request and its completion; its contents are therefore
+ * snapshotted first. swout_pb is set to NULL if the page-out is canceled
+ * while the write is in flight.
+ */
+static unsigned char *swout_buf;
+static phys_bytes swout_buf_phys;
+static struct phys_block *swout_pb;
+static u32_t swout_slot;
+static int swout_busy;
+static int swap_errors;
+
+/* Page-out victim scan position, so that successive scans cycle through all
+ * processes and all their pages instead of hammering the first candidate.
+ */
+static int scan_proc;
+static vir_bytes scan_vaddr;
+
+/*===========================================================================*
+ *				slot_alloc				     *
+ *===========================================================================*/
+static int slot_alloc(u32_t *slotp)
+{
+	u32_t i, slot;
+
+	if(!swap_slots_free)
+		return ENOSPC;
+
+	for(i = 0; i < swap_slots; i++) {
+		slot = swap_nextslot;
+		if(++swap_nextslot >= swap_slots)
+			swap_nextslot = 0;
+		if(!GET_BIT(swap_bitmap, slot)) {
+			SET_BIT(swap_bitmap, slot);
+			swap_slots_free--;
+			*slotp = slot;
+			return OK;
+		}
+	}
+
+	panic("swap: no slot found with %u free", swap_slots_free);
+}
+
+/*===========================================================================*
+ *				slot_free				     *
+ *===========================================================================*/
+static void slot_free(u32_t slot)
+{
+	assert(slot < swap_slots);
+	assert(GET_BIT(swap_bitmap, slot));
+	UNSET_BIT(swap_bitmap, slot);
+	swap_slots_free++;
+}
+
+/*===========================================================================*
+ *				swap_slot_free				     *
+ *===========================================================================*/
+void swap_slot_free(struct phys_block *pb)
+{
+/* The last reference to a swapped-out block is gone; release its slot. */
+	assert(pb->flags & PBF_SWAPPED);
+	slot_free(pb->phys / VM_PAGE_SIZE);
+	pb->flags &= ~PBF_SWAPPED;
+	pb->phys = MAP_NONE;
+}
+
+/*===========================================================================*
+ *				swapon_done				     *
+ *===========================================================================*/
+static void swapon_done(struct vmproc *vmp, message *replymsg, void *cbarg,
+	void *origmsg_v)
+{
+/* VFS has replied to the VMVFSREQ_FDLOOKUP request for the swap space. */
+	message *origmsg = (message *) origmsg_v;
+	message reply;
+	u64_t size;
+	int result;
+
+	assert(swapon_inflight);
+	swapon_inflight = 0;
+
+	result = replymsg->VMV_RESULT;
+
+	if(result == OK) {
+		size = (u64_t)replymsg->VMV_SIZE_PAGES * VM_PAGE_SIZE;
+		if(origmsg->m_lc_vm_swapon.size &&
+		   origmsg->m_lc_vm_swapon.size < size)
+			size = origmsg->m_lc_vm_swapon.size;
+
+		if(size < VM_PAGE_SIZE)
+			result = EINVAL;
+	}
+
+	if(result == OK) {
+		swap_slots = size / VM_PAGE_SIZE;
+		swap_bitmap = calloc(BITMAP_CHUNKS(swap_slots),
+			sizeof(bitchunk_t));
+		if(!swap_bitmap)
+			result = ENOMEM;
+	}
+
+	if(result == OK && !swout_buf) {
+		swout_buf = vm_allocpage(&swout_buf_phys, VMP_SPARE);
+		if(!swout_buf) {
+			free(swap_bitmap);
+			swap_bitmap = NULL;
+			result = ENOMEM;
+		}
+	}
+
+	if(result == OK) {
+		swap_fd = replymsg->VMV_FD;
+		swap_dev = replymsg->VMV_DEV;
+		swap_ino = replymsg->VMV_INO;
+		swap_slots_free = swap_slots;
+		swap_nextslot = 0;
+		swap_errors = 0;
+		swap_enabled = 1;
+
+		printf("VM: swap space enabled, %u pages\n", swap_slots);
+	} else if(replymsg->VMV_RESULT == OK && vmp != NULL) {
+		/* The lookup succeeded but setup failed; close our copy of
+		 * the file descriptor again.
+		 */
+		if(vfs_request(VMVFSREQ_FDCLOSE, replymsg->VMV_FD, vmp,
+			0, 0, 0, NULL, NULL, NULL, 0) != OK)
+			printf("VM: swap: could not close fd\n");
+	}
+
+	/* Unblock the caller, unless it has exited in the meantime. */
+	if(vmp != NULL) {
+		memset(&reply, 0, sizeof(reply));
+		reply.m_type = result;
+
+		if(ipc_send(vmp->vm_endpoint, &reply) != OK)
+			panic("VM: swapon_done: ipc_send() failed");
+	}
+}
+
+/*===========================================================================*
+ *				do_swapon				     *
+ *===========================================================================*/
+int do_swapon(message *m)
+{
+	struct vmproc *vmp;
+	int n;
+
+	if(swap_enabled || swapon_inflight)
+		return EBUSY;
+
+	if(vm_isokendpt(m->m_source, &n) != OK)
+		panic("do_swapon: message from strange source: %d",
+			m->m_source);
+
+	vmp = &vmproc[n];
+
+	if(vfs_request(VMVFSREQ_FDLOOKUP, m->m_lc_vm_swapon.fd, vmp, 0, 0, 0,
+		swapon_done, NULL, m, sizeof(*m)) != OK) {
+		printf("VM: vfs_request for swapon failed\n");
+		return ENXIO;
+	}
+
+	swapon_inflight = 1;
+
+	/* Request queued; don't reply. */
+	return SUSPEND;
+}
+
+/*===========================================================================*
+ *				swap_pagein				     *
+ *===========================================================================*/
+int swap_pagein(struct vmproc *vmp, struct phys_block *pb, u32_t allocflags,
+	vfs_callback_t cb, void *state, int statelen, int *io)
+{
+/* Handle a page fault on a swapped-out anonymous block. If the page is in
+ * the VM cache, restore it to a fresh frame and free its swap slot.
+ * Otherwise, have VFS peek it from the swap space into the cache, and
+ * suspend the fault; the retry will find the page in the cache.
+ */
+	struct cached_page *cp;
+	phys_bytes new_page, new_page_cl;
+	u64_t offset;
+
+	assert(pb->flags & PBF_SWAPPED);
+	assert(swap_fd >= 0);
+
+	offset = pb->phys;
+
+	if(swap_ino == VMC_NO_INODE)
+		cp = find_cached_page_bydev(swap_dev, offset, VMC_NO_INODE,
+			0, 1);
+	else
+		cp = find_cached_page_byino(swap_dev, swap_ino, offset, 1);
+
+	if(cp) {
+		if((new_page_cl = alloc_mem(1, allocflags)) == NO_MEM) {
+			printf("swap_pagein: out of memory\n");
+			return ENOMEM;
+		}
+		new_page = CLICK2ABS(new_page_cl);
+
+		if(sys_abscopy(cp->page->phys, new_page, VM_PAGE_SIZE) != OK)
+			panic("swap_pagein: abscopy failed");
+
+		/* Drop the cached copy right away: the slot is freed below
+		 * and may be rewritten with other contents, and the page
+		 * will not be faulted from the cache again.
+		 */
+		rmcache(cp);
+
+		slot_free(offset / VM_PAGE_SIZE);
+
+		pb->phys = new_page;
+		pb->flags &= ~PBF_SWAPPED;
+
+		return OK;
+	}
+
+	if(!cb)
+		return EFAULT;
+
+	if(vfs_request(VMVFSREQ_FDIO, swap_fd, vmp, offset, VM_PAGE_SIZE, 0,
+		cb, NULL, state, statelen) != OK) {
+		printf("VM: swap_pagein: vfs_request failed\n");
+		return ENOMEM;
+	}
+
+	*io = 1;
+	return SUSPEND;
+}
+
+/*===========================================================================*
+ *				swap_pageout_cancel			     *
+ *===========================================================================*/
+void swap_pageout_cancel(struct phys_block *pb)
+{
+/* The block is referenced (or dies) while its page-out write is in flight.
+ * The frame is still valid, so simply forget about the page-out; the write
+ * completion will release the swap slot.
+ */
+	assert(pb->flags & PBF_PAGEOUT);
+	assert(swout_pb == pb);
+
+	pb->flags &= ~PBF_PAGEOUT;
+	swout_pb = NULL;
+}
+
+/*===========================================================================*
+ *				swout_done				     *
+ *===========================================================================*/
+static void swout_done(struct vmproc *vmp, message *replymsg, void *cbarg,
+	void *state)
+{
+/* VFS has replied to the page-out write request. */
+	struct phys_block *pb;
+
+	assert(swout_busy);
+	swout_busy = 0;
+
+	if(!(pb = swout_pb)) {
+		/* The page-out was canceled while the write was in flight. */
+		slot_free(swout_slot);
+		return;
+	}
+
+	swout_pb = NULL;
+
+	assert(pb->flags & PBF_PAGEOUT);
+	pb->flags &= ~PBF_PAGEOUT;
+
+	if(replymsg->VMV_RESULT != VM_PAGE_SIZE) {
+		printf("VM: swap: write to slot %u failed (%d)\n", swout_slot,
+			replymsg->VMV_RESULT);
+		slot_free(swout_slot);
+
+		/* The page simply stays in memory; its mappings are rebuilt
+		 * on the next fault. Give up on a swap space that keeps
+		 * failing, rather than retrying it forever.
+		 */
+		if(++swap_errors >= SWAP_MAX_ERRORS) {
+			printf("VM: swap: too many errors, disabling swap\n");
+			swap_enabled = 0;
+		}
+		return;
+	}
+
+	swap_errors = 0;
+
+	/* The write succeeded and nobody touched the block in the meantime.
+	 * Free the frame and let the block point into the swap space.
+	 */
+	free_mem(ABS2CLICK(pb->phys), 1);
+	pb->phys = (phys_bytes)swout_slot * VM_PAGE_SIZE;
+	pb->flags |= PBF_SWAPPED;
+}
+
+/*===========================================================================*
+ *				region_evictable			     *
+ *===========================================================================*/
+static int region_evictable(struct vir_region *vr)
+{
+	/* Shared, pinned and specially placed memory (DMA buffers and the
+	 * like) must keep the frames it has; only plain private mappings are
+	 * fair game.
+	 */
+	if(vr->flags & (VR_SHARED|VR_PINNED|VR_DIRECT|VR_PHYS64K|VR_LOWER16MB|
+		VR_LOWER1MB))
+		return 0;
+	if(vr->remaps > 0)
+		return 0;
+	return 1;
+}
+
+/*===========================================================================*
+ *				find_victim				     *
+ *===========================================================================*/
+static struct phys_region *find_victim(void)
+{
+/* Find an anonymous page to page out, resuming the scan where the previous
+ * one left off. Only pages of regular user processes are considered: system
+ * services are few, mostly small, and must never block on their own memory.
+ * Blocks shared between processes (copy-on-write after fork) are skipped to
+ * keep the bookkeeping simple; they revert to private blocks over time.
+ */
+	int i;
+
+	for(i = 0; i < VMP_NR; i++) {
+		struct vmproc *vmp = &vmproc[scan_proc];
+		region_iter v_iter;
+		struct vir_region *vr;
+
+		if(!(vmp->vm_flags & VMF_INUSE) ||
+		   (vmp->vm_flags & VMF_EXITING) || !acl_is_user(vmp)) {
+			scan_proc = (scan_proc + 1) % VMP_NR;
+			scan_vaddr = 0;
+			continue;
+		}
+
+		region_start_iter(&vmp->vm_regions_avl, &v_iter, scan_vaddr,
+			AVL_GREATER_EQUAL);
+
+		while((vr = region_get_iter(&v_iter))) {
+			vir_bytes voffset = 0;
+
+			if(region_evictable(vr)) {
+				if(scan_vaddr > vr->vaddr)
+					voffset = scan_vaddr - vr->vaddr;
+
+				for(; voffset < vr->length;
+					voffset += VM_PAGE_SIZE) {
+					struct phys_region *pr;
+					struct phys_block *pb;
+
+					if(!(pr = physblock_get(vr, voffset)))
+						continue;
+					pb = pr->ph;
+
+					if(pr->memtype != &mem_type_anon)
+						continue;
+					if(pb->refcount != 1)
+						continue;
+					if(pb->phys == MAP_NONE)
+						continue;
+					if(pb->flags & (PBF_INCACHE|
+						PBF_SWAPPED|PBF_PAGEOUT))
+						continue;
+
+					scan_vaddr = vr->vaddr + voffset +
+						VM_PAGE_SIZE;
+					return pr;
+				}
+			}
+
+			region_incr_iter(&v_iter);
+			scan_vaddr = vr->vaddr + vr->length;
+		}
+
+		scan_proc = (scan_proc + 1) % VMP_NR;
+		scan_vaddr = 0;
+	}
+
+	return NULL;
+}
+
+/*===========================================================================*
+ *				swap_cycle				     *
+ *===========================================================================*/
+void swap_cycle(void)
+{
+/* Called from the main loop between requests, like alloc_cycle(). If memory
+ * is getting tight, start writing out one page; the write completes
+ * asynchronously, so this never stalls the loop.
+ */
+	struct phys_region *pr;
+	struct phys_block *pb;
+	struct vmproc *vmp;
+	u32_t slot;
+
+	assert(swap_enabled);
+
+	if(swout_busy)
+		return;
+
+	if(mem_free_pages() >= SWAP_LOWWATER_PAGES)
+		return;
+
+	if(!swap_slots_free)
+		return;
+
+	if(!(pr = find_victim()))
+		return;
+
+	pb = pr->ph;
+	vmp = pr->parent->parent;
+
+	if(slot_alloc(&slot) != OK)
+		return;
+
+	/* Unmap the page before snapshotting it, so that any access from now
+	 * on faults and cancels the page-out instead of modifying the frame
+	 * behind our back.
+	 */
+	if(pt_writemap(vmp, &vmp->vm_pt, pr->parent->vaddr + pr->offset,
+		MAP_NONE, VM_PAGE_SIZE, 0, WMF_OVERWRITE) != OK) {
+		printf("VM: swap: could not unmap page-out victim\n");
+		slot_free(slot);
+		return;
+	}
+
+	if(sys_abscopy(pb->phys, swout_buf_phys, VM_PAGE_SIZE) != OK)
+		panic("swap_cycle: abscopy failed");
+
+	pb->flags |= PBF_PAGEOUT;
+	swout_pb = pb;
+	swout_slot = slot;
+	swout_busy = 1;
+
+	if(vfs_request(VMVFSREQ_FDWRITE, swap_fd, vmp,
+		(u64_t)slot * VM_PAGE_SIZE, VM_PAGE_SIZE,
+		(vir_bytes)swout_buf, swout_done, NULL, NULL, 0) != OK) {
+		printf("VM: swap: vfs_request for page-out failed\n");
+		pb->flags &= ~PBF_PAGEOUT;
+		swout_pb = NULL;
+		swout_busy = 0;
+		slot_free(slot);
+	}
+}
@@ -38,17 +38,32 @@ static struct vfs_request_node {
 	int			req_id;
 	vfs_callback_t		callback;
 	struct vfs_request_node	*next;
-} *first_queued, *active;
+} *first_queued, *first_active;
+
+/* Limit on the number of requests outstanding at VFS at any time; any more
+ * are queued until replies come in. Multiple outstanding requests keep one
+ * slow file-backed page fault from stalling every other one behind it, as
+ * replies are matched by request id and may arrive in any order.
+ */
+#define MAX_ACTIVE_REQS	8
+
+static int nr_active;
 
 static void activate(void)
 {
-	assert(!active);
+	struct vfs_request_node *reqnode;
+
+	assert(nr_active < MAX_ACTIVE_REQS);
 	assert(first_queued);
 
-	active = first_queued;
-	first_queued = first_queued->next;
+	reqnode = first_queued;
+	first_queued = reqnode->next;
+
+	reqnode->next = first_active;
+	first_active = reqnode;
+	nr_active++;
 
-	if(asynsend3(VFS_PROC_NR, &active->reqmsg, AMF_NOREPLY) != OK)
+	if(asynsend3(VFS_PROC_NR, &reqnode->reqmsg, AMF_NOREPLY) != OK)
 		panic("VM: asynsend to VFS failed");
 }
 
@@ -58,7 +73,8 @@ static void activate(void)
  *                              vfs_request                                 *
  *===========================================================================*/
 int vfs_request(int reqno, int fd, struct vmproc *vmp, u64_t offset, u32_t len,
-	vfs_callback_t reply_callback, void *cbarg, void *state, int statelen)
+	vir_bytes buf, vfs_callback_t reply_callback, void *cbarg, void *state,
+	int statelen)
 {
 /* Perform an asynchronous request to VFS.
  * We send a message of type VFS_VMCALL to VFS. VFS will respond
@@ -87,6 +103,7 @@ int vfs_request(int reqno, int fd, struct vmproc *vmp, u64_t offset, u32_t len,
 	m->VFS_VMCALL_ENDPOINT = vmp->vm_endpoint;
 	m->VFS_VMCALL_OFFSET = offset;
 	m->VFS_VMCALL_LENGTH = len;
+	m->VFS_VMCALL_BUF = buf;
 
 	reqnode->who = vmp->vm_endpoint;
 	reqnode->req_id = reqid;
@@ -96,8 +113,8 @@ int vfs_request(int reqno, int fd, struct vmproc *vmp, u64_t offset, u32_t len,
 	if(state) memcpy(reqnode->reqstate, state, statelen);
 	first_queued = reqnode;
 
-	/* Send the request message if none pending. */
-	if(!active)
+	/* Send the request message if there is room for it at VFS. */
+	if(nr_active < MAX_ACTIVE_REQS)
 		activate();
 
 	return OK;
@@ -108,34 +125,41 @@ int vfs_request(int reqno, int fd, struct vmproc *vmp, u64_t offset, u32_t len,
  *===========================================================================*/
 int do_vfs_reply(message *m)
 {
-/* VFS has handled a VM request and VFS has replied. It must be the
- * active request.
+/* VFS has handled a VM request and VFS has replied. It must be one of the
+ * active requests; replies may arrive in any order.
  */
- 	struct vfs_request_node *orignode = active;
+ 	struct vfs_request_node *reqnode, **prevp;
  	vfs_callback_t req_callback;
 	void *cbarg;
 	int n;
 	struct vmproc *vmp;
 
-	assert(active);
-	assert(active->req_id == m->VMV_REQID);
+	for (prevp = &first_active; (reqnode = *prevp) != NULL;
+	    prevp = &reqnode->next)
+		if (reqnode->req_id == m->VMV_REQID)
+			break;
+
+	if(reqnode == NULL)
+		panic("VM: stray reply from VFS, request id %d", m->VMV_REQID);
+
+	*prevp = reqnode->next;
+	nr_active--;
 
 	/* the endpoint may have exited */
 	if(vm_isokendpt(m->VMV_ENDPOINT, &n) != OK)
 		vmp = NULL;
 	else	vmp = &vmproc[n];
 
-	req_callback = active->callback;
-	cbarg = active->opaque;
-	active = NULL;
+	req_callback = reqnode->callback;
+	cbarg = reqnode->opaque;
 
 	/* Invoke requested reply-callback within VM. */
-	if(req_callback) req_callback(vmp, m, cbarg, orignode->reqstate);
+	if(req_callback) req_callback(vmp, m, cbarg, reqnode->reqstate);
 
-	SLABFREE(orignode);
+	SLABFREE(reqnode);
 
-	/* Send the next request message if any and not re-activated. */
-	if(first_queued && !active)
+	/* Send more request messages if queued, as far as there is room. */
+	while(first_queued && nr_active < MAX_ACTIVE_REQS)
 		activate();
 
 	return SUSPEND;	/* don't reply to the reply */
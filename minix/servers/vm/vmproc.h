@@ -35,5 +35,6 @@ struct vmproc {
 #define VMF_INUSE	0x001	/* slot contains a process */
 #define VMF_EXITING	0x002	/* PM is cleaning up this process */
 #define VMF_VM_INSTANCE 0x010   /* This is a VM process instance */
+#define VMF_MLOCKALL	0x020	/* mlockall(MCL_FUTURE): pin new mappings */
 
 #endif
@@ -0,0 +1,51 @@
+#!/bin/sh
+
+. ./support.sh
+
+# The following are commented-out examples of how to run iobench. The
+# syntax of the calls is:
+#
+#   io_bench_raw <device> <parameters>
+#   io_bench_file <file> <parameters>
+#
+# <parameters> is a comma-separated list:
+#
+# bs           I/O request size in bytes (default 4096).
+# span         Working set size in kilobytes (default 65536). Clamped to
+#              the partition/file size; with "rw", files are extended to
+#              this size before the measurement starts.
+# ops          Number of operations to perform (default 8192, max 65536).
+# depth        Queue depth: number of asynchronous requests kept
+#              outstanding. Raw mode only; file I/O is synchronous.
+# random       Random instead of sequential offsets.
+# write        Percentage of operations that are writes (0-100).
+#              Requires "rw".
+# rw (or) ro   "rw" allows iobench to WRITE TO AND DESTROY DATA ON the
+#              target. Default is read-only.
+# fsync        fsync the file after the last operation (file mode).
+#
+# Results appear on the console and in /var/log/messages. Note that in
+# file mode the first pass over the working set warms the FS block cache
+# and the VM second-level cache; run multiple passes (or compare the
+# first pass with later ones) to separate cold from warm performance.
+# Raw mode bypasses the caches entirely. Driver restarts during a run
+# are retried transparently by libbdev and, when the retry limit is
+# exceeded, counted in errors=.
+#
+# Before commenting out any "rw" entry, you MUST edit the device name,
+# or you WILL risk losing arbitrary data.
+
+# Random 4K reads, queue depth 8, against a SATA disk driver:
+#io_bench_raw /dev/c2d0 "random,depth=8"
+
+# Sequential 64K reads against an IDE disk driver:
+#io_bench_raw /dev/c0d0 "bs=65536"
+
+# 70/30 random 4K read/write mix on a scratch partition (DESTROYS DATA):
+#io_bench_raw /dev/c0d1p2 "rw,random,write=30,depth=4"
+
+# Cached sequential reads from a file:
+#io_bench_file /usr/tmp/iobench.dat "rw,span=16384"
+
+# Random 4K writes to a file, fsync at the end:
+#io_bench_file /usr/tmp/iobench.dat "rw,random,write=100,fsync,span=16384"
@@ -0,0 +1,468 @@
+/* I/O workload benchmark for files and raw block devices.
+ *
+ * The benchmark runs as a service so that it can drive block drivers
+ * directly through libbdev ("raw" mode, with real queue depth using the
+ * asynchronous libbdev calls), next to regular file I/O through VFS
+ * ("file" mode, which exercises the FS block cache). Results are
+ * reported as machine-readable lines in the same format as the
+ * ipcbench suite: per-operation TSC latency percentiles plus total
+ * IOPS and bandwidth.
+ */
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/type.h>
+#include <minix/ipc.h>
+#include <minix/partition.h>
+#include <minix/safecopies.h>
+#include <minix/bdev.h>
+#include <minix/drvlib.h>
+#include <minix/ds.h>
+#include <minix/optset.h>
+#include <minix/syslib.h>
+#include <minix/sysutil.h>
+#include <minix/minlib.h>
+#include <sys/ioc_disk.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+#define MAX_DEPTH	64		/* max outstanding raw requests */
+#define MAX_OPS		65536		/* max recorded operations */
+
+static char target_file[PATH_MAX] = "";	/* file to benchmark, if any */
+static char driver_label[32] = "";	/* driver DS label (raw mode) */
+static int driver_major = -1;		/* device major (raw mode) */
+static int driver_minor = -1;		/* device minor (raw mode) */
+
+static int block_size = 4096;		/* I/O request size in bytes */
+static int span_kb = 65536;		/* working set size in kilobytes */
+static int nr_ops = 8192;		/* number of operations to perform */
+static int depth = 1;			/* queue depth (raw mode only) */
+static int pct_write = 0;		/* percentage of write operations */
+static int do_random = FALSE;		/* random instead of sequential? */
+static int may_write = FALSE;		/* may we write to the target? */
+static int do_fsync = FALSE;		/* fsync at the end (file mode)? */
+static int silent = FALSE;		/* no console output? */
+
+/* Options supported by this service. */
+static struct optset optset_table[] = {
+	{ "file",	OPT_STRING,	target_file,	sizeof(target_file) },
+	{ "label",	OPT_STRING,	driver_label,	sizeof(driver_label) },
+	{ "major",	OPT_INT,	&driver_major,	10		    },
+	{ "minor",	OPT_INT,	&driver_minor,	10		    },
+	{ "bs",		OPT_INT,	&block_size,	10		    },
+	{ "span",	OPT_INT,	&span_kb,	10		    },
+	{ "ops",	OPT_INT,	&nr_ops,	10		    },
+	{ "depth",	OPT_INT,	&depth,		10		    },
+	{ "write",	OPT_INT,	&pct_write,	10		    },
+	{ "random",	OPT_BOOL,	&do_random,	TRUE		    },
+	{ "rw",		OPT_BOOL,	&may_write,	TRUE		    },
+	{ "ro",		OPT_BOOL,	&may_write,	FALSE		    },
+	{ "fsync",	OPT_BOOL,	&do_fsync,	TRUE		    },
+	{ "silent",	OPT_BOOL,	&silent,	TRUE		    },
+	{ NULL,		0,		NULL,		0		    }
+};
+
+/* Per-request state for the raw mode request window. */
+struct slot {
+	int busy;
+	bdev_id_t id;
+	u64_t t0;
+	char *buf;
+};
+static struct slot slots[MAX_DEPTH];
+
+static u32_t samples[MAX_OPS];		/* per-operation latency, cycles */
+static int nr_samples = 0;
+static int nr_errors = 0;
+static u64_t bytes_done = 0;
+
+static u64_t span;			/* working set size in bytes */
+static u64_t nr_blocks;			/* span / block_size */
+
+/* SEF functions and variables. */
+static void sef_local_startup(void);
+
+/*===========================================================================*
+ *				   output				     *
+ *===========================================================================*/
+static void output(char *fmt, ...)
+{
+	/* Print information, unless configured to be silent. */
+	va_list argp;
+
+	if (silent)
+		return;
+
+	va_start(argp, fmt);
+
+	vprintf(fmt, argp);
+
+	va_end(argp);
+}
+
+/*===========================================================================*
+ *				 next_offset				     *
+ *===========================================================================*/
+static u64_t next_offset(void)
+{
+	/* Compute the offset for the next operation. */
+	static u64_t seq_off = 0;
+	u64_t off;
+
+	if (do_random)
+		off = (u64_t) (lrand48() % nr_blocks) * block_size;
+	else {
+		off = seq_off;
+		seq_off += block_size;
+		if (seq_off + block_size > span)
+			seq_off = 0;
+	}
+
+	return off;
+}
+
+/*===========================================================================*
+ *				   is_write				     *
+ *===========================================================================*/
+static int is_write(void)
+{
+	/* Should the next operation be a write? */
+	if (pct_write <= 0)
+		return FALSE;
+	if (pct_write >= 100)
+		return TRUE;
+	return (lrand48() % 100) < pct_write;
+}
+
+/*===========================================================================*
+ *				 record_sample				     *
+ *===========================================================================*/
+static void record_sample(u64_t t0, u64_t t1)
+{
+	if (nr_samples < MAX_OPS)
+		samples[nr_samples++] = (u32_t) (t1 - t0);
+}
+
+/*===========================================================================*
+ *				  cmp_sample				     *
+ *===========================================================================*/
+static int cmp_sample(const void *a, const void *b)
+{
+	u32_t va = *(const u32_t *) a, vb = *(const u32_t *) b;
+
+	return va > vb ? 1 : (va < vb ? -1 : 0);
+}
+
+/*===========================================================================*
+ *				    report				     *
+ *===========================================================================*/
+static void report(const char *mode, u64_t total_tsc)
+{
+	/* Print the results in machine-readable form. */
+	u64_t sum = 0, cal;
+	u32_t total_us, cal_us;
+	unsigned long iops, kbps;
+	int i, n;
+
+	/* TSC calibration, for converting the cycle counts below. */
+	cal = (u64_t) 1 << 30;
+	cal_us = tsc_to_micros(ex64lo(cal), ex64hi(cal));
+	if (cal_us > 0)
+		printf("iobench calibration cycles_per_us=%lu\n",
+			(unsigned long) (cal / cal_us));
+
+	total_us = tsc_to_micros(ex64lo(total_tsc), ex64hi(total_tsc));
+	if (total_us == 0)
+		total_us = 1;
+
+	iops = (unsigned long)
+		(((u64_t) (nr_ops - nr_errors) * 1000000) / total_us);
+	kbps = (unsigned long) ((bytes_done * 1000000 / 1024) / total_us);
+
+	printf("iobench result mode=%s pattern=%s write_pct=%d bs=%d "
+		"depth=%d span_kb=%d ops=%d errors=%d total_us=%lu "
+		"iops=%lu kb_per_s=%lu\n",
+		mode, do_random ? "random" : "sequential", pct_write,
+		block_size, depth, span_kb, nr_ops, nr_errors,
+		(unsigned long) total_us, iops, kbps);
+
+	n = nr_samples;
+	if (n == 0)
+		return;
+	qsort(samples, n, sizeof(samples[0]), cmp_sample);
+	for (i = 0; i < n; i++)
+		sum += samples[i];
+
+	printf("iobench latency unit=cycles n=%d min=%lu p50=%lu p90=%lu "
+		"p99=%lu max=%lu avg=%lu\n", n,
+		(unsigned long) samples[0], (unsigned long) samples[n/2],
+		(unsigned long) samples[(n/10)*9],
+		(unsigned long) samples[(n/100)*99],
+		(unsigned long) samples[n-1], (unsigned long) (sum / n));
+}
+
+/*===========================================================================*
+ *				 raw_callback				     *
+ *===========================================================================*/
+static void raw_callback(dev_t UNUSED(dev), bdev_id_t UNUSED(id),
+	bdev_param_t param, int result)
+{
+	/* An asynchronous request has completed. */
+	struct slot *sp = (struct slot *) param;
+	u64_t t1;
+
+	read_tsc_64(&t1);
+	record_sample(sp->t0, t1);
+
+	if (result != block_size)
+		nr_errors++;
+	else
+		bytes_done += result;
+
+	sp->busy = FALSE;
+}
+
+/*===========================================================================*
+ *				   run_raw				     *
+ *===========================================================================*/
+static void run_raw(void)
+{
+	/* Benchmark a block device directly through libbdev, keeping up
+	 * to 'depth' asynchronous requests outstanding. Driver restarts
+	 * are retried transparently by libbdev; requests that still fail
+	 * after its retry limits show up in the error count.
+	 */
+	struct part_geom part;
+	dev_t dev;
+	u64_t t_start, t_end, off;
+	bdev_id_t id;
+	char *buf;
+	int i, issued, pending, access;
+
+	if (depth < 1 || depth > MAX_DEPTH)
+		panic("invalid queue depth");
+	if (driver_minor < 0 || driver_minor > 255)
+		panic("invalid or no driver minor given");
+	if (driver_major < 0)
+		panic("invalid or no driver major given");
+
+	dev = makedev(driver_major, driver_minor);
+
+	bdev_driver(dev, driver_label);
+
+	access = may_write ? (BDEV_R_BIT | BDEV_W_BIT) : BDEV_R_BIT;
+	if (bdev_open(dev, access) != OK)
+		panic("unable to open device");
+
+	/* Limit the working set to the partition size, if we can get it. */
+	if (bdev_ioctl(dev, DIOCGETP, &part, NONE) == OK &&
+			part.size < span) {
+		span = part.size;
+		nr_blocks = span / block_size;
+		if (nr_blocks == 0)
+			panic("partition too small for block size");
+	}
+
+	/* Drivers may require physically contiguous buffers for DMA. */
+	buf = alloc_contig(depth * block_size, 0, NULL);
+	if (buf == NULL)
+		panic("unable to allocate buffers");
+	for (i = 0; i < depth; i++)
+		slots[i].buf = buf + i * block_size;
+
+	read_tsc_64(&t_start);
+
+	issued = 0;
+	do {
+		/* Fill the request window. */
+		for (i = 0; i < depth && issued < nr_ops; i++) {
+			struct slot *sp = &slots[i];
+
+			if (sp->busy)
+				continue;
+
+			off = next_offset();
+			read_tsc_64(&sp->t0);
+			if (is_write())
+				id = bdev_write_asyn(dev, off, sp->buf,
+					block_size, BDEV_NOFLAGS,
+					raw_callback, sp);
+			else
+				id = bdev_read_asyn(dev, off, sp->buf,
+					block_size, BDEV_NOFLAGS,
+					raw_callback, sp);
+			if (id < 0) {
+				nr_errors++;
+				issued++;
+				continue;
+			}
+			sp->busy = TRUE;
+			sp->id = id;
+			issued++;
+		}
+
+		/* Wait for the oldest outstanding request; this may
+		 * complete any number of other requests as well.
+		 */
+		pending = 0;
+		for (i = 0; i < depth; i++) {
+			if (slots[i].busy) {
+				pending = 1;
+				(void) bdev_wait_asyn(slots[i].id);
+				break;
+			}
+		}
+	} while (issued < nr_ops || pending);
+
+	read_tsc_64(&t_end);
+
+	bdev_close(dev);
+
+	free_contig(buf, depth * block_size);
+
+	report("raw", t_end - t_start);
+}
+
+/*===========================================================================*
+ *				   run_file				     *
+ *===========================================================================*/
+static void run_file(void)
+{
+	/* Benchmark a file (or device node) through regular VFS I/O.
+	 * This path is synchronous, so the queue depth is always 1, and
+	 * it is served from the FS block cache; the first pass over the
+	 * working set warms the cache.
+	 */
+	struct stat st;
+	u64_t t_start, t_end, t0, t1, off;
+	char *buf;
+	ssize_t r;
+	int fd, i, flags;
+
+	if (depth != 1) {
+		output("IOBENCH: file I/O is synchronous; forcing depth 1\n");
+		depth = 1;
+	}
+
+	flags = may_write ? O_RDWR | O_CREAT : O_RDONLY;
+	if ((fd = open(target_file, flags, 0644)) < 0)
+		panic("unable to open '%s'", target_file);
+
+	if (fstat(fd, &st) != 0)
+		panic("unable to stat '%s'", target_file);
+
+	if (!(buf = malloc(block_size)))
+		panic("unable to allocate buffer");
+	memset(buf, 0x5a, block_size);
+
+	if ((u64_t) st.st_size < span) {
+		if (!may_write) {
+			/* Limit the working set to the file size. */
+			span = st.st_size;
+			nr_blocks = span / block_size;
+			if (nr_blocks == 0)
+				panic("file too small for block size");
+		} else {
+			/* Extend the file to the working set size, so
+			 * that reads do not hit holes. Not timed.
+			 */
+			for (off = 0; off < span; off += block_size)
+				if (pwrite(fd, buf, block_size, off) !=
+						block_size)
+					panic("unable to extend '%s'",
+						target_file);
+		}
+	}
+
+	read_tsc_64(&t_start);
+
+	for (i = 0; i < nr_ops; i++) {
+		off = next_offset();
+		read_tsc_64(&t0);
+		if (is_write())
+			r = pwrite(fd, buf, block_size, off);
+		else
+			r = pread(fd, buf, block_size, off);
+		read_tsc_64(&t1);
+		record_sample(t0, t1);
+		if (r != block_size)
+			nr_errors++;
+		else
+			bytes_done += r;
+	}
+
+	if (do_fsync && fsync(fd) != 0)
+		nr_errors++;
+
+	read_tsc_64(&t_end);
+
+	free(buf);
+	close(fd);
+
+	report("file", t_end - t_start);
+}
+
+/*===========================================================================*
+ *			       sef_cb_init_fresh			     *
+ *===========================================================================*/
+static int sef_cb_init_fresh(int UNUSED(type), sef_init_info_t *UNUSED(info))
+{
+	/* Initialize and run the benchmark. */
+
+	if (env_argc > 1)
+		optset_parse(optset_table, env_argv[1]);
+
+	if (target_file[0] == '\0' && driver_label[0] == '\0')
+		panic("no file or driver label given");
+	if (pct_write > 0 && !may_write)
+		panic("writes requested without rw");
+	if (block_size <= 0 || nr_ops <= 0 || nr_ops > MAX_OPS ||
+			span_kb <= 0)
+		panic("invalid benchmark parameters");
+
+	span = (u64_t) span_kb * 1024;
+	nr_blocks = span / block_size;
+	if (nr_blocks == 0)
+		panic("working set too small for block size");
+
+	srand48(getticks());
+
+	if (target_file[0] != '\0')
+		run_file();
+	else
+		run_raw();
+
+	return OK;
+}
+
+/*===========================================================================*
+ *			       sef_local_startup			     *
+ *===========================================================================*/
+static void sef_local_startup(void)
+{
+	/* Initialize the SEF framework. */
+
+	sef_setcb_init_fresh(sef_cb_init_fresh);
+
+	sef_startup();
+}
+
+/*===========================================================================*
+ *				    main				     *
+ *===========================================================================*/
+int main(int argc, char **argv)
+{
+	env_setargs(argc, argv);
+	sef_local_startup();
+
+	return 0;
+}
@@ -0,0 +1,30 @@
+# Supporting routines for iobench. Do not run directly.
+
+# usage: devtotriple /dev/cXdY..
+# returns a label, major, minor triple in the form
+# "label=at_wini_N,major=J,minor=M"
+devtotriple() {
+  label=`awk "/^$(stat -f '%Hr' $1) / "'{print $2}' /proc/dmap`
+  if [ ! -z "$label" ]; then
+    echo "label=$label,major=`stat -f '%Hr' $1`,minor=`stat -f '%Lr' $1`"
+  fi
+}
+
+# usage: io_bench_raw /dev/cXdY.. "params,for,iobench"
+# runs iobench against the driver of the given device ("raw" mode)
+io_bench_raw() {
+  if [ ! -x iobench ]; then echo "compile iobench first!" >&2; exit 1; fi
+  if [ ! -b "$1" ]; then echo "$1 is not a block device" >&2; exit 1; fi
+  triple=$(devtotriple $1)
+  if [ -z "$triple" ]; then echo "driver not found for $1" >&2; exit 1; fi
+  minix-service up `pwd`/iobench -args "$triple,$2" -config system.conf \
+    -script /etc/rs.single -label iobench_$(stat -f '%r' $1)
+}
+
+# usage: io_bench_file /path/to/file "params,for,iobench"
+# runs iobench against a file through VFS ("file" mode)
+io_bench_file() {
+  if [ ! -x iobench ]; then echo "compile iobench first!" >&2; exit 1; fi
+  minix-service up `pwd`/iobench -args "file=$1,$2" -config system.conf \
+    -script /etc/rs.single -label iobench_file
+}
@@ -0,0 +1,264 @@
+#include "inc.h"
+
+static endpoint_t worker[BENCH_WORKERS];
+static char buf[BENCH_BUF_SIZE];
+static u32_t samples[BENCH_SAMPLES];
+
+/* SEF functions and variables. */
+static void sef_local_startup(void);
+
+/*===========================================================================*
+ *				  cmp_sample				     *
+ *===========================================================================*/
+static int cmp_sample(const void *a, const void *b)
+{
+	u32_t va = *(const u32_t *) a, vb = *(const u32_t *) b;
+
+	return va > vb ? 1 : (va < vb ? -1 : 0);
+}
+
+/*===========================================================================*
+ *				   report				     *
+ *===========================================================================*/
+static void report(const char *name, const char *unit, u32_t *s, int n)
+{
+/* Print one machine-readable result line with the percentiles of the
+ * recorded samples. Times are in TSC cycles; the cycles_per_us line
+ * printed at startup allows conversion to wall-clock time.
+ */
+	u64_t sum = 0;
+	int i;
+
+	qsort(s, n, sizeof(s[0]), cmp_sample);
+	for(i = 0; i < n; i++)
+		sum += s[i];
+
+	printf("ipcbench %s unit=%s n=%d min=%lu p50=%lu p90=%lu p99=%lu "
+		"max=%lu avg=%lu\n", name, unit, n,
+		(unsigned long) s[0], (unsigned long) s[n/2],
+		(unsigned long) s[(n/10)*9], (unsigned long) s[(n/100)*99],
+		(unsigned long) s[n-1], (unsigned long) (sum / n));
+}
+
+/*===========================================================================*
+ *				bench_sendrec				     *
+ *===========================================================================*/
+static void bench_sendrec(void)
+{
+	message m;
+	u64_t t0, t1;
+	int i, r;
+
+	for(i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) {
+		memset(&m, 0, sizeof(m));
+		m.m_type = BENCH_ECHO;
+		read_tsc_64(&t0);
+		r = ipc_sendrec(worker[0], &m);
+		read_tsc_64(&t1);
+		if(r != OK || m.m_type != OK) {
+			printf("BENCH: sendrec failed: %d\n", r);
+			return;
+		}
+		if(i >= 0)
+			samples[i] = (u32_t) (t1 - t0);
+	}
+
+	report("sendrec_latency", "cycles", samples, BENCH_SAMPLES);
+}
+
+/*===========================================================================*
+ *				bench_asynsend				     *
+ *===========================================================================*/
+static void bench_asynsend(void)
+{
+	message m;
+	u64_t t0, t1;
+	int i, j, r, rounds;
+
+	rounds = BENCH_SAMPLES / 8;
+
+	for(i = -1; i < rounds; i++) {
+		read_tsc_64(&t0);
+		for(j = 0; j < BENCH_ASYNC_BATCH; j++) {
+			memset(&m, 0, sizeof(m));
+			m.m_type = BENCH_ASYNC;
+			if((r = asynsend(worker[0], &m)) != OK) {
+				printf("BENCH: asynsend failed: %d\n", r);
+				return;
+			}
+		}
+
+		/* The sync request cannot overtake the async messages:
+		 * the kernel delivers pending async messages from a
+		 * sender before its blocking sends.
+		 */
+		memset(&m, 0, sizeof(m));
+		m.m_type = BENCH_SYNC;
+		r = ipc_sendrec(worker[0], &m);
+		read_tsc_64(&t1);
+		if(r != OK || m.m_type != OK) {
+			printf("BENCH: sync failed: %d\n", r);
+			return;
+		}
+		if(m.m1_i1 != BENCH_ASYNC_BATCH) {
+			printf("BENCH: lost async messages: %d != %d\n",
+				m.m1_i1, BENCH_ASYNC_BATCH);
+			return;
+		}
+		if(i >= 0)
+			samples[i] = (u32_t) ((t1 - t0) / BENCH_ASYNC_BATCH);
+	}
+
+	report("asynsend_throughput", "cycles/msg", samples, rounds);
+}
+
+/*===========================================================================*
+ *				bench_safecopy				     *
+ *===========================================================================*/
+static void bench_safecopy(void)
+{
+	static const size_t sizes[] = {
+		64, 256, 1024, 4096, 16384, 65536, BENCH_BUF_SIZE
+	};
+	char name[64];
+	message m;
+	cp_grant_id_t gid;
+	u64_t t0, t1;
+	int i, s, r, rounds;
+
+	/* Have the first worker grant us its buffer. */
+	memset(&m, 0, sizeof(m));
+	m.m_type = BENCH_GETGRANT;
+	r = ipc_sendrec(worker[0], &m);
+	if(r != OK || m.m_type != OK) {
+		printf("BENCH: getgrant failed: %d\n", r);
+		return;
+	}
+	gid = m.m1_i1;
+
+	rounds = BENCH_SAMPLES / 8;
+
+	for(s = 0; s < (int) (sizeof(sizes)/sizeof(sizes[0])); s++) {
+		for(i = -BENCH_WARMUP; i < rounds; i++) {
+			read_tsc_64(&t0);
+			r = sys_safecopyfrom(worker[0], gid, 0,
+				(vir_bytes) buf, sizes[s]);
+			read_tsc_64(&t1);
+			if(r != OK) {
+				printf("BENCH: safecopy failed: %d\n", r);
+				return;
+			}
+			if(i >= 0)
+				samples[i] = (u32_t) (t1 - t0);
+		}
+		snprintf(name, sizeof(name), "safecopy size=%lu",
+			(unsigned long) sizes[s]);
+		report(name, "cycles", samples, rounds);
+	}
+}
+
+/*===========================================================================*
+ *				bench_notify				     *
+ *===========================================================================*/
+static void bench_notify(void)
+{
+	char name[64];
+	message m;
+	u64_t t0, t1;
+	int ipc_status;
+	int i, w, got, r, rounds;
+
+	rounds = BENCH_SAMPLES / 8;
+
+	for(i = -BENCH_WARMUP; i < rounds; i++) {
+		read_tsc_64(&t0);
+		for(w = 0; w < BENCH_WORKERS; w++)
+			ipc_notify(worker[w]);
+
+		/* Each worker bounces the notification back once;
+		 * notifications from distinct senders do not merge.
+		 */
+		got = 0;
+		while(got < BENCH_WORKERS) {
+			if((r = sef_receive_status(ANY, &m,
+				&ipc_status)) != OK) {
+				printf("BENCH: receive failed: %d\n", r);
+				return;
+			}
+			if(is_ipc_notify(ipc_status))
+				got++;
+		}
+		read_tsc_64(&t1);
+		if(i >= 0)
+			samples[i] = (u32_t) (t1 - t0);
+	}
+
+	snprintf(name, sizeof(name), "notify_fanout dst=%d", BENCH_WORKERS);
+	report(name, "cycles", samples, rounds);
+}
+
+/*===========================================================================*
+ *				    main				     *
+ *===========================================================================*/
+int main(int argc, char **argv)
+{
+	message m;
+	u64_t cal;
+	u32_t micros;
+	int fid_get;
+	int i, r;
+
+	/* SEF local startup. */
+	env_setargs(argc, argv);
+	sef_local_startup();
+
+	/* Collect the worker endpoints. */
+	fid_get = open(FIFO_BENCH, O_RDONLY);
+	if(fid_get < 0) {
+		printf("BENCH: can't open fifo file.\n");
+		return 1;
+	}
+	for(i = 0; i < BENCH_WORKERS; i++) {
+		if(read(fid_get, &worker[i],
+			sizeof(worker[i])) != sizeof(worker[i])) {
+			printf("BENCH: can't read worker endpoint.\n");
+			return 1;
+		}
+		dprint(("BENCH: got worker endpoint: %d\n", worker[i]));
+	}
+	close(fid_get);
+
+	/* Print the TSC calibration so that consumers can convert the
+	 * cycle counts to wall-clock time.
+	 */
+	cal = (u64_t) 1 << 30;
+	micros = tsc_to_micros(ex64lo(cal), ex64hi(cal));
+	if(micros > 0)
+		printf("ipcbench calibration cycles_per_us=%lu\n",
+			(unsigned long) (cal / micros));
+
+	bench_sendrec();
+	bench_asynsend();
+	bench_safecopy();
+	bench_notify();
+
+	/* Shut down the workers. */
+	for(i = 0; i < BENCH_WORKERS; i++) {
+		memset(&m, 0, sizeof(m));
+		m.m_type = BENCH_QUIT;
+		if((r = ipc_sendrec(worker[i], &m)) != OK)
+			printf("BENCH: quit failed for %d: %d\n",
+				worker[i], r);
+	}
+
+	return 0;
+}
+
+/*===========================================================================*
+ *			       sef_local_startup			     *
+ *===========================================================================*/
+static void sef_local_startup()
+{
+  /* Let SEF perform startup. */
+  sef_startup();
+}
@@ -0,0 +1,55 @@
+
+#define _SYSTEM		1
+
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <minix/config.h>
+#include <minix/com.h>
+#include <minix/type.h>
+#include <minix/const.h>
+#include <minix/endpoint.h>
+#include <minix/ipc.h>
+#include <minix/safecopies.h>
+#include <minix/syslib.h>
+#include <minix/sysutil.h>
+#include <minix/minlib.h>
+#include <errno.h>
+
+/* Private benchmark protocol between bench and the workers. */
+#define BENCH_RQ_BASE	0x4B00
+#define BENCH_ECHO	(BENCH_RQ_BASE + 0)	/* sendrec round trip */
+#define BENCH_ASYNC	(BENCH_RQ_BASE + 1)	/* asynsend payload */
+#define BENCH_SYNC	(BENCH_RQ_BASE + 2)	/* collect async count */
+#define BENCH_GETGRANT	(BENCH_RQ_BASE + 3)	/* get a grant for safecopy */
+#define BENCH_QUIT	(BENCH_RQ_BASE + 4)	/* shut down worker */
+
+/* Number of worker services started by the run script; the notify
+ * fan-out benchmark notifies all of them, the other benchmarks use the
+ * first one only.
+ */
+#define BENCH_WORKERS	4
+
+/* Measurement parameters. Warmup iterations are run but not recorded,
+ * so that caches, page tables and the async message tables are hot
+ * before sampling starts.
+ */
+#define BENCH_WARMUP	64
+#define BENCH_SAMPLES	1024
+#define BENCH_ASYNC_BATCH 256
+
+/* Buffer granted by the worker for the safecopy bandwidth benchmark. */
+#define BENCH_BUF_SIZE	(256 * 1024)
+
+#define FIFO_BENCH "/usr/src/minix/tests/ipcbench/1fifo"
+
+#define DEBUG 0
+#if DEBUG
+#	define dprint(x) printf x
+#else
+#	define dprint(x)
+#endif
@@ -0,0 +1,96 @@
+#include "inc.h"
+
+static char grant_buf[BENCH_BUF_SIZE];
+
+/* SEF functions and variables. */
+static void sef_local_startup(void);
+
+/*===========================================================================*
+ *				    main				     *
+ *===========================================================================*/
+int main(int argc, char **argv)
+{
+	endpoint_t ep_self;
+	message m;
+	int ipc_status;
+	int fid_send;
+	int async_seen = 0;
+	cp_grant_id_t gid;
+	int r;
+
+	/* SEF local startup. */
+	env_setargs(argc, argv);
+	sef_local_startup();
+
+	/* Report our endpoint to the benchmark driver. */
+	fid_send = open(FIFO_BENCH, O_WRONLY);
+	if(fid_send < 0) {
+		printf("WORKER: can't open fifo file.\n");
+		return 1;
+	}
+	ep_self = sef_self();
+	write(fid_send, &ep_self, sizeof(ep_self));
+	close(fid_send);
+	dprint(("WORKER: sent my endpoint: %d\n", ep_self));
+
+	/* Serve benchmark requests until told to quit. */
+	for(;;) {
+		if((r = sef_receive_status(ANY, &m, &ipc_status)) != OK) {
+			printf("WORKER: receive failed: %d\n", r);
+			return 1;
+		}
+
+		if(is_ipc_notify(ipc_status)) {
+			/* Notify fan-out: bounce the notification back. */
+			ipc_notify(m.m_source);
+			continue;
+		}
+
+		if(IPC_STATUS_CALL(ipc_status) == SENDA) {
+			/* Async throughput: just count the message. */
+			async_seen++;
+			continue;
+		}
+
+		switch(m.m_type) {
+		case BENCH_ECHO:
+			m.m_type = OK;
+			break;
+		case BENCH_SYNC:
+			m.m1_i1 = async_seen;
+			async_seen = 0;
+			m.m_type = OK;
+			break;
+		case BENCH_GETGRANT:
+			gid = cpf_grant_direct(m.m_source,
+				(vir_bytes) grant_buf, BENCH_BUF_SIZE,
+				CPF_READ | CPF_WRITE);
+			m.m1_i1 = gid;
+			m.m_type = gid == GRANT_INVALID ? EINVAL : OK;
+			break;
+		case BENCH_QUIT:
+			m.m_type = OK;
+			ipc_send(m.m_source, &m);
+			return 0;
+		default:
+			printf("WORKER: unexpected request %d from %d\n",
+				m.m_type, m.m_source);
+			m.m_type = EINVAL;
+			break;
+		}
+
+		if((r = ipc_send(m.m_source, &m)) != OK) {
+			printf("WORKER: reply failed: %d\n", r);
+			return 1;
+		}
+	}
+}
+
+/*===========================================================================*
+ *			       sef_local_startup			     *
+ *===========================================================================*/
+static void sef_local_startup()
+{
+  /* Let SEF perform startup. */
+  sef_startup();
+}
@@ -0,0 +1,147 @@
+/* bootprof - display the system boot-time profile */
+/*
+ * This tool prints a waterfall of system startup: the kernel's boot phases,
+ * followed by one line per system service showing when RS requested its
+ * initialization, when the service entered sef_startup(), when it completed
+ * initialization, and when RS received the reply.  The data comes from the
+ * minix.rs.boot sysctl(7) subtree, which reports all times in microseconds
+ * relative to the first kernel boot event.
+ *
+ * Since the service records are read from RS's live process table, services
+ * started long after boot show up as well, at their actual start time; the
+ * -b flag limits the output to the boot itself by cutting off at the given
+ * number of seconds.
+ */
+
+#include <sys/sysctl.h>
+#include <minix/rs.h>
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static struct rs_bootprof_kev kevs[RS_BOOTPROF_NR_KERNEL];
+static unsigned int nkevs;
+
+static struct rs_bootprof_srv *srvs;
+static unsigned int nsrvs;
+
+/*
+ * Fetch one of the minix.rs.boot tables.  The number of records is not known
+ * beforehand, so probe for the size first, as usual for list sysctls.
+ */
+static size_t
+fetch(const char * name, void ** ptr, size_t recsize)
+{
+	void *buf;
+	size_t len;
+
+	if (sysctlbyname(name, NULL, &len, NULL, 0) < 0)
+		err(EXIT_FAILURE, "sysctl %s", name);
+
+	if (len == 0) {
+		*ptr = NULL;
+		return 0;
+	}
+
+	if ((buf = malloc(len)) == NULL)
+		err(EXIT_FAILURE, "malloc");
+
+	if (sysctlbyname(name, buf, &len, NULL, 0) < 0)
+		err(EXIT_FAILURE, "sysctl %s", name);
+
+	*ptr = buf;
+	return len / recsize;
+}
+
+/*
+ * Sort services by the time RS started them, so that the output reads as a
+ * timeline.  RS reports them in process table order, which is close to but
+ * not exactly start order.
+ */
+static int
+srvcmp(const void * a, const void * b)
+{
+	const struct rs_bootprof_srv *sa = a, *sb = b;
+
+	if (sa->sv_start != sb->sv_start)
+		return (sa->sv_start < sb->sv_start) ? -1 : 1;
+
+	return strcmp(sa->sv_label, sb->sv_label);
+}
+
+static void
+usage(void)
+{
+
+	fprintf(stderr, "usage: bootprof [-b seconds]\n");
+
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char ** argv)
+{
+	struct rs_bootprof_srv *sp;
+	void *ptr;
+	unsigned long cutoff;
+	unsigned int i;
+	int c;
+
+	cutoff = 0;
+
+	while ((c = getopt(argc, argv, "b:")) != -1) {
+		switch (c) {
+		case 'b':
+			cutoff = strtoul(optarg, NULL, 10) * 1000000UL;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (optind != argc)
+		usage();
+
+	nkevs = fetch("minix.rs.boot.kernel", &ptr, sizeof(kevs[0]));
+	if (nkevs > RS_BOOTPROF_NR_KERNEL)
+		nkevs = RS_BOOTPROF_NR_KERNEL;
+	if (nkevs > 0)
+		memcpy(kevs, ptr, nkevs * sizeof(kevs[0]));
+	free(ptr);
+
+	nsrvs = fetch("minix.rs.boot.services", &ptr, sizeof(srvs[0]));
+	srvs = ptr;
+
+	qsort(srvs, nsrvs, sizeof(srvs[0]), srvcmp);
+
+	printf("%-16s %10s\n", "KERNEL PHASE", "enter");
+
+	for (i = 0; i < nkevs; i++)
+		printf("%-16s %10u\n", kevs[i].ke_name, kevs[i].ke_micros);
+
+	printf("\n%-16s %10s %10s %10s %10s\n", "SERVICE", "start", "sef",
+	    "init", "ready");
+
+	for (i = 0; i < nsrvs; i++) {
+		sp = &srvs[i];
+
+		if (cutoff != 0 && sp->sv_start > cutoff)
+			continue;
+
+		/* The sef and init columns are blank for services that were
+		 * started before RS itself, and thus could not report their
+		 * own timestamps to this instance of RS.
+		 */
+		if (sp->sv_sef != 0)
+			printf("%-16s %10u %10u %10u %10u\n", sp->sv_label,
+			    sp->sv_start, sp->sv_sef, sp->sv_init,
+			    sp->sv_ready);
+		else
+			printf("%-16s %10u %10s %10s %10u\n", sp->sv_label,
+			    sp->sv_start, "-", "-", sp->sv_ready);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,606 @@
+/* netbench - simple network throughput and latency benchmark */
+/*
+ * This tool provides a netperf-style network benchmark for MINIX3.  It
+ * supports four tests: TCP and UDP bulk transfer ("tcp_stream", "udp_stream")
+ * and TCP and UDP request-response ("tcp_rr", "udp_rr").  One netbench
+ * instance runs as the server (-s), typically on another machine; the other
+ * instance runs the selected test as the client against it.  The server
+ * discards incoming stream traffic on its base port, and echoes
+ * request-response traffic on the port right above it.
+ *
+ * On the client side, stream tests report achieved throughput, and
+ * request-response tests report transaction rate and per-transaction latency
+ * percentiles, all on machine-readable "netbench ..." output lines.  In
+ * addition, the -P flag takes a snapshot of the local LWIP service's
+ * per-stage cost counters (the minix.lwip.perf sysctl(7) subtree) before and
+ * after the measurement, and reports the deltas, so that the cycles spent
+ * during the run can be attributed to the individual packet processing
+ * stages: network driver communication, checksum computation, and TCP event
+ * processing.  For that breakdown to be meaningful, the benchmark should
+ * obviously be the main network load on the system during the run.
+ */
+
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <err.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PORT_DEFAULT		12903	/* default server base port */
+#define DURATION_DEFAULT	10	/* default test duration (seconds) */
+#define MSGSIZE_STREAM_DEF	8192	/* default stream message size */
+#define MSGSIZE_RR_DEF		64	/* default request-response size */
+#define MSGSIZE_MAX		65536	/* maximum message size */
+
+#define MAX_SAMPLES		65536	/* maximum latency samples kept */
+#define MAX_CONNS		16	/* maximum server-side connections */
+
+#define RR_TIMEOUT_SEC		3	/* timeout for UDP responses (secs) */
+
+static char buf[MSGSIZE_MAX];
+
+static volatile sig_atomic_t done;
+
+static uint32_t samples[MAX_SAMPLES];
+static unsigned int nsamples;
+
+/*
+ * The minix.lwip.perf counters reported by -P, in reporting order.  Counters
+ * not present on the running system are silently skipped.
+ */
+static const char *const lwipstat_names[] = {
+	"ndev_send_pkts", "ndev_send_cycles", "ndev_send_bytes",
+	"ndev_recv_pkts", "ndev_recv_cycles", "ndev_recv_bytes",
+	"chksum_calls", "chksum_cycles", "chksum_bytes",
+	"tcp_sent_calls", "tcp_sent_cycles", "tcp_sent_bytes",
+	"tcp_recv_calls", "tcp_recv_cycles", "tcp_recv_bytes",
+};
+
+static uint64_t lwipstat_before[__arraycount(lwipstat_names)];
+
+static void
+usage(void)
+{
+
+	fprintf(stderr, "usage: %s -s [-p port]\n"
+	    "       %s -t test [-H host] [-p port] [-l secs] [-m size] [-P]\n"
+	    "with test one of: tcp_stream udp_stream tcp_rr udp_rr\n",
+	    getprogname(), getprogname());
+
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * Return the current monotonic time in microseconds.
+ */
+static uint64_t
+now_us(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+		err(EXIT_FAILURE, "clock_gettime");
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+got_alarm(int sig __unused)
+{
+
+	done = 1;
+}
+
+/*
+ * Create a socket of the given type, bound to the given local port.  For TCP,
+ * also put the socket in listening mode.  Return the socket file descriptor.
+ */
+static int
+bind_socket(int type, int port)
+{
+	struct sockaddr_in sin;
+	int fd, on;
+
+	if ((fd = socket(AF_INET, type, 0)) < 0)
+		err(EXIT_FAILURE, "socket");
+
+	on = 1;
+	(void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_ANY);
+	sin.sin_port = htons(port);
+
+	if (bind(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0)
+		err(EXIT_FAILURE, "bind");
+
+	if (type == SOCK_STREAM && listen(fd, 5) < 0)
+		err(EXIT_FAILURE, "listen");
+
+	return fd;
+}
+
+/*
+ * Serve a newly readable UDP socket: receive one datagram, and either discard
+ * it (stream traffic) or echo it back to its sender (request-response
+ * traffic).
+ */
+static void
+serve_udp(int fd, int echo)
+{
+	struct sockaddr_in sin;
+	socklen_t len;
+	ssize_t r;
+
+	len = sizeof(sin);
+
+	if ((r = recvfrom(fd, buf, sizeof(buf), 0, (struct sockaddr *)&sin,
+	    &len)) < 0)
+		return;
+
+	if (echo)
+		(void)sendto(fd, buf, r, 0, (struct sockaddr *)&sin, len);
+}
+
+/*
+ * Run as the benchmark server, serving both stream (discard) and
+ * request-response (echo) traffic over both TCP and UDP, until killed.
+ */
+static void __dead
+serve(int port)
+{
+	static struct {
+		int fd;		/* connection socket, or -1 if free */
+		int echo;	/* echo received data back? */
+	} conn[MAX_CONNS];
+	int tcp_fd[2], udp_fd[2];
+	fd_set fds;
+	unsigned int i, j;
+	ssize_t r;
+	int fd, nfds;
+
+	/* Index 0 is the stream (discard) port, index 1 the echo port. */
+	for (i = 0; i < 2; i++) {
+		tcp_fd[i] = bind_socket(SOCK_STREAM, port + (int)i);
+		udp_fd[i] = bind_socket(SOCK_DGRAM, port + (int)i);
+	}
+
+	for (i = 0; i < __arraycount(conn); i++)
+		conn[i].fd = -1;
+
+	for (;;) {
+		FD_ZERO(&fds);
+
+		nfds = 0;
+
+		for (i = 0; i < 2; i++) {
+			FD_SET(tcp_fd[i], &fds);
+			FD_SET(udp_fd[i], &fds);
+
+			nfds = MAX(nfds, MAX(tcp_fd[i], udp_fd[i]) + 1);
+		}
+
+		for (i = 0; i < __arraycount(conn); i++) {
+			if (conn[i].fd < 0)
+				continue;
+
+			FD_SET(conn[i].fd, &fds);
+
+			nfds = MAX(nfds, conn[i].fd + 1);
+		}
+
+		if (select(nfds, &fds, NULL, NULL, NULL) < 0) {
+			if (errno == EINTR)
+				continue;
+
+			err(EXIT_FAILURE, "select");
+		}
+
+		/* Accept new TCP connections, if we have room for them. */
+		for (i = 0; i < 2; i++) {
+			if (!FD_ISSET(tcp_fd[i], &fds))
+				continue;
+
+			if ((fd = accept(tcp_fd[i], NULL, NULL)) < 0)
+				continue;
+
+			for (j = 0; j < __arraycount(conn); j++)
+				if (conn[j].fd < 0)
+					break;
+
+			if (j == __arraycount(conn)) {
+				close(fd);
+
+				continue;
+			}
+
+			conn[j].fd = fd;
+			conn[j].echo = (i == 1);
+		}
+
+		for (i = 0; i < 2; i++)
+			if (FD_ISSET(udp_fd[i], &fds))
+				serve_udp(udp_fd[i], i == 1 /*echo*/);
+
+		/* Serve established TCP connections. */
+		for (i = 0; i < __arraycount(conn); i++) {
+			if (conn[i].fd < 0 || !FD_ISSET(conn[i].fd, &fds))
+				continue;
+
+			if ((r = read(conn[i].fd, buf, sizeof(buf))) <= 0) {
+				close(conn[i].fd);
+
+				conn[i].fd = -1;
+
+				continue;
+			}
+
+			if (conn[i].echo &&
+			    write(conn[i].fd, buf, r) != r) {
+				close(conn[i].fd);
+
+				conn[i].fd = -1;
+			}
+		}
+	}
+}
+
+/*
+ * Create a socket of the given type, connected to the given port on the given
+ * host.  UDP sockets are connected as well, restricting traffic to the given
+ * peer.  Return the socket file descriptor.
+ */
+static int
+connect_socket(const char * host, int type, int port)
+{
+	struct addrinfo hints, *res;
+	char serv[16];
+	int fd, r;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = type;
+
+	snprintf(serv, sizeof(serv), "%d", port);
+
+	if ((r = getaddrinfo(host, serv, &hints, &res)) != 0)
+		errx(EXIT_FAILURE, "%s: %s", host, gai_strerror(r));
+
+	if ((fd = socket(res->ai_family, res->ai_socktype,
+	    res->ai_protocol)) < 0)
+		err(EXIT_FAILURE, "socket");
+
+	if (connect(fd, res->ai_addr, res->ai_addrlen) < 0)
+		err(EXIT_FAILURE, "connect");
+
+	freeaddrinfo(res);
+
+	return fd;
+}
+
+/*
+ * Receive exactly 'size' bytes from the given stream socket.  Return 0 on
+ * success, or -1 if the connection was lost.
+ */
+static int
+recv_full(int fd, size_t size)
+{
+	size_t off;
+	ssize_t r;
+
+	for (off = 0; off < size; off += r)
+		if ((r = read(fd, buf, MIN(size - off, sizeof(buf)))) <= 0)
+			return -1;
+
+	return 0;
+}
+
+/*
+ * Take a snapshot of the LWIP per-stage cost counters.  Return 0 on success,
+ * or -1 if the counters are not available on this system.
+ */
+static int
+lwipstat_snapshot(uint64_t * vals)
+{
+	char name[64];
+	unsigned int i;
+	size_t len;
+
+	for (i = 0; i < __arraycount(lwipstat_names); i++) {
+		snprintf(name, sizeof(name), "minix.lwip.perf.%s",
+		    lwipstat_names[i]);
+
+		len = sizeof(vals[i]);
+
+		if (sysctlbyname(name, &vals[i], &len, NULL, 0) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Report the deltas of the LWIP per-stage cost counters over the measurement,
+ * along with the TSC frequency needed to convert cycle counts to time.
+ */
+static void
+lwipstat_report(void)
+{
+	uint64_t after[__arraycount(lwipstat_names)];
+	unsigned int i;
+	size_t len;
+	int tsc_khz;
+
+	if (lwipstat_snapshot(after) < 0) {
+		warnx("minix.lwip.perf counters are not available");
+
+		return;
+	}
+
+	len = sizeof(tsc_khz);
+
+	if (sysctlbyname("minix.lwip.perf.tsc_khz", &tsc_khz, &len, NULL,
+	    0) < 0)
+		tsc_khz = 0;
+
+	printf("netbench lwipstat tsc_khz=%d", tsc_khz);
+
+	for (i = 0; i < __arraycount(lwipstat_names); i++) {
+		/* Keep each stage's counters together on one line. */
+		if (i % 3 == 0)
+			printf("\nnetbench lwipstat");
+
+		printf(" %s=%" PRIu64, lwipstat_names[i],
+		    after[i] - lwipstat_before[i]);
+	}
+
+	printf("\n");
+}
+
+/*
+ * Run a bulk transfer test: send fixed-size messages back to back for the
+ * given duration, and report the achieved throughput.  The server end
+ * discards the data.  For UDP, the reported number is the send rate, which
+ * due to losses may exceed the rate of data actually arriving at the server.
+ */
+static void
+run_stream(const char * name, int fd, size_t msgsize, int duration)
+{
+	uint64_t t0, t1, bytes, msgs;
+	ssize_t r;
+
+	bytes = msgs = 0;
+
+	t0 = now_us();
+
+	alarm(duration);
+
+	while (!done) {
+		if ((r = write(fd, buf, msgsize)) <= 0) {
+			if (errno == EINTR)
+				continue;
+
+			err(EXIT_FAILURE, "write");
+		}
+
+		bytes += r;
+		msgs++;
+	}
+
+	t1 = now_us();
+
+	printf("netbench %s msgsize=%zu time_us=%" PRIu64 " msgs=%" PRIu64
+	    " bytes=%" PRIu64 " kb_per_s=%" PRIu64 "\n", name, msgsize,
+	    t1 - t0, msgs, bytes, bytes * 1000000 / 1024 / (t1 - t0));
+}
+
+/*
+ * Run a request-response test: send a fixed-size request and wait for the
+ * same amount of data to be echoed back, repeatedly, for the given duration.
+ * Report the transaction rate and the per-transaction latency distribution.
+ */
+static void
+run_rr(const char * name, int fd, size_t msgsize, int duration, int is_udp)
+{
+	struct timeval tv;
+	uint64_t t0, t1, t2, trans, lost, sum;
+	unsigned int i;
+	fd_set fds;
+	ssize_t r;
+
+	trans = lost = sum = 0;
+
+	t0 = now_us();
+
+	alarm(duration);
+
+	while (!done) {
+		t1 = now_us();
+
+		if ((r = write(fd, buf, msgsize)) <= 0) {
+			if (errno == EINTR)
+				continue;
+
+			err(EXIT_FAILURE, "write");
+		}
+
+		if (is_udp) {
+			/*
+			 * Datagrams may get lost.  Wait for the response with
+			 * a timeout, counting a timed-out transaction as lost
+			 * rather than including it in the latency figures.
+			 */
+			FD_ZERO(&fds);
+			FD_SET(fd, &fds);
+
+			tv.tv_sec = RR_TIMEOUT_SEC;
+			tv.tv_usec = 0;
+
+			if ((r = select(fd + 1, &fds, NULL, NULL, &tv)) < 0) {
+				if (errno == EINTR)
+					continue;
+
+				err(EXIT_FAILURE, "select");
+			}
+
+			if (r == 0) {
+				lost++;
+
+				continue;
+			}
+
+			if (recv(fd, buf, sizeof(buf), 0) <= 0)
+				err(EXIT_FAILURE, "recv");
+		} else {
+			if (recv_full(fd, msgsize) < 0)
+				errx(EXIT_FAILURE, "connection lost");
+		}
+
+		t2 = now_us();
+
+		if (nsamples < __arraycount(samples))
+			samples[nsamples++] = (uint32_t)(t2 - t1);
+
+		sum += t2 - t1;
+		trans++;
+	}
+
+	t2 = now_us();
+
+	printf("netbench %s msgsize=%zu time_us=%" PRIu64 " trans=%" PRIu64
+	    " lost=%" PRIu64 " trans_per_s=%" PRIu64 "\n", name, msgsize,
+	    t2 - t0, trans, lost, trans * 1000000 / (t2 - t0));
+
+	if (trans == 0)
+		return;
+
+	/* Sort the samples in order to extract percentiles. */
+	for (i = 1; i < nsamples; i++) {
+		uint32_t v = samples[i];
+		unsigned int j;
+
+		for (j = i; j > 0 && samples[j - 1] > v; j--)
+			samples[j] = samples[j - 1];
+
+		samples[j] = v;
+	}
+
+	printf("netbench %s latency unit=us n=%u min=%" PRIu32 " p50=%" PRIu32
+	    " p90=%" PRIu32 " p99=%" PRIu32 " max=%" PRIu32 " avg=%" PRIu64
+	    "\n", name, nsamples, samples[0], samples[nsamples / 2],
+	    samples[nsamples * 9 / 10], samples[nsamples * 99 / 100],
+	    samples[nsamples - 1], sum / trans);
+}
+
+int
+main(int argc, char * argv[])
+{
+	const char *host, *test;
+	size_t msgsize;
+	int c, fd, port, duration, server, lwipstat, is_udp, is_rr;
+
+	setprogname(argv[0]);
+
+	host = "127.0.0.1";
+	test = NULL;
+	port = PORT_DEFAULT;
+	duration = DURATION_DEFAULT;
+	msgsize = 0;
+	server = lwipstat = 0;
+
+	while ((c = getopt(argc, argv, "sH:p:t:l:m:P")) != -1) {
+		switch (c) {
+		case 's':
+			server = 1;
+			break;
+		case 'H':
+			host = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 't':
+			test = optarg;
+			break;
+		case 'l':
+			duration = atoi(optarg);
+			break;
+		case 'm':
+			msgsize = (size_t)atol(optarg);
+			break;
+		case 'P':
+			lwipstat = 1;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (port <= 0 || port > 65534 || duration <= 0 ||
+	    msgsize > MSGSIZE_MAX)
+		usage();
+
+	if (server) {
+		if (test != NULL)
+			usage();
+
+		serve(port);
+		/* NOTREACHED */
+	}
+
+	if (test == NULL)
+		usage();
+
+	if (!strcmp(test, "tcp_stream"))
+		is_udp = is_rr = 0;
+	else if (!strcmp(test, "udp_stream")) {
+		is_udp = 1;
+		is_rr = 0;
+	} else if (!strcmp(test, "tcp_rr")) {
+		is_udp = 0;
+		is_rr = 1;
+	} else if (!strcmp(test, "udp_rr"))
+		is_udp = is_rr = 1;
+	else
+		usage();
+
+	if (msgsize == 0)
+		msgsize = (is_rr) ? MSGSIZE_RR_DEF : MSGSIZE_STREAM_DEF;
+
+	memset(buf, 0x5a, sizeof(buf));
+
+	signal(SIGALRM, got_alarm);
+
+	fd = connect_socket(host, (is_udp) ? SOCK_DGRAM : SOCK_STREAM,
+	    port + is_rr);
+
+	if (lwipstat && lwipstat_snapshot(lwipstat_before) < 0) {
+		warnx("minix.lwip.perf counters are not available");
+
+		lwipstat = 0;
+	}
+
+	if (is_rr)
+		run_rr(test, fd, msgsize, duration, is_udp);
+	else
+		run_stream(test, fd, msgsize, duration);
+
+	if (lwipstat)
+		lwipstat_report();
+
+	close(fd);
+
+	return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@ usage(void)
 	fprintf(stderr, "  %s add [-a start[-end]] [-s skip] [-c count] [-rw] "
 	    "<action> [params]\n", getprogname());
 	fprintf(stderr, "  %s del N\n", getprogname());
+	fprintf(stderr, "  %s stats [-r]\n", getprogname());
 	fprintf(stderr, "\n");
 	fprintf(stderr, "actions and params:\n");
 	fprintf(stderr, "  corrupt [zero|persist|random]\n");
@@ -288,6 +289,104 @@ do_del(int fd, int argc, char ** argv, int off)
 	return EXIT_SUCCESS;
 }
 
+static int
+do_stats(int fd, int argc, char ** argv, int off)
+{
+	struct fbd_stats stats;
+	struct fbd_opstats *rd, *wr;
+	char buf[32];
+	u64_t size;
+	int i;
+
+	/* With -r, reset the statistics instead of printing them. */
+	if (argc > off + 1) {
+		if (strcmp(argv[off + 1], "-r"))
+			usage();
+
+		if (ioctl(fd, FBDCRESETSTATS)) {
+			perror("ioctl");
+
+			return EXIT_FAILURE;
+		}
+
+		printf("Statistics reset\n");
+
+		return EXIT_SUCCESS;
+	}
+
+	if (ioctl(fd, FBDCGETSTATS, &stats)) {
+		perror("ioctl");
+
+		return EXIT_FAILURE;
+	}
+
+	rd = &stats.read;
+	wr = &stats.write;
+
+	printf("%-10s %15s %15s\n", "", "READ", "WRITE");
+	printf("%-10s %15llu %15llu\n", "count",
+	    (unsigned long long) rd->count, (unsigned long long) wr->count);
+	printf("%-10s %15llu %15llu\n", "avg (us)",
+	    (unsigned long long) (rd->count ? rd->lat_sum / rd->count : 0),
+	    (unsigned long long) (wr->count ? wr->lat_sum / wr->count : 0));
+	printf("%-10s %15lu %15lu\n", "min (us)",
+	    (unsigned long) rd->lat_min, (unsigned long) wr->lat_min);
+	printf("%-10s %15lu %15lu\n", "max (us)",
+	    (unsigned long) rd->lat_max, (unsigned long) wr->lat_max);
+	printf("%-10s %15llu\n", "fbd (us)",
+	    (unsigned long long) stats.overhead);
+
+	/* Each latency bucket covers [2^i, 2^(i+1)) microseconds, and is
+	 * labeled with its lower bound; empty buckets are not printed.
+	 */
+	printf("\n%-10s %15s %15s\n", "lat (us)", "READ", "WRITE");
+
+	for (i = 0; i < FBD_LAT_BUCKETS; i++) {
+		if (rd->lat_hist[i] == 0 && wr->lat_hist[i] == 0)
+			continue;
+
+		if (i == FBD_LAT_BUCKETS - 1)
+			snprintf(buf, sizeof(buf), ">=%u", 1U << i);
+		else
+			snprintf(buf, sizeof(buf), "%u", i ? (1U << i) : 0);
+
+		printf("%-10s %15llu %15llu\n", buf,
+		    (unsigned long long) rd->lat_hist[i],
+		    (unsigned long long) wr->lat_hist[i]);
+	}
+
+	/* Same story for the size buckets, which start at 512 bytes. */
+	printf("\n%-10s %15s %8s %15s %8s\n", "size", "READ", "avg(us)",
+	    "WRITE", "avg(us)");
+
+	for (i = 0; i < FBD_SIZE_BUCKETS; i++) {
+		if (rd->size_count[i] == 0 && wr->size_count[i] == 0)
+			continue;
+
+		size = 512ULL << i;
+
+		if (i == FBD_SIZE_BUCKETS - 1)
+			snprintf(buf, sizeof(buf), ">=%lluK",
+			    (unsigned long long) (size / 1024));
+		else if (size < 1024)
+			snprintf(buf, sizeof(buf), "%llu",
+			    (unsigned long long) size);
+		else
+			snprintf(buf, sizeof(buf), "%lluK",
+			    (unsigned long long) (size / 1024));
+
+		printf("%-10s %15llu %8llu %15llu %8llu\n", buf,
+		    (unsigned long long) rd->size_count[i],
+		    (unsigned long long) (rd->size_count[i] ?
+		    rd->size_lat[i] / rd->size_count[i] : 0),
+		    (unsigned long long) wr->size_count[i],
+		    (unsigned long long) (wr->size_count[i] ?
+		    wr->size_lat[i] / wr->size_count[i] : 0));
+	}
+
+	return EXIT_SUCCESS;
+}
+
 int
 main(int argc, char ** argv)
 {
@@ -321,6 +420,8 @@ main(int argc, char ** argv)
 		r = do_add(fd, argc, argv, off);
 	else if (!strcmp(argv[off], "del"))
 		r = do_del(fd, argc, argv, off);
+	else if (!strcmp(argv[off], "stats"))
+		r = do_stats(fd, argc, argv, off);
 	else
 		usage();
 
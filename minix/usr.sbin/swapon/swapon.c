@@ -0,0 +1,77 @@
+/* swapon - hand a swap partition or file to VM for paging */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <minix/partition.h>
+#include <minix/com.h>
+#include <lib.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <err.h>
+
+static void __dead
+usage(void)
+{
+	fprintf(stderr, "usage: %s <device|file> [bytes]\n", getprogname());
+
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char ** argv)
+{
+	struct part_geom part;
+	struct stat st;
+	message m;
+	uint64_t size;
+	char *ep;
+	int fd;
+
+	setprogname(argv[0]);
+
+	if (argc != 2 && argc != 3) usage();
+
+	if ((fd = open(argv[1], O_RDWR)) < 0)
+		err(EXIT_FAILURE, "open %s", argv[1]);
+
+	if (fstat(fd, &st) < 0)
+		err(EXIT_FAILURE, "fstat %s", argv[1]);
+
+	/*
+	 * Determine the size of the swap space.  VM learns the size of a
+	 * regular file by itself, but not that of a block device, so always
+	 * pass the size along.
+	 */
+	if (S_ISBLK(st.st_mode)) {
+		if (ioctl(fd, DIOCGETP, &part) < 0)
+			err(EXIT_FAILURE, "ioctl %s", argv[1]);
+
+		size = part.size;
+	} else if (S_ISREG(st.st_mode)) {
+		size = st.st_size;
+	} else
+		errx(EXIT_FAILURE, "%s is not a block device or regular file",
+		    argv[1]);
+
+	if (argc == 3) {
+		size = strtoull(argv[2], &ep, 10);
+
+		if (argv[2][0] == '\0' || *ep != '\0' || size == 0)
+			usage();
+	}
+
+	memset(&m, 0, sizeof(m));
+	m.m_lc_vm_swapon.fd = fd;
+	m.m_lc_vm_swapon.size = size;
+
+	if (_syscall(VM_PROC_NR, VM_SWAPON, &m) < 0)
+		err(EXIT_FAILURE, "VM_SWAPON %s", argv[1]);
+
+	/* VM has made its own copy of the file descriptor by now. */
+	close(fd);
+
+	return EXIT_SUCCESS;
+}
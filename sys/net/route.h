@@ -233,6 +233,15 @@ struct rt_msghdr {
 #define RTM_IFINFO	0x14	/* iface/link going up/down etc. */
 #define RTM_CHGADDR	0x15	/* address properties changed */
 
+#if defined(__minix)
+/*
+ * Message type filtering, set through setsockopt(2) at level AF_ROUTE.  The
+ * option value is an array of uint8_t message types (RTM_) that are to be
+ * delivered to the socket; an empty array restores delivery of all messages.
+ */
+#define RO_MSGFILTER	1	/* array of which rtm_type to send to client */
+#endif /* defined(__minix) */
+
 #define RTV_MTU		0x1	/* init or lock _mtu */
 #define RTV_HOPCOUNT	0x2	/* init or lock _hopcount */
 #define RTV_EXPIRE	0x4	/* init or lock _expire */
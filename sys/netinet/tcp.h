@@ -130,6 +130,9 @@ struct tcphdr {
 #define	TCP_INFO	9	/* retrieve tcp_info structure */
 #define	TCP_MD5SIG	0x10	/* use MD5 digests (RFC2385) */
 #define	TCP_CONGCTL	0x20	/* selected congestion control */
+#if defined(__minix)
+#define	TCP_DEFER_ACCEPT 0x40	/* delay accept(2) until data arrives */
+#endif /* defined(__minix) */
 
 #define	TCPI_OPT_TIMESTAMPS	0x01
 #define	TCPI_OPT_SACK		0x02
@@ -172,7 +172,11 @@
 #define	ENOLINK		(_SIGN 95 )		/* Link has been severed */
 #define	EPROTO		(_SIGN 96 )		/* Protocol error */
 
-#define	ELAST		(_SIGN 96 )		/* Must equal largest errno */
+/* Robust mutexes */
+#define	EOWNERDEAD	(_SIGN 97 )		/* Previous owner died */
+#define	ENOTRECOVERABLE	(_SIGN 98 )		/* State not recoverable */
+
+#define	ELAST		(_SIGN 98 )		/* Must equal largest errno */
 
 #if defined(_KERNEL) || defined(_KMEMUSER)
 /* pseudo-errors returned inside kernel to modify return to process */
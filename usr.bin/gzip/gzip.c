@@ -49,6 +49,7 @@ __RCSID("$NetBSD: gzip.c,v 1.108 2015/04/15 02:29:12 christos Exp $");
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 
 #include <inttypes.h>
 #include <unistd.h>
@@ -169,6 +170,7 @@ static	int	numflag = 6;		/* gzip -1..-9 value */
 
 #ifndef SMALL
 static	int	fflag;			/* force mode */
+static	int	jflag = 1;		/* number of compression workers */
 static	int	kflag;			/* don't delete input files */
 static	int	nflag;			/* don't save name/timestamp */
 static	int	Nflag;			/* don't restore name/timestamp */
@@ -215,6 +217,8 @@ static	ssize_t	read_retry(int, void *, size_t);
 #define unlink_input(f, sb) unlink(f)
 #else
 static	off_t	cat_fd(unsigned char *, size_t, off_t *, int fd);
+static	off_t	gz_compress_parallel(int, int, off_t *, const char *,
+		    uint32_t);
 static	void	prepend_gzip(char *, int *, char ***);
 static	void	handle_dir(char *);
 static	void	print_verbage(const char *, const char *, off_t, off_t);
@@ -250,6 +254,7 @@ static const struct option longopts[] = {
 	{ "uncompress",		no_argument,		0,	'd' },
 	{ "force",		no_argument,		0,	'f' },
 	{ "help",		no_argument,		0,	'h' },
+	{ "jobs",		required_argument,	0,	'j' },
 	{ "keep",		no_argument,		0,	'k' },
 	{ "list",		no_argument,		0,	'l' },
 	{ "no-name",		no_argument,		0,	'n' },
@@ -279,7 +284,7 @@ main(int argc, char **argv)
 {
 	const char *progname = getprogname();
 #ifndef SMALL
-	char *gzip;
+	char *gzip, *ep;
 	int len;
 #endif
 	int ch;
@@ -304,7 +309,7 @@ main(int argc, char **argv)
 #ifdef SMALL
 #define OPT_LIST "123456789cdhlV"
 #else
-#define OPT_LIST "123456789cdfhklNnqrS:tVv"
+#define OPT_LIST "123456789cdfhj:klNnqrS:tVv"
 #endif
 
 	while ((ch = getopt_long(argc, argv, OPT_LIST, longopts, NULL)) != -1) {
@@ -331,6 +336,13 @@ main(int argc, char **argv)
 		case 'f':
 			fflag = 1;
 			break;
+		case 'j':
+			jflag = (int)strtol(optarg, &ep, 10);
+			if (*optarg == '\0' || *ep != '\0' ||
+			    jflag < 1 || jflag > 64)
+				errx(1, "incorrect number of jobs: '%s'",
+				    optarg);
+			break;
 		case 'k':
 			kflag = 1;
 			break;
@@ -537,6 +549,11 @@ gz_compress(int in, int out, off_t *gsizep, const char *origname, uint32_t mtime
 				 0, OS_CODE };
 #endif
 
+#ifndef SMALL
+	if (jflag > 1)
+		return gz_compress_parallel(in, out, gsizep, origname, mtime);
+#endif
+
 	outbufp = malloc(BUFLEN);
 	inbufp = malloc(BUFLEN);
 	if (outbufp == NULL || inbufp == NULL) {
@@ -688,6 +705,321 @@ out:
 	return in_tot;
 }
 
+#ifndef SMALL
+/*
+ * Parallel compression, in the style of pigz(1).  The input is cut into
+ * fixed-size blocks, which are handed out round-robin to a pool of worker
+ * processes.  Each worker compresses its block as an independent raw deflate
+ * fragment, terminated with a sync flush: an empty stored block that realigns
+ * the output to a byte boundary.  Since such fragments contain complete,
+ * non-final deflate blocks only, their in-order concatenation - followed by
+ * one empty final block - is itself a valid deflate stream, and the gzip
+ * header and trailer can be wrapped around it as usual, with the trailer CRC
+ * stitched together from the per-block CRCs using crc32_combine().  Workers
+ * are separate processes rather than threads, since that is the only way for
+ * the work to spread over multiple CPUs.  Each block is compressed without
+ * sight of the data preceding it, which costs a little compression ratio; the
+ * blocks are kept large enough to make the loss marginal.
+ */
+
+#define BLOCKLEN	(256 * 1024)	/* uncompressed bytes per block */
+#define BLOCKBOUND	(BLOCKLEN + BLOCKLEN / 500 + 64)
+
+struct worker {
+	pid_t		pid;
+	int		reqfd;		/* we write blocks to this */
+	int		respfd;		/* we read results from this */
+	uint32_t	pending;	/* input bytes awaiting collection */
+};
+
+/* write all of the given buffer, retrying on partial writes */
+static int
+write_retry(int fd, const void *buf, size_t sz)
+{
+	const char *cp = buf;
+	size_t left = sz;
+
+	while (left > 0) {
+		ssize_t ret;
+
+		ret = write(fd, cp, left);
+		if (ret == -1)
+			return -1;
+		cp += ret;
+		left -= ret;
+	}
+
+	return 0;
+}
+
+/*
+ * Worker main loop: read length-prefixed blocks from reqfd until a zero
+ * length arrives, compress each into a sync-flushed raw deflate fragment,
+ * and write the fragment back to respfd, preceded by its length and the
+ * CRC of the input block.
+ */
+__dead static void
+compress_worker(int reqfd, int respfd)
+{
+	z_stream z;
+	char *inbufp, *outbufp;
+	uint32_t head[2], len;
+	ssize_t hlen;
+	int error;
+
+	inbufp = malloc(BLOCKLEN);
+	outbufp = malloc(BLOCKBOUND);
+	if (inbufp == NULL || outbufp == NULL) {
+		maybe_warnx("malloc failed");
+		_exit(1);
+	}
+
+	memset(&z, 0, sizeof z);
+	z.zalloc = Z_NULL;
+	z.zfree = Z_NULL;
+	z.opaque = 0;
+	if (deflateInit2(&z, numflag, Z_DEFLATED, (-MAX_WBITS), 8,
+	    Z_DEFAULT_STRATEGY) != Z_OK) {
+		maybe_warnx("deflateInit2 failed");
+		_exit(1);
+	}
+
+	for (;;) {
+		hlen = read_retry(reqfd, &len, sizeof len);
+		if (hlen == 0)
+			_exit(0);	/* done; the parent closed the pipe */
+		if (hlen != sizeof len) {
+			maybe_warn("worker read");
+			_exit(1);
+		}
+		if (len == 0 || len > BLOCKLEN ||
+		    read_retry(reqfd, inbufp, len) != (ssize_t)len) {
+			maybe_warnx("worker block read failed");
+			_exit(1);
+		}
+
+		/*
+		 * Reset the stream for every block: in the stitched output,
+		 * this block does not follow the worker's previous one, so
+		 * no history may carry over into back-references.
+		 */
+		if (deflateReset(&z) != Z_OK) {
+			maybe_warnx("deflateReset failed");
+			_exit(1);
+		}
+		z.next_in = (unsigned char *)inbufp;
+		z.avail_in = len;
+		z.next_out = (unsigned char *)outbufp;
+		z.avail_out = BLOCKBOUND;
+
+		error = deflate(&z, Z_SYNC_FLUSH);
+		if (error != Z_OK || z.avail_in != 0) {
+			maybe_warnx("deflate failed");
+			_exit(1);
+		}
+
+		head[0] = (uint32_t)((char *)z.next_out - outbufp);
+		head[1] = crc32(0L, (const Bytef *)inbufp, (unsigned)len);
+		if (write_retry(respfd, head, sizeof head) == -1 ||
+		    write_retry(respfd, outbufp, head[0]) == -1) {
+			maybe_warn("worker write");
+			_exit(1);
+		}
+	}
+}
+
+/* collect one compressed block from a worker and write it to the output */
+static int
+collect_block(struct worker *wp, int out, char *outbufp, uLong *crcp,
+	      off_t *out_totp)
+{
+	uint32_t head[2];
+
+	if (read_retry(wp->respfd, head, sizeof head) != sizeof head ||
+	    head[0] > BLOCKBOUND ||
+	    read_retry(wp->respfd, outbufp, head[0]) != (ssize_t)head[0]) {
+		maybe_warnx("worker failed");
+		return -1;
+	}
+
+	if (write_retry(out, outbufp, head[0]) == -1) {
+		maybe_warn("write");
+		return -1;
+	}
+
+	*crcp = crc32_combine(*crcp, (uLong)head[1], (z_off_t)wp->pending);
+	*out_totp += head[0];
+	wp->pending = 0;
+	return 0;
+}
+
+/* compress input to output using worker processes; see above */
+static off_t
+gz_compress_parallel(int in, int out, off_t *gsizep, const char *origname,
+		     uint32_t mtime)
+{
+	struct worker *workers;
+	char *inbufp, *outbufp;
+	off_t in_tot = 0, out_tot = 0;
+	ssize_t in_size;
+	uint32_t len;
+	uLong crc;
+	int i, w, status;
+	/* one empty final block: BFINAL=1, BTYPE=fixed, end-of-block code */
+	static const char final_block[2] = { 0x03, 0x00 };
+
+	workers = calloc(jflag, sizeof *workers);
+	inbufp = malloc(BLOCKLEN);
+	outbufp = malloc(BLOCKBOUND);
+	if (workers == NULL || inbufp == NULL || outbufp == NULL)
+		maybe_err("malloc failed");
+
+	for (w = 0; w < jflag; w++) {
+		int req[2], resp[2];
+
+		if (pipe(req) == -1 || pipe(resp) == -1)
+			maybe_err("pipe");
+		switch (workers[w].pid = fork()) {
+		case -1:
+			maybe_err("fork");
+			/* NOTREACHED */
+		case 0:
+			close(req[1]);
+			close(resp[0]);
+			for (i = 0; i < w; i++) {
+				close(workers[i].reqfd);
+				close(workers[i].respfd);
+			}
+			compress_worker(req[0], resp[1]);
+			/* NOTREACHED */
+		default:
+			close(req[0]);
+			close(resp[1]);
+			workers[w].reqfd = req[1];
+			workers[w].respfd = resp[0];
+		}
+	}
+
+	if (nflag != 0) {
+		mtime = 0;
+		origname = "";
+	}
+
+	i = snprintf(outbufp, BLOCKBOUND, "%c%c%c%c%c%c%c%c%c%c%s",
+		     GZIP_MAGIC0, GZIP_MAGIC1, Z_DEFLATED,
+		     *origname ? ORIG_NAME : 0,
+		     mtime & 0xff,
+		     (mtime >> 8) & 0xff,
+		     (mtime >> 16) & 0xff,
+		     (mtime >> 24) & 0xff,
+		     numflag == 1 ? 4 : numflag == 9 ? 2 : 0,
+		     OS_CODE, origname);
+	if (i >= BLOCKBOUND)
+		maybe_err("snprintf");
+	if (*origname)
+		i++;
+
+	if (write_retry(out, outbufp, i) == -1) {
+		maybe_warn("write");
+		out_tot = -1;
+		in_tot = -1;
+		goto out;
+	}
+	out_tot += i;
+
+	/*
+	 * Hand out blocks round-robin.  A worker's previous result is always
+	 * collected before a new block is sent to it, so a worker we write to
+	 * is idle and draining its request pipe; this keeps the pipeline free
+	 * of deadlocks with jflag blocks in flight.
+	 */
+	crc = crc32(0L, Z_NULL, 0);
+	w = 0;
+	for (;;) {
+		in_size = read_retry(in, inbufp, BLOCKLEN);
+		if (in_size == -1) {
+			maybe_warn("read");
+			in_tot = -1;
+			goto out;
+		}
+		if (in_size == 0)
+			break;
+
+		if (workers[w].pending != 0 &&
+		    collect_block(&workers[w], out, outbufp, &crc,
+		    &out_tot) == -1) {
+			in_tot = -1;
+			goto out;
+		}
+
+		len = (uint32_t)in_size;
+		if (write_retry(workers[w].reqfd, &len, sizeof len) == -1 ||
+		    write_retry(workers[w].reqfd, inbufp, len) == -1) {
+			maybe_warn("worker write");
+			in_tot = -1;
+			goto out;
+		}
+		workers[w].pending = len;
+		in_tot += in_size;
+		w = (w + 1) % jflag;
+	}
+
+	/* collect the remaining blocks, oldest first */
+	for (i = 0; i < jflag; i++) {
+		struct worker *wp = &workers[(w + i) % jflag];
+
+		if (wp->pending != 0 &&
+		    collect_block(wp, out, outbufp, &crc, &out_tot) == -1) {
+			in_tot = -1;
+			goto out;
+		}
+	}
+
+	if (write_retry(out, final_block, sizeof final_block) == -1) {
+		maybe_warn("write");
+		in_tot = -1;
+		goto out;
+	}
+	out_tot += sizeof final_block;
+
+	i = snprintf(outbufp, BLOCKBOUND, "%c%c%c%c%c%c%c%c",
+		 (int)crc & 0xff,
+		 (int)(crc >> 8) & 0xff,
+		 (int)(crc >> 16) & 0xff,
+		 (int)(crc >> 24) & 0xff,
+		 (int)in_tot & 0xff,
+		 (int)(in_tot >> 8) & 0xff,
+		 (int)(in_tot >> 16) & 0xff,
+		 (int)(in_tot >> 24) & 0xff);
+	if (i != 8)
+		maybe_err("snprintf");
+	if (write_retry(out, outbufp, i) == -1) {
+		maybe_warn("write");
+		in_tot = -1;
+	} else
+		out_tot += i;
+
+out:
+	/* closing the request pipes tells the workers to exit */
+	for (w = 0; w < jflag; w++) {
+		close(workers[w].reqfd);
+		close(workers[w].respfd);
+	}
+	for (w = 0; w < jflag; w++) {
+		if (waitpid(workers[w].pid, &status, 0) == -1 ||
+		    !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			in_tot = -1;
+	}
+
+	free(outbufp);
+	free(inbufp);
+	free(workers);
+	if (gsizep)
+		*gsizep = out_tot;
+	return in_tot;
+}
+#endif /* !SMALL */
+
 /*
  * uncompress input to output then close the input.  return the
  * uncompressed size written, and put the compressed sized read
@@ -2051,6 +2383,7 @@ usage(void)
     "    --uncompress\n"
     " -f --force           force overwriting & compress links\n"
     " -h --help            display this help\n"
+    " -j num --jobs num    compress with num worker processes\n"
     " -k --keep            don't delete input files during operation\n"
     " -l --list            list compressed file contents\n"
     " -N --name            save or restore original file name and time stamp\n"
@@ -306,6 +306,8 @@ static const char *shellArgv = NULL;		  /* Custom shell args */
 
 STATIC Job	*job_table;	/* The structures that describe them */
 STATIC Job	*job_table_end;	/* job_table + maxJobs */
+static Job	**pid_hash;	/* direct-mapped pid -> job cache */
+static unsigned int pid_hash_mask; /* size of pid_hash, minus one */
 static int	wantToken;	/* we want a token */
 static int lurking_children = 0;
 static int make_suspended = 0;	/* non-zero if we've seen a SIGTSTP (etc) */
@@ -600,6 +602,19 @@ JobPassSig_suspend(int signo)
     (void)sigprocmask(SIG_SETMASK, &omask, NULL);
 }
 
+/*-
+ *-----------------------------------------------------------------------
+ * JobPidSlot  --
+ *	Return the pid_hash slot for the given pid.
+ *-----------------------------------------------------------------------
+ */
+static Job **
+JobPidSlot(int pid)
+{
+    /* Fibonacci hashing; the low pid bits alone distribute poorly. */
+    return &pid_hash[((unsigned int)pid * 2654435761U) & pid_hash_mask];
+}
+
 /*-
  *-----------------------------------------------------------------------
  * JobFindPid  --
@@ -607,6 +622,10 @@ JobPassSig_suspend(int signo)
  *	are equal. This function is called from Job_CatchChildren
  *	to find the job descriptor of the finished job.
  *
+ *	The pid_hash cache, maintained by JobExec, normally yields the job
+ *	without a scan; since slots may be overwritten on collision, a
+ *	cache miss still falls back to scanning the whole table.
+ *
  * Input:
  *	job		job to examine
  *	pid		process id desired
@@ -623,6 +642,10 @@ JobFindPid(int pid, int status, Boolean isJobs)
 {
     Job *job;
 
+    job = *JobPidSlot(pid);
+    if (job != NULL && job->job_state == status && job->pid == pid)
+	return job;
+
     for (job = job_table; job < job_table_end; job++) {
 	if ((job->job_state == status) && job->pid == pid)
 	    return job;
@@ -1397,6 +1420,7 @@ JobExec(Job *job, char **argv)
 
     /* Parent, continuing after the child exec */
     job->pid = cpid;
+    *JobPidSlot(cpid) = job;
 
     Trace_Log(JOBSTART, job);
 
@@ -2211,6 +2235,12 @@ Job_Init(void)
     job_table = bmake_malloc(maxJobs * sizeof *job_table);
     memset(job_table, 0, maxJobs * sizeof *job_table);
     job_table_end = job_table + maxJobs;
+    /* Four hash slots per job keep pid collisions rare */
+    for (pid_hash_mask = 4; pid_hash_mask < (unsigned int)maxJobs * 4;)
+	pid_hash_mask <<= 1;
+    pid_hash = bmake_malloc(pid_hash_mask * sizeof *pid_hash);
+    memset(pid_hash, 0, pid_hash_mask * sizeof *pid_hash);
+    pid_hash_mask--;
     wantToken =	0;
 
     aborting = 	  0;
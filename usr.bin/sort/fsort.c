@@ -93,7 +93,7 @@ fsort(struct filelist *filelist, int nfiles, FILE *outfp, struct field *ftbl)
 	RECHEADER *nbuffer;
 	FILE *fp, *tmp_fp;
 	int file_no;
-	int max_recs = DEBUG('m') ? 16 : MAXNUM;
+	int max_recs = DEBUG('m') ? 16 : maxrecnum;
 
 	buffer = allocrec(NULL, bufsize);
 	bufend = (u_char *)buffer + bufsize;
@@ -120,6 +120,7 @@ fsort(struct filelist *filelist, int nfiles, FILE *outfp, struct field *ftbl)
 	fp = fopen(filelist->names[0], "r");
 	if (fp == NULL)
 		err(2, "%s", filelist->names[0]);
+	(void)setvbuf(fp, NULL, _IOFBF, IOBUFSIZE);
 
 	/* Loop through reads of chunk of input files that get sorted
 	 * and then merged together. */
@@ -156,10 +157,11 @@ fsort(struct filelist *filelist, int nfiles, FILE *outfp, struct field *ftbl)
 				fp = fopen(filelist->names[file_no], "r");
 				if (fp == NULL)
 					err(2, "%s", filelist->names[file_no]);
+				(void)setvbuf(fp, NULL, _IOFBF, IOBUFSIZE);
 				continue;
 			}
 			if (nelem >= max_recs
-			    || (bufsize >= MAXBUFSIZE && nelem > 8))
+			    || (bufsize >= maxbufsize && nelem > 8))
 				/* Need to sort and save this lot of data */
 				break;
 
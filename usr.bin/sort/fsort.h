@@ -73,6 +73,19 @@
  * Default (initial) and maximum size of record buffer for fsort().
  * Note that no more than MAXNUM records are stored in the buffer,
  * even if the buffer is not full yet.
+ * Both maximums are defaults: setmemlimits() raises maxbufsize and
+ * maxrecnum above them on systems that report enough free memory.
+ * Longer in-memory runs mean fewer temporary files and fewer merge
+ * passes over the data.
  */
 #define DEFBUFSIZE	(1 << 20)	/* 1MB */
 #define MAXBUFSIZE	(8 << 20)	/* 10 MB */
+#define TOPBUFSIZE	(256 << 20)	/* never size runs beyond this */
+
+/*
+ * Size of the stdio buffers for the bulk data files: the input files,
+ * the temporary run files and the output file.  All of these are read
+ * and written strictly sequentially, so fewer, larger transfers only
+ * help.
+ */
+#define IOBUFSIZE	(1 << 18)	/* 256KB */
@@ -62,6 +62,8 @@
  */
 
 #include "sort.h"
+#include "fsort.h"
+#include "pathnames.h"
 
 __RCSID("$NetBSD: init.c,v 1.29 2013/10/18 20:47:06 christos Exp $");
 
@@ -448,3 +450,48 @@ settables(void)
 			dtable[i] = 1;
 	}
 }
+
+/*
+ * Maximum size of the fsort() record buffer and maximum number of records
+ * held in it, as possibly raised from their built-in defaults below.
+ */
+size_t maxbufsize = MAXBUFSIZE;
+int maxrecnum = MAXNUM;
+
+/*
+ * Size the in-memory sort run to the machine.  The built-in maximums date
+ * from machines where 8MB was a lot; with multi-GB inputs they produce
+ * hundreds of temporary run files and multiple cascaded merge passes.  When
+ * the system tells us how much memory is actually free, claim a quarter of
+ * it for run generation, so that runs are as long as reasonably possible and
+ * most of the merging work disappears.  The record count limit is scaled
+ * along with the buffer so that it does not become the effective cap.
+ */
+void
+setmemlimits(void)
+{
+#if defined(__minix)
+	FILE *fp;
+	unsigned int pagesize;
+	unsigned long total, freemem, largest, cached;
+	size_t sz;
+
+	if ((fp = fopen(_PATH_MEMINFO, "r")) == NULL)
+		return;
+	if (fscanf(fp, "%u %lu %lu %lu %lu", &pagesize, &total, &freemem,
+	    &largest, &cached) != 5) {
+		(void)fclose(fp);
+		return;
+	}
+	(void)fclose(fp);
+
+	sz = (size_t)pagesize * (freemem / 4);
+	if (sz <= MAXBUFSIZE)
+		return;
+	if (sz > TOPBUFSIZE)
+		sz = TOPBUFSIZE;
+
+	maxbufsize = sz;
+	maxrecnum = MAXNUM * (sz / MAXBUFSIZE);
+#endif /* defined(__minix) */
+}
@@ -86,9 +86,12 @@ static int insert(struct mfile **, struct mfile *, int, int);
 static void merge_sort_fstack(FILE *, put_func_t, struct field *);
 
 /*
- * Number of files merge() can merge in one pass.
+ * Number of files merge() can merge in one pass.  Each active input costs a
+ * record buffer (DEFLLEN, growing on demand) plus a stdio buffer, so the
+ * memory cost of a wide merge is modest, while every widening of the merge
+ * divides the number of passes over the full data set.
  */
-#define MERGE_FNUM      16
+#define MERGE_FNUM      64
 
 static struct mfile fstack[MERGE_FNUM];
 static struct mfile fstack_1[MERGE_FNUM];
@@ -110,7 +113,7 @@ save_for_merge(FILE *fp, get_func_t get, struct field *ftbl)
 			memcpy(fstack, fstack_1, sizeof fstack);
 			merge_sort_fstack(mfp1, putrec, ftbl);
 			if (fstack_2_count == MERGE_FNUM) {
-				/* More than 4096 files! */
+				/* More than MERGE_FNUM^3 files! */
 				mfp2 = ftmp();
 				memcpy(fstack, fstack_2, sizeof fstack);
 				merge_sort_fstack(mfp2, putrec, ftbl);
@@ -150,6 +153,7 @@ fmerge(struct filelist *filelist, int nfiles, FILE *outfp, struct field *ftbl)
 		fp = fopen(filelist->names[i], "r");
 		if (fp == NULL)
 			err(2, "%s", filelist->names[i]);
+		(void)setvbuf(fp, NULL, _IOFBF, IOBUFSIZE);
 		save_for_merge(fp, get, ftbl);
 	}
 
@@ -64,3 +64,6 @@
  */
 
 #define	 _PATH_STDIN		"/dev/stdin"
+#if defined(__minix)
+#define	 _PATH_MEMINFO		"/proc/meminfo"
+#endif /* defined(__minix) */
@@ -302,6 +302,7 @@ main(int argc, char *argv[])
 	}
 
 	settables();
+	setmemlimits();
 
 	if (optind == argc) {
 		static const char * const names[] = { _PATH_STDIN, NULL };
@@ -355,6 +356,9 @@ main(int argc, char *argv[])
 			err(2, "output file %s", outfile);
 	}
 
+	/* All output is sequential; write it in large chunks. */
+	(void)setvbuf(outfp, NULL, _IOFBF, IOBUFSIZE);
+
 	if (mflag)
 		fmerge(&filelist, num_input_files, outfp, fldtab);
 	else
@@ -169,6 +169,8 @@ extern u_char ascii[NBINS], Rascii[NBINS], Ftable[NBINS], RFtable[NBINS];
 extern u_char *const weight_tables[4];   /* ascii, Rascii, Ftable, RFtable */
 extern u_char d_mask[NBINS];
 extern int SINGL_FLD, SEP_FLAG, UNIQUE, REVERSE;
+extern size_t maxbufsize;
+extern int maxrecnum;
 extern int posix_sort;
 extern int REC_D;
 extern const char *tmpdir;
@@ -201,4 +203,5 @@ void	 putkeydump(const RECHEADER *, FILE *);
 void	 rd_append(int, int, int, FILE *, u_char *, u_char *);
 void	 radix_sort(RECHEADER **, RECHEADER **, int);
 int	 setfield(const char *, struct field *, int);
+void	 setmemlimits(void);
 void	 settables(void);
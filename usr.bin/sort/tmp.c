@@ -77,6 +77,7 @@ __RCSID("$NetBSD: tmp.c,v 1.16 2009/11/06 18:34:22 joerg Exp $");
 #include <unistd.h>
 
 #include "sort.h"
+#include "fsort.h"
 #include "pathnames.h"
 
 #define _NAME_TMP "sort.XXXXXXXX"
@@ -98,6 +99,8 @@ ftmp(void)
 		err(2, "ftmp: mkstemp(\"%s\")", path);
 	if (!(fp = fdopen(fd, "w+")))
 		err(2, "ftmp: fdopen(\"%s\")", path);
+	/* Runs are written and then merged back strictly sequentially. */
+	(void)setvbuf(fp, NULL, _IOFBF, IOBUFSIZE);
 	if (!DEBUG('t'))
 		(void)unlink(path);
 
@@ -59,16 +59,55 @@ __RCSID("$NetBSD: buf.c,v 1.22 2015/03/29 05:52:59 agc Exp $");
 
 TAILQ_HEAD(buftailhead,buf) buftail;
 
+/*
+ * Write-behind buffer.  bwrite() coalesces writes of adjacent blocks into
+ * this buffer and bflush() writes the whole run to the image with a single
+ * large write, instead of issuing one small write per block.
+ */
+#define	WB_SIZE	(1024 * 1024)
+static char	*wbbuf;
+static off_t	wboffset;		/* image offset of the buffered run */
+static size_t	wblen;			/* number of bytes buffered */
+static int	wbfd = -1;		/* image fd the buffer belongs to */
+
+int
+bflush(void)
+{
+	ssize_t	rv;
+
+	if (wblen == 0)
+		return (0);
+	if (debug & DEBUG_BUF_BWRITE)
+		printf("bflush: offset %lld len %zu\n",
+		    (long long)wboffset, wblen);
+	if (lseek(wbfd, wboffset, SEEK_SET) == -1)
+		return (errno);
+	rv = write(wbfd, wbbuf, wblen);
+	if (rv == -1)			/* write error */
+		return (errno);
+	if ((size_t)rv != wblen)	/* short write ? */
+		return (EAGAIN);
+	wblen = 0;
+	return (0);
+}
+
 int
 bread(struct vnode *vp, daddr_t blkno, int size, int u2 __unused,
 	struct buf **bpp)
 {
 	off_t	offset;
 	ssize_t	rv;
+	int	error;
 	fsinfo_t *fs = vp->fs;
 
 	assert (bpp != NULL);
 
+	/* Reads must see all completed writes. */
+	if ((error = bflush()) != 0) {
+		errno = error;
+		err(1, "%s: flushing pending writes", __func__);
+	}
+
 	if (debug & DEBUG_BUF_BREAD)
 		printf("bread: blkno %lld size %d\n", (long long)blkno, size);
 	*bpp = getblk(vp, blkno, size, 0, 0);
@@ -129,7 +168,7 @@ bwrite(struct buf *bp)
 {
 	off_t	offset;
 	ssize_t	rv;
-	int	bytes;
+	int	bytes, error;
 	fsinfo_t *fs = bp->b_fs;
 
 	assert (bp != NULL);
@@ -138,32 +177,66 @@ bwrite(struct buf *bp)
 	if (debug & DEBUG_BUF_BWRITE)
 		printf("bwrite: blkno %lld offset %lld bcount %d\n",
 		    (long long)bp->b_blkno, (long long) offset, bytes);
-	if (lseek(bp->b_fs->fd, offset, SEEK_SET) == -1)
-		return (errno);
-	rv = write(bp->b_fs->fd, bp->b_data, bytes);
-	if (debug & DEBUG_BUF_BWRITE)
-		printf("bwrite: write %ld (offset %lld) returned %lld\n",
-		    bp->b_bcount, (long long)offset, (long long)rv);
+	if (wbbuf == NULL)
+		wbbuf = emalloc(WB_SIZE);
+	/*
+	 * Flush the write-behind buffer first if this block is not adjacent
+	 * to the buffered run, belongs to another image, or does not fit.
+	 */
+	if (wblen > 0 && (fs->fd != wbfd ||
+	    offset != wboffset + (off_t)wblen ||
+	    wblen + (size_t)bytes > WB_SIZE)) {
+		if ((error = bflush()) != 0) {
+			brelse(bp, 0);
+			return (error);
+		}
+	}
+	if ((size_t)bytes > WB_SIZE) {
+		/* Too large to buffer; write it out directly. */
+		if (lseek(fs->fd, offset, SEEK_SET) == -1) {
+			error = errno;
+			brelse(bp, 0);
+			return (error);
+		}
+		rv = write(fs->fd, bp->b_data, bytes);
+		if (debug & DEBUG_BUF_BWRITE)
+			printf("bwrite: write %ld (offset %lld) returned %lld\n",
+			    bp->b_bcount, (long long)offset, (long long)rv);
+		brelse(bp, 0);
+		if (rv == bytes)
+			return (0);
+		else if (rv == -1)	/* write error */
+			return (errno);
+		else			/* short write ? */
+			return (EAGAIN);
+	}
+	if (wblen == 0) {
+		wbfd = fs->fd;
+		wboffset = offset;
+	}
+	memcpy(wbbuf + wblen, bp->b_data, bytes);
+	wblen += bytes;
 	brelse(bp, 0);
-	if (rv == bytes)
-		return (0);
-	else if (rv == -1)		/* write error */
-		return (errno);
-	else				/* short write ? */
-		return (EAGAIN);
+	return (0);
 }
 
 void
 bcleanup(void)
 {
 	struct buf *bp;
+	int error;
+
+	if ((error = bflush()) != 0) {
+		errno = error;
+		err(1, "%s: flushing pending writes", __func__);
+	}
 
 	/*
 	 * XXX	this really shouldn't be necessary, but i'm curious to
 	 *	know why there's still some buffers lying around that
 	 *	aren't brelse()d
 	 */
-	
+
 	if (TAILQ_EMPTY(&buftail))
 		return;
 
@@ -75,6 +75,7 @@ struct buf {
 
 struct kauth_cred;
 void		bcleanup(void);
+int		bflush(void);
 int		bread(struct vnode *, daddr_t, int, int, struct buf **);
 void		brelse(struct buf *, int);
 int		bwrite(struct buf *);
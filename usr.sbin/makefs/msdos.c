@@ -196,6 +196,10 @@ msdos_makefs(const char *image, const char *dir, fsnode *root, fsinfo_t *fsopts)
 	if (debug & DEBUG_FS_MAKEFS)
 		bcleanup();
 
+		/* write out any data still in the write-behind buffer */
+	if ((errno = bflush()) != 0)
+		err(1, "Flushing `%s'", image);
+
 	printf("Image `%s' complete\n", image);
 }
 
@@ -135,9 +135,10 @@ do {									\
 int
 compare(NODE *s, FTSENT *p)
 {
-	u_int32_t len, val, flags;
-	int fd, label;
+	u_int32_t len, flags;
+	int dflags, digesterr, label;
 	const char *cp, *tab;
+	struct mtree_digest dig;
 #if !defined(NO_MD5) || !defined(NO_RMD160) || !defined(NO_SHA1) || !defined(NO_SHA2)
 	char *digestbuf;
 #endif
@@ -400,36 +401,53 @@ typeerr:		LABEL;
 	 * occurs, only checking of stuff like checksums and symlinks.
 	 */
  afterpermwhack:
+	/*
+	 * Compute all requested checksums and digests in a single pass over
+	 * the file, instead of rereading it once for each key.
+	 */
+	dflags = s->flags & (F_CKSUM
+#ifndef NO_MD5
+	    | F_MD5
+#endif
+#ifndef NO_RMD160
+	    | F_RMD160
+#endif
+#ifndef NO_SHA1
+	    | F_SHA1
+#endif
+#ifndef NO_SHA2
+	    | F_SHA256 | F_SHA384 | F_SHA512
+#endif
+	    );
+	digesterr = 0;
+	if (dflags != 0 && digest_file(p->fts_accpath, dflags, &dig) == -1)
+		digesterr = errno;
+
 	if (s->flags & F_CKSUM) {
-		if ((fd = open(p->fts_accpath, O_RDONLY, 0)) < 0) {
-			LABEL;
-			printf("%scksum: %s: %s\n",
-			    tab, p->fts_accpath, strerror(errno));
-			tab = "\t";
-		} else if (crc(fd, &val, &len)) {
-			close(fd);
+		if (digesterr != 0) {
 			LABEL;
 			printf("%scksum: %s: %s\n",
-			    tab, p->fts_accpath, strerror(errno));
+			    tab, p->fts_accpath, strerror(digesterr));
 			tab = "\t";
 		} else {
-			close(fd);
-			if (s->cksum != val) {
+			if (s->cksum != dig.d_cksum) {
 				LABEL;
 				printf(flavor == F_FREEBSD9 ?
 				    "%scksum expected %lu found %lu\n" :
 				    "%scksum (%lu, %lu)\n",
-				    tab, s->cksum, (unsigned long)val);
+				    tab, s->cksum,
+				    (unsigned long)dig.d_cksum);
 			}
 			tab = "\t";
 		}
 	}
 #ifndef NO_MD5
 	if (s->flags & F_MD5) {
-		if ((digestbuf = MD5File(p->fts_accpath, NULL)) == NULL) {
+		if ((digestbuf = dig.d_md5) == NULL) {
 			LABEL;
 			printf("%s%s: %s: %s\n",
-			    tab, MD5KEY, p->fts_accpath, strerror(errno));
+			    tab, MD5KEY, p->fts_accpath,
+			    strerror(digesterr != 0 ? digesterr : errno));
 			tab = "\t";
 		} else {
 			if (strcmp(s->md5digest, digestbuf)) {
@@ -440,16 +458,16 @@ typeerr:		LABEL;
 				    tab, MD5KEY, s->md5digest, digestbuf);
 			}
 			tab = "\t";
-			free(digestbuf);
 		}
 	}
 #endif	/* ! NO_MD5 */
 #ifndef NO_RMD160
 	if (s->flags & F_RMD160) {
-		if ((digestbuf = RMD160File(p->fts_accpath, NULL)) == NULL) {
+		if ((digestbuf = dig.d_rmd160) == NULL) {
 			LABEL;
 			printf("%s%s: %s: %s\n",
-			    tab, RMD160KEY, p->fts_accpath, strerror(errno));
+			    tab, RMD160KEY, p->fts_accpath,
+			    strerror(digesterr != 0 ? digesterr : errno));
 			tab = "\t";
 		} else {
 			if (strcmp(s->rmd160digest, digestbuf)) {
@@ -460,16 +478,16 @@ typeerr:		LABEL;
 				    tab, RMD160KEY, s->rmd160digest, digestbuf);
 			}
 			tab = "\t";
-			free(digestbuf);
 		}
 	}
 #endif	/* ! NO_RMD160 */
 #ifndef NO_SHA1
 	if (s->flags & F_SHA1) {
-		if ((digestbuf = SHA1File(p->fts_accpath, NULL)) == NULL) {
+		if ((digestbuf = dig.d_sha1) == NULL) {
 			LABEL;
 			printf("%s%s: %s: %s\n",
-			    tab, SHA1KEY, p->fts_accpath, strerror(errno));
+			    tab, SHA1KEY, p->fts_accpath,
+			    strerror(digesterr != 0 ? digesterr : errno));
 			tab = "\t";
 		} else {
 			if (strcmp(s->sha1digest, digestbuf)) {
@@ -480,16 +498,16 @@ typeerr:		LABEL;
 				    tab, SHA1KEY, s->sha1digest, digestbuf);
 			}
 			tab = "\t";
-			free(digestbuf);
 		}
 	}
 #endif	/* ! NO_SHA1 */
 #ifndef NO_SHA2
 	if (s->flags & F_SHA256) {
-		if ((digestbuf = SHA256_File(p->fts_accpath, NULL)) == NULL) {
+		if ((digestbuf = dig.d_sha256) == NULL) {
 			LABEL;
 			printf("%s%s: %s: %s\n",
-			    tab, SHA256KEY, p->fts_accpath, strerror(errno));
+			    tab, SHA256KEY, p->fts_accpath,
+			    strerror(digesterr != 0 ? digesterr : errno));
 			tab = "\t";
 		} else {
 			if (strcmp(s->sha256digest, digestbuf)) {
@@ -500,15 +518,15 @@ typeerr:		LABEL;
 				    tab, SHA256KEY, s->sha256digest, digestbuf);
 			}
 			tab = "\t";
-			free(digestbuf);
 		}
 	}
 #ifdef SHA384_BLOCK_LENGTH
 	if (s->flags & F_SHA384) {
-		if ((digestbuf = SHA384_File(p->fts_accpath, NULL)) == NULL) {
+		if ((digestbuf = dig.d_sha384) == NULL) {
 			LABEL;
 			printf("%s%s: %s: %s\n",
-			    tab, SHA384KEY, p->fts_accpath, strerror(errno));
+			    tab, SHA384KEY, p->fts_accpath,
+			    strerror(digesterr != 0 ? digesterr : errno));
 			tab = "\t";
 		} else {
 			if (strcmp(s->sha384digest, digestbuf)) {
@@ -519,15 +537,15 @@ typeerr:		LABEL;
 				    tab, SHA384KEY, s->sha384digest, digestbuf);
 			}
 			tab = "\t";
-			free(digestbuf);
 		}
 	}
 #endif
 	if (s->flags & F_SHA512) {
-		if ((digestbuf = SHA512_File(p->fts_accpath, NULL)) == NULL) {
+		if ((digestbuf = dig.d_sha512) == NULL) {
 			LABEL;
 			printf("%s%s: %s: %s\n",
-			    tab, SHA512KEY, p->fts_accpath, strerror(errno));
+			    tab, SHA512KEY, p->fts_accpath,
+			    strerror(digesterr != 0 ? digesterr : errno));
 			tab = "\t";
 		} else {
 			if (strcmp(s->sha512digest, digestbuf)) {
@@ -538,10 +556,11 @@ typeerr:		LABEL;
 				    tab, SHA512KEY, s->sha512digest, digestbuf);
 			}
 			tab = "\t";
-			free(digestbuf);
 		}
 	}
 #endif	/* ! NO_SHA2 */
+	if (dflags != 0)
+		free_digest(&dig);
 	if (s->flags & F_SLINK &&
 	    strcmp(cp = rlink(p->fts_accpath), s->slink)) {
 		LABEL;
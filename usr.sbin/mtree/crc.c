@@ -47,10 +47,27 @@ __RCSID("$NetBSD: crc.c,v 1.9 2012/10/05 00:40:51 christos Exp $");
 
 #include <sys/types.h>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
+#ifndef NO_MD5
+#include <md5.h>
+#endif
+#ifndef NO_RMD160
+#include <rmd160.h>
+#endif
+#ifndef NO_SHA1
+#include <sha1.h>
+#endif
+#ifndef NO_SHA2
+#include <sha2.h>
+#endif
+
 #include "extern.h"
 
 static const u_int32_t crctab[] = {
@@ -161,3 +178,179 @@ crc(int fd, u_int32_t *cval, u_int32_t *clen)
 		crc_total = ~crctot;
 	return 0;
 }
+
+/*
+ * Compute all of the file checksums and digests requested in `flags' in a
+ * single pass over the file, instead of reopening and rereading the file
+ * once per requested key.  Returns 0 on success and -1 on failure, setting
+ * errno.  The digest strings stored in `dig' are allocated; the caller
+ * frees them, e.g. with free_digest().
+ */
+int
+digest_file(const char *path, int flags, struct mtree_digest *dig)
+{
+#ifndef NO_MD5
+	MD5_CTX md5ctx;
+#endif
+#ifndef NO_RMD160
+	RMD160_CTX rmd160ctx;
+#endif
+#ifndef NO_SHA1
+	SHA1_CTX sha1ctx;
+#endif
+#ifndef NO_SHA2
+	SHA256_CTX sha256ctx;
+#ifdef SHA384_BLOCK_LENGTH
+	SHA384_CTX sha384ctx;
+#endif
+	SHA512_CTX sha512ctx;
+#endif
+	u_char *p, buf[64 * 1024];
+	u_int32_t thecrc, crctot, len;
+	ssize_t nr, nb;
+	int fd, serrno;
+
+	memset(dig, 0, sizeof(*dig));
+
+	if ((fd = open(path, O_RDONLY, 0)) < 0)
+		return -1;
+
+	thecrc = len = crctot = 0;
+	if (sflag)
+		crctot = ~crc_total;
+#ifndef NO_MD5
+	if (flags & F_MD5)
+		MD5Init(&md5ctx);
+#endif
+#ifndef NO_RMD160
+	if (flags & F_RMD160)
+		RMD160Init(&rmd160ctx);
+#endif
+#ifndef NO_SHA1
+	if (flags & F_SHA1)
+		SHA1Init(&sha1ctx);
+#endif
+#ifndef NO_SHA2
+	if (flags & F_SHA256)
+		SHA256_Init(&sha256ctx);
+#ifdef SHA384_BLOCK_LENGTH
+	if (flags & F_SHA384)
+		SHA384_Init(&sha384ctx);
+#endif
+	if (flags & F_SHA512)
+		SHA512_Init(&sha512ctx);
+#endif
+
+	while ((nr = read(fd, buf, sizeof(buf))) > 0) {
+		if (flags & F_CKSUM) {
+			if (sflag) {
+				for (len += nr, nb = nr, p = buf; nb--; ++p) {
+					COMPUTE(thecrc, *p);
+					COMPUTE(crctot, *p);
+				}
+			} else {
+				for (len += nr, nb = nr, p = buf; nb--; ++p)
+					COMPUTE(thecrc, *p);
+			}
+		}
+#ifndef NO_MD5
+		if (flags & F_MD5)
+			MD5Update(&md5ctx, buf, (unsigned int)nr);
+#endif
+#ifndef NO_RMD160
+		if (flags & F_RMD160)
+			RMD160Update(&rmd160ctx, buf, (unsigned int)nr);
+#endif
+#ifndef NO_SHA1
+		if (flags & F_SHA1)
+			SHA1Update(&sha1ctx, buf, (unsigned int)nr);
+#endif
+#ifndef NO_SHA2
+		if (flags & F_SHA256)
+			SHA256_Update(&sha256ctx, buf, (size_t)nr);
+#ifdef SHA384_BLOCK_LENGTH
+		if (flags & F_SHA384)
+			SHA384_Update(&sha384ctx, buf, (size_t)nr);
+#endif
+		if (flags & F_SHA512)
+			SHA512_Update(&sha512ctx, buf, (size_t)nr);
+#endif
+	}
+	serrno = errno;
+	(void)close(fd);
+	if (nr < 0) {
+		errno = serrno;
+		return -1;
+	}
+
+	if (flags & F_CKSUM) {
+		dig->d_csumlen = len;
+
+		/* Include the length of the file. */
+		if (sflag) {
+			for (; len != 0; len >>= 8) {
+				COMPUTE(thecrc, len & 0xff);
+				COMPUTE(crctot, len & 0xff);
+			}
+		} else {
+			for (; len != 0; len >>= 8)
+				COMPUTE(thecrc, len & 0xff);
+		}
+
+		dig->d_cksum = ~thecrc;
+		if (sflag)
+			crc_total = ~crctot;
+	}
+#ifndef NO_MD5
+	if (flags & F_MD5)
+		dig->d_md5 = MD5End(&md5ctx, NULL);
+#endif
+#ifndef NO_RMD160
+	if (flags & F_RMD160)
+		dig->d_rmd160 = RMD160End(&rmd160ctx, NULL);
+#endif
+#ifndef NO_SHA1
+	if (flags & F_SHA1)
+		dig->d_sha1 = SHA1End(&sha1ctx, NULL);
+#endif
+#ifndef NO_SHA2
+	if (flags & F_SHA256)
+		dig->d_sha256 = SHA256_End(&sha256ctx, NULL);
+#ifdef SHA384_BLOCK_LENGTH
+	if (flags & F_SHA384)
+		dig->d_sha384 = SHA384_End(&sha384ctx, NULL);
+#endif
+	if (flags & F_SHA512)
+		dig->d_sha512 = SHA512_End(&sha512ctx, NULL);
+#endif
+	return 0;
+}
+
+/*
+ * Free the digest strings computed by digest_file().
+ */
+void
+free_digest(struct mtree_digest *dig)
+{
+
+#ifndef NO_MD5
+	free(dig->d_md5);
+	dig->d_md5 = NULL;
+#endif
+#ifndef NO_RMD160
+	free(dig->d_rmd160);
+	dig->d_rmd160 = NULL;
+#endif
+#ifndef NO_SHA1
+	free(dig->d_sha1);
+	dig->d_sha1 = NULL;
+#endif
+#ifndef NO_SHA2
+	free(dig->d_sha256);
+	dig->d_sha256 = NULL;
+	free(dig->d_sha384);
+	dig->d_sha384 = NULL;
+	free(dig->d_sha512);
+	dig->d_sha512 = NULL;
+#endif
+}
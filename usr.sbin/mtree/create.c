@@ -181,12 +181,9 @@ cwalk(FILE *fp)
 static void
 statf(FILE *fp, int indent, FTSENT *p)
 {
-	u_int32_t len, val;
-	int fd, offset;
+	int dflags, offset;
 	const char *name = NULL;
-#if !defined(NO_MD5) || !defined(NO_RMD160) || !defined(NO_SHA1) || !defined(NO_SHA2)
-	char *digestbuf;
-#endif
+	struct mtree_digest dig;
 
 	offset = fprintf(fp, "%*s%s%s", indent, "",
 	    S_ISDIR(p->fts_statp->st_mode) ? "" : "    ", vispath(p->fts_name));
@@ -238,65 +235,84 @@ statf(FILE *fp, int indent, FTSENT *p)
 		output(fp, indent, &offset, "time=%jd.%09ld",
 		    (intmax_t)p->fts_statp->st_mtime, (long)0);
 #endif
-	if (keys & F_CKSUM && S_ISREG(p->fts_statp->st_mode)) {
-		if ((fd = open(p->fts_accpath, O_RDONLY, 0)) < 0 ||
-		    crc(fd, &val, &len))
+	/*
+	 * Compute all requested checksums and digests in a single pass over
+	 * the file, instead of rereading it once for each key.
+	 */
+	dflags = keys & (F_CKSUM
+#ifndef NO_MD5
+	    | F_MD5
+#endif
+#ifndef NO_RMD160
+	    | F_RMD160
+#endif
+#ifndef NO_SHA1
+	    | F_SHA1
+#endif
+#ifndef NO_SHA2
+	    | F_SHA256 | F_SHA384 | F_SHA512
+#endif
+	    );
+	if (dflags != 0 && S_ISREG(p->fts_statp->st_mode)) {
+		if (digest_file(p->fts_accpath, dflags, &dig) == -1)
 			mtree_err("%s: %s", p->fts_accpath, strerror(errno));
-		close(fd);
-		output(fp, indent, &offset, "cksum=%lu", (long)val);
-	}
+		if (keys & F_CKSUM)
+			output(fp, indent, &offset, "cksum=%lu",
+			    (long)dig.d_cksum);
 #ifndef NO_MD5
-	if (keys & F_MD5 && S_ISREG(p->fts_statp->st_mode)) {
-		if ((digestbuf = MD5File(p->fts_accpath, NULL)) == NULL)
-			mtree_err("%s: MD5File failed: %s", p->fts_accpath,
-			    strerror(errno));
-		output(fp, indent, &offset, "%s=%s", MD5KEY, digestbuf);
-		free(digestbuf);
-	}
+		if (keys & F_MD5) {
+			if (dig.d_md5 == NULL)
+				mtree_err("%s: MD5 failed: %s",
+				    p->fts_accpath, strerror(errno));
+			output(fp, indent, &offset, "%s=%s", MD5KEY,
+			    dig.d_md5);
+		}
 #endif	/* ! NO_MD5 */
 #ifndef NO_RMD160
-	if (keys & F_RMD160 && S_ISREG(p->fts_statp->st_mode)) {
-		if ((digestbuf = RMD160File(p->fts_accpath, NULL)) == NULL)
-			mtree_err("%s: RMD160File failed: %s", p->fts_accpath,
-			    strerror(errno));
-		output(fp, indent, &offset, "%s=%s", RMD160KEY, digestbuf);
-		free(digestbuf);
-	}
+		if (keys & F_RMD160) {
+			if (dig.d_rmd160 == NULL)
+				mtree_err("%s: RMD160 failed: %s",
+				    p->fts_accpath, strerror(errno));
+			output(fp, indent, &offset, "%s=%s", RMD160KEY,
+			    dig.d_rmd160);
+		}
 #endif	/* ! NO_RMD160 */
 #ifndef NO_SHA1
-	if (keys & F_SHA1 && S_ISREG(p->fts_statp->st_mode)) {
-		if ((digestbuf = SHA1File(p->fts_accpath, NULL)) == NULL)
-			mtree_err("%s: SHA1File failed: %s", p->fts_accpath,
-			    strerror(errno));
-		output(fp, indent, &offset, "%s=%s", SHA1KEY, digestbuf);
-		free(digestbuf);
-	}
+		if (keys & F_SHA1) {
+			if (dig.d_sha1 == NULL)
+				mtree_err("%s: SHA1 failed: %s",
+				    p->fts_accpath, strerror(errno));
+			output(fp, indent, &offset, "%s=%s", SHA1KEY,
+			    dig.d_sha1);
+		}
 #endif	/* ! NO_SHA1 */
 #ifndef NO_SHA2
-	if (keys & F_SHA256 && S_ISREG(p->fts_statp->st_mode)) {
-		if ((digestbuf = SHA256_File(p->fts_accpath, NULL)) == NULL)
-			mtree_err("%s: SHA256_File failed: %s", p->fts_accpath,
-			    strerror(errno));
-		output(fp, indent, &offset, "%s=%s", SHA256KEY, digestbuf);
-		free(digestbuf);
-	}
+		if (keys & F_SHA256) {
+			if (dig.d_sha256 == NULL)
+				mtree_err("%s: SHA256 failed: %s",
+				    p->fts_accpath, strerror(errno));
+			output(fp, indent, &offset, "%s=%s", SHA256KEY,
+			    dig.d_sha256);
+		}
 #ifdef SHA384_BLOCK_LENGTH
-	if (keys & F_SHA384 && S_ISREG(p->fts_statp->st_mode)) {
-		if ((digestbuf = SHA384_File(p->fts_accpath, NULL)) == NULL)
-			mtree_err("%s: SHA384_File failed: %s", p->fts_accpath,
-			    strerror(errno));
-		output(fp, indent, &offset, "%s=%s", SHA384KEY, digestbuf);
-		free(digestbuf);
-	}
+		if (keys & F_SHA384) {
+			if (dig.d_sha384 == NULL)
+				mtree_err("%s: SHA384 failed: %s",
+				    p->fts_accpath, strerror(errno));
+			output(fp, indent, &offset, "%s=%s", SHA384KEY,
+			    dig.d_sha384);
+		}
 #endif
-	if (keys & F_SHA512 && S_ISREG(p->fts_statp->st_mode)) {
-		if ((digestbuf = SHA512_File(p->fts_accpath, NULL)) == NULL)
-			mtree_err("%s: SHA512_File failed: %s", p->fts_accpath,
-			    strerror(errno));
-		output(fp, indent, &offset, "%s=%s", SHA512KEY, digestbuf);
-		free(digestbuf);
-	}
+		if (keys & F_SHA512) {
+			if (dig.d_sha512 == NULL)
+				mtree_err("%s: SHA512 failed: %s",
+				    p->fts_accpath, strerror(errno));
+			output(fp, indent, &offset, "%s=%s", SHA512KEY,
+			    dig.d_sha512);
+		}
 #endif	/* ! NO_SHA2 */
+		free_digest(&dig);
+	}
 	if (keys & F_SLINK &&
 	    (p->fts_info == FTS_SL || p->fts_info == FTS_SLNONE))
 		output(fp, indent, &offset, "link=%s",
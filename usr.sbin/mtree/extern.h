@@ -59,12 +59,39 @@ enum flavor {
 	F_NETBSD6
 };
 
+/*
+ * All checksums and digests of one file, computed by digest_file() in a
+ * single pass over the file contents.  Members are only filled in when the
+ * corresponding key was requested; digest strings are allocated and must be
+ * freed by the caller, e.g. with free_digest().
+ */
+struct mtree_digest {
+	u_int32_t d_cksum;		/* POSIX 1003.2 checksum */
+	u_int32_t d_csumlen;		/* number of bytes checksummed */
+#ifndef NO_MD5
+	char	*d_md5;
+#endif
+#ifndef NO_RMD160
+	char	*d_rmd160;
+#endif
+#ifndef NO_SHA1
+	char	*d_sha1;
+#endif
+#ifndef NO_SHA2
+	char	*d_sha256;
+	char	*d_sha384;
+	char	*d_sha512;
+#endif
+};
+
 void	 addtag(slist_t *, char *);
 int	 check_excludes(const char *, const char *);
 int	 compare(NODE *, FTSENT *);
 int	 crc(int, u_int32_t *, u_int32_t *);
 void	 cwalk(FILE *);
+int	 digest_file(const char *, int, struct mtree_digest *);
 void	 dump_nodes(FILE *, const char *, NODE *, int);
+void	 free_digest(struct mtree_digest *);
 void	 init_excludes(void);
 int	 matchtags(NODE *);
 __dead __printflike(1,2) void	 mtree_err(const char *, ...);
@@ -235,6 +235,7 @@ unsigned	valid_utf8(const char *);
 static unsigned check_sd(char*);
 static unsigned check_msgid(char *);
 /* event handling */
+static void	sync_files(void);
 static void	dispatch_read_klog(int fd, short event, void *ev);
 static void	dispatch_read_finet(int fd, short event, void *ev);
 static void	dispatch_read_funix(int fd, short event, void *ev);
@@ -495,7 +496,8 @@ getgroup:
 		DPRINTF(D_NET, "Listening on unix dgram socket `%s'\n", *pp);
 	}
 
-	if ((fklog = open(_PATH_KLOG, O_RDONLY, 0)) < 0) {
+	/* Nonblocking, so that dispatch_read_klog() can drain it in batches. */
+	if ((fklog = open(_PATH_KLOG, O_RDONLY|O_NONBLOCK, 0)) < 0) {
 		DPRINTF(D_FILE, "Can't open `%s' (%d)\n", _PATH_KLOG, errno);
 	} else {
 		DPRINTF(D_FILE, "Listening on kernel log `%s' with fd %d\n",
@@ -660,6 +662,32 @@ usage(void)
 	exit(1);
 }
 
+/*
+ * Maximum number of reads drained from one source per event callback.
+ * Reading in batches saves one event loop round trip per message during
+ * bursts, while the limit keeps a busy source from starving the others.
+ */
+#define INTAKE_BATCH	32
+
+/*
+ * Flush log files that had synced messages written to them since the last
+ * fsync.  Called after every intake batch, so that a burst of messages to
+ * the same file is covered by a single fsync instead of one per message.
+ */
+static void
+sync_files(void)
+{
+	struct filed *f;
+
+	for (f = Files; f != NULL; f = f->f_next) {
+		if (!(f->f_flags & FFLAG_NEEDSYNC))
+			continue;
+		if (f->f_file >= 0)
+			(void)fsync(f->f_file);
+		f->f_flags &= ~FFLAG_NEEDSYNC;
+	}
+}
+
 /*
  * Dispatch routine for reading /dev/klog
  *
@@ -673,24 +701,34 @@ static void
 dispatch_read_klog(int fd, short event, void *ev)
 {
 	ssize_t rv;
-	size_t resid = linebufsize - klog_linebufoff;
+	size_t resid;
+	int i;
 
 	DPRINTF((D_CALL|D_EVENT), "Kernel log active (%d, %d, %p)"
 		" with linebuf@%p, length %zu)\n", fd, event, ev,
 		klog_linebuf, linebufsize);
 
-	rv = read(fd, &klog_linebuf[klog_linebufoff], resid - 1);
-	if (rv > 0) {
+	for (i = 0; i < INTAKE_BATCH; i++) {
+		resid = linebufsize - klog_linebufoff;
+		rv = read(fd, &klog_linebuf[klog_linebufoff], resid - 1);
+		if (rv == 0)
+			break;
+		if (rv < 0) {
+			if (errno == EINTR || errno == EWOULDBLOCK ||
+			    errno == EAGAIN)
+				break;
+			/*
+			 * /dev/klog has croaked.  Disable the event
+			 * so it won't bother us again.
+			 */
+			logerror("klog failed");
+			event_del(ev);
+			break;
+		}
 		klog_linebuf[klog_linebufoff + rv] = '\0';
 		printsys(klog_linebuf);
-	} else if (rv < 0 && errno != EINTR) {
-		/*
-		 * /dev/klog has croaked.  Disable the event
-		 * so it won't bother us again.
-		 */
-		logerror("klog failed");
-		event_del(ev);
 	}
+	sync_files();
 }
 
 /*
@@ -702,6 +740,7 @@ dispatch_read_funix(int fd, short event, void *ev)
 	struct sockaddr_un myname, fromunix;
 	ssize_t rv;
 	socklen_t sunlen;
+	int i;
 
 	sunlen = sizeof(myname);
 	if (getsockname(fd, (struct sockaddr *)&myname, &sunlen) != 0) {
@@ -721,16 +760,23 @@ dispatch_read_funix(int fd, short event, void *ev)
 		" with linebuf@%p, size %zu)\n", (int)SUN_PATHLEN(&myname),
 		myname.sun_path, fd, event, ev, linebuf, linebufsize-1);
 
-	sunlen = sizeof(fromunix);
-	rv = recvfrom(fd, linebuf, linebufsize-1, 0,
-	    (struct sockaddr *)&fromunix, &sunlen);
-	if (rv > 0) {
-		linebuf[rv] = '\0';
-		printline(LocalFQDN, linebuf, 0);
-	} else if (rv < 0 && errno != EINTR) {
-		logerror("recvfrom() unix `%.*s'",
-			(int)SUN_PATHLEN(&myname), myname.sun_path);
+	for (i = 0; i < INTAKE_BATCH; i++) {
+		sunlen = sizeof(fromunix);
+		rv = recvfrom(fd, linebuf, linebufsize-1, MSG_DONTWAIT,
+		    (struct sockaddr *)&fromunix, &sunlen);
+		if (rv > 0) {
+			linebuf[rv] = '\0';
+			printline(LocalFQDN, linebuf, 0);
+		} else if (rv < 0) {
+			if (errno != EINTR && errno != EWOULDBLOCK &&
+			    errno != EAGAIN)
+				logerror("recvfrom() unix `%.*s'",
+					(int)SUN_PATHLEN(&myname),
+					myname.sun_path);
+			break;
+		}
 	}
+	sync_files();
 }
 
 /*
@@ -745,7 +791,7 @@ dispatch_read_finet(int fd, short event, void *ev)
 	struct sockaddr_storage frominet;
 	ssize_t rv;
 	socklen_t len;
-	int reject = 0;
+	int i, reject = 0;
 
 	DPRINTF((D_CALL|D_EVENT|D_NET), "inet socket active (%d, %d %p) "
 		" with linebuf@%p, size %zu)\n",
@@ -759,20 +805,25 @@ dispatch_read_finet(int fd, short event, void *ev)
 		DPRINTF(D_NET, "access denied\n");
 #endif
 
-	len = sizeof(frominet);
-	rv = recvfrom(fd, linebuf, linebufsize-1, 0,
-	    (struct sockaddr *)&frominet, &len);
-	if (rv == 0 || (rv < 0 && errno == EINTR))
-		return;
-	else if (rv < 0) {
-		logerror("recvfrom inet");
-		return;
-	}
+	for (i = 0; i < INTAKE_BATCH; i++) {
+		len = sizeof(frominet);
+		rv = recvfrom(fd, linebuf, linebufsize-1, MSG_DONTWAIT,
+		    (struct sockaddr *)&frominet, &len);
+		if (rv == 0)
+			continue;
+		if (rv < 0) {
+			if (errno != EINTR && errno != EWOULDBLOCK &&
+			    errno != EAGAIN)
+				logerror("recvfrom inet");
+			break;
+		}
 
-	linebuf[rv] = '\0';
-	if (!reject)
-		printline(cvthname(&frominet), linebuf,
-		    RemoteAddDate ? ADDDATE : 0);
+		linebuf[rv] = '\0';
+		if (!reject)
+			printline(cvthname(&frominet), linebuf,
+			    RemoteAddDate ? ADDDATE : 0);
+	}
+	sync_files();
 }
 
 /*
@@ -2441,9 +2492,14 @@ fprintlog(struct filed *f, struct buf_msg *passedbuffer, struct buf_queue *qentr
 			}
 		} else {
 			f->f_lasterror = 0;
+			/*
+			 * Defer the fsync to the end of the current intake
+			 * batch, so that a burst of synced messages to the
+			 * same file costs one fsync instead of one each.
+			 */
 			if ((buffer->flags & SYNC_FILE)
 			 && (f->f_flags & FFLAG_SYNC))
-				(void)fsync(f->f_file);
+				f->f_flags |= FFLAG_NEEDSYNC;
 			/* Problem with files: We cannot check beforehand if
 			 * they would be writeable and call send_queue() first.
 			 * So we call send_queue() after a successful write,
@@ -2762,6 +2818,8 @@ domark(int fd, short event, void *ev)
 		}
 	}
 	message_allqueues_check();
+	/* Backstop for synced messages logged outside the intake paths. */
+	sync_files();
 	RESTORE_SIGNALS(omask);
 
 	/* Walk the dead queue, and see if we should signal somebody. */
@@ -2918,6 +2976,7 @@ die(int fd, short event, void *ev)
 			fprintlog(f, NULL, NULL);
 		SEND_QUEUE(f);
 	}
+	sync_files();
 
 #ifndef DISABLE_TLS
 	free_incoming_tls_sockets();
@@ -3367,6 +3426,7 @@ init(int fd, short event, void *ev)
 			fprintlog(f, NULL, NULL);
 		SEND_QUEUE(f);
 	}
+	sync_files();
 	/* some actions only on SIGHUP and not on first start */
 	if (Initialized) {
 #ifndef DISABLE_SIGN
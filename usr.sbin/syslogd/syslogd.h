@@ -5,7 +5,7 @@
  * All rights reserved.
  *
  * This code is derived from software contributed to The NetBSD Foundation
- * by Martin Sch�tte.
+ * by Martin Sch�tte.
  *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions
@@ -380,6 +380,9 @@ struct filed {
 #define FFLAG_FULL	0x02	/* for F_FILE | F_PIPE: write PRI header */
 #define FFLAG_SIGN	0x04	/* for syslog-sign with SG="3":
 				 * sign the messages to this destination */
+#define FFLAG_NEEDSYNC	0x08	/* for F_FILE: a synced message was written
+				 * since the last fsync; flushed in batches
+				 * by sync_files() */
 };
 
 #ifndef DISABLE_TLS